@@ -0,0 +1,1034 @@
+/*
+File:   app_benchmarks.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds a handful of functions that time various parts of loading and processing maps.
+	** These are kicked off by debug hotkeys in AppUpdate and print their results to the console.
+*/
+
+bool AreOsmTagRangesIdentical(const OsmMap* left, OsmTagRange leftRange, const OsmMap* right, OsmTagRange rightRange)
+{
+	if (leftRange.count != rightRange.count) { return false; }
+	const OsmTag* leftTags = GetOsmTags(left, leftRange);
+	const OsmTag* rightTags = GetOsmTags(right, rightRange);
+	for (u32 tIndex = 0; tIndex < leftRange.count; tIndex++)
+	{
+		if (!StrExactEquals(leftTags[tIndex].key, rightTags[tIndex].key) || !StrExactEquals(leftTags[tIndex].value, rightTags[tIndex].value)) { return false; }
+	}
+	return true;
+}
+
+// Returns true if the two maps hold exactly the same primitives (ids, locations, tags, node refs and members) in the same order
+bool AreOsmMapsIdentical(OsmMap* left, OsmMap* right)
+{
+	NotNull(left);
+	NotNull(right);
+	if (left->nodes.length != right->nodes.length) { return false; }
+	if (left->ways.length != right->ways.length) { return false; }
+	if (left->relations.length != right->relations.length) { return false; }
+	
+	VarArrayLoop(&left->nodes, nIndex)
+	{
+		VarArrayLoopGet(OsmNode, leftNode, &left->nodes, nIndex);
+		OsmNode* rightNode = VarArrayGet(OsmNode, &right->nodes, nIndex);
+		if (leftNode->id != rightNode->id) { return false; }
+		OsmLocation leftLocation = *VarArrayGet(OsmLocation, &left->nodeLocations, nIndex);
+		OsmLocation rightLocation = *VarArrayGet(OsmLocation, &right->nodeLocations, nIndex);
+		if (leftLocation.lon != rightLocation.lon || leftLocation.lat != rightLocation.lat) { return false; }
+		OsmNodeInfo* leftInfo = VarArrayGet(OsmNodeInfo, &left->nodeInfos, nIndex);
+		OsmNodeInfo* rightInfo = VarArrayGet(OsmNodeInfo, &right->nodeInfos, nIndex);
+		if (leftInfo->version != rightInfo->version || leftInfo->changeset != rightInfo->changeset || leftInfo->uid != rightInfo->uid) { return false; }
+		if (!AreOsmTagRangesIdentical(left, leftNode->tags, right, rightNode->tags)) { return false; }
+	}
+	
+	VarArrayLoop(&left->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, leftWay, &left->ways, wIndex);
+		OsmWay* rightWay = VarArrayGet(OsmWay, &right->ways, wIndex);
+		if (leftWay->id != rightWay->id) { return false; }
+		if (leftWay->nodes.length != rightWay->nodes.length) { return false; }
+		VarArrayLoop(&leftWay->nodes, nIndex)
+		{
+			VarArrayLoopGet(OsmNodeRef, leftRef, &leftWay->nodes, nIndex);
+			OsmNodeRef* rightRef = VarArrayGet(OsmNodeRef, &rightWay->nodes, nIndex);
+			if (leftRef->id != rightRef->id || (leftRef->nodeIndex == OSM_INVALID_INDEX) != (rightRef->nodeIndex == OSM_INVALID_INDEX)) { return false; }
+		}
+		if (!AreOsmTagRangesIdentical(left, leftWay->tags, right, rightWay->tags)) { return false; }
+	}
+	
+	VarArrayLoop(&left->relations, rIndex)
+	{
+		VarArrayLoopGet(OsmRelation, leftRelation, &left->relations, rIndex);
+		OsmRelation* rightRelation = VarArrayGet(OsmRelation, &right->relations, rIndex);
+		if (leftRelation->id != rightRelation->id) { return false; }
+		if (leftRelation->members.length != rightRelation->members.length) { return false; }
+		VarArrayLoop(&leftRelation->members, mIndex)
+		{
+			VarArrayLoopGet(OsmRelationMember, leftMember, &leftRelation->members, mIndex);
+			OsmRelationMember* rightMember = VarArrayGet(OsmRelationMember, &rightRelation->members, mIndex);
+			if (leftMember->id != rightMember->id || leftMember->type != rightMember->type || leftMember->role != rightMember->role) { return false; }
+		}
+		if (!AreOsmTagRangesIdentical(left, leftRelation->tags, right, rightRelation->tags)) { return false; }
+	}
+	
+	return true;
+}
+
+// +--------------------------------------------------------------+
+// |                    .pbf Thread Scaling                       |
+// +--------------------------------------------------------------+
+// Reads the whole file into memory once and then parses it serially and with 1, 2, 4, and 8 worker threads.
+// Every threaded result is compared against the serial one to make sure the pipeline didn't change the output
+void RunPbfThreadScalingBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	Slice fileContents = Slice_Empty;
+	if (!OsReadBinFile(filePath, scratch, &fileContents)) { NotifyPrint_E("Failed to open \"%.*s\" for benchmark", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	PrintLine_I("Benchmarking .pbf parsing of \"%.*s\" (%llu bytes, %llu processor core%s)", StrPrint(filePath), fileContents.length, GetNumProcessorCores(), Plural(GetNumProcessorCores(), "s"));
+	
+	OsmMap serialMap = ZEROED;
+	DataStream serialStream = ToDataStreamFromBuffer(fileContents);
+	OsTime serialStartTime = OsGetTime();
+	Result serialResult = TryParsePbfMap(stdHeap, &serialStream, nullptr, &serialMap);
+	r32 serialMs = OsTimeDiffMsR32(serialStartTime, OsGetTime());
+	if (serialResult != Result_Success) { NotifyPrint_E("Serial parse failed: %s", GetResultStr(serialResult)); ScratchEnd(scratch); return; }
+	PrintLine_I("  serial:    %8.1fms (%llu nodes, %llu ways, %llu relations)", serialMs, serialMap.nodes.length, serialMap.ways.length, serialMap.relations.length);
+	
+	uxx threadCounts[] = { 1, 2, 4, 8 };
+	for (uxx cIndex = 0; cIndex < ArrayCount(threadCounts); cIndex++)
+	{
+		WorkerPool pool = ZEROED;
+		InitWorkerPool(stdHeap, threadCounts[cIndex], &pool);
+		OsmLoadOptions threadedOptions = ZEROED;
+		threadedOptions.workerPool = &pool;
+		OsmMap threadedMap = ZEROED;
+		DataStream threadedStream = ToDataStreamFromBuffer(fileContents);
+		OsTime startTime = OsGetTime();
+		Result threadedResult = TryParsePbfMap(stdHeap, &threadedStream, &threadedOptions, &threadedMap);
+		r32 threadedMs = OsTimeDiffMsR32(startTime, OsGetTime());
+		FreeWorkerPool(&pool);
+		if (threadedResult == Result_Success)
+		{
+			bool isIdentical = AreOsmMapsIdentical(&serialMap, &threadedMap);
+			PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  %llu thread%s: %8.1fms (%.2fx)%s",
+				threadCounts[cIndex], Plural(threadCounts[cIndex], "s"),
+				threadedMs, (threadedMs > 0) ? (serialMs / threadedMs) : 0.0f,
+				isIdentical ? "" : " OUTPUT DOES NOT MATCH SERIAL!"
+			);
+			FreeOsmMap(&threadedMap);
+		}
+		else { NotifyPrint_E("Parse with %llu thread%s failed: %s", threadCounts[cIndex], Plural(threadCounts[cIndex], "s"), GetResultStr(threadedResult)); }
+	}
+	
+	FreeOsmMap(&serialMap);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                      Tag String Memory                       |
+// +--------------------------------------------------------------+
+// Loads the file and compares the memory the map's OsmStringPool uses to what the tag strings took when every key and value was
+// its own AllocStr8 (the character bytes plus one heap allocation each, the per-allocation overhead depends on the heap so it's printed separately).
+// Also prints what the shared map->tags array costs next to the VarArray every primitive used to have for its tags
+void RunOsmTagMemoryBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	Slice fileContents = Slice_Empty;
+	if (!OsReadBinFile(filePath, scratch, &fileContents)) { NotifyPrint_E("Failed to open \"%.*s\" for benchmark", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	PrintLine_I("Measuring tag string memory for \"%.*s\" (%llu bytes)", StrPrint(filePath), fileContents.length);
+	
+	OsmMap map = ZEROED;
+	DataStream stream = ToDataStreamFromBuffer(fileContents);
+	OsTime startTime = OsGetTime();
+	Result parseResult = TryParsePbfMap(stdHeap, &stream, nullptr, &map);
+	r32 elapsedMs = OsTimeDiffMsR32(startTime, OsGetTime());
+	if (parseResult != Result_Success) { NotifyPrint_E("Parse failed: %s", GetResultStr(parseResult)); ScratchEnd(scratch); return; }
+	
+	//NOTE: Every primitive's tags are in map.tags, and right after a load none of them are dead
+	uxx numTags = map.tags.length - map.numDeadTags;
+	uxx numTagStringBytes = 0;
+	VarArrayLoop(&map.tags, tIndex) { VarArrayLoopGet(OsmTag, tag, &map.tags, tIndex); numTagStringBytes += tag->key.length + tag->value.length; }
+	uxx numPrimitives = map.nodes.length + map.ways.length + map.relations.length;
+	
+	uxx poolBytes = GetOsmStringPoolMemoryUsage(&map.stringPool);
+	PrintLine_I("  loaded in %.1fms, %llu tag%s", elapsedMs, numTags, Plural(numTags, "s"));
+	PrintLine_I("  separate strings: %llu bytes in %llu allocation%s", numTagStringBytes, numTags*2, Plural(numTags*2, "s"));
+	PrintLine_I("  string pool:      %llu bytes for %llu unique string%s (%.1fx smaller, not counting allocation overhead)",
+		poolBytes,
+		map.stringPool.entries.length, Plural(map.stringPool.entries.length, "s"),
+		(poolBytes > 0) ? ((r64)numTagStringBytes / (r64)poolBytes) : 0.0
+	);
+	PrintLine_I("  tag array:        %llu bytes for all %llu tags plus %llu bytes of ranges (a VarArray per primitive would be %llu bytes of headers on its own)",
+		numTags * (uxx)sizeof(OsmTag), numTags,
+		numPrimitives * (uxx)sizeof(OsmTagRange),
+		numPrimitives * (uxx)sizeof(VarArray)
+	);
+	
+	FreeOsmMap(&map);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                        Save Comparison                       |
+// +--------------------------------------------------------------+
+// Loads the file and times saving it with SerializeOsmMap and with SerializePbfMap (serially and on a worker pool).
+// The threaded .pbf output has to be byte for byte identical to the serial one and is parsed again to make sure nothing was lost
+void RunOsmSaveBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	Slice fileContents = Slice_Empty;
+	if (!OsReadBinFile(filePath, scratch, &fileContents)) { NotifyPrint_E("Failed to open \"%.*s\" for benchmark", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	PrintLine_I("Comparing .osm and .pbf saving for \"%.*s\" (%llu bytes)", StrPrint(filePath), fileContents.length);
+	
+	OsmMap map = ZEROED;
+	DataStream stream = ToDataStreamFromBuffer(fileContents);
+	Result parseResult = TryParsePbfMap(stdHeap, &stream, nullptr, &map);
+	if (parseResult != Result_Success) { NotifyPrint_E("Parse failed: %s", GetResultStr(parseResult)); ScratchEnd(scratch); return; }
+	
+	uxx scratchMark = ArenaGetMark(scratch);
+	OsTime osmStartTime = OsGetTime();
+	Str8 osmContents = SerializeOsmMap(scratch, &map);
+	r32 osmMs = OsTimeDiffMsR32(osmStartTime, OsGetTime());
+	uxx osmSize = osmContents.length;
+	ArenaResetToMark(scratch, scratchMark);
+	PrintLine_I("  .osm:            %8.1fms %12llu bytes", osmMs, osmSize);
+	
+	OsTime serialStartTime = OsGetTime();
+	Slice serialContents = SerializePbfMap(scratch, &map, nullptr);
+	r32 serialMs = OsTimeDiffMsR32(serialStartTime, OsGetTime());
+	PrintLine_I("  .pbf serial:     %8.1fms %12llu bytes (%.1fx faster, %.1fx smaller)",
+		serialMs, serialContents.length,
+		(serialMs > 0) ? (osmMs / serialMs) : 0.0f,
+		(serialContents.length > 0) ? ((r64)osmSize / (r64)serialContents.length) : 0.0
+	);
+	
+	WorkerPool pool = ZEROED;
+	InitWorkerPool(stdHeap, GetNumProcessorCores(), &pool);
+	uxx numThreads = pool.numThreads;
+	OsTime threadedStartTime = OsGetTime();
+	Slice threadedContents = SerializePbfMap(scratch, &map, &pool);
+	r32 threadedMs = OsTimeDiffMsR32(threadedStartTime, OsGetTime());
+	FreeWorkerPool(&pool);
+	bool isIdentical = (threadedContents.length == serialContents.length && MyMemEquals(threadedContents.bytes, serialContents.bytes, serialContents.length));
+	PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  .pbf %llu thread%s: %8.1fms %12llu bytes (%.1fx faster)%s",
+		numThreads, Plural(numThreads, "s"),
+		threadedMs, threadedContents.length,
+		(threadedMs > 0) ? (osmMs / threadedMs) : 0.0f,
+		isIdentical ? "" : " OUTPUT DOES NOT MATCH SERIAL!"
+	);
+	
+	OsmMap reloadedMap = ZEROED;
+	DataStream reloadStream = ToDataStreamFromBuffer(serialContents);
+	Result reloadResult = TryParsePbfMap(stdHeap, &reloadStream, nullptr, &reloadedMap);
+	if (reloadResult == Result_Success)
+	{
+		bool reloadMatches = AreOsmMapsIdentical(&map, &reloadedMap);
+		PrintLineAt(reloadMatches ? DbgLevel_Info : DbgLevel_Error, "  reloaded .pbf has %llu nodes, %llu ways and %llu relations%s",
+			reloadedMap.nodes.length, reloadedMap.ways.length, reloadedMap.relations.length,
+			reloadMatches ? "" : " WHICH DOES NOT MATCH THE ORIGINAL!"
+		);
+		FreeOsmMap(&reloadedMap);
+	}
+	else { NotifyPrint_E("Reloading the saved .pbf failed: %s", GetResultStr(reloadResult)); }
+	
+	FreeOsmMap(&map);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                    .pbf Decoder Comparison                   |
+// +--------------------------------------------------------------+
+// Parses the file serially with the generated protobuf-c decoder and then with our direct decoder (a few times each)
+// and prints the best time for both. The two maps are compared to make sure the direct decoder produces the same output
+void RunPbfDecoderBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	Slice fileContents = Slice_Empty;
+	if (!OsReadBinFile(filePath, scratch, &fileContents)) { NotifyPrint_E("Failed to open \"%.*s\" for benchmark", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	PrintLine_I("Comparing .pbf PrimitiveBlock decoders on \"%.*s\" (%llu bytes)", StrPrint(filePath), fileContents.length);
+	
+	const uxx numRuns = 3;
+	OsmMap maps[2] = ZEROED;
+	r32 bestMs[2] = { 0.0f, 0.0f };
+	const char* decoderNames[2] = { "protobuf-c", "direct" };
+	for (uxx dIndex = 0; dIndex < 2; dIndex++)
+	{
+		OsmLoadOptions options = ZEROED;
+		options.useProtobufCDecoder = (dIndex == 0);
+		for (uxx runIndex = 0; runIndex < numRuns; runIndex++)
+		{
+			OsmMap map = ZEROED;
+			DataStream stream = ToDataStreamFromBuffer(fileContents);
+			OsTime startTime = OsGetTime();
+			Result parseResult = TryParsePbfMap(stdHeap, &stream, &options, &map);
+			r32 elapsedMs = OsTimeDiffMsR32(startTime, OsGetTime());
+			if (parseResult != Result_Success)
+			{
+				NotifyPrint_E("Parse with %s decoder failed: %s", decoderNames[dIndex], GetResultStr(parseResult));
+				if (dIndex > 0) { FreeOsmMap(&maps[0]); }
+				ScratchEnd(scratch);
+				return;
+			}
+			if (runIndex == 0 || elapsedMs < bestMs[dIndex]) { bestMs[dIndex] = elapsedMs; }
+			if (runIndex == 0) { MyMemCopy(&maps[dIndex], &map, sizeof(OsmMap)); }
+			else { FreeOsmMap(&map); }
+		}
+	}
+	
+	bool isIdentical = AreOsmMapsIdentical(&maps[0], &maps[1]);
+	PrintLine_I("  %-10s: %8.1fms (best of %llu)", decoderNames[0], bestMs[0], numRuns);
+	PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  %-10s: %8.1fms (%.2fx)%s",
+		decoderNames[1], bestMs[1], (bestMs[1] > 0) ? (bestMs[0] / bestMs[1]) : 0.0f,
+		isIdentical ? "" : " OUTPUT DOES NOT MATCH PROTOBUF-C!"
+	);
+	
+	FreeOsmMap(&maps[1]);
+	FreeOsmMap(&maps[0]);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                  DenseNodes Delta Kernels                    |
+// +--------------------------------------------------------------+
+typedef plex PbfBenchColumn PbfBenchColumn;
+plex PbfBenchColumn
+{
+	Slice slice;
+	uxx count;
+	bool isDelta; //false for DenseInfo version which is a plain int32 column
+};
+
+void AddPbfBenchColumn(VarArray* columnsOut, PbfWireReader* reader, PbfWireType wireType, bool isDelta)
+{
+	PbfPackedField field = ZEROED;
+	if (!TryReadPbfPackedField(reader, wireType, &field)) { return; }
+	PbfBenchColumn* newColumn = VarArrayAdd(PbfBenchColumn, columnsOut);
+	NotNull(newColumn);
+	newColumn->slice = field.slice;
+	newColumn->count = field.count;
+	newColumn->isDelta = isDelta;
+}
+
+bool DecodePbfBenchColumn(PbfKernelLevel level, const PbfBenchColumn* column, i64* valuesOut, PbfDeltaColumnStats* statsOut)
+{
+	if (column->isDelta) { return DecodePbfDeltaColumn(level, column->slice, column->count, valuesOut, statsOut); }
+	else { return DecodePbfInt32Column(level, column->slice, column->count, valuesOut, statsOut); }
+}
+
+// Walks PrimitiveBlock -> PrimitiveGroup -> DenseNodes (-> DenseInfo) and records every column that DecodePbfDenseNodesDirect runs through the kernels
+void FindPbfDenseColumns(Slice primitiveBlockBytes, VarArray* columnsOut)
+{
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	PbfWireReader blockReader = MakePbfWireReader(primitiveBlockBytes);
+	while (PbfWireReadField(&blockReader, &fieldNumber, &wireType))
+	{
+		if (fieldNumber != 2 || wireType != PbfWireType_LengthDelimited) { PbfWireSkipField(&blockReader, wireType); continue; }
+		PbfWireReader groupReader = MakePbfWireReader(PbfWireReadSlice(&blockReader));
+		while (PbfWireReadField(&groupReader, &fieldNumber, &wireType))
+		{
+			if (fieldNumber != 2 || wireType != PbfWireType_LengthDelimited) { PbfWireSkipField(&groupReader, wireType); continue; }
+			PbfWireReader denseReader = MakePbfWireReader(PbfWireReadSlice(&groupReader));
+			while (PbfWireReadField(&denseReader, &fieldNumber, &wireType))
+			{
+				if (fieldNumber == 1 || fieldNumber == 8 || fieldNumber == 9) { AddPbfBenchColumn(columnsOut, &denseReader, wireType, true); }
+				else if (fieldNumber == 5 && wireType == PbfWireType_LengthDelimited)
+				{
+					PbfWireReader infoReader = MakePbfWireReader(PbfWireReadSlice(&denseReader));
+					while (PbfWireReadField(&infoReader, &fieldNumber, &wireType))
+					{
+						if (fieldNumber == 1) { AddPbfBenchColumn(columnsOut, &infoReader, wireType, false); }
+						else if (fieldNumber >= 2 && fieldNumber <= 4) { AddPbfBenchColumn(columnsOut, &infoReader, wireType, true); }
+						else { PbfWireSkipField(&infoReader, wireType); }
+					}
+				}
+				else { PbfWireSkipField(&denseReader, wireType); }
+			}
+		}
+	}
+}
+
+// Inflates every OSMData blob in the file, pulls out the DenseNodes columns, and then times decoding all of them with each kernel
+// level the CPU supports. Every level is checked against the scalar kernel (values and stats) before it's timed
+void RunPbfDeltaKernelBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	Slice fileContents = Slice_Empty;
+	if (!OsReadBinFile(filePath, scratch, &fileContents)) { NotifyPrint_E("Failed to open \"%.*s\" for benchmark", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	
+	VarArray columns;
+	InitVarArray(PbfBenchColumn, &columns, scratch);
+	DataStream stream = ToDataStreamFromBuffer(fileContents);
+	PbfPipeline pipeline = ZEROED;
+	pipeline.protobufStream = &stream;
+	InitThreadMutex(&pipeline.readMutex);
+	while (true)
+	{
+		PbfStagedBlock block = ZEROED;
+		block.arena = scratch;
+		InitVarArray(PbfStagedMessage, &block.messages, scratch);
+		if (!TryReadPbfBlob(&pipeline, &block) || block.result != Result_None) { break; }
+		Slice decompressedBuffer = Slice_Empty;
+		if (DecompressPbfStagedBlob(&block, &decompressedBuffer) != Result_None) { break; }
+		if (StrExactEquals(block.typeStr, StrLit("OSMData"))) { FindPbfDenseColumns(decompressedBuffer, &columns); }
+	}
+	FreeThreadMutex(&pipeline.readMutex);
+	
+	uxx totalValues = 0;
+	uxx totalBytes = 0;
+	uxx maxColumnCount = 0;
+	VarArrayLoop(&columns, cIndex)
+	{
+		VarArrayLoopGet(PbfBenchColumn, column, &columns, cIndex);
+		totalValues += column->count;
+		totalBytes += column->slice.length;
+		maxColumnCount = MaxUXX(maxColumnCount, column->count);
+	}
+	if (totalValues == 0) { NotifyPrint_W("Found no DenseNodes in \"%.*s\"", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	PbfKernelLevel supportedLevel = GetPbfKernelLevelSupported();
+	PrintLine_I("Benchmarking DenseNodes delta kernels on \"%.*s\" (%llu column%s, %llu values, %llu bytes, best level %s)",
+		StrPrint(filePath),
+		columns.length, Plural(columns.length, "s"),
+		totalValues, totalBytes, GetPbfKernelLevelStr(supportedLevel)
+	);
+	
+	i64* referenceValues = AllocArray(i64, scratch, maxColumnCount);
+	i64* testValues = AllocArray(i64, scratch, maxColumnCount);
+	NotNull(referenceValues);
+	NotNull(testValues);
+	const uxx numRuns = 10;
+	r32 scalarMs = 0.0f;
+	for (uxx levelIndex = PbfKernelLevel_Scalar; levelIndex <= (uxx)supportedLevel; levelIndex++)
+	{
+		PbfKernelLevel level = (PbfKernelLevel)levelIndex;
+		bool isIdentical = true;
+		VarArrayLoop(&columns, cIndex)
+		{
+			VarArrayLoopGet(PbfBenchColumn, column, &columns, cIndex);
+			PbfDeltaColumnStats referenceStats = ZEROED;
+			PbfDeltaColumnStats testStats = ZEROED;
+			bool referenceSuccess = DecodePbfBenchColumn(PbfKernelLevel_Scalar, column, referenceValues, &referenceStats);
+			bool testSuccess = DecodePbfBenchColumn(level, column, testValues, &testStats);
+			if (referenceSuccess != testSuccess ||
+				referenceStats.minValue != testStats.minValue || referenceStats.maxValue != testStats.maxValue || referenceStats.minDelta != testStats.minDelta ||
+				!MyMemEquals(referenceValues, testValues, sizeof(i64) * column->count))
+			{
+				isIdentical = false;
+				break;
+			}
+		}
+		
+		r32 bestMs = 0.0f;
+		for (uxx runIndex = 0; runIndex < numRuns; runIndex++)
+		{
+			OsTime startTime = OsGetTime();
+			VarArrayLoop(&columns, cIndex)
+			{
+				VarArrayLoopGet(PbfBenchColumn, column, &columns, cIndex);
+				PbfDeltaColumnStats stats = ZEROED;
+				DecodePbfBenchColumn(level, column, testValues, &stats);
+			}
+			r32 elapsedMs = OsTimeDiffMsR32(startTime, OsGetTime());
+			if (runIndex == 0 || elapsedMs < bestMs) { bestMs = elapsedMs; }
+		}
+		if (level == PbfKernelLevel_Scalar) { scalarMs = bestMs; }
+		
+		PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  %-7s: %7.2fms %6.2fns/value %8.1fMB/s (%.2fx)%s",
+			GetPbfKernelLevelStr(level),
+			bestMs,
+			(bestMs * 1000000.0f) / (r32)totalValues,
+			(bestMs > 0) ? ((r32)totalBytes / (1024.0f * 1024.0f)) / (bestMs / 1000.0f) : 0.0f,
+			(bestMs > 0) ? (scalarMs / bestMs) : 0.0f,
+			isIdentical ? "" : " OUTPUT DOES NOT MATCH SCALAR!"
+		);
+	}
+	
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                      XML DOM Child Walk                      |
+// +--------------------------------------------------------------+
+// How XmlGetNextChild and XmlGetAttribute used to work: prevChild's index is found by searching the children and the types and keys are compared as strings
+XmlElement* XmlGetNextChildByScan(VarArray* children, Str8 type, XmlElement* prevChild)
+{
+	uxx startIndex = 0;
+	if (prevChild != nullptr)
+	{
+		VarArrayLoop(children, cIndex) { if (VarArrayGet(XmlElement, children, cIndex) == prevChild) { startIndex = cIndex+1; break; } }
+	}
+	for (uxx cIndex = startIndex; cIndex < children->length; cIndex++)
+	{
+		VarArrayLoopGet(XmlElement, child, children, cIndex);
+		if (StrExactEquals(child->type, type)) { return child; }
+	}
+	return nullptr;
+}
+Str8 XmlGetAttributeByScan(XmlElement* element, Str8 attributeName)
+{
+	VarArrayLoop(&element->attributes, aIndex)
+	{
+		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
+		if (StrExactEquals(attribute->key, attributeName)) { return attribute->value; }
+	}
+	return Str8_Empty;
+}
+
+// Walks the first maxNodes <node> children of osmElement and looks up their id, lat and lon attributes. Returns the summed length
+// of the values so the lookups can't be thrown away
+uxx WalkXmlNodes(XmlFile* file, XmlElement* osmElement, uxx maxNodes, bool useIter)
+{
+	uxx result = 0;
+	uxx numNodes = 0;
+	if (useIter)
+	{
+		u32 idKeyId = XmlFindNameId(file, StrLit("id"));
+		u32 latKeyId = XmlFindNameId(file, StrLit("lat"));
+		u32 lonKeyId = XmlFindNameId(file, StrLit("lon"));
+		XmlChildIter iter = XmlIterChildren(file, osmElement, StrLit("node"));
+		for (XmlElement* node = XmlIterNext(&iter); node != nullptr && numNodes < maxNodes; node = XmlIterNext(&iter))
+		{
+			XmlAttribute* idAttribute = XmlFindAttributeById(node, idKeyId);
+			XmlAttribute* latAttribute = XmlFindAttributeById(node, latKeyId);
+			XmlAttribute* lonAttribute = XmlFindAttributeById(node, lonKeyId);
+			if (idAttribute != nullptr) { result += idAttribute->value.length; }
+			if (latAttribute != nullptr) { result += latAttribute->value.length; }
+			if (lonAttribute != nullptr) { result += lonAttribute->value.length; }
+			numNodes++;
+		}
+	}
+	else
+	{
+		for (XmlElement* node = XmlGetNextChildByScan(&osmElement->children, StrLit("node"), nullptr); node != nullptr && numNodes < maxNodes; node = XmlGetNextChildByScan(&osmElement->children, StrLit("node"), node))
+		{
+			result += XmlGetAttributeByScan(node, StrLit("id")).length;
+			result += XmlGetAttributeByScan(node, StrLit("lat")).length;
+			result += XmlGetAttributeByScan(node, StrLit("lon")).length;
+			numNodes++;
+		}
+	}
+	return result;
+}
+
+// Parses the file with TryParseXml and then walks an eighth, a quarter, half and all of the <node> children of <osm>, once the way
+// the DOM used to be walked and once with XmlIterChildren and attribute ids (best of a few runs each). The time per node should stay flat for the second one
+void RunXmlDomBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	Str8 fileContents = Str8_Empty;
+	if (!OsReadTextFile(filePath, scratch, &fileContents)) { NotifyPrint_E("Failed to open \"%.*s\" for benchmark", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	
+	XmlFile xmlFile = ZEROED;
+	OsTime parseStartTime = OsGetTime();
+	Result parseResult = TryParseXml(fileContents, scratch, &xmlFile);
+	r32 parseMs = OsTimeDiffMsR32(parseStartTime, OsGetTime());
+	if (parseResult != Result_Success) { NotifyPrint_E("Parse failed: %s", GetResultStr(parseResult)); ScratchEnd(scratch); return; }
+	XmlElement* osmElement = XmlGetOneChild(&xmlFile, nullptr, StrLit("osm"));
+	if (osmElement == nullptr) { NotifyPrint_E("There is no <osm> element in \"%.*s\"", StrPrint(filePath)); ScratchEnd(scratch); return; }
+	uxx numNodes = 0;
+	XmlChildIter countIter = XmlIterChildren(&xmlFile, osmElement, StrLit("node"));
+	while (XmlIterNext(&countIter) != nullptr) { numNodes++; }
+	PrintLine_I("Walking the XML DOM of \"%.*s\" (%llu bytes, %llu elements, %llu name%s, %llu nodes, parsed in %.1fms)",
+		StrPrint(filePath), fileContents.length, xmlFile.numElements,
+		xmlFile.names.length, Plural(xmlFile.names.length, "s"),
+		numNodes, parseMs
+	);
+	
+	const char* walkNames[2] = { "string scan", "iter + ids" };
+	const uxx numRuns = 5;
+	uxx fractions[] = { 8, 4, 2, 1 };
+	for (uxx fIndex = 0; fIndex < ArrayCount(fractions); fIndex++)
+	{
+		uxx maxNodes = numNodes / fractions[fIndex];
+		if (maxNodes == 0) { continue; }
+		r32 walkMs[2] = { 0.0f, 0.0f };
+		uxx walkSums[2] = { 0, 0 };
+		for (uxx wIndex = 0; wIndex < 2; wIndex++)
+		{
+			for (uxx runIndex = 0; runIndex < numRuns; runIndex++)
+			{
+				OsTime startTime = OsGetTime();
+				walkSums[wIndex] = WalkXmlNodes(&xmlFile, osmElement, maxNodes, (wIndex == 1));
+				r32 elapsedMs = OsTimeDiffMsR32(startTime, OsGetTime());
+				if (runIndex == 0 || elapsedMs < walkMs[wIndex]) { walkMs[wIndex] = elapsedMs; }
+			}
+		}
+		bool isIdentical = (walkSums[0] == walkSums[1]);
+		PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  %8llu nodes: %s %8.2fms %8.1fns/node | %s %8.2fms %8.1fns/node%s",
+			maxNodes,
+			walkNames[0], walkMs[0], (walkMs[0] * 1000000.0f) / (r32)maxNodes,
+			walkNames[1], walkMs[1], (walkMs[1] * 1000000.0f) / (r32)maxNodes,
+			isIdentical ? "" : " LOOKUPS DO NOT MATCH!"
+		);
+	}
+	
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                    .osm Number Parsing                       |
+// +--------------------------------------------------------------+
+// Loads the file and prints the coordinates and ids of its nodes the way SerializeOsmMap does. Those strings are parsed with the generic
+// TryParseR64\TryParseU64 and with the fast .osm parsers (best of a few runs each) and the results are compared. Then the map is saved
+// with SerializeOsmMap and parsed back twice to make sure the .osm output round-trips exactly
+void RunOsmNumberParsingBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	OsmMap map = ZEROED;
+	Result loadResult = TryParseMapFile(scratch, filePath, nullptr, &map);
+	if (loadResult != Result_Success) { NotifyPrint_E("Failed to load \"%.*s\" for benchmark: %s", StrPrint(filePath), GetResultStr(loadResult)); ScratchEnd(scratch); return; }
+	uxx numCoords = map.nodes.length * 2;
+	uxx numIds = map.nodes.length;
+	if (numIds == 0) { NotifyPrint_E("\"%.*s\" has no nodes to benchmark", StrPrint(filePath)); FreeOsmMap(&map); ScratchEnd(scratch); return; }
+	
+	Str8* coordStrs = AllocArray(Str8, scratch, numCoords);
+	Str8* idStrs = AllocArray(Str8, scratch, numIds);
+	NotNull(coordStrs);
+	NotNull(idStrs);
+	uxx numStrBytes = 0;
+	VarArrayLoop(&map.nodes, nIndex)
+	{
+		VarArrayLoopGet(OsmNode, node, &map.nodes, nIndex);
+		v2d location = ToV2dFromOsmLocation(*VarArrayGet(OsmLocation, &map.nodeLocations, nIndex));
+		coordStrs[nIndex*2 + 0] = PrintInArenaStr(scratch, "%.7lf", location.lat);
+		coordStrs[nIndex*2 + 1] = PrintInArenaStr(scratch, "%.7lf", location.lon);
+		idStrs[nIndex] = PrintInArenaStr(scratch, "%llu", node->id);
+		numStrBytes += coordStrs[nIndex*2 + 0].length + coordStrs[nIndex*2 + 1].length + idStrs[nIndex].length;
+	}
+	PrintLine_I("Benchmarking .osm number parsing on \"%.*s\" (%llu coordinates, %llu ids, %llu bytes)", StrPrint(filePath), numCoords, numIds, numStrBytes);
+	
+	r64* genericCoords = AllocArray(r64, scratch, numCoords);
+	r64* fastCoords = AllocArray(r64, scratch, numCoords);
+	i32* fixedCoords = AllocArray(i32, scratch, numCoords);
+	u64* genericIds = AllocArray(u64, scratch, numIds);
+	u64* fastIds = AllocArray(u64, scratch, numIds);
+	NotNull(genericCoords);
+	NotNull(fastCoords);
+	NotNull(fixedCoords);
+	NotNull(genericIds);
+	NotNull(fastIds);
+	
+	const uxx numRuns = 5;
+	const char* parserNames[5] = { "TryParseR64", "TryParseOsmCoordFast", "TryParseOsmCoordFixedFast", "TryParseU64", "TryParseOsmDigitsFast" };
+	r32 bestMs[5] = ZEROED;
+	uxx numFailed[5] = ZEROED;
+	for (uxx runIndex = 0; runIndex < numRuns; runIndex++)
+	{
+		for (uxx pIndex = 0; pIndex < ArrayCount(bestMs); pIndex++)
+		{
+			uxx failCount = 0;
+			OsTime startTime = OsGetTime();
+			switch (pIndex)
+			{
+				case 0: for (uxx cIndex = 0; cIndex < numCoords; cIndex++) { if (!TryParseR64(coordStrs[cIndex], &genericCoords[cIndex], nullptr)) { failCount++; } } break;
+				case 1: for (uxx cIndex = 0; cIndex < numCoords; cIndex++) { if (!TryParseOsmCoordFast(coordStrs[cIndex], &fastCoords[cIndex])) { failCount++; } } break;
+				case 2: for (uxx cIndex = 0; cIndex < numCoords; cIndex++) { if (!TryParseOsmCoordFixedFast(coordStrs[cIndex], &fixedCoords[cIndex])) { failCount++; } } break;
+				case 3: for (uxx iIndex = 0; iIndex < numIds; iIndex++) { if (!TryParseU64(idStrs[iIndex], &genericIds[iIndex], nullptr)) { failCount++; } } break;
+				case 4: for (uxx iIndex = 0; iIndex < numIds; iIndex++) { if (!TryParseOsmDigitsFast(idStrs[iIndex], &fastIds[iIndex])) { failCount++; } } break;
+				default: break;
+			}
+			r32 elapsedMs = OsTimeDiffMsR32(startTime, OsGetTime());
+			if (runIndex == 0 || elapsedMs < bestMs[pIndex]) { bestMs[pIndex] = elapsedMs; }
+			numFailed[pIndex] = failCount;
+		}
+	}
+	
+	uxx numCoordMismatches = 0;
+	uxx numFixedMismatches = 0;
+	for (uxx cIndex = 0; cIndex < numCoords; cIndex++)
+	{
+		if (fastCoords[cIndex] != genericCoords[cIndex]) { numCoordMismatches++; }
+		if (fixedCoords[cIndex] != (i32)RoundR64i(genericCoords[cIndex] * OSM_COORD_FIXED_SCALE)) { numFixedMismatches++; }
+	}
+	uxx numIdMismatches = 0;
+	for (uxx iIndex = 0; iIndex < numIds; iIndex++) { if (fastIds[iIndex] != genericIds[iIndex]) { numIdMismatches++; } }
+	uxx numMismatches[5] = { 0, numCoordMismatches, numFixedMismatches, 0, numIdMismatches };
+	
+	for (uxx pIndex = 0; pIndex < ArrayCount(bestMs); pIndex++)
+	{
+		bool isCoord = (pIndex < 3);
+		uxx numValues = isCoord ? numCoords : numIds;
+		r32 baselineMs = isCoord ? bestMs[0] : bestMs[3];
+		bool isCorrect = (numFailed[pIndex] == 0 && numMismatches[pIndex] == 0);
+		PrintLineAt(isCorrect ? DbgLevel_Info : DbgLevel_Error, "  %-26s %7.2fms %6.2fns/value (%.2fx)%s",
+			parserNames[pIndex], bestMs[pIndex],
+			(bestMs[pIndex] * 1000000.0f) / (r32)numValues,
+			(bestMs[pIndex] > 0) ? (baselineMs / bestMs[pIndex]) : 0.0f,
+			isCorrect ? "" : " FAILED OR DID NOT MATCH THE GENERIC PARSER!"
+		);
+	}
+	
+	//NOTE: The first load might not have come from a .osm file, so we compare the second and third generations rather than the original map
+	Str8 firstContents = SerializeOsmMap(scratch, &map);
+	OsmMap firstReload = ZEROED;
+	Result firstResult = TryParseOsmMap(stdHeap, firstContents, nullptr, &firstReload);
+	if (firstResult == Result_Success)
+	{
+		Str8 secondContents = SerializeOsmMap(scratch, &firstReload);
+		OsmMap secondReload = ZEROED;
+		Result secondResult = TryParseOsmMap(stdHeap, secondContents, nullptr, &secondReload);
+		if (secondResult == Result_Success)
+		{
+			bool isIdentical = (StrExactEquals(firstContents, secondContents) && AreOsmMapsIdentical(&firstReload, &secondReload));
+			PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  SerializeOsmMap round trip (%llu bytes)%s", secondContents.length, isIdentical ? " is exact" : " DOES NOT MATCH!");
+			FreeOsmMap(&secondReload);
+		}
+		else { NotifyPrint_E("Parsing the saved .osm a second time failed: %s", GetResultStr(secondResult)); }
+		FreeOsmMap(&firstReload);
+	}
+	else { NotifyPrint_E("Parsing the saved .osm failed: %s", GetResultStr(firstResult)); }
+	
+	FreeOsmMap(&map);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                   .osm XML Thread Scaling                    |
+// +--------------------------------------------------------------+
+// Loads the file (any format) and saves it as .osm text in memory, then parses that text serially and with 1, 2, 4, and 8 worker threads.
+// Every threaded result is compared against the serial one. The text has to be at least twice OSM_XML_SEGMENT_SIZE for the threads to be used at all
+void RunOsmThreadScalingBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	OsmMap sourceMap = ZEROED;
+	Result loadResult = TryParseMapFile(scratch, filePath, nullptr, &sourceMap);
+	if (loadResult != Result_Success) { NotifyPrint_E("Failed to load \"%.*s\" for benchmark: %s", StrPrint(filePath), GetResultStr(loadResult)); ScratchEnd(scratch); return; }
+	Str8 xmlContents = SerializeOsmMap(scratch, &sourceMap);
+	FreeOsmMap(&sourceMap);
+	uxx numSegments = xmlContents.length / OSM_XML_SEGMENT_SIZE; //roughly, the splits land at the next element
+	PrintLine_I("Benchmarking .osm parsing of \"%.*s\" saved as XML (%llu bytes, ~%llu segment%s, %llu processor core%s)",
+		StrPrint(filePath), xmlContents.length,
+		numSegments, Plural(numSegments, "s"),
+		GetNumProcessorCores(), Plural(GetNumProcessorCores(), "s")
+	);
+	
+	OsmMap serialMap = ZEROED;
+	OsTime serialStartTime = OsGetTime();
+	Result serialResult = TryParseOsmMap(stdHeap, xmlContents, nullptr, &serialMap);
+	r32 serialMs = OsTimeDiffMsR32(serialStartTime, OsGetTime());
+	if (serialResult != Result_Success) { NotifyPrint_E("Serial parse failed: %s", GetResultStr(serialResult)); ScratchEnd(scratch); return; }
+	PrintLine_I("  serial:    %8.1fms (%llu nodes, %llu ways, %llu relations)", serialMs, serialMap.nodes.length, serialMap.ways.length, serialMap.relations.length);
+	
+	uxx threadCounts[] = { 1, 2, 4, 8 };
+	for (uxx cIndex = 0; cIndex < ArrayCount(threadCounts); cIndex++)
+	{
+		WorkerPool pool = ZEROED;
+		InitWorkerPool(stdHeap, threadCounts[cIndex], &pool);
+		OsmLoadOptions threadedOptions = ZEROED;
+		threadedOptions.workerPool = &pool;
+		OsmMap threadedMap = ZEROED;
+		OsTime startTime = OsGetTime();
+		Result threadedResult = TryParseOsmMap(stdHeap, xmlContents, &threadedOptions, &threadedMap);
+		r32 threadedMs = OsTimeDiffMsR32(startTime, OsGetTime());
+		FreeWorkerPool(&pool);
+		if (threadedResult == Result_Success)
+		{
+			bool isIdentical = AreOsmMapsIdentical(&serialMap, &threadedMap);
+			PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  %llu thread%s: %8.1fms (%.2fx)%s",
+				threadCounts[cIndex], Plural(threadCounts[cIndex], "s"),
+				threadedMs, (threadedMs > 0) ? (serialMs / threadedMs) : 0.0f,
+				isIdentical ? "" : " OUTPUT DOES NOT MATCH SERIAL!"
+			);
+			FreeOsmMap(&threadedMap);
+		}
+		else { NotifyPrint_E("Parse with %llu thread%s failed: %s", threadCounts[cIndex], Plural(threadCounts[cIndex], "s"), GetResultStr(threadedResult)); }
+	}
+	
+	FreeOsmMap(&serialMap);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                  Compressed .osm Streaming                   |
+// +--------------------------------------------------------------+
+// Wraps the deflate stream that PbfCompressZlib makes in a gzip member header and trailer instead of the zlib ones
+Slice CompressOsmBenchGzip(Arena* arena, Slice rawData)
+{
+	ScratchBegin1(scratch, arena);
+	Slice zlibData = PbfCompressZlib(scratch, rawData);
+	InflateStream* crcStream = AllocType(InflateStream, scratch);
+	NotNull(crcStream);
+	InitGzipCrcTable(crcStream);
+	u32 crc = UpdateGzipCrc(crcStream, 0, rawData.bytes, rawData.length);
+	u32 rawSize = (u32)rawData.length;
+	
+	uxx deflateLength = zlibData.length - 2 - 4; //the 2 byte zlib header and the adler32 at the end
+	u8 header[10] = { 0x1F, 0x8B, 8, 0x00, 0, 0, 0, 0, 0x00, 0xFF }; //no flags, no mtime, OS unknown
+	Slice result = Slice_Empty;
+	result.length = sizeof(header) + deflateLength + 8;
+	result.bytes = AllocArray(u8, arena, result.length);
+	NotNull(result.bytes);
+	MyMemCopy(&result.bytes[0], &header[0], sizeof(header));
+	MyMemCopy(&result.bytes[sizeof(header)], &zlibData.bytes[2], deflateLength);
+	u8* trailer = &result.bytes[sizeof(header) + deflateLength];
+	for (uxx bIndex = 0; bIndex < 4; bIndex++) { trailer[bIndex] = (u8)(crc >> (bIndex*8)); trailer[4 + bIndex] = (u8)(rawSize >> (bIndex*8)); }
+	ScratchEnd(scratch);
+	return result;
+}
+
+// Loads the file (any format), saves it as .osm text in memory and gzips that, then compares parsing the text directly against streaming it out
+// of the gzip data on the calling thread and with the decompression on a worker thread. We have no bzip2 compressor so only gzip is measured here
+void RunOsmCompressedLoadBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	OsmMap sourceMap = ZEROED;
+	Result loadResult = TryParseMapFile(scratch, filePath, nullptr, &sourceMap);
+	if (loadResult != Result_Success) { NotifyPrint_E("Failed to load \"%.*s\" for benchmark: %s", StrPrint(filePath), GetResultStr(loadResult)); ScratchEnd(scratch); return; }
+	Str8 xmlContents = SerializeOsmMap(scratch, &sourceMap);
+	FreeOsmMap(&sourceMap);
+	Slice gzipContents = CompressOsmBenchGzip(scratch, MakeSlice(xmlContents.length, xmlContents.chars));
+	PrintLine_I("Benchmarking compressed .osm loading of \"%.*s\" saved as XML (%llu bytes, %llu gzipped)", StrPrint(filePath), xmlContents.length, gzipContents.length);
+	
+	OsmMap plainMap = ZEROED;
+	OsTime plainStartTime = OsGetTime();
+	Result plainResult = TryParseOsmMap(stdHeap, xmlContents, nullptr, &plainMap);
+	r32 plainMs = OsTimeDiffMsR32(plainStartTime, OsGetTime());
+	if (plainResult != Result_Success) { NotifyPrint_E("Uncompressed parse failed: %s", GetResultStr(plainResult)); ScratchEnd(scratch); return; }
+	PrintLine_I("  uncompressed:    %8.1fms", plainMs);
+	
+	const char* modeNames[2] = { "gzip", "gzip pipelined" };
+	for (uxx mIndex = 0; mIndex < 2; mIndex++)
+	{
+		WorkerPool pool = ZEROED;
+		OsmLoadOptions options = ZEROED;
+		if (mIndex == 1) { InitWorkerPool(stdHeap, 1, &pool); options.workerPool = &pool; }
+		OsmMap gzipMap = ZEROED;
+		OsTime startTime = OsGetTime();
+		Result gzipResult = TryParseOsmCompressedMap(stdHeap, gzipContents, StreamCodec_Gzip, nullptr, &options, &gzipMap);
+		r32 gzipMs = OsTimeDiffMsR32(startTime, OsGetTime());
+		if (mIndex == 1) { FreeWorkerPool(&pool); }
+		if (gzipResult == Result_Success)
+		{
+			bool isIdentical = AreOsmMapsIdentical(&plainMap, &gzipMap);
+			PrintLineAt(isIdentical ? DbgLevel_Info : DbgLevel_Error, "  %-15s: %8.1fms (%.2fx)%s",
+				modeNames[mIndex], gzipMs, (gzipMs > 0) ? (plainMs / gzipMs) : 0.0f,
+				isIdentical ? "" : " OUTPUT DOES NOT MATCH UNCOMPRESSED!"
+			);
+			FreeOsmMap(&gzipMap);
+		}
+		else { NotifyPrint_E("%s parse failed: %s", modeNames[mIndex], GetResultStr(gzipResult)); }
+	}
+	
+	FreeOsmMap(&plainMap);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                          Id Lookups                          |
+// +--------------------------------------------------------------+
+#define OSM_ID_BENCH_LINEAR_SAMPLE   1000 //ids, the linear scan is too slow to run on every ref so we time this many and scale it up
+
+// Looks up the node of every way ref in the map with FindOsmNode (including building the table), with a binary search on the sorted
+// nodes array (what FindOsmNode used to do when the nodes were sorted) and with a linear scan (what it did when they weren't),
+// then times ResolveOsmRelationMembers on every relation, which used to scan the relations array for every relation member
+void RunOsmIdLookupBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	OsmMap map = ZEROED;
+	Result loadResult = TryParseMapFile(scratch, filePath, nullptr, &map);
+	if (loadResult != Result_Success) { NotifyPrint_E("Failed to load \"%.*s\" for benchmark: %s", StrPrint(filePath), GetResultStr(loadResult)); ScratchEnd(scratch); return; }
+	
+	uxx numRefs = 0;
+	VarArrayLoop(&map.ways, wIndex) { VarArrayLoopGet(OsmWay, way, &map.ways, wIndex); numRefs += way->nodes.length; }
+	u64* refIds = AllocArray(u64, scratch, MaxUXX(numRefs, 1));
+	NotNull(refIds);
+	uxx refIndex = 0;
+	VarArrayLoop(&map.ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map.ways, wIndex);
+		VarArrayLoop(&way->nodes, nIndex) { refIds[refIndex] = VarArrayGet(OsmNodeRef, &way->nodes, nIndex)->id; refIndex++; }
+	}
+	PrintLine_I("Benchmarking id lookups in \"%.*s\" (%llu nodes, %llu ways, %llu relations, %llu way refs)",
+		StrPrint(filePath), map.nodes.length, map.ways.length, map.relations.length, numRefs
+	);
+	SortOsmNodes(&map);
+	
+	uxx numFound = 0;
+	InvalidateOsmIdTable(&map.nodeIdTable);
+	OsTime hashStartTime = OsGetTime();
+	for (uxx rIndex = 0; rIndex < numRefs; rIndex++) { if (FindOsmNode(&map, refIds[rIndex]) != nullptr) { numFound++; } }
+	r32 hashMs = OsTimeDiffMsR32(hashStartTime, OsGetTime());
+	
+	uxx numBinaryFound = 0;
+	OsTime binaryStartTime = OsGetTime();
+	for (uxx rIndex = 0; rIndex < numRefs; rIndex++)
+	{
+		if (BinarySearchVarArrayUintMember(OsmNode, id, &map.nodes, &refIds[rIndex]) < map.nodes.length) { numBinaryFound++; }
+	}
+	r32 binaryMs = OsTimeDiffMsR32(binaryStartTime, OsGetTime());
+	
+	uxx numLinearRefs = MinUXX(numRefs, OSM_ID_BENCH_LINEAR_SAMPLE);
+	uxx numLinearFound = 0;
+	OsTime linearStartTime = OsGetTime();
+	for (uxx rIndex = 0; rIndex < numLinearRefs; rIndex++)
+	{
+		VarArrayLoop(&map.nodes, nIndex) { if (VarArrayGet(OsmNode, &map.nodes, nIndex)->id == refIds[rIndex]) { numLinearFound++; break; } }
+	}
+	r32 linearMs = OsTimeDiffMsR32(linearStartTime, OsGetTime());
+	r32 linearAllMs = (numLinearRefs > 0) ? (linearMs * (r32)numRefs / (r32)numLinearRefs) : 0.0f;
+	
+	PrintLineAt((numFound == numBinaryFound) ? DbgLevel_Info : DbgLevel_Error, "  hash table:    %8.1fms, %llu found, %llu bytes%s",
+		hashMs, numFound, GetOsmIdTableMemoryUsage(&map.nodeIdTable),
+		(numFound == numBinaryFound) ? "" : " DOES NOT MATCH BINARY SEARCH!"
+	);
+	PrintLine_I("  binary search: %8.1fms (%.2fx)", binaryMs, (hashMs > 0) ? (binaryMs / hashMs) : 0.0f);
+	PrintLine_I("  linear scan:   %8.1fms for %llu refs, ~%.1fms for all of them (%.0fx)", linearMs, numLinearRefs, linearAllMs, (hashMs > 0) ? (linearAllMs / hashMs) : 0.0f);
+	
+	OsTime relationsStartTime = OsGetTime();
+	VarArrayLoop(&map.relations, rIndex)
+	{
+		VarArrayLoopGet(OsmRelation, relation, &map.relations, rIndex);
+		ResolveOsmRelationMembers(&map, relation, false);
+	}
+	r32 relationsMs = OsTimeDiffMsR32(relationsStartTime, OsGetTime());
+	PrintLine_I("  ResolveOsmRelationMembers on every relation: %.1fms", relationsMs);
+	
+	FreeOsmMap(&map);
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                         Node Columns                         |
+// +--------------------------------------------------------------+
+#define OSM_NODE_BENCH_ITERATIONS   20 //passes over every node for each loop, so the timings aren't dominated by the first pass faulting the memory in
+
+// What a node looked like before the location, flags and metadata were moved out of OsmNode into the map's columns, only used to compare against
+typedef plex OsmNodeRecordBench OsmNodeRecordBench;
+plex OsmNodeRecordBench
+{
+	OsmNode node;
+	OsmNodeInfo info;
+	v2d location;
+	bool isSelected;
+	bool isHovered;
+};
+
+// Compares the memory each node takes (in total and in what the per-frame loops have to read) and times the render cull
+// and the hover search from AppUpdate over the location column and over a copy of the nodes laid out as one record each.
+// The column holds whatever OSM_FIXED_POINT_LOCATIONS picks, so build with it on and off to compare the two
+void RunOsmNodeColumnsBenchmark(FilePath filePath)
+{
+	ScratchBegin(scratch);
+	OsmMap map = ZEROED;
+	Result loadResult = TryParseMapFile(scratch, filePath, nullptr, &map);
+	if (loadResult != Result_Success) { NotifyPrint_E("Failed to load \"%.*s\" for benchmark: %s", StrPrint(filePath), GetResultStr(loadResult)); ScratchEnd(scratch); return; }
+	uxx numNodes = map.nodes.length;
+	PrintLine_I("Benchmarking node columns in \"%.*s\" (%llu nodes, %s locations)", StrPrint(filePath), numNodes, OSM_FIXED_POINT_LOCATIONS ? "fixed-point" : "double");
+	if (numNodes == 0) { FreeOsmMap(&map); ScratchEnd(scratch); return; }
+	
+	uxx columnBytes = sizeof(OsmNode) + sizeof(OsmLocation) + sizeof(u8) + sizeof(OsmNodeInfo);
+	uxx columnHotBytes = sizeof(OsmLocation) + sizeof(u8);
+	PrintLine_I("  columns: %llu bytes per node (%llu OsmNode + %llu location + %llu flags + %llu info), the loops read %llu",
+		columnBytes, (uxx)sizeof(OsmNode), (uxx)sizeof(OsmLocation), (uxx)sizeof(u8), (uxx)sizeof(OsmNodeInfo), columnHotBytes
+	);
+	PrintLine_I("  records: %llu bytes per node, the loops read all of it (%.1fx more)",
+		(uxx)sizeof(OsmNodeRecordBench), (r64)sizeof(OsmNodeRecordBench) / (r64)columnHotBytes
+	);
+	
+	OsmNodeRecordBench* records = AllocArray(OsmNodeRecordBench, scratch, numNodes);
+	NotNull(records);
+	for (uxx nIndex = 0; nIndex < numNodes; nIndex++)
+	{
+		records[nIndex].node = *VarArrayGet(OsmNode, &map.nodes, nIndex);
+		records[nIndex].info = *VarArrayGet(OsmNodeInfo, &map.nodeInfos, nIndex);
+		records[nIndex].location = ToV2dFromOsmLocation(*VarArrayGet(OsmLocation, &map.nodeLocations, nIndex));
+		records[nIndex].isSelected = false;
+		records[nIndex].isHovered = false;
+	}
+	
+	//NOTE: The middle quarter of the map stands in for the viewport, and its center for the mouse
+	recd bounds = map.bounds;
+	r64 minLon = MinR64(bounds.lon, bounds.lon + bounds.sizeLon) + AbsR64(bounds.sizeLon)/4;
+	r64 minLat = MinR64(bounds.lat, bounds.lat + bounds.sizeLat) + AbsR64(bounds.sizeLat)/4;
+	r64 maxLon = minLon + AbsR64(bounds.sizeLon)/2;
+	r64 maxLat = minLat + AbsR64(bounds.sizeLat)/2;
+	v2d mouseLocation = MakeV2d((minLon + maxLon)/2, (minLat + maxLat)/2);
+	const OsmLocation* nodeLocations = (const OsmLocation*)map.nodeLocations.items;
+	u8* nodeFlags = (u8*)map.nodeFlags.items;
+	//NOTE: Same as AppUpdate, the column loops compare in the column's units
+	r64 minLonUnits = minLon * OSM_LOCATION_UNITS_PER_DEGREE;
+	r64 minLatUnits = minLat * OSM_LOCATION_UNITS_PER_DEGREE;
+	r64 maxLonUnits = maxLon * OSM_LOCATION_UNITS_PER_DEGREE;
+	r64 maxLatUnits = maxLat * OSM_LOCATION_UNITS_PER_DEGREE;
+	v2d mouseUnits = MakeV2d(mouseLocation.lon * OSM_LOCATION_UNITS_PER_DEGREE, mouseLocation.lat * OSM_LOCATION_UNITS_PER_DEGREE);
+	
+	uxx numColumnInside = 0;
+	OsTime columnCullStartTime = OsGetTime();
+	for (uxx iteration = 0; iteration < OSM_NODE_BENCH_ITERATIONS; iteration++)
+	{
+		for (uxx nIndex = 0; nIndex < numNodes; nIndex++)
+		{
+			r64 nodeLon = (r64)nodeLocations[nIndex].lon;
+			r64 nodeLat = (r64)nodeLocations[nIndex].lat;
+			if (nodeLon <= maxLonUnits && nodeLat <= maxLatUnits && nodeLon >= minLonUnits && nodeLat >= minLatUnits) { numColumnInside++; }
+		}
+	}
+	r32 columnCullMs = OsTimeDiffMsR32(columnCullStartTime, OsGetTime());
+	
+	uxx numRecordInside = 0;
+	OsTime recordCullStartTime = OsGetTime();
+	for (uxx iteration = 0; iteration < OSM_NODE_BENCH_ITERATIONS; iteration++)
+	{
+		for (uxx nIndex = 0; nIndex < numNodes; nIndex++)
+		{
+			v2d location = records[nIndex].location;
+			if (location.lon <= maxLon && location.lat <= maxLat && location.lon >= minLon && location.lat >= minLat) { numRecordInside++; }
+		}
+	}
+	r32 recordCullMs = OsTimeDiffMsR32(recordCullStartTime, OsGetTime());
+	
+	uxx columnClosestIndex = 0;
+	OsTime columnHoverStartTime = OsGetTime();
+	for (uxx iteration = 0; iteration < OSM_NODE_BENCH_ITERATIONS; iteration++)
+	{
+		r64 closestDistanceSqr = 0.0;
+		for (uxx nIndex = 0; nIndex < numNodes; nIndex++)
+		{
+			FlagUnset(nodeFlags[nIndex], (u8)OsmNodeFlag_Hovered);
+			r64 lonDiff = (r64)nodeLocations[nIndex].lon - mouseUnits.lon;
+			r64 latDiff = (r64)nodeLocations[nIndex].lat - mouseUnits.lat;
+			r64 distanceSqr = lonDiff*lonDiff + latDiff*latDiff;
+			if (nIndex == 0 || distanceSqr < closestDistanceSqr) { columnClosestIndex = nIndex; closestDistanceSqr = distanceSqr; }
+		}
+	}
+	r32 columnHoverMs = OsTimeDiffMsR32(columnHoverStartTime, OsGetTime());
+	
+	uxx recordClosestIndex = 0;
+	OsTime recordHoverStartTime = OsGetTime();
+	for (uxx iteration = 0; iteration < OSM_NODE_BENCH_ITERATIONS; iteration++)
+	{
+		r64 closestDistanceSqr = 0.0;
+		for (uxx nIndex = 0; nIndex < numNodes; nIndex++)
+		{
+			records[nIndex].isHovered = false;
+			r64 distanceSqr = LengthSquaredV2d(SubV2d(mouseLocation, records[nIndex].location));
+			if (nIndex == 0 || distanceSqr < closestDistanceSqr) { recordClosestIndex = nIndex; closestDistanceSqr = distanceSqr; }
+		}
+	}
+	r32 recordHoverMs = OsTimeDiffMsR32(recordHoverStartTime, OsGetTime());
+	
+	bool doResultsMatch = (numColumnInside == numRecordInside && columnClosestIndex == recordClosestIndex);
+	r64 numNodesVisited = (r64)numNodes * OSM_NODE_BENCH_ITERATIONS;
+	PrintLineAt(doResultsMatch ? DbgLevel_Info : DbgLevel_Error, "  cull:  columns %7.1fms (%.1fM nodes/s), records %7.1fms (%.1fM nodes/s), %.2fx%s",
+		columnCullMs, (columnCullMs > 0) ? (numNodesVisited / columnCullMs / 1000.0) : 0.0,
+		recordCullMs, (recordCullMs > 0) ? (numNodesVisited / recordCullMs / 1000.0) : 0.0,
+		(columnCullMs > 0) ? (recordCullMs / columnCullMs) : 0.0f,
+		doResultsMatch ? "" : " RESULTS DO NOT MATCH!"
+	);
+	PrintLine_I("  hover: columns %7.1fms (%.1fM nodes/s), records %7.1fms (%.1fM nodes/s), %.2fx",
+		columnHoverMs, (columnHoverMs > 0) ? (numNodesVisited / columnHoverMs / 1000.0) : 0.0,
+		recordHoverMs, (recordHoverMs > 0) ? (numNodesVisited / recordHoverMs / 1000.0) : 0.0,
+		(columnHoverMs > 0) ? (recordHoverMs / columnHoverMs) : 0.0f
+	);
+	
+	v2d* decodedLocations = AllocArray(v2d, scratch, numNodes);
+	NotNull(decodedLocations);
+	OsTime decodeStartTime = OsGetTime();
+	for (uxx iteration = 0; iteration < OSM_NODE_BENCH_ITERATIONS; iteration++) { DecodeOsmLocations(numNodes, nodeLocations, decodedLocations); }
+	r32 decodeMs = OsTimeDiffMsR32(decodeStartTime, OsGetTime());
+	PrintLine_I("  DecodeOsmLocations on every node: %7.1fms (%.1fM nodes/s)", decodeMs, (decodeMs > 0) ? (numNodesVisited / decodeMs / 1000.0) : 0.0);
+	
+	FreeOsmMap(&map);
+	ScratchEnd(scratch);
+}
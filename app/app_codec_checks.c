@@ -0,0 +1,252 @@
+/*
+File:   app_codec_checks.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds known-answer checks for the codecs that we implement ourselves instead of getting from PigCore or third_party.
+	** Every fixture below is CodecCheckText compressed by the reference tool named above it, our decoder has to turn it
+	** back into exactly CodecCheckText and has to reject a truncated copy. Our encoders are checked by round tripping
+	** through the matching decoder. These are kicked off by a debug hotkey in AppUpdate and print their results to the console
+*/
+
+// A small .osm file with a long literal run (the header), long and self-overlapping matches (the A's) and some multi-byte UTF-8
+const char CodecCheckText[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<osm version=\"0.6\" generator=\"Cosm codec check\">\n"
+	" <node id=\"1000\" lat=\"47.6060595\" lon=\"-122.3321708\" version=\"1\"/>\n"
+	" <node id=\"1003\" lat=\"47.6061012\" lon=\"-122.3322031\" version=\"2\"/>\n"
+	" <node id=\"1006\" lat=\"47.6060345\" lon=\"-122.3321677\" version=\"3\"/>\n"
+	" <node id=\"1009\" lat=\"47.6061595\" lon=\"-122.3322647\" version=\"4\"/>\n"
+	" <node id=\"1012\" lat=\"47.6061761\" lon=\"-122.3322940\" version=\"1\"/>\n"
+	" <node id=\"1015\" lat=\"47.6060843\" lon=\"-122.3322556\" version=\"2\"/>\n"
+	" <node id=\"1018\" lat=\"47.6061842\" lon=\"-122.3323496\" version=\"3\"/>\n"
+	" <node id=\"1021\" lat=\"47.6061757\" lon=\"-122.3323759\" version=\"4\"/>\n"
+	" <node id=\"1024\" lat=\"47.6060588\" lon=\"-122.3323345\" version=\"1\"/>\n"
+	" <node id=\"1027\" lat=\"47.6061336\" lon=\"-122.3324255\" version=\"2\"/>\n"
+	" <node id=\"1030\" lat=\"47.6061000\" lon=\"-122.3324488\" version=\"3\"/>\n"
+	" <node id=\"1033\" lat=\"47.6059580\" lon=\"-122.3324044\" version=\"4\"/>\n"
+	" <way id=\"2000\" version=\"1\">\n"
+	"  <nd ref=\"1000\"/>\n"
+	"  <nd ref=\"1003\"/>\n"
+	"  <nd ref=\"1006\"/>\n"
+	"  <nd ref=\"1009\"/>\n"
+	"  <nd ref=\"1012\"/>\n"
+	"  <nd ref=\"1015\"/>\n"
+	"  <nd ref=\"1018\"/>\n"
+	"  <nd ref=\"1021\"/>\n"
+	"  <nd ref=\"1024\"/>\n"
+	"  <nd ref=\"1027\"/>\n"
+	"  <nd ref=\"1030\"/>\n"
+	"  <nd ref=\"1033\"/>\n"
+	"  <tag k=\"highway\" v=\"residential\"/>\n"
+	"  <tag k=\"name\" v=\"AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA\"/>\n"
+	"  <tag k=\"name:ja\" v=\"\xE6\x9D\xB1\xE4\xBA\xAC\xE9\x83\xBD\xE5\xBA\x81\"/>\n"
+	" </way>\n"
+	"</osm>\n";
+
+// +--------------------------------------------------------------+
+// |                          PBF Codecs                          |
+// +--------------------------------------------------------------+
+// lz4 -9 -B7 --no-frame-crc with the frame header, block size and end mark stripped off (lz4_data in a Blob is a bare LZ4 block)
+const u8 CodecCheckLz4[501] = {
+	0xF6, 0x1C, 0x3C, 0x3F, 0x78, 0x6D, 0x6C, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6F, 0x6E, 0x3D, 0x22, 0x31, 0x2E, 0x30, 0x22, 0x20, 0x65, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x3D, 0x22,
+	0x55, 0x54, 0x46, 0x2D, 0x38, 0x22, 0x3F, 0x3E, 0x0A, 0x3C, 0x6F, 0x73, 0x6D, 0x26, 0x00, 0xF0, 0x02, 0x30, 0x2E, 0x36, 0x22, 0x20, 0x67, 0x65, 0x6E, 0x65, 0x72, 0x61, 0x74, 0x6F, 0x72, 0x3D,
+	0x22, 0x43, 0x1E, 0x00, 0xF0, 0x22, 0x63, 0x6F, 0x64, 0x65, 0x63, 0x20, 0x63, 0x68, 0x65, 0x63, 0x6B, 0x22, 0x3E, 0x0A, 0x20, 0x3C, 0x6E, 0x6F, 0x64, 0x65, 0x20, 0x69, 0x64, 0x3D, 0x22, 0x31,
+	0x30, 0x30, 0x30, 0x22, 0x20, 0x6C, 0x61, 0x74, 0x3D, 0x22, 0x34, 0x37, 0x2E, 0x36, 0x30, 0x36, 0x30, 0x35, 0x39, 0x35, 0x22, 0x20, 0x6C, 0x4A, 0x00, 0xD7, 0x2D, 0x31, 0x32, 0x32, 0x2E, 0x33,
+	0x33, 0x32, 0x31, 0x37, 0x30, 0x38, 0x22, 0x87, 0x00, 0x2C, 0x22, 0x2F, 0x43, 0x00, 0x19, 0x33, 0x43, 0x00, 0x4B, 0x31, 0x30, 0x31, 0x32, 0x43, 0x00, 0x47, 0x32, 0x30, 0x33, 0x31, 0x43, 0x00,
+	0x1E, 0x32, 0x43, 0x00, 0x1A, 0x36, 0x86, 0x00, 0x2D, 0x33, 0x34, 0x86, 0x00, 0x37, 0x36, 0x37, 0x37, 0x43, 0x00, 0x1E, 0x33, 0x43, 0x00, 0x1A, 0x39, 0x86, 0x00, 0x0E, 0xC9, 0x00, 0x38, 0x32,
+	0x36, 0x34, 0x43, 0x00, 0x1D, 0x34, 0x43, 0x00, 0x2A, 0x31, 0x32, 0x43, 0x00, 0x3C, 0x37, 0x36, 0x31, 0x43, 0x00, 0x3F, 0x39, 0x34, 0x30, 0x0C, 0x01, 0x0A, 0x2A, 0x31, 0x35, 0xC9, 0x00, 0x3C,
+	0x38, 0x34, 0x33, 0x43, 0x00, 0x3F, 0x35, 0x35, 0x36, 0x0C, 0x01, 0x0A, 0x2A, 0x31, 0x38, 0x86, 0x00, 0x2C, 0x38, 0x34, 0x4F, 0x01, 0x4F, 0x33, 0x34, 0x39, 0x36, 0x0C, 0x01, 0x0A, 0x2B, 0x32,
+	0x31, 0xC9, 0x00, 0x2C, 0x35, 0x37, 0x43, 0x00, 0x3F, 0x37, 0x35, 0x39, 0x0C, 0x01, 0x0A, 0x2B, 0x32, 0x34, 0x18, 0x02, 0x2C, 0x38, 0x38, 0x43, 0x00, 0x01, 0xA5, 0x01, 0x0F, 0x0C, 0x01, 0x08,
+	0x2A, 0x32, 0x37, 0x86, 0x00, 0x3B, 0x33, 0x33, 0x36, 0x43, 0x00, 0x4F, 0x34, 0x32, 0x35, 0x35, 0x0C, 0x01, 0x0A, 0x2B, 0x33, 0x30, 0x5B, 0x02, 0x2C, 0x30, 0x30, 0x43, 0x00, 0x3F, 0x34, 0x38,
+	0x38, 0x0C, 0x01, 0x0A, 0x19, 0x33, 0x9E, 0x02, 0x4D, 0x35, 0x39, 0x35, 0x38, 0x43, 0x00, 0x3E, 0x30, 0x34, 0x34, 0x0C, 0x01, 0x31, 0x77, 0x61, 0x79, 0x42, 0x00, 0x3A, 0x32, 0x30, 0x30, 0xF3,
+	0x01, 0xB3, 0x3E, 0x0A, 0x20, 0x20, 0x3C, 0x6E, 0x64, 0x20, 0x72, 0x65, 0x66, 0x41, 0x03, 0x1C, 0x2F, 0x13, 0x00, 0x1E, 0x33, 0x13, 0x00, 0x1E, 0x36, 0x13, 0x00, 0x1D, 0x39, 0x13, 0x00, 0x2E,
+	0x31, 0x32, 0x13, 0x00, 0x1E, 0x35, 0x13, 0x00, 0x1D, 0x38, 0x13, 0x00, 0x2E, 0x32, 0x31, 0x13, 0x00, 0x1E, 0x34, 0x13, 0x00, 0x1D, 0x37, 0x13, 0x00, 0x1E, 0x33, 0xBE, 0x00, 0x14, 0x33, 0xBE,
+	0x00, 0xFA, 0x0F, 0x74, 0x61, 0x67, 0x20, 0x6B, 0x3D, 0x22, 0x68, 0x69, 0x67, 0x68, 0x77, 0x61, 0x79, 0x22, 0x20, 0x76, 0x3D, 0x22, 0x72, 0x65, 0x73, 0x69, 0x64, 0x65, 0x6E, 0x74, 0x69, 0x61,
+	0x6C, 0x25, 0x00, 0x41, 0x6E, 0x61, 0x6D, 0x65, 0x22, 0x00, 0x1F, 0x41, 0x01, 0x00, 0x46, 0x0E, 0x71, 0x00, 0x31, 0x3A, 0x6A, 0x61, 0x74, 0x00, 0xC2, 0xE6, 0x9D, 0xB1, 0xE4, 0xBA, 0xAC, 0xE9,
+	0x83, 0xBD, 0xE5, 0xBA, 0x81, 0xBD, 0x01, 0xD0, 0x2F, 0x77, 0x61, 0x79, 0x3E, 0x0A, 0x3C, 0x2F, 0x6F, 0x73, 0x6D, 0x3E, 0x0A,
+};
+
+// xz --format=lzma, an "LZMA alone" stream with an unknown size in the header and an end marker
+const u8 CodecCheckLzma[374] = {
+	0x5D, 0x00, 0x00, 0x80, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x1E, 0x0F, 0xCB, 0x87, 0x11, 0xD8, 0xCE, 0x66, 0x91, 0x0F, 0x83, 0x1E, 0xCA, 0xFD, 0x7B, 0x33, 0xD4, 0x7F,
+	0xE9, 0xB7, 0xDA, 0x28, 0x31, 0x76, 0x25, 0x66, 0x20, 0x4D, 0x2A, 0x09, 0x6D, 0x6A, 0xF7, 0x29, 0x70, 0x38, 0x30, 0xE7, 0xCC, 0x1D, 0x56, 0x17, 0x51, 0xDC, 0x55, 0xAF, 0x5B, 0xDA, 0xB1, 0xFC,
+	0xED, 0x89, 0x1E, 0x68, 0xA4, 0x13, 0xEB, 0xA7, 0x52, 0x14, 0xCF, 0x36, 0x8A, 0x47, 0x35, 0x72, 0xC5, 0xB0, 0xBF, 0xCB, 0x1A, 0x20, 0xCB, 0xD9, 0x53, 0xDF, 0x2D, 0x30, 0x97, 0xAA, 0xC9, 0x93,
+	0xC9, 0x50, 0x4E, 0xC6, 0x4A, 0x04, 0x38, 0x8E, 0xD9, 0x09, 0xFF, 0x52, 0xA5, 0xE9, 0xC0, 0x87, 0x44, 0x5A, 0xDB, 0x2A, 0xF1, 0xD0, 0x33, 0xBF, 0x4B, 0x7C, 0x8D, 0x33, 0x7E, 0x99, 0x03, 0x9E,
+	0x09, 0x85, 0x3F, 0xE9, 0xF1, 0xDB, 0x4C, 0xB2, 0x83, 0x11, 0x8E, 0x71, 0x4A, 0xBB, 0xA6, 0xB8, 0xD0, 0x89, 0x98, 0x9A, 0x0B, 0x3D, 0x70, 0x1F, 0x80, 0x84, 0x72, 0x01, 0x15, 0x1C, 0x6F, 0x0E,
+	0x09, 0x4B, 0xD9, 0x2D, 0xEA, 0x60, 0xD2, 0x08, 0x50, 0x1D, 0xE1, 0x20, 0x0D, 0x86, 0xCD, 0xF4, 0xEE, 0x6C, 0x33, 0xD4, 0xA4, 0x01, 0x6F, 0x96, 0x5E, 0x07, 0xB2, 0xA4, 0x04, 0x17, 0x95, 0x80,
+	0x8B, 0x28, 0x98, 0x5E, 0x95, 0x65, 0xC4, 0xCF, 0x42, 0xCB, 0xDD, 0x0A, 0x9A, 0x70, 0xD1, 0xC7, 0x4A, 0xE6, 0x07, 0xB3, 0x98, 0x63, 0x24, 0xDB, 0xF1, 0x94, 0x34, 0xDC, 0x2F, 0x89, 0x95, 0x5D,
+	0x48, 0x51, 0xE5, 0x4F, 0x7C, 0x36, 0xE3, 0x3C, 0x3A, 0xF7, 0x1A, 0xC9, 0xBD, 0x48, 0xB5, 0xAC, 0xDD, 0x44, 0x5F, 0x54, 0xE2, 0x88, 0x5A, 0xA3, 0x09, 0x0E, 0xE4, 0xB5, 0x4A, 0xAC, 0x41, 0x64,
+	0xCF, 0x2E, 0x56, 0xD9, 0xCA, 0xA5, 0xCB, 0x8B, 0xC9, 0xCA, 0x91, 0x4B, 0x03, 0x11, 0xD0, 0xAB, 0x0E, 0xB5, 0x3C, 0xF6, 0x96, 0x70, 0xE2, 0xD8, 0x80, 0x1B, 0x6C, 0xE0, 0x68, 0x6C, 0xF0, 0x69,
+	0x65, 0xAD, 0xFF, 0xE6, 0x9E, 0x76, 0xD2, 0x2C, 0xDE, 0xE3, 0xA9, 0xF3, 0x3C, 0xCA, 0xD0, 0x80, 0xC7, 0xCA, 0x84, 0xBA, 0x34, 0x60, 0xF7, 0xC1, 0xBA, 0xBB, 0x8F, 0x19, 0x37, 0x58, 0x5C, 0x82,
+	0x89, 0xB0, 0x0F, 0x23, 0x22, 0xF3, 0x14, 0xF7, 0x41, 0xCC, 0xD6, 0x94, 0xFE, 0xCE, 0xC0, 0xFD, 0xCA, 0x61, 0xAB, 0x70, 0x0E, 0x4D, 0x63, 0x9F, 0xB4, 0x92, 0x2A, 0x77, 0x3D, 0x2B, 0x7C, 0xE1,
+	0xF4, 0x2B, 0x02, 0xC6, 0x9A, 0xCC, 0x62, 0x8F, 0xAA, 0xD3, 0x4B, 0x11, 0x4D, 0xA2, 0xB4, 0xFF, 0x9D, 0xFF, 0x54, 0x40, 0x32, 0x00,
+};
+
+// Decompresses the fixture with the PbfCodecTable entry for codec and compares it against CodecCheckText, then makes sure a truncated copy fails
+bool CheckPbfCodecFixture(PbfCodec codec, uxx compressedSize, const u8* compressedBytes)
+{
+	ScratchBegin(scratch);
+	const PbfCodecInfo* codecInfo = GetPbfCodecInfo(codec);
+	NotNull(codecInfo->Decompress);
+	Str8 expected = MakeStr8(ArrayCount(CodecCheckText)-1, (char*)CodecCheckText);
+	Slice decompressed = codecInfo->Decompress(scratch, MakeSlice(compressedSize, (u8*)compressedBytes), expected.length);
+	bool decodedCorrectly = (decompressed.bytes != nullptr && decompressed.length == expected.length && MyMemEquals(decompressed.bytes, expected.chars, expected.length));
+	Slice truncated = codecInfo->Decompress(scratch, MakeSlice(compressedSize/2, (u8*)compressedBytes), expected.length);
+	bool rejectedTruncated = (truncated.bytes == nullptr);
+	bool result = (decodedCorrectly && rejectedTruncated);
+	PrintLineAt(result ? DbgLevel_Info : DbgLevel_Error, "  %-5s %llu->%llu bytes: %s",
+		GetPbfCodecStr(codec), compressedSize, expected.length,
+		result ? "Passed" : (decodedCorrectly ? "FAILED (accepted truncated data)" : "FAILED (output doesn't match)")
+	);
+	ScratchEnd(scratch);
+	return result;
+}
+
+// Fills bytesOut with a deterministic mix of incompressible runs, copies of earlier bytes (near and far) and long runs of a single byte.
+// Big inputs made this way span several of the deflate encoder's blocks. isIncompressible leaves out everything but the first kind of
+// run so the deflate encoder has to fall back to stored blocks
+void FillCodecCheckNoise(u64 seed, uxx numBytes, bool isIncompressible, u8* bytesOut)
+{
+	u64 state = (seed != 0) ? seed : 1;
+	uxx bIndex = 0;
+	while (bIndex < numBytes)
+	{
+		state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+		uxx runLength = MinUXX(1 + (uxx)((state >> 8) % 300), numBytes - bIndex);
+		uxx runKind = (uxx)(state % 3);
+		if (runKind == 0 || bIndex == 0 || isIncompressible)
+		{
+			for (uxx rIndex = 0; rIndex < runLength; rIndex++) { state ^= state << 13; state ^= state >> 7; state ^= state << 17; bytesOut[bIndex + rIndex] = (u8)state; }
+		}
+		else if (runKind == 1)
+		{
+			uxx distance = 1 + (uxx)((state >> 24) % MinUXX(bIndex, DEFLATE_WINDOW_SIZE + 1000)); //sometimes further back than deflate can reach
+			for (uxx rIndex = 0; rIndex < runLength; rIndex++) { bytesOut[bIndex + rIndex] = bytesOut[bIndex + rIndex - distance]; }
+		}
+		else { MyMemSet(&bytesOut[bIndex], (u8)(state >> 40) & 0x03, runLength); }
+		bIndex += runLength;
+	}
+}
+
+// Compresses rawData with the PbfCodecTable entry for codec and makes sure the decompressor gives back exactly rawData
+bool CheckPbfCodecRoundTrip(PbfCodec codec, const char* inputName, Slice rawData)
+{
+	ScratchBegin(scratch);
+	const PbfCodecInfo* codecInfo = GetPbfCodecInfo(codec);
+	NotNull(codecInfo->Compress);
+	NotNull(codecInfo->Decompress);
+	Slice compressed = codecInfo->Compress(scratch, rawData);
+	Slice decompressed = (compressed.bytes != nullptr) ? codecInfo->Decompress(scratch, compressed, rawData.length) : Slice_Empty;
+	bool result = (decompressed.bytes != nullptr && decompressed.length == rawData.length && MyMemEquals(decompressed.bytes, rawData.bytes, rawData.length));
+	PrintLineAt(result ? DbgLevel_Info : DbgLevel_Error, "  %-5s round trip %s %llu->%llu bytes: %s",
+		GetPbfCodecStr(codec), inputName, rawData.length, compressed.length,
+		result ? "Passed" : "FAILED (output doesn't match)"
+	);
+	ScratchEnd(scratch);
+	return result;
+}
+
+// +--------------------------------------------------------------+
+// |                        Stream Codecs                         |
+// +--------------------------------------------------------------+
+// gzip -9 -n of the first 600 bytes followed by gzip -9 -n of the rest, two members like pigz or bgzip would write
+const u8 CodecCheckGzip[494] = {
+	0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7D, 0xD0, 0xCB, 0xAA, 0xC2, 0x30, 0x10, 0x06, 0xE0, 0xBD, 0x4F, 0x11, 0x66, 0x6F, 0x9D, 0xC9, 0x65, 0x92, 0x42, 0xAB, 0x8B, 0x03,
+	0x3E, 0xC1, 0x39, 0x0F, 0x20, 0x35, 0x68, 0x51, 0x53, 0xA8, 0x22, 0x3E, 0xBE, 0xF1, 0x6C, 0xCC, 0x05, 0xBA, 0x4C, 0x32, 0xF9, 0xF8, 0xE7, 0xEF, 0x76, 0xAF, 0xDB, 0x55, 0x3C, 0xFD, 0x7C, 0x1F,
+	0xA7, 0xD0, 0x03, 0x35, 0x08, 0xC2, 0x87, 0x61, 0x3A, 0x8E, 0xE1, 0xD4, 0xC3, 0xDF, 0xEF, 0x7E, 0xED, 0x60, 0xB7, 0x5D, 0x75, 0xD3, 0xFD, 0xF6, 0x9D, 0xC2, 0x86, 0x41, 0x9C, 0x7C, 0xF0, 0xF3,
+	0xE1, 0x31, 0xCD, 0x3D, 0xFC, 0x7C, 0x5E, 0xE3, 0x1F, 0x3F, 0x88, 0xE1, 0xEC, 0x87, 0x0B, 0x6C, 0x57, 0xA2, 0x0B, 0xF1, 0x2C, 0xC6, 0x63, 0x34, 0x11, 0x23, 0x7A, 0x3D, 0x3C, 0x7A, 0xD0, 0xB6,
+	0x61, 0x64, 0x34, 0xAD, 0x89, 0x17, 0x1F, 0x69, 0x4D, 0x52, 0x36, 0x4A, 0x49, 0xB2, 0xE8, 0x20, 0x89, 0x01, 0x9B, 0x92, 0x50, 0x19, 0x41, 0x48, 0xB2, 0x20, 0x24, 0x2A, 0x4A, 0x08, 0x59, 0x13,
+	0x9C, 0xA7, 0x50, 0xBA, 0x4A, 0xC1, 0xD6, 0x26, 0x84, 0xAA, 0x89, 0x36, 0x4F, 0x51, 0x2F, 0x22, 0x59, 0xA7, 0x84, 0xAE, 0x88, 0xFF, 0xDC, 0x09, 0x61, 0x99, 0x4A, 0xA2, 0xD5, 0xB8, 0xD8, 0x05,
+	0x99, 0x7C, 0x11, 0xA7, 0x55, 0x49, 0x18, 0xC3, 0x8B, 0x5D, 0x90, 0xCB, 0x53, 0x38, 0x5D, 0xD6, 0xA9, 0x74, 0xCB, 0x8B, 0x5D, 0x48, 0x2A, 0x16, 0x31, 0x36, 0x21, 0xDE, 0x4F, 0xA1, 0x6E, 0x58,
+	0x58, 0x02, 0x00, 0x00, 0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xB5, 0x91, 0x4D, 0x6E, 0x83, 0x30, 0x10, 0x46, 0xF7, 0x9C, 0xC2, 0xF2, 0x3E, 0x60, 0xCF, 0xD8, 0xFC, 0x54,
+	0x01, 0xA9, 0x47, 0xB1, 0x84, 0x43, 0xDC, 0x26, 0x20, 0x01, 0x6A, 0x94, 0x65, 0xD4, 0x73, 0xF4, 0x06, 0xDD, 0x74, 0x8B, 0xD4, 0xDB, 0xB4, 0x95, 0x7A, 0x8B, 0x18, 0xA2, 0x54, 0xC0, 0xAC, 0xCB,
+	0xF2, 0xCD, 0xE8, 0x7D, 0x9F, 0x87, 0x10, 0x11, 0x30, 0xD1, 0x19, 0x67, 0x2F, 0xB6, 0xED, 0x5C, 0x53, 0xE7, 0x5C, 0xF1, 0xA8, 0x08, 0xD8, 0xB6, 0x6E, 0x4A, 0xCB, 0x5C, 0x99, 0x73, 0x29, 0x40,
+	0x71, 0x76, 0x30, 0xBD, 0x1F, 0x25, 0x61, 0x2C, 0x62, 0xA1, 0xD3, 0xD4, 0x83, 0x71, 0x77, 0x23, 0x01, 0xC2, 0x51, 0x81, 0x4A, 0xCF, 0x14, 0x92, 0x2A, 0x92, 0x85, 0x42, 0x22, 0xC6, 0x2B, 0x85,
+	0x02, 0x3D, 0x57, 0x00, 0x51, 0xA0, 0x58, 0x2A, 0x84, 0x10, 0x6B, 0x85, 0x1A, 0x8B, 0xFD, 0x29, 0x90, 0x2A, 0x70, 0xAE, 0xD0, 0x99, 0x4E, 0x89, 0x42, 0x28, 0x45, 0x6F, 0x71, 0x32, 0xE7, 0xC9,
+	0x00, 0x53, 0xE6, 0xEC, 0x99, 0x7E, 0xE8, 0x03, 0x4A, 0xD6, 0xDA, 0xDD, 0xE8, 0xF7, 0xD3, 0x68, 0x8D, 0x90, 0xA2, 0x98, 0xA2, 0x8C, 0x20, 0x09, 0x14, 0x69, 0x8A, 0x52, 0x82, 0x40, 0x52, 0xA4,
+	0x28, 0x4A, 0x08, 0x42, 0xDA, 0x1E, 0xEF, 0xED, 0x7B, 0x53, 0xB1, 0xE7, 0x9C, 0xEF, 0x5D, 0xB5, 0xF7, 0xC7, 0xF0, 0x37, 0xC8, 0x79, 0x6B, 0x3B, 0x57, 0xDA, 0xBA, 0x77, 0xE6, 0xB0, 0x5C, 0xAA,
+	0xCD, 0xD1, 0x4E, 0x1B, 0x8F, 0xFF, 0xF6, 0xD1, 0xC0, 0x87, 0x27, 0x33, 0x65, 0xFE, 0xBC, 0x7D, 0x7C, 0x0D, 0xEF, 0xBF, 0xAF, 0x9F, 0xDF, 0xC3, 0xE5, 0xF6, 0xF3, 0x22, 0x5F, 0xB8, 0x08, 0xB6,
+	0x51, 0xD3, 0x1D, 0x8B, 0xE0, 0x0A, 0xF7, 0x62, 0x77, 0x5A, 0xF0, 0x02, 0x00, 0x00,
+};
+
+// bzip2 -9
+const u8 CodecCheckBzip2[450] = {
+	0x42, 0x5A, 0x68, 0x39, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0xC0, 0x35, 0xF9, 0x5D, 0x00, 0x01, 0x63, 0xDF, 0xF9, 0x00, 0x10, 0x50, 0x03, 0xFF, 0xF7, 0xA9, 0x00, 0x07, 0x00, 0x2F, 0xFF, 0x9D,
+	0xE0, 0x28, 0x00, 0x00, 0x02, 0x00, 0x04, 0x20, 0x12, 0x07, 0x20, 0x40, 0x01, 0xBD, 0x91, 0x73, 0x03, 0x0D, 0x0D, 0x00, 0x00, 0x01, 0xA0, 0x00, 0x00, 0x00, 0x06, 0x82, 0x06, 0xA0, 0xA3, 0x4F,
+	0x0A, 0x7A, 0x98, 0x26, 0x34, 0x8D, 0x0C, 0x43, 0x4C, 0x4C, 0x01, 0xA7, 0xA9, 0x44, 0x6D, 0x40, 0x00, 0x00, 0x00, 0x01, 0xA0, 0x00, 0x04, 0x51, 0x08, 0x99, 0x00, 0x9A, 0x4F, 0x49, 0xA3, 0xD2,
+	0x69, 0xA0, 0xF5, 0x03, 0x4F, 0x20, 0x9A, 0x0F, 0xD5, 0x37, 0x00, 0x10, 0x01, 0x20, 0xC0, 0x30, 0xC7, 0x0E, 0x36, 0x3B, 0x41, 0xE7, 0xF0, 0x68, 0x03, 0xDC, 0x0C, 0x36, 0x80, 0xFA, 0x41, 0x01,
+	0xE1, 0x65, 0x47, 0x5A, 0xD8, 0x6E, 0xB6, 0xEB, 0x7C, 0xEE, 0x88, 0x48, 0x23, 0x9C, 0xE8, 0x45, 0x8F, 0x06, 0x0B, 0xE2, 0xE6, 0x36, 0x8A, 0xC9, 0x1E, 0x93, 0xD1, 0x8C, 0x02, 0x95, 0x31, 0x7D,
+	0x2C, 0xD3, 0x34, 0xCC, 0xDE, 0x37, 0xEE, 0x8C, 0xCF, 0x92, 0xAA, 0xAA, 0xAA, 0xAD, 0x20, 0x10, 0x27, 0x7C, 0xCE, 0xA0, 0x0A, 0x80, 0x2B, 0xDF, 0x20, 0x0A, 0x8D, 0x20, 0xD9, 0x47, 0xB4, 0xEC,
+	0xAE, 0x8C, 0x67, 0x44, 0x14, 0xBA, 0x43, 0x03, 0x08, 0x04, 0x92, 0x09, 0x83, 0xA2, 0xE8, 0x6A, 0x42, 0x98, 0xC4, 0x96, 0x9B, 0xE6, 0xF1, 0xA4, 0x01, 0x10, 0xAD, 0x5E, 0xC0, 0x69, 0x24, 0x54,
+	0x82, 0x48, 0xCC, 0x66, 0x8B, 0x9B, 0x03, 0x11, 0x62, 0xF2, 0xA0, 0xC2, 0xC9, 0x0D, 0xAA, 0x50, 0x8A, 0x4D, 0x22, 0x6C, 0xCB, 0x20, 0xC1, 0x88, 0x36, 0xBA, 0x95, 0xA4, 0x41, 0x74, 0x5C, 0x55,
+	0xA4, 0xE6, 0x70, 0x48, 0x06, 0x80, 0x05, 0x15, 0x92, 0x48, 0x1D, 0x6B, 0x10, 0x94, 0x3D, 0x90, 0xDE, 0x73, 0x9C, 0xA1, 0x05, 0x01, 0xC0, 0x11, 0xC0, 0xC9, 0xA4, 0x90, 0x9B, 0x1C, 0x22, 0x12,
+	0x68, 0xD4, 0x09, 0xE5, 0x08, 0x0F, 0x46, 0x73, 0xC6, 0xF2, 0x3B, 0x90, 0x76, 0x8A, 0xDE, 0x0C, 0x20, 0x92, 0x60, 0x4B, 0x72, 0x64, 0xB0, 0x6B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x67, 0x13,
+	0x4A, 0x93, 0x72, 0x97, 0x2D, 0xF6, 0x89, 0x5C, 0xD0, 0xCC, 0xC4, 0x03, 0xEF, 0xEE, 0xF9, 0xD7, 0x84, 0x71, 0x63, 0xEB, 0xF6, 0x9A, 0x77, 0xEA, 0x7B, 0xF6, 0x1C, 0x41, 0xDB, 0xCD, 0xEA, 0xDF,
+	0x11, 0x64, 0x6E, 0x47, 0x92, 0x31, 0x1B, 0xC1, 0xDA, 0x47, 0x2C, 0x01, 0xBF, 0xAA, 0xB9, 0xB7, 0xAB, 0x6C, 0x41, 0xFB, 0xB5, 0xBF, 0x3F, 0xE3, 0xA3, 0x1D, 0x96, 0x47, 0x9E, 0x9D, 0x32, 0xAF,
+	0x2C, 0xD6, 0x75, 0xE8, 0x90, 0x1B, 0x32, 0x78, 0x6D, 0x51, 0xD0, 0x6B, 0xF5, 0x83, 0x1A, 0xE4, 0x19, 0xD8, 0x0E, 0x73, 0xA4, 0x1B, 0x2B, 0xB3, 0xC2, 0xFE, 0x18, 0xE1, 0xA8, 0x1C, 0xF2, 0x01,
+	0xD2, 0xAD, 0x5D, 0x40, 0xDE, 0xE9, 0x9B, 0xC4, 0x29, 0xBB, 0x0F, 0x6D, 0x9F, 0x4C, 0xB2, 0x9F, 0x4C, 0xB2, 0xFE, 0x7F, 0xB2, 0xDD, 0x97, 0xFC, 0x5D, 0xC9, 0x14, 0xE1, 0x42, 0x43, 0x00, 0xD7,
+	0xE5, 0x74,
+};
+
+// Runs compressedData through a StreamDecoder on this thread (the same path TryParseOsmCompressedMap takes) and compares the chunks against expected
+bool DoesStreamDecoderMatch(Arena* arena, StreamCodec codec, Slice compressedData, Str8 expected)
+{
+	StreamDecoder decoder = ZEROED;
+	InitStreamDecoder(arena, codec, compressedData, nullptr, nullptr, &decoder);
+	bool result = true;
+	uxx numMatched = 0;
+	Slice chunk = Slice_Empty;
+	while (result && NextStreamDecoderChunk(&decoder, &chunk))
+	{
+		if (chunk.length > expected.length - numMatched || !MyMemEquals(chunk.bytes, &expected.chars[numMatched], chunk.length)) { result = false; }
+		numMatched += chunk.length;
+	}
+	if (decoder.error != Result_None || numMatched != expected.length) { result = false; }
+	FreeStreamDecoder(&decoder);
+	return result;
+}
+
+// Decodes the fixture and compares it against CodecCheckText, then makes sure a truncated copy fails
+bool CheckStreamCodecFixture(StreamCodec codec, uxx compressedSize, const u8* compressedBytes)
+{
+	ScratchBegin(scratch);
+	Str8 expected = MakeStr8(ArrayCount(CodecCheckText)-1, (char*)CodecCheckText);
+	bool decodedCorrectly = DoesStreamDecoderMatch(scratch, codec, MakeSlice(compressedSize, (u8*)compressedBytes), expected);
+	bool rejectedTruncated = !DoesStreamDecoderMatch(scratch, codec, MakeSlice(compressedSize/2, (u8*)compressedBytes), expected);
+	bool result = (decodedCorrectly && rejectedTruncated);
+	PrintLineAt(result ? DbgLevel_Info : DbgLevel_Error, "  %-5s %llu->%llu bytes: %s",
+		GetStreamCodecStr(codec), compressedSize, expected.length,
+		result ? "Passed" : (decodedCorrectly ? "FAILED (accepted truncated data)" : "FAILED (output doesn't match)")
+	);
+	ScratchEnd(scratch);
+	return result;
+}
+
+// Returns true if every check passed
+bool RunCodecChecks()
+{
+	PrintLine_I("Checking our codecs against the reference compressed fixtures...");
+	bool result = true;
+	if (!CheckPbfCodecFixture(PbfCodec_Lz4, ArrayCount(CodecCheckLz4), &CodecCheckLz4[0])) { result = false; }
+	if (!CheckPbfCodecFixture(PbfCodec_Lzma, ArrayCount(CodecCheckLzma), &CodecCheckLzma[0])) { result = false; }
+	if (!CheckStreamCodecFixture(StreamCodec_Gzip, ArrayCount(CodecCheckGzip), &CodecCheckGzip[0])) { result = false; }
+	if (!CheckStreamCodecFixture(StreamCodec_Bzip2, ArrayCount(CodecCheckBzip2), &CodecCheckBzip2[0])) { result = false; }
+	
+	//NOTE: The deflate encoder is only checked against our own (PigCore's) inflate, the reference zlib isn't available in the app
+	{
+		ScratchBegin(scratch);
+		const uxx noiseSize = Megabytes(1);
+		u8* noiseBytes = AllocArray(u8, scratch, noiseSize);
+		NotNull(noiseBytes);
+		if (!CheckPbfCodecRoundTrip(PbfCodec_Zlib, "text", MakeSlice(ArrayCount(CodecCheckText)-1, (u8*)CodecCheckText))) { result = false; }
+		FillCodecCheckNoise(1234, noiseSize, false, noiseBytes);
+		if (!CheckPbfCodecRoundTrip(PbfCodec_Zlib, "noise", MakeSlice(noiseSize, noiseBytes))) { result = false; }
+		FillCodecCheckNoise(5678, noiseSize, true, noiseBytes);
+		if (!CheckPbfCodecRoundTrip(PbfCodec_Zlib, "random", MakeSlice(noiseSize, noiseBytes))) { result = false; }
+		ScratchEnd(scratch);
+	}
+	if (result) { PrintLine_I("All codec checks passed"); }
+	else { NotifyPrint_E("Some codec checks failed! See the console for details"); }
+	return result;
+}
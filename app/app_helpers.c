@@ -288,8 +288,9 @@ void SetMapItemSelected(OsmMap* map, OsmPrimitiveType type, void* itemPntr, bool
 	NotNull(map);
 	NotNull(itemPntr);
 	u64 itemId = 0;
-	if (type == OsmPrimitiveType_Node) { itemId = ((OsmNode*)itemPntr)->id; }
-	else if (type == OsmPrimitiveType_Way) { itemId = ((OsmWay*)itemPntr)->id; }
+	u32 itemIndex = OSM_INVALID_INDEX;
+	if (type == OsmPrimitiveType_Node) { itemId = ((OsmNode*)itemPntr)->id; itemIndex = GetOsmNodeIndex(map, (OsmNode*)itemPntr); }
+	else if (type == OsmPrimitiveType_Way) { itemId = ((OsmWay*)itemPntr)->id; itemIndex = (u32)((OsmWay*)itemPntr - (OsmWay*)map->ways.items); }
 	else { Assert(false); }
 	
 	bool isAlreadySelected = false;
@@ -313,15 +314,15 @@ void SetMapItemSelected(OsmMap* map, OsmPrimitiveType type, void* itemPntr, bool
 		ClearPointer(newSelectedItem);
 		newSelectedItem->type = type;
 		newSelectedItem->id = itemId;
-		newSelectedItem->pntr = itemPntr;
-		if (type == OsmPrimitiveType_Node) { ((OsmNode*)itemPntr)->isSelected = true; }
+		newSelectedItem->index = itemIndex;
+		if (type == OsmPrimitiveType_Node) { FlagSet(*GetOsmNodeFlags(map, (OsmNode*)itemPntr), (u8)OsmNodeFlag_Selected); }
 		else if (type == OsmPrimitiveType_Way) { ((OsmWay*)itemPntr)->isSelected = true; }
 		else { Assert(false); }
 	}
 	else
 	{
 		if (!isAlreadySelected) { return; }
-		if (type == OsmPrimitiveType_Node) { ((OsmNode*)itemPntr)->isSelected = false; }
+		if (type == OsmPrimitiveType_Node) { FlagUnset(*GetOsmNodeFlags(map, (OsmNode*)itemPntr), (u8)OsmNodeFlag_Selected); }
 		else if (type == OsmPrimitiveType_Way) { ((OsmWay*)itemPntr)->isSelected = false; }
 		else { Assert(false); }
 		VarArrayRemoveAt(OsmSelectedItem, &map->selectedItems, selectedItemIndex);
@@ -335,8 +336,8 @@ void ClearMapSelection(OsmMap* map)
 	VarArrayLoop(&map->selectedItems, sIndex)
 	{
 		VarArrayLoopGet(OsmSelectedItem, selectedItem, &map->selectedItems, sIndex);
-		if (selectedItem->type == OsmPrimitiveType_Node) { selectedItem->nodePntr->isSelected = false; }
-		else if (selectedItem->type == OsmPrimitiveType_Way) { selectedItem->wayPntr->isSelected = false; }
+		if (selectedItem->type == OsmPrimitiveType_Node) { FlagUnset(*VarArrayGet(u8, &map->nodeFlags, selectedItem->index), (u8)OsmNodeFlag_Selected); }
+		else if (selectedItem->type == OsmPrimitiveType_Way) { GetOsmWayByIndex(map, selectedItem->index)->isSelected = false; }
 	}
 	VarArrayClear(&map->selectedItems);
 }
@@ -347,8 +348,8 @@ void FindInternationalCodepointsInMapNames(OsmMap* map, VarArray* codepointsOut)
 	VarArrayLoop(&map->nodes, nIndex)
 	{
 		VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
-		Str8 nameStr = GetOsmNodeTagValue(node, StrLit("name:ja"), Str8_Empty);
-		if (IsEmptyStr(nameStr)) { nameStr = GetOsmNodeTagValue(node, StrLit("name"), Str8_Empty); }
+		Str8 nameStr = GetOsmNodeTagValue(map, node, StrLit("name:ja"), Str8_Empty);
+		if (IsEmptyStr(nameStr)) { nameStr = GetOsmNodeTagValue(map, node, StrLit("name"), Str8_Empty); }
 		for (uxx bIndex = 0; bIndex < nameStr.length; bIndex++)
 		{
 			u32 codepoint = 0;
@@ -372,126 +373,163 @@ void FindInternationalCodepointsInMapNames(OsmMap* map, VarArray* codepointsOut)
 	}
 }
 
-Result TryParseMapFile(Arena* arena, FilePath filePath, OsmMap* mapOut)
+// options can be nullptr for the default behavior (see OsmLoadOptions). The details of a failure are only printed to the
+// console, the caller decides whether the user should get a notification (this runs on app->loaderPool's thread for MapLoader)
+Result TryParseMapFile(Arena* arena, FilePath filePath, const OsmLoadOptions* options, OsmMap* mapOut)
 {
 	ScratchBegin1(scratch, arena);
 	Result parseResult = Result_None;
 	
 	if (StrAnyCaseEndsWith(filePath, StrLit(".pbf")))
 	{
-		#if 1
-		OsFile pbfFile = ZEROED;
-		TracyCZoneN(_OsOpenFile, "OsOpenFile", true);
-		bool openedSelectedFile = OsOpenFile(scratch, filePath, OsOpenFileMode_Read, false, &pbfFile);
-		TracyCZoneEnd(_OsOpenFile);
-		if (openedSelectedFile)
+		MappedFile mappedFile = ZEROED;
+		bool allowMapping = (options == nullptr || !options->disableMemoryMapping);
+		if (allowMapping && TryOpenMappedFile(filePath, &mappedFile))
 		{
-			PrintLine_I("Opened binary \"%.*s\"", StrPrint(filePath));
-			DataStream fileStream = ToDataStreamFromFile(&pbfFile);
-			parseResult = TryParsePbfMap(stdHeap, &fileStream, mapOut);
-			OsCloseFile(&pbfFile);
-			if (parseResult != Result_Success) { NotifyPrint_E("Failed to parse as OpenStreetMaps Protobuf data! Error: %s", GetResultStr(parseResult)); }
+			PrintLine_I("Mapped binary \"%.*s\", %llu bytes", StrPrint(filePath), mappedFile.size);
+			
+			//NOTE: The first unfiltered load of a file writes a blob index next to it, later filtered loads use it to skip blobs.
+			//      The index lives in stdHeap since the Merge stage grows it while the pipeline is using our scratch arenas
+			OsmLoadOptions indexedOptions = ZEROED;
+			if (options != nullptr) { MyMemCopy(&indexedOptions, options, sizeof(OsmLoadOptions)); }
+			bool isFiltered = (indexedOptions.useBoundsFilter || indexedOptions.tagFilter != nullptr);
+			bool handleBlobIndex = (!indexedOptions.disableBlobIndex && indexedOptions.blobIndex == nullptr && indexedOptions.buildBlobIndex == nullptr);
+			FilePath indexPath = JoinStringsInArena(scratch, filePath, StrLit(PBF_BLOB_INDEX_FILE_EXT), false);
+			PbfBlobIndex blobIndex = ZEROED;
+			if (handleBlobIndex)
+			{
+				Result indexResult = TryLoadPbfBlobIndex(stdHeap, indexPath, &mappedFile, &blobIndex);
+				if (indexResult == Result_Success)
+				{
+					PrintLine_D("Loaded blob index covering %llu blob%s", blobIndex.entries.length, Plural(blobIndex.entries.length, "s"));
+					//NOTE: Unfiltered loads read every blob anyway, but the index still tells the pipeline how big to make the OsmMap arrays
+					indexedOptions.blobIndex = &blobIndex;
+				}
+				else
+				{
+					if (indexResult != Result_FileNotFound) { PrintLine_W("Ignoring blob index \"%.*s\": %s", StrPrint(indexPath), GetResultStr(indexResult)); }
+					if (!isFiltered) { InitPbfBlobIndex(stdHeap, &blobIndex); indexedOptions.buildBlobIndex = &blobIndex; }
+				}
+			}
+			
+			SetOsmLoadProgressTotal(indexedOptions.progress, mappedFile.size, (indexedOptions.blobIndex != nullptr && !isFiltered) ? indexedOptions.blobIndex->entries.length : 0);
+			parseResult = TryParsePbfMappedFile(stdHeap, &mappedFile, &indexedOptions, mapOut);
+			CloseMappedFile(&mappedFile);
+			if (parseResult != Result_Success && parseResult != Result_Canceled) { PrintLine_E("Failed to parse as OpenStreetMaps Protobuf data! Error: %s", GetResultStr(parseResult)); }
+			else if (parseResult == Result_Success && indexedOptions.buildBlobIndex == &blobIndex && blobIndex.entries.length > 0)
+			{
+				if (SavePbfBlobIndex(indexPath, &blobIndex)) { PrintLine_I("Saved blob index covering %llu blob%s to \"%.*s\"", blobIndex.entries.length, Plural(blobIndex.entries.length, "s"), StrPrint(indexPath)); }
+				else { PrintLine_W("Failed to save blob index to \"%.*s\"", StrPrint(indexPath)); }
+			}
+			if (blobIndex.arena != nullptr) { FreePbfBlobIndex(&blobIndex); }
 		}
-		else { NotifyPrint_E("Failed to open \"%.*s\"", StrPrint(filePath)); }
-		#else
-		Slice fileContents = Slice_Empty;
-		TracyCZoneN(_ReadBinFile, "OsReadBinFile", true);
-		bool openedSelectedFile = OsReadBinFile(filePath, scratch, &fileContents);
-		TracyCZoneEnd(_ReadBinFile);
-		if (openedSelectedFile)
+		else
 		{
-			PrintLine_I("Opened binary \"%.*s\", %llu bytes", StrPrint(filePath), fileContents.length);
-			DataStream fileStream = ToDataStreamFromBuffer(fileContents);
-			parseResult = TryParsePbfMap(stdHeap, &fileStream, mapOut);
-			if (parseResult != Result_Success) { PrintLine_E("Failed to parse as OpenStreetMaps Protobuf data! Error: %s", GetResultStr(parseResult)); }
+			#if 1
+			OsFile pbfFile = ZEROED;
+			TracyCZoneN(_OsOpenFile, "OsOpenFile", true);
+			bool openedSelectedFile = OsOpenFile(scratch, filePath, OsOpenFileMode_Read, false, &pbfFile);
+			TracyCZoneEnd(_OsOpenFile);
+			if (openedSelectedFile)
+			{
+				PrintLine_I("Opened binary \"%.*s\"", StrPrint(filePath));
+				DataStream fileStream = ToDataStreamFromFile(&pbfFile);
+				parseResult = TryParsePbfMap(stdHeap, &fileStream, options, mapOut);
+				OsCloseFile(&pbfFile);
+				if (parseResult != Result_Success && parseResult != Result_Canceled) { PrintLine_E("Failed to parse as OpenStreetMaps Protobuf data! Error: %s", GetResultStr(parseResult)); }
+			}
+			else { PrintLine_E("Failed to open \"%.*s\"", StrPrint(filePath)); parseResult = Result_FailedToReadFile; }
+			#else
+			Slice fileContents = Slice_Empty;
+			TracyCZoneN(_ReadBinFile, "OsReadBinFile", true);
+			bool openedSelectedFile = OsReadBinFile(filePath, scratch, &fileContents);
+			TracyCZoneEnd(_ReadBinFile);
+			if (openedSelectedFile)
+			{
+				PrintLine_I("Opened binary \"%.*s\", %llu bytes", StrPrint(filePath), fileContents.length);
+				DataStream fileStream = ToDataStreamFromBuffer(fileContents);
+				parseResult = TryParsePbfMap(stdHeap, &fileStream, options, mapOut);
+				if (parseResult != Result_Success) { PrintLine_E("Failed to parse as OpenStreetMaps Protobuf data! Error: %s", GetResultStr(parseResult)); }
+			}
+			else { PrintLine_E("Failed to open \"%.*s\"", StrPrint(filePath)); parseResult = Result_FailedToReadFile; }
+			#endif
 		}
-		else { PrintLine_E("Failed to open \"%.*s\"", StrPrint(filePath)); }
-		#endif
 	}
-	else if (StrAnyCaseEndsWith(filePath, StrLit(".osm")))
+	else if (StrAnyCaseEndsWith(filePath, StrLit(".osm")) || StrAnyCaseEndsWith(filePath, StrLit(".osc")))
 	{
-		Str8 fileContents = Str8_Empty;
-		TracyCZoneN(_ReadTextFile, "OsReadTextFile", true);
-		bool openedSelectedFile = OsReadTextFile(filePath, scratch, &fileContents);
-		TracyCZoneEnd(_ReadTextFile);
-		if (openedSelectedFile)
+		if (options != nullptr && options->useBoundsFilter) { PrintLine_W("The bounds filter is only supported for .pbf files, loading all of \"%.*s\"", StrPrint(filePath)); }
+		//NOTE: The threaded .osm load splits the file at top-level elements, in an .osc file those are inside <create> and <modify> so every split would fail
+		OsmLoadOptions xmlOptions = ZEROED;
+		if (options != nullptr) { MyMemCopy(&xmlOptions, options, sizeof(OsmLoadOptions)); }
+		if (StrAnyCaseEndsWith(filePath, StrLit(".osc"))) { xmlOptions.workerPool = nullptr; }
+		options = &xmlOptions;
+		MappedFile mappedFile = ZEROED;
+		bool allowMapping = !options->disableMemoryMapping;
+		if (allowMapping && TryOpenMappedFile(filePath, &mappedFile))
 		{
-			PrintLine_I("Opened text \"%.*s\", %llu bytes", StrPrint(filePath), fileContents.length);
-			parseResult = TryParseOsmMap(stdHeap, fileContents, mapOut);
-			if (parseResult != Result_Success) { NotifyPrint_E("Failed to parse as OpenStreetMaps XML data! Error: %s", GetResultStr(parseResult)); }
+			PrintLine_I("Mapped text \"%.*s\", %llu bytes", StrPrint(filePath), mappedFile.size);
+			parseResult = TryParseOsmMappedFile(stdHeap, &mappedFile, options, mapOut);
+			CloseMappedFile(&mappedFile);
+			if (parseResult != Result_Success && parseResult != Result_Canceled) { PrintLine_E("Failed to parse as OpenStreetMaps XML data! Error: %s", GetResultStr(parseResult)); }
+		}
+		else
+		{
+			Str8 fileContents = Str8_Empty;
+			TracyCZoneN(_ReadTextFile, "OsReadTextFile", true);
+			bool openedSelectedFile = OsReadTextFile(filePath, scratch, &fileContents);
+			TracyCZoneEnd(_ReadTextFile);
+			if (openedSelectedFile)
+			{
+				PrintLine_I("Opened text \"%.*s\", %llu bytes", StrPrint(filePath), fileContents.length);
+				parseResult = TryParseOsmMap(stdHeap, fileContents, options, mapOut);
+				if (parseResult != Result_Success && parseResult != Result_Canceled) { PrintLine_E("Failed to parse as OpenStreetMaps XML data! Error: %s", GetResultStr(parseResult)); }
+			}
+			else { PrintLine_E("Failed to open \"%.*s\"", StrPrint(filePath)); parseResult = Result_FailedToReadFile; }
 		}
-		else { NotifyPrint_E("Failed to open \"%.*s\"", StrPrint(filePath)); }
 	}
-	else
+	else if (StrAnyCaseEndsWith(filePath, StrLit(".osm.gz")) || StrAnyCaseEndsWith(filePath, StrLit(".osc.gz")) ||
+		StrAnyCaseEndsWith(filePath, StrLit(".osm.bz2")) || StrAnyCaseEndsWith(filePath, StrLit(".osc.bz2")))
 	{
-		NotifyPrint_E("Unknown file extension \"%.*s\", expected .osm or .pbf files!", StrPrint(GetFileNamePart(filePath, true)));
-		parseResult = Result_UnsupportedFileFormat;
-	}
-	
-	ScratchEnd(scratch);
-	return parseResult;
-}
-
-void OpenOsmMap(FilePath filePath, bool addToMap)
-{
-	TracyCZoneN(funcZone, "OpenOsmMap", true);
-	ScratchBegin(scratch);
-	
-	OsmMap newMap = ZEROED;
-	Result parseResult = TryParseMapFile(scratch, filePath, &newMap);
-	if (parseResult == Result_Success)
-	{
-		PrintLine_I("Parsed map! %llu node%s, %llu way%s, %llu relation%s",
-			newMap.nodes.length, Plural(newMap.nodes.length, "s"),
-			newMap.ways.length, Plural(newMap.ways.length, "s"),
-			newMap.relations.length, Plural(newMap.relations.length, "s")
-		);
-		
-		if (addToMap && app->map.arena != nullptr)
+		if (options != nullptr && options->useBoundsFilter) { PrintLine_W("The bounds filter is only supported for .pbf files, loading all of \"%.*s\"", StrPrint(filePath)); }
+		StreamCodec codec = StrAnyCaseEndsWith(filePath, StrLit(".gz")) ? StreamCodec_Gzip : StreamCodec_Bzip2;
+		MappedFile mappedFile = ZEROED;
+		bool allowMapping = (options == nullptr || !options->disableMemoryMapping);
+		if (allowMapping && TryOpenMappedFile(filePath, &mappedFile))
 		{
-			OsmAddFromMap(&app->map, &newMap);
-			FreeOsmMap(&newMap);
+			PrintLine_I("Mapped %s compressed \"%.*s\", %llu bytes", GetStreamCodecStr(codec), StrPrint(filePath), mappedFile.size);
+			parseResult = TryParseOsmCompressedMap(stdHeap, MakeSlice(mappedFile.size, mappedFile.bytes), codec, &mappedFile, options, mapOut);
+			CloseMappedFile(&mappedFile);
+			if (parseResult != Result_Success && parseResult != Result_Canceled) { PrintLine_E("Failed to parse as %s compressed OpenStreetMaps XML data! Error: %s", GetStreamCodecStr(codec), GetResultStr(parseResult)); }
 		}
 		else
 		{
-			FreeStr8(stdHeap, &app->mapFilePath);
-			FreeOsmMap(&app->map);
-			MyMemCopy(&app->map, &newMap, sizeof(OsmMap));
-			app->mapFilePath = AllocStr8(stdHeap, filePath);
-		}
-		AppRememberRecentFile(filePath);
-		
-		v2d boundsOnMapTopLeft = MapProject(app->view.projection, app->map.bounds.topLeft, app->view.mapRec);
-		v2d boundsOnMapBottomRight = MapProject(app->view.projection, AddV2d(app->map.bounds.topLeft, app->map.bounds.size), app->view.mapRec);
-		recd boundsOnMap = NewRecdBetweenV(boundsOnMapTopLeft, boundsOnMapBottomRight);
-		app->view.position = AddV2d(boundsOnMap.topLeft, ShrinkV2d(boundsOnMap.size, 2.0));
-		rec mainViewportRec = GetClayElementDrawRecNt("MainViewport");
-		if (boundsOnMap.width > 0 && boundsOnMap.height > 0 && mainViewportRec.width > 0)
-		{
-			app->view.zoom = MinR64(
-				mainViewportRec.width / boundsOnMap.width,
-				mainViewportRec.height / boundsOnMap.height
-			);
+			Slice fileContents = Slice_Empty;
+			TracyCZoneN(_ReadBinFile, "OsReadBinFile", true);
+			bool openedSelectedFile = OsReadBinFile(filePath, scratch, &fileContents);
+			TracyCZoneEnd(_ReadBinFile);
+			if (openedSelectedFile)
+			{
+				PrintLine_I("Opened %s compressed \"%.*s\", %llu bytes", GetStreamCodecStr(codec), StrPrint(filePath), fileContents.length);
+				parseResult = TryParseOsmCompressedMap(stdHeap, fileContents, codec, nullptr, options, mapOut);
+				if (parseResult != Result_Success && parseResult != Result_Canceled) { PrintLine_E("Failed to parse as %s compressed OpenStreetMaps XML data! Error: %s", GetStreamCodecStr(codec), GetResultStr(parseResult)); }
+			}
+			else { PrintLine_E("Failed to open \"%.*s\"", StrPrint(filePath)); parseResult = Result_FailedToReadFile; }
 		}
-		
-		TracyCZoneN(_FindInternationalCodepoints, "FindInternationalCodepoints", true);
-		FindInternationalCodepointsInMapNames(&app->map, &app->kanjiCodepoints);
-		TracyCZoneEnd(_FindInternationalCodepoints);
-		
-		//TODO: This is taking like 40-50ms now. We should really work on changing how we display international codepoints
-		TracyCZoneN(_CreatingFonts, "CreatingFonts", true);
-		bool fontBakeSuccess = AppCreateFonts();
-		TracyCZoneEnd(_CreatingFonts);
-		
-		Assert(fontBakeSuccess);
+	}
+	else
+	{
+		PrintLine_E("Unknown file extension \"%.*s\", expected .osm, .osc, .osm.gz, .osm.bz2 or .pbf files!", StrPrint(GetFileNamePart(filePath, true)));
+		parseResult = Result_UnsupportedFileFormat;
 	}
 	
 	ScratchEnd(scratch);
-	TracyCZoneEnd(funcZone);
+	return parseResult;
 }
 
+// Not allowed while app->mapLoader is busy, app->map may only be a preview at that point
 bool SaveOsmMap(FilePath filePath)
 {
+	if (app->mapLoader.isLoading) { NotifyPrint_W("Can't save \"%.*s\" while a map is still loading", StrPrint(filePath)); return false; }
 	ScratchBegin(scratch);
 	bool result = false;
 	if (StrAnyCaseEndsWith(filePath, StrLit(".osm")))
@@ -508,10 +546,20 @@ bool SaveOsmMap(FilePath filePath)
 		}
 		else { Notify_E("Failed to serialize map to OpenStreetMap XML format!"); }
 	}
-	// else if (StrAnyCaseEndsWith(filePath, StrLit(".pbf")))
-	// {
-	// 	Unimplemented(); //TODO: Implement me!
-	// }
+	else if (StrAnyCaseEndsWith(filePath, StrLit(".pbf")))
+	{
+		Slice pbfFileContents = SerializePbfMap(scratch, &app->map, &app->workerPool);
+		if (pbfFileContents.length > 0)
+		{
+			if (OsWriteBinFile(filePath, pbfFileContents))
+			{
+				NotifyPrint_I("Successfully saved %llu byte PBF to \"%.*s\"", pbfFileContents.length, StrPrint(filePath));
+				result = true;
+			}
+			else { NotifyPrint_E("Failed to write %llu byte PBF to \"%.*s\"!", pbfFileContents.length, StrPrint(filePath)); }
+		}
+		else { Notify_E("Failed to serialize map to .pbf format!"); }
+	}
 	else
 	{
 		Str8 fileName = GetFileNamePart(filePath, true);
@@ -521,7 +569,7 @@ bool SaveOsmMap(FilePath filePath)
 	return result;
 }
 
-void UpdateOsmWayColorChoice(OsmWay* way)
+void UpdateOsmWayColorChoice(OsmMap* map, OsmWay* way)
 {
 	if (!way->colorsChosen)
 	{
@@ -534,10 +582,10 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 		{
 			way->fillColor = MakeColorU32(0x80FF00FF);
 			way->renderLayer = OsmRenderLayer_Bottom;
-			if (way->tags.length == 0) { way->fillColor = Transparent; } //TODO: We should see if there are any relations referencing this way and maybe color this way based off that
+			if (way->tags.count == 0) { way->fillColor = Transparent; } //TODO: We should see if there are any relations referencing this way and maybe color this way based off that
 			else
 			{
-				Str8 landuseStr = GetOsmWayTagValue(way, StrLit("landuse"), Str8_Empty);
+				Str8 landuseStr = GetOsmWayTagValue(map, way, StrLit("landuse"), Str8_Empty);
 				if (StrAnyCaseEquals(landuseStr, StrLit("retail"))) { way->fillColor = CartoFillRetail; way->borderThickness = 1.0f; way->borderColor = CartoBorderRetail; }
 				else if (StrAnyCaseEquals(landuseStr, StrLit("residential"))) { way->fillColor = CartoFillResidential; }
 				else if (StrAnyCaseEquals(landuseStr, StrLit("commercial"))) { way->fillColor = CartoFillCommercial; way->borderThickness = 1.0f; way->borderColor = CartoBorderCommercial; }
@@ -550,7 +598,7 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 					StrAnyCaseEquals(landuseStr, StrLit("flowerbed"))) { way->fillColor = CartoFillGrass; }
 				else
 				{
-					Str8 leisureStr = GetOsmWayTagValue(way, StrLit("leisure"), Str8_Empty);
+					Str8 leisureStr = GetOsmWayTagValue(map, way, StrLit("leisure"), Str8_Empty);
 					if (StrAnyCaseEquals(leisureStr, StrLit("park"))) { way->fillColor = CartoFillPark; }
 					else if (StrAnyCaseEquals(leisureStr, StrLit("playground")) ||
 						StrAnyCaseEquals(landuseStr, StrLit("recreation_ground"))) { way->fillColor = CartoFillPlayground; }
@@ -560,7 +608,7 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 					else if (StrAnyCaseEquals(leisureStr, StrLit("swimming_pool"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillWater; way->borderThickness = 1.0f; way->borderColor = CartoBorderWater; }
 					else if (StrAnyCaseEquals(leisureStr, StrLit("garden"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillGrass; }
 					{
-						Str8 buildingStr = GetOsmWayTagValue(way, StrLit("building"), Str8_Empty);
+						Str8 buildingStr = GetOsmWayTagValue(map, way, StrLit("building"), Str8_Empty);
 						if (StrAnyCaseEquals(buildingStr, StrLit("yes")) ||
 							StrAnyCaseEquals(buildingStr, StrLit("apartments")) ||
 							StrAnyCaseEquals(buildingStr, StrLit("residential")) ||
@@ -580,15 +628,15 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 						// else if (StrAnyCaseEquals(buildingStr, StrLit("train_station"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillPublicTransit; }
 						else
 						{
-							Str8 amenityStr = GetOsmWayTagValue(way, StrLit("amenity"), Str8_Empty);
+							Str8 amenityStr = GetOsmWayTagValue(map, way, StrLit("amenity"), Str8_Empty);
 							if (StrAnyCaseEquals(amenityStr, StrLit("school"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillSchool; }
 							else if (StrAnyCaseEquals(amenityStr, StrLit("parking"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillParking; way->borderThickness = 1.0f; way->borderColor = CartoBorderParking; }
 							else if (StrAnyCaseEquals(amenityStr, StrLit("place_of_worship"))) { way->fillColor = CartoFillReligious; way->borderThickness = 1.0f; way->borderColor = CartoBorderReligious; }
 							else
 							{
-								Str8 waterStr = GetOsmWayTagValue(way, StrLit("water"), Str8_Empty);
-								Str8 waterwayStr = GetOsmWayTagValue(way, StrLit("waterway"), Str8_Empty);
-								Str8 naturalStr = GetOsmWayTagValue(way, StrLit("natural"), Str8_Empty);
+								Str8 waterStr = GetOsmWayTagValue(map, way, StrLit("water"), Str8_Empty);
+								Str8 waterwayStr = GetOsmWayTagValue(map, way, StrLit("waterway"), Str8_Empty);
+								Str8 naturalStr = GetOsmWayTagValue(map, way, StrLit("natural"), Str8_Empty);
 								if (StrAnyCaseEquals(waterStr, StrLit("lake")) ||
 									StrAnyCaseEquals(waterStr, StrLit("river")) ||
 									StrAnyCaseEquals(waterStr, StrLit("pond")) ||
@@ -598,22 +646,22 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 								else if (StrAnyCaseEquals(naturalStr, StrLit("wood"))) { way->fillColor = CartoFillForest; }
 								else
 								{
-									Str8 demolishedBuildingStr = GetOsmWayTagValue(way, StrLit("demolished:building"), Str8_Empty);
-									Str8 buildingPartStr = GetOsmWayTagValue(way, StrLit("building:part"), Str8_Empty);
-									Str8 wasBuildingStr = GetOsmWayTagValue(way, StrLit("was:building"), Str8_Empty);
+									Str8 demolishedBuildingStr = GetOsmWayTagValue(map, way, StrLit("demolished:building"), Str8_Empty);
+									Str8 buildingPartStr = GetOsmWayTagValue(map, way, StrLit("building:part"), Str8_Empty);
+									Str8 wasBuildingStr = GetOsmWayTagValue(map, way, StrLit("was:building"), Str8_Empty);
 									if (StrAnyCaseEquals(demolishedBuildingStr, StrLit("yes"))) { way->fillColor = Transparent; }
 									else if (StrAnyCaseEquals(wasBuildingStr, StrLit("yes"))) { way->fillColor = Transparent; }
 									else if (!IsEmptyStr(buildingPartStr)) { way->fillColor = Transparent; }
 									else
 									{
-										Str8 railwayStr = GetOsmWayTagValue(way, StrLit("railway"), Str8_Empty);
-										Str8 manMadeStr = GetOsmWayTagValue(way, StrLit("man_made"), Str8_Empty);
+										Str8 railwayStr = GetOsmWayTagValue(map, way, StrLit("railway"), Str8_Empty);
+										Str8 manMadeStr = GetOsmWayTagValue(map, way, StrLit("man_made"), Str8_Empty);
 										if (StrAnyCaseEquals(railwayStr, StrLit("platform"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillPublicTransit; way->borderThickness = 1.0f; way->borderColor = CartoBorderPublicTransit; }
 										else if (StrAnyCaseEquals(manMadeStr, StrLit("bridge"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillBridge; }
 										else
 										{
-											if (!IsEmptyStr(GetOsmWayTagValue(way, StrLit("highway"), Str8_Empty)) ||
-												!IsEmptyStr(GetOsmWayTagValue(way, StrLit("barrier"), Str8_Empty))) { way->isClosedLoop = false; }
+											if (!IsEmptyStr(GetOsmWayTagValue(map, way, StrLit("highway"), Str8_Empty)) ||
+												!IsEmptyStr(GetOsmWayTagValue(map, way, StrLit("barrier"), Str8_Empty))) { way->isClosedLoop = false; }
 										}
 									}
 								}
@@ -628,28 +676,29 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 				#if 0
 				if (way->fillColor.valueU32 == 0x80FF00FF)
 				{
-					PrintLine_D("Way[%llu] failed to choose a fillColor with %llu tags", way->id, way->tags.length);
-					VarArrayLoop(&way->tags, tIndex)
+					PrintLine_D("Way[%llu] failed to choose a fillColor with %u tags", way->id, way->tags.count);
+					const OsmTag* wayTags = GetOsmTags(map, way->tags);
+					for (u32 tIndex = 0; tIndex < way->tags.count; tIndex++)
 					{
-						VarArrayLoopGet(OsmTag, tag, &way->tags, tIndex);
-						PrintLine_D("\tTag[%llu] \"%.*s\" = \"%.*s\"", tIndex, StrPrint(tag->key), StrPrint(tag->value));
+						PrintLine_D("\tTag[%u] \"%.*s\" = \"%.*s\"", tIndex, StrPrint(wayTags[tIndex].key), StrPrint(wayTags[tIndex].value));
 					}
 				}
 				#endif
 				
-				Str8 colorStr = GetOsmWayTagValue(way, StrLit("color"), Str8_Empty);
-				if (IsEmptyStr(colorStr)) { colorStr = GetOsmWayTagValue(way, StrLit("colour"), Str8_Empty); }
+				Str8 colorStr = GetOsmWayTagValue(map, way, StrLit("color"), Str8_Empty);
+				if (IsEmptyStr(colorStr)) { colorStr = GetOsmWayTagValue(map, way, StrLit("colour"), Str8_Empty); }
 				if (!IsEmptyStr(colorStr))
 				{
 					TryParseColor(colorStr, &way->fillColor, nullptr);
 				}
 				else
 				{
-					VarArrayLoop(&way->relationPntrs, rIndex)
+					VarArrayLoop(&way->relationIndices, rIndex)
 					{
-						VarArrayLoopGetValue(OsmRelation*, relation, &way->relationPntrs, rIndex);
-						Str8 relationColorStr = GetOsmRelationTagValue(relation, StrLit("color"), Str8_Empty);
-						if (IsEmptyStr(relationColorStr)) { relationColorStr = GetOsmRelationTagValue(relation, StrLit("colour"), Str8_Empty); }
+						VarArrayLoopGetValue(u32, relationIndex, &way->relationIndices, rIndex);
+						OsmRelation* relation = GetOsmRelationByIndex(map, relationIndex);
+						Str8 relationColorStr = GetOsmRelationTagValue(map, relation, StrLit("color"), Str8_Empty);
+						if (IsEmptyStr(relationColorStr)) { relationColorStr = GetOsmRelationTagValue(map, relation, StrLit("colour"), Str8_Empty); }
 						if (!IsEmptyStr(relationColorStr))
 						{
 							TryParseColor(relationColorStr, &way->fillColor, nullptr);
@@ -664,7 +713,7 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 			way->renderLayer = OsmRenderLayer_Top;
 			way->fillColor = Black;
 			way->lineThickness = 1.0f;
-			Str8 highwayStr = GetOsmWayTagValue(way, StrLit("highway"), Str8_Empty);
+			Str8 highwayStr = GetOsmWayTagValue(map, way, StrLit("highway"), Str8_Empty);
 			if (StrAnyCaseEquals(highwayStr, StrLit("trunk"))) { way->fillColor = CartoStrokeTrunk; way->lineThickness = 5.0f; }
 			else if (StrAnyCaseEquals(highwayStr, StrLit("tertiary"))) { way->fillColor = CartoStrokeRoad; way->lineThickness = 3.0f; }
 			else if (StrAnyCaseEquals(highwayStr, StrLit("residential")) ||
@@ -677,36 +726,37 @@ void UpdateOsmWayColorChoice(OsmWay* way)
 			else if (StrAnyCaseEquals(highwayStr, StrLit("track"))) { way->fillColor = CartoStrokeTrack; way->lineThickness = 2.0f; }
 			else
 			{
-				Str8 railwayStr = GetOsmWayTagValue(way, StrLit("railway"), Str8_Empty);
-				Str8 waterwayStr = GetOsmWayTagValue(way, StrLit("waterway"), Str8_Empty);
-				Str8 barrierStr = GetOsmWayTagValue(way, StrLit("barrier"), Str8_Empty);
+				Str8 railwayStr = GetOsmWayTagValue(map, way, StrLit("railway"), Str8_Empty);
+				Str8 waterwayStr = GetOsmWayTagValue(map, way, StrLit("waterway"), Str8_Empty);
+				Str8 barrierStr = GetOsmWayTagValue(map, way, StrLit("barrier"), Str8_Empty);
 				if (StrAnyCaseEquals(waterwayStr, StrLit("stream"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoFillWater; way->lineThickness = 2.0f; }
 				else if (StrAnyCaseEquals(barrierStr, StrLit("hedge"))) { way->fillColor = CartoStrokeHedge; way->lineThickness = 3.0f; }
 				else if (StrAnyCaseEquals(barrierStr, StrLit("fence"))) { way->fillColor = CartoStrokeFence; way->lineThickness = 1.0f; }
 				else if (StrAnyCaseEquals(railwayStr, StrLit("rail"))) { way->renderLayer = OsmRenderLayer_Middle; way->fillColor = CartoStrokeRail; way->lineThickness = 2.0f; }
 				else
 				{
-					Str8 powerStr = GetOsmWayTagValue(way, StrLit("power"), Str8_Empty);
+					Str8 powerStr = GetOsmWayTagValue(map, way, StrLit("power"), Str8_Empty);
 					if (StrAnyCaseEquals(powerStr, StrLit("line"))) { way->renderLayer = OsmRenderLayer_Top; way->fillColor = CartoStrokePowerline; way->lineThickness = 1.0f; }
-					
+				
 				}
 			}
 			
-			Str8 thicknessStr = GetOsmWayTagValue(way, StrLit("thickness"), Str8_Empty);
+			Str8 thicknessStr = GetOsmWayTagValue(map, way, StrLit("thickness"), Str8_Empty);
 			if (!IsEmptyStr(thicknessStr)) { TryParseR32(thicknessStr, &way->lineThickness, nullptr); }
-			Str8 colorStr = GetOsmWayTagValue(way, StrLit("color"), Str8_Empty);
-			if (IsEmptyStr(colorStr)) { colorStr = GetOsmWayTagValue(way, StrLit("colour"), Str8_Empty); }
+			Str8 colorStr = GetOsmWayTagValue(map, way, StrLit("color"), Str8_Empty);
+			if (IsEmptyStr(colorStr)) { colorStr = GetOsmWayTagValue(map, way, StrLit("colour"), Str8_Empty); }
 			if (!IsEmptyStr(colorStr))
 			{
 				TryParseColor(colorStr, &way->fillColor, nullptr);
 			}
 			else
 			{
-				VarArrayLoop(&way->relationPntrs, rIndex)
+				VarArrayLoop(&way->relationIndices, rIndex)
 				{
-					VarArrayLoopGetValue(OsmRelation*, relation, &way->relationPntrs, rIndex);
-					Str8 relationColorStr = GetOsmRelationTagValue(relation, StrLit("color"), Str8_Empty);
-					if (IsEmptyStr(relationColorStr)) { relationColorStr = GetOsmRelationTagValue(relation, StrLit("colour"), Str8_Empty); }
+					VarArrayLoopGetValue(u32, relationIndex, &way->relationIndices, rIndex);
+					OsmRelation* relation = GetOsmRelationByIndex(map, relationIndex);
+					Str8 relationColorStr = GetOsmRelationTagValue(map, relation, StrLit("color"), Str8_Empty);
+					if (IsEmptyStr(relationColorStr)) { relationColorStr = GetOsmRelationTagValue(map, relation, StrLit("colour"), Str8_Empty); }
 					if (!IsEmptyStr(relationColorStr))
 					{
 						TryParseColor(relationColorStr, &way->fillColor, nullptr);
@@ -728,12 +778,7 @@ void UpdateOsmWayTriangulation(OsmMap* map, OsmWay* way)
 		
 		uxx numPolygonVerts = way->nodes.length;
 		v2d* polygonVerts = AllocArray(v2d, scratch, numPolygonVerts);
-		VarArrayLoop(&way->nodes, nIndex)
-		{
-			VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
-			if (nodeRef->pntr == nullptr) { way->attemptedTriangulation = true; TracyCZoneEnd(_TriangulatingWay); return; }
-			polygonVerts[nIndex] = nodeRef->pntr->location;
-		}
+		if (!TryGetOsmWayNodeLocations(map, way, polygonVerts)) { ScratchEnd(scratch); TracyCZoneEnd(_TriangulatingWay); return; }
 		// PrintLine_D("Triangulating way %llu (%llu nodes)", way->id, way->nodes.length);
 		way->triIndices = Triangulate2DEarClipR64(map->arena, numPolygonVerts, polygonVerts, &way->numTriIndices);
 		if (way->triIndices == nullptr)
@@ -777,7 +822,7 @@ void UpdateOsmWayTriangulation(OsmMap* map, OsmWay* way)
 	}
 }
 
-void RenderWayLine(OsmWay* way, recd mapScreenRec, r32 thickness, Color32 color)
+void RenderWayLine(OsmMap* map, OsmWay* way, recd mapScreenRec, r32 thickness, Color32 color)
 {
 	#if 1
 	TracyCZoneN(funcZone, "RenderWayLine", true);
@@ -785,12 +830,12 @@ void RenderWayLine(OsmWay* way, recd mapScreenRec, r32 thickness, Color32 color)
 	SimpPolygonR64 simpPoly = ZEROED;
 	simpPoly.numVertices = way->nodes.length;
 	simpPoly.vertices = AllocArray(SimpPolyVertR64, scratch, simpPoly.numVertices);
-	VarArrayLoop(&way->nodes, nIndex)
+	v2d* locations = AllocArray(v2d, scratch, simpPoly.numVertices);
+	if (!TryGetOsmWayNodeLocations(map, way, locations)) { ScratchEnd(scratch); TracyCZoneEnd(funcZone); return; }
+	for (uxx vIndex = 0; vIndex < simpPoly.numVertices; vIndex++)
 	{
-		VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
-		if (nodeRef->pntr == nullptr) { ScratchEnd(scratch); TracyCZoneEnd(funcZone); return; }
-		simpPoly.vertices[nIndex].state = 0;
-		simpPoly.vertices[nIndex].pos = nodeRef->pntr->location;
+		simpPoly.vertices[vIndex].pos = locations[vIndex];
+		simpPoly.vertices[vIndex].state = 0;
 	}
 	r64 epsilonDegrees = ((r64)WAY_SIMPLIFYING_EPSILON_PX / mapScreenRec.width) * MERCATOR_LONGITUDE_RANGE;
 	TracyCZoneN(_SimplifyPolygonR64, "SimplifyPolygonR64", true);
@@ -814,15 +859,16 @@ void RenderWayLine(OsmWay* way, recd mapScreenRec, r32 thickness, Color32 color)
 	v2d prevPos = V2d_Zero;
 	VarArrayLoop(&way->nodes, nIndex)
 	{
-		VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
-		v2d nodePos = MapProject(app->view.projection, nodeRef->pntr->location, mapScreenRec);
+		v2d nodeLocation = V2d_Zero;
+		TryGetOsmWayNodeLocation(map, way, nIndex, &nodeLocation);
+		v2d nodePos = MapProject(app->view.projection, nodeLocation, mapScreenRec);
 		if (nIndex > 0) { DrawLine(ToV2Fromd(prevPos), ToV2Fromd(nodePos), thickness, color); }
 		prevPos = nodePos;
 	}
 	#endif
 }
 
-void RenderWayFilled(OsmWay* way, recd mapScreenRec, rec wayOnScreenBoundsRec, Color32 fillColor, r32 borderThickness, Color32 borderColor)
+void RenderWayFilled(OsmMap* map, OsmWay* way, recd mapScreenRec, rec wayOnScreenBoundsRec, Color32 fillColor, r32 borderThickness, Color32 borderColor)
 {
 	bool renderedFill = false;
 	if (way->triVertBuffer.arena != nullptr && way->triVertBuffer.numVertices > 0)
@@ -842,12 +888,13 @@ void RenderWayFilled(OsmWay* way, recd mapScreenRec, rec wayOnScreenBoundsRec, C
 	{
 		for (uxx iIndex = 0; iIndex < way->numTriIndices; iIndex += 3)
 		{
-			OsmNodeRef* node0 = VarArrayGet(OsmNodeRef, &way->nodes, way->triIndices[iIndex+0]);
-			OsmNodeRef* node1 = VarArrayGet(OsmNodeRef, &way->nodes, way->triIndices[iIndex+1]);
-			OsmNodeRef* node2 = VarArrayGet(OsmNodeRef, &way->nodes, way->triIndices[iIndex+2]);
-			v2 vert0 = ToV2Fromd(MapProject(app->view.projection, node0->pntr->location, mapScreenRec));
-			v2 vert1 = ToV2Fromd(MapProject(app->view.projection, node1->pntr->location, mapScreenRec));
-			v2 vert2 = ToV2Fromd(MapProject(app->view.projection, node2->pntr->location, mapScreenRec));
+			//NOTE: The way only got triangulated if every node had a location
+			v2d location0 = V2d_Zero; TryGetOsmWayNodeLocation(map, way, way->triIndices[iIndex+0], &location0);
+			v2d location1 = V2d_Zero; TryGetOsmWayNodeLocation(map, way, way->triIndices[iIndex+1], &location1);
+			v2d location2 = V2d_Zero; TryGetOsmWayNodeLocation(map, way, way->triIndices[iIndex+2], &location2);
+			v2 vert0 = ToV2Fromd(MapProject(app->view.projection, location0, mapScreenRec));
+			v2 vert1 = ToV2Fromd(MapProject(app->view.projection, location1, mapScreenRec));
+			v2 vert2 = ToV2Fromd(MapProject(app->view.projection, location2, mapScreenRec));
 			DrawLine(vert0, vert1, 2.0f, fillColor);
 			DrawLine(vert1, vert2, 2.0f, fillColor);
 			DrawLine(vert2, vert0, 2.0f, fillColor);
@@ -856,10 +903,10 @@ void RenderWayFilled(OsmWay* way, recd mapScreenRec, rec wayOnScreenBoundsRec, C
 	}
 	if (way->attemptedTriangulation && !renderedFill)
 	{
-		RenderWayLine(way, mapScreenRec, 2.0f, fillColor);
+		RenderWayLine(map, way, mapScreenRec, 2.0f, fillColor);
 	}
 	else if (borderThickness > 0 && borderColor.a > 0)
 	{
-		RenderWayLine(way, mapScreenRec, borderThickness, borderColor);
+		RenderWayLine(map, way, mapScreenRec, borderThickness, borderColor);
 	}
 }
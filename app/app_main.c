@@ -41,14 +41,36 @@ Description:
 #endif
 #endif
 
+#if COMPILER_IS_MSVC
+#pragma warning(push)
+#pragma warning(disable: 4244)
+#pragma warning(disable: 4127)
+#endif
+#include "third_party/zstd/zstddeclib.c"
+#if COMPILER_IS_MSVC
+#pragma warning(pop)
+#endif
+
 // +--------------------------------------------------------------+
 // |                         Header Files                         |
 // +--------------------------------------------------------------+
 #include "osm_pbf.pb-c.h"
 #include "parse_xml.h"
+#include "osm_xml_numbers.h"
+#include "worker_pool.h"
+#include "mapped_file.h"
+#include "pbf_wire_format.h"
+#include "pbf_delta_kernels.h"
+#include "pbf_codecs.h"
+#include "stream_codecs.h"
+#include "osm_tag_filter.h"
+#include "pbf_blob_index.h"
 #include "platform_interface.h"
 #include "app_resources.h"
 #include "map_projections.h"
+#include "osm_string_pool.h"
+#include "osm_id_table.h"
+#include "osm_load_progress.h"
 #include "osm_carto.h"
 #include "osm_map.h"
 #include "app_main.h"
@@ -71,14 +93,29 @@ static Arena* stdHeap = nullptr;
 // +--------------------------------------------------------------+
 #include "osm_pbf.pb-c.c"
 #include "parse_xml.c"
+#include "osm_xml_numbers.c"
+#include "worker_pool.c"
+#include "mapped_file.c"
+#include "pbf_wire_format.c"
+#include "pbf_delta_kernels.c"
+#include "pbf_codecs.c"
+#include "stream_codecs.c"
 #include "main2d_shader.glsl.h"
 #include "app_resources.c"
+#include "osm_string_pool.c"
+#include "osm_id_table.c"
 #include "osm_map.c"
+#include "osm_load_progress.c"
+#include "osm_tag_filter.c"
+#include "pbf_blob_index.c"
 #include "osm_map_serialization_osm.c"
 #include "osm_map_serialization_pbf.c"
 #include "app_clay_helpers.c"
 #include "app_recent_files.c"
 #include "app_helpers.c"
+#include "app_map_loader.c"
+#include "app_benchmarks.c"
+#include "app_codec_checks.c"
 #include "map_tiles.c"
 #include "map_view.c"
 #include "app_clay.c"
@@ -157,6 +194,9 @@ EXPORT_FUNC APP_INIT_DEF(AppInit)
 	InitNotificationQueue(stdHeap, &app->notificationQueue);
 	LoadNotificationIcons();
 	
+	InitWorkerPool(stdHeap, NUM_WORKER_THREADS, &app->workerPool);
+	InitWorkerPoolEx(stdHeap, 1, MAP_LOADER_SCRATCH_SIZE, &app->loaderPool);
+	
 	InitCompiledShader(&app->mainShader, stdHeap, main2d);
 	LoadMapBackTexture();
 	
@@ -237,6 +277,11 @@ EXPORT_FUNC APP_BEFORE_RELOAD_DEF(AppBeforeReload)
 	
 	WriteLine_W("App is preparing for DLL reload...");
 	//TODO: Anything that needs to be saved before the DLL reload should be done here
+	//NOTE: The worker threads are running code from this DLL so they need to be stopped before it gets unloaded.
+	//      We don't try to resume a map load across the reload, it gets canceled and the user can open the file again
+	CancelMapLoad();
+	FreeWorkerPool(&app->loaderPool);
+	FreeWorkerPool(&app->workerPool);
 	
 	ScratchEnd(scratch);
 	ScratchEnd(scratch2);
@@ -256,6 +301,8 @@ EXPORT_FUNC APP_AFTER_RELOAD_DEF(AppAfterReload)
 	UpdateDllGlobals(inPlatformInfo, inPlatformApi, memoryPntr, nullptr);
 	
 	WriteLine_I("New app DLL was loaded!");
+	InitWorkerPool(stdHeap, NUM_WORKER_THREADS, &app->workerPool);
+	InitWorkerPoolEx(stdHeap, 1, MAP_LOADER_SCRATCH_SIZE, &app->loaderPool);
 	if (!StrExactEquals(app->mapBackTexturePath, StrLit(MAP_BACKGROUND_TEXTURE_PATH)))
 	{
 		PrintLine_W("Loading background texture from \"%s\" (was \"%.*s\")", MAP_BACKGROUND_TEXTURE_PATH, StrPrint(app->mapBackTexturePath));
@@ -305,6 +352,11 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 	{
 		UpdateMapTiles();
 		OsUpdateHttpRequestManager(&app->httpManager, appIn->programTime);
+		if (app->mapLoader.isLoading)
+		{
+			UpdateMapLoader();
+			isOverDisplayLimit = (app->map.nodes.length > DISPLAY_NODE_COUNT_LIMIT || app->map.ways.length > DISPLAY_WAY_COUNT_LIMIT);
+		}
 		
 		// +==============================+
 		// |  Check Recent Files Changed  |
@@ -351,23 +403,28 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 				VarArrayLoopGet(OsmSelectedItem, selectedItem, &app->map.selectedItems, sIndex);
 				if (selectedItem->type == OsmPrimitiveType_Node)
 				{
-					averageLocation = AddV2d(averageLocation, selectedItem->nodePntr->location);
+					averageLocation = AddV2d(averageLocation, ToV2dFromOsmLocation(*VarArrayGet(OsmLocation, &app->map.nodeLocations, selectedItem->index)));
 					averageCount++;
 				}
 				else if (selectedItem->type == OsmPrimitiveType_Way)
 				{
 					//TODO: This isn't a great way to find the center of an arbitrary polygon! Sides with more vertices are weighted heavier. Should we find the center of mass?
+					OsmWay* selectedWay = GetOsmWayByIndex(&app->map, selectedItem->index);
 					v2d wayAverageLocation = V2d_Zero;
 					uxx wayAverageCount = 0;
-					VarArrayLoop(&selectedItem->wayPntr->nodes, nIndex)
+					VarArrayLoop(&selectedWay->nodes, nIndex)
 					{
-						VarArrayLoopGet(OsmNodeRef, nodeRef, &selectedItem->wayPntr->nodes, nIndex);
-						wayAverageLocation = AddV2d(wayAverageLocation, nodeRef->pntr->location);
+						v2d nodeLocation = V2d_Zero;
+						if (!TryGetOsmWayNodeLocation(&app->map, selectedWay, nIndex, &nodeLocation)) { continue; }
+						wayAverageLocation = AddV2d(wayAverageLocation, nodeLocation);
 						wayAverageCount++;
 					}
-					wayAverageLocation = ShrinkV2d(wayAverageLocation, (r64)wayAverageCount);
-					averageLocation = AddV2d(averageLocation, wayAverageLocation);
-					averageCount++;
+					if (wayAverageCount > 0)
+					{
+						wayAverageLocation = ShrinkV2d(wayAverageLocation, (r64)wayAverageCount);
+						averageLocation = AddV2d(averageLocation, wayAverageLocation);
+						averageCount++;
+					}
 				}
 			}
 			averageLocation = ShrinkV2d(averageLocation, (r64)averageCount);
@@ -406,12 +463,44 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 			isOverDisplayLimit = (app->map.nodes.length > DISPLAY_NODE_COUNT_LIMIT || app->map.ways.length > DISPLAY_WAY_COUNT_LIMIT);
 		}
 		
+		// +==================================+
+		// | Ctrl+Shift+B Benchmark Parsing   |
+		// +==================================+
+		if (IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Control) && IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Shift) && IsKeyboardKeyPressed(&appIn->keyboard, nullptr, Key_B, false))
+		{
+			RunPbfDeltaKernelBenchmark(StrLit(TEST_OSM_FILE));
+			RunPbfDecoderBenchmark(StrLit(TEST_OSM_FILE));
+			RunPbfThreadScalingBenchmark(StrLit(TEST_OSM_FILE));
+			RunOsmTagMemoryBenchmark(StrLit(TEST_OSM_FILE));
+			RunOsmSaveBenchmark(StrLit(TEST_OSM_FILE));
+			RunXmlDomBenchmark(StrLit("resources/map/fuji_area_railways.osm"));
+			RunXmlDomBenchmark(StrLit("resources/map/hawaii_maritime_boundary.osm"));
+			RunOsmNumberParsingBenchmark(StrLit(TEST_OSM_FILE));
+			RunOsmThreadScalingBenchmark(StrLit(TEST_OSM_FILE));
+			RunOsmCompressedLoadBenchmark(StrLit(TEST_OSM_FILE));
+			RunOsmIdLookupBenchmark(StrLit(TEST_OSM_FILE));
+			RunOsmNodeColumnsBenchmark(StrLit(TEST_OSM_FILE));
+		}
+		
+		// +==================================+
+		// | Ctrl+Shift+K Check Codecs        |
+		// +==================================+
+		if (IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Control) && IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Shift) && IsKeyboardKeyPressed(&appIn->keyboard, nullptr, Key_K, false))
+		{
+			RunCodecChecks();
+		}
+		
 		// +==============================+
 		// |      Handle Key_Escape       |
 		// +==============================+
 		if (IsKeyboardKeyPressed(&appIn->keyboard, nullptr, Key_Escape, true))
 		{
-			if (app->map.selectedItems.length > 0)
+			if (app->mapLoader.isLoading)
+			{
+				CancelMapLoad();
+				isOverDisplayLimit = (app->map.nodes.length > DISPLAY_NODE_COUNT_LIMIT || app->map.ways.length > DISPLAY_WAY_COUNT_LIMIT);
+			}
+			else if (app->map.selectedItems.length > 0)
 			{
 				ClearMapSelection(&app->map);
 			}
@@ -428,7 +517,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 		{
 			if (!isMouseOverMainViewport)
 			{
-				VarArrayLoop(&app->map.nodes, nIndex) { VarArrayLoopGet(OsmNode, node, &app->map.nodes, nIndex); node->isHovered = false; }
+				VarArrayLoop(&app->map.nodeFlags, nIndex) { FlagUnset(*VarArrayGet(u8, &app->map.nodeFlags, nIndex), (u8)OsmNodeFlag_Hovered); }
 				VarArrayLoop(&app->map.ways, wIndex) { VarArrayLoopGet(OsmWay, way, &app->map.ways, wIndex); way->isHovered = false; }
 				// if (IsMouseBtnPressed(&appIn->mouse, MouseBtn_Left))
 				// {
@@ -440,19 +529,27 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 				recd screenMapRec = GetMapScreenRec(&app->view);
 				v2d mouseLocation = MapUnproject(app->view.projection, ToV2dFromf(appIn->mouse.position), screenMapRec);
 				
+				//NOTE: Only the location and flag columns are touched here, the OsmNode itself is only looked at for the closest one.
+				//      The distances are compared in the column's own units, nothing gets converted to degrees
 				OsmNode* closestNode = nullptr;
+				uxx closestNodeIndex = app->map.nodes.length;
 				r64 closestNodeDistanceSqr = 0.0f;
-				VarArrayLoop(&app->map.nodes, nIndex)
+				const OsmLocation* nodeLocations = (const OsmLocation*)app->map.nodeLocations.items;
+				u8* nodeFlags = (u8*)app->map.nodeFlags.items;
+				v2d mouseUnits = MakeV2d(mouseLocation.lon * OSM_LOCATION_UNITS_PER_DEGREE, mouseLocation.lat * OSM_LOCATION_UNITS_PER_DEGREE);
+				for (uxx nIndex = 0; nIndex < app->map.nodeLocations.length; nIndex++)
 				{
-					VarArrayLoopGet(OsmNode, node, &app->map.nodes, nIndex);
-					node->isHovered = false;
-					r64 nodeDistanceSqr = LengthSquaredV2d(SubV2d(mouseLocation, node->location));
-					if (closestNode == nullptr || nodeDistanceSqr < closestNodeDistanceSqr)
+					FlagUnset(nodeFlags[nIndex], (u8)OsmNodeFlag_Hovered);
+					r64 lonDiff = (r64)nodeLocations[nIndex].lon - mouseUnits.lon;
+					r64 latDiff = (r64)nodeLocations[nIndex].lat - mouseUnits.lat;
+					r64 nodeDistanceSqr = lonDiff*lonDiff + latDiff*latDiff;
+					if (closestNodeIndex == app->map.nodes.length || nodeDistanceSqr < closestNodeDistanceSqr)
 					{
-						closestNode = node;
+						closestNodeIndex = nIndex;
 						closestNodeDistanceSqr = nodeDistanceSqr;
 					}
 				}
+				if (closestNodeIndex < app->map.nodes.length) { closestNode = VarArrayGet(OsmNode, &app->map.nodes, closestNodeIndex); }
 				
 				OsmWay* closestWay = nullptr;
 				v2d closestWayPoint = V2d_Zero;
@@ -467,9 +564,10 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 					{
 						for (uxx nIndex = 1; nIndex < way->nodes.length; nIndex++)
 						{
-							OsmNodeRef* node1 = VarArrayGet(OsmNodeRef, &way->nodes, nIndex-1);
-							OsmNodeRef* node2 = VarArrayGet(OsmNodeRef, &way->nodes, nIndex);
-							Line2DR64 line = MakeLine2DR64V(node1->pntr->location, node2->pntr->location);
+							v2d location1 = V2d_Zero;
+							v2d location2 = V2d_Zero;
+							if (!TryGetOsmWayNodeLocation(&app->map, way, nIndex-1, &location1) || !TryGetOsmWayNodeLocation(&app->map, way, nIndex, &location2)) { continue; }
+							Line2DR64 line = MakeLine2DR64V(location1, location2);
 							v2d closestPoint = V2d_Zero;
 							r64 distanceToLine = DistanceToLine2DR64(line, mouseLocation, &closestPoint);
 							if (closestWay == nullptr || distanceToLine*distanceToLine < closestWayDistanceSqr)
@@ -490,11 +588,11 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 				OsmWay* hoveredWay = nullptr;
 				if (closestNode != nullptr)
 				{
-					v2 nodePosOnScreen = ToV2Fromd(MapProject(app->view.projection, closestNode->location, screenMapRec));
+					v2 nodePosOnScreen = ToV2Fromd(MapProject(app->view.projection, ToV2dFromOsmLocation(nodeLocations[closestNodeIndex]), screenMapRec));
 					if (LengthSquaredV2(SubV2(nodePosOnScreen, appIn->mouse.position)) < 10*10)
 					{
 						hoveredNode = closestNode;
-						hoveredNode->isHovered = true;
+						FlagSet(nodeFlags[closestNodeIndex], (u8)OsmNodeFlag_Hovered);
 					}
 				}
 				else if (closestWay != nullptr)
@@ -527,7 +625,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 					
 					if (nodeWay != nullptr)
 					{
-						hoveredNode->isHovered = false;
+						FlagUnset(*GetOsmNodeFlags(&app->map, hoveredNode), (u8)OsmNodeFlag_Hovered);
 						nodeWay->isHovered = true;
 						hoveredNode = nullptr;
 						hoveredWay = nodeWay;
@@ -541,7 +639,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 					if (!IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Shift) && !IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Control)) { ClearMapSelection(&app->map); }
 					if (hoveredNode != nullptr)
 					{
-						SetMapNodeSelected(&app->map, hoveredNode, IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Control) ? !hoveredNode->isSelected : true);
+						SetMapNodeSelected(&app->map, hoveredNode, IsKeyboardKeyDown(&appIn->keyboard, nullptr, Key_Control) ? !IsFlagSet(*GetOsmNodeFlags(&app->map, hoveredNode), OsmNodeFlag_Selected) : true);
 					}
 					else if (hoveredWay != nullptr)
 					{
@@ -599,7 +697,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 			#else
 			NotifyPrintAt(level, 0, "%s Notification \"%.*s\"!", GetDbgLevelStr(level), StrPrint(app->mapBackTexturePath));
 			#endif
-			
+		
 		}
 		
 		UpdateMapView(&app->view, isMouseOverMainViewport, &appIn->mouse, &appIn->keyboard);
@@ -761,8 +859,8 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 			{
 				v2d clickedLocation = MapUnproject(app->view.projection, ToV2dFromf(appIn->mouse.position), mapScreenRec);
 				OsmNode* newNode = AddOsmNode(&app->map, clickedLocation, 0);
-				OsmTag* newTag1 = VarArrayAdd(OsmTag, &newNode->tags); NotNull(newTag1); newTag1->key = AllocStr8Nt(app->map.arena, "name"); newTag1->value = AllocStr8Nt(app->map.arena, "Mouse");
-				OsmTag* newTag2 = VarArrayAdd(OsmTag, &newNode->tags); NotNull(newTag2); newTag2->key = AllocStr8Nt(app->map.arena, "population"); newTag2->value = AllocStr8Nt(app->map.arena, "1000000");
+				AddOsmTag(&app->map, &newNode->tags, StrLit("name"), StrLit("Mouse"));
+				AddOsmTag(&app->map, &newNode->tags, StrLit("population"), StrLit("1000000"));
 			}
 			#endif
 			
@@ -793,7 +891,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 					VarArrayLoop(&app->map.ways, wIndex)
 					{
 						VarArrayLoopGet(OsmWay, way, &app->map.ways, wIndex);
-						UpdateOsmWayColorChoice(way);
+						UpdateOsmWayColorChoice(&app->map, way);
 						if (way->renderLayer == currentLayer && way->colorsChosen &&
 							way->nodeBounds.lon <= viewableLongitude.max && way->nodeBounds.lat <= viewableLatitude.max &&
 							way->nodeBounds.lon + way->nodeBounds.sizeLon >= viewableLongitude.min && way->nodeBounds.lat + way->nodeBounds.sizeLat >= viewableLatitude.min)
@@ -820,13 +918,13 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 										UpdateOsmWayTriangulation(&app->map, way);
 										Color32 fillColor = way->isSelected ? MonokaiGreen : (way->isHovered ? ColorLerpSimple(way->fillColor, MonokaiOrange, 0.2f) : way->fillColor);
 										Color32 borderColor = (way->isSelected || way->isHovered) ? Transparent : way->borderColor;
-										RenderWayFilled(way, mapScreenRec, boundsRec, fillColor, way->borderThickness, borderColor);
+										RenderWayFilled(&app->map, way, mapScreenRec, boundsRec, fillColor, way->borderThickness, borderColor);
 									}
 								}
 								
 								if (!way->isClosedLoop && way->lineThickness > 0.0f)
 								{
-									RenderWayLine(way, mapScreenRec, way->lineThickness, way->fillColor);
+									RenderWayLine(&app->map, way, mapScreenRec, way->lineThickness, way->fillColor);
 								}
 							}
 						}
@@ -834,7 +932,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 						if (currentLayer == OsmRenderLayer_Selection && (way->isSelected || way->isHovered))
 						{
 							Color32 borderColor = (way->isSelected ? CartoTextGreen : CartoTextOrange);
-							RenderWayLine(way, mapScreenRec, 2.0f, borderColor);
+							RenderWayLine(&app->map, way, mapScreenRec, 2.0f, borderColor);
 						}
 					}
 				}
@@ -847,46 +945,57 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 			if (!isOverDisplayLimit && true)
 			{
 				TracyCZoneN(_RenderNodes, "RenderNodes", true);
-				VarArrayLoop(&app->map.nodes, nIndex)
+				//NOTE: The cull only streams through the location column, the OsmNode (and its tags) are only touched for the nodes that are on screen.
+				//      The view is scaled into the column's units so only the nodes that pass get converted to degrees
+				const OsmLocation* nodeLocations = (const OsmLocation*)app->map.nodeLocations.items;
+				const u8* nodeFlags = (const u8*)app->map.nodeFlags.items;
+				RangeR64 viewableLonUnits = NewRangeR64(viewableLongitude.min * OSM_LOCATION_UNITS_PER_DEGREE, viewableLongitude.max * OSM_LOCATION_UNITS_PER_DEGREE);
+				RangeR64 viewableLatUnits = NewRangeR64(viewableLatitude.min * OSM_LOCATION_UNITS_PER_DEGREE, viewableLatitude.max * OSM_LOCATION_UNITS_PER_DEGREE);
+				for (uxx nIndex = 0; nIndex < app->map.nodeLocations.length; nIndex++)
 				{
-					VarArrayLoopGet(OsmNode, node, &app->map.nodes, nIndex);
-					if (node->location.lon <= viewableLongitude.max && node->location.lat <= viewableLatitude.max &&
-						node->location.lon >= viewableLongitude.min && node->location.lat >= viewableLatitude.min)
+					r64 nodeLon = (r64)nodeLocations[nIndex].lon;
+					r64 nodeLat = (r64)nodeLocations[nIndex].lat;
+					if (nodeLon <= viewableLonUnits.max && nodeLat <= viewableLatUnits.max &&
+						nodeLon >= viewableLonUnits.min && nodeLat >= viewableLatUnits.min)
 					{
-						Str8 populationStr = GetOsmNodeTagValue(node, StrLit("population"), Str8_Empty);
-						Str8 railwayStr = GetOsmNodeTagValue(node, StrLit("railway"), Str8_Empty);
+						v2d nodeLocation = ToV2dFromOsmLocation(nodeLocations[nIndex]);
+						OsmNode* node = VarArrayGet(OsmNode, &app->map.nodes, nIndex);
+						bool isNodeSelected = IsFlagSet(nodeFlags[nIndex], OsmNodeFlag_Selected);
+						bool isNodeHovered = IsFlagSet(nodeFlags[nIndex], OsmNodeFlag_Hovered);
+						Str8 populationStr = GetOsmNodeTagValue(&app->map, node, StrLit("population"), Str8_Empty);
+						Str8 railwayStr = GetOsmNodeTagValue(&app->map, node, StrLit("railway"), Str8_Empty);
 						u64 population = 0; TryParseU64(populationStr, &population, nullptr);
 						r32 populationLerp = InverseLerpClampR32(Thousand(50), Thousand(500), (r32)population);
 						r32 radius = (!IsEmptyStr(populationStr)) ? LerpR32(1.0, 10.0f, populationLerp) : 0.0f;
 						if (radius == 0.0f && StrAnyCaseEquals(railwayStr, StrLit("stop"))) { radius = 5.0f; }
 						if (app->map.ways.length == 0 && radius == 0.0f) { radius = 1.0f; } //Show all nodes when now ways were found
-						if (app->renderNodes && radius == 0.0f && node->wayPntrs.length == 0) { radius = 1.0f; } //Show nodes that aren't part of ways
+						if (app->renderNodes && radius == 0.0f && node->wayIndices.length == 0) { radius = 1.0f; } //Show nodes that aren't part of ways
 						
-						Str8 radiusStr = GetOsmNodeTagValue(node, StrLit("radius"), Str8_Empty);
+						Str8 radiusStr = GetOsmNodeTagValue(&app->map, node, StrLit("radius"), Str8_Empty);
 						if (!IsEmptyStr(radiusStr)) { TryParseR32(radiusStr, &radius, nullptr); }
 						
-						if (node->isSelected) { radius = 3.0f; }
-						else if (node->isHovered) { radius = 2.0f; }
+						if (isNodeSelected) { radius = 3.0f; }
+						else if (isNodeHovered) { radius = 2.0f; }
 						
 						if (radius > 0.0f)
 						{
 							Color32 outlineColor = Transparent;
 							Color32 nodeColor = (population < Thousand(50)) ? MonokaiGray2 : ColorLerpSimple(CartoTextOrange, CartoTextGreen, populationLerp);
-							Str8 colorStr = GetOsmNodeTagValue(node, StrLit("color"), Str8_Empty);
+							Str8 colorStr = GetOsmNodeTagValue(&app->map, node, StrLit("color"), Str8_Empty);
 							if (!IsEmptyStr(colorStr)) { TryParseColor(colorStr, &nodeColor, nullptr); }
 							
-							if (node->isSelected) { nodeColor = MonokaiGreen; outlineColor = CartoTextGreen; }
-							else if (node->isHovered) { nodeColor = MonokaiOrange; outlineColor = CartoTextOrange; }
+							if (isNodeSelected) { nodeColor = MonokaiGreen; outlineColor = CartoTextGreen; }
+							else if (isNodeHovered) { nodeColor = MonokaiOrange; outlineColor = CartoTextOrange; }
 							
-							v2d nodePos = MapProject(app->view.projection, node->location, mapScreenRec);
+							v2d nodePos = MapProject(app->view.projection, nodeLocation, mapScreenRec);
 							AlignV2d(&nodePos);
 							if (outlineColor.a > 0) { DrawCircle(MakeCircleV(ToV2Fromd(nodePos), radius + 1), outlineColor); }
 							DrawCircle(MakeCircleV(ToV2Fromd(nodePos), radius), nodeColor);
 							
-							Str8 japaneseNameStr = GetOsmNodeTagValue(node, StrLit("name:ja"), Str8_Empty);
-							if (IsEmptyStr(japaneseNameStr)) { japaneseNameStr = GetOsmNodeTagValue(node, StrLit("name"), Str8_Empty); }
-							Str8 englishNameStr = GetOsmNodeTagValue(node, StrLit("name:es"), Str8_Empty);
-							if (IsEmptyStr(englishNameStr)) { englishNameStr = GetOsmNodeTagValue(node, StrLit("name:en"), Str8_Empty); }
+							Str8 japaneseNameStr = GetOsmNodeTagValue(&app->map, node, StrLit("name:ja"), Str8_Empty);
+							if (IsEmptyStr(japaneseNameStr)) { japaneseNameStr = GetOsmNodeTagValue(&app->map, node, StrLit("name"), Str8_Empty); }
+							Str8 englishNameStr = GetOsmNodeTagValue(&app->map, node, StrLit("name:es"), Str8_Empty);
+							if (IsEmptyStr(englishNameStr)) { englishNameStr = GetOsmNodeTagValue(&app->map, node, StrLit("name:en"), Str8_Empty); }
 							
 							Color32 textColor = (outlineColor.a > 0) ? outlineColor : nodeColor;
 							v2 namePos = AddV2(ToV2Fromd(nodePos), MakeV2(0, -(radius + 5)));
@@ -1036,7 +1145,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 							if (ClayBtn("Open Recent >", "", false, nullptr)) { } Clay__CloseElement();
 						}
 						
-						if (ClayBtn("Save As...", "Ctrl+Shift+S", (app->map.arena != nullptr), nullptr))
+						if (ClayBtn("Save As...", "Ctrl+Shift+S", (app->map.arena != nullptr && !app->mapLoader.isLoading), nullptr))
 						{
 							Str8Pair extensions[] = {
 								{ StrLit("All Files"), StrLit("*.*") },
@@ -1057,6 +1166,7 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 						
 						if (ClayBtn("Close File", "Ctrl+W", true, nullptr))
 						{
+							CancelMapLoad();
 							FreeOsmMap(&app->map);
 							FreeStr8(stdHeap, &app->mapFilePath);
 						} Clay__CloseElement();
@@ -1094,6 +1204,54 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 					
 					CLAY({ .layout = { .sizing = { .width=CLAY_SIZING_GROW(0) } } }) {}
 					
+					// +==============================+
+					// |     Map Loading Progress     |
+					// +==============================+
+					if (app->mapLoader.isLoading)
+					{
+						MapLoader* loader = &app->mapLoader;
+						LockThreadMutex(&loader->progress.mutex);
+						u64 totalBytes = loader->progress.totalBytes;
+						u64 processedBytes = loader->progress.processedBytes;
+						uxx numBlobs = loader->progress.numBlobs;
+						uxx numBlobsProcessed = loader->progress.numBlobsProcessed;
+						UnlockThreadMutex(&loader->progress.mutex);
+						
+						r32 loadFraction = 0.0f;
+						if (totalBytes > 0) { loadFraction = (r32)ClampR64((r64)processedBytes / (r64)totalBytes, 0.0, 1.0); }
+						else if (numBlobs > 0) { loadFraction = (r32)ClampR64((r64)numBlobsProcessed / (r64)numBlobs, 0.0, 1.0); }
+						Str8 loadingFileName = GetFileNamePart(loader->filePath, true);
+						Str8 progressStr = (numBlobs > 0)
+							? PrintInArenaStr(uiArena, "Loading %.*s %d%% (%llu/%llu blobs, %.1f MB) Esc to cancel", StrPrint(loadingFileName), (int)(loadFraction * 100), (u64)numBlobsProcessed, (u64)numBlobs, (r64)processedBytes / (r64)Megabytes(1))
+							: PrintInArenaStr(uiArena, "Loading %.*s %d%% (%.1f MB) Esc to cancel", StrPrint(loadingFileName), (int)(loadFraction * 100), (r64)processedBytes / (r64)Megabytes(1));
+						CLAY_TEXT(
+							progressStr,
+							CLAY_TEXT_CONFIG({
+								.fontId = app->clayUiFontId,
+								.fontSize = (u16)app->uiFontSize,
+								.textColor = TEXT_WHITE,
+								.wrapMode = CLAY_TEXT_WRAP_NONE,
+							})
+						);
+						CLAY({ .layout = { .sizing = { .width=CLAY_SIZING_FIXED(UI_R32(4)) } } }) {}
+						CLAY({ .id = CLAY_ID("LoadProgressBar"),
+							.layout = {
+								.sizing = {
+									.width = CLAY_SIZING_FIXED(UI_R32(120)),
+									.height = CLAY_SIZING_FIXED(UI_R32(10)),
+								},
+							},
+							.backgroundColor = BACKGROUND_BLACK,
+							.border = { .color=OUTLINE_GRAY, .width=CLAY_BORDER_OUTSIDE(UI_BORDER(1)) },
+						})
+						{
+							CLAY({ .layout = { .sizing = { .width=CLAY_SIZING_FIXED(UI_R32(120) * loadFraction), .height=CLAY_SIZING_GROW(0) } },
+								.backgroundColor = SELECTED_BLUE,
+							}) {}
+						}
+						CLAY({ .layout = { .sizing = { .width=CLAY_SIZING_FIXED(UI_R32(10)) } } }) {}
+					}
+					
 					CLAY({ .id = CLAY_ID("FileNameDisplay") })
 					{
 						if (!IsEmptyStr(app->mapFilePath))
@@ -1329,43 +1487,47 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 													Str8 timestampStr = Str8_Empty;
 													Str8 user = Str8_Empty;
 													u64 uid = 0;
-													VarArray* tagsArray = nullptr;
-													VarArray* wayPntrsArray = nullptr;
-													VarArray* relationPntrsArray = nullptr;
+													OsmTagRange tagRange = ZEROED;
+													VarArray* wayIndicesArray = nullptr;
+													VarArray* relationIndicesArray = nullptr;
 													if (selectedItem->type == OsmPrimitiveType_Node)
 													{
-														itemId = selectedItem->nodePntr->id;
-														nameTag = GetOsmNodeTagValue(selectedItem->nodePntr, StrLit("name:en"), Str8_Empty);
-														if (IsEmptyStr(nameTag)) { nameTag = GetOsmNodeTagValue(selectedItem->nodePntr, StrLit("name"), Str8_Empty); }
-														visible = selectedItem->nodePntr->visible;
-														version = selectedItem->nodePntr->version;
-														changeset = selectedItem->nodePntr->changeset;
-														timestampStr = selectedItem->nodePntr->timestampStr;
-														user = selectedItem->nodePntr->user;
-														uid = selectedItem->nodePntr->uid;
-														tagsArray = &selectedItem->nodePntr->tags;
-														wayPntrsArray = &selectedItem->nodePntr->wayPntrs;
-														relationPntrsArray = &selectedItem->nodePntr->relationPntrs;
+														OsmNode* selectedNode = GetOsmNodeByIndex(&app->map, selectedItem->index);
+														itemId = selectedNode->id;
+														nameTag = GetOsmNodeTagValue(&app->map, selectedNode, StrLit("name:en"), Str8_Empty);
+														if (IsEmptyStr(nameTag)) { nameTag = GetOsmNodeTagValue(&app->map, selectedNode, StrLit("name"), Str8_Empty); }
+														OsmNodeInfo* selectedInfo = GetOsmNodeInfo(&app->map, selectedNode);
+														visible = selectedInfo->visible;
+														version = selectedInfo->version;
+														changeset = selectedInfo->changeset;
+														timestampStr = selectedInfo->timestampStr;
+														user = selectedInfo->user;
+														uid = selectedInfo->uid;
+														tagRange = selectedNode->tags;
+														wayIndicesArray = &selectedNode->wayIndices;
+														relationIndicesArray = &selectedNode->relationIndices;
 													}
 													else if (selectedItem->type == OsmPrimitiveType_Way)
 													{
-														itemId = selectedItem->wayPntr->id;
-														nameTag = GetOsmWayTagValue(selectedItem->wayPntr, StrLit("name:en"), Str8_Empty);
-														if (IsEmptyStr(nameTag)) { nameTag = GetOsmWayTagValue(selectedItem->wayPntr, StrLit("name"), Str8_Empty); }
-														visible = selectedItem->wayPntr->visible;
-														version = selectedItem->wayPntr->version;
-														changeset = selectedItem->wayPntr->changeset;
-														timestampStr = selectedItem->wayPntr->timestampStr;
-														user = selectedItem->wayPntr->user;
-														uid = selectedItem->wayPntr->uid;
-														tagsArray = &selectedItem->wayPntr->tags;
-														relationPntrsArray = &selectedItem->wayPntr->relationPntrs;
+														OsmWay* selectedWay = GetOsmWayByIndex(&app->map, selectedItem->index);
+														itemId = selectedWay->id;
+														nameTag = GetOsmWayTagValue(&app->map, selectedWay, StrLit("name:en"), Str8_Empty);
+														if (IsEmptyStr(nameTag)) { nameTag = GetOsmWayTagValue(&app->map, selectedWay, StrLit("name"), Str8_Empty); }
+														visible = selectedWay->visible;
+														version = selectedWay->version;
+														changeset = selectedWay->changeset;
+														timestampStr = selectedWay->timestampStr;
+														user = selectedWay->user;
+														uid = selectedWay->uid;
+														tagRange = selectedWay->tags;
+														relationIndicesArray = &selectedWay->relationIndices;
 													}
 													Str8 displayName = PrintInArenaStr(uiArena, "> %s %llu \"%.*s\"%s", GetOsmPrimitiveTypeStr(selectedItem->type), itemId, StrPrint(nameTag), visible ? "" : " (visible=false)");
 													INFO_PANEL_TEXT("Label_DisplayName", sIndex, displayName, MonokaiGreen);
 													if (selectedItem->type == OsmPrimitiveType_Way)
 													{
-														Str8 wayMetaStr = PrintInArenaStr(uiArena, "    %llu nodes%s", selectedItem->wayPntr->nodes.length, selectedItem->wayPntr->isClosedLoop ? " closed loop" : "");
+														OsmWay* selectedWay = GetOsmWayByIndex(&app->map, selectedItem->index);
+														Str8 wayMetaStr = PrintInArenaStr(uiArena, "    %llu nodes%s", selectedWay->nodes.length, selectedWay->isClosedLoop ? " closed loop" : "");
 														INFO_PANEL_TEXT("Label_WayMeta", sIndex, wayMetaStr, TEXT_GRAY);
 													}
 													
@@ -1395,12 +1557,13 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 														INFO_PANEL_TEXT("Label_UID", sIndex, uidStr, TEXT_GRAY);
 													}
 													
-													if (relationPntrsArray != nullptr)
+													if (relationIndicesArray != nullptr)
 													{
-														VarArrayLoop(relationPntrsArray, rIndex)
+														VarArrayLoop(relationIndicesArray, rIndex)
 														{
-															VarArrayLoopGetValue(OsmRelation*, relation, relationPntrsArray, rIndex);
-															Str8 relationName = GetOsmRelationTagValue(relation, StrLit("name"), Str8_Empty);
+															VarArrayLoopGetValue(u32, relationIndex, relationIndicesArray, rIndex);
+															OsmRelation* relation = GetOsmRelationByIndex(&app->map, relationIndex);
+															Str8 relationName = GetOsmRelationTagValue(&app->map, relation, StrLit("name"), Str8_Empty);
 															uxx memberIndex = UINTXX_MAX;
 															OsmRelationMemberRole role = OsmRelationMemberRole_None;
 															VarArrayLoop(&relation->members, mIndex)
@@ -1413,14 +1576,11 @@ EXPORT_FUNC APP_UPDATE_DEF(AppUpdate)
 															INFO_PANEL_TEXT("Label_Relation", sIndex*Million(1) + rIndex, relationStr, MonokaiPurple);
 														}
 													}
-													if (tagsArray != nullptr)
+													const OsmTag* tags = GetOsmTags(&app->map, tagRange);
+													for (u32 tIndex = 0; tIndex < tagRange.count; tIndex++)
 													{
-														VarArrayLoop(tagsArray, tIndex)
-														{
-															VarArrayLoopGet(OsmTag, tag, tagsArray, tIndex);
-															Str8 tagStr = PrintInArenaStr(uiArena, "  %.*s = \"%.*s\"", StrPrint(tag->key), StrPrint(tag->value));
-															INFO_PANEL_TEXT("Label_Tag", sIndex*Million(1) + tIndex, tagStr, TEXT_WHITE);
-														}
+														Str8 tagStr = PrintInArenaStr(uiArena, "  %.*s = \"%.*s\"", StrPrint(tags[tIndex].key), StrPrint(tags[tIndex].value));
+														INFO_PANEL_TEXT("Label_Tag", sIndex*Million(1) + tIndex, tagStr, TEXT_WHITE);
 													}
 												}
 											}
@@ -1552,6 +1712,9 @@ EXPORT_FUNC APP_CLOSING_DEF(AppClosing)
 	#endif
 	
 	AppSaveRecentFilesList();
+	CancelMapLoad();
+	FreeWorkerPool(&app->loaderPool);
+	FreeWorkerPool(&app->workerPool);
 	
 	ScratchEnd(scratch);
 	ScratchEnd(scratch2);
@@ -40,6 +40,27 @@ plex MapTile
 	Texture texture;
 };
 
+// OpenOsmMap loads on app->loaderPool's thread, see app_map_loader.c. Only the main thread touches this unless noted otherwise
+typedef plex MapLoader MapLoader;
+plex MapLoader
+{
+	bool isLoading;
+	bool addToMap;
+	bool isPreviewing; //app->map is the preview of the file being loaded, the old map is in prevMap until the load succeeds
+	FilePath filePath;
+	OsmMap prevMap; //app->map from before the preview was swapped in, given back if the load fails or is canceled
+	Str8 prevMapFilePath;
+	MapView prevView;
+	OsTime startTime;
+	OsmLoadProgress progress;
+	WorkerWaitGroup waitGroup; //just the MapLoaderJob
+	
+	//NOTE: These are written by the loader thread while it holds progress.mutex
+	bool isFinished;
+	Result result;
+	OsmMap newMap;
+};
+
 typedef plex AppData AppData;
 plex AppData
 {
@@ -51,6 +72,9 @@ plex AppData
 	r32 prevUpdateMs;
 	PerfGraph perfGraph;
 	bool showPerfGraph;
+	WorkerPool workerPool;
+	WorkerPool loaderPool; //a single thread with as much scratch as the main thread (see MAP_LOADER_SCRATCH_SIZE), see MapLoader
+	MapLoader mapLoader;
 	
 	Shader mainShader;
 	PigFont uiFont;
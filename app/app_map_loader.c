@@ -0,0 +1,220 @@
+/*
+File:   app_map_loader.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds OpenOsmMap, which loads the map on app->loaderPool's thread so the window keeps updating
+	** while a large file loads, along with the functions that show the preview while it's loading,
+	** cancel it, and swap the new map in once it's done
+*/
+
+void FitMapViewToBounds(recd bounds)
+{
+	v2d boundsOnMapTopLeft = MapProject(app->view.projection, bounds.topLeft, app->view.mapRec);
+	v2d boundsOnMapBottomRight = MapProject(app->view.projection, AddV2d(bounds.topLeft, bounds.size), app->view.mapRec);
+	recd boundsOnMap = NewRecdBetweenV(boundsOnMapTopLeft, boundsOnMapBottomRight);
+	app->view.position = AddV2d(boundsOnMap.topLeft, ShrinkV2d(boundsOnMap.size, 2.0));
+	rec mainViewportRec = GetClayElementDrawRecNt("MainViewport");
+	if (boundsOnMap.width > 0 && boundsOnMap.height > 0 && mainViewportRec.width > 0)
+	{
+		app->view.zoom = MinR64(
+			mainViewportRec.width / boundsOnMap.width,
+			mainViewportRec.height / boundsOnMap.height
+		);
+	}
+}
+
+// Runs on app->loaderPool's thread. The parsing itself still spreads out over app->workerPool
+WORKER_JOB_DEF(MapLoaderJob)
+{
+	MapLoader* loader = (MapLoader*)contextPntr;
+	TracyCZoneN(funcZone, "MapLoaderJob", true);
+	ScratchBegin(scratch);
+	
+	OsmLoadOptions loadOptions = ZEROED;
+	loadOptions.workerPool = &app->workerPool;
+	loadOptions.useLocationsOnWays = LOAD_USE_LOCATIONS_ON_WAYS;
+	loadOptions.progress = &loader->progress;
+	OsmTagFilter tagFilter = ZEROED;
+	Str8 tagFilterStr = StrLit(LOAD_TAG_FILTER);
+	if (!IsEmptyStr(tagFilterStr))
+	{
+		Result compileResult = TryCompileOsmTagFilter(scratch, tagFilterStr, &tagFilter);
+		if (compileResult == Result_Success)
+		{
+			loadOptions.tagFilter = &tagFilter;
+			loadOptions.tagFilterNodes = OsmTagFilterNodes_WayNodes;
+		}
+		else { NotifyPrint_W("Ignoring invalid tag filter \"%.*s\": %s", StrPrint(tagFilterStr), GetResultStr(compileResult)); }
+	}
+	
+	OsmMap newMap = ZEROED;
+	Result parseResult = TryParseMapFile(scratch, loader->filePath, &loadOptions, &newMap);
+	
+	LockThreadMutex(&loader->progress.mutex);
+	MyMemCopy(&loader->newMap, &newMap, sizeof(OsmMap));
+	loader->result = parseResult;
+	loader->isFinished = true;
+	UnlockThreadMutex(&loader->progress.mutex);
+	
+	ScratchEnd(scratch);
+	TracyCZoneEnd(funcZone);
+}
+
+// Frees everything the MapLoader holds. The loader thread must not be running. If we are still previewing then the load
+// didn't make it into app->map so the preview is thrown away and the map (and view) from before the load are put back
+void FreeMapLoader(MapLoader* loader)
+{
+	NotNull(loader);
+	if (loader->isLoading)
+	{
+		if (loader->isFinished && loader->result == Result_Success) { FreeOsmMap(&loader->newMap); }
+		//NOTE: The preview ways in app->map have tags that point into progress.previewStrings so the map has to go first
+		if (loader->isPreviewing)
+		{
+			FreeOsmMap(&app->map);
+			FreeStr8(stdHeap, &app->mapFilePath);
+			MyMemCopy(&app->map, &loader->prevMap, sizeof(OsmMap));
+			app->mapFilePath = loader->prevMapFilePath;
+			app->view.position = loader->prevView.position;
+			app->view.zoom = loader->prevView.zoom;
+			loader->isPreviewing = false;
+		}
+		FreeOsmLoadProgress(&loader->progress);
+		FreeStr8(stdHeap, &loader->filePath);
+	}
+	ClearPointer(loader);
+}
+
+// Blocks until the loader thread notices (at most one blob or OSM_LOAD_PROGRESS_PERIOD elements later) and throws away whatever it loaded.
+// The map that was open before the load comes back (see FreeMapLoader)
+void CancelMapLoad()
+{
+	MapLoader* loader = &app->mapLoader;
+	if (!loader->isLoading) { return; }
+	TracyCZoneN(funcZone, "CancelMapLoad", true);
+	PrintLine_I("Canceling the load of \"%.*s\"", StrPrint(loader->filePath));
+	RequestOsmLoadCancel(&loader->progress);
+	WaitForWorkerWaitGroup(&loader->waitGroup);
+	FreeMapLoader(loader);
+	TracyCZoneEnd(funcZone);
+}
+
+// The load happens in the background, UpdateMapLoader swaps the new map in once it's done. Opening another file while one is loading cancels the first one
+void OpenOsmMap(FilePath filePath, bool addToMap)
+{
+	TracyCZoneN(funcZone, "OpenOsmMap", true);
+	MapLoader* loader = &app->mapLoader;
+	if (loader->isLoading) { CancelMapLoad(); }
+	
+	ClearPointer(loader);
+	loader->isLoading = true;
+	loader->addToMap = (addToMap && app->map.arena != nullptr);
+	loader->filePath = AllocStr8(stdHeap, filePath);
+	loader->startTime = OsGetTime();
+	//NOTE: Adding to the current map doesn't get a preview, there's nowhere to put it without touching the map the user is looking at
+	InitOsmLoadProgress(loader->addToMap ? nullptr : stdHeap, DISPLAY_WAY_COUNT_LIMIT, &loader->progress);
+	PrintLine_I("Loading \"%.*s\"...", StrPrint(loader->filePath));
+	InitWorkerWaitGroup(&app->loaderPool, &loader->waitGroup);
+	WorkerPoolQueueJob(&loader->waitGroup, MapLoaderJob, loader);
+	
+	TracyCZoneEnd(funcZone);
+}
+
+void FinishMapLoad()
+{
+	TracyCZoneN(funcZone, "FinishMapLoad", true);
+	MapLoader* loader = &app->mapLoader;
+	//NOTE: isFinished is set right before the job returns, this makes sure it's completely done with the loader before we free anything
+	WaitForWorkerWaitGroup(&loader->waitGroup);
+	r32 loadMs = OsTimeDiffMsR32(loader->startTime, OsGetTime());
+	
+	if (loader->result == Result_Success)
+	{
+		OsmMap* newMap = &loader->newMap;
+		PrintLine_I("Parsed map in %.0fms! %llu node%s, %llu way%s, %llu relation%s", loadMs,
+			newMap->nodes.length, Plural(newMap->nodes.length, "s"),
+			newMap->ways.length, Plural(newMap->ways.length, "s"),
+			newMap->relations.length, Plural(newMap->relations.length, "s")
+		);
+		
+		bool wasPreviewing = loader->isPreviewing;
+		if (loader->addToMap && app->map.arena != nullptr)
+		{
+			OsmAddFromMap(&app->map, newMap);
+			FreeOsmMap(newMap);
+		}
+		else
+		{
+			FreeStr8(stdHeap, &app->mapFilePath);
+			FreeOsmMap(&app->map);
+			MyMemCopy(&app->map, newMap, sizeof(OsmMap));
+			ClearPointer(newMap);
+			app->mapFilePath = AllocStr8(stdHeap, loader->filePath);
+			if (wasPreviewing)
+			{
+				//The load made it, now the map from before the preview can go
+				FreeOsmMap(&loader->prevMap);
+				FreeStr8(stdHeap, &loader->prevMapFilePath);
+				loader->isPreviewing = false;
+			}
+		}
+		AppRememberRecentFile(loader->filePath);
+		
+		//NOTE: The view was already moved to the bounds when the preview showed up, the user may have moved it since then
+		if (!wasPreviewing) { FitMapViewToBounds(app->map.bounds); }
+		
+		TracyCZoneN(_FindInternationalCodepoints, "FindInternationalCodepoints", true);
+		FindInternationalCodepointsInMapNames(&app->map, &app->kanjiCodepoints);
+		TracyCZoneEnd(_FindInternationalCodepoints);
+		
+		//TODO: This is taking like 40-50ms now. We should really work on changing how we display international codepoints
+		TracyCZoneN(_CreatingFonts, "CreatingFonts", true);
+		bool fontBakeSuccess = AppCreateFonts();
+		TracyCZoneEnd(_CreatingFonts);
+		
+		Assert(fontBakeSuccess);
+		UNUSED(fontBakeSuccess);
+	}
+	else if (loader->result == Result_Canceled) { PrintLine_I("Load of \"%.*s\" was canceled after %.0fms", StrPrint(loader->filePath), loadMs); }
+	else
+	{
+		//NOTE: TryParseMapFile only prints the details to the console since it runs on the loader thread, the user is told here.
+		//      If there was a preview FreeMapLoader puts the previous map back
+		NotifyPrint_E("Failed to load \"%.*s\": %s", StrPrint(GetFileNamePart(loader->filePath, true)), GetResultStr(loader->result));
+	}
+	
+	FreeMapLoader(loader);
+	TracyCZoneEnd(funcZone);
+}
+
+// Called once a frame. Moves any preview ways the loader has made into app->map and swaps the new map in when the load is done
+void UpdateMapLoader()
+{
+	MapLoader* loader = &app->mapLoader;
+	if (!loader->isLoading) { return; }
+	TracyCZoneN(funcZone, "UpdateMapLoader", true);
+	
+	LockThreadMutex(&loader->progress.mutex);
+	bool isFinished = loader->isFinished;
+	bool hasPreviewWays = (loader->progress.previewWays.length > 0);
+	UnlockThreadMutex(&loader->progress.mutex);
+	
+	//NOTE: The old map (and view) is set aside in loader->prevMap while we preview, FinishMapLoad only frees it once the load succeeds
+	if (!loader->isPreviewing && hasPreviewWays && !isFinished)
+	{
+		MyMemCopy(&loader->prevMap, &app->map, sizeof(OsmMap));
+		ClearPointer(&app->map);
+		loader->prevMapFilePath = app->mapFilePath;
+		MyMemCopy(&loader->prevView, &app->view, sizeof(MapView));
+		InitOsmMap(stdHeap, &app->map, 0, DISPLAY_WAY_COUNT_LIMIT, 0, 0);
+		app->mapFilePath = AllocStr8(stdHeap, loader->filePath);
+		loader->isPreviewing = true;
+		TakeOsmLoadPreview(&loader->progress, &app->map);
+		FitMapViewToBounds(app->map.bounds);
+	}
+	else if (loader->isPreviewing) { TakeOsmLoadPreview(&loader->progress, &app->map); }
+	
+	if (isFinished) { FinishMapLoad(); }
+	TracyCZoneEnd(funcZone);
+}
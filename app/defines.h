@@ -66,6 +66,15 @@ Date:   02\25\2025
 #define DISPLAY_NODE_COUNT_LIMIT     Thousand(100)
 #define DISPLAY_WAY_COUNT_LIMIT      Thousand(30)
 
+#define NUM_WORKER_THREADS           0 //threads, 0 means one per processor core
+#define MAP_LOADER_SCRATCH_SIZE      Gigabytes(4) //virtual, app->loaderPool's thread needs as much scratch as the main thread since TryParseMapFile reads whole files into scratch when it can't map them
+
+// #define LOAD_TAG_FILTER              "highway or railway=rail" //only load the ways and relations that match this (see osm_tag_filter.c for the syntax) and the nodes they need
+#define LOAD_TAG_FILTER              ""
+#define LOAD_USE_LOCATIONS_ON_WAYS   1 //.pbf files with the "LocationsOnWays" feature (ex. osmium add-locations-to-ways) skip adding untagged nodes to the map
+#define OSM_FIXED_POINT_LOCATIONS    0 //node (and inline way) locations are kept as i32 pairs in 1e-7 degree units (OSM's own precision) instead of doubles, half the memory
+#define DEBUG_PBF_CODEC_STATS        0 //print how many blobs of each codec a .pbf load went through (sizes and time spent decompressing) and how well a .pbf save compressed
+
 #define NOTIFICATION_ICONS_TEXTURE_PATH "resources/image/notifications_2x2.png"
 #define NOTIFICATION_ICONS_SIZE 16 //px
 
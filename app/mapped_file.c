@@ -0,0 +1,109 @@
+/*
+File:   mapped_file.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds functions that map an entire file into our address space (read-only) so large files like
+	** .pbf extracts can be parsed in place without reading them into an arena first. As the parser
+	** advances it calls MappedFileReadahead so the OS starts paging in the next part of the file
+	** before we touch it. When mapping isn't supported on a platform TryOpenMappedFile simply fails
+	** and the caller should fall back to reading the file through an OsFile
+*/
+
+void CloseMappedFile(MappedFile* file)
+{
+	NotNull(file);
+	#if MAPPED_FILE_SUPPORTED
+	if (file->isOpen)
+	{
+		#if TARGET_IS_WINDOWS
+		if (file->bytes != nullptr) { UnmapViewOfFile(file->bytes); }
+		if (file->mappingHandle != NULL) { CloseHandle(file->mappingHandle); }
+		if (file->fileHandle != INVALID_HANDLE_VALUE) { CloseHandle(file->fileHandle); }
+		#else
+		if (file->bytes != nullptr) { munmap(file->bytes, file->size); }
+		if (file->fileDescriptor >= 0) { close(file->fileDescriptor); }
+		#endif
+	}
+	#endif
+	ClearPointer(file);
+}
+
+bool TryOpenMappedFile(FilePath path, MappedFile* fileOut)
+{
+	NotNull(fileOut);
+	ClearPointer(fileOut);
+	#if !MAPPED_FILE_SUPPORTED
+	UNUSED(path);
+	return false;
+	#else
+	TracyCZoneN(Zone_Func, "TryOpenMappedFile", true);
+	ScratchBegin(scratch);
+	Str8 pathNt = PrintInArenaStr(scratch, "%.*s", StrPrint(path));
+	bool result = false;
+	
+	#if TARGET_IS_WINDOWS
+	fileOut->isOpen = true;
+	fileOut->fileHandle = CreateFileA(pathNt.chars, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	LARGE_INTEGER fileSize = ZEROED;
+	if (fileOut->fileHandle != INVALID_HANDLE_VALUE && GetFileSizeEx(fileOut->fileHandle, &fileSize) && fileSize.QuadPart > 0)
+	{
+		fileOut->size = (uxx)fileSize.QuadPart;
+		fileOut->mappingHandle = CreateFileMappingA(fileOut->fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (fileOut->mappingHandle != NULL)
+		{
+			fileOut->bytes = (u8*)MapViewOfFile(fileOut->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+			result = (fileOut->bytes != nullptr);
+		}
+	}
+	#else
+	fileOut->isOpen = true;
+	fileOut->fileDescriptor = open(pathNt.chars, O_RDONLY);
+	struct stat fileStat = ZEROED;
+	if (fileOut->fileDescriptor >= 0 && fstat(fileOut->fileDescriptor, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		fileOut->size = (uxx)fileStat.st_size;
+		void* mappedPntr = mmap(nullptr, fileOut->size, PROT_READ, MAP_PRIVATE, fileOut->fileDescriptor, 0);
+		if (mappedPntr != MAP_FAILED)
+		{
+			fileOut->bytes = (u8*)mappedPntr;
+			//NOTE: Sequential lets the kernel read further ahead and drop pages behind us sooner
+			madvise(fileOut->bytes, fileOut->size, MADV_SEQUENTIAL);
+			result = true;
+		}
+	}
+	#endif
+	
+	if (!result) { CloseMappedFile(fileOut); }
+	ScratchEnd(scratch);
+	TracyCZoneEnd(Zone_Func);
+	return result;
+	#endif
+}
+
+// Call this as the reader advances. Once the reader gets within half a window of what we've already hinted we ask the OS
+// to start paging in the next MAPPED_FILE_READAHEAD_SIZE bytes. This is only a hint, nothing breaks if the OS ignores it
+void MappedFileReadahead(MappedFile* file, uxx readOffset)
+{
+	NotNull(file);
+	#if MAPPED_FILE_SUPPORTED
+	if (!file->isOpen || file->readaheadOffset >= file->size) { return; }
+	if (readOffset + (MAPPED_FILE_READAHEAD_SIZE/2) < file->readaheadOffset) { return; }
+	uxx hintOffset = MaxUXX(file->readaheadOffset, readOffset);
+	uxx hintLength = MinUXX(MAPPED_FILE_READAHEAD_SIZE, file->size - hintOffset);
+	#if TARGET_IS_WINDOWS
+	WIN32_MEMORY_RANGE_ENTRY rangeEntry = ZEROED;
+	rangeEntry.VirtualAddress = &file->bytes[hintOffset];
+	rangeEntry.NumberOfBytes = hintLength;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &rangeEntry, 0);
+	#else
+	//NOTE: madvise requires a page aligned address
+	uxx pageSize = (uxx)sysconf(_SC_PAGESIZE);
+	uxx alignedOffset = hintOffset - (hintOffset % pageSize);
+	madvise(&file->bytes[alignedOffset], hintLength + (hintOffset - alignedOffset), MADV_WILLNEED);
+	#endif
+	file->readaheadOffset = hintOffset + hintLength;
+	#else
+	UNUSED(readOffset);
+	#endif
+}
@@ -0,0 +1,42 @@
+/*
+File:   mapped_file.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#if TARGET_IS_LINUX || TARGET_IS_OSX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define MAPPED_FILE_SUPPORTED 1
+#elif TARGET_IS_WINDOWS
+#define MAPPED_FILE_SUPPORTED 1
+#else
+#define MAPPED_FILE_SUPPORTED 0
+#endif
+
+#define MAPPED_FILE_READAHEAD_SIZE Megabytes(16) //how far ahead of the reader we ask the OS to start paging in
+
+// A read-only view of an entire file. The bytes stay valid until CloseMappedFile is called
+typedef plex MappedFile MappedFile;
+plex MappedFile
+{
+	bool isOpen;
+	uxx size;
+	u8* bytes;
+	uxx readaheadOffset; //everything before this has already been hinted by MappedFileReadahead
+	#if !MAPPED_FILE_SUPPORTED
+	u8 unused;
+	#elif TARGET_IS_WINDOWS
+	HANDLE fileHandle;
+	HANDLE mappingHandle;
+	#else
+	int fileDescriptor;
+	#endif
+};
+
+#endif //  _MAPPED_FILE_H
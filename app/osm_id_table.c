@@ -0,0 +1,148 @@
+/*
+File:   osm_id_table.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the functions that build, update and search an OsmIdTable
+*/
+
+void FreeOsmIdTable(OsmIdTable* table)
+{
+	NotNull(table);
+	if (table->arena != nullptr && table->numSlots > 0)
+	{
+		FreeArray(u64, table->arena, table->numSlots, table->slotIds);
+		FreeArray(u32, table->arena, table->numSlots, table->slotIndices);
+	}
+	ClearPointer(table);
+}
+
+void InitOsmIdTable(Arena* arena, OsmIdTable* tableOut)
+{
+	NotNull(arena);
+	NotNull(tableOut);
+	ClearPointer(tableOut);
+	tableOut->arena = arena;
+}
+
+// Ids are mostly sequential so we can't just mask off the low bits, this is the finalizer from MurmurHash3
+uxx HashOsmId(u64 id)
+{
+	id ^= (id >> 33);
+	id *= 0xFF51AFD7ED558CCDULL;
+	id ^= (id >> 33);
+	id *= 0xC4CEB9FE1A85EC53ULL;
+	id ^= (id >> 33);
+	return (uxx)id;
+}
+
+// Drops every entry, the next lookup adds everything in the array again. The slots are kept so that doesn't have to reallocate them
+void InvalidateOsmIdTable(OsmIdTable* table)
+{
+	NotNull(table);
+	if (table->numSlots > 0) { MyMemSet(table->slotIndices, 0xFF, sizeof(u32) * table->numSlots); } //0xFFFFFFFF is OSM_ID_TABLE_EMPTY
+	table->numEntries = 0;
+	table->numIndexed = 0;
+}
+
+// Makes room for numEntries without going over OSM_ID_TABLE_MAX_LOAD, rehashing everything that's in there
+void ReserveOsmIdTable(OsmIdTable* table, uxx numEntries)
+{
+	NotNull(table);
+	NotNull(table->arena);
+	uxx newNumSlots = MaxUXX(table->numSlots, OSM_ID_TABLE_MIN_SLOTS);
+	while (numEntries * 100 > newNumSlots * OSM_ID_TABLE_MAX_LOAD) { newNumSlots *= 2; }
+	if (newNumSlots == table->numSlots) { return; }
+	TracyCZoneN(Zone_Func, "ReserveOsmIdTable", true);
+	
+	u64* newSlotIds = AllocArray(u64, table->arena, newNumSlots);
+	u32* newSlotIndices = AllocArray(u32, table->arena, newNumSlots);
+	NotNull(newSlotIds);
+	NotNull(newSlotIndices);
+	MyMemSet(newSlotIndices, 0xFF, sizeof(u32) * newNumSlots);
+	uxx slotMask = newNumSlots - 1;
+	for (uxx sIndex = 0; sIndex < table->numSlots; sIndex++)
+	{
+		if (table->slotIndices[sIndex] == OSM_ID_TABLE_EMPTY) { continue; }
+		uxx newSlotIndex = HashOsmId(table->slotIds[sIndex]) & slotMask;
+		while (newSlotIndices[newSlotIndex] != OSM_ID_TABLE_EMPTY) { newSlotIndex = (newSlotIndex + 1) & slotMask; }
+		newSlotIds[newSlotIndex] = table->slotIds[sIndex];
+		newSlotIndices[newSlotIndex] = table->slotIndices[sIndex];
+	}
+	if (table->numSlots > 0)
+	{
+		FreeArray(u64, table->arena, table->numSlots, table->slotIds);
+		FreeArray(u32, table->arena, table->numSlots, table->slotIndices);
+	}
+	table->slotIds = newSlotIds;
+	table->slotIndices = newSlotIndices;
+	table->numSlots = newNumSlots;
+	TracyCZoneValue(Zone_Func, newNumSlots);
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Doesn't grow the table, call ReserveOsmIdTable first. When the id is already in the table the first index is kept, the same one a linear scan would find
+void InsertOsmIdTableEntry(OsmIdTable* table, u64 id, uxx index)
+{
+	Assert(index < OSM_ID_TABLE_EMPTY);
+	uxx slotMask = table->numSlots - 1;
+	uxx slotIndex = HashOsmId(id) & slotMask;
+	while (table->slotIndices[slotIndex] != OSM_ID_TABLE_EMPTY)
+	{
+		if (table->slotIds[slotIndex] == id) { return; }
+		slotIndex = (slotIndex + 1) & slotMask;
+	}
+	table->slotIds[slotIndex] = id;
+	table->slotIndices[slotIndex] = (u32)index;
+	table->numEntries++;
+}
+
+// Called by AddOsmNode/Way/Relation for the item they just added at index. Does nothing until the table has been built, or when
+// something else was appended to the array first (the next lookup adds both)
+void AddOsmIdTableEntry(OsmIdTable* table, u64 id, uxx index)
+{
+	NotNull(table);
+	if (table->numSlots == 0 || table->numIndexed != index) { return; }
+	ReserveOsmIdTable(table, table->numEntries + 1);
+	InsertOsmIdTableEntry(table, id, index);
+	table->numIndexed++;
+}
+
+// Adds array items [numIndexed, numItems) to the table. firstId points at the id member of item 0 and idStride is the size of the items
+void SyncOsmIdTable(OsmIdTable* table, uxx numItems, const u64* firstId, uxx idStride)
+{
+	NotNull(table);
+	if (table->numIndexed >= numItems) { return; }
+	TracyCZoneN(Zone_Func, "SyncOsmIdTable", true);
+	ReserveOsmIdTable(table, table->numEntries + (numItems - table->numIndexed));
+	const u8* idBytes = (const u8*)firstId;
+	for (uxx iIndex = table->numIndexed; iIndex < numItems; iIndex++)
+	{
+		InsertOsmIdTableEntry(table, *(const u64*)&idBytes[iIndex * idStride], iIndex);
+	}
+	TracyCZoneValue(Zone_Func, numItems - table->numIndexed);
+	table->numIndexed = numItems;
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Returns the array index for the id, or numIndexed when it's not in the table. Call SyncOsmIdTable first
+uxx FindOsmIdTableIndex(const OsmIdTable* table, u64 id)
+{
+	NotNull(table);
+	if (table->numSlots == 0) { return table->numIndexed; }
+	uxx slotMask = table->numSlots - 1;
+	uxx slotIndex = HashOsmId(id) & slotMask;
+	while (table->slotIndices[slotIndex] != OSM_ID_TABLE_EMPTY)
+	{
+		if (table->slotIds[slotIndex] == id) { return (uxx)table->slotIndices[slotIndex]; }
+		slotIndex = (slotIndex + 1) & slotMask;
+	}
+	return table->numIndexed;
+}
+
+// How many bytes the slots take up
+uxx GetOsmIdTableMemoryUsage(const OsmIdTable* table)
+{
+	NotNull(table);
+	return table->numSlots * (sizeof(u64) + sizeof(u32));
+}
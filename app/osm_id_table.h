@@ -0,0 +1,31 @@
+/*
+File:   osm_id_table.h
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** An OsmIdTable maps the ids of one kind of primitive in an OsmMap to their index in the map's array.
+	** It's an open addressed table that holds indices rather than pointers so it stays valid when the array grows.
+*/
+
+#ifndef _OSM_ID_TABLE_H
+#define _OSM_ID_TABLE_H
+
+#define OSM_ID_TABLE_MIN_SLOTS   1024 //must be a power of 2
+#define OSM_ID_TABLE_MAX_LOAD    70 //percent, the slots double when there are more entries than this
+#define OSM_ID_TABLE_EMPTY       UINT32_MAX
+
+//NOTE: The table is only built the first time something is looked up, loads that never call FindOsmNode/Way/Relation don't pay for it.
+//      After that AddOsmNode/Way/Relation add to it as they go and anything appended to the array some other way is picked up on the next lookup.
+//      Anything that moves or removes entries in the array (sorting it, compacting it) has to call InvalidateOsmIdTable
+typedef plex OsmIdTable OsmIdTable;
+plex OsmIdTable
+{
+	Arena* arena;
+	uxx numSlots; //0 until the table is built
+	u64* slotIds;
+	u32* slotIndices; //OSM_ID_TABLE_EMPTY for empty slots, otherwise an index into the map's array
+	uxx numEntries;
+	uxx numIndexed; //the first numIndexed items of the array are in the table
+};
+
+#endif //  _OSM_ID_TABLE_H
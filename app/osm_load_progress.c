@@ -0,0 +1,221 @@
+/*
+File:   osm_load_progress.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the functions that the loaders use to report their progress (and make a preview of the map)
+	** and that the main thread uses to read it back, cancel the load or take the preview ways
+*/
+
+void FreeOsmLoadProgress(OsmLoadProgress* progress)
+{
+	NotNull(progress);
+	if (progress->previewArena != nullptr)
+	{
+		VarArrayLoop(&progress->previewWays, wIndex)
+		{
+			VarArrayLoopGet(OsmWay, way, &progress->previewWays, wIndex);
+			FreeOsmWay(progress->previewArena, way);
+		}
+		FreeVarArray(&progress->previewWays);
+		FreeVarArray(&progress->previewTags);
+		FreeOsmStringPool(&progress->previewStrings);
+	}
+	FreeThreadMutex(&progress->mutex);
+	ClearPointer(progress);
+}
+
+// Pass nullptr for previewArena if nobody is going to take the preview ways
+void InitOsmLoadProgress(Arena* previewArena, uxx maxPreviewWays, OsmLoadProgress* progressOut)
+{
+	NotNull(progressOut);
+	ClearPointer(progressOut);
+	InitThreadMutex(&progressOut->mutex);
+	if (previewArena != nullptr)
+	{
+		progressOut->previewArena = previewArena;
+		progressOut->maxPreviewWays = maxPreviewWays;
+		InitVarArray(OsmWay, &progressOut->previewWays, previewArena);
+		InitVarArray(OsmTag, &progressOut->previewTags, previewArena);
+		InitOsmStringPool(previewArena, &progressOut->previewStrings);
+	}
+}
+
+void RequestOsmLoadCancel(OsmLoadProgress* progress)
+{
+	NotNull(progress);
+	LockThreadMutex(&progress->mutex);
+	progress->cancelRequested = true;
+	UnlockThreadMutex(&progress->mutex);
+}
+
+// The loaders call this every so often and stop with Result_Canceled when it returns true. progress can be nullptr
+bool IsOsmLoadCanceled(OsmLoadProgress* progress)
+{
+	if (progress == nullptr) { return false; }
+	LockThreadMutex(&progress->mutex);
+	bool result = progress->cancelRequested;
+	UnlockThreadMutex(&progress->mutex);
+	return result;
+}
+
+void SetOsmLoadProgressTotal(OsmLoadProgress* progress, u64 totalBytes, uxx numBlobs)
+{
+	if (progress == nullptr) { return; }
+	LockThreadMutex(&progress->mutex);
+	progress->totalBytes = totalBytes;
+	progress->numBlobs = numBlobs;
+	UnlockThreadMutex(&progress->mutex);
+}
+
+void AddOsmLoadProgress(OsmLoadProgress* progress, u64 numBytes, uxx numBlobs)
+{
+	if (progress == nullptr) { return; }
+	LockThreadMutex(&progress->mutex);
+	progress->processedBytes += numBytes;
+	progress->numBlobsProcessed += numBlobs;
+	UnlockThreadMutex(&progress->mutex);
+}
+
+// For loaders that can only estimate how far through the source they are
+void SetOsmLoadProgressBytes(OsmLoadProgress* progress, u64 processedBytes)
+{
+	if (progress == nullptr) { return; }
+	LockThreadMutex(&progress->mutex);
+	progress->processedBytes = processedBytes;
+	UnlockThreadMutex(&progress->mutex);
+}
+
+// Called by the loader after it adds ways to the map it's building. Copies any ways it hasn't seen yet into previewWays with the locations of their
+// nodes filled in. Ways that reference nodes we don't have (yet) are left out. If the loader sorts the ways after we've seen some of them the preview
+// might miss or repeat a few, which is fine
+void PublishOsmLoadPreview(OsmLoadProgress* progress, OsmMap* map)
+{
+	if (progress == nullptr || progress->previewArena == nullptr) { return; }
+	NotNull(map);
+	TracyCZoneN(funcZone, "PublishOsmLoadPreview", true);
+	Arena* arena = progress->previewArena;
+	
+	//NOTE: Only this thread writes to numPreviewWays and hasPreviewBounds so we don't need the lock to read them
+	if (!progress->hasPreviewBounds && (map->bounds.sizeLon != 0 || map->bounds.sizeLat != 0))
+	{
+		LockThreadMutex(&progress->mutex);
+		progress->hasPreviewBounds = true;
+		progress->previewBounds = map->bounds;
+		UnlockThreadMutex(&progress->mutex);
+	}
+	if (progress->numPreviewWays >= progress->maxPreviewWays) { progress->numWaysChecked = map->ways.length; }
+	if (progress->numWaysChecked >= map->ways.length) { TracyCZoneEnd(funcZone); return; }
+	
+	ScratchBegin(scratch);
+	VarArray newWays; //OsmWay
+	InitVarArray(OsmWay, &newWays, scratch);
+	VarArray newTags; //OsmTag
+	InitVarArray(OsmTag, &newTags, scratch);
+	VarArray locationsBuffer; //v2d
+	InitVarArray(v2d, &locationsBuffer, scratch);
+	uxx wIndex = progress->numWaysChecked;
+	for (; wIndex < map->ways.length && progress->numPreviewWays + newWays.length < progress->maxPreviewWays; wIndex++)
+	{
+		OsmWay* way = VarArrayGet(OsmWay, &map->ways, wIndex);
+		if (way->nodes.length == 0) { continue; }
+		VarArrayClear(&locationsBuffer);
+		VarArrayExpand(&locationsBuffer, way->nodes.length);
+		bool foundAllNodes = true;
+		VarArrayLoop(&way->nodes, nIndex)
+		{
+			v2d location = V2d_Zero;
+			if (!TryGetOsmWayNodeLocation(map, way, nIndex, &location))
+			{
+				OsmNode* node = FindOsmNode(map, VarArrayGet(OsmNodeRef, &way->nodes, nIndex)->id);
+				if (node == nullptr) { foundAllNodes = false; break; }
+				location = GetOsmNodeLocation(map, node);
+			}
+			VarArrayAddValue(v2d, &locationsBuffer, location);
+		}
+		if (!foundAllNodes) { continue; }
+		
+		OsmWay* previewWay = VarArrayAdd(OsmWay, &newWays);
+		NotNull(previewWay);
+		ClearPointer(previewWay);
+		previewWay->id = way->id;
+		previewWay->visible = way->visible;
+		previewWay->isClosedLoop = way->isClosedLoop;
+		InitVarArrayWithInitial(OsmNodeRef, &previewWay->nodes, arena, way->nodes.length);
+		VarArrayLoop(&way->nodes, nIndex)
+		{
+			OsmNodeRef* newRef = VarArrayAdd(OsmNodeRef, &previewWay->nodes);
+			NotNull(newRef);
+			newRef->id = VarArrayGet(OsmNodeRef, &way->nodes, nIndex)->id;
+			newRef->nodeIndex = OSM_INVALID_INDEX;
+		}
+		InitVarArrayWithInitial(OsmLocation, &previewWay->locations, arena, locationsBuffer.length);
+		VarArrayLoop(&locationsBuffer, lIndex) { VarArrayLoopGetValue(v2d, location, &locationsBuffer, lIndex); VarArrayAddValue(OsmLocation, &previewWay->locations, ToOsmLocation(location)); }
+		//NOTE: The offset is into newTags for now, it's moved along when the tags are added to previewTags below
+		previewWay->tags.offset = (u32)newTags.length;
+		previewWay->tags.count = way->tags.count;
+		const OsmTag* wayTags = GetOsmTags(map, way->tags);
+		for (u32 tIndex = 0; tIndex < way->tags.count; tIndex++)
+		{
+			OsmTag* newTag = VarArrayAdd(OsmTag, &newTags);
+			NotNull(newTag);
+			newTag->key = InternOsmStr8(&progress->previewStrings, wayTags[tIndex].key);
+			newTag->value = InternOsmStr8(&progress->previewStrings, wayTags[tIndex].value);
+		}
+		UpdateOsmWayNodeBounds(map, previewWay);
+	}
+	progress->numWaysChecked = wIndex;
+	
+	if (newWays.length > 0)
+	{
+		LockThreadMutex(&progress->mutex);
+		u32 tagsOffset = (u32)progress->previewTags.length;
+		VarArrayExpand(&progress->previewWays, progress->previewWays.length + newWays.length);
+		VarArrayLoop(&newWays, nIndex)
+		{
+			OsmWay* newWay = VarArrayAdd(OsmWay, &progress->previewWays);
+			NotNull(newWay);
+			MyMemCopy(newWay, VarArrayGet(OsmWay, &newWays, nIndex), sizeof(OsmWay));
+			newWay->tags.offset += tagsOffset;
+		}
+		VarArrayExpand(&progress->previewTags, progress->previewTags.length + newTags.length);
+		VarArrayLoop(&newTags, tIndex) { VarArrayLoopGetValue(OsmTag, newTag, &newTags, tIndex); VarArrayAddValue(OsmTag, &progress->previewTags, newTag); }
+		progress->numPreviewWays += newWays.length;
+		UnlockThreadMutex(&progress->mutex);
+	}
+	
+	ScratchEnd(scratch);
+	TracyCZoneEnd(funcZone);
+}
+
+// Called on the main thread. Moves any preview ways that are waiting onto the end of map, which must be using the same arena as the preview.
+// Their tags go onto the end of map->tags but the strings stay in progress->previewStrings, so the map has to be freed before the progress is. Returns how many ways were moved
+uxx TakeOsmLoadPreview(OsmLoadProgress* progress, OsmMap* map)
+{
+	NotNull(progress);
+	NotNull(map);
+	if (progress->previewArena == nullptr) { return 0; }
+	Assert(map->arena == progress->previewArena);
+	LockThreadMutex(&progress->mutex);
+	uxx result = progress->previewWays.length;
+	if (result > 0)
+	{
+		Assert(map->tags.length + progress->previewTags.length <= UINT32_MAX);
+		u32 tagsOffset = (u32)map->tags.length;
+		VarArrayExpand(&map->ways, map->ways.length + result);
+		VarArrayLoop(&progress->previewWays, wIndex)
+		{
+			OsmWay* newWay = VarArrayAdd(OsmWay, &map->ways);
+			NotNull(newWay);
+			MyMemCopy(newWay, VarArrayGet(OsmWay, &progress->previewWays, wIndex), sizeof(OsmWay));
+			newWay->tags.offset += tagsOffset;
+		}
+		VarArrayExpand(&map->tags, map->tags.length + progress->previewTags.length);
+		VarArrayLoop(&progress->previewTags, tIndex) { VarArrayLoopGetValue(OsmTag, previewTag, &progress->previewTags, tIndex); VarArrayAddValue(OsmTag, &map->tags, previewTag); }
+		VarArrayClear(&progress->previewWays);
+		VarArrayClear(&progress->previewTags);
+	}
+	if (progress->hasPreviewBounds) { map->bounds = progress->previewBounds; }
+	UnlockThreadMutex(&progress->mutex);
+	return result;
+}
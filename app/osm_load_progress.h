@@ -0,0 +1,41 @@
+/*
+File:   osm_load_progress.h
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** OsmLoadProgress lets one thread watch (and cancel) a map load that is running on
+	** another thread, and hands over a preview of the ways as they are loaded
+*/
+
+#ifndef _OSM_LOAD_PROGRESS_H
+#define _OSM_LOAD_PROGRESS_H
+
+#define OSM_LOAD_PROGRESS_PERIOD   1024 //elements, how often the .osm loader updates the progress and checks for cancellation
+
+// Optionally passed in OsmLoadOptions. Everything above the loader-only fields is protected by the mutex, lock it before reading them from another thread
+typedef plex OsmLoadProgress OsmLoadProgress;
+plex OsmLoadProgress
+{
+	ThreadMutex mutex;
+	u64 totalBytes; //0 when we don't know how big the source is
+	u64 processedBytes;
+	uxx numBlobs; //.pbf only, 0 when there is no blob index to tell us
+	uxx numBlobsProcessed; //.pbf only
+	bool cancelRequested;
+	
+	//NOTE: The loader copies the ways it has added into previewWays with inline locations (so they don't need the nodes) and the main thread
+	//      moves them into the map it's drawing with TakeOsmLoadPreview, so a large file starts drawing long before it's done loading
+	Arena* previewArena; //nullptr when no preview is wanted
+	uxx maxPreviewWays; //we stop making a preview once this many ways have been handed over
+	bool hasPreviewBounds;
+	recd previewBounds;
+	VarArray previewWays; //OsmWay, waiting to be taken
+	VarArray previewTags; //OsmTag, the tags of previewWays (their OsmTagRanges index into this until TakeOsmLoadPreview moves them into the map)
+	uxx numPreviewWays; //how many have been added to previewWays in total
+	
+	//NOTE: These are only touched by the loading thread (or by whichever worker is merging, for a threaded .osm load)
+	uxx numWaysChecked; //index into the loading map's ways
+	OsmStringPool previewStrings; //previewTags point into this, the characters never move so the main thread can keep using them after they're handed over
+};
+
+#endif //  _OSM_LOAD_PROGRESS_H
@@ -3,32 +3,25 @@ File:   osm_map.c
 Author: Taylor Robbins
 Date:   07\06\2025
 Description: 
-	** None
+	** Holds the functions that build an OsmMap (adding nodes, ways, relations and their tags), look up and sort
+	** its primitives, resolve the node refs and relation members, and free it all again
 */
 
-void FreeOsmTag(Arena* arena, OsmTag* tag)
+void FreeOsmNodeInfo(Arena* arena, OsmNodeInfo* info)
 {
 	NotNull(arena);
-	NotNull(tag);
-	FreeStr8(arena, &tag->key);
-	FreeStr8(arena, &tag->value);
-	ClearPointer(tag);
+	NotNull(info);
+	FreeStr8(arena, &info->timestampStr);
+	FreeStr8(arena, &info->user);
+	ClearPointer(info);
 }
 
 void FreeOsmNode(Arena* arena, OsmNode* node)
 {
 	NotNull(arena);
 	NotNull(node);
-	FreeStr8(arena, &node->timestampStr);
-	FreeStr8(arena, &node->user);
-	VarArrayLoop(&node->tags, tIndex)
-	{
-		VarArrayLoopGet(OsmTag, tag, &node->tags, tIndex);
-		FreeOsmTag(arena, tag);
-	}
-	FreeVarArray(&node->tags);
-	if (node->wayPntrs.arena != nullptr) { FreeVarArray(&node->wayPntrs); }
-	if (node->wayPntrs.arena != nullptr) { FreeVarArray(&node->relationPntrs); }
+	if (node->wayIndices.arena != nullptr) { FreeVarArray(&node->wayIndices); }
+	if (node->relationIndices.arena != nullptr) { FreeVarArray(&node->relationIndices); }
 	ClearPointer(node);
 }
 
@@ -39,13 +32,8 @@ void FreeOsmWay(Arena* arena, OsmWay* way)
 	FreeStr8(arena, &way->timestampStr);
 	FreeStr8(arena, &way->user);
 	FreeVarArray(&way->nodes);
-	VarArrayLoop(&way->tags, tIndex)
-	{
-		VarArrayLoopGet(OsmTag, tag, &way->tags, tIndex);
-		FreeOsmTag(arena, tag);
-	}
-	FreeVarArray(&way->tags);
-	if (way->relationPntrs.arena != nullptr) { FreeVarArray(&way->relationPntrs); }
+	if (way->locations.arena != nullptr) { FreeVarArray(&way->locations); }
+	if (way->relationIndices.arena != nullptr) { FreeVarArray(&way->relationIndices); }
 	if (way->triIndices != nullptr) { FreeArray(uxx, arena, way->numTriIndices, way->triIndices); }
 	FreeVertBuffer(&way->triVertBuffer);
 	ClearPointer(way);
@@ -57,19 +45,13 @@ void FreeOsmRelation(Arena* arena, OsmRelation* relation)
 	NotNull(relation);
 	FreeStr8(arena, &relation->timestampStr);
 	FreeStr8(arena, &relation->user);
-	VarArrayLoop(&relation->tags, tIndex)
-	{
-		VarArrayLoopGet(OsmTag, tag, &relation->tags, tIndex);
-		FreeOsmTag(arena, tag);
-	}
-	FreeVarArray(&relation->tags);
 	VarArrayLoop(&relation->members, mIndex)
 	{
 		VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
 		FreeVarArray(&member->locations);
 	}
 	FreeVarArray(&relation->members);
-	if (relation->relationPntrs.arena != nullptr) { FreeVarArray(&relation->relationPntrs); }
+	if (relation->relationIndices.arena != nullptr) { FreeVarArray(&relation->relationIndices); }
 	ClearPointer(relation);
 }
 
@@ -83,21 +65,30 @@ void FreeOsmMap(OsmMap* map)
 		{
 			VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
 			FreeOsmNode(map->arena, node);
+			FreeOsmNodeInfo(map->arena, VarArrayGet(OsmNodeInfo, &map->nodeInfos, nIndex));
 		}
 		FreeVarArray(&map->nodes);
+		FreeVarArray(&map->nodeLocations);
+		FreeVarArray(&map->nodeFlags);
+		FreeVarArray(&map->nodeInfos);
 		VarArrayLoop(&map->ways, wIndex)
 		{
 			VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
 			FreeOsmWay(map->arena, way);
 		}
 		FreeVarArray(&map->ways);
+		FreeVarArray(&map->tags); //the tag strings belong to the stringPool
+		FreeOsmIdTable(&map->nodeIdTable);
+		FreeOsmIdTable(&map->wayIdTable);
+		FreeOsmIdTable(&map->relationIdTable);
+		FreeOsmStringPool(&map->stringPool);
 		FreeVarArray(&map->selectedItems);
 	}
 	ClearPointer(map);
 	TracyCZoneEnd(funcZone);
 }
 
-void InitOsmMap(Arena* arena, OsmMap* mapOut, u64 numNodesExpected, u64 numWaysExpected, u64 numRelationsExpected)
+void InitOsmMap(Arena* arena, OsmMap* mapOut, u64 numNodesExpected, u64 numWaysExpected, u64 numRelationsExpected, u64 numTagsExpected)
 {
 	TracyCZoneN(funcZone, "InitOsmMap", true);
 	NotNull(arena);
@@ -108,60 +99,247 @@ void InitOsmMap(Arena* arena, OsmMap* mapOut, u64 numNodesExpected, u64 numWaysE
 	mapOut->nextWayId = 1;
 	mapOut->nextRelationId = 1;
 	InitVarArrayWithInitial(OsmNode, &mapOut->nodes, arena, numNodesExpected);
+	InitVarArrayWithInitial(OsmLocation, &mapOut->nodeLocations, arena, numNodesExpected);
+	InitVarArrayWithInitial(u8, &mapOut->nodeFlags, arena, numNodesExpected);
+	InitVarArrayWithInitial(OsmNodeInfo, &mapOut->nodeInfos, arena, numNodesExpected);
 	InitVarArrayWithInitial(OsmWay, &mapOut->ways, arena, numWaysExpected);
 	InitVarArrayWithInitial(OsmRelation, &mapOut->relations, arena, numRelationsExpected);
+	InitVarArrayWithInitial(OsmTag, &mapOut->tags, arena, numTagsExpected);
+	InitOsmIdTable(arena, &mapOut->nodeIdTable);
+	InitOsmIdTable(arena, &mapOut->wayIdTable);
+	InitOsmIdTable(arena, &mapOut->relationIdTable);
+	InitOsmStringPool(arena, &mapOut->stringPool);
 	InitVarArray(OsmSelectedItem, &mapOut->selectedItems, arena);
 	TracyCZoneEnd(funcZone);
 }
 
-OsmNode* FindOsmNode(OsmMap* map, u64 nodeId)
+OsmFixedLocation ToOsmFixedLocation(v2d location)
 {
-	TracyCZoneN(funcZone, "FindOsmNode", true);
-	if (map->areNodesSorted)
-	{
-		uxx foundIndex = BinarySearchVarArrayUintMember(OsmNode, id, &map->nodes, &nodeId);
-		if (foundIndex < map->nodes.length) { TracyCZoneEnd(funcZone); return VarArrayGet(OsmNode, &map->nodes, foundIndex); }
-	}
-	else
+	OsmFixedLocation result;
+	result.lon = (i32)RoundR64i(location.lon * OSM_COORD_FIXED_SCALE);
+	result.lat = (i32)RoundR64i(location.lat * OSM_COORD_FIXED_SCALE);
+	return result;
+}
+v2d ToV2dFromOsmFixedLocation(OsmFixedLocation location)
+{
+	return MakeV2d((r64)location.lon / OSM_COORD_FIXED_SCALE, (r64)location.lat / OSM_COORD_FIXED_SCALE);
+}
+
+#if OSM_FIXED_POINT_LOCATIONS
+OsmLocation ToOsmLocation(v2d location) { return ToOsmFixedLocation(location); }
+v2d ToV2dFromOsmLocation(OsmLocation location) { return ToV2dFromOsmFixedLocation(location); }
+#else
+OsmLocation ToOsmLocation(v2d location) { return location; }
+v2d ToV2dFromOsmLocation(OsmLocation location) { return location; }
+#endif
+
+// Turns a run of locations (a way's inline locations, a slice of map->nodeLocations, etc.) into degrees all at once
+void DecodeOsmLocations(uxx numLocations, const OsmLocation* locations, v2d* locationsOut)
+{
+	#if OSM_FIXED_POINT_LOCATIONS
+	const r64 scale = 1.0 / OSM_COORD_FIXED_SCALE;
+	for (uxx lIndex = 0; lIndex < numLocations; lIndex++)
 	{
-		VarArrayLoop(&map->nodes, nIndex)
-		{
-			VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
-			if (node->id == nodeId) { TracyCZoneEnd(funcZone); return node; }
-		}
+		locationsOut[lIndex].lon = (r64)locations[lIndex].lon * scale;
+		locationsOut[lIndex].lat = (r64)locations[lIndex].lat * scale;
 	}
+	#else
+	if (numLocations > 0) { MyMemCopy(locationsOut, locations, sizeof(v2d) * numLocations); }
+	#endif
+}
+
+// Any nodes/ways/relations that were appended since the last lookup (by the loaders, or before the table was built) are added to the table first.
+// When an id shows up more than once we return the first one, regardless of whether the array is sorted
+OsmNode* FindOsmNode(OsmMap* map, u64 nodeId)
+{
+	TracyCZoneN(funcZone, "FindOsmNode", true);
+	SyncOsmIdTable(&map->nodeIdTable, map->nodes.length, &((OsmNode*)map->nodes.items)->id, sizeof(OsmNode));
+	uxx foundIndex = FindOsmIdTableIndex(&map->nodeIdTable, nodeId);
+	OsmNode* result = (foundIndex < map->nodes.length) ? VarArrayGet(OsmNode, &map->nodes, foundIndex) : nullptr;
+	DebugAssert(result == nullptr || result->id == nodeId);
 	TracyCZoneEnd(funcZone);
-	return nullptr;
+	return result;
 }
 OsmWay* FindOsmWay(OsmMap* map, u64 wayId)
 {
 	TracyCZoneN(funcZone, "FindOsmWay", true);
-	if (map->areWaysSorted)
-	{
-		uxx foundIndex = BinarySearchVarArrayUintMember(OsmWay, id, &map->ways, &wayId);
-		if (foundIndex < map->ways.length) { TracyCZoneEnd(funcZone); return VarArrayGet(OsmWay, &map->ways, foundIndex); }
-	}
-	else
+	SyncOsmIdTable(&map->wayIdTable, map->ways.length, &((OsmWay*)map->ways.items)->id, sizeof(OsmWay));
+	uxx foundIndex = FindOsmIdTableIndex(&map->wayIdTable, wayId);
+	OsmWay* result = (foundIndex < map->ways.length) ? VarArrayGet(OsmWay, &map->ways, foundIndex) : nullptr;
+	DebugAssert(result == nullptr || result->id == wayId);
+	TracyCZoneEnd(funcZone);
+	return result;
+}
+OsmRelation* FindOsmRelation(OsmMap* map, u64 relationId)
+{
+	TracyCZoneN(funcZone, "FindOsmRelation", true);
+	SyncOsmIdTable(&map->relationIdTable, map->relations.length, &((OsmRelation*)map->relations.items)->id, sizeof(OsmRelation));
+	uxx foundIndex = FindOsmIdTableIndex(&map->relationIdTable, relationId);
+	OsmRelation* result = (foundIndex < map->relations.length) ? VarArrayGet(OsmRelation, &map->relations, foundIndex) : nullptr;
+	DebugAssert(result == nullptr || result->id == relationId);
+	TracyCZoneEnd(funcZone);
+	return result;
+}
+
+// These turn an index handle (OsmNodeRef.nodeIndex, OsmRelationMember.index, etc.) back into a pointer, nullptr for OSM_INVALID_INDEX.
+// The pointer is only good until the array is added to, keep the index instead
+OsmNode* GetOsmNodeByIndex(const OsmMap* map, u32 nodeIndex)
+{
+	if (nodeIndex == OSM_INVALID_INDEX) { return nullptr; }
+	Assert(nodeIndex < map->nodes.length);
+	return &((OsmNode*)map->nodes.items)[nodeIndex];
+}
+OsmWay* GetOsmWayByIndex(const OsmMap* map, u32 wayIndex)
+{
+	if (wayIndex == OSM_INVALID_INDEX) { return nullptr; }
+	Assert(wayIndex < map->ways.length);
+	return &((OsmWay*)map->ways.items)[wayIndex];
+}
+OsmRelation* GetOsmRelationByIndex(const OsmMap* map, u32 relationIndex)
+{
+	if (relationIndex == OSM_INVALID_INDEX) { return nullptr; }
+	Assert(relationIndex < map->relations.length);
+	return &((OsmRelation*)map->relations.items)[relationIndex];
+}
+
+// The node columns (see OsmMap.nodeLocations) are indexed the same as map->nodes. These take the node pointer for convenience,
+// loops over every node should walk the columns directly instead
+u32 GetOsmNodeIndex(const OsmMap* map, const OsmNode* node)
+{
+	NotNull(node);
+	DebugAssert(node >= (OsmNode*)map->nodes.items && node < (OsmNode*)map->nodes.items + map->nodes.length);
+	return (u32)(node - (OsmNode*)map->nodes.items);
+}
+v2d GetOsmNodeLocation(const OsmMap* map, const OsmNode* node)
+{
+	return ToV2dFromOsmLocation(((OsmLocation*)map->nodeLocations.items)[GetOsmNodeIndex(map, node)]);
+}
+u8* GetOsmNodeFlags(const OsmMap* map, const OsmNode* node)
+{
+	return &((u8*)map->nodeFlags.items)[GetOsmNodeIndex(map, node)];
+}
+OsmNodeInfo* GetOsmNodeInfo(const OsmMap* map, const OsmNode* node)
+{
+	return &((OsmNodeInfo*)map->nodeInfos.items)[GetOsmNodeIndex(map, node)];
+}
+
+// Makes room for numNodes nodes in map->nodes and all the node columns
+void ExpandOsmNodes(OsmMap* map, uxx numNodes)
+{
+	VarArrayExpand(&map->nodes, numNodes);
+	VarArrayExpand(&map->nodeLocations, numNodes);
+	VarArrayExpand(&map->nodeFlags, numNodes);
+	VarArrayExpand(&map->nodeInfos, numNodes);
+}
+
+// +--------------------------------------------------------------+
+// |                             Tags                             |
+// +--------------------------------------------------------------+
+// The pointer is only good until map->tags is added to. Returns nullptr for an untagged primitive
+OsmTag* GetOsmTags(const OsmMap* map, OsmTagRange range)
+{
+	if (range.count == 0) { return nullptr; }
+	DebugAssert((uxx)range.offset + range.count <= map->tags.length);
+	return &((OsmTag*)map->tags.items)[range.offset];
+}
+
+// Makes room for numTags more tags at the end of range and returns the first of them, cleared, for the caller to fill in (with strings from map->stringPool).
+// The loaders call this right after adding each primitive so its tags just go on the end of map->tags. If range isn't the last thing in map->tags
+// (a primitive that was added earlier is being edited) its tags are moved to the end first and the old copies are left as dead tags until
+// CompactOsmTags is called. Any pointers into map->tags are invalidated
+OsmTag* AddOsmTags(OsmMap* map, OsmTagRange* range, uxx numTags)
+{
+	NotNull(map);
+	NotNull(range);
+	if (numTags == 0) { return nullptr; }
+	bool isAtEnd = (range->count == 0 || (uxx)range->offset + range->count == map->tags.length);
+	uxx numToMove = isAtEnd ? 0 : range->count;
+	Assert(map->tags.length + numToMove + numTags <= UINT32_MAX);
+	VarArrayExpand(&map->tags, map->tags.length + numToMove + numTags);
+	if (range->count == 0) { range->offset = (u32)map->tags.length; }
+	else if (!isAtEnd)
 	{
-		VarArrayLoop(&map->ways, wIndex)
+		u32 newOffset = (u32)map->tags.length;
+		for (u32 tIndex = 0; tIndex < range->count; tIndex++)
 		{
-			VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
-			if (way->id == wayId) { TracyCZoneEnd(funcZone); return way; }
+			OsmTag oldTag = *VarArrayGet(OsmTag, &map->tags, range->offset + tIndex);
+			VarArrayAddValue(OsmTag, &map->tags, oldTag);
 		}
+		map->numDeadTags += range->count;
+		range->offset = newOffset;
 	}
-	TracyCZoneEnd(funcZone);
-	return nullptr;
+	uxx firstNewIndex = map->tags.length;
+	for (uxx tIndex = 0; tIndex < numTags; tIndex++)
+	{
+		OsmTag* newTag = VarArrayAdd(OsmTag, &map->tags);
+		NotNull(newTag);
+		ClearPointer(newTag);
+	}
+	range->count += (u32)numTags;
+	return VarArrayGet(OsmTag, &map->tags, firstNewIndex);
 }
-OsmRelation* FindOsmRelation(OsmMap* map, u64 relationId)
+
+void AddOsmTag(OsmMap* map, OsmTagRange* range, Str8 key, Str8 value)
 {
-	TracyCZoneN(funcZone, "FindOsmRelation", true);
-	VarArrayLoop(&map->relations, rIndex)
+	OsmTag* newTag = AddOsmTags(map, range, 1);
+	newTag->key = InternOsmStr8(&map->stringPool, key);
+	newTag->value = InternOsmStr8(&map->stringPool, value);
+}
+
+// The tags stay in map->tags as dead tags until CompactOsmTags is called
+void RemoveOsmTags(OsmMap* map, OsmTagRange* range)
+{
+	map->numDeadTags += range->count;
+	range->offset = 0;
+	range->count = 0;
+}
+
+void CompactOsmTagRange(const VarArray* oldTags, VarArray* newTags, OsmTagRange* range)
+{
+	if (range->count == 0) { return; }
+	u32 newOffset = (u32)newTags->length;
+	for (u32 tIndex = 0; tIndex < range->count; tIndex++)
 	{
-		VarArrayLoopGet(OsmRelation, relation, &map->relations, rIndex);
-		if (relation->id == relationId) { TracyCZoneEnd(funcZone); return relation; }
+		VarArrayAddValue(OsmTag, newTags, *VarArrayGet(OsmTag, oldTags, range->offset + tIndex));
 	}
+	range->offset = newOffset;
+}
+
+// Rewrites map->tags without any dead tags, with the nodes' tags first, then the ways' and then the relations', each in the order
+// of their array. Every OsmTagRange in the map gets its new offset
+void CompactOsmTags(OsmMap* map)
+{
+	NotNull(map);
+	if (map->numDeadTags == 0) { return; }
+	TracyCZoneN(funcZone, "CompactOsmTags", true);
+	Assert(map->numDeadTags <= map->tags.length);
+	VarArray newTags; //OsmTag
+	InitVarArrayWithInitial(OsmTag, &newTags, map->arena, map->tags.length - map->numDeadTags);
+	VarArrayLoop(&map->nodes, nIndex) { VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex); CompactOsmTagRange(&map->tags, &newTags, &node->tags); }
+	VarArrayLoop(&map->ways, wIndex) { VarArrayLoopGet(OsmWay, way, &map->ways, wIndex); CompactOsmTagRange(&map->tags, &newTags, &way->tags); }
+	VarArrayLoop(&map->relations, rIndex) { VarArrayLoopGet(OsmRelation, relation, &map->relations, rIndex); CompactOsmTagRange(&map->tags, &newTags, &relation->tags); }
+	DebugAssert(newTags.length == map->tags.length - map->numDeadTags);
+	FreeVarArray(&map->tags);
+	map->tags = newTags;
+	map->numDeadTags = 0;
 	TracyCZoneEnd(funcZone);
-	return nullptr;
+}
+
+// Same as FindOsmNode/Way/Relation but returns the index (or OSM_INVALID_INDEX)
+u32 FindOsmNodeIndex(OsmMap* map, u64 nodeId)
+{
+	OsmNode* node = FindOsmNode(map, nodeId);
+	return (node != nullptr) ? GetOsmNodeIndex(map, node) : OSM_INVALID_INDEX;
+}
+u32 FindOsmWayIndex(OsmMap* map, u64 wayId)
+{
+	OsmWay* way = FindOsmWay(map, wayId);
+	return (way != nullptr) ? (u32)(way - (OsmWay*)map->ways.items) : OSM_INVALID_INDEX;
+}
+u32 FindOsmRelationIndex(OsmMap* map, u64 relationId)
+{
+	OsmRelation* relation = FindOsmRelation(map, relationId);
+	return (relation != nullptr) ? (u32)(relation - (OsmRelation*)map->relations.items) : OSM_INVALID_INDEX;
 }
 
 OsmNode* AddOsmNode(OsmMap* map, v2d location, u64 id)
@@ -169,25 +347,34 @@ OsmNode* AddOsmNode(OsmMap* map, v2d location, u64 id)
 	TracyCZoneN(funcZone, "AddOsmNode", true);
 	NotNull(map);
 	NotNull(map->arena);
+	Assert(map->nodes.length < OSM_INVALID_INDEX);
 	OsmNode* result = VarArrayAdd(OsmNode, &map->nodes);
 	NotNull(result);
 	ClearPointer(result);
 	result->id = (id == 0) ? map->nextNodeId : id;
 	if (id == 0) { map->nextNodeId++; }
 	else if (map->nextNodeId <= id) { map->nextNodeId = id+1; }
-	result->location = location;
-	result->visible = true;
-	InitVarArray(OsmTag, &result->tags, map->arena);
+	VarArrayAddValue(OsmLocation, &map->nodeLocations, ToOsmLocation(location));
+	VarArrayAddValue(u8, &map->nodeFlags, OsmNodeFlag_None);
+	OsmNodeInfo* newInfo = VarArrayAdd(OsmNodeInfo, &map->nodeInfos);
+	NotNull(newInfo);
+	ClearPointer(newInfo);
+	newInfo->visible = true;
+	DebugAssert(map->nodeLocations.length == map->nodes.length && map->nodeFlags.length == map->nodes.length && map->nodeInfos.length == map->nodes.length);
+	AddOsmIdTableEntry(&map->nodeIdTable, result->id, map->nodes.length-1);
 	TracyCZoneEnd(funcZone);
 	return result;
 }
 
-OsmWay* AddOsmWay(OsmMap* map, u64 id, u64 numNodes, u64* nodeIds)
+// Adds a way whose OsmNodeRefs only have their ids filled in. The nodeIndex of each and nodeBounds are left empty until ResolveOsmNodeRefs is called,
+// which lets the loaders resolve every way at once after all the nodes are in (and sorted) rather than doing a lookup per ref
+OsmWay* AddOsmWayUnresolved(OsmMap* map, u64 id, u64 numNodes, u64* nodeIds)
 {
-	TracyCZoneN(funcZone, "AddOsmWay", true);
+	TracyCZoneN(funcZone, "AddOsmWayUnresolved", true);
 	NotNull(map);
 	NotNull(map->arena);
 	Assert(numNodes == 0 || nodeIds != nullptr);
+	Assert(map->ways.length < OSM_INVALID_INDEX);
 	OsmWay* result = VarArrayAdd(OsmWay, &map->ways);
 	NotNull(result);
 	ClearPointer(result);
@@ -196,32 +383,427 @@ OsmWay* AddOsmWay(OsmMap* map, u64 id, u64 numNodes, u64* nodeIds)
 	else if (map->nextWayId <= id) { map->nextWayId = id+1; }
 	result->visible = true;
 	InitVarArrayWithInitial(OsmNodeRef, &result->nodes, map->arena, numNodes);
-	bool foundFirstNode = false;
 	for (u64 nIndex = 0; nIndex < numNodes; nIndex++)
 	{
 		OsmNodeRef* newRef = VarArrayAdd(OsmNodeRef, &result->nodes);
 		NotNull(newRef);
 		ClearPointer(newRef);
 		newRef->id = nodeIds[nIndex];
-		newRef->pntr = FindOsmNode(map, newRef->id);
-		if (newRef->pntr == nullptr) { map->waysMissingNodes = true; }
-		else
-		{
-			if (!foundFirstNode) { result->nodeBounds = MakeRecd(newRef->pntr->location.lon, newRef->pntr->location.lat, 0, 0); foundFirstNode = true; }
-			else { result->nodeBounds = BothRecd(result->nodeBounds, MakeRecdV(newRef->pntr->location, V2d_Zero)); }
-		}
+		newRef->nodeIndex = OSM_INVALID_INDEX;
 	}
 	result->isClosedLoop = (numNodes >= 3 && nodeIds[0] == nodeIds[numNodes-1]);
-	InitVarArray(OsmTag, &result->tags, map->arena);
+	AddOsmIdTableEntry(&map->wayIdTable, result->id, map->ways.length-1);
 	TracyCZoneEnd(funcZone);
 	return result;
 }
 
+// Ways from a LocationsOnWays .pbf have the location of every node inline (and unresolved refs), everything else goes through the resolved nodeIndex.
+// Returns false if the node is missing from the map
+bool TryGetOsmWayNodeLocation(const OsmMap* map, const OsmWay* way, uxx nodeIndex, v2d* locationOut)
+{
+	Assert(nodeIndex < way->nodes.length);
+	if (way->locations.length > 0) { *locationOut = ToV2dFromOsmLocation(((OsmLocation*)way->locations.items)[nodeIndex]); return true; }
+	OsmNodeRef* nodeRef = VarArrayGet(OsmNodeRef, &way->nodes, nodeIndex);
+	if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { return false; }
+	Assert(nodeRef->nodeIndex < map->nodeLocations.length);
+	*locationOut = ToV2dFromOsmLocation(((OsmLocation*)map->nodeLocations.items)[nodeRef->nodeIndex]);
+	return true;
+}
+
+// Fills locationsOut (way->nodes.length long) with the location of every node in the way, returns false if any of them are missing
+bool TryGetOsmWayNodeLocations(const OsmMap* map, const OsmWay* way, v2d* locationsOut)
+{
+	if (way->locations.length > 0) { DecodeOsmLocations(way->locations.length, (const OsmLocation*)way->locations.items, locationsOut); return true; }
+	const OsmLocation* nodeLocations = (const OsmLocation*)map->nodeLocations.items;
+	VarArrayLoop(&way->nodes, nIndex)
+	{
+		VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
+		if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { return false; }
+		DebugAssert(nodeRef->nodeIndex < map->nodeLocations.length);
+		locationsOut[nIndex] = ToV2dFromOsmLocation(nodeLocations[nodeRef->nodeIndex]);
+	}
+	return true;
+}
+
+void UpdateOsmWayNodeBounds(const OsmMap* map, OsmWay* way)
+{
+	bool foundFirstNode = false;
+	way->nodeBounds = MakeRecd(0, 0, 0, 0);
+	VarArrayLoop(&way->nodes, nIndex)
+	{
+		v2d location = V2d_Zero;
+		if (!TryGetOsmWayNodeLocation(map, way, nIndex, &location)) { continue; }
+		if (!foundFirstNode) { way->nodeBounds = MakeRecd(location.lon, location.lat, 0, 0); foundFirstNode = true; }
+		else { way->nodeBounds = BothRecd(way->nodeBounds, MakeRecdV(location, V2d_Zero)); }
+	}
+}
+
+// Copies numNodes inline locations onto a way made by AddOsmWayUnresolved, see OsmWay.locations
+void SetOsmWayLocations(OsmMap* map, OsmWay* way, uxx numNodes, const v2d* locations)
+{
+	Assert(numNodes == way->nodes.length);
+	InitVarArrayWithInitial(OsmLocation, &way->locations, map->arena, numNodes);
+	for (uxx nIndex = 0; nIndex < numNodes; nIndex++) { VarArrayAddValue(OsmLocation, &way->locations, ToOsmLocation(locations[nIndex])); }
+}
+
+OsmWay* AddOsmWay(OsmMap* map, u64 id, u64 numNodes, u64* nodeIds)
+{
+	TracyCZoneN(funcZone, "AddOsmWay", true);
+	OsmWay* result = AddOsmWayUnresolved(map, id, numNodes, nodeIds);
+	VarArrayLoop(&result->nodes, nIndex)
+	{
+		VarArrayLoopGet(OsmNodeRef, nodeRef, &result->nodes, nIndex);
+		nodeRef->nodeIndex = FindOsmNodeIndex(map, nodeRef->id);
+		if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { map->waysMissingNodes = true; }
+	}
+	UpdateOsmWayNodeBounds(map, result);
+	TracyCZoneEnd(funcZone);
+	return result;
+}
+
+// Sorts the refs by node id (LSD radix sort, 8 bits per pass, passes where every id has the same byte are skipped)
+void SortOsmNodeRefEntries(uxx numEntries, OsmNodeRefEntry* entries, OsmNodeRefEntry* tempEntries)
+{
+	uxx byteCounts[sizeof(u64)][256];
+	MyMemSet(&byteCounts[0][0], 0x00, sizeof(byteCounts));
+	for (uxx eIndex = 0; eIndex < numEntries; eIndex++)
+	{
+		u64 nodeId = entries[eIndex].nodeId;
+		for (uxx bIndex = 0; bIndex < sizeof(u64); bIndex++) { byteCounts[bIndex][(nodeId >> (bIndex*8)) & 0xFF]++; }
+	}
+	
+	OsmNodeRefEntry* source = entries;
+	OsmNodeRefEntry* dest = tempEntries;
+	for (uxx bIndex = 0; bIndex < sizeof(u64); bIndex++)
+	{
+		uxx* counts = &byteCounts[bIndex][0];
+		if (counts[(entries[0].nodeId >> (bIndex*8)) & 0xFF] == numEntries) { continue; }
+		uxx offset = 0;
+		for (uxx vIndex = 0; vIndex < 256; vIndex++) { uxx count = counts[vIndex]; counts[vIndex] = offset; offset += count; }
+		for (uxx eIndex = 0; eIndex < numEntries; eIndex++)
+		{
+			uxx value = (uxx)((source[eIndex].nodeId >> (bIndex*8)) & 0xFF);
+			dest[counts[value]] = source[eIndex];
+			counts[value]++;
+		}
+		OsmNodeRefEntry* swap = source; source = dest; dest = swap;
+	}
+	if (source != entries) { MyMemCopy(entries, source, sizeof(OsmNodeRefEntry) * numEntries); }
+}
+
+// Sorts numItems items (each one itemSize bytes and starting with a u64 id) by id in place and returns an array in arena that says where each one went,
+// oldToNew[oldIndex] = newIndex. Items with the same id keep their order. Used by SortOsmNodes/Ways/Relations so they can remap the index handles
+u32* SortOsmPrimitivesById(Arena* arena, uxx numItems, void* items, uxx itemSize)
+{
+	NotNull(arena);
+	Assert(numItems < OSM_INVALID_INDEX);
+	if (numItems == 0) { return nullptr; }
+	u32* result = AllocArray(u32, arena, numItems);
+	NotNull(result);
+	ScratchBegin1(scratch, arena);
+	OsmNodeRefEntry* entries = AllocArray(OsmNodeRefEntry, scratch, numItems);
+	OsmNodeRefEntry* tempEntries = AllocArray(OsmNodeRefEntry, scratch, numItems);
+	u8* tempItem = (u8*)AllocMem(scratch, itemSize);
+	NotNull(entries);
+	NotNull(tempEntries);
+	NotNull(tempItem);
+	u8* itemBytes = (u8*)items;
+	for (uxx iIndex = 0; iIndex < numItems; iIndex++)
+	{
+		entries[iIndex].nodeId = *(u64*)&itemBytes[iIndex * itemSize];
+		entries[iIndex].index = iIndex;
+	}
+	SortOsmNodeRefEntries(numItems, entries, tempEntries);
+	for (uxx eIndex = 0; eIndex < numItems; eIndex++) { result[entries[eIndex].index] = (u32)eIndex; }
+	
+	//NOTE: entries[newIndex].index is where the item that belongs at newIndex is now. We follow each cycle of that permutation
+	//      so every item is copied once and only one item needs to be held on the side. Finished slots get index = newIndex
+	for (uxx startIndex = 0; startIndex < numItems; startIndex++)
+	{
+		if (entries[startIndex].index == startIndex) { continue; }
+		MyMemCopy(tempItem, &itemBytes[startIndex * itemSize], itemSize);
+		uxx dstIndex = startIndex;
+		while (true)
+		{
+			uxx srcIndex = entries[dstIndex].index;
+			entries[dstIndex].index = dstIndex;
+			if (srcIndex == startIndex) { MyMemCopy(&itemBytes[dstIndex * itemSize], tempItem, itemSize); break; }
+			MyMemCopy(&itemBytes[dstIndex * itemSize], &itemBytes[srcIndex * itemSize], itemSize);
+			dstIndex = srcIndex;
+		}
+	}
+	ScratchEnd(scratch);
+	return result;
+}
+
+// Updates every index handle that refers to a node after the nodes array was reordered or compacted. oldToNew[oldIndex] is where
+// each node went, or OSM_INVALID_INDEX if it was removed (in which case the ways, relations and selected items lose it)
+void RemapOsmNodeIndices(OsmMap* map, const u32* oldToNew)
+{
+	TracyCZoneN(funcZone, "RemapOsmNodeIndices", true);
+	VarArrayLoop(&map->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+		VarArrayLoop(&way->nodes, nIndex)
+		{
+			VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
+			if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { continue; }
+			nodeRef->nodeIndex = oldToNew[nodeRef->nodeIndex];
+			if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { map->waysMissingNodes = true; }
+		}
+	}
+	VarArrayLoop(&map->relations, rIndex)
+	{
+		VarArrayLoopGet(OsmRelation, relation, &map->relations, rIndex);
+		VarArrayLoop(&relation->members, mIndex)
+		{
+			VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
+			if (member->type != OsmRelationMemberType_Node || member->index == OSM_INVALID_INDEX) { continue; }
+			member->index = oldToNew[member->index];
+			if (member->index == OSM_INVALID_INDEX) { map->relationsMissingMembers = true; }
+		}
+	}
+	for (uxx sIndex = map->selectedItems.length; sIndex > 0; sIndex--)
+	{
+		OsmSelectedItem* selectedItem = VarArrayGet(OsmSelectedItem, &map->selectedItems, sIndex-1);
+		if (selectedItem->type != OsmPrimitiveType_Node) { continue; }
+		selectedItem->index = oldToNew[selectedItem->index];
+		if (selectedItem->index == OSM_INVALID_INDEX) { VarArrayRemoveAt(OsmSelectedItem, &map->selectedItems, sIndex-1); }
+	}
+	TracyCZoneEnd(funcZone);
+}
+
+// Same as RemapOsmNodeIndices for the ways. Ways are never removed so oldToNew has no OSM_INVALID_INDEX entries
+void RemapOsmWayIndices(OsmMap* map, const u32* oldToNew)
+{
+	TracyCZoneN(funcZone, "RemapOsmWayIndices", true);
+	VarArrayLoop(&map->nodes, nIndex)
+	{
+		VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
+		VarArrayLoop(&node->wayIndices, wIndex) { u32* wayIndex = VarArrayGet(u32, &node->wayIndices, wIndex); *wayIndex = oldToNew[*wayIndex]; }
+	}
+	VarArrayLoop(&map->relations, rIndex)
+	{
+		VarArrayLoopGet(OsmRelation, relation, &map->relations, rIndex);
+		VarArrayLoop(&relation->members, mIndex)
+		{
+			VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
+			if (member->type == OsmRelationMemberType_Way && member->index != OSM_INVALID_INDEX) { member->index = oldToNew[member->index]; }
+		}
+	}
+	VarArrayLoop(&map->selectedItems, sIndex)
+	{
+		VarArrayLoopGet(OsmSelectedItem, selectedItem, &map->selectedItems, sIndex);
+		if (selectedItem->type == OsmPrimitiveType_Way) { selectedItem->index = oldToNew[selectedItem->index]; }
+	}
+	TracyCZoneEnd(funcZone);
+}
+
+// Same as RemapOsmNodeIndices for the relations. Relations are never removed so oldToNew has no OSM_INVALID_INDEX entries
+void RemapOsmRelationIndices(OsmMap* map, const u32* oldToNew)
+{
+	TracyCZoneN(funcZone, "RemapOsmRelationIndices", true);
+	VarArrayLoop(&map->nodes, nIndex)
+	{
+		VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
+		VarArrayLoop(&node->relationIndices, rIndex) { u32* relationIndex = VarArrayGet(u32, &node->relationIndices, rIndex); *relationIndex = oldToNew[*relationIndex]; }
+	}
+	VarArrayLoop(&map->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+		VarArrayLoop(&way->relationIndices, rIndex) { u32* relationIndex = VarArrayGet(u32, &way->relationIndices, rIndex); *relationIndex = oldToNew[*relationIndex]; }
+	}
+	VarArrayLoop(&map->relations, rIndex)
+	{
+		VarArrayLoopGet(OsmRelation, relation, &map->relations, rIndex);
+		VarArrayLoop(&relation->relationIndices, pIndex) { u32* relationIndex = VarArrayGet(u32, &relation->relationIndices, pIndex); *relationIndex = oldToNew[*relationIndex]; }
+		VarArrayLoop(&relation->members, mIndex)
+		{
+			VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
+			if (member->type == OsmRelationMemberType_Relation && member->index != OSM_INVALID_INDEX) { member->index = oldToNew[member->index]; }
+		}
+	}
+	TracyCZoneEnd(funcZone);
+}
+
+// Moves each item of a node column to oldToNew[oldIndex] (dropping the ones that are OSM_INVALID_INDEX) through a copy in tempItems
+void RemapOsmNodeColumn(VarArray* column, uxx itemSize, const u32* oldToNew, uxx newLength, u8* tempItems)
+{
+	if (column->length == 0) { return; }
+	MyMemCopy(tempItems, column->items, itemSize * column->length);
+	u8* items = (u8*)column->items;
+	for (uxx oldIndex = 0; oldIndex < column->length; oldIndex++)
+	{
+		if (oldToNew[oldIndex] == OSM_INVALID_INDEX) { continue; }
+		MyMemCopy(&items[oldToNew[oldIndex] * itemSize], &tempItems[oldIndex * itemSize], itemSize);
+	}
+	column->length = newLength;
+}
+
+// Keeps nodeLocations, nodeFlags and nodeInfos lined up with map->nodes after SortOsmNodes or RemoveUnreferencedOsmNodes moved the nodes around.
+// Call this before map->nodes.length is changed, the columns still have the old length
+void RemapOsmNodeColumns(OsmMap* map, const u32* oldToNew, uxx newLength)
+{
+	TracyCZoneN(funcZone, "RemapOsmNodeColumns", true);
+	uxx oldLength = map->nodeLocations.length;
+	DebugAssert(map->nodeFlags.length == oldLength && map->nodeInfos.length == oldLength);
+	if (oldLength > 0)
+	{
+		ScratchBegin1(scratch, map->arena);
+		u8* tempItems = (u8*)AllocMem(scratch, MaxUXX(sizeof(OsmLocation), sizeof(OsmNodeInfo)) * oldLength);
+		NotNull(tempItems);
+		RemapOsmNodeColumn(&map->nodeLocations, sizeof(OsmLocation), oldToNew, newLength, tempItems);
+		RemapOsmNodeColumn(&map->nodeFlags, sizeof(u8), oldToNew, newLength, tempItems);
+		RemapOsmNodeColumn(&map->nodeInfos, sizeof(OsmNodeInfo), oldToNew, newLength, tempItems);
+		ScratchEnd(scratch);
+	}
+	TracyCZoneEnd(funcZone);
+}
+
+// These sort the array by id (if it isn't already) and remap every index handle that refers into it, so nothing needs to be looked up again
+void SortOsmNodes(OsmMap* map)
+{
+	NotNull(map);
+	if (map->areNodesSorted) { return; }
+	TracyCZoneN(funcZone, "SortOsmNodes", true);
+	ScratchBegin1(scratch, map->arena);
+	u32* oldToNew = SortOsmPrimitivesById(scratch, map->nodes.length, map->nodes.items, sizeof(OsmNode));
+	if (oldToNew != nullptr) { RemapOsmNodeColumns(map, oldToNew, map->nodes.length); RemapOsmNodeIndices(map, oldToNew); }
+	InvalidateOsmIdTable(&map->nodeIdTable);
+	map->areNodesSorted = true;
+	ScratchEnd(scratch);
+	TracyCZoneEnd(funcZone);
+}
+void SortOsmWays(OsmMap* map)
+{
+	NotNull(map);
+	if (map->areWaysSorted) { return; }
+	TracyCZoneN(funcZone, "SortOsmWays", true);
+	ScratchBegin1(scratch, map->arena);
+	u32* oldToNew = SortOsmPrimitivesById(scratch, map->ways.length, map->ways.items, sizeof(OsmWay));
+	if (oldToNew != nullptr) { RemapOsmWayIndices(map, oldToNew); }
+	InvalidateOsmIdTable(&map->wayIdTable);
+	map->areWaysSorted = true;
+	ScratchEnd(scratch);
+	TracyCZoneEnd(funcZone);
+}
+void SortOsmRelations(OsmMap* map)
+{
+	NotNull(map);
+	if (map->areRelationsSorted) { return; }
+	TracyCZoneN(funcZone, "SortOsmRelations", true);
+	ScratchBegin1(scratch, map->arena);
+	u32* oldToNew = SortOsmPrimitivesById(scratch, map->relations.length, map->relations.items, sizeof(OsmRelation));
+	if (oldToNew != nullptr) { RemapOsmRelationIndices(map, oldToNew); }
+	InvalidateOsmIdTable(&map->relationIdTable);
+	map->areRelationsSorted = true;
+	ScratchEnd(scratch);
+	TracyCZoneEnd(funcZone);
+}
+
+// Fills in the nodeIndex of every OsmNodeRef in every way in one pass: the refs are gathered, sorted by id and then walked alongside
+// the (sorted) nodes array like a merge join. Also recalculates each way's nodeBounds and map->waysMissingNodes.
+// Call this once all the nodes are added, ResolveMissingOsmNodeRefs is cheaper when only a few refs need filling in
+void ResolveOsmNodeRefs(OsmMap* map)
+{
+	TracyCZoneN(funcZone, "ResolveOsmNodeRefs", true);
+	NotNull(map);
+	SortOsmNodes(map);
+	
+	//NOTE: Ways with inline locations are skipped entirely, their refs stay unresolved and they never count as missing nodes
+	map->waysMissingNodes = false;
+	uxx numRefs = 0;
+	VarArrayLoop(&map->ways, wIndex) { VarArrayLoopGet(OsmWay, way, &map->ways, wIndex); if (way->locations.length == 0) { numRefs += way->nodes.length; } }
+	
+	if (numRefs > 0)
+	{
+		ScratchBegin1(scratch, map->arena);
+		OsmNodeRefEntry* entries = AllocArray(OsmNodeRefEntry, scratch, numRefs);
+		OsmNodeRefEntry* tempEntries = AllocArray(OsmNodeRefEntry, scratch, numRefs);
+		NotNull(entries);
+		NotNull(tempEntries);
+		
+		TracyCZoneN(Zone_Gather, "GatherRefs", true);
+		uxx entryIndex = 0;
+		VarArrayLoop(&map->ways, wIndex)
+		{
+			VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+			if (way->locations.length > 0) { continue; }
+			VarArrayLoop(&way->nodes, nIndex)
+			{
+				VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
+				entries[entryIndex].nodeId = nodeRef->id;
+				entries[entryIndex].ref = nodeRef;
+				entryIndex++;
+			}
+		}
+		TracyCZoneEnd(Zone_Gather);
+		
+		TracyCZoneN(Zone_Sort, "SortRefs", true);
+		SortOsmNodeRefEntries(numRefs, entries, tempEntries);
+		TracyCZoneEnd(Zone_Sort);
+		
+		TracyCZoneN(Zone_Join, "JoinRefs", true);
+		OsmNode* nodes = (OsmNode*)map->nodes.items;
+		uxx numNodes = map->nodes.length;
+		uxx nodeIndex = 0;
+		for (uxx eIndex = 0; eIndex < numRefs; eIndex++)
+		{
+			u64 nodeId = entries[eIndex].nodeId;
+			while (nodeIndex < numNodes && nodes[nodeIndex].id < nodeId) { nodeIndex++; }
+			if (nodeIndex < numNodes && nodes[nodeIndex].id == nodeId) { entries[eIndex].ref->nodeIndex = (u32)nodeIndex; }
+			else { entries[eIndex].ref->nodeIndex = OSM_INVALID_INDEX; map->waysMissingNodes = true; }
+		}
+		TracyCZoneEnd(Zone_Join);
+		
+		ScratchEnd(scratch);
+	}
+	
+	TracyCZoneN(Zone_Bounds, "WayBounds", true);
+	VarArrayLoop(&map->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+		UpdateOsmWayNodeBounds(map, way);
+	}
+	TracyCZoneEnd(Zone_Bounds);
+	TracyCZoneEnd(funcZone);
+}
+
+// Looks up the node for each ref that ResolveOsmNodeRefs (or an earlier call to this) couldn't find, after more nodes have been added.
+// The refs that were already resolved are left alone. Ways that gain a node get their nodeBounds updated and are added to the node's wayIndices
+void ResolveMissingOsmNodeRefs(OsmMap* map)
+{
+	TracyCZoneN(funcZone, "ResolveMissingOsmNodeRefs", true);
+	NotNull(map);
+	if (!map->waysMissingNodes) { TracyCZoneEnd(funcZone); return; }
+	map->waysMissingNodes = false;
+	VarArrayLoop(&map->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+		if (way->locations.length > 0) { continue; }
+		bool foundNewNodes = false;
+		VarArrayLoop(&way->nodes, nIndex)
+		{
+			VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
+			if (nodeRef->nodeIndex != OSM_INVALID_INDEX) { continue; }
+			nodeRef->nodeIndex = FindOsmNodeIndex(map, nodeRef->id);
+			if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { map->waysMissingNodes = true; continue; }
+			OsmNode* node = GetOsmNodeByIndex(map, nodeRef->nodeIndex);
+			if (node->wayIndices.arena == nullptr) { InitVarArray(u32, &node->wayIndices, map->arena); }
+			VarArrayAddValue(u32, &node->wayIndices, (u32)wIndex);
+			foundNewNodes = true;
+		}
+		if (foundNewNodes) { UpdateOsmWayNodeBounds(map, way); }
+	}
+	TracyCZoneEnd(funcZone);
+}
+
 OsmRelation* AddOsmRelation(OsmMap* map, u64 id, uxx numMembersExpected)
 {
 	TracyCZoneN(funcZone, "AddOsmRelation", true);
 	NotNull(map);
 	NotNull(map->arena);
+	Assert(map->relations.length < OSM_INVALID_INDEX);
 	OsmRelation* result = VarArrayAdd(OsmRelation, &map->relations);
 	NotNull(result);
 	ClearPointer(result);
@@ -229,43 +811,49 @@ OsmRelation* AddOsmRelation(OsmMap* map, u64 id, uxx numMembersExpected)
 	if (id == 0) { map->nextRelationId++; }
 	else if (map->nextRelationId <= id) { map->nextRelationId = id+1; }
 	result->visible = true;
-	InitVarArray(OsmTag, &result->tags, map->arena);
 	InitVarArrayWithInitial(OsmRelationMember, &result->members, map->arena, numMembersExpected);
+	AddOsmIdTableEntry(&map->relationIdTable, result->id, map->relations.length-1);
 	TracyCZoneEnd(funcZone);
 	return result;
 }
 
-void UpdateOsmRelationPntrs(OsmMap* map, OsmRelation* relation)
+// Adds relationIndex to the relationIndices of whatever the member refers to
+void AddOsmRelationMemberBackIndex(OsmMap* map, const OsmRelationMember* member, u32 relationIndex)
+{
+	VarArray* relationIndices = nullptr;
+	if (member->type == OsmRelationMemberType_Node) { relationIndices = &GetOsmNodeByIndex(map, member->index)->relationIndices; }
+	else if (member->type == OsmRelationMemberType_Way) { relationIndices = &GetOsmWayByIndex(map, member->index)->relationIndices; }
+	else if (member->type == OsmRelationMemberType_Relation) { relationIndices = &GetOsmRelationByIndex(map, member->index)->relationIndices; }
+	else { Assert(false); return; }
+	if (relationIndices->arena == nullptr) { InitVarArray(u32, relationIndices, map->arena); }
+	VarArrayAddValue(u32, relationIndices, relationIndex);
+}
+
+// Looks up the members of the relation. When onlyMissing is true the members that already have an index are skipped, and the ones that are
+// found get the relation added to their relationIndices (when resolving everything UpdateOsmRelationBackIndices is expected to be called afterwards)
+void ResolveOsmRelationMembers(OsmMap* map, OsmRelation* relation, bool onlyMissing)
 {
 	NotNull(map);
 	NotNull(relation);
+	u32 relationIndex = (u32)(relation - (OsmRelation*)map->relations.items);
 	VarArrayLoop(&relation->members, mIndex)
 	{
 		VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
-		if (member->type == OsmRelationMemberType_Node)
-		{
-			member->nodePntr = FindOsmNode(map, member->id);
-			if (member->nodePntr != nullptr) { map->relationsMissingMembers = true; }
-		}
-		else if (member->type == OsmRelationMemberType_Way)
-		{
-			member->wayPntr = FindOsmWay(map, member->id);
-			if (member->wayPntr != nullptr) { map->relationsMissingMembers = true; }
-		}
-		else if (member->type == OsmRelationMemberType_Relation)
-		{
-			member->relationPntr = FindOsmRelation(map, member->id);
-			if (member->relationPntr != nullptr) { map->relationsMissingMembers = true; }
-		}
+		if (onlyMissing && member->index != OSM_INVALID_INDEX) { continue; }
+		if (member->type == OsmRelationMemberType_Node) { member->index = FindOsmNodeIndex(map, member->id); }
+		else if (member->type == OsmRelationMemberType_Way) { member->index = FindOsmWayIndex(map, member->id); }
+		else if (member->type == OsmRelationMemberType_Relation) { member->index = FindOsmRelationIndex(map, member->id); }
+		if (member->index == OSM_INVALID_INDEX) { map->relationsMissingMembers = true; }
+		else if (onlyMissing) { AddOsmRelationMemberBackIndex(map, member, relationIndex); }
 	}
 }
 
-void UpdateOsmNodeWayBackPntrs(OsmMap* map)
+void UpdateOsmNodeWayIndices(OsmMap* map)
 {
 	VarArrayLoop(&map->nodes, nIndex)
 	{
 		VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
-		if (node->wayPntrs.arena != nullptr) { VarArrayClear(&node->wayPntrs); }
+		if (node->wayIndices.arena != nullptr) { VarArrayClear(&node->wayIndices); }
 	}
 	
 	VarArrayLoop(&map->ways, wIndex)
@@ -274,31 +862,32 @@ void UpdateOsmNodeWayBackPntrs(OsmMap* map)
 		VarArrayLoop(&way->nodes, nIndex)
 		{
 			VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
-			if (nodeRef->pntr != nullptr)
+			if (nodeRef->nodeIndex != OSM_INVALID_INDEX)
 			{
-				if (nodeRef->pntr->wayPntrs.arena == nullptr) { InitVarArray(OsmWay*, &nodeRef->pntr->wayPntrs, map->arena); }
-				VarArrayAddValue(OsmWay*, &nodeRef->pntr->wayPntrs, way);
+				OsmNode* node = GetOsmNodeByIndex(map, nodeRef->nodeIndex);
+				if (node->wayIndices.arena == nullptr) { InitVarArray(u32, &node->wayIndices, map->arena); }
+				VarArrayAddValue(u32, &node->wayIndices, (u32)wIndex);
 			}
 		}
 	}
 }
 
-void UpdateOsmRelationBackPntrs(OsmMap* map)
+void UpdateOsmRelationBackIndices(OsmMap* map)
 {
 	VarArrayLoop(&map->nodes, nIndex)
 	{
 		VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
-		if (node->relationPntrs.arena != nullptr) { VarArrayClear(&node->relationPntrs); }
+		if (node->relationIndices.arena != nullptr) { VarArrayClear(&node->relationIndices); }
 	}
 	VarArrayLoop(&map->ways, wIndex)
 	{
 		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
-		if (way->relationPntrs.arena != nullptr) { VarArrayClear(&way->relationPntrs); }
+		if (way->relationIndices.arena != nullptr) { VarArrayClear(&way->relationIndices); }
 	}
 	VarArrayLoop(&map->relations, rIndex)
 	{
 		VarArrayLoopGet(OsmRelation, relation, &map->relations, rIndex);
-		if (relation->relationPntrs.arena != nullptr) { VarArrayClear(&relation->relationPntrs); }
+		if (relation->relationIndices.arena != nullptr) { VarArrayClear(&relation->relationIndices); }
 	}
 	
 	VarArrayLoop(&map->relations, rIndex)
@@ -307,65 +896,183 @@ void UpdateOsmRelationBackPntrs(OsmMap* map)
 		VarArrayLoop(&relation->members, mIndex)
 		{
 			VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
-			if (member->type == OsmRelationMemberType_Node && member->nodePntr != nullptr)
+			if (member->index != OSM_INVALID_INDEX) { AddOsmRelationMemberBackIndex(map, member, (u32)rIndex); }
+		}
+	}
+}
+
+// Sorts the entries and copies their unique ids into a new array in arena. The refs in entries don't matter here and can be nullptr
+u64* MakeSortedOsmIdSet(Arena* arena, uxx numEntries, OsmNodeRefEntry* entries, uxx* numIdsOut)
+{
+	NotNull(arena);
+	NotNull(numIdsOut);
+	*numIdsOut = 0;
+	if (numEntries == 0) { return nullptr; }
+	u64* result = AllocArray(u64, arena, numEntries);
+	NotNull(result);
+	ScratchBegin1(scratch, arena);
+	OsmNodeRefEntry* tempEntries = AllocArray(OsmNodeRefEntry, scratch, numEntries);
+	NotNull(tempEntries);
+	SortOsmNodeRefEntries(numEntries, entries, tempEntries);
+	ScratchEnd(scratch);
+	uxx numIds = 0;
+	for (uxx eIndex = 0; eIndex < numEntries; eIndex++)
+	{
+		if (numIds == 0 || result[numIds-1] != entries[eIndex].nodeId) { result[numIds] = entries[eIndex].nodeId; numIds++; }
+	}
+	*numIdsOut = numIds;
+	return result;
+}
+
+bool IsOsmIdInSortedSet(uxx numIds, const u64* ids, u64 id)
+{
+	uxx lowIndex = 0;
+	uxx highIndex = numIds;
+	while (lowIndex < highIndex)
+	{
+		uxx middleIndex = lowIndex + (highIndex - lowIndex)/2;
+		if (ids[middleIndex] < id) { lowIndex = middleIndex+1; }
+		else { highIndex = middleIndex; }
+	}
+	return (lowIndex < numIds && ids[lowIndex] == id);
+}
+
+// Returns the sorted (and de-duplicated) ids of every OsmNodeRef that ResolveOsmNodeRefs couldn't find a node for
+u64* GetMissingOsmNodeRefIds(OsmMap* map, Arena* arena, uxx* numIdsOut)
+{
+	NotNull(map);
+	NotNull(arena);
+	NotNull(numIdsOut);
+	*numIdsOut = 0;
+	uxx numMissingRefs = 0;
+	VarArrayLoop(&map->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+		if (way->locations.length > 0) { continue; }
+		VarArrayLoop(&way->nodes, nIndex) { VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex); if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { numMissingRefs++; } }
+	}
+	if (numMissingRefs == 0) { return nullptr; }
+	
+	ScratchBegin1(scratch, arena);
+	OsmNodeRefEntry* entries = AllocArray(OsmNodeRefEntry, scratch, numMissingRefs);
+	NotNull(entries);
+	uxx entryIndex = 0;
+	VarArrayLoop(&map->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+		if (way->locations.length > 0) { continue; }
+		VarArrayLoop(&way->nodes, nIndex)
+		{
+			VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
+			if (nodeRef->nodeIndex != OSM_INVALID_INDEX) { continue; }
+			entries[entryIndex].nodeId = nodeRef->id;
+			entries[entryIndex].ref = nodeRef;
+			entryIndex++;
+		}
+	}
+	u64* result = MakeSortedOsmIdSet(arena, numMissingRefs, entries, numIdsOut);
+	ScratchEnd(scratch);
+	return result;
+}
+
+// Drops every node that no way references (used by OsmTagFilterNodes_WayNodes when we couldn't avoid loading them in the first place).
+// The index handles of the nodes that are kept (node refs, relation members, selection) are remapped to where they moved
+void RemoveUnreferencedOsmNodes(OsmMap* map)
+{
+	TracyCZoneN(funcZone, "RemoveUnreferencedOsmNodes", true);
+	NotNull(map);
+	ResolveOsmNodeRefs(map);
+	if (map->nodes.length > 0)
+	{
+		ScratchBegin1(scratch, map->arena);
+		OsmNode* nodes = (OsmNode*)map->nodes.items;
+		u32* oldToNew = AllocArray(u32, scratch, map->nodes.length);
+		NotNull(oldToNew);
+		MyMemSet(oldToNew, 0xFF, sizeof(u32) * map->nodes.length); //0xFFFFFFFF is OSM_INVALID_INDEX, the nodes nothing references keep it
+		VarArrayLoop(&map->ways, wIndex)
+		{
+			VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+			VarArrayLoop(&way->nodes, nIndex)
 			{
-				if (member->nodePntr->relationPntrs.arena == nullptr) { InitVarArray(OsmRelation*, &member->nodePntr->relationPntrs, map->arena); }
-				VarArrayAddValue(OsmRelation*, &member->nodePntr->relationPntrs, relation);
+				VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
+				if (nodeRef->nodeIndex != OSM_INVALID_INDEX) { oldToNew[nodeRef->nodeIndex] = 0; }
 			}
-			else if (member->type == OsmRelationMemberType_Way && member->wayPntr != nullptr)
+		}
+		
+		uxx numKept = 0;
+		for (uxx nIndex = 0; nIndex < map->nodes.length; nIndex++)
+		{
+			if (oldToNew[nIndex] != OSM_INVALID_INDEX)
 			{
-				if (member->wayPntr->relationPntrs.arena == nullptr) { InitVarArray(OsmRelation*, &member->wayPntr->relationPntrs, map->arena); }
-				VarArrayAddValue(OsmRelation*, &member->wayPntr->relationPntrs, relation);
+				if (numKept != nIndex) { MyMemCopy(&nodes[numKept], &nodes[nIndex], sizeof(OsmNode)); }
+				oldToNew[nIndex] = (u32)numKept;
+				numKept++;
 			}
-			else if (member->type == OsmRelationMemberType_Relation && member->relationPntr != nullptr)
+			else
 			{
-				if (member->relationPntr->relationPntrs.arena == nullptr) { InitVarArray(OsmRelation*, &member->relationPntr->relationPntrs, map->arena); }
-				VarArrayAddValue(OsmRelation*, &member->relationPntr->relationPntrs, relation);
+				RemoveOsmTags(map, &nodes[nIndex].tags);
+				FreeOsmNode(map->arena, &nodes[nIndex]);
+				FreeOsmNodeInfo(map->arena, VarArrayGet(OsmNodeInfo, &map->nodeInfos, nIndex));
 			}
 		}
+		RemapOsmNodeColumns(map, oldToNew, numKept);
+		map->nodes.length = numKept;
+		RemapOsmNodeIndices(map, oldToNew);
+		InvalidateOsmIdTable(&map->nodeIdTable);
+		CompactOsmTags(map);
+		ScratchEnd(scratch);
 	}
+	TracyCZoneEnd(funcZone);
 }
 
-Str8 GetOsmNodeTagValue(OsmNode* node, Str8 tagKey, Str8 defaultValue)
+Str8 GetOsmTagValue(const OsmMap* map, OsmTagRange range, Str8 tagKey, Str8 defaultValue)
 {
-	if (node == nullptr) { return defaultValue; }
-	VarArrayLoop(&node->tags, tIndex)
+	const OsmTag* tags = GetOsmTags(map, range);
+	for (u32 tIndex = 0; tIndex < range.count; tIndex++)
 	{
-		VarArrayLoopGet(OsmTag, tag, &node->tags, tIndex);
-		if (StrAnyCaseEquals(tag->key, tagKey)) { return tag->value; }
+		if (StrAnyCaseEquals(tags[tIndex].key, tagKey)) { return tags[tIndex].value; }
 	}
 	return defaultValue;
 }
-Str8 GetOsmWayTagValue(OsmWay* way, Str8 tagKey, Str8 defaultValue)
+Str8 GetOsmNodeTagValue(const OsmMap* map, const OsmNode* node, Str8 tagKey, Str8 defaultValue)
+{
+	if (node == nullptr) { return defaultValue; }
+	return GetOsmTagValue(map, node->tags, tagKey, defaultValue);
+}
+Str8 GetOsmWayTagValue(const OsmMap* map, const OsmWay* way, Str8 tagKey, Str8 defaultValue)
 {
 	if (way == nullptr) { return defaultValue; }
-	VarArrayLoop(&way->tags, tIndex)
-	{
-		VarArrayLoopGet(OsmTag, tag, &way->tags, tIndex);
-		if (StrAnyCaseEquals(tag->key, tagKey)) { return tag->value; }
-	}
-	return defaultValue;
+	return GetOsmTagValue(map, way->tags, tagKey, defaultValue);
 }
-Str8 GetOsmRelationTagValue(OsmRelation* relation, Str8 tagKey, Str8 defaultValue)
+Str8 GetOsmRelationTagValue(const OsmMap* map, const OsmRelation* relation, Str8 tagKey, Str8 defaultValue)
 {
 	if (relation == nullptr) { return defaultValue; }
-	VarArrayLoop(&relation->tags, tIndex)
+	return GetOsmTagValue(map, relation->tags, tagKey, defaultValue);
+}
+
+// Adds srcRange's tags (from srcMap) onto the end of dstRange in dstMap, the strings are interned into dstMap->stringPool
+void CopyOsmTagsFromMap(OsmMap* dstMap, OsmTagRange* dstRange, const OsmMap* srcMap, OsmTagRange srcRange)
+{
+	if (srcRange.count == 0) { return; }
+	OsmTag* dstTags = AddOsmTags(dstMap, dstRange, srcRange.count);
+	const OsmTag* srcTags = GetOsmTags(srcMap, srcRange);
+	for (u32 tIndex = 0; tIndex < srcRange.count; tIndex++)
 	{
-		VarArrayLoopGet(OsmTag, tag, &relation->tags, tIndex);
-		if (StrAnyCaseEquals(tag->key, tagKey)) { return tag->value; }
+		dstTags[tIndex].key = InternOsmStr8(&dstMap->stringPool, srcTags[tIndex].key);
+		dstTags[tIndex].value = InternOsmStr8(&dstMap->stringPool, srcTags[tIndex].value);
 	}
-	return defaultValue;
 }
 
 void OsmAddFromMap(OsmMap* dstMap, const OsmMap* srcMap)
 {
 	dstMap->bounds = BothRecd(dstMap->bounds, srcMap->bounds);
+	VarArrayExpand(&dstMap->tags, dstMap->tags.length + (srcMap->tags.length - srcMap->numDeadTags));
 	
 	// +==============================+
 	// |          Add Nodes           |
 	// +==============================+
 	{
-		VarArrayExpand(&dstMap->nodes, dstMap->nodes.length + srcMap->nodes.length);
+		ExpandOsmNodes(dstMap, dstMap->nodes.length + srcMap->nodes.length);
 		
 		u64 prevNodeId = 0;
 		if (dstMap->nodes.length > 0) { prevNodeId = VarArrayGetLast(OsmNode, &dstMap->nodes)->id; }
@@ -377,42 +1084,23 @@ void OsmAddFromMap(OsmMap* dstMap, const OsmMap* srcMap)
 			{
 				if (srcNode->id <= prevNodeId) { dstMap->areNodesSorted = false; }
 				prevNodeId = srcNode->id;
-				OsmNode* dstNode = AddOsmNode(dstMap, srcNode->location, srcNode->id);
+				const OsmNodeInfo* srcInfo = VarArrayGet(OsmNodeInfo, &srcMap->nodeInfos, nIndex);
+				OsmNode* dstNode = AddOsmNode(dstMap, ToV2dFromOsmLocation(*VarArrayGet(OsmLocation, &srcMap->nodeLocations, nIndex)), srcNode->id);
 				NotNull(dstNode);
-				dstNode->visible = srcNode->visible;
-				dstNode->version = srcNode->version;
-				dstNode->changeset = srcNode->changeset;
-				dstNode->timestampStr = (!IsEmptyStr(srcNode->timestampStr) ? AllocStr8(dstMap->arena, srcNode->timestampStr) : Str8_Empty);
-				dstNode->user = (!IsEmptyStr(srcNode->user) ? AllocStr8(dstMap->arena, srcNode->user) : Str8_Empty);
-				dstNode->uid = srcNode->uid;
-				VarArrayLoop(&srcNode->tags, tIndex)
-				{
-					VarArrayLoopGet(OsmTag, srcTag, &srcNode->tags, tIndex);
-					OsmTag* dstTag = VarArrayAdd(OsmTag, &dstNode->tags);
-					NotNull(dstTag);
-					dstTag->key = AllocStr8(dstMap->arena, srcTag->key);
-					dstTag->value = AllocStr8(dstMap->arena, srcTag->value);
-				}
+				OsmNodeInfo* dstInfo = GetOsmNodeInfo(dstMap, dstNode);
+				dstInfo->visible = srcInfo->visible;
+				dstInfo->version = srcInfo->version;
+				dstInfo->changeset = srcInfo->changeset;
+				dstInfo->timestampStr = (!IsEmptyStr(srcInfo->timestampStr) ? AllocStr8(dstMap->arena, srcInfo->timestampStr) : Str8_Empty);
+				dstInfo->user = (!IsEmptyStr(srcInfo->user) ? AllocStr8(dstMap->arena, srcInfo->user) : Str8_Empty);
+				dstInfo->uid = srcInfo->uid;
+				CopyOsmTagsFromMap(dstMap, &dstNode->tags, srcMap, srcNode->tags);
 			}
 		}
 		
-		//Sort the nodes if needed
-		if (!dstMap->areNodesSorted)
-		{
-			QuickSortVarArrayUintMember(OsmNode, id, &dstMap->nodes);
-			dstMap->areNodesSorted = true;
-		}
-		
-		//Update NodeRef pntrs for existing ways since we expanded the node array and it may have been reallocated
-		VarArrayLoop(&dstMap->ways, wIndex)
-		{
-			VarArrayLoopGet(OsmWay, way, &dstMap->ways, wIndex);
-			VarArrayLoop(&way->nodes, nIndex)
-			{
-				VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
-				nodeRef->pntr = FindOsmNode(dstMap, nodeRef->id);
-			}
-		}
+		//NOTE: The existing ways keep pointing at the right nodes, sorting only remaps their indices. Refs that were missing might be here now
+		SortOsmNodes(dstMap);
+		ResolveMissingOsmNodeRefs(dstMap);
 	}
 	
 	// +==============================+
@@ -434,48 +1122,39 @@ void OsmAddFromMap(OsmMap* dstMap, const OsmMap* srcMap)
 				ScratchBegin1(scratch, dstMap->arena);
 				u64* nodeIds = (srcWay->nodes.length > 0) ? AllocArray(u64, scratch, srcWay->nodes.length) : nullptr;
 				VarArrayLoop(&srcWay->nodes, nIndex) { VarArrayLoopGet(OsmNodeRef, nodeRef, &srcWay->nodes, nIndex); nodeIds[nIndex] = nodeRef->id; }
-				OsmWay* dstWay = AddOsmWay(dstMap, srcWay->id, srcWay->nodes.length, nodeIds);
+				OsmWay* dstWay = AddOsmWayUnresolved(dstMap, srcWay->id, srcWay->nodes.length, nodeIds);
 				ScratchEnd(scratch);
 				NotNull(dstWay);
+				u32 dstWayIndex = (u32)(dstMap->ways.length-1);
+				if (srcWay->locations.length > 0)
+				{
+					InitVarArrayWithInitial(OsmLocation, &dstWay->locations, dstMap->arena, srcWay->locations.length);
+					VarArrayLoop(&srcWay->locations, lIndex) { VarArrayAddValue(OsmLocation, &dstWay->locations, *VarArrayGet(OsmLocation, &srcWay->locations, lIndex)); }
+				}
+				else
+				{
+					VarArrayLoop(&dstWay->nodes, nIndex)
+					{
+						VarArrayLoopGet(OsmNodeRef, nodeRef, &dstWay->nodes, nIndex);
+						nodeRef->nodeIndex = FindOsmNodeIndex(dstMap, nodeRef->id);
+						if (nodeRef->nodeIndex == OSM_INVALID_INDEX) { dstMap->waysMissingNodes = true; continue; }
+						OsmNode* node = GetOsmNodeByIndex(dstMap, nodeRef->nodeIndex);
+						if (node->wayIndices.arena == nullptr) { InitVarArray(u32, &node->wayIndices, dstMap->arena); }
+						VarArrayAddValue(u32, &node->wayIndices, dstWayIndex);
+					}
+				}
+				UpdateOsmWayNodeBounds(dstMap, dstWay);
 				dstWay->visible = srcWay->visible;
 				dstWay->version = srcWay->version;
 				dstWay->changeset = srcWay->changeset;
 				dstWay->timestampStr = (!IsEmptyStr(srcWay->timestampStr) ? AllocStr8(dstMap->arena, srcWay->timestampStr) : Str8_Empty);
 				dstWay->user = (!IsEmptyStr(srcWay->user) ? AllocStr8(dstMap->arena, srcWay->user) : Str8_Empty);
 				dstWay->uid = srcWay->uid;
-				VarArrayLoop(&srcWay->tags, tIndex)
-				{
-					VarArrayLoopGet(OsmTag, srcTag, &srcWay->tags, tIndex);
-					OsmTag* dstTag = VarArrayAdd(OsmTag, &dstWay->tags);
-					NotNull(dstTag);
-					dstTag->key = AllocStr8(dstMap->arena, srcTag->key);
-					dstTag->value = AllocStr8(dstMap->arena, srcTag->value);
-				}
+				CopyOsmTagsFromMap(dstMap, &dstWay->tags, srcMap, srcWay->tags);
 			}
 		}
 		
-		//Sort the ways if needed
-		if (!dstMap->areWaysSorted)
-		{
-			QuickSortVarArrayUintMember(OsmWay, id, &dstMap->ways);
-			dstMap->areWaysSorted = true;
-		}
-		
-		UpdateOsmNodeWayBackPntrs(dstMap);
-		
-		//Update Relation Member Pntrs
-		VarArrayLoop(&dstMap->relations, rIndex)
-		{
-			VarArrayLoopGet(OsmRelation, relation, &dstMap->relations, rIndex);
-			VarArrayLoop(&relation->members, mIndex)
-			{
-				VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
-				if (member->type == OsmRelationMemberType_Node) { member->nodePntr = FindOsmNode(dstMap, member->id); }
-				else if (member->type == OsmRelationMemberType_Way) { member->wayPntr = FindOsmWay(dstMap, member->id); }
-				else if (member->type == OsmRelationMemberType_Relation) { /*member->relationPntr = FindOsmRelation(dstMap, member->id);*/ } //NOTE: We'll do this for all relations later, after we've added the new ones
-				else { Assert(false); }
-			}
-		}
+		SortOsmWays(dstMap);
 	}
 	
 	// +==============================+
@@ -483,6 +1162,7 @@ void OsmAddFromMap(OsmMap* dstMap, const OsmMap* srcMap)
 	// +==============================+
 	{
 		VarArrayExpand(&dstMap->relations, dstMap->relations.length + srcMap->relations.length);
+		uxx numOldRelations = dstMap->relations.length;
 		
 		u64 prevRelationId = 0;
 		if (dstMap->relations.length > 0) { prevRelationId = VarArrayGetLast(OsmRelation, &dstMap->relations)->id; }
@@ -511,54 +1191,21 @@ void OsmAddFromMap(OsmMap* dstMap, const OsmMap* srcMap)
 					dstMember->id = srcMember->id;
 					dstMember->type = srcMember->type;
 					dstMember->role = srcMember->role;
+					dstMember->index = OSM_INVALID_INDEX; //We'll look it up below, once all the new relations are in
 					//TODO: Copy the locations!
-					if (dstMember->type == OsmRelationMemberType_Node) { dstMember->nodePntr = FindOsmNode(dstMap, dstMember->id); }
-					else if (dstMember->type == OsmRelationMemberType_Way) { dstMember->wayPntr = FindOsmWay(dstMap, dstMember->id); }
-					else if (dstMember->type == OsmRelationMemberType_Relation) { /*dstMember->relationPntr = FindOsmRelation(dstMap, dstMember->id);*/ } //NOTE: We'll do this for all relations later, after we've added the new ones
-					else { Assert(false); }
-				}
-				VarArrayLoop(&srcRelation->tags, tIndex)
-				{
-					VarArrayLoopGet(OsmTag, srcTag, &srcRelation->tags, tIndex);
-					OsmTag* dstTag = VarArrayAdd(OsmTag, &dstRelation->tags);
-					NotNull(dstTag);
-					dstTag->key = AllocStr8(dstMap->arena, srcTag->key);
-					dstTag->value = AllocStr8(dstMap->arena, srcTag->value);
 				}
+				CopyOsmTagsFromMap(dstMap, &dstRelation->tags, srcMap, srcRelation->tags);
 			}
 		}
 		
-		//Sort the relations if needed
-		if (!dstMap->areRelationsSorted)
+		//NOTE: Only the new relations and the members that were missing before (which the new nodes, ways or relations might fill in) are looked up
+		bool wereRelationsMissingMembers = dstMap->relationsMissingMembers;
+		dstMap->relationsMissingMembers = false;
+		for (uxx rIndex = (wereRelationsMissingMembers ? 0 : numOldRelations); rIndex < dstMap->relations.length; rIndex++)
 		{
-			QuickSortVarArrayUintMember(OsmRelation, id, &dstMap->relations);
-			dstMap->areRelationsSorted = true;
+			ResolveOsmRelationMembers(dstMap, VarArrayGet(OsmRelation, &dstMap->relations, rIndex), true);
 		}
 		
-		//Update Relation Members that are Relation Type
-		VarArrayLoop(&dstMap->relations, rIndex)
-		{
-			VarArrayLoopGet(OsmRelation, relation, &dstMap->relations, rIndex);
-			VarArrayLoop(&relation->members, mIndex)
-			{
-				VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
-				if (member->type == OsmRelationMemberType_Relation) { member->relationPntr = FindOsmRelation(dstMap, member->id); }
-			}
-		}
-		
-		UpdateOsmRelationBackPntrs(dstMap);
-	}
-	
-	// +==============================+
-	// |    Update Selection Pntrs    |
-	// +==============================+
-	{
-		VarArrayLoop(&dstMap->selectedItems, sIndex)
-		{
-			VarArrayLoopGet(OsmSelectedItem, selectedItem, &dstMap->selectedItems, sIndex);
-			if (selectedItem->type == OsmPrimitiveType_Node) { selectedItem->nodePntr = FindOsmNode(dstMap, selectedItem->id); }
-			else if (selectedItem->type == OsmPrimitiveType_Way) { selectedItem->wayPntr = FindOsmWay(dstMap, selectedItem->id); }
-			else { Assert(false); }
-		}
+		SortOsmRelations(dstMap);
 	}
 }
@@ -7,6 +7,8 @@ Date:   07\06\2025
 #ifndef _OSM_MAP_H
 #define _OSM_MAP_H
 
+#define OSM_INVALID_INDEX   UINT32_MAX //an index handle that doesn't refer to anything, usually because the primitive isn't in the map
+
 typedef enum OsmPrimitiveType OsmPrimitiveType;
 enum OsmPrimitiveType
 {
@@ -27,6 +29,7 @@ const char* GetOsmPrimitiveTypeStr(OsmPrimitiveType enumValue)
 }
 
 // <tag k="highway" v="secondary"/>
+// The strings are owned by the map's stringPool, they're interned with InternOsmStr8 and are never freed individually
 typedef plex OsmTag OsmTag;
 plex OsmTag
 {
@@ -34,31 +37,83 @@ plex OsmTag
 	Str8 value;
 };
 
+// Where a primitive's tags are in map->tags. The loaders add each primitive's tags all at once so they end up back to back with
+// no per-primitive allocation, an untagged primitive is just a zero count. Use GetOsmTags to get at them and AddOsmTags to add more
+typedef plex OsmTagRange OsmTagRange;
+plex OsmTagRange
+{
+	u32 offset; //into map->tags, meaningless when count is 0
+	u32 count;
+};
+
 // <node id="30139418" visible="true" version="5" changeset="50213102" timestamp="2017-07-11T21:17:35Z" user="Natfoot" uid="567792" lat="47.7801029" lon="-122.1907513"/>
+// Only the id, tags and back-references live here. The location, flags and metadata are in columns on the OsmMap that parallel map->nodes
+// (see GetOsmNodeLocation, GetOsmNodeFlags and GetOsmNodeInfo) so the loops that only need the locations don't have to pull the rest through the cache
 typedef plex OsmNode OsmNode;
 plex OsmNode
 {
 	u64 id;
+	OsmTagRange tags;
+	VarArray wayIndices; //u32, into map->ways
+	VarArray relationIndices; //u32, into map->relations
+};
+
+// The parts of a node we only need when showing it in the info panel or saving it, map->nodeInfos
+typedef plex OsmNodeInfo OsmNodeInfo;
+plex OsmNodeInfo
+{
 	bool visible;
 	i32 version;
 	u64 changeset;
 	Str8 timestampStr;
 	Str8 user;
 	u64 uid;
-	v2d location;
-	VarArray tags; //OsmTag
-	VarArray wayPntrs; //OsmWay*
-	VarArray relationPntrs; //OsmRelation*
-	
-	bool isSelected;
-	bool isHovered;
 };
 
+// map->nodeFlags
+typedef enum OsmNodeFlag OsmNodeFlag;
+enum OsmNodeFlag
+{
+	OsmNodeFlag_None     = 0x00,
+	OsmNodeFlag_Selected = 0x01,
+	OsmNodeFlag_Hovered  = 0x02,
+	OsmNodeFlag_All      = 0x03,
+};
+
+// A lon/lat in 1e-7 degree units, which is all the precision OSM itself keeps (and what a .pbf gives us with the default granularity)
+typedef plex OsmFixedLocation OsmFixedLocation;
+plex OsmFixedLocation
+{
+	i32 lon;
+	i32 lat;
+};
+
+// What map->nodeLocations, OsmWay.locations and OsmRelationMember.locations hold, OSM_FIXED_POINT_LOCATIONS (in defines.h) picks between doubles and fixed-point.
+// Both have lon and lat members so comparisons work either way, but go through ToOsmLocation/ToV2dFromOsmLocation (or DecodeOsmLocations
+// for a whole run of them) to get degrees. Decoding is left until something actually needs degrees, usually right before MapProject.
+// Loops that only compare locations can scale what they compare against by OSM_LOCATION_UNITS_PER_DEGREE instead
+#if OSM_FIXED_POINT_LOCATIONS
+typedef OsmFixedLocation OsmLocation;
+#define OSM_LOCATION_UNITS_PER_DEGREE   OSM_COORD_FIXED_SCALE
+#else
+typedef v2d OsmLocation;
+#define OSM_LOCATION_UNITS_PER_DEGREE   1
+#endif
+
 typedef plex OsmNodeRef OsmNodeRef;
 plex OsmNodeRef
 {
 	u64 id;
-	OsmNode* pntr;
+	u32 nodeIndex; //into map->nodes, OSM_INVALID_INDEX until resolved or when the node is missing
+};
+
+// Scratch entries used by ResolveOsmNodeRefs to sort every way's refs by node id. SortOsmPrimitivesById
+// sorts these too, with the id of a node, way or relation and where it was in the array
+typedef plex OsmNodeRefEntry OsmNodeRefEntry;
+plex OsmNodeRefEntry
+{
+	u64 nodeId;
+	union { OsmNodeRef* ref; uxx index; };
 };
 
 typedef enum OsmRenderLayer OsmRenderLayer;
@@ -97,8 +152,9 @@ plex OsmWay
 	u64 uid;
 	
 	VarArray nodes; //OsmNodeRef
-	VarArray tags; //OsmTag
-	VarArray relationPntrs; //OsmRelation*
+	VarArray locations; //OsmLocation, one per node when the way came from a LocationsOnWays .pbf (see OsmLoadOptions.useLocationsOnWays), in which case the node refs are never resolved
+	OsmTagRange tags;
+	VarArray relationIndices; //u32, into map->relations
 	recd nodeBounds;
 	
 	bool colorsChosen;
@@ -283,8 +339,8 @@ plex OsmRelationMember
 	u64 id;
 	OsmRelationMemberType type;
 	OsmRelationMemberRole role;
-	VarArray locations; //v2d
-	union { void* pntr; OsmNode* nodePntr; OsmWay* wayPntr; plex OsmRelation* relationPntr; };
+	VarArray locations; //OsmLocation, the node's location or the way's geometry when the .osm file has them inline
+	u32 index; //into map->nodes, map->ways or map->relations depending on type, OSM_INVALID_INDEX when the member is missing
 };
 
 typedef plex OsmRelation OsmRelation;
@@ -299,9 +355,9 @@ plex OsmRelation
 	u64 uid;
 	recd bounds;
 	
-	VarArray tags; //OsmTag
+	OsmTagRange tags;
 	VarArray members; //OsmRelationMember
-	VarArray relationPntrs; //OsmRelation*
+	VarArray relationIndices; //u32, into map->relations
 };
 
 typedef plex OsmSelectedItem OsmSelectedItem;
@@ -309,9 +365,13 @@ plex OsmSelectedItem
 {
 	OsmPrimitiveType type;
 	u64 id;
-	union { void* pntr; OsmNode* nodePntr; OsmWay* wayPntr; };
+	u32 index; //into map->nodes or map->ways depending on type
 };
 
+//NOTE: Primitives refer to each other by their index in the arrays below (OsmNodeRef.nodeIndex, OsmRelationMember.index, OsmNode.wayIndices, etc.)
+//      rather than by pointer, so adding to an array never invalidates anything even when it reallocates. Anything that reorders an
+//      array has to go through SortOsmNodes/SortOsmWays/SortOsmRelations (or RemoveUnreferencedOsmNodes), which remap them (and move
+//      the node columns along with the nodes). That includes the loaders, so a handle resolved before a sort stays valid after it
 typedef plex OsmMap OsmMap;
 plex OsmMap
 {
@@ -326,18 +386,48 @@ plex OsmMap
 	bool areNodesSorted;
 	u64 nextNodeId;
 	VarArray nodes; //OsmNode
+	VarArray nodeLocations; //OsmLocation, same length and order as nodes
+	VarArray nodeFlags; //u8, OsmNodeFlag, same length and order as nodes
+	VarArray nodeInfos; //OsmNodeInfo, same length and order as nodes
+	OsmIdTable nodeIdTable;
 	
 	bool areWaysSorted;
 	bool waysMissingNodes;
 	u64 nextWayId;
 	VarArray ways; //OsmWay
+	OsmIdTable wayIdTable;
 	
 	bool areRelationsSorted;
 	bool relationsMissingMembers;
 	u64 nextRelationId;
 	VarArray relations; //OsmRelation
+	OsmIdTable relationIdTable;
+	
+	VarArray tags; //OsmTag, every node's, way's and relation's tags (see OsmTagRange)
+	uxx numDeadTags; //tags in the array that nothing refers to anymore (left behind by AddOsmTags or by removed primitives), see CompactOsmTags
+	OsmStringPool stringPool; //tag keys and values
 	
 	VarArray selectedItems; //OsmSelectedItem
 };
 
+// Passed to TryParsePbfMap (and TryParseMapFile) to control how a map is loaded. A zeroed struct gives the default behavior
+typedef plex OsmLoadOptions OsmLoadOptions;
+plex OsmLoadOptions
+{
+	WorkerPool* workerPool; //nullptr means everything is done on the calling thread
+	bool useProtobufCDecoder; //.pbf only, decodes PrimitiveBlocks with the generated osm_pbf.pb-c.c code instead of our own decoder
+	PbfKernelLevel kernelLevel; //.pbf only, Auto uses the fastest DenseNodes kernels the CPU supports
+	bool disableMemoryMapping; //TryParseMapFile reads .pbf files through an OsFile DataStream (and .osm files into memory) instead of mapping them
+	bool useBoundsFilter; //.pbf only, nodes outside boundsFilter are dropped as they are decoded and only the ways and relations that reference kept nodes (or ways) are added
+	recd boundsFilter; //lon/lat, the sign of the size doesn't matter. Also replaces the map's bounds
+	bool keepWayNodesOutsideBounds; //.pbf only, ways that cross the edge of boundsFilter also get their nodes that are outside it. Requires a second pass over the file so it only works on memory mapped files
+	OsmTagFilter* tagFilter; //compiled with TryCompileOsmTagFilter, ways and relations that don't match are dropped before they are added to the map
+	OsmTagFilterNodes tagFilterNodes; //which nodes are kept when tagFilter is set
+	bool useLocationsOnWays; //.pbf only, when the file has the "LocationsOnWays" feature ways take their geometry from the coordinates stored inline and untagged nodes are never added to the map
+	PbfBlobIndex* blobIndex; //.pbf only, memory mapped files only. When given, filtered loads skip the blobs the index says can't contain anything that would be kept
+	PbfBlobIndex* buildBlobIndex; //.pbf only, memory mapped files only. Gets an entry for every blob in the file (only when nothing is filtered and blobIndex is not being used)
+	bool disableBlobIndex; //.pbf only, TryParseMapFile neither reads nor writes the PBF_BLOB_INDEX_FILE_EXT file next to the .pbf
+	OsmLoadProgress* progress; //lets another thread watch the load, cancel it (the load returns Result_Canceled) and take a preview of the ways as they're added
+};
+
 #endif //  _OSM_MAP_H
@@ -6,347 +6,1195 @@ Description:
 	** Holds TryParseOsmMap and SerializeOsmMap which handle the XML-based .osm file format
 */
 
-Result TryParseOsmMap(Arena* arena, Str8 xmlFileContents, OsmMap* mapOut)
+bool IsOsmXmlNameEnd(char c)
 {
-	TracyCZoneN(funcZone, "TryParseOsmMap", true);
-	ScratchBegin1(scratch, arena);
-	XmlFile xml = ZEROED;
-	Result parseResult = TryParseXml(xmlFileContents, scratch, &xml);
-	if (parseResult != Result_Success)
+	return (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>');
+}
+
+// A cheap pass over the raw file that counts <node, <way, <relation and <tag opening tags so the OsmMap arrays can be allocated once up front.
+// We look for '<' 8 bytes at a time (see "Determine if a word has a byte equal to n" in Bit Twiddling Hacks) and only look closer at words that have one.
+// This doesn't know about comments or CDATA so the counts can come out a little high, which is fine for sizing
+void CountOsmXmlPrimitives(Str8 xmlFileContents, uxx* numNodesOut, uxx* numWaysOut, uxx* numRelationsOut, uxx* numTagsOut)
+{
+	TracyCZoneN(funcZone, "CountOsmXmlPrimitives", true);
+	const u64 onesMask = 0x0101010101010101ULL;
+	const u64 highsMask = 0x8080808080808080ULL;
+	const u64 openAngleMask = 0x3C3C3C3C3C3C3C3CULL; //'<' in every byte
+	uxx numNodes = 0;
+	uxx numWays = 0;
+	uxx numRelations = 0;
+	uxx numTags = 0;
+	uxx cIndex = 0;
+	while (cIndex < xmlFileContents.length)
 	{
-		ScratchEnd(scratch);
-		TracyCZoneEnd(funcZone);
-		return parseResult;
-	}
-	
-	InitOsmMap(arena, mapOut, 0, 0, 0);
-	mapOut->areNodesSorted = true;
-	mapOut->areWaysSorted = true;
-	mapOut->areRelationsSorted = false; //TODO: Change me!
-	
-	do
-	{
-		XmlElement* root = XmlGetOneChildOrBreak(&xml, nullptr, StrLit("osm"));
-		Str8 mapVersionStr  = XmlGetAttributeOrDefault(&xml, root, StrLit("version"),     Str8_Empty);
-		Str8 generatorStr   = XmlGetAttributeOrDefault(&xml, root, StrLit("generator"),   Str8_Empty);
-		Str8 copyrightStr   = XmlGetAttributeOrDefault(&xml, root, StrLit("copyright"),   Str8_Empty);
-		Str8 attributionStr = XmlGetAttributeOrDefault(&xml, root, StrLit("attribution"), Str8_Empty);
-		Str8 licenseStr     = XmlGetAttributeOrDefault(&xml, root, StrLit("license"),     Str8_Empty);
-		mapOut->versionStr     = (!IsEmptyStr(mapVersionStr)  ? AllocStr8(arena, mapVersionStr)  : Str8_Empty);
-		mapOut->generatorStr   = (!IsEmptyStr(generatorStr)   ? AllocStr8(arena, generatorStr)   : Str8_Empty);
-		mapOut->copyrightStr   = (!IsEmptyStr(copyrightStr)   ? AllocStr8(arena, copyrightStr)   : Str8_Empty);
-		mapOut->attributionStr = (!IsEmptyStr(attributionStr) ? AllocStr8(arena, attributionStr) : Str8_Empty);
-		mapOut->licenseStr     = (!IsEmptyStr(licenseStr)     ? AllocStr8(arena, licenseStr)     : Str8_Empty);
+		if (xmlFileContents.length - cIndex >= sizeof(u64))
+		{
+			u64 word = 0;
+			MyMemCopy(&word, &xmlFileContents.chars[cIndex], sizeof(u64));
+			u64 xored = (word ^ openAngleMask);
+			if (((xored - onesMask) & ~xored & highsMask) == 0) { cIndex += sizeof(u64); continue; }
+		}
+		if (xmlFileContents.chars[cIndex] == '<')
+		{
+			Str8 rest = MakeStr8(xmlFileContents.length - (cIndex+1), &xmlFileContents.chars[cIndex+1]);
+			if (rest.length > 4 && MyMemEquals(rest.chars, "node", 4) && IsOsmXmlNameEnd(rest.chars[4])) { numNodes++; }
+			else if (rest.length > 3 && MyMemEquals(rest.chars, "way", 3) && IsOsmXmlNameEnd(rest.chars[3])) { numWays++; }
+			else if (rest.length > 8 && MyMemEquals(rest.chars, "relation", 8) && IsOsmXmlNameEnd(rest.chars[8])) { numRelations++; }
+			else if (rest.length > 3 && MyMemEquals(rest.chars, "tag", 3) && IsOsmXmlNameEnd(rest.chars[3])) { numTags++; }
+		}
+		cIndex++;
+	}
+	TracyCZoneValue(funcZone, xmlFileContents.length);
+	if (numNodesOut != nullptr) { *numNodesOut = numNodes; }
+	if (numWaysOut != nullptr) { *numWaysOut = numWays; }
+	if (numRelationsOut != nullptr) { *numRelationsOut = numRelations; }
+	if (numTagsOut != nullptr) { *numTagsOut = numTags; }
+	TracyCZoneEnd(funcZone);
+}
+
+// +--------------------------------------------------------------+
+// |                       .osm XML Loader                        |
+// +--------------------------------------------------------------+
+//NOTE: TryParseOsmMap feeds hoxml's events straight into an OsmXmlLoader rather than building an XmlFile first. The attributes and children
+//      of each node/way/relation are collected in buffers that get reused for every element and the primitive is only added to the map when
+//      its end tag comes through, that way the tag filter gets to see all of the tags before we add anything
+
+typedef enum OsmXmlElement OsmXmlElement;
+enum OsmXmlElement
+{
+	OsmXmlElement_None = 0,
+	OsmXmlElement_Unknown, //anything we don't expect where it is, it's skipped along with all of its children
+	OsmXmlElement_Osm,
+	OsmXmlElement_OsmChange, //the root of an .osc file, in place of osm
+	OsmXmlElement_Change, //<create> or <modify> in osmChange. <delete> is Unknown, the elements in it usually only have an id
+	OsmXmlElement_Bounds, //in osm or relation
+	OsmXmlElement_Node,
+	OsmXmlElement_Way,
+	OsmXmlElement_Relation,
+	OsmXmlElement_Tag,
+	OsmXmlElement_Nd, //in way, or in a member of a relation for the locations of a way member
+	OsmXmlElement_Member,
+	OsmXmlElement_Count,
+};
+const char* GetOsmXmlElementStr(OsmXmlElement enumValue)
+{
+	switch (enumValue)
+	{
+		case OsmXmlElement_None:      return "None";
+		case OsmXmlElement_Unknown:   return "Unknown";
+		case OsmXmlElement_Osm:       return "osm";
+		case OsmXmlElement_OsmChange: return "osmChange";
+		case OsmXmlElement_Change:    return "create/modify";
+		case OsmXmlElement_Bounds:    return "bounds";
+		case OsmXmlElement_Node:      return "node";
+		case OsmXmlElement_Way:       return "way";
+		case OsmXmlElement_Relation:  return "relation";
+		case OsmXmlElement_Tag:       return "tag";
+		case OsmXmlElement_Nd:        return "nd";
+		case OsmXmlElement_Member:    return "member";
+		default: return UNKNOWN_STR;
+	}
+}
+
+typedef plex OsmXmlMember OsmXmlMember;
+plex OsmXmlMember
+{
+	u64 id;
+	bool hasId;
+	bool hasType;
+	bool hasRole;
+	OsmRelationMemberType type;
+	OsmRelationMemberRole role;
+	v2d location; //INFINITY when the member doesn't have lat/lon attributes
+	uxx firstLocationIndex; //into OsmXmlLoader.memberLocations, for the <nd lat="" lon=""/> children of way members
+	uxx numLocations;
+};
+
+typedef plex OsmXmlLoader OsmXmlLoader;
+plex OsmXmlLoader
+{
+	Arena* arena; //the map's arena
+	Arena* scratch; //holds the buffers below, which are reused for every element
+	Arena* elementArena; //reset after every child of <osm>. Holds copies of the strings that hoxml only keeps until its next event
+	uxx elementArenaMark;
+	OsmMap* map;
+	hoxml_context_t* hoxml;
+	char* hoxmlBuffer; //scratch, starts at OSM_XML_HOXML_BUFFER_SIZE and doubles whenever hoxml runs out of room
+	uxx hoxmlBufferSize;
+	Str8 xmlFileContents; //handed to hoxml OSM_XML_CHUNK_SIZE bytes at a time
+	MappedFile* mappedFile; //nullptr when xmlFileContents isn't mapped
+	StreamDecoder* decoder; //when the file is compressed the chunks come from here instead, and xmlFileContents is the compressed data
+	uxx chunkOffset; //where the chunk hoxml is working on starts in xmlFileContents
+	bool isSegment; //one piece of a threaded load (see OsmXmlPipeline), the progress and preview are handled when the segment is merged
+	Str8 segmentPrefix; //handed to hoxml before xmlFileContents, "<osm>" for every segment but the first
+	Str8 segmentSuffix; //handed to hoxml after xmlFileContents, "</osm>" for every segment but the last
+	OsmTagFilter* tagFilter;
+	OsmTagFilterNodes tagFilterNodes;
+	bool keepOnlyWayNodes;
+	bool onlyCollectWayNodes; //the first pass of a keepOnlyWayNodes load, which only looks at the ways and adds the node ids of the ones that match the filter to wayNodeRefs
+	VarArray wayNodeRefs; //OsmNodeRefEntry
+	uxx numWayNodeIds;
+	u64* wayNodeIds;
+	OsmLoadProgress* progress;
+	u64 fileSize;
+	uxx numElementsDone;
+	
+	Result error;
+	Str8 errorStr;
+	OsmXmlElement errorElement;
+	u32 errorLine;
+	
+	uxx depth;
+	OsmXmlElement stack[XML_MAX_DEPTH];
+	bool foundBounds; //on <osm>
+	bool isOsmChange; //the root was <osmChange>, which has no <bounds>
+	u8 boundsFoundMask; //bits in the order of boundsValues
+	r64 boundsValues[4]; //minlon, minlat, maxlon, maxlat
+	
+	//NOTE: The node, way or relation that we're inside of
+	u64 id;
+	bool hasId;
+	bool hasLon;
+	bool hasLat;
+	v2d location;
+	bool visible;
+	i32 version;
+	u64 changeset;
+	u64 uid;
+	Str8 timestampStr; //elementArena
+	Str8 user; //elementArena
+	bool hasBounds;
+	recd bounds;
+	VarArray tags; //OsmTag, the strings are in elementArena
+	VarArray nodeIds; //u64
+	VarArray members; //OsmXmlMember
+	VarArray memberLocations; //v2d
+	
+	//NOTE: The <tag> or <nd> that we're inside of
+	bool childHasKey;
+	bool childHasValue;
+	bool childHasRef;
+	bool childHasLon;
+	bool childHasLat;
+	OsmTag childTag;
+	u64 childRef;
+	v2d childLocation;
+};
+
+void SetOsmXmlLoaderError(OsmXmlLoader* loader, Result error, Str8 errorStr)
+{
+	if (loader->error != Result_None) { return; } //the first error is the interesting one
+	loader->error = error;
+	loader->errorStr = errorStr;
+	loader->errorElement = (loader->depth > 0) ? loader->stack[loader->depth-1] : OsmXmlElement_None;
+	loader->errorLine = (loader->hoxml != nullptr) ? loader->hoxml->line : 0;
+}
+
+OsmXmlElement GetOsmXmlElement(Str8 name, OsmXmlElement parent)
+{
+	switch (parent)
+	{
+		case OsmXmlElement_None:
+		{
+			if (StrExactEquals(name, StrLit("osm"))) { return OsmXmlElement_Osm; }
+			if (StrExactEquals(name, StrLit("osmChange"))) { return OsmXmlElement_OsmChange; }
+		} break;
+		case OsmXmlElement_OsmChange:
+		{
+			if (StrExactEquals(name, StrLit("create"))) { return OsmXmlElement_Change; }
+			if (StrExactEquals(name, StrLit("modify"))) { return OsmXmlElement_Change; }
+		} break;
+		case OsmXmlElement_Osm:
+		case OsmXmlElement_Change:
+		{
+			if (StrExactEquals(name, StrLit("node"))) { return OsmXmlElement_Node; }
+			if (StrExactEquals(name, StrLit("way"))) { return OsmXmlElement_Way; }
+			if (StrExactEquals(name, StrLit("relation"))) { return OsmXmlElement_Relation; }
+			if (parent == OsmXmlElement_Osm && StrExactEquals(name, StrLit("bounds"))) { return OsmXmlElement_Bounds; }
+		} break;
+		case OsmXmlElement_Node:
+		{
+			if (StrExactEquals(name, StrLit("tag"))) { return OsmXmlElement_Tag; }
+		} break;
+		case OsmXmlElement_Way:
+		{
+			if (StrExactEquals(name, StrLit("nd"))) { return OsmXmlElement_Nd; }
+			if (StrExactEquals(name, StrLit("tag"))) { return OsmXmlElement_Tag; }
+		} break;
+		case OsmXmlElement_Relation:
+		{
+			if (StrExactEquals(name, StrLit("member"))) { return OsmXmlElement_Member; }
+			if (StrExactEquals(name, StrLit("tag"))) { return OsmXmlElement_Tag; }
+			if (StrExactEquals(name, StrLit("bounds"))) { return OsmXmlElement_Bounds; }
+		} break;
+		case OsmXmlElement_Member:
+		{
+			if (StrExactEquals(name, StrLit("nd"))) { return OsmXmlElement_Nd; }
+		} break;
+		default: break;
+	}
+	return OsmXmlElement_Unknown;
+}
+
+bool TryParseOsmXmlU64(OsmXmlLoader* loader, Str8 attributeName, Str8 valueStr, u64* valueOut)
+{
+	if (TryParseOsmU64(valueStr, valueOut)) { return true; }
+	SetOsmXmlLoaderError(loader, Result_InvalidAttributeValue, attributeName);
+	return false;
+}
+bool TryParseOsmXmlR64(OsmXmlLoader* loader, Str8 attributeName, Str8 valueStr, r64* valueOut)
+{
+	if (TryParseOsmCoord(valueStr, valueOut)) { return true; }
+	SetOsmXmlLoaderError(loader, Result_InvalidAttributeValue, attributeName);
+	return false;
+}
+
+// Called once per child of <osm>. Every OSM_LOAD_PROGRESS_PERIOD elements we report how far through the file we are, hand any
+// new ways over for the preview and check if the load was canceled. Returns false when it was. Segments of a threaded load pass
+// nullptr for map, they only check for cancellation since the progress and preview are updated as each segment is merged
+bool UpdateOsmXmlLoadProgress(OsmLoadProgress* progress, OsmMap* map, u64 processedBytes, uxx* numElementsDone)
+{
+	if (progress == nullptr) { return true; }
+	(*numElementsDone)++;
+	if ((*numElementsDone % OSM_LOAD_PROGRESS_PERIOD) != 0) { return true; }
+	if (map != nullptr)
+	{
+		SetOsmLoadProgressBytes(progress, processedBytes);
+		PublishOsmLoadPreview(progress, map);
+	}
+	return !IsOsmLoadCanceled(progress);
+}
+
+//NOTE: A keepOnlyWayNodes load goes through the file twice so we count each pass as half of the progress
+u64 GetOsmXmlLoaderProgressBytes(OsmXmlLoader* loader, u64 passBytes)
+{
+	if (!loader->keepOnlyWayNodes) { return passBytes; }
+	else if (loader->onlyCollectWayNodes) { return passBytes / 2; }
+	else { return (loader->fileSize + passBytes) / 2; }
+}
+
+void AddOsmXmlTags(OsmMap* map, uxx numTags, const OsmTag* tags, OsmTagRange* rangeOut)
+{
+	if (numTags == 0) { return; }
+	OsmTag* newTags = AddOsmTags(map, rangeOut, numTags);
+	for (uxx tIndex = 0; tIndex < numTags; tIndex++)
+	{
+		newTags[tIndex].key = InternOsmStr8(&map->stringPool, tags[tIndex].key);
+		newTags[tIndex].value = InternOsmStr8(&map->stringPool, tags[tIndex].value);
+	}
+}
+
+void BeginOsmXmlElement(OsmXmlLoader* loader, Str8 name)
+{
+	if (loader->depth >= XML_MAX_DEPTH) { SetOsmXmlLoaderError(loader, Result_StackOverflow, Str8_Empty); return; }
+	OsmXmlElement parent = (loader->depth > 0) ? loader->stack[loader->depth-1] : OsmXmlElement_None;
+	OsmXmlElement element = GetOsmXmlElement(name, parent);
+	if (parent == OsmXmlElement_None && element != OsmXmlElement_Osm && element != OsmXmlElement_OsmChange) { SetOsmXmlLoaderError(loader, Result_ElementNotFound, StrLit("osm")); return; }
+	if (element == OsmXmlElement_OsmChange) { loader->isOsmChange = true; }
+	//NOTE: The first pass of a keepOnlyWayNodes load skips everything but the ways and their children
+	if (loader->onlyCollectWayNodes && element != OsmXmlElement_Osm && element != OsmXmlElement_OsmChange && element != OsmXmlElement_Change &&
+		element != OsmXmlElement_Way && parent != OsmXmlElement_Way)
+	{
+		element = OsmXmlElement_Unknown;
+	}
+	loader->stack[loader->depth] = element;
+	loader->depth++;
+	
+	switch (element)
+	{
+		case OsmXmlElement_Bounds:
+		{
+			loader->boundsFoundMask = 0;
+		} break;
 		
-		XmlElement* bounds = XmlGetOneChildOrBreak(&xml, root, StrLit("bounds"));
-		r64 boundsMinLon = XmlGetAttributeR64OrBreak(&xml, bounds, StrLit("minlon"));
-		r64 boundsMinLat = XmlGetAttributeR64OrBreak(&xml, bounds, StrLit("minlat"));
-		r64 boundsMaxLon = XmlGetAttributeR64OrBreak(&xml, bounds, StrLit("maxlon"));
-		r64 boundsMaxLat = XmlGetAttributeR64OrBreak(&xml, bounds, StrLit("maxlat"));
-		//TODO: This does not properly handle if the rectangle passes over the international date line (max longitude will be less than min longitude)
-		mapOut->bounds = NewRecdBetween(boundsMinLon, boundsMinLat, boundsMaxLon, boundsMaxLat);
+		case OsmXmlElement_Node:
+		case OsmXmlElement_Way:
+		case OsmXmlElement_Relation:
+		{
+			loader->id = 0;
+			loader->hasId = false;
+			loader->hasLon = false;
+			loader->hasLat = false;
+			loader->location = V2d_Zero;
+			loader->visible = true;
+			loader->version = 0;
+			loader->changeset = 0;
+			loader->uid = 0;
+			loader->timestampStr = Str8_Empty;
+			loader->user = Str8_Empty;
+			loader->hasBounds = false;
+			VarArrayClear(&loader->tags);
+			VarArrayClear(&loader->nodeIds);
+			VarArrayClear(&loader->members);
+			VarArrayClear(&loader->memberLocations);
+		} break;
 		
-		u64 prevNodeId = 0;
-		bool areNodesSorted = true;
-		u64 prevWayId = 0;
-		bool areWaysSorted = true;
+		case OsmXmlElement_Tag:
+		{
+			loader->childHasKey = false;
+			loader->childHasValue = false;
+			loader->childTag.key = Str8_Empty;
+			loader->childTag.value = Str8_Empty;
+		} break;
 		
-		// +==============================+
-		// |         Parse Nodes          |
-		// +==============================+
-		XmlElement* xmlNode = nullptr;
-		while ((xmlNode = XmlGetNextChild(&xml, root, StrLit("node"), xmlNode)) != nullptr)
-		{
-			u64 id        = XmlGetAttributeU64OrBreak(&xml, xmlNode, StrLit("id"));
-			r64 longitude = XmlGetAttributeR64OrBreak(&xml, xmlNode, StrLit("lon"));
-			r64 latitude  = XmlGetAttributeR64OrBreak(&xml, xmlNode, StrLit("lat"));
-			Str8 visibleStr   = XmlGetAttributeOrDefault(&xml, xmlNode, StrLit("visible"),   Str8_Empty);
-			Str8 versionStr   = XmlGetAttributeOrDefault(&xml, xmlNode, StrLit("version"),   Str8_Empty);
-			Str8 changesetStr = XmlGetAttributeOrDefault(&xml, xmlNode, StrLit("changeset"), Str8_Empty);
-			Str8 timestampStr = XmlGetAttributeOrDefault(&xml, xmlNode, StrLit("timestamp"), Str8_Empty);
-			Str8 userStr      = XmlGetAttributeOrDefault(&xml, xmlNode, StrLit("user"),      Str8_Empty);
-			Str8 uidStr       = XmlGetAttributeOrDefault(&xml, xmlNode, StrLit("uid"),       Str8_Empty);
-			bool visible = true;
-			i32 version = 0;
-			u64 changeset = 0;
-			u64 uid = 0;
-			if (!IsEmptyStr(visibleStr)   && !TryParseBool(visibleStr,  &visible,   nullptr)) { PrintLine_W("Failed to parse visible attribute as bool on node %llu: \"%.*s\"", id, StrPrint(visibleStr)); }
-			if (!IsEmptyStr(versionStr)   && !TryParseI32(versionStr,   &version,   nullptr)) { PrintLine_W("Failed to parse version attribute as i32 on node %llu: \"%.*s\"", id, StrPrint(versionStr)); }
-			if (!IsEmptyStr(changesetStr) && !TryParseU64(changesetStr, &changeset, nullptr)) { PrintLine_W("Failed to parse changeset attribute as u64 on node %llu: \"%.*s\"", id, StrPrint(changesetStr)); }
-			if (!IsEmptyStr(uidStr)       && !TryParseU64(uidStr,       &uid,       nullptr)) { PrintLine_W("Failed to parse uid attribute as u64 on node %llu: \"%.*s\"", id, StrPrint(uidStr)); }
-			
-			if (id <= prevNodeId) { areNodesSorted = false; }
-			prevNodeId = id;
-			
-			OsmNode* newNode = AddOsmNode(mapOut, MakeV2d(longitude, latitude), id);
-			NotNull(newNode);
-			newNode->visible = visible;
-			newNode->version = version;
-			newNode->changeset = changeset;
-			newNode->timestampStr = (!IsEmptyStr(timestampStr) ? AllocStr8(arena, timestampStr) : Str8_Empty);
-			newNode->user = (!IsEmptyStr(userStr) ? AllocStr8(arena, userStr) : Str8_Empty);
-			newNode->uid = uid;
-			
-			XmlElement* xmlTag = nullptr;
-			while ((xmlTag = XmlGetNextChild(&xml, xmlNode, StrLit("tag"), xmlTag)) != nullptr)
-			{
-				Str8 keyStr = XmlGetAttributeOrBreak(&xml, xmlTag, StrLit("k"));
-				Str8 valueStr = XmlGetAttributeOrBreak(&xml, xmlTag, StrLit("v"));
-				OsmTag* newTag = VarArrayAdd(OsmTag, &newNode->tags);
-				NotNull(newTag);
-				ClearPointer(newTag);
-				newTag->key = AllocStr8(arena, keyStr);
-				newTag->value = AllocStr8(arena, valueStr);
-			}
-			if (xml.error != Result_None) { break; }
-		}
-		if (xml.error != Result_None) { break; }
+		case OsmXmlElement_Nd:
+		{
+			loader->childHasRef = false;
+			loader->childHasLon = false;
+			loader->childHasLat = false;
+		} break;
 		
-		// +==============================+
-		// |          Sort Nodes          |
-		// +==============================+
-		if (!mapOut->areNodesSorted || !areNodesSorted)
-		{
-			TracyCZoneN(Zone_SortNodes, "SortNodes", true);
-			QuickSortVarArrayUintMember(OsmNode, id, &mapOut->nodes);
-			mapOut->areNodesSorted = true;
-			TracyCZoneEnd(Zone_SortNodes);
-		}
+		case OsmXmlElement_Member:
+		{
+			OsmXmlMember* newMember = VarArrayAdd(OsmXmlMember, &loader->members);
+			NotNull(newMember);
+			ClearPointer(newMember);
+			newMember->location = MakeV2d(INFINITY, INFINITY);
+			newMember->firstLocationIndex = loader->memberLocations.length;
+		} break;
+		
+		default: break;
+	}
+}
+
+void HandleOsmXmlAttribute(OsmXmlLoader* loader, Str8 name, Str8 value)
+{
+	if (loader->depth == 0) { return; }
+	OsmXmlElement element = loader->stack[loader->depth-1];
+	switch (element)
+	{
+		case OsmXmlElement_Osm:
+		case OsmXmlElement_OsmChange:
+		{
+			if (loader->onlyCollectWayNodes || IsEmptyStr(value)) { break; }
+			OsmMap* map = loader->map;
+			if (StrExactEquals(name, StrLit("version"))) { map->versionStr = AllocStr8(loader->arena, value); }
+			else if (StrExactEquals(name, StrLit("generator"))) { map->generatorStr = AllocStr8(loader->arena, value); }
+			else if (StrExactEquals(name, StrLit("copyright"))) { map->copyrightStr = AllocStr8(loader->arena, value); }
+			else if (StrExactEquals(name, StrLit("attribution"))) { map->attributionStr = AllocStr8(loader->arena, value); }
+			else if (StrExactEquals(name, StrLit("license"))) { map->licenseStr = AllocStr8(loader->arena, value); }
+		} break;
+		
+		case OsmXmlElement_Bounds:
+		{
+			uxx valueIndex = 4;
+			if (StrExactEquals(name, StrLit("minlon"))) { valueIndex = 0; }
+			else if (StrExactEquals(name, StrLit("minlat"))) { valueIndex = 1; }
+			else if (StrExactEquals(name, StrLit("maxlon"))) { valueIndex = 2; }
+			else if (StrExactEquals(name, StrLit("maxlat"))) { valueIndex = 3; }
+			if (valueIndex < 4 && TryParseOsmXmlR64(loader, name, value, &loader->boundsValues[valueIndex])) { FlagSet(loader->boundsFoundMask, (u8)(1 << valueIndex)); }
+		} break;
 		
-		// +==============================+
-		// |          Parse Ways          |
-		// +==============================+
-		XmlElement* xmlWay = nullptr;
-		while ((xmlWay = XmlGetNextChild(&xml, root, StrLit("way"), xmlWay)) != nullptr)
-		{
-			u64 mark = ArenaGetMark(scratch);
-			u64 numNodesInWay = 0;
-			VarArrayLoop(&xmlWay->children, cIndex)
+		case OsmXmlElement_Node:
+		case OsmXmlElement_Way:
+		case OsmXmlElement_Relation:
+		{
+			if (StrExactEquals(name, StrLit("id"))) { loader->hasId = TryParseOsmXmlU64(loader, name, value, &loader->id); }
+			else if (element == OsmXmlElement_Node && StrExactEquals(name, StrLit("lon"))) { loader->hasLon = TryParseOsmXmlR64(loader, name, value, &loader->location.lon); }
+			else if (element == OsmXmlElement_Node && StrExactEquals(name, StrLit("lat"))) { loader->hasLat = TryParseOsmXmlR64(loader, name, value, &loader->location.lat); }
+			else if (IsEmptyStr(value)) { }
+			else if (StrExactEquals(name, StrLit("visible")))
 			{
-				VarArrayLoopGet(XmlElement, xmlChild, &xmlWay->children, cIndex);
-				if (StrExactEquals(xmlChild->type, StrLit("nd"))) { numNodesInWay++; }
+				if (!TryParseBool(value, &loader->visible, nullptr)) { PrintLine_W("Failed to parse visible attribute as bool on %s on line %u: \"%.*s\"", GetOsmXmlElementStr(element), loader->hoxml->line, StrPrint(value)); }
 			}
-			
-			u64* nodeIds = (numNodesInWay != 0) ? AllocArray(u64, scratch, numNodesInWay) : nullptr;
-			u64 nIndex = 0;
-			VarArrayLoop(&xmlWay->children, cIndex)
+			else if (StrExactEquals(name, StrLit("version")))
 			{
-				VarArrayLoopGet(XmlElement, xmlChild, &xmlWay->children, cIndex);
-				if (StrExactEquals(xmlChild->type, StrLit("nd")))
-				{
-					nodeIds[nIndex] = XmlGetAttributeU64OrBreak(&xml, xmlChild, StrLit("ref"));
-					nIndex++;
-				}
+				if (!TryParseOsmI32(value, &loader->version)) { PrintLine_W("Failed to parse version attribute as i32 on %s on line %u: \"%.*s\"", GetOsmXmlElementStr(element), loader->hoxml->line, StrPrint(value)); }
 			}
-			if (xml.error != Result_None) { break; }
-			
-			u64 id = XmlGetAttributeU64OrBreak(&xml, xmlWay, StrLit("id"));
-			Str8 visibleStr   = XmlGetAttributeOrDefault(&xml, xmlWay, StrLit("visible"),   Str8_Empty);
-			Str8 versionStr   = XmlGetAttributeOrDefault(&xml, xmlWay, StrLit("version"),   Str8_Empty);
-			Str8 changesetStr = XmlGetAttributeOrDefault(&xml, xmlWay, StrLit("changeset"), Str8_Empty);
-			Str8 timestampStr = XmlGetAttributeOrDefault(&xml, xmlWay, StrLit("timestamp"), Str8_Empty);
-			Str8 userStr      = XmlGetAttributeOrDefault(&xml, xmlWay, StrLit("user"),      Str8_Empty);
-			Str8 uidStr       = XmlGetAttributeOrDefault(&xml, xmlWay, StrLit("uid"),       Str8_Empty);
-			bool visible = true;
-			i32 version = 0;
-			u64 changeset = 0;
-			u64 uid = 0;
-			if (!IsEmptyStr(visibleStr)   && !TryParseBool(visibleStr,  &visible,   nullptr)) { PrintLine_W("Failed to parse visible attribute as bool on way %llu: \"%.*s\"", id, StrPrint(visibleStr)); }
-			if (!IsEmptyStr(versionStr)   && !TryParseI32(versionStr,   &version,   nullptr)) { PrintLine_W("Failed to parse version attribute as i32 on way %llu: \"%.*s\"", id, StrPrint(versionStr)); }
-			if (!IsEmptyStr(changesetStr) && !TryParseU64(changesetStr, &changeset, nullptr)) { PrintLine_W("Failed to parse changeset attribute as u64 on way %llu: \"%.*s\"", id, StrPrint(changesetStr)); }
-			if (!IsEmptyStr(uidStr)       && !TryParseU64(uidStr,       &uid,       nullptr)) { PrintLine_W("Failed to parse uid attribute as u64 on way %llu: \"%.*s\"", id, StrPrint(uidStr)); }
-			
-			if (id <= prevWayId) { areWaysSorted = false; }
-			prevWayId = id;
-			
-			OsmWay* newWay = AddOsmWay(mapOut, id, numNodesInWay, nodeIds);
-			NotNull(newWay);
-			newWay->visible = visible;
-			newWay->version = version;
-			newWay->changeset = changeset;
-			newWay->timestampStr = (!IsEmptyStr(timestampStr) ? AllocStr8(arena, timestampStr) : Str8_Empty);
-			newWay->user = (!IsEmptyStr(userStr) ? AllocStr8(arena, userStr) : Str8_Empty);
-			newWay->uid = uid;
-			
-			XmlElement* xmlTag = nullptr;
-			while ((xmlTag = XmlGetNextChild(&xml, xmlWay, StrLit("tag"), xmlTag)) != nullptr)
+			else if (StrExactEquals(name, StrLit("changeset")))
 			{
-				Str8 keyStr = XmlGetAttributeOrBreak(&xml, xmlTag, StrLit("k"));
-				Str8 valueStr = XmlGetAttributeOrBreak(&xml, xmlTag, StrLit("v"));
-				OsmTag* newTag = VarArrayAdd(OsmTag, &newWay->tags);
-				NotNull(newTag);
-				ClearPointer(newTag);
-				newTag->key = AllocStr8(arena, keyStr);
-				newTag->value = AllocStr8(arena, valueStr);
+				if (!TryParseOsmU64(value, &loader->changeset)) { PrintLine_W("Failed to parse changeset attribute as u64 on %s on line %u: \"%.*s\"", GetOsmXmlElementStr(element), loader->hoxml->line, StrPrint(value)); }
 			}
-			if (xml.error != Result_None) { break; }
-			
-			ArenaResetToMark(scratch, mark);
-		}
-		if (xml.error != Result_None) { break; }
-		
-		// +==============================+
-		// |          Sort Ways           |
-		// +==============================+
-		if (!mapOut->areWaysSorted || !areWaysSorted)
-		{
-			TracyCZoneN(Zone_SortWays, "SortWays", true);
-			QuickSortVarArrayUintMember(OsmWay, id, &mapOut->ways);
-			mapOut->areWaysSorted = true;
-			TracyCZoneEnd(Zone_SortWays);
-		}
-		
-		// +==============================+
-		// |       Parse Relations        |
-		// +==============================+
-		XmlElement* xmlRelation = nullptr;
-		while ((xmlRelation = XmlGetNextChild(&xml, root, StrLit("relation"), xmlRelation)) != nullptr)
-		{
-			u64 id = XmlGetAttributeU64OrBreak(&xml, xmlRelation, StrLit("id"));
-			Str8 visibleStr   = XmlGetAttributeOrDefault(&xml, xmlRelation, StrLit("visible"),   Str8_Empty);
-			Str8 versionStr   = XmlGetAttributeOrDefault(&xml, xmlRelation, StrLit("version"),   Str8_Empty);
-			Str8 changesetStr = XmlGetAttributeOrDefault(&xml, xmlRelation, StrLit("changeset"), Str8_Empty);
-			Str8 timestampStr = XmlGetAttributeOrDefault(&xml, xmlRelation, StrLit("timestamp"), Str8_Empty);
-			Str8 userStr      = XmlGetAttributeOrDefault(&xml, xmlRelation, StrLit("user"),      Str8_Empty);
-			Str8 uidStr       = XmlGetAttributeOrDefault(&xml, xmlRelation, StrLit("uid"),       Str8_Empty);
-			bool visible = true;
-			i32 version = 0;
-			u64 changeset = 0;
-			u64 uid = 0;
-			if (!IsEmptyStr(visibleStr)   && !TryParseBool(visibleStr,  &visible,   nullptr)) { PrintLine_W("Failed to parse visible attribute as bool on relation %llu: \"%.*s\"", id, StrPrint(visibleStr)); }
-			if (!IsEmptyStr(versionStr)   && !TryParseI32(versionStr,   &version,   nullptr)) { PrintLine_W("Failed to parse version attribute as i32 on relation %llu: \"%.*s\"", id, StrPrint(versionStr)); }
-			if (!IsEmptyStr(changesetStr) && !TryParseU64(changesetStr, &changeset, nullptr)) { PrintLine_W("Failed to parse changeset attribute as u64 on relation %llu: \"%.*s\"", id, StrPrint(changesetStr)); }
-			if (!IsEmptyStr(uidStr)       && !TryParseU64(uidStr,       &uid,       nullptr)) { PrintLine_W("Failed to parse uid attribute as u64 on relation %llu: \"%.*s\"", id, StrPrint(uidStr)); }
-			XmlElement* xmlRelationBounds = XmlGetChild(&xml, xmlRelation, StrLit("bounds"), 0);
-			
-			u64 numMembersInRelation = 0;
-			VarArrayLoop(&xmlRelation->children, cIndex)
+			else if (StrExactEquals(name, StrLit("uid")))
 			{
-				VarArrayLoopGet(XmlElement, xmlChild, &xmlRelation->children, cIndex);
-				if (StrExactEquals(xmlChild->type, StrLit("member"))) { numMembersInRelation++; }
+				if (!TryParseOsmU64(value, &loader->uid)) { PrintLine_W("Failed to parse uid attribute as u64 on %s on line %u: \"%.*s\"", GetOsmXmlElementStr(element), loader->hoxml->line, StrPrint(value)); }
 			}
-			
-			OsmRelation* newRelation = AddOsmRelation(mapOut, id, numMembersInRelation);
-			if (xmlRelationBounds != nullptr)
-			{
-				r64 relationBoundsMinLon = XmlGetAttributeR64OrBreak(&xml, xmlRelationBounds, StrLit("minlon"));
-				r64 relationBoundsMinLat = XmlGetAttributeR64OrBreak(&xml, xmlRelationBounds, StrLit("minlat"));
-				r64 relationBoundsMaxLon = XmlGetAttributeR64OrBreak(&xml, xmlRelationBounds, StrLit("maxlon"));
-				r64 relationBoundsMaxLat = XmlGetAttributeR64OrBreak(&xml, xmlRelationBounds, StrLit("maxlat"));
-				newRelation->bounds = NewRecdBetween(relationBoundsMinLon, relationBoundsMinLat, relationBoundsMaxLon, relationBoundsMaxLat);
-			}
-			newRelation->visible = visible;
-			newRelation->version = version;
-			newRelation->changeset = changeset;
-			newRelation->timestampStr = (!IsEmptyStr(timestampStr) ? AllocStr8(arena, timestampStr) : Str8_Empty);
-			newRelation->user = (!IsEmptyStr(userStr) ? AllocStr8(arena, userStr) : Str8_Empty);
-			newRelation->uid = uid;
-			
-			XmlElement* xmlMember = nullptr;
-			while ((xmlMember = XmlGetNextChild(&xml, xmlRelation, StrLit("member"), xmlMember)) != nullptr)
+			else if (StrExactEquals(name, StrLit("timestamp"))) { loader->timestampStr = AllocStr8(loader->elementArena, value); }
+			else if (StrExactEquals(name, StrLit("user"))) { loader->user = AllocStr8(loader->elementArena, value); }
+		} break;
+		
+		case OsmXmlElement_Tag:
+		{
+			if (StrExactEquals(name, StrLit("k"))) { loader->childTag.key = AllocStr8(loader->elementArena, value); loader->childHasKey = true; }
+			else if (StrExactEquals(name, StrLit("v"))) { loader->childTag.value = AllocStr8(loader->elementArena, value); loader->childHasValue = true; }
+		} break;
+		
+		case OsmXmlElement_Nd:
+		{
+			if (StrExactEquals(name, StrLit("ref"))) { loader->childHasRef = TryParseOsmXmlU64(loader, name, value, &loader->childRef); }
+			else if (StrExactEquals(name, StrLit("lon"))) { loader->childHasLon = TryParseOsmXmlR64(loader, name, value, &loader->childLocation.lon); }
+			else if (StrExactEquals(name, StrLit("lat"))) { loader->childHasLat = TryParseOsmXmlR64(loader, name, value, &loader->childLocation.lat); }
+		} break;
+		
+		case OsmXmlElement_Member:
+		{
+			OsmXmlMember* member = VarArrayGetLast(OsmXmlMember, &loader->members);
+			if (StrExactEquals(name, StrLit("type")))
 			{
-				Str8 typeStr = XmlGetAttributeOrBreak(&xml, xmlMember, StrLit("type"));
-				u64 refId = XmlGetAttributeU64OrBreak(&xml, xmlMember, StrLit("ref"));
-				Str8 roleStr = XmlGetAttributeOrBreak(&xml, xmlMember, StrLit("role"));
-				r64 latitude = XmlGetAttributeR64OrDefault(&xml, xmlMember, StrLit("lat"), INFINITY);
-				r64 longitude = XmlGetAttributeR64OrDefault(&xml, xmlMember, StrLit("lon"), INFINITY);
-				
-				OsmRelationMemberType type = OsmRelationMemberType_None;
 				for (uxx eIndex = 1; eIndex < OsmRelationMemberType_Count; eIndex++)
 				{
-					const char* enumValueStrNt = GetOsmRelationMemberTypeXmlStr((OsmRelationMemberType)eIndex);
-					if (StrAnyCaseEquals(typeStr, MakeStr8Nt(enumValueStrNt)))
+					if (StrAnyCaseEquals(value, MakeStr8Nt(GetOsmRelationMemberTypeXmlStr((OsmRelationMemberType)eIndex))))
 					{
-						type = (OsmRelationMemberType)eIndex;
+						member->type = (OsmRelationMemberType)eIndex;
 						break;
 					}
 				}
-				if (type == OsmRelationMemberType_None) { xml.error = Result_InvalidType; xml.errorStr = typeStr; xml.errorElement = xmlRelation; break; }
-				OsmRelationMemberRole role = OsmRelationMemberRole_None;
-				if (!IsEmptyStr(roleStr))
+				if (member->type == OsmRelationMemberType_None) { SetOsmXmlLoaderError(loader, Result_InvalidType, AllocStr8(loader->scratch, value)); break; }
+				member->hasType = true;
+			}
+			else if (StrExactEquals(name, StrLit("ref"))) { member->hasId = TryParseOsmXmlU64(loader, name, value, &member->id); }
+			else if (StrExactEquals(name, StrLit("role")))
+			{
+				member->hasRole = true;
+				if (IsEmptyStr(value)) { break; }
+				for (uxx eIndex = 1; eIndex < OsmRelationMemberRole_Count; eIndex++)
 				{
-					for (uxx eIndex = 1; eIndex < OsmRelationMemberRole_Count; eIndex++)
+					if (StrAnyCaseEquals(value, MakeStr8Nt(GetOsmRelationMemberRoleXmlStr((OsmRelationMemberRole)eIndex))))
 					{
-						const char* enumValueStrNt = GetOsmRelationMemberRoleXmlStr((OsmRelationMemberRole)eIndex);
-						if (StrAnyCaseEquals(roleStr, MakeStr8Nt(enumValueStrNt)))
-						{
-							role = (OsmRelationMemberRole)eIndex;
-							break;
-						}
+						member->role = (OsmRelationMemberRole)eIndex;
+						break;
 					}
-					if (role == OsmRelationMemberRole_None) { PrintLine_W("Warning: Unknown role type \"%.*s\" on member[%llu] in relation %llu", StrPrint(roleStr), newRelation->members.length, newRelation->id); }
 				}
-				
-				OsmRelationMember* newMember = VarArrayAdd(OsmRelationMember, &newRelation->members);
-				NotNull(newMember);
-				ClearPointer(newMember);
-				newMember->id = refId;
-				newMember->type = type;
-				newMember->role = role;
-				
-				if (newMember->type == OsmRelationMemberType_Node && !IsInfiniteOrNanR64(latitude) && !IsInfiniteOrNanR64(longitude))
+				if (member->role == OsmRelationMemberRole_None) { PrintLine_W("Warning: Unknown role type \"%.*s\" on member[%llu] in relation %llu", StrPrint(value), loader->members.length-1, loader->id); }
+			}
+			else if (StrExactEquals(name, StrLit("lon"))) { TryParseOsmXmlR64(loader, name, value, &member->location.lon); }
+			else if (StrExactEquals(name, StrLit("lat"))) { TryParseOsmXmlR64(loader, name, value, &member->location.lat); }
+		} break;
+		
+		default: break;
+	}
+}
+
+void FinishOsmXmlNode(OsmXmlLoader* loader)
+{
+	if (!loader->hasId) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("id")); return; }
+	if (!loader->hasLon) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("lon")); return; }
+	if (!loader->hasLat) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("lat")); return; }
+	if (loader->keepOnlyWayNodes && !IsOsmIdInSortedSet(loader->numWayNodeIds, loader->wayNodeIds, loader->id)) { return; }
+	if (loader->tagFilter != nullptr && loader->tagFilterNodes == OsmTagFilterNodes_Matching &&
+		!DoesOsmTagFilterMatch(loader->tagFilter, loader->tags.length, (const OsmTag*)loader->tags.items))
+	{
+		return;
+	}
+	
+	OsmMap* map = loader->map;
+	OsmNode* lastNode = VarArrayGetLastSoft(OsmNode, &map->nodes);
+	if (lastNode != nullptr && loader->id <= lastNode->id) { map->areNodesSorted = false; }
+	
+	OsmNode* newNode = AddOsmNode(map, loader->location, loader->id);
+	NotNull(newNode);
+	OsmNodeInfo* newInfo = GetOsmNodeInfo(map, newNode);
+	newInfo->visible = loader->visible;
+	newInfo->version = loader->version;
+	newInfo->changeset = loader->changeset;
+	newInfo->timestampStr = (!IsEmptyStr(loader->timestampStr) ? AllocStr8(loader->arena, loader->timestampStr) : Str8_Empty);
+	newInfo->user = (!IsEmptyStr(loader->user) ? AllocStr8(loader->arena, loader->user) : Str8_Empty);
+	newInfo->uid = loader->uid;
+	AddOsmXmlTags(loader->map, loader->tags.length, (const OsmTag*)loader->tags.items, &newNode->tags);
+}
+
+void FinishOsmXmlWay(OsmXmlLoader* loader)
+{
+	if (!loader->hasId) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("id")); return; }
+	if (loader->tagFilter != nullptr && !DoesOsmTagFilterMatch(loader->tagFilter, loader->tags.length, (const OsmTag*)loader->tags.items)) { return; }
+	if (loader->onlyCollectWayNodes)
+	{
+		VarArrayLoop(&loader->nodeIds, nIndex)
+		{
+			VarArrayLoopGetValue(u64, nodeId, &loader->nodeIds, nIndex);
+			OsmNodeRefEntry* newEntry = VarArrayAdd(OsmNodeRefEntry, &loader->wayNodeRefs);
+			NotNull(newEntry);
+			newEntry->nodeId = nodeId;
+			newEntry->ref = nullptr;
+		}
+		return;
+	}
+	
+	OsmMap* map = loader->map;
+	OsmWay* lastWay = VarArrayGetLastSoft(OsmWay, &map->ways);
+	if (lastWay != nullptr && loader->id <= lastWay->id) { map->areWaysSorted = false; }
+	
+	OsmWay* newWay = AddOsmWayUnresolved(map, loader->id, loader->nodeIds.length, (u64*)loader->nodeIds.items);
+	NotNull(newWay);
+	newWay->visible = loader->visible;
+	newWay->version = loader->version;
+	newWay->changeset = loader->changeset;
+	newWay->timestampStr = (!IsEmptyStr(loader->timestampStr) ? AllocStr8(loader->arena, loader->timestampStr) : Str8_Empty);
+	newWay->user = (!IsEmptyStr(loader->user) ? AllocStr8(loader->arena, loader->user) : Str8_Empty);
+	newWay->uid = loader->uid;
+	AddOsmXmlTags(loader->map, loader->tags.length, (const OsmTag*)loader->tags.items, &newWay->tags);
+}
+
+void FinishOsmXmlRelation(OsmXmlLoader* loader)
+{
+	if (!loader->hasId) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("id")); return; }
+	if (loader->tagFilter != nullptr && !DoesOsmTagFilterMatch(loader->tagFilter, loader->tags.length, (const OsmTag*)loader->tags.items)) { return; }
+	
+	OsmRelation* newRelation = AddOsmRelation(loader->map, loader->id, loader->members.length);
+	NotNull(newRelation);
+	if (loader->hasBounds) { newRelation->bounds = loader->bounds; }
+	newRelation->visible = loader->visible;
+	newRelation->version = loader->version;
+	newRelation->changeset = loader->changeset;
+	newRelation->timestampStr = (!IsEmptyStr(loader->timestampStr) ? AllocStr8(loader->arena, loader->timestampStr) : Str8_Empty);
+	newRelation->user = (!IsEmptyStr(loader->user) ? AllocStr8(loader->arena, loader->user) : Str8_Empty);
+	newRelation->uid = loader->uid;
+	
+	VarArrayLoop(&loader->members, mIndex)
+	{
+		VarArrayLoopGet(OsmXmlMember, member, &loader->members, mIndex);
+		OsmRelationMember* newMember = VarArrayAdd(OsmRelationMember, &newRelation->members);
+		NotNull(newMember);
+		ClearPointer(newMember);
+		newMember->id = member->id;
+		newMember->type = member->type;
+		newMember->role = member->role;
+		newMember->index = OSM_INVALID_INDEX;
+		if (member->type == OsmRelationMemberType_Node && !IsInfiniteOrNanR64(member->location.lat) && !IsInfiniteOrNanR64(member->location.lon))
+		{
+			InitVarArrayWithInitial(OsmLocation, &newMember->locations, loader->arena, 1);
+			VarArrayAddValue(OsmLocation, &newMember->locations, ToOsmLocation(member->location));
+		}
+		else if (member->type == OsmRelationMemberType_Way)
+		{
+			InitVarArrayWithInitial(OsmLocation, &newMember->locations, loader->arena, member->numLocations);
+			for (uxx lIndex = 0; lIndex < member->numLocations; lIndex++)
+			{
+				VarArrayAddValue(OsmLocation, &newMember->locations, ToOsmLocation(*VarArrayGet(v2d, &loader->memberLocations, member->firstLocationIndex + lIndex)));
+			}
+		}
+	}
+	
+	AddOsmXmlTags(loader->map, loader->tags.length, (const OsmTag*)loader->tags.items, &newRelation->tags);
+}
+
+void EndOsmXmlElement(OsmXmlLoader* loader)
+{
+	if (loader->depth == 0) { SetOsmXmlLoaderError(loader, Result_UnexpectedEndElement, Str8_Empty); return; }
+	OsmXmlElement element = loader->stack[loader->depth-1];
+	OsmXmlElement parent = (loader->depth >= 2) ? loader->stack[loader->depth-2] : OsmXmlElement_None;
+	switch (element)
+	{
+		case OsmXmlElement_Bounds:
+		{
+			const char* boundsNames[4] = { "minlon", "minlat", "maxlon", "maxlat" };
+			bool foundAllValues = true;
+			for (uxx vIndex = 0; vIndex < 4; vIndex++)
+			{
+				if (!IsFlagSet(loader->boundsFoundMask, (u8)(1 << vIndex))) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, MakeStr8Nt(boundsNames[vIndex])); foundAllValues = false; break; }
+			}
+			if (!foundAllValues) { break; }
+			//TODO: This does not properly handle if the rectangle passes over the international date line (max longitude will be less than min longitude)
+			recd bounds = NewRecdBetween(loader->boundsValues[0], loader->boundsValues[1], loader->boundsValues[2], loader->boundsValues[3]);
+			if (parent == OsmXmlElement_Osm)
+			{
+				if (loader->foundBounds) { SetOsmXmlLoaderError(loader, Result_Duplicate, StrLit("bounds")); break; }
+				loader->map->bounds = bounds;
+				loader->foundBounds = true;
+			}
+			else if (parent == OsmXmlElement_Relation) { loader->hasBounds = true; loader->bounds = bounds; }
+		} break;
+		
+		case OsmXmlElement_Tag:
+		{
+			if (!loader->childHasKey) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("k")); break; }
+			if (!loader->childHasValue) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("v")); break; }
+			VarArrayAddValue(OsmTag, &loader->tags, loader->childTag);
+		} break;
+		
+		case OsmXmlElement_Nd:
+		{
+			if (parent == OsmXmlElement_Way)
+			{
+				if (!loader->childHasRef) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("ref")); break; }
+				VarArrayAddValue(u64, &loader->nodeIds, loader->childRef);
+			}
+			else
+			{
+				if (!loader->childHasLat) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("lat")); break; }
+				if (!loader->childHasLon) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("lon")); break; }
+				VarArrayAddValue(v2d, &loader->memberLocations, loader->childLocation);
+				VarArrayGetLast(OsmXmlMember, &loader->members)->numLocations++;
+			}
+		} break;
+		
+		case OsmXmlElement_Member:
+		{
+			OsmXmlMember* member = VarArrayGetLast(OsmXmlMember, &loader->members);
+			if (!member->hasType) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("type")); break; }
+			if (!member->hasId) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("ref")); break; }
+			if (!member->hasRole) { SetOsmXmlLoaderError(loader, Result_AttributeNotFound, StrLit("role")); break; }
+		} break;
+		
+		case OsmXmlElement_Node: FinishOsmXmlNode(loader); break;
+		case OsmXmlElement_Way: FinishOsmXmlWay(loader); break;
+		case OsmXmlElement_Relation: FinishOsmXmlRelation(loader); break;
+		default: break;
+	}
+	if (loader->error != Result_None) { return; }
+	loader->depth--;
+	
+	if (parent == OsmXmlElement_Osm || parent == OsmXmlElement_Change)
+	{
+		ArenaResetToMark(loader->elementArena, loader->elementArenaMark);
+		//NOTE: For a compressed file we can only tell how far through the compressed data the decoder was when it made the current chunk
+		u64 passBytes = (loader->decoder != nullptr) ? loader->decoder->chunkInputOffset : (u64)loader->chunkOffset + (u64)(loader->hoxml->iterator - loader->hoxml->xml);
+		if (!UpdateOsmXmlLoadProgress(loader->progress, loader->isSegment ? nullptr : loader->map, GetOsmXmlLoaderProgressBytes(loader, passBytes), &loader->numElementsDone))
+		{
+			SetOsmXmlLoaderError(loader, Result_Canceled, Str8_Empty);
+		}
+	}
+}
+
+// Gives hoxml the next OSM_XML_CHUNK_SIZE bytes of the file, returns false when there is nothing left. hoxml copies the names and
+// values it gives back into hoxmlBuffer so nothing needs the old chunk once the next one is handed over. The segments of a threaded
+// load have segmentPrefix handed over before the first chunk and segmentSuffix after the last one. A compressed file is handed over in whatever chunks the decoder makes
+bool NextOsmXmlLoaderChunk(OsmXmlLoader* loader, Str8* chunkInOut)
+{
+	if (loader->decoder != nullptr)
+	{
+		Slice decodedChunk = Slice_Empty;
+		if (!NextStreamDecoderChunk(loader->decoder, &decodedChunk))
+		{
+			if (loader->decoder->error != Result_None) { SetOsmXmlLoaderError(loader, loader->decoder->error, MakeStr8Nt(GetStreamCodecStr(loader->decoder->codec))); }
+			return false;
+		}
+		*chunkInOut = MakeStr8(decodedChunk.length, (char*)decodedChunk.bytes);
+		return true;
+	}
+	if (chunkInOut->chars == nullptr && !IsEmptyStr(loader->segmentPrefix)) { *chunkInOut = loader->segmentPrefix; return true; }
+	if (!IsEmptyStr(loader->segmentSuffix) && chunkInOut->chars == loader->segmentSuffix.chars) { return false; }
+	bool isAfterPrefix = (!IsEmptyStr(loader->segmentPrefix) && chunkInOut->chars == loader->segmentPrefix.chars);
+	uxx nextOffset = isAfterPrefix ? 0 : loader->chunkOffset + chunkInOut->length;
+	if (nextOffset >= loader->xmlFileContents.length)
+	{
+		if (IsEmptyStr(loader->segmentSuffix)) { return false; }
+		*chunkInOut = loader->segmentSuffix;
+		return true;
+	}
+	loader->chunkOffset = nextOffset;
+	uxx chunkSize = loader->xmlFileContents.length - nextOffset;
+	//NOTE: hoxml can only put a character back together when its bytes are split between two chunks, so we never leave a last chunk that's shorter than a character can be
+	if (chunkSize >= OSM_XML_CHUNK_SIZE + sizeof(u32)) { chunkSize = OSM_XML_CHUNK_SIZE; }
+	*chunkInOut = MakeStr8(chunkSize, &loader->xmlFileContents.chars[nextOffset]);
+	if (loader->mappedFile != nullptr) { MappedFileReadahead(loader->mappedFile, nextOffset); }
+	return true;
+}
+
+// Runs hoxml over the whole file once, one chunk at a time, passing each event along to the functions above
+Result DoOsmXmlLoaderPass(OsmXmlLoader* loader)
+{
+	TracyCZoneN(funcZone, "DoOsmXmlLoaderPass", true);
+	hoxml_context_t hoxml;
+	hoxml_init(&hoxml, loader->hoxmlBuffer, (size_t)loader->hoxmlBufferSize);
+	loader->hoxml = &hoxml;
+	loader->depth = 0;
+	loader->numElementsDone = 0;
+	loader->chunkOffset = 0;
+	if (loader->decoder != nullptr && loader->decoder->numTaken > 0) { ResetStreamDecoder(loader->decoder); }
+	Str8 chunk = Str8_Empty;
+	
+	bool foundRoot = false;
+	bool insideProcessingInstruction = false;
+	hoxml_code_t code;
+	if (NextOsmXmlLoaderChunk(loader, &chunk))
+	{
+		do
+		{
+			code = hoxml_parse(&hoxml, chunk.chars, (size_t)chunk.length);
+			switch (code)
+			{
+				case HOXML_ELEMENT_BEGIN: BeginOsmXmlElement(loader, MakeStr8Nt(hoxml.tag)); foundRoot = true; break;
+				case HOXML_ELEMENT_END: EndOsmXmlElement(loader); break;
+				case HOXML_ATTRIBUTE: if (!insideProcessingInstruction) { HandleOsmXmlAttribute(loader, MakeStr8Nt(hoxml.attribute), MakeStr8Nt(hoxml.value)); } break;
+				case HOXML_PROCESSING_INSTRUCTION_BEGIN: insideProcessingInstruction = true; break;
+				case HOXML_PROCESSING_INSTRUCTION_END: insideProcessingInstruction = false; break;
+				case HOXML_END_OF_DOCUMENT: /* Do nothing */ break;
+				case HOXML_ERROR_UNEXPECTED_EOF:
 				{
-					InitVarArrayWithInitial(v2d, &newMember->locations, arena, 1);
-					VarArrayAddValue(v2d, &newMember->locations, MakeV2d(longitude, latitude));
-				}
-				else if (newMember->type == OsmRelationMemberType_Way)
+					if (!NextOsmXmlLoaderChunk(loader, &chunk)) { SetOsmXmlLoaderError(loader, GetResultForHoxmlCode(code), MakeStr8Nt(GetHoxmlCodeStr(code))); }
+				} break;
+				//NOTE: hoxml keeps the content of every open element, which for <osm> is all the whitespace between its children,
+				//      so the buffer still grows by a few bytes per element. Everything else in it only lives as long as one element
+				case HOXML_ERROR_INSUFFICIENT_MEMORY:
 				{
-					uxx numNodeLocations = 0;
-					VarArrayLoop(&xmlMember->children, cIndex)
-					{
-						VarArrayLoopGet(XmlElement, xmlChild, &xmlMember->children, cIndex);
-						if (StrExactEquals(xmlChild->type, StrLit("nd"))) { numNodeLocations++; }
-					}
-					
-					InitVarArrayWithInitial(v2d, &newMember->locations, arena, numNodeLocations);
-					XmlElement* xmlNodeLocation = nullptr;
-					while ((xmlNodeLocation = XmlGetNextChild(&xml, xmlMember, StrLit("nd"), xmlNodeLocation)) != nullptr)
-					{
-						r64 nodeLatitude = XmlGetAttributeR64OrBreak(&xml, xmlNodeLocation, StrLit("lat"));
-						r64 nodeLongitude = XmlGetAttributeR64OrBreak(&xml, xmlNodeLocation, StrLit("lon"));
-						VarArrayAddValue(v2d, &newMember->locations, MakeV2d(nodeLongitude, nodeLatitude));
-					}
-					if (xml.error != Result_None) { break; }
-				}
+					uxx newBufferSize = loader->hoxmlBufferSize * 2;
+					char* newBuffer = (char*)AllocMem(loader->scratch, newBufferSize);
+					NotNull(newBuffer);
+					hoxml_realloc(&hoxml, newBuffer, (size_t)newBufferSize);
+					loader->hoxmlBuffer = newBuffer;
+					loader->hoxmlBufferSize = newBufferSize;
+				} break;
+				default:
+				{
+					Result hoxmlResult = GetResultForHoxmlCode(code);
+					if (hoxmlResult != Result_None) { SetOsmXmlLoaderError(loader, hoxmlResult, MakeStr8Nt(GetHoxmlCodeStr(code))); }
+					else { PrintLine_W("Unhandled HOXML code: \"%s\"", GetHoxmlCodeStr(code)); }
+				} break;
 			}
-			if (xml.error != Result_None) { break; }
-			
-			XmlElement* xmlTag = nullptr;
-			while ((xmlTag = XmlGetNextChild(&xml, xmlRelation, StrLit("tag"), xmlTag)) != nullptr)
+		} while (code != HOXML_END_OF_DOCUMENT && loader->error == Result_None);
+	}
+	
+	if (loader->error == Result_None)
+	{
+		if (!foundRoot) { SetOsmXmlLoaderError(loader, Result_EmptyFile, Str8_Empty); }
+		else if (loader->depth > 0) { SetOsmXmlLoaderError(loader, Result_MissingEndElement, Str8_Empty); }
+	}
+	loader->hoxml = nullptr;
+	TracyCZoneEnd(funcZone);
+	return (loader->error == Result_None) ? Result_Success : loader->error;
+}
+
+// Sets up a loader for the whole file (or one segment of it) with the settings from options. The buffers that get reused for every
+// element go in scratch. The map should have just been initialized, the Finish functions clear the sorted flags as things come in out of order
+void InitOsmXmlLoader(OsmXmlLoader* loader, Arena* arena, Arena* scratch, Arena* elementArena, OsmMap* map, Str8 xmlFileContents, const OsmLoadOptions* options)
+{
+	ClearPointer(loader);
+	loader->arena = arena;
+	loader->scratch = scratch;
+	loader->elementArena = elementArena;
+	loader->elementArenaMark = ArenaGetMark(elementArena);
+	loader->map = map;
+	loader->tagFilter = (options != nullptr) ? options->tagFilter : nullptr;
+	loader->tagFilterNodes = (options != nullptr) ? options->tagFilterNodes : OsmTagFilterNodes_All;
+	loader->keepOnlyWayNodes = (loader->tagFilter != nullptr && loader->tagFilterNodes == OsmTagFilterNodes_WayNodes);
+	loader->progress = (options != nullptr) ? options->progress : nullptr;
+	loader->fileSize = xmlFileContents.length;
+	loader->xmlFileContents = xmlFileContents;
+	loader->hoxmlBufferSize = OSM_XML_HOXML_BUFFER_SIZE;
+	loader->hoxmlBuffer = (char*)AllocMem(scratch, loader->hoxmlBufferSize);
+	NotNull(loader->hoxmlBuffer);
+	InitVarArray(OsmTag, &loader->tags, scratch);
+	InitVarArray(u64, &loader->nodeIds, scratch);
+	InitVarArray(OsmXmlMember, &loader->members, scratch);
+	InitVarArray(v2d, &loader->memberLocations, scratch);
+	map->areNodesSorted = true;
+	map->areWaysSorted = true;
+	map->areRelationsSorted = false; //TODO: Change me!
+}
+
+// +--------------------------------------------------------------+
+// |                   Threaded .osm XML Loader                   |
+// +--------------------------------------------------------------+
+//NOTE: When TryParseOsmMap is given a workerPool the file is cut into segments of about OSM_XML_SEGMENT_SIZE, each one starting at a top-level
+//      <node>, <way> or <relation>. Each worker parses whole segments with its own hoxml context into a staged OsmMap in its scratch arena
+//      (the segment is wrapped in a made up <osm> element so hoxml sees a complete document) and then waits for its turn to append that to
+//      the real map. Segments are merged strictly in file order so the result is the same as loading the file on one thread.
+//      We can't know for sure where a top-level element starts without parsing everything before it, a "<node" inside a comment or CDATA
+//      section looks just the same. A bad split always leaves the segment before it with something unclosed though, so it fails to parse
+//      and TryParseOsmMap starts over on the calling thread
+
+typedef plex OsmXmlPipeline OsmXmlPipeline;
+plex OsmXmlPipeline
+{
+	OsmXmlLoader* loader; //the loader TryParseOsmMap set up, the segments copy its settings and get merged into its map
+	MappedFile* mappedFile;
+	uxx numSegments;
+	uxx* segmentOffsets; //numSegments+1 long, the last one is the length of the file
+	
+	ThreadMutex claimMutex;
+	uxx nextClaimSegmentIndex;
+	bool isClaimFinished;
+	
+	ThreadMutex mergeMutex; //also protects the loader and its map
+	ThreadCondVar mergeTurnChanged;
+	uxx nextMergeSegmentIndex;
+	u64 mergedBytes;
+	Result result; //Result_None until a segment fails or the load is canceled
+};
+
+// Finds the first <node, <way or <relation at or after startIndex, returns xml.length if there isn't one
+uxx FindOsmXmlPrimitiveStart(Str8 xml, uxx startIndex)
+{
+	for (uxx cIndex = startIndex; cIndex < xml.length; cIndex++)
+	{
+		if (xml.chars[cIndex] != '<') { continue; }
+		Str8 rest = MakeStr8(xml.length - (cIndex+1), &xml.chars[cIndex+1]);
+		if (rest.length > 4 && MyMemEquals(rest.chars, "node", 4) && IsOsmXmlNameEnd(rest.chars[4])) { return cIndex; }
+		if (rest.length > 3 && MyMemEquals(rest.chars, "way", 3) && IsOsmXmlNameEnd(rest.chars[3])) { return cIndex; }
+		if (rest.length > 8 && MyMemEquals(rest.chars, "relation", 8) && IsOsmXmlNameEnd(rest.chars[8])) { return cIndex; }
+	}
+	return xml.length;
+}
+
+void MergeOsmXmlSegmentStrings(Arena* arena, Str8 segmentStr, Str8* strOut)
+{
+	if (!IsEmptyStr(segmentStr)) { *strOut = AllocStr8(arena, segmentStr); }
+}
+
+// Appends everything the segment staged to the real map the same way FinishOsmXmlNode\Way\Relation would have if they had been adding to it directly.
+// Called with mergeMutex locked, in file order. Returns false (with pipeline->result set) when the load should stop
+bool MergeOsmXmlSegment(OsmXmlPipeline* pipeline, OsmXmlLoader* segmentLoader)
+{
+	TracyCZoneN(funcZone, "MergeOsmXmlSegment", true);
+	OsmXmlLoader* loader = pipeline->loader;
+	OsmMap* map = loader->map;
+	OsmMap* segmentMap = segmentLoader->map;
+	
+	if (segmentLoader->foundBounds)
+	{
+		if (loader->foundBounds) { pipeline->result = Result_Duplicate; TracyCZoneEnd(funcZone); return false; }
+		map->bounds = segmentMap->bounds;
+		loader->foundBounds = true;
+	}
+	MergeOsmXmlSegmentStrings(loader->arena, segmentMap->versionStr, &map->versionStr);
+	MergeOsmXmlSegmentStrings(loader->arena, segmentMap->generatorStr, &map->generatorStr);
+	MergeOsmXmlSegmentStrings(loader->arena, segmentMap->copyrightStr, &map->copyrightStr);
+	MergeOsmXmlSegmentStrings(loader->arena, segmentMap->attributionStr, &map->attributionStr);
+	MergeOsmXmlSegmentStrings(loader->arena, segmentMap->licenseStr, &map->licenseStr);
+	
+	if (loader->onlyCollectWayNodes)
+	{
+		VarArrayExpand(&loader->wayNodeRefs, loader->wayNodeRefs.length + segmentLoader->wayNodeRefs.length);
+		VarArrayLoop(&segmentLoader->wayNodeRefs, eIndex) { VarArrayLoopGetValue(OsmNodeRefEntry, entry, &segmentLoader->wayNodeRefs, eIndex); VarArrayAddValue(OsmNodeRefEntry, &loader->wayNodeRefs, entry); }
+	}
+	
+	ExpandOsmNodes(map, map->nodes.length + segmentMap->nodes.length);
+	VarArrayExpand(&map->tags, map->tags.length + segmentMap->tags.length);
+	VarArrayLoop(&segmentMap->nodes, nIndex)
+	{
+		VarArrayLoopGet(OsmNode, segmentNode, &segmentMap->nodes, nIndex);
+		VarArrayLoopGet(OsmNodeInfo, segmentInfo, &segmentMap->nodeInfos, nIndex);
+		OsmNode* lastNode = VarArrayGetLastSoft(OsmNode, &map->nodes);
+		if (lastNode != nullptr && segmentNode->id <= lastNode->id) { map->areNodesSorted = false; }
+		OsmNode* newNode = AddOsmNode(map, ToV2dFromOsmLocation(*VarArrayGet(OsmLocation, &segmentMap->nodeLocations, nIndex)), segmentNode->id);
+		NotNull(newNode);
+		OsmNodeInfo* newInfo = GetOsmNodeInfo(map, newNode);
+		newInfo->visible = segmentInfo->visible;
+		newInfo->version = segmentInfo->version;
+		newInfo->changeset = segmentInfo->changeset;
+		newInfo->timestampStr = (!IsEmptyStr(segmentInfo->timestampStr) ? AllocStr8(loader->arena, segmentInfo->timestampStr) : Str8_Empty);
+		newInfo->user = (!IsEmptyStr(segmentInfo->user) ? AllocStr8(loader->arena, segmentInfo->user) : Str8_Empty);
+		newInfo->uid = segmentInfo->uid;
+		AddOsmXmlTags(map, segmentNode->tags.count, GetOsmTags(segmentMap, segmentNode->tags), &newNode->tags);
+	}
+	
+	if (segmentMap->ways.length > 0)
+	{
+		ScratchBegin1(scratch, loader->arena);
+		VarArray nodeIds; //u64
+		InitVarArray(u64, &nodeIds, scratch);
+		VarArrayExpand(&map->ways, map->ways.length + segmentMap->ways.length);
+		VarArrayLoop(&segmentMap->ways, wIndex)
+		{
+			VarArrayLoopGet(OsmWay, segmentWay, &segmentMap->ways, wIndex);
+			OsmWay* lastWay = VarArrayGetLastSoft(OsmWay, &map->ways);
+			if (lastWay != nullptr && segmentWay->id <= lastWay->id) { map->areWaysSorted = false; }
+			VarArrayClear(&nodeIds);
+			VarArrayExpand(&nodeIds, segmentWay->nodes.length);
+			VarArrayLoop(&segmentWay->nodes, nIndex) { VarArrayAddValue(u64, &nodeIds, VarArrayGet(OsmNodeRef, &segmentWay->nodes, nIndex)->id); }
+			OsmWay* newWay = AddOsmWayUnresolved(map, segmentWay->id, nodeIds.length, (u64*)nodeIds.items);
+			NotNull(newWay);
+			newWay->visible = segmentWay->visible;
+			newWay->version = segmentWay->version;
+			newWay->changeset = segmentWay->changeset;
+			newWay->timestampStr = (!IsEmptyStr(segmentWay->timestampStr) ? AllocStr8(loader->arena, segmentWay->timestampStr) : Str8_Empty);
+			newWay->user = (!IsEmptyStr(segmentWay->user) ? AllocStr8(loader->arena, segmentWay->user) : Str8_Empty);
+			newWay->uid = segmentWay->uid;
+			AddOsmXmlTags(map, segmentWay->tags.count, GetOsmTags(segmentMap, segmentWay->tags), &newWay->tags);
+		}
+		ScratchEnd(scratch);
+	}
+	
+	VarArrayExpand(&map->relations, map->relations.length + segmentMap->relations.length);
+	VarArrayLoop(&segmentMap->relations, rIndex)
+	{
+		VarArrayLoopGet(OsmRelation, segmentRelation, &segmentMap->relations, rIndex);
+		OsmRelation* newRelation = AddOsmRelation(map, segmentRelation->id, segmentRelation->members.length);
+		NotNull(newRelation);
+		newRelation->bounds = segmentRelation->bounds;
+		newRelation->visible = segmentRelation->visible;
+		newRelation->version = segmentRelation->version;
+		newRelation->changeset = segmentRelation->changeset;
+		newRelation->timestampStr = (!IsEmptyStr(segmentRelation->timestampStr) ? AllocStr8(loader->arena, segmentRelation->timestampStr) : Str8_Empty);
+		newRelation->user = (!IsEmptyStr(segmentRelation->user) ? AllocStr8(loader->arena, segmentRelation->user) : Str8_Empty);
+		newRelation->uid = segmentRelation->uid;
+		VarArrayLoop(&segmentRelation->members, mIndex)
+		{
+			VarArrayLoopGet(OsmRelationMember, segmentMember, &segmentRelation->members, mIndex);
+			OsmRelationMember* newMember = VarArrayAdd(OsmRelationMember, &newRelation->members);
+			NotNull(newMember);
+			ClearPointer(newMember);
+			newMember->id = segmentMember->id;
+			newMember->type = segmentMember->type;
+			newMember->role = segmentMember->role;
+			newMember->index = OSM_INVALID_INDEX;
+			if (segmentMember->type == OsmRelationMemberType_Way || segmentMember->locations.length > 0)
+			{
+				InitVarArrayWithInitial(OsmLocation, &newMember->locations, loader->arena, segmentMember->locations.length);
+				VarArrayLoop(&segmentMember->locations, lIndex) { VarArrayAddValue(OsmLocation, &newMember->locations, *VarArrayGet(OsmLocation, &segmentMember->locations, lIndex)); }
+			}
+		}
+		AddOsmXmlTags(map, segmentRelation->tags.count, GetOsmTags(segmentMap, segmentRelation->tags), &newRelation->tags);
+	}
+	
+	pipeline->mergedBytes += segmentLoader->xmlFileContents.length;
+	if (loader->progress != nullptr)
+	{
+		SetOsmLoadProgressBytes(loader->progress, GetOsmXmlLoaderProgressBytes(loader, pipeline->mergedBytes));
+		PublishOsmLoadPreview(loader->progress, map);
+		if (IsOsmLoadCanceled(loader->progress)) { pipeline->result = Result_Canceled; TracyCZoneEnd(funcZone); return false; }
+	}
+	TracyCZoneEnd(funcZone);
+	return true;
+}
+
+// Each job claims the next segment, parses it into a staged map in its scratch arena and then waits for its turn to merge it.
+// We queue one of these per worker thread so the number of staged segments is bounded by the number of threads
+WORKER_JOB_DEF(OsmXmlPipelineJob)
+{
+	OsmXmlPipeline* pipeline = (OsmXmlPipeline*)contextPntr;
+	OsmXmlLoader* loader = pipeline->loader;
+	ScratchBegin1(scratch, loader->arena);
+	ScratchBegin2(elementScratch, loader->arena, scratch);
+	while (true)
+	{
+		LockThreadMutex(&pipeline->claimMutex);
+		uxx segmentIndex = pipeline->nextClaimSegmentIndex;
+		bool hasSegment = (!pipeline->isClaimFinished && segmentIndex < pipeline->numSegments);
+		if (hasSegment)
+		{
+			pipeline->nextClaimSegmentIndex++;
+			if (pipeline->mappedFile != nullptr) { MappedFileReadahead(pipeline->mappedFile, pipeline->segmentOffsets[segmentIndex]); }
+		}
+		UnlockThreadMutex(&pipeline->claimMutex);
+		if (!hasSegment) { break; }
+		
+		uxx scratchMark = ArenaGetMark(scratch);
+		uxx elementScratchMark = ArenaGetMark(elementScratch);
+		uxx segmentStart = pipeline->segmentOffsets[segmentIndex];
+		Str8 segmentContents = MakeStr8(pipeline->segmentOffsets[segmentIndex+1] - segmentStart, &loader->xmlFileContents.chars[segmentStart]);
+		OsmMap segmentMap = ZEROED;
+		InitOsmMap(scratch, &segmentMap, 0, 0, 0, 0);
+		OsmXmlLoader segmentLoader = ZEROED;
+		InitOsmXmlLoader(&segmentLoader, scratch, scratch, elementScratch, &segmentMap, segmentContents, nullptr);
+		segmentLoader.tagFilter = loader->tagFilter;
+		segmentLoader.tagFilterNodes = loader->tagFilterNodes;
+		segmentLoader.keepOnlyWayNodes = loader->keepOnlyWayNodes;
+		segmentLoader.onlyCollectWayNodes = loader->onlyCollectWayNodes;
+		segmentLoader.numWayNodeIds = loader->numWayNodeIds;
+		segmentLoader.wayNodeIds = loader->wayNodeIds;
+		segmentLoader.progress = loader->progress;
+		segmentLoader.isSegment = true;
+		segmentLoader.segmentPrefix = (segmentIndex > 0) ? StrLit("<osm>") : Str8_Empty;
+		segmentLoader.segmentSuffix = (segmentIndex+1 < pipeline->numSegments) ? StrLit("</osm>") : Str8_Empty;
+		if (segmentLoader.onlyCollectWayNodes) { InitVarArray(OsmNodeRefEntry, &segmentLoader.wayNodeRefs, scratch); }
+		Result segmentResult = DoOsmXmlLoaderPass(&segmentLoader);
+		
+		LockThreadMutex(&pipeline->mergeMutex);
+		while (pipeline->nextMergeSegmentIndex != segmentIndex && pipeline->result == Result_None) { WaitThreadCondVar(&pipeline->mergeTurnChanged, &pipeline->mergeMutex); }
+		bool shouldContinue = false;
+		if (pipeline->result == Result_None)
+		{
+			if (segmentResult == Result_Success) { shouldContinue = MergeOsmXmlSegment(pipeline, &segmentLoader); }
+			else { pipeline->result = segmentResult; }
+			pipeline->nextMergeSegmentIndex++;
+			if (!shouldContinue)
 			{
-				Str8 keyStr = XmlGetAttributeOrBreak(&xml, xmlTag, StrLit("k"));
-				Str8 valueStr = XmlGetAttributeOrBreak(&xml, xmlTag, StrLit("v"));
-				OsmTag* newTag = VarArrayAdd(OsmTag, &newRelation->tags);
-				NotNull(newTag);
-				ClearPointer(newTag);
-				newTag->key = AllocStr8(arena, keyStr);
-				newTag->value = AllocStr8(arena, valueStr);
+				//NOTE: Lock order is always mergeMutex -> claimMutex
+				LockThreadMutex(&pipeline->claimMutex);
+				pipeline->isClaimFinished = true;
+				UnlockThreadMutex(&pipeline->claimMutex);
 			}
-			if (xml.error != Result_None) { break; }
 		}
-		if (xml.error != Result_None) { break; }
-	} while(false);
+		WakeAllThreadCondVar(&pipeline->mergeTurnChanged);
+		UnlockThreadMutex(&pipeline->mergeMutex);
+		
+		ArenaResetToMark(elementScratch, elementScratchMark);
+		ArenaResetToMark(scratch, scratchMark);
+		if (!shouldContinue) { break; }
+	}
+	ScratchEnd(elementScratch);
+	ScratchEnd(scratch);
+}
+
+// Does the same thing as DoOsmXmlLoaderPass but with the file split into segments that are parsed on the workerPool's threads
+Result RunOsmXmlPipelinePass(OsmXmlLoader* loader, WorkerPool* workerPool)
+{
+	TracyCZoneN(funcZone, "RunOsmXmlPipelinePass", true);
+	NotNull(workerPool);
+	Str8 xmlFileContents = loader->xmlFileContents;
+	
+	//NOTE: This stays in loader->scratch until TryParseOsmMap is done, a ScratchBegin here would hand out the same arena that the merge grows wayNodeRefs in
+	VarArray segmentOffsets; //uxx
+	InitVarArray(uxx, &segmentOffsets, loader->scratch);
+	VarArrayAddValue(uxx, &segmentOffsets, 0);
+	uxx searchIndex = OSM_XML_SEGMENT_SIZE;
+	while (searchIndex < xmlFileContents.length)
+	{
+		uxx segmentStart = FindOsmXmlPrimitiveStart(xmlFileContents, searchIndex);
+		if (segmentStart >= xmlFileContents.length) { break; }
+		VarArrayAddValue(uxx, &segmentOffsets, segmentStart);
+		searchIndex = segmentStart + OSM_XML_SEGMENT_SIZE;
+	}
+	VarArrayAddValue(uxx, &segmentOffsets, xmlFileContents.length);
+	
+	OsmXmlPipeline pipeline = ZEROED;
+	pipeline.loader = loader;
+	pipeline.mappedFile = loader->mappedFile;
+	pipeline.numSegments = segmentOffsets.length-1;
+	pipeline.segmentOffsets = (uxx*)segmentOffsets.items;
+	pipeline.result = Result_None;
+	InitThreadMutex(&pipeline.claimMutex);
+	InitThreadMutex(&pipeline.mergeMutex);
+	InitThreadCondVar(&pipeline.mergeTurnChanged);
+	WorkerWaitGroup waitGroup = ZEROED;
+	InitWorkerWaitGroup(workerPool, &waitGroup);
+	for (uxx tIndex = 0; tIndex < workerPool->numThreads; tIndex++) { WorkerPoolQueueJob(&waitGroup, OsmXmlPipelineJob, &pipeline); }
+	WaitForWorkerWaitGroup(&waitGroup);
+	FreeThreadCondVar(&pipeline.mergeTurnChanged);
+	FreeThreadMutex(&pipeline.mergeMutex);
+	FreeThreadMutex(&pipeline.claimMutex);
 	
-	if (xml.error == Result_None)
+	TracyCZoneValue(funcZone, pipeline.numSegments);
+	TracyCZoneEnd(funcZone);
+	return (pipeline.result == Result_None) ? Result_Success : pipeline.result;
+}
+
+// +--------------------------------------------------------------+
+// |                        TryParseOsmMap                        |
+// +--------------------------------------------------------------+
+// Runs every pass the load needs, on the workerPool's threads when it's not nullptr
+Result DoOsmXmlLoad(OsmXmlLoader* loader, WorkerPool* workerPool)
+{
+	Result result = Result_Success;
+	// +==============================+
+	// |      Find Kept Way Nodes     |
+	// +==============================+
+	//NOTE: The nodes come before the ways in the file so we have to go through the file once just to find out which nodes the kept ways need
+	if (loader->keepOnlyWayNodes)
+	{
+		InitVarArray(OsmNodeRefEntry, &loader->wayNodeRefs, loader->scratch);
+		loader->onlyCollectWayNodes = true;
+		result = (workerPool != nullptr) ? RunOsmXmlPipelinePass(loader, workerPool) : DoOsmXmlLoaderPass(loader);
+		loader->onlyCollectWayNodes = false;
+		if (result == Result_Success) { loader->wayNodeIds = MakeSortedOsmIdSet(loader->scratch, loader->wayNodeRefs.length, (OsmNodeRefEntry*)loader->wayNodeRefs.items, &loader->numWayNodeIds); }
+	}
+	
+	if (result == Result_Success) { result = (workerPool != nullptr) ? RunOsmXmlPipelinePass(loader, workerPool) : DoOsmXmlLoaderPass(loader); }
+	return result;
+}
+
+// Fills in the bounds of an .osc file, which doesn't have a <bounds> element, from its nodes
+void SetOsmXmlBoundsFromNodes(OsmMap* map)
+{
+	if (map->nodes.length == 0) { map->bounds = Recd_Zero; return; }
+	v2d minLocation = MakeV2d(INFINITY, INFINITY);
+	v2d maxLocation = MakeV2d(-INFINITY, -INFINITY);
+	VarArrayLoop(&map->nodeLocations, nIndex)
+	{
+		v2d location = ToV2dFromOsmLocation(*VarArrayGet(OsmLocation, &map->nodeLocations, nIndex));
+		minLocation.lon = MinR64(minLocation.lon, location.lon);
+		minLocation.lat = MinR64(minLocation.lat, location.lat);
+		maxLocation.lon = MaxR64(maxLocation.lon, location.lon);
+		maxLocation.lat = MaxR64(maxLocation.lat, location.lat);
+	}
+	map->bounds = NewRecdBetween(minLocation.lon, minLocation.lat, maxLocation.lon, maxLocation.lat);
+}
+
+// When decoder is not nullptr the XML comes out of it instead and xmlFileContents is the compressed file (only its size is used, for progress)
+Result TryParseOsmMapFromSource(Arena* arena, Str8 xmlFileContents, MappedFile* mappedFile, StreamDecoder* decoder, const OsmLoadOptions* options, OsmMap* mapOut)
+{
+	TracyCZoneN(funcZone, "TryParseOsmMap", true);
+	NotNullStr(xmlFileContents);
+	NotNull(arena);
+	NotNull(mapOut);
+	ScratchBegin1(scratch, arena);
+	ScratchBegin2(elementScratch, arena, scratch);
+	
+	//NOTE: Files that would only make one or two segments aren't worth starting the pipeline for. A compressed file can't be split
+	//      before it's decoded, the decoder gets the workerPool instead and decodes the next chunks while we parse
+	WorkerPool* workerPool = (options != nullptr) ? options->workerPool : nullptr;
+	if (workerPool != nullptr && (decoder != nullptr || workerPool->numThreads == 0 || xmlFileContents.length < OSM_XML_SEGMENT_SIZE*2)) { workerPool = nullptr; }
+	
+	//NOTE: With a tag filter most of the elements are thrown away, so the counts would just waste memory
+	uxx numNodesExpected = 0;
+	uxx numWaysExpected = 0;
+	uxx numRelationsExpected = 0;
+	uxx numTagsExpected = 0;
+	if (decoder == nullptr && (options == nullptr || options->tagFilter == nullptr)) { CountOsmXmlPrimitives(xmlFileContents, &numNodesExpected, &numWaysExpected, &numRelationsExpected, &numTagsExpected); }
+	InitOsmMap(arena, mapOut, numNodesExpected, numWaysExpected, numRelationsExpected, numTagsExpected);
+	
+	OsmXmlLoader loader = ZEROED;
+	InitOsmXmlLoader(&loader, arena, scratch, elementScratch, mapOut, xmlFileContents, options);
+	loader.mappedFile = (decoder == nullptr) ? mappedFile : nullptr;
+	loader.decoder = decoder;
+	SetOsmLoadProgressTotal(loader.progress, xmlFileContents.length, 0);
+	
+	Result result = DoOsmXmlLoad(&loader, workerPool);
+	if (workerPool != nullptr && result != Result_Success && result != Result_Canceled)
+	{
+		//NOTE: See the NOTE above OsmXmlPipeline. A split in the wrong place looks just like a broken file so we go again on this thread,
+		//      which also gets us an error with a proper line number if the file really is broken
+		PrintLine_D("Threaded .osm parse failed (%s), parsing again on one thread", GetResultStr(result));
+		FreeOsmMap(mapOut);
+		InitOsmMap(arena, mapOut, numNodesExpected, numWaysExpected, numRelationsExpected, numTagsExpected);
+		InitOsmXmlLoader(&loader, arena, scratch, elementScratch, mapOut, xmlFileContents, options);
+		loader.mappedFile = mappedFile;
+		result = DoOsmXmlLoad(&loader, nullptr);
+	}
+	if (result == Result_Success && !loader.foundBounds)
 	{
+		if (loader.isOsmChange) { SetOsmXmlBoundsFromNodes(mapOut); }
+		else { SetOsmXmlLoaderError(&loader, Result_ElementNotFound, StrLit("bounds")); result = loader.error; }
+	}
+	
+	if (result == Result_Success)
+	{
+		PublishOsmLoadPreview(loader.progress, mapOut);
+		SortOsmWays(mapOut);
+		ResolveOsmNodeRefs(mapOut);
 		VarArrayLoop(&mapOut->relations, rIndex)
 		{
 			VarArrayLoopGet(OsmRelation, relation, &mapOut->relations, rIndex);
-			UpdateOsmRelationPntrs(mapOut, relation);
+			ResolveOsmRelationMembers(mapOut, relation, false);
 		}
-		UpdateOsmNodeWayBackPntrs(mapOut);
-		UpdateOsmRelationBackPntrs(mapOut);
+		UpdateOsmNodeWayIndices(mapOut);
+		UpdateOsmRelationBackIndices(mapOut);
 	}
 	else
 	{
-		NotNull(xml.errorElement);
-		NotifyPrint_E("XML Parsing Error: %s \"%.*s\" on \"%.*s\" element", GetResultStr(xml.error), StrPrint(xml.errorStr), StrPrint(xml.errorElement->type));
+		if (result == Result_Canceled) { PrintLine_I("Load was canceled"); }
+		else { NotifyPrint_E("XML Parsing Error: %s \"%.*s\" on \"%s\" element (line %u)", GetResultStr(result), StrPrint(loader.errorStr), GetOsmXmlElementStr(loader.errorElement), loader.errorLine); }
 		FreeOsmMap(mapOut);
 	}
 	
+	ScratchEnd(elementScratch);
 	ScratchEnd(scratch);
 	TracyCZoneEnd(funcZone);
-	return (xml.error == Result_None) ? Result_Success : xml.error;
+	return result;
+}
+
+// Pass nullptr for options to load everything. Only the workerPool, tag filter and progress options apply to .osm files.
+// The file is handed to hoxml in OSM_XML_CHUNK_SIZE pieces so besides xmlFileContents we only need the map and a small hoxml buffer
+Result TryParseOsmMap(Arena* arena, Str8 xmlFileContents, const OsmLoadOptions* options, OsmMap* mapOut)
+{
+	return TryParseOsmMapFromSource(arena, xmlFileContents, nullptr, nullptr, options, mapOut);
+}
+
+// Same as TryParseOsmMap but the XML is read in place from the mapped file, so the text of the file never has to be held in memory.
+// The mappedFile must stay open until this returns, nothing in the resulting map points into it
+Result TryParseOsmMappedFile(Arena* arena, MappedFile* mappedFile, const OsmLoadOptions* options, OsmMap* mapOut)
+{
+	NotNull(mappedFile);
+	NotNull(mappedFile->bytes);
+	return TryParseOsmMapFromSource(arena, MakeStr8(mappedFile->size, (char*)mappedFile->bytes), mappedFile, nullptr, options, mapOut);
+}
+
+// Same as TryParseOsmMap but for a gzip or bzip2 compressed .osm (or .osc) file, which is decompressed a chunk at a time as it's parsed so the
+// decompressed XML never has to be in memory all at once. When options has a workerPool one of its threads does the decompressing.
+// mappedFile is optional, when compressedData is in one the decoder hints the OS to read ahead of it
+Result TryParseOsmCompressedMap(Arena* arena, Slice compressedData, StreamCodec codec, MappedFile* mappedFile, const OsmLoadOptions* options, OsmMap* mapOut)
+{
+	NotNull(arena);
+	NotNullStr(compressedData);
+	ScratchBegin1(scratch, arena);
+	StreamDecoder decoder = ZEROED;
+	InitStreamDecoder(scratch, codec, compressedData, mappedFile, (options != nullptr) ? options->workerPool : nullptr, &decoder);
+	Result result = TryParseOsmMapFromSource(arena, MakeStr8(compressedData.length, (char*)compressedData.bytes), mappedFile, &decoder, options, mapOut);
+	FreeStreamDecoder(&decoder);
+	ScratchEnd(scratch);
+	return result;
 }
 
 Str8 SerializeOsmMap(Arena* arena, OsmMap* map)
@@ -359,34 +1207,37 @@ Str8 SerializeOsmMap(Arena* arena, OsmMap* map)
 		
 		v2d boundsMin = MakeV2d(MinR64(map->bounds.lon, map->bounds.lon + map->bounds.sizeLon), MinR64(map->bounds.lat, map->bounds.lat + map->bounds.sizeLat));
 		v2d boundsMax = MakeV2d(MaxR64(map->bounds.lon, map->bounds.lon + map->bounds.sizeLon), MaxR64(map->bounds.lat, map->bounds.lat + map->bounds.sizeLat));
-		TwoPassPrint(&result, "\t<bounds minlat=\"%lf\" minlon=\"%lf\" maxlat=\"%lf\" maxlon=\"%lf\"/>\n", boundsMin.lat, boundsMin.lon, boundsMax.lat, boundsMax.lon);
+		TwoPassPrint(&result, "\t<bounds minlat=\"%.7lf\" minlon=\"%.7lf\" maxlat=\"%.7lf\" maxlon=\"%.7lf\"/>\n", boundsMin.lat, boundsMin.lon, boundsMax.lat, boundsMax.lon);
 		
 		VarArrayLoop(&map->nodes, nIndex)
 		{
 			VarArrayLoopGet(OsmNode, node, &map->nodes, nIndex);
+			VarArrayLoopGet(OsmNodeInfo, info, &map->nodeInfos, nIndex);
+			v2d location = ToV2dFromOsmLocation(*VarArrayGet(OsmLocation, &map->nodeLocations, nIndex));
 			uxx scratchMark = ArenaGetMark(scratch);
-			TwoPassPrint(&result, "\t<node id=\"%llu\" visible=\"%s\"", node->id, node->visible ? "true" : "false");
-			if (node->version != 0) { TwoPassPrint(&result, " version=\"%d\"", node->version); }
-			if (node->changeset != 0) { TwoPassPrint(&result, " changeset=\"%llu\"", node->changeset); }
-			if (!IsEmptyStr(node->timestampStr))
+			TwoPassPrint(&result, "\t<node id=\"%llu\" visible=\"%s\"", node->id, info->visible ? "true" : "false");
+			if (info->version != 0) { TwoPassPrint(&result, " version=\"%d\"", info->version); }
+			if (info->changeset != 0) { TwoPassPrint(&result, " changeset=\"%llu\"", info->changeset); }
+			if (!IsEmptyStr(info->timestampStr))
 			{
-				Str8 escapedTimestampStr = EscapeXmlString(scratch, node->timestampStr, false);
+				Str8 escapedTimestampStr = EscapeXmlString(scratch, info->timestampStr, false);
 				TwoPassPrint(&result, " timestamp=\"%.*s\"", StrPrint(escapedTimestampStr));
 			}
-			if (!IsEmptyStr(node->user))
+			if (!IsEmptyStr(info->user))
 			{
-				Str8 escapedUser = EscapeXmlString(scratch, node->user, false);
+				Str8 escapedUser = EscapeXmlString(scratch, info->user, false);
 				TwoPassPrint(&result, " user=\"%.*s\"", StrPrint(escapedUser));
 			}
-			if (node->uid != 0) { TwoPassPrint(&result, " uid=\"%llu\"", node->uid); }
-			TwoPassPrint(&result, " lat=\"%lf\" lon=\"%lf\"", node->location.lat, node->location.lon);
+			if (info->uid != 0) { TwoPassPrint(&result, " uid=\"%llu\"", info->uid); }
+			TwoPassPrint(&result, " lat=\"%.7lf\" lon=\"%.7lf\"", location.lat, location.lon);
 			
-			if (node->tags.length > 0)
+			if (node->tags.count > 0)
 			{
 				TwoPassStrNt(&result, ">\n");
-				VarArrayLoop(&node->tags, tIndex)
+				const OsmTag* nodeTags = GetOsmTags(map, node->tags);
+				for (u32 tIndex = 0; tIndex < node->tags.count; tIndex++)
 				{
-					VarArrayLoopGet(OsmTag, tag, &node->tags, tIndex);
+					const OsmTag* tag = &nodeTags[tIndex];
 					Str8 escapedKey = EscapeXmlString(scratch, tag->key, false);
 					Str8 escapedValue = EscapeXmlString(scratch, tag->value, false);
 					TwoPassPrint(&result, "\t\t<tag k=\"%.*s\" v=\"%.*s\"/>\n", StrPrint(escapedKey), StrPrint(escapedValue));
@@ -417,7 +1268,7 @@ Str8 SerializeOsmMap(Arena* arena, OsmMap* map)
 			}
 			if (way->uid != 0) { TwoPassPrint(&result, " uid=\"%llu\"", way->uid); }
 			
-			if (way->nodes.length > 0 || way->tags.length > 0)
+			if (way->nodes.length > 0 || way->tags.count > 0)
 			{
 				TwoPassStrNt(&result, ">\n");
 				VarArrayLoop(&way->nodes, nIndex)
@@ -425,9 +1276,10 @@ Str8 SerializeOsmMap(Arena* arena, OsmMap* map)
 					VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
 					TwoPassPrint(&result, "\t\t<nd ref=\"%llu\"/>\n", nodeRef->id);
 				}
-				VarArrayLoop(&way->tags, tIndex)
+				const OsmTag* wayTags = GetOsmTags(map, way->tags);
+				for (u32 tIndex = 0; tIndex < way->tags.count; tIndex++)
 				{
-					VarArrayLoopGet(OsmTag, tag, &way->tags, tIndex);
+					const OsmTag* tag = &wayTags[tIndex];
 					Str8 escapedKey = EscapeXmlString(scratch, tag->key, false);
 					Str8 escapedValue = EscapeXmlString(scratch, tag->value, false);
 					TwoPassPrint(&result, "\t\t<tag k=\"%.*s\" v=\"%.*s\"/>\n", StrPrint(escapedKey), StrPrint(escapedValue));
@@ -457,7 +1309,7 @@ Str8 SerializeOsmMap(Arena* arena, OsmMap* map)
 			}
 			if (relation->uid != 0) { TwoPassPrint(&result, " uid=\"%llu\"", relation->uid); }
 			
-			if (relation->members.length > 0 || relation->tags.length > 0)
+			if (relation->members.length > 0 || relation->tags.count > 0)
 			{
 				TwoPassStrNt(&result, ">\n");
 				VarArrayLoop(&relation->members, mIndex)
@@ -466,9 +1318,10 @@ Str8 SerializeOsmMap(Arena* arena, OsmMap* map)
 					TwoPassPrint(&result, "\t\t<member type=\"%s\" ref=\"%llu\" role=\"%s\"/>\n", GetOsmRelationMemberTypeXmlStr(member->type), member->id, GetOsmRelationMemberRoleXmlStr(member->role));
 					//TODO: Check if location information is present, either attach as attributes for single location (for node) or as children (for ways)
 				}
-				VarArrayLoop(&relation->tags, tIndex)
+				const OsmTag* relationTags = GetOsmTags(map, relation->tags);
+				for (u32 tIndex = 0; tIndex < relation->tags.count; tIndex++)
 				{
-					VarArrayLoopGet(OsmTag, tag, &relation->tags, tIndex);
+					const OsmTag* tag = &relationTags[tIndex];
 					Str8 escapedKey = EscapeXmlString(scratch, tag->key, false);
 					Str8 escapedValue = EscapeXmlString(scratch, tag->value, false);
 					TwoPassPrint(&result, "\t\t<tag k=\"%.*s\" v=\"%.*s\"/>\n", StrPrint(escapedKey), StrPrint(escapedValue));
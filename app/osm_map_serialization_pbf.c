@@ -3,7 +3,9 @@ File:   osm_map_serialization_pbf.c
 Author: Taylor Robbins
 Date:   09\11\2025
 Description: 
-	** Holds TryParsePbfMap and (eventually) SerializePbfMap which handle the Protobuf-based .pbf file format
+	** Holds TryParsePbfMap and SerializePbfMap which handle the Protobuf-based .pbf file format
+	** PrimitiveBlocks are normally decoded by walking the wire format directly (see pbf_wire_format.c)
+	** with the generated osm_pbf.pb-c.c code kept around as a reference and fallback
 */
 
 // +--------------------------------------------------------------+
@@ -28,563 +30,3016 @@ char GetPbfBlobTypeChar(u8 blobType)
 	: Str8_Empty                                                                                   \
 )
 
-Result TryParsePbfMap(Arena* arena, DataStream* protobufStream, OsmMap* mapOut)
+typedef plex PbfBlobHeaderInfo PbfBlobHeaderInfo;
+plex PbfBlobHeaderInfo
 {
-	TracyCZoneN(Zone_Func, "TryParsePbfMap", true);
-	ScratchBegin1(scratch, arena);
-	ProtobufCAllocator scratchAllocator = ProtobufAllocatorFromArena(scratch);
-	Result result = Result_None;
-	uxx blobIndex = 0;
-	bool foundOsmHeader = false;
-	bool foundOsmData = false;
-	bool foundUnkownBlobTypes = false;
+	Str8 type; //points into the header bytes
+	Slice indexData;
+	i32 dataSize;
+};
+
+// BlobHeader and Blob are read with the wire reader rather than osm_pbf.pb-c.c because protobuf-c copies every bytes field it unpacks.
+// This way the compressed data is referenced in place (in the mapped file or the read buffer) and inflating is the only copy we make
+bool TryParsePbfBlobHeaderDirect(Slice headerBytes, PbfBlobHeaderInfo* infoOut)
+{
+	ClearPointer(infoOut);
+	bool foundType = false;
+	bool foundDataSize = false;
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	PbfWireReader reader = MakePbfWireReader(headerBytes);
+	while (PbfWireReadField(&reader, &fieldNumber, &wireType))
+	{
+		if (fieldNumber == 1 && wireType == PbfWireType_LengthDelimited)
+		{
+			Slice typeSlice = PbfWireReadSlice(&reader);
+			infoOut->type = MakeStr8(typeSlice.length, (char*)typeSlice.bytes);
+			foundType = true;
+		}
+		else if (fieldNumber == 2 && wireType == PbfWireType_LengthDelimited) { infoOut->indexData = PbfWireReadSlice(&reader); }
+		else if (fieldNumber == 3 && wireType == PbfWireType_Varint) { infoOut->dataSize = (i32)PbfWireReadVarint(&reader); foundDataSize = true; }
+		else if (fieldNumber <= 3) { return false; }
+		else { PbfWireSkipField(&reader, wireType); }
+	}
+	return (!reader.isError && foundType && foundDataSize);
+}
+
+typedef plex PbfBlobInfo PbfBlobInfo;
+plex PbfBlobInfo
+{
+	i32 rawSize;
+	OSMPBF__Blob__DataCase dataCase;
+	Slice data; //points into the blob bytes
+};
+
+bool TryParsePbfBlobDirect(Slice blobBytes, PbfBlobInfo* infoOut)
+{
+	ClearPointer(infoOut);
+	infoOut->dataCase = OSMPBF__BLOB__DATA__NOT_SET;
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	PbfWireReader reader = MakePbfWireReader(blobBytes);
+	while (PbfWireReadField(&reader, &fieldNumber, &wireType))
+	{
+		if (fieldNumber == 2)
+		{
+			if (wireType != PbfWireType_Varint) { return false; }
+			infoOut->rawSize = (i32)PbfWireReadVarint(&reader);
+		}
+		else if (fieldNumber == 1 || (fieldNumber >= 3 && fieldNumber <= 7))
+		{
+			if (wireType != PbfWireType_LengthDelimited) { return false; }
+			//NOTE: Like any oneof, if more than one of these shows up the last one wins
+			infoOut->dataCase = (OSMPBF__Blob__DataCase)fieldNumber;
+			infoOut->data = PbfWireReadSlice(&reader);
+		}
+		else { PbfWireSkipField(&reader, wireType); }
+	}
+	return !reader.isError;
+}
+
+
+// +--------------------------------------------------------------+
+// |                     Parallel Decode Types                    |
+// +--------------------------------------------------------------+
+// TryParsePbfMap runs every blob through 3 stages: Read (serialized, in file order), Decode (parallel, inflate + protobuf unpack + delta
+// decoding into a "staged" block in the worker's scratch arena) and Merge (serialized, strictly in blob order). Because the Merge
+// stage does all the work that touches the OsmMap in the same order as a single-threaded load would, the resulting map is identical
+// no matter how many threads are used. All messages are deferred until the Merge stage so they also print in the same order.
+typedef plex PbfStagedMessage PbfStagedMessage;
+plex PbfStagedMessage
+{
+	DbgLevel level;
+	bool notify;
+	Str8 text;
+};
+
+typedef plex PbfStringTable PbfStringTable;
+plex PbfStringTable
+{
+	uxx numStrings;
+	Str8* strings; //these point into the decompressed buffer
+};
+
+// Tags are staged as indices into the block's string table so the Merge stage only has to look each unique string up in the map's OsmStringPool once per block
+typedef plex PbfStagedTag PbfStagedTag;
+plex PbfStagedTag
+{
+	u32 keyId;
+	u32 valueId; //0 (the empty string) when the id in the file was out of range
+};
+
+typedef plex PbfStagedNode PbfStagedNode;
+plex PbfStagedNode
+{
+	u64 id;
+	v2d location;
+	bool visible;
+	i32 version;
+	u64 changeset;
+	u64 uid;
+	uxx numTags;
+	PbfStagedTag* tags;
+};
+
+typedef plex PbfStagedWay PbfStagedWay;
+plex PbfStagedWay
+{
+	u64 id;
+	bool visible;
+	i32 version;
+	u64 changeset;
+	u64 uid;
+	uxx numNodes;
+	u64* nodeIds;
+	v2d* locations; //numNodes long when the way had LocationsOnWays coordinates, otherwise nullptr
+	uxx numTags;
+	PbfStagedTag* tags;
+};
+
+typedef plex PbfStagedMember PbfStagedMember;
+plex PbfStagedMember
+{
+	u64 id;
+	OsmRelationMemberType type;
+	OsmRelationMemberRole role;
+};
+
+typedef plex PbfStagedRelation PbfStagedRelation;
+plex PbfStagedRelation
+{
+	u64 id;
+	bool visible;
+	i32 version;
+	u64 changeset;
+	u64 uid;
+	uxx numMembers;
+	PbfStagedMember* members;
+	uxx numTags;
+	PbfStagedTag* tags;
+};
+
+typedef plex PbfStagedGroup PbfStagedGroup;
+plex PbfStagedGroup
+{
+	bool hasNodes;
+	bool areNodesSorted;
+	uxx numNodes;
+	PbfStagedNode* nodes;
+	
+	bool hasWays;
+	bool areWaysSorted;
+	uxx numWays;
+	PbfStagedWay* ways;
+	
+	bool hasRelations;
+	bool areRelationsSorted;
+	uxx numRelations;
+	PbfStagedRelation* relations;
+};
+
+typedef enum PbfStagedBlockType PbfStagedBlockType;
+enum PbfStagedBlockType
+{
+	PbfStagedBlockType_None = 0,
+	PbfStagedBlockType_Header,
+	PbfStagedBlockType_Data,
+	PbfStagedBlockType_Unknown,
+};
+
+typedef plex PbfStagedBlock PbfStagedBlock;
+plex PbfStagedBlock
+{
+	Arena* arena; //the worker's scratch arena, everything below lives in here
+	uxx blobIndex;
+	Result result;
+	VarArray messages; //PbfStagedMessage
+	
+	PbfStagedBlockType type;
+	Str8 typeStr;
+	uxx headerLength;
+	u8* headerBytes;
+	uxx blobLength;
+	u8* blobBytes;
+	
+	recd bounds; //only filled for Header blocks
+	bool hasLocationsOnWays; //only filled for Header blocks
+	uxx numGroups;
+	PbfStagedGroup* groups;
+	PbfStringTable stringTable; //only filled for Data blocks, the staged tags index into this
+	u64* stringHashes; //numStrings long, hashed in the Decode stage so the Merge stage doesn't have to
+	u32* stringHandles; //numStrings long, OSM_STRING_INVALID until the Merge stage interns the string into the map's OsmStringPool
 	
-	while (!IsDataStreamFinished(protobufStream) && result == Result_None)
+	PbfBlobIndexEntry indexEntry; //only filled when pipeline->buildBlobIndex is set
+	
+	PbfCodec codec; //PbfCodec_None until DecompressPbfStagedBlob has run
+	uxx compressedSize;
+	uxx rawSize;
+	r64 decompressMs;
+};
+
+typedef enum PbfPipelinePass PbfPipelinePass;
+enum PbfPipelinePass
+{
+	PbfPipelinePass_Main = 0,
+	PbfPipelinePass_WayNodes, //second pass for options.keepWayNodesOutsideBounds and OsmTagFilterNodes_WayNodes, only the nodes listed in wayNodeIds are merged
+};
+
+typedef plex PbfPipeline PbfPipeline;
+plex PbfPipeline
+{
+	Arena* arena;
+	DataStream* protobufStream; //nullptr when reading from mappedFile
+	MappedFile* mappedFile; //when this is set blob bytes are referenced in place instead of being read into the scratch arena
+	uxx mappedReadOffset;
+	OsmLoadOptions options;
+	OsmMap* mapOut;
+	PbfPipelinePass pass;
+	v2d boundsFilterMin; //lon/lat, only used when options.useBoundsFilter is set
+	v2d boundsFilterMax;
+	bool skipNodesInMainPass; //OsmTagFilterNodes_WayNodes on a mapped file, the WayNodes pass picks up all the nodes
+	uxx numWayNodeIds;
+	u64* wayNodeIds; //sorted, the nodes that kept ways reference that weren't kept in the Main pass. Only used in the WayNodes pass
+	uxx numWayNodesFound;
+	PbfBlobIndex* blobIndex; //options.blobIndex when it can be used, otherwise nullptr
+	PbfBlobIndex* buildBlobIndex; //options.buildBlobIndex when it can be filled, otherwise nullptr
+	bool useWayLocations; //options.useLocationsOnWays and the OSMHeader listed the "LocationsOnWays" feature. Set when the header is merged
+	uxx numNodesExpected; //summed from blobIndex on unfiltered loads so the OsmMap arrays can be allocated once, 0 when we don't know
+	uxx numWaysExpected;
+	uxx numRelationsExpected;
+	
+	ThreadMutex readMutex;
+	bool isReadFinished;
+	uxx nextReadBlobIndex;
+	uxx nextIndexEntry; //only used when blobIndex is set
+	bool skippedDataBlobs; //the blobIndex let us skip at least one OSMData blob in the Main pass
+	
+	ThreadMutex mergeMutex;
+	ThreadCondVar mergeTurnChanged;
+	uxx nextMergeBlobIndex;
+	Result result;
+	uxx errorBlobIndex;
+	bool foundOsmHeader;
+	bool foundOsmData;
+	bool foundUnknownBlobTypes;
+	PbfCodecStats codecStats[PbfCodec_Count]; //filled by the Merge stage in both passes, printed at the end of the load when DEBUG_PBF_CODEC_STATS is enabled
+};
+
+// +--------------------------------------------------------------+
+// |                    Parallel Decode Stages                    |
+// +--------------------------------------------------------------+
+void AddPbfStagedMessage(PbfStagedBlock* block, DbgLevel level, bool notify, Str8 text)
+{
+	PbfStagedMessage* newMessage = VarArrayAdd(PbfStagedMessage, &block->messages);
+	NotNull(newMessage);
+	newMessage->level = level;
+	newMessage->notify = notify;
+	newMessage->text = text;
+}
+#define PbfStagedError(blockPntr, ...)       AddPbfStagedMessage((blockPntr), DbgLevel_Error, true, PrintInArenaStr((blockPntr)->arena, __VA_ARGS__))
+#define PbfStagedWarning(blockPntr, ...)     AddPbfStagedMessage((blockPntr), DbgLevel_Warning, false, PrintInArenaStr((blockPntr)->arena, __VA_ARGS__))
+#define PbfStagedNotifyWarning(blockPntr, ...) AddPbfStagedMessage((blockPntr), DbgLevel_Warning, true, PrintInArenaStr((blockPntr)->arena, __VA_ARGS__))
+
+// Returns a pointer straight into the mapped file when there is one, otherwise the bytes are read from the stream into arena.
+// Returns nullptr if there aren't enough bytes left. The caller must hold pipeline->readMutex
+u8* ReadPbfPipelineBytes(PbfPipeline* pipeline, uxx numBytes, Arena* arena)
+{
+	if (pipeline->mappedFile == nullptr) { return TryReadFromDataStream(pipeline->protobufStream, numBytes, arena); }
+	MappedFile* mappedFile = pipeline->mappedFile;
+	if (mappedFile->size - pipeline->mappedReadOffset < numBytes) { return nullptr; }
+	u8* result = &mappedFile->bytes[pipeline->mappedReadOffset];
+	pipeline->mappedReadOffset += numBytes;
+	MappedFileReadahead(mappedFile, pipeline->mappedReadOffset);
+	return result;
+}
+Result GetPbfPipelineReadError(PbfPipeline* pipeline)
+{
+	return (pipeline->mappedFile != nullptr) ? Result_NoMoreBytes : pipeline->protobufStream->error;
+}
+
+bool IsPbfLocationInBoundsFilter(const PbfPipeline* pipeline, v2d location)
+{
+	return (location.lon >= pipeline->boundsFilterMin.lon && location.lon <= pipeline->boundsFilterMax.lon &&
+		location.lat >= pipeline->boundsFilterMin.lat && location.lat <= pipeline->boundsFilterMax.lat);
+}
+
+// Decides from the blob's index entry whether the current pass could keep anything from it. Errs on the side of reading the blob
+bool IsPbfBlobNeeded(const PbfPipeline* pipeline, const PbfBlobIndexEntry* entry)
+{
+	if ((entry->flags & PbfBlobIndexFlag_Header) != 0) { return (pipeline->pass == PbfPipelinePass_Main); }
+	if (pipeline->pass == PbfPipelinePass_WayNodes) { return DoesPbfBlobIndexEntryContainAnyNodeId(entry, pipeline->numWayNodeIds, pipeline->wayNodeIds); }
+	if ((entry->flags & (PbfBlobIndexFlag_HasNodes|PbfBlobIndexFlag_HasWays|PbfBlobIndexFlag_HasRelations)) == 0) { return true; } //unknown blob types, let the Decode stage warn about them
+	bool isNodesOnly = ((entry->flags & (PbfBlobIndexFlag_HasWays|PbfBlobIndexFlag_HasRelations)) == 0);
+	if (isNodesOnly && pipeline->skipNodesInMainPass) { return false; }
+	//NOTE: Relations can be kept because they reference another kept relation, which the bounds don't capture, so we always read those blobs.
+	//      Ways are only kept when they reference a kept node, and a way's bounds cover all its nodes, so a way blob outside the filter has nothing for us
+	if ((entry->flags & PbfBlobIndexFlag_HasRelations) != 0) { return true; }
+	if (pipeline->options.useBoundsFilter && !DoesPbfBlobIndexEntryIntersectBounds(entry, pipeline->boundsFilterMin, pipeline->boundsFilterMax)) { return false; }
+	return true;
+}
+
+// Reads the next BlobHeader and Blob bytes (or finds them in the mapped file). Returns false if there are no more blobs to read.
+// A read failure still returns true with block->result set so the failure gets reported in order by the Merge stage
+bool TryReadPbfBlob(PbfPipeline* pipeline, PbfStagedBlock* block)
+{
+	TracyCZoneN(Zone_Func, "TryReadPbfBlob", true);
+	LockThreadMutex(&pipeline->readMutex);
+	uxx expectedEndOffset = 0;
+	if (pipeline->blobIndex != nullptr && !pipeline->isReadFinished)
 	{
-		uxx scratchMark1 = ArenaGetMark(scratch);
-		u32 headerLength = BinStreamReadU32(protobufStream, scratch,
-			result = ((blobIndex == 0) ? Result_EmptyFile : result);
-			break
-		);
-		FlipEndianU32(headerLength);
-		if (headerLength == 0) { result = Result_ValueTooLow; break; }
-		if (headerLength > Kilobytes(64)) { result = Result_ValueTooHigh; break; }
-		u8* headerBytes = TryReadFromDataStream(protobufStream, headerLength, scratch);
-		if (headerBytes == nullptr) { NotifyPrint_E("Failed to read %u byte header for blob[%llu]", headerLength, blobIndex); result = protobufStream->error; break; }
-		// PrintLine_D("headerLength=%u", headerLength);
-		
-		TracyCZoneN(Zone_BlobHeader, "BlobHeader", true);
-		OSMPBF__BlobHeader* blobHeader = osmpbf__blob_header__unpack(&scratchAllocator, headerLength, headerBytes);
-		TracyCZoneEnd(Zone_BlobHeader);
-		if (blobHeader == nullptr) { result = Result_ParsingFailure; break; }
-		Str8 blobTypeStr = MakeStr8Nt(blobHeader->type);
-		// PrintLine_I("Parsed %u byte BlobHeader: %d byte \"%s\"", headerLength, blobHeader->datasize, blobHeader->type);
-		// if (blobHeader->has_indexdata) { PrintLine_D("\tindexdata=%zu bytes %p", blobHeader->indexdata.len, blobHeader->indexdata.data); }
-		if (blobHeader->datasize == 0) { result = Result_ValueTooLow; break; }
-		if (blobHeader->datasize > Megabytes(32)) { result = Result_ValueTooHigh; break; }
-		u8* blobBytes = TryReadFromDataStream(protobufStream, blobHeader->datasize, scratch);
-		if (blobBytes == nullptr) { NotifyPrint_E("Failed to read %u byte blob[%llu]", blobHeader->datasize, blobIndex); result = protobufStream->error; break; }
-		
-		TracyCZoneN(Zone_Blob, "Blob", true);
-		OSMPBF__Blob* blob = osmpbf__blob__unpack(&scratchAllocator, blobHeader->datasize, blobBytes);
-		TracyCZoneEnd(Zone_Blob);
-		if (blob == nullptr) { result = Result_ParsingFailure; break; }
-		// PrintLine_I("\tParsed %d byte Blob!", blobHeader->datasize);
-		// PrintLine_D("\t\traw_size=%d%s", blob->raw_size, blob->has_raw_size ? "" : " (Not Found)");
-		const char* compressionTypeStr = "UNKNOWN";
-		ProtobufCBinaryData* dataPntr = nullptr;
-		switch (blob->data_case)
-		{
-			case OSMPBF__BLOB__DATA__NOT_SET:            compressionTypeStr = "_NOT_SET";                                              break;
-			case OSMPBF__BLOB__DATA_RAW:                 compressionTypeStr = "RAW";            dataPntr = &blob->obsolete_bzip2_data; break;
-			case OSMPBF__BLOB__DATA_ZLIB_DATA:           compressionTypeStr = "ZLIB";           dataPntr = &blob->lz4_data;            break;
-			case OSMPBF__BLOB__DATA_LZMA_DATA:           compressionTypeStr = "LZMA";           dataPntr = &blob->lzma_data;           break;
-			case OSMPBF__BLOB__DATA_OBSOLETE_BZIP2_DATA: compressionTypeStr = "OBSOLETE_BZIP2"; dataPntr = &blob->raw;                 break;
-			case OSMPBF__BLOB__DATA_LZ4_DATA:            compressionTypeStr = "LZ4";            dataPntr = &blob->zlib_data;           break;
-			case OSMPBF__BLOB__DATA_ZSTD_DATA:           compressionTypeStr = "ZSTD";           dataPntr = &blob->zstd_data;           break;
-		}
-		// PrintLineAt((dataPntr == nullptr ? DbgLevel_Error: DbgLevel_Info),
-		// 	"Found Blob[%llu]: \"%s\" (%s %d->%d bytes)",
-		// 	blobIndex,
-		// 	blobHeader->type,
-		// 	compressionTypeStr,
-		// 	(dataPntr != nullptr) ? dataPntr->len : 0,
-		// 	blob->raw_size
-		// );
-		
-		Slice decompressedBuffer = Slice_Empty;
-		if (blob->data_case == OSMPBF__BLOB__DATA_RAW)
+		//NOTE: We jump straight to the start of the next blob we need. Since the index matched the file's size and hash we trust the offsets,
+		//      but still check that each blob ends where the index says it does (see below)
+		PbfBlobIndexEntry* nextEntry = nullptr;
+		while (pipeline->nextIndexEntry < pipeline->blobIndex->entries.length)
 		{
-			decompressedBuffer = MakeSlice((uxx)dataPntr->len, dataPntr->data);
+			PbfBlobIndexEntry* entry = VarArrayGet(PbfBlobIndexEntry, &pipeline->blobIndex->entries, pipeline->nextIndexEntry);
+			pipeline->nextIndexEntry++;
+			if (IsPbfBlobNeeded(pipeline, entry)) { nextEntry = entry; break; }
+			if (pipeline->pass == PbfPipelinePass_Main && (entry->flags & PbfBlobIndexFlag_Header) == 0) { pipeline->skippedDataBlobs = true; }
 		}
-		else if (blob->data_case == OSMPBF__BLOB__DATA_ZLIB_DATA && blob->raw_size > 0)
+		if (nextEntry != nullptr)
 		{
-			TracyCZoneN(Zone_ZlibDecompress, "ZlibDecompress", true);
-			decompressedBuffer = ZlibDecompressIntoArena(scratch, MakeSlice((uxx)dataPntr->len, dataPntr->data), (uxx)blob->raw_size);
-			TracyCZoneEnd(Zone_ZlibDecompress);
-			if (decompressedBuffer.bytes == nullptr)
-			{
-				NotifyPrint_E("Failed to decompress blob[%llu] ZLIB %llu->%llu", blobIndex, (uxx)dataPntr->len, (uxx)blob->raw_size);
-				result = Result_DecompressError;
-				break;
-			}
-			// PrintLine_I("Decompressed ZLIB_DATA successfully: %llu bytes (%02X %02X %02X %02X)", decompressedBuffer.length, decompressedBuffer.bytes[0], decompressedBuffer.bytes[1], decompressedBuffer.bytes[2], decompressedBuffer.bytes[3]);
+			pipeline->mappedReadOffset = (uxx)nextEntry->fileOffset;
+			expectedEndOffset = (uxx)(nextEntry->fileOffset + nextEntry->length);
 		}
-		else if (blob->data_case != OSMPBF__BLOB__DATA__NOT_SET)
+		else { pipeline->isReadFinished = true; }
+	}
+	bool isSourceFinished = (pipeline->mappedFile != nullptr)
+		? (pipeline->mappedReadOffset >= pipeline->mappedFile->size)
+		: IsDataStreamFinished(pipeline->protobufStream);
+	if (pipeline->isReadFinished || isSourceFinished)
+	{
+		pipeline->isReadFinished = true;
+		UnlockThreadMutex(&pipeline->readMutex);
+		TracyCZoneEnd(Zone_Func);
+		return false;
+	}
+	
+	uxx blobIndex = pipeline->nextReadBlobIndex;
+	block->blobIndex = blobIndex;
+	block->result = Result_None;
+	if (pipeline->buildBlobIndex != nullptr) { InitPbfBlobIndexEntry(&block->indexEntry); block->indexEntry.fileOffset = (u64)pipeline->mappedReadOffset; }
+	do
+	{
+		//NOTE: A canceled load is reported through the Merge stage like any other failure so everything before this blob still merges in order
+		if (IsOsmLoadCanceled(pipeline->options.progress)) { block->result = Result_Canceled; break; }
+		u8* lengthBytes = ReadPbfPipelineBytes(pipeline, sizeof(u32), block->arena);
+		if (lengthBytes == nullptr) { block->result = ((blobIndex == 0) ? Result_EmptyFile : Result_None); break; }
+		u32 headerLength = (((u32)lengthBytes[0] << 24) | ((u32)lengthBytes[1] << 16) | ((u32)lengthBytes[2] << 8) | (u32)lengthBytes[3]); //big-endian
+		if (headerLength == 0) { block->result = Result_ValueTooLow; break; }
+		if (headerLength > Kilobytes(64)) { block->result = Result_ValueTooHigh; break; }
+		block->headerBytes = ReadPbfPipelineBytes(pipeline, headerLength, block->arena);
+		if (block->headerBytes == nullptr) { PbfStagedError(block, "Failed to read %u byte header for blob[%llu]", headerLength, blobIndex); block->result = GetPbfPipelineReadError(pipeline); break; }
+		block->headerLength = (uxx)headerLength;
+		
+		TracyCZoneN(Zone_BlobHeader, "BlobHeader", true);
+		PbfBlobHeaderInfo blobHeader = ZEROED;
+		bool parsedHeader = TryParsePbfBlobHeaderDirect(MakeSlice(block->headerLength, block->headerBytes), &blobHeader);
+		TracyCZoneEnd(Zone_BlobHeader);
+		if (!parsedHeader) { block->result = Result_ParsingFailure; break; }
+		block->typeStr = blobHeader.type;
+		// PrintLine_I("Parsed %u byte BlobHeader: %d byte \"%.*s\"", headerLength, blobHeader.dataSize, StrPrint(blobHeader.type));
+		// if (blobHeader.indexData.length > 0) { PrintLine_D("\tindexdata=%llu bytes %p", blobHeader.indexData.length, blobHeader.indexData.bytes); }
+		if (blobHeader.dataSize == 0) { block->result = Result_ValueTooLow; break; }
+		if ((u32)blobHeader.dataSize > Megabytes(32)) { block->result = Result_ValueTooHigh; break; }
+		block->blobBytes = ReadPbfPipelineBytes(pipeline, (uxx)blobHeader.dataSize, block->arena);
+		if (block->blobBytes == nullptr) { PbfStagedError(block, "Failed to read %d byte blob[%llu]", blobHeader.dataSize, blobIndex); block->result = GetPbfPipelineReadError(pipeline); break; }
+		block->blobLength = (uxx)blobHeader.dataSize;
+		if (pipeline->buildBlobIndex != nullptr) { block->indexEntry.length = (u64)pipeline->mappedReadOffset - block->indexEntry.fileOffset; }
+		if (expectedEndOffset != 0 && pipeline->mappedReadOffset != expectedEndOffset)
 		{
-			NotifyPrint_E("Unsupported compression %s on blob[%llu]", compressionTypeStr, blobIndex);
-			result = Result_UnsupportedCompression;
-			break;
+			PbfStagedError(block, "Blob[%llu] doesn't end where the blob index says it should, the index is out of date", blobIndex);
+			block->result = Result_Mismatch;
 		}
+	} while(0);
+	
+	//NOTE: Running out of bytes in the middle of the length prefix of a blob (other than the first) is treated as the end of the file
+	bool isEndOfFile = (block->result == Result_None && block->blobBytes == nullptr);
+	if (isEndOfFile || block->result != Result_None) { pipeline->isReadFinished = true; }
+	if (!isEndOfFile) { pipeline->nextReadBlobIndex++; }
+	UnlockThreadMutex(&pipeline->readMutex);
+	TracyCZoneEnd(Zone_Func);
+	return !isEndOfFile;
+}
+
+// Both decoders treat string id 0 and out of range ids as the empty string
+u32 GetPbfStagedStringId(const PbfStringTable* table, i64 stringId)
+{
+	return (stringId > 0 && (uxx)stringId < table->numStrings) ? (u32)stringId : 0;
+}
+
+// This is the reference decoder that uses the generated osm_pbf.pb-c.c code to unpack the entire PrimitiveBlock before walking it.
+// TryDecodePbfPrimitiveBlockDirect should produce exactly the same staged block, and falls back to this for anything it doesn't handle
+Result DecodePbfPrimitiveBlockProtobufC(PbfStagedBlock* block, Slice decompressedBuffer)
+{
+	TracyCZoneN(Zone_Func, "DecodePbfPrimitiveBlockProtobufC", true);
+	Arena* scratch = block->arena;
+	ProtobufCAllocator scratchAllocator = ProtobufAllocatorFromArena(scratch);
+	uxx blobIndex = block->blobIndex;
+	Result result = Result_None;
+	
+	TracyCZoneN(Zone_OsmPrimitiveBlock, "OsmPrimitiveBlock", true);
+	OSMPBF__PrimitiveBlock* primitiveBlock = osmpbf__primitive_block__unpack(&scratchAllocator, decompressedBuffer.length, decompressedBuffer.bytes);
+	TracyCZoneEnd(Zone_OsmPrimitiveBlock);
+	if (primitiveBlock == nullptr) { PbfStagedError(block, "Failed to parse OSMPBF::PrimitiveBlock in blob[%llu]!", blobIndex); TracyCZoneEnd(Zone_Func); return Result_ParsingFailure; }
+	
+	block->stringTable.numStrings = (uxx)primitiveBlock->stringtable->n_s;
+	block->stringTable.strings = (block->stringTable.numStrings > 0) ? AllocArray(Str8, scratch, block->stringTable.numStrings) : nullptr;
+	for (size_t sIndex = 0; sIndex < primitiveBlock->stringtable->n_s; sIndex++)
+	{
+		block->stringTable.strings[sIndex] = MakeStr8(primitiveBlock->stringtable->s[sIndex].len, (char*)primitiveBlock->stringtable->s[sIndex].data);
+	}
+	
+	r64 granularityMult = (r64)(primitiveBlock->has_granularity ? primitiveBlock->granularity : 1) * (r64)Billionth(100);
+	v2d nodeOffset = MakeV2d(
+		(r64)(primitiveBlock->has_lon_offset ? primitiveBlock->lon_offset * granularityMult : 0),
+		(r64)(primitiveBlock->has_lat_offset ? primitiveBlock->lat_offset * granularityMult : 0)
+	);
+	
+	block->numGroups = (uxx)primitiveBlock->n_primitivegroup;
+	block->groups = (block->numGroups > 0) ? AllocArray(PbfStagedGroup, scratch, block->numGroups) : nullptr;
+	if (block->numGroups > 0) { NotNull(block->groups); MyMemSet(block->groups, 0x00, sizeof(PbfStagedGroup) * block->numGroups); }
+	
+	for (size_t gIndex = 0; gIndex < primitiveBlock->n_primitivegroup; gIndex++)
+	{
+		OSMPBF__PrimitiveGroup* primitiveGroup = primitiveBlock->primitivegroup[gIndex];
+		PbfStagedGroup* group = &block->groups[gIndex];
 		
 		// +==============================+
-		// |        OSMHeader Blob        |
+		// |       PBF Dense Nodes        |
 		// +==============================+
-		if (StrExactEquals(blobTypeStr, StrLit("OSMHeader")))
+		if (primitiveGroup->dense != nullptr)
 		{
-			if (foundOsmHeader) { NotifyPrint_E("Blob[%llu] was a second OSMHeader!", blobIndex); result = Result_Duplicate; break; }
+			TracyCZoneN(Zone_OsmDenseNodes, "OsmDenseNodes", true);
+			OSMPBF__DenseNodes* denseNodes = primitiveGroup->dense;
+			NotNull(denseNodes->denseinfo);
+			if (denseNodes->n_id != denseNodes->n_lat) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match Lat count %zu", blobIndex, denseNodes->n_id, denseNodes->n_lat); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
+			if (denseNodes->n_id != denseNodes->n_lon) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match Lon count %zu", blobIndex, denseNodes->n_id, denseNodes->n_lon); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
+			bool haveVersions   = (denseNodes->denseinfo->n_version   != 0);
+			bool haveTimestamps = (denseNodes->denseinfo->n_timestamp != 0);
+			bool haveChangesets = (denseNodes->denseinfo->n_changeset != 0);
+			bool haveUids       = (denseNodes->denseinfo->n_uid       != 0);
+			bool haveUserSids   = (denseNodes->denseinfo->n_user_sid  != 0);
+			bool haveVisibles   = (denseNodes->denseinfo->n_visible   != 0);
+			if (haveVersions   && denseNodes->n_id != denseNodes->denseinfo->n_version)   { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match info->version count %zu",   blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_version);   result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
+			if (haveTimestamps && denseNodes->n_id != denseNodes->denseinfo->n_timestamp) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match info->timestamp count %zu", blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_timestamp); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
+			if (haveChangesets && denseNodes->n_id != denseNodes->denseinfo->n_changeset) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match info->changeset count %zu", blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_changeset); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
+			if (haveUids       && denseNodes->n_id != denseNodes->denseinfo->n_uid)       { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match info->uid count %zu",       blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_uid);       result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
+			if (haveUserSids   && denseNodes->n_id != denseNodes->denseinfo->n_user_sid)  { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match info->user_sid count %zu",  blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_user_sid);  result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
+			if (haveVisibles   && denseNodes->n_id != denseNodes->denseinfo->n_visible)   { PbfStagedError(block, "DenseNode in blob[%llu] ID count %zu doesn't match info->visible count %zu",   blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_visible);   result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
 			
-			TracyCZoneN(Zone_OsmHeaderBlock, "OsmHeaderBlock", true);
-			OSMPBF__HeaderBlock* headerBlock = osmpbf__header_block__unpack(&scratchAllocator, decompressedBuffer.length, decompressedBuffer.bytes);
-			TracyCZoneEnd(Zone_OsmHeaderBlock);
-			if (headerBlock == nullptr) { NotifyPrint_E("Failed to parse OSMPBF::HeaderBlock in blob[%llu]!", blobIndex); result = Result_ParsingFailure; break; }
-			#if 0
-			PrintLine_D("\tbbox: (%lf, %lf, %lf, %lf)",
-				(r64)headerBlock->bbox->left * (r64)Nano(1),
-				(r64)headerBlock->bbox->top * (r64)Nano(1),
-				(r64)headerBlock->bbox->right * (r64)Nano(1),
-				(r64)headerBlock->bbox->bottom * (r64)Nano(1)
-			);
-			PrintLine_D("\tn_required_features: %zu", headerBlock->n_required_features);
-			for (size_t fIndex = 0; fIndex < headerBlock->n_required_features; fIndex++) { PrintLine_D("\t\trequired_feature[%zu]: \"%s\"", fIndex, headerBlock->required_features[fIndex]); }
-			PrintLine_D("\tn_optional_features: %zu", headerBlock->n_optional_features);
-			for (size_t fIndex = 0; fIndex < headerBlock->n_optional_features; fIndex++) { PrintLine_D("\t\toptional_feature[%zu]: \"%s\"", fIndex, headerBlock->optional_features[fIndex]); }
-			PrintLine_D("\twritingprogram: \"%s\"", headerBlock->writingprogram); //ex. "osmconvert 0.8.10"
-			PrintLine_D("\tsource: \"%s\"", headerBlock->source); //ex. "http://www.openstreetmap.org/api/0.6"
-			if (headerBlock->has_osmosis_replication_timestamp) { PrintLine_D("\tosmosis_replication_timestamp: %lld", headerBlock->osmosis_replication_timestamp); }
-			if (headerBlock->has_osmosis_replication_sequence_number) { PrintLine_D("\tosmosis_replication_sequence_number: %lld", headerBlock->osmosis_replication_sequence_number); }
-			if (headerBlock->osmosis_replication_base_url != nullptr) { PrintLine_D("\tosmosis_replication_base_url: \"%s\"", headerBlock->osmosis_replication_base_url); }
-			#endif
+			group->hasNodes = true;
+			group->areNodesSorted = true;
+			group->numNodes = (uxx)denseNodes->n_id;
+			group->nodes = (group->numNodes > 0) ? AllocArray(PbfStagedNode, scratch, group->numNodes) : nullptr;
+			PbfStagedTag* tagsBuffer = (denseNodes->n_keys_vals > 0) ? AllocArray(PbfStagedTag, scratch, (uxx)(denseNodes->n_keys_vals/2) + 1) : nullptr;
+			uxx numTagsUsed = 0;
 			
-			foundOsmHeader = true;
-			InitOsmMap(arena, mapOut, 0, 0, 0);
-			mapOut->areNodesSorted = true;
-			mapOut->areWaysSorted = true;
-			mapOut->areRelationsSorted = true;
-			mapOut->bounds.x = (r64)headerBlock->bbox->left * (r64)Nano(1);
-			mapOut->bounds.y = (r64)headerBlock->bbox->top * (r64)Nano(1);
-			mapOut->bounds.width = ((r64)headerBlock->bbox->right * (r64)Nano(1)) - mapOut->bounds.x;
-			mapOut->bounds.height = ((r64)headerBlock->bbox->bottom * (r64)Nano(1)) - mapOut->bounds.y;
-			//TODO: Ensure that all the "required_features" are things we expect to handle
-			//      "OsmSchema-V0.6", "DenseNodes", "Sort.Type_then_ID", "LocationsOnWays", "HistoricalInformation", etc.
+			size_t currentKeyValIndex = 0;
+			
+			i64 prevNodeId = 0;
+			i64 prevNodeLat = 0;
+			i64 prevNodeLon = 0;
+			i64 prevNodeTimestamp = 0;
+			i64 prevNodeChangeset = 0;
+			i32 prevNodeUid = 0;
+			i32 prevNodeUserSid = 0;
+			for (size_t nIndex = 0; nIndex < denseNodes->n_id; nIndex++)
+			{
+				i64 nodeId = prevNodeId + denseNodes->id[nIndex];
+				i64 nodeLat = prevNodeLat + denseNodes->lat[nIndex];
+				i64 nodeLon = prevNodeLon + denseNodes->lon[nIndex];
+				i32 nodeVersion   = (haveVersions   ? denseNodes->denseinfo->version[nIndex] : -1); //NOTE: version is not delta coded
+				i64 nodeTimestamp = (haveTimestamps ? prevNodeTimestamp + denseNodes->denseinfo->timestamp[nIndex] : 0);
+				i64 nodeChangeset = (haveChangesets ? prevNodeChangeset + denseNodes->denseinfo->changeset[nIndex] : 0);
+				i32 nodeUid       = (haveUids       ? prevNodeUid       + denseNodes->denseinfo->uid[nIndex]       : 0);
+				i32 nodeUserSid   = (haveUserSids   ? prevNodeUserSid   + denseNodes->denseinfo->user_sid[nIndex]  : 0);
+				bool nodeVisible  = (haveVisibles   ? denseNodes->denseinfo->visible[nIndex]   : true);
+				if (nodeId <= 0) { PbfStagedError(block, "Invalid Node ID %lld in blob[%llu] group[%zu] denseNode[%zu]!", nodeId, blobIndex, gIndex, nIndex); result = Result_InvalidID; break; }
+				if (nodeVersion < -1) { PbfStagedError(block, "Invalid Node Version %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeVersion, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
+				if (nodeTimestamp < 0) { PbfStagedError(block, "Invalid Node Timestamp %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeTimestamp, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
+				if (nodeChangeset < 0) { PbfStagedError(block, "Invalid Node Changeset %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeChangeset, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
+				if (nodeUid < 0) { PbfStagedError(block, "Invalid Node UID %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeUid, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
+				
+				//NOTE: The first node is compared against the last node in the map during the Merge stage
+				if (nIndex > 0 && prevNodeId >= nodeId) { group->areNodesSorted = false; }
+				
+				PbfStagedNode* stagedNode = &group->nodes[nIndex];
+				stagedNode->id = (u64)nodeId;
+				stagedNode->location = MakeV2d(
+					nodeOffset.x + ((r64)nodeLon * granularityMult),
+					nodeOffset.y + ((r64)nodeLat * granularityMult)
+				);
+				stagedNode->visible = nodeVisible;
+				stagedNode->version = nodeVersion;
+				stagedNode->changeset = (u64)nodeChangeset;
+				// TODO: Str8 timestampStr;
+				// TODO: Str8 user;
+				stagedNode->uid = (u64)nodeUid;
+				stagedNode->tags = (tagsBuffer != nullptr) ? &tagsBuffer[numTagsUsed] : nullptr;
+				stagedNode->numTags = 0;
+				
+				//Find node tags by walking keys_vals list 2 at a time until we find a 0 entry
+				while (currentKeyValIndex <= denseNodes->n_keys_vals)
+				{
+					i32 keyStringId = denseNodes->keys_vals[currentKeyValIndex+0];
+					if (keyStringId == 0 || currentKeyValIndex+1 >= denseNodes->n_keys_vals) { currentKeyValIndex++; break; } // 0 entry denotes following tags are for next node
+					i32 valStringId = denseNodes->keys_vals[currentKeyValIndex+1];
+					currentKeyValIndex += 2;
+					Str8 keyStr = GetPbfString(primitiveBlock->stringtable, keyStringId);
+					if (!IsEmptyStr(keyStr))
+					{
+						PbfStagedTag* newTag = &tagsBuffer[numTagsUsed];
+						newTag->keyId = (u32)keyStringId;
+						newTag->valueId = GetPbfStagedStringId(&block->stringTable, valStringId);
+						numTagsUsed++;
+						stagedNode->numTags++;
+					}
+				}
+				
+				prevNodeId = nodeId;
+				prevNodeLat = nodeLat;
+				prevNodeLon = nodeLon;
+				prevNodeTimestamp = nodeTimestamp;
+				prevNodeChangeset = nodeChangeset;
+				prevNodeUid = nodeUid;
+				prevNodeUserSid = nodeUserSid;
+			}
+			TracyCZoneEnd(Zone_OsmDenseNodes);
+			if (result != Result_None) { break; }
+			if (currentKeyValIndex < denseNodes->n_keys_vals) { PbfStagedNotifyWarning(block, "There were %zu/%zu tags left over after parsing %zu denseNodes in blob[%llu]", denseNodes->n_keys_vals - currentKeyValIndex, denseNodes->n_keys_vals, denseNodes->n_id, blobIndex); }
 		}
+		
 		// +==============================+
-		// |         OSMData Blob         |
+		// |          PBF Nodes           |
 		// +==============================+
-		else if (StrExactEquals(blobTypeStr, StrLit("OSMData")))
+		//NOTE: Plain nodes are appended after any DenseNodes in the same group (DecodePbfNodesDirect does the same)
+		if (primitiveGroup->n_nodes > 0)
 		{
-			if (!foundOsmHeader) { NotifyPrint_E("Blob[%llu] was OSMData BEFORE we found OSMHeader blob!", blobIndex); result = Result_MissingHeader; break; }
-			
-			TracyCZoneN(Zone_OsmHeaderBlock, "OsmPrimitiveBlock", true);
-			OSMPBF__PrimitiveBlock* primitiveBlock = osmpbf__primitive_block__unpack(&scratchAllocator, decompressedBuffer.length, decompressedBuffer.bytes);
-			TracyCZoneEnd(Zone_OsmHeaderBlock);
-			if (primitiveBlock == nullptr) { NotifyPrint_E("Failed to parse OSMPBF::PrimitiveBlock in blob[%llu]!", blobIndex); result = Result_ParsingFailure; break; }
-			#if 0
-			PrintLine_D("\tstrings: %zu", primitiveBlock->stringtable->n_s);
-			// PrintLine_D("\tstrings at %p relative to %p or %d", primitiveBlock->stringtable->s, decompressedBuffer.bytes, (u8*)primitiveBlock->stringtable->s - decompressedBuffer.bytes);
-			PrintLine_D("\tn_primitivegroup: %zu", primitiveBlock->n_primitivegroup);
-			for (size_t gIndex = 0; gIndex < primitiveBlock->n_primitivegroup; gIndex++)
-			{
-				OSMPBF__PrimitiveGroup* primitiveGroup = primitiveBlock->primitivegroup[gIndex];
-				PrintLine_D("\t\tgroup[%zu]: %zu nodes (%zu dense) - %zu ways - %zu relations - %zu changesets",
-					gIndex,
-					primitiveGroup->n_nodes,
-					(primitiveGroup->dense != nullptr) ? MaxU64(MaxU64((u64)primitiveGroup->dense->n_id, (u64)primitiveGroup->dense->n_lat), (u64)primitiveGroup->dense->n_lon) : (size_t)0,
-					primitiveGroup->n_ways,
-					primitiveGroup->n_relations,
-					primitiveGroup->n_changesets
+			TracyCZoneN(Zone_OsmNodes, "OsmNodes", true);
+			PbfStagedNode* newNodes = AllocArray(PbfStagedNode, scratch, group->numNodes + (uxx)primitiveGroup->n_nodes);
+			NotNull(newNodes);
+			if (group->numNodes > 0) { MyMemCopy(newNodes, group->nodes, sizeof(PbfStagedNode) * group->numNodes); }
+			if (!group->hasNodes) { group->areNodesSorted = true; }
+			group->hasNodes = true;
+			group->nodes = newNodes;
+			u64 prevNodeId = (group->numNodes > 0) ? group->nodes[group->numNodes-1].id : 0;
+			for (size_t nIndex = 0; nIndex < primitiveGroup->n_nodes; nIndex++)
+			{
+				OSMPBF__Node* node = primitiveGroup->nodes[nIndex];
+				OSMPBF__Info* info = node->info; //NOTE: info is optional on plain nodes
+				if (node->id <= 0)                                                  { PbfStagedError(block, "Node[%zu] in blob[%llu] has invalid ID %lld",        nIndex, blobIndex, node->id); result = Result_InvalidID; break; }
+				if (info != nullptr && info->has_version   && info->version   < -1) { PbfStagedError(block, "Node[%zu] in blob[%llu] has invalid version %d",     nIndex, blobIndex, info->version); result = Result_ValueTooLow; break; }
+				if (info != nullptr && info->has_timestamp && info->timestamp < 0)  { PbfStagedError(block, "Node[%zu] in blob[%llu] has invalid timestamp %lld", nIndex, blobIndex, info->timestamp); result = Result_ValueTooLow; break; }
+				if (info != nullptr && info->has_uid       && info->uid       < 0)  { PbfStagedError(block, "Node[%zu] in blob[%llu] has invalid uid %d",         nIndex, blobIndex, info->uid); result = Result_ValueTooLow; break; }
+				if (info != nullptr && info->has_changeset && info->changeset < 0)  { PbfStagedError(block, "Node[%zu] in blob[%llu] has invalid changeset %lld", nIndex, blobIndex, info->changeset); result = Result_ValueTooLow; break; }
+				if (node->n_keys != node->n_vals)                                   { PbfStagedError(block, "Node[%zu] in blob[%llu] key count %zu doesn't match value count %zu", nIndex, blobIndex, node->n_keys, node->n_vals); result = Result_Mismatch; break; }
+				
+				//NOTE: The first node is compared against the last node in the map during the Merge stage
+				if (prevNodeId != 0 && prevNodeId >= (u64)node->id) { group->areNodesSorted = false; }
+				prevNodeId = (u64)node->id;
+				
+				PbfStagedNode* stagedNode = &group->nodes[group->numNodes];
+				group->numNodes++;
+				stagedNode->id = (u64)node->id;
+				stagedNode->location = MakeV2d(
+					nodeOffset.x + ((r64)node->lon * granularityMult),
+					nodeOffset.y + ((r64)node->lat * granularityMult)
 				);
-				if (primitiveGroup->dense != nullptr)
+				stagedNode->visible = ((info != nullptr && info->has_visible) ? info->visible : true);
+				stagedNode->version = ((info != nullptr && info->has_version) ? info->version : -1);
+				stagedNode->changeset = ((info != nullptr && info->has_changeset) ? (u64)info->changeset : 0);
+				stagedNode->uid = ((info != nullptr && info->has_uid) ? (u64)info->uid : 0);
+				stagedNode->numTags = 0;
+				stagedNode->tags = (node->n_keys > 0) ? AllocArray(PbfStagedTag, scratch, (uxx)node->n_keys) : nullptr;
+				for (size_t tIndex = 0; tIndex < node->n_keys; tIndex++)
 				{
-					NotNull(primitiveGroup->dense->denseinfo);
-					PrintLine_D("\t\t\tDenseNodes: %zu IDs, %zu lats, %zu lons, %zu kvps", primitiveGroup->dense->n_id, primitiveGroup->dense->n_lat, primitiveGroup->dense->n_lon, primitiveGroup->dense->n_keys_vals);
-					PrintLine_D("\t\t\t Info: %zu versions, %zu timestamps, %zu changesets, %zu uids, %zu user_sids, %zu visibles", primitiveGroup->dense->denseinfo->n_version, primitiveGroup->dense->denseinfo->n_timestamp, primitiveGroup->dense->denseinfo->n_changeset, primitiveGroup->dense->denseinfo->n_uid, primitiveGroup->dense->denseinfo->n_user_sid, primitiveGroup->dense->denseinfo->n_visible);
+					Str8 keyStr = GetPbfString(primitiveBlock->stringtable, node->keys[tIndex]);
+					if (!IsEmptyStr(keyStr))
+					{
+						PbfStagedTag* newTag = &stagedNode->tags[stagedNode->numTags];
+						newTag->keyId = node->keys[tIndex];
+						newTag->valueId = GetPbfStagedStringId(&block->stringTable, node->vals[tIndex]);
+						stagedNode->numTags++;
+					}
 				}
 			}
-			if (primitiveBlock->has_granularity) { PrintLine_D("\tgranularity: %d", primitiveBlock->granularity); }
-			else { WriteLine_D("\tgranularity: default"); }
-			if (primitiveBlock->has_lat_offset) { PrintLine_D("\tlat_offset: %lld", primitiveBlock->lat_offset); }
-			else { WriteLine_D("\tlat_offset: default"); }
-			if (primitiveBlock->has_lon_offset) { PrintLine_D("\tlon_offset: %lld", primitiveBlock->lon_offset); }
-			else { WriteLine_D("\tlon_offset: default"); }
-			if (primitiveBlock->has_date_granularity) { PrintLine_D("\tdate_granularity: %d", primitiveBlock->date_granularity); }
-			else { WriteLine_D("\tdate_granularity: default"); }
-			#endif
-			
-			r64 granularityMult = (r64)(primitiveBlock->has_granularity ? primitiveBlock->granularity : 1) * (r64)Billionth(100);
-			v2d nodeOffset = MakeV2d(
-				(r64)(primitiveBlock->has_lon_offset ? primitiveBlock->lon_offset * granularityMult : 0),
-				(r64)(primitiveBlock->has_lat_offset ? primitiveBlock->lat_offset * granularityMult : 0)
-			);
-			
-			for (size_t gIndex = 0; gIndex < primitiveBlock->n_primitivegroup; gIndex++)
+			TracyCZoneEnd(Zone_OsmNodes);
+			if (result != Result_None) { break; }
+		}
+		
+		// +==============================+
+		// |           PBF Ways           |
+		// +==============================+
+		if (primitiveGroup->n_ways > 0)
+		{
+			TracyCZoneN(Zone_OsmWays, "OsmWays", true);
+			group->hasWays = true;
+			group->areWaysSorted = true;
+			group->ways = AllocArray(PbfStagedWay, scratch, (uxx)primitiveGroup->n_ways);
+			NotNull(group->ways);
+			u64 prevWayId = 0;
+			for (size_t wIndex = 0; wIndex < primitiveGroup->n_ways; wIndex++)
 			{
-				OSMPBF__PrimitiveGroup* primitiveGroup = primitiveBlock->primitivegroup[gIndex];
-				
-				// +==============================+
-				// |          PBF Nodes           |
-				// +==============================+
-				if (primitiveGroup->n_nodes > 0)
+				OSMPBF__Way* way = primitiveGroup->ways[wIndex];
+				NotNull(way->info);
+				if (way->id <= 0)                                         { PbfStagedError(block, "Way[%zu] in blob[%llu] has invalid ID %lld",        wIndex, blobIndex, way->id); result = Result_InvalidID; break; }
+				if (way->info->has_timestamp && way->info->timestamp < 0) { PbfStagedError(block, "Way[%zu] in blob[%llu] has invalid timestamp %lld", wIndex, blobIndex, way->info->timestamp); result = Result_ValueTooLow; break; }
+				if (way->info->has_uid       && way->info->uid       < 0) { PbfStagedError(block, "Way[%zu] in blob[%llu] has invalid uid %d",         wIndex, blobIndex, way->info->uid); result = Result_ValueTooLow; break; }
+				if (way->info->has_changeset && way->info->changeset < 0) { PbfStagedError(block, "Way[%zu] in blob[%llu] has invalid changeset %lld", wIndex, blobIndex, way->info->changeset); result = Result_ValueTooLow; break; }
+				if (way->n_keys != way->n_vals)                           { PbfStagedError(block, "Way[%zu] in blob[%llu] key count %zu doesn't match value count %zu", wIndex, blobIndex, way->n_keys, way->n_vals); result = Result_Mismatch; break; }
+				if (way->n_refs > 0)
 				{
-					TracyCZoneN(Zone_OsmNodes, "OsmNodes", true);
-					for (size_t nIndex = 0; nIndex < primitiveGroup->n_nodes; nIndex++)
+					uxx numNodesInWay = (uxx)way->n_refs;
+					u64* nodeIds = AllocArray(u64, scratch, numNodesInWay);
+					NotNull(nodeIds);
+					u64 prevNodeId = 0;
+					for (size_t rIndex = 0; rIndex < way->n_refs; rIndex++)
 					{
-						OSMPBF__Node* node = primitiveGroup->nodes[nIndex];
-						UNUSED(node); //TODO: Implement me!
+						if (way->refs[rIndex] < -(i64)prevNodeId) { PbfStagedError(block, "Node[%zu] in Way[%zu] in blob[%llu] has negative ID %llu%s%lld", rIndex, wIndex, blobIndex, prevNodeId, (way->refs[rIndex] >= 0) ? "+" : "", way->refs[rIndex]); result = Result_InvalidID; break; }
+						if (way->refs[rIndex] > 0 && (u64)way->refs[rIndex] > UINT64_MAX - prevNodeId) { PbfStagedError(block, "Node[%zu] in Way[%zu] in blob[%llu] has overflow ID %llu%s%lld", rIndex, wIndex, blobIndex, prevNodeId, (way->refs[rIndex] >= 0) ? "+" : "", way->refs[rIndex]); result = Result_InvalidID; break; }
+						nodeIds[rIndex] = (u64)(prevNodeId + way->refs[rIndex]);
+						prevNodeId = nodeIds[rIndex];
 					}
-					TracyCZoneEnd(Zone_OsmNodes);
 					if (result != Result_None) { break; }
-				}
-				
-				// +==============================+
-				// |       PBF Dense Nodes        |
-				// +==============================+
-				if (primitiveGroup->dense != nullptr)
-				{
-					TracyCZoneN(Zone_OsmDenseNodes, "OsmDenseNodes", true);
-					OSMPBF__DenseNodes* denseNodes = primitiveGroup->dense;
-					NotNull(denseNodes->denseinfo);
-					if (denseNodes->n_id != denseNodes->n_lat) { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match Lat count %zu", blobIndex, denseNodes->n_id, denseNodes->n_lat); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
-					if (denseNodes->n_id != denseNodes->n_lon) { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match Lon count %zu", blobIndex, denseNodes->n_id, denseNodes->n_lon); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
-					bool haveVersions   = (denseNodes->denseinfo->n_version   != 0);
-					bool haveTimestamps = (denseNodes->denseinfo->n_timestamp != 0);
-					bool haveChangesets = (denseNodes->denseinfo->n_changeset != 0);
-					bool haveUids       = (denseNodes->denseinfo->n_uid       != 0);
-					bool haveUserSids   = (denseNodes->denseinfo->n_user_sid  != 0);
-					bool haveVisibles   = (denseNodes->denseinfo->n_visible   != 0);
-					if (haveVersions   && denseNodes->n_id != denseNodes->denseinfo->n_version)   { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match info->version count %zu",   blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_version);   result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
-					if (haveTimestamps && denseNodes->n_id != denseNodes->denseinfo->n_timestamp) { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match info->timestamp count %zu", blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_timestamp); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
-					if (haveChangesets && denseNodes->n_id != denseNodes->denseinfo->n_changeset) { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match info->changeset count %zu", blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_changeset); result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
-					if (haveUids       && denseNodes->n_id != denseNodes->denseinfo->n_uid)       { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match info->uid count %zu",       blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_uid);       result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
-					if (haveUserSids   && denseNodes->n_id != denseNodes->denseinfo->n_user_sid)  { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match info->user_sid count %zu",  blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_user_sid);  result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
-					if (haveVisibles   && denseNodes->n_id != denseNodes->denseinfo->n_visible)   { NotifyPrint_E("DenseNode in blob[%llu] ID count %zu doesn't match info->visible count %zu",   blobIndex, denseNodes->n_id, denseNodes->denseinfo->n_visible);   result = Result_Mismatch; TracyCZoneEnd(Zone_OsmDenseNodes); break; }
 					
-					VarArrayExpand(&mapOut->nodes, mapOut->nodes.length + (uxx)denseNodes->n_id);
+					//NOTE: The first way is compared against the last way in the map during the Merge stage
+					if (prevWayId != 0 && prevWayId >= (u64)way->id) { group->areWaysSorted = false; }
+					prevWayId = (u64)way->id;
 					
-					size_t currentKeyValIndex = 0;
-					
-					bool areNewNodesSorted = true;
-					i64 prevNodeId = 0;
-					i64 prevNodeLat = 0;
-					i64 prevNodeLon = 0;
-					i32 prevNodeVersion = 0;
-					i64 prevNodeTimestamp = 0;
-					i64 prevNodeChangeset = 0;
-					i32 prevNodeUid = 0;
-					i32 prevNodeUserSid = 0;
-					for (size_t nIndex = 0; nIndex < denseNodes->n_id; nIndex++)
+					v2d* wayLocations = nullptr;
+					if (way->n_lat == numNodesInWay && way->n_lon == numNodesInWay)
 					{
-						i64 nodeId = prevNodeId + denseNodes->id[nIndex];
-						i64 nodeLat = prevNodeLat + denseNodes->lat[nIndex];
-						i64 nodeLon = prevNodeLon + denseNodes->lon[nIndex];
-						i32 nodeVersion   = (haveVersions   ? prevNodeVersion   + denseNodes->denseinfo->version[nIndex]   : -1);
-						i64 nodeTimestamp = (haveTimestamps ? prevNodeTimestamp + denseNodes->denseinfo->timestamp[nIndex] : 0);
-						i64 nodeChangeset = (haveChangesets ? prevNodeChangeset + denseNodes->denseinfo->changeset[nIndex] : 0);
-						i32 nodeUid       = (haveUids       ? prevNodeUid       + denseNodes->denseinfo->uid[nIndex]       : 0);
-						i32 nodeUserSid   = (haveUserSids   ? prevNodeUserSid   + denseNodes->denseinfo->user_sid[nIndex]  : 0);
-						bool nodeVisible  = (haveVisibles   ? denseNodes->denseinfo->visible[nIndex]   : true);
-						if (nodeId <= 0) { NotifyPrint_E("Invalid Node ID %lld in blob[%llu] group[%zu] denseNode[%zu]!", nodeId, blobIndex, gIndex, nIndex); result = Result_InvalidID; break; }
-						if (nodeVersion < -1) { NotifyPrint_E("Invalid Node Version %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeVersion, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
-						if (nodeTimestamp < 0) { NotifyPrint_E("Invalid Node Timestamp %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeTimestamp, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
-						if (nodeChangeset < 0) { NotifyPrint_E("Invalid Node Changeset %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeChangeset, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
-						if (nodeUid < 0) { NotifyPrint_E("Invalid Node UID %d in blob[%llu] group[%zu] denseNode[%zu]!", nodeUid, blobIndex, gIndex, nIndex); result = Result_ValueTooLow; break; }
-						
-						if (nIndex == 0)
+						wayLocations = AllocArray(v2d, scratch, numNodesInWay);
+						NotNull(wayLocations);
+						i64 wayLat = 0;
+						i64 wayLon = 0;
+						for (size_t rIndex = 0; rIndex < way->n_refs; rIndex++)
 						{
-							OsmNode* lastNode = VarArrayGetLastSoft(OsmNode, &mapOut->nodes);
-							if (lastNode != nullptr && lastNode->id >= (u64)nodeId) { areNewNodesSorted = false; }
+							wayLat += way->lat[rIndex];
+							wayLon += way->lon[rIndex];
+							wayLocations[rIndex] = MakeV2d(
+								nodeOffset.x + ((r64)wayLon * granularityMult),
+								nodeOffset.y + ((r64)wayLat * granularityMult)
+							);
 						}
-						else if (prevNodeId >= nodeId) { areNewNodesSorted = false; }
-						v2d nodeLocation = MakeV2d(
-							nodeOffset.x + ((r64)nodeLon * granularityMult),
-							nodeOffset.y + ((r64)nodeLat * granularityMult)
-						);
-						// if (nIndex < 10) { PrintLine_D("Node[%lld]: (%lld, %lld) -> (%lf, %lf) -> (%lf, %lf)", nodeId, nodeLat, nodeLon, (r64)nodeLon * granularityMult, (r64)nodeLat * granularityMult, nodeLocation.x, nodeLocation.y); }
-						
-						OsmNode* newNode = AddOsmNode(mapOut, nodeLocation, (u64)nodeId);
-						newNode->visible = nodeVisible;
-						newNode->version = nodeVersion;
-						newNode->changeset = (u64)nodeChangeset;
-						// TODO: Str8 timestampStr;
-						// TODO: Str8 user;
-						newNode->uid = (u64)nodeUid;
-						
-						//Find node tags by walking keys_vals list 2 at a time until we find a 0 entry
-						while (currentKeyValIndex <= denseNodes->n_keys_vals)
-						{
-							i32 keyStringId = denseNodes->keys_vals[currentKeyValIndex+0];
-							if (keyStringId == 0 || currentKeyValIndex+1 >= denseNodes->n_keys_vals) { currentKeyValIndex++; break; } // 0 entry denotes following tags are for next node
-							i32 valStringId = denseNodes->keys_vals[currentKeyValIndex+1];
-							currentKeyValIndex += 2;
-							Str8 keyStr = GetPbfString(primitiveBlock->stringtable, keyStringId);
-							if (!IsEmptyStr(keyStr))
-							{
-								Str8 valueStr = GetPbfString(primitiveBlock->stringtable, valStringId);
-								OsmTag* newTag = VarArrayAdd(OsmTag, &newNode->tags);
-								NotNull(newTag);
-								ClearPointer(newTag);
-								newTag->key = AllocStr8(arena, keyStr);
-								newTag->value = AllocStr8(arena, valueStr);
-							}
-						}
-						
-						prevNodeId = nodeId;
-						prevNodeLat = nodeLat;
-						prevNodeLon = nodeLon;
-						prevNodeVersion = nodeVersion;
-						prevNodeTimestamp = nodeTimestamp;
-						prevNodeChangeset = nodeChangeset;
-						prevNodeUid = nodeUid;
-						prevNodeUserSid = nodeUserSid;
 					}
-					TracyCZoneEnd(Zone_OsmDenseNodes);
-					if (result != Result_None) { break; }
-					if (currentKeyValIndex < denseNodes->n_keys_vals) { NotifyPrint_W("There were %zu/%zu tags left over after parsing %zu denseNodes in blob[%llu]", denseNodes->n_keys_vals - currentKeyValIndex, denseNodes->n_keys_vals, denseNodes->n_id, blobIndex); }
+					else if (way->n_lat != 0 || way->n_lon != 0) { PbfStagedWarning(block, "Way[%zu] in blob[%llu] has %zu lat and %zu lon for %zu node refs, ignoring them", wIndex, blobIndex, way->n_lat, way->n_lon, way->n_refs); }
 					
-					if (!areNewNodesSorted || !mapOut->areNodesSorted)
+					PbfStagedWay* stagedWay = &group->ways[group->numWays];
+					group->numWays++;
+					stagedWay->id = (u64)way->id;
+					stagedWay->visible = (way->info->has_visible ? way->info->visible : true);
+					stagedWay->version = (way->info->has_version ? way->info->version : -1);
+					//TODO: Str8 timestampStr; stagedWay->timestamp = (way->info->has_timestamp ? (u64)way->info->timestamp : 0);
+					stagedWay->uid = (way->info->has_uid ? (u64)way->info->uid : 0);
+					//TODO: Str8 user; stagedWay->user = (way->info->has_user_sid ? LookupString(way->info->user_sid) : Str8_Empty);
+					stagedWay->changeset = (way->info->has_changeset ? (u64)way->info->changeset : 0);
+					stagedWay->numNodes = numNodesInWay;
+					stagedWay->nodeIds = nodeIds;
+					stagedWay->locations = wayLocations;
+					stagedWay->numTags = 0;
+					stagedWay->tags = (way->n_keys > 0) ? AllocArray(PbfStagedTag, scratch, (uxx)way->n_keys) : nullptr;
+					for (size_t tIndex = 0; tIndex < way->n_keys; tIndex++)
 					{
-						TracyCZoneN(Zone_SortNodes, "SortNodes", true);
-						QuickSortVarArrayUintMember(OsmNode, id, &mapOut->nodes);
-						mapOut->areNodesSorted = true;
-						TracyCZoneEnd(Zone_SortNodes);
-						
-						//TODO: We really should be waiting till the end of parsing the entire file before hook up NodeRefs with valid pointers
-						if (mapOut->ways.length > 0)
+						Str8 keyStr = GetPbfString(primitiveBlock->stringtable, way->keys[tIndex]);
+						if (!IsEmptyStr(keyStr))
 						{
-							TracyCZoneN(_FixNodeRefs, "FixNodeRefs", true);
-							VarArrayLoop(&mapOut->ways, wIndex)
-							{
-								VarArrayLoopGet(OsmWay, way, &mapOut->ways, wIndex);
-								VarArrayLoop(&way->nodes, nIndex)
-								{
-									VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
-									nodeRef->pntr = FindOsmNode(mapOut, nodeRef->id);
-								}
-							}
-							TracyCZoneEnd(_FixNodeRefs);
+							PbfStagedTag* newTag = &stagedWay->tags[stagedWay->numTags];
+							newTag->keyId = way->keys[tIndex];
+							newTag->valueId = GetPbfStagedStringId(&block->stringTable, way->vals[tIndex]);
+							stagedWay->numTags++;
 						}
 					}
 				}
-				
-				// +==============================+
-				// |           PBF Ways           |
-				// +==============================+
-				if (primitiveGroup->n_ways > 0)
+				else { PbfStagedWarning(block, "Way[%zu] in blob[%llu] had no node references!", wIndex, blobIndex); }
+			}
+			TracyCZoneEnd(Zone_OsmWays);
+			if (result != Result_None) { break; }
+		}
+		
+		// +==============================+
+		// |        PBF Relations         |
+		// +==============================+
+		if (primitiveGroup->n_relations > 0)
+		{
+			TracyCZoneN(Zone_OsmRelations, "OsmRelations", true);
+			group->hasRelations = true;
+			group->areRelationsSorted = true;
+			group->relations = AllocArray(PbfStagedRelation, scratch, (uxx)primitiveGroup->n_relations);
+			NotNull(group->relations);
+			u64 prevRelationId = 0;
+			for (size_t rIndex = 0; rIndex < primitiveGroup->n_relations; rIndex++)
+			{
+				OSMPBF__Relation* relation = primitiveGroup->relations[rIndex];
+				NotNull(relation->info);
+				if (relation->id <= 0)                                              { PbfStagedError(block, "Relation[%zu] in blob[%llu] has invalid ID %lld", rIndex, blobIndex, relation->id); result = Result_InvalidID; break; }
+				if (relation->info->has_timestamp && relation->info->timestamp < 0) { PbfStagedError(block, "Relation[%zu] in blob[%llu] has invalid timestamp %lld", rIndex, blobIndex, relation->info->timestamp); result = Result_ValueTooLow; break; }
+				if (relation->info->has_uid       && relation->info->uid       < 0) { PbfStagedError(block, "Relation[%zu] in blob[%llu] has invalid uid %d", rIndex, blobIndex, relation->info->uid); result = Result_ValueTooLow; break; }
+				if (relation->info->has_changeset && relation->info->changeset < 0) { PbfStagedError(block, "Relation[%zu] in blob[%llu] has invalid changeset %lld", rIndex, blobIndex, relation->info->changeset); result = Result_ValueTooLow; break; }
+				if (relation->n_keys != relation->n_vals)                           { PbfStagedError(block, "Relation[%zu] in blob[%llu] key count %zu doesn't match value count %zu", rIndex, blobIndex, relation->n_keys, relation->n_vals); result = Result_Mismatch; break; }
+				if (relation->n_memids != relation->n_roles_sid)                    { PbfStagedError(block, "Relation[%zu] in blob[%llu] member ID count %zu doesn't match roles SID count %zu", rIndex, blobIndex, relation->n_memids, relation->n_roles_sid); result = Result_Mismatch; break; }
+				if (relation->n_memids != relation->n_types)                        { PbfStagedError(block, "Relation[%zu] in blob[%llu] member ID count %zu doesn't match types count %zu", rIndex, blobIndex, relation->n_memids, relation->n_types); result = Result_Mismatch; break; }
+				if (relation->n_memids > 0)
 				{
-					TracyCZoneN(Zone_OsmWays, "OsmWays", true);
-					bool areNewWaysSorted = true;
-					u64 prevWayId = 0;
-					for (size_t wIndex = 0; wIndex < primitiveGroup->n_ways; wIndex++)
+					//NOTE: The first relation is compared against the last relation in the map during the Merge stage
+					if (prevRelationId != 0 && prevRelationId >= (u64)relation->id) { group->areRelationsSorted = false; }
+					prevRelationId = (u64)relation->id;
+					
+					PbfStagedRelation* stagedRelation = &group->relations[group->numRelations];
+					group->numRelations++;
+					stagedRelation->id = (u64)relation->id;
+					stagedRelation->visible = (relation->info->has_visible ? relation->info->visible : true);
+					stagedRelation->version = (relation->info->has_version ? relation->info->version : -1);
+					//TODO: Str8 timestampStr; stagedRelation->timestamp = (relation->info->has_timestamp ? (u64)relation->info->timestamp : 0);
+					stagedRelation->uid = (relation->info->has_uid ? (u64)relation->info->uid : 0);
+					//TODO: Str8 user; stagedRelation->user = (relation->info->has_user_sid ? LookupString(relation->info->user_sid) : Str8_Empty);
+					stagedRelation->changeset = (relation->info->has_changeset ? (u64)relation->info->changeset : 0);
+					stagedRelation->numTags = 0;
+					stagedRelation->tags = (relation->n_keys > 0) ? AllocArray(PbfStagedTag, scratch, (uxx)relation->n_keys) : nullptr;
+					for (size_t tIndex = 0; tIndex < relation->n_keys; tIndex++)
 					{
-						OSMPBF__Way* way = primitiveGroup->ways[wIndex];
-						NotNull(way->info);
-						if (way->id <= 0)                                         { NotifyPrint_E("Way[%zu] in blob[%llu] has invalid ID %lld",        wIndex, blobIndex, way->id); result = Result_InvalidID; break; }
-						if (way->info->has_timestamp && way->info->timestamp < 0) { NotifyPrint_E("Way[%zu] in blob[%llu] has invalid timestamp %lld", wIndex, blobIndex, way->info->timestamp); result = Result_ValueTooLow; break; }
-						if (way->info->has_uid       && way->info->uid       < 0) { NotifyPrint_E("Way[%zu] in blob[%llu] has invalid uid %d",         wIndex, blobIndex, way->info->uid); result = Result_ValueTooLow; break; }
-						if (way->info->has_changeset && way->info->changeset < 0) { NotifyPrint_E("Way[%zu] in blob[%llu] has invalid changeset %lld", wIndex, blobIndex, way->info->changeset); result = Result_ValueTooLow; break; }
-						if (way->n_keys != way->n_vals)                           { NotifyPrint_E("Way[%zu] in blob[%llu] key count %zu doesn't match value count %zu", wIndex, blobIndex, way->n_keys, way->n_vals); result = Result_Mismatch; break; }
-						if (way->n_refs > 0)
+						Str8 keyStr = GetPbfString(primitiveBlock->stringtable, relation->keys[tIndex]);
+						if (!IsEmptyStr(keyStr))
 						{
-							uxx scratchMark2 = ArenaGetMark(scratch);
-							uxx numNodesInWay = (uxx)way->n_refs;
-							u64* nodeIds = AllocArray(u64, scratch, numNodesInWay);
-							NotNull(nodeIds);
-							u64 prevNodeId = 0;
-							for (size_t rIndex = 0; rIndex < way->n_refs; rIndex++)
-							{
-								if (way->refs[rIndex] < -(i64)prevNodeId) { NotifyPrint_E("Node[%zu] in Way[%zu] in blob[%llu] has negative ID %llu%s%lld", rIndex, wIndex, blobIndex, prevNodeId, (way->refs[rIndex] >= 0) ? "+" : "", way->refs[rIndex]); result = Result_InvalidID; break; }
-								if (way->refs[rIndex] > 0 && (u64)way->refs[rIndex] > UINT64_MAX - prevNodeId) { NotifyPrint_E("Node[%zu] in Way[%zu] in blob[%llu] has overflow ID %llu%s%lld", rIndex, wIndex, blobIndex, prevNodeId, (way->refs[rIndex] >= 0) ? "+" : "", way->refs[rIndex]); result = Result_InvalidID; break; }
-								nodeIds[rIndex] = (u64)(prevNodeId + way->refs[rIndex]);
-								prevNodeId = nodeIds[rIndex];
-							}
-							if (result != Result_None) { ArenaResetToMark(scratch, scratchMark2); break; }
-							
-							if (prevWayId == 0)
-							{
-								OsmWay* lastWay = VarArrayGetLastSoft(OsmWay, &mapOut->ways);
-								if (lastWay != nullptr && lastWay->id >= (u64)way->id) { areNewWaysSorted = false; }
-							}
-							else if (prevWayId >= (u64)way->id) { areNewWaysSorted = false; }
-							prevWayId = (u64)way->id;
-							
-							//TODO: Handle "LocationsOnWays" feature by looking at n_lat,n_lon and disregarding if the IDs map to nodes we loaded!
-							OsmWay* newWay = AddOsmWay(mapOut, (u64)way->id, numNodesInWay, nodeIds);
-							newWay->visible = (way->info->has_visible ? way->info->visible : true);
-							newWay->version = (way->info->has_version ? way->info->version : -1);
-							//TODO: Str8 timestampStr; newWay->timestamp = (way->info->has_timestamp ? (u64)way->info->timestamp : 0);
-							newWay->uid = (way->info->has_uid ? (u64)way->info->uid : 0);
-							//TODO: Str8 user; newWay->user = (way->info->has_user_sid ? LookupString(way->info->user_sid) : Str8_Empty);
-							newWay->changeset = (way->info->has_changeset ? (u64)way->info->changeset : 0);
-							VarArrayExpand(&newWay->tags, newWay->tags.length + (uxx)way->n_keys);
-							for (size_t tIndex = 0; tIndex < way->n_keys; tIndex++)
-							{
-								Str8 keyStr = GetPbfString(primitiveBlock->stringtable, way->keys[tIndex]);
-								if (!IsEmptyStr(keyStr))
-								{
-									Str8 valueStr = GetPbfString(primitiveBlock->stringtable, way->vals[tIndex]);
-									OsmTag* newTag = VarArrayAdd(OsmTag, &newWay->tags);
-									NotNull(newTag);
-									ClearPointer(newTag);
-									newTag->key = AllocStr8(arena, keyStr);
-									newTag->value = AllocStr8(arena, valueStr);
-								}
-							}
-							
-							ArenaResetToMark(scratch, scratchMark2);
+							PbfStagedTag* newTag = &stagedRelation->tags[stagedRelation->numTags];
+							newTag->keyId = relation->keys[tIndex];
+							newTag->valueId = GetPbfStagedStringId(&block->stringTable, relation->vals[tIndex]);
+							stagedRelation->numTags++;
 						}
-						else { PrintLine_W("Way[%zu] in blob[%llu] had no node references!", wIndex, blobIndex); }
 					}
-					TracyCZoneEnd(Zone_OsmWays);
-					if (result != Result_None) { break; }
 					
-					if (!areNewWaysSorted || !mapOut->areWaysSorted)
+					stagedRelation->numMembers = 0;
+					stagedRelation->members = AllocArray(PbfStagedMember, scratch, (uxx)relation->n_memids);
+					NotNull(stagedRelation->members);
+					i64 prevMemberId = 0;
+					for (size_t mIndex = 0; mIndex < relation->n_memids; mIndex++)
 					{
-						TracyCZoneN(Zone_SortWays, "SortWays", true);
-						QuickSortVarArrayUintMember(OsmWay, id, &mapOut->ways);
-						mapOut->areWaysSorted = true;
-						TracyCZoneEnd(Zone_SortWays);
-					}
-				}
-				
-				// +==============================+
-				// |        PBF Relations         |
-				// +==============================+
-				if (primitiveGroup->n_relations > 0)
-				{
-					TracyCZoneN(Zone_OsmRelations, "OsmRelations", true);
-					bool areNewRelationsSorted = true;
-					u64 prevRelationId = 0;
-					for (size_t rIndex = 0; rIndex < primitiveGroup->n_relations; rIndex++)
-					{
-						OSMPBF__Relation* relation = primitiveGroup->relations[rIndex];
-						NotNull(relation->info);
-						if (relation->id <= 0)                                              { NotifyPrint_E("Relation[%zu] in blob[%llu] has invalid ID %lld", rIndex, blobIndex, relation->id); result = Result_InvalidID; break; }
-						if (relation->info->has_timestamp && relation->info->timestamp < 0) { NotifyPrint_E("Relation[%zu] in blob[%llu] has invalid timestamp %lld", rIndex, blobIndex, relation->info->timestamp); result = Result_ValueTooLow; break; }
-						if (relation->info->has_uid       && relation->info->uid       < 0) { NotifyPrint_E("Relation[%zu] in blob[%llu] has invalid uid %d", rIndex, blobIndex, relation->info->uid); result = Result_ValueTooLow; break; }
-						if (relation->info->has_changeset && relation->info->changeset < 0) { NotifyPrint_E("Relation[%zu] in blob[%llu] has invalid changeset %lld", rIndex, blobIndex, relation->info->changeset); result = Result_ValueTooLow; break; }
-						if (relation->n_keys != relation->n_vals)                           { NotifyPrint_E("Relation[%zu] in blob[%llu] key count %zu doesn't match value count %zu", rIndex, blobIndex, relation->n_keys, relation->n_vals); result = Result_Mismatch; break; }
-						if (relation->n_memids != relation->n_roles_sid)                    { NotifyPrint_E("Relation[%zu] in blob[%llu] member ID count %zu doesn't match roles SID count %zu", rIndex, blobIndex, relation->n_memids, relation->n_roles_sid); result = Result_Mismatch; break; }
-						if (relation->n_memids != relation->n_types)                        { NotifyPrint_E("Relation[%zu] in blob[%llu] member ID count %zu doesn't match types count %zu", rIndex, blobIndex, relation->n_memids, relation->n_types); result = Result_Mismatch; break; }
-						if (relation->n_memids > 0)
+						Str8 roleStr = GetPbfString(primitiveBlock->stringtable, relation->roles_sid[mIndex]);
+						i64 memberId = prevMemberId + relation->memids[mIndex];
+						prevMemberId = memberId;
+						OSMPBF__Relation__MemberType memberType = relation->types[mIndex];
+						
+						OsmRelationMemberRole role = OsmRelationMemberRole_None;
+						if (!IsEmptyStr(roleStr))
 						{
-							if (prevRelationId == 0)
-							{
-								OsmRelation* lastRelation = VarArrayGetLastSoft(OsmRelation, &mapOut->relations);
-								if (lastRelation != nullptr && lastRelation->id >= (u64)relation->id) { areNewRelationsSorted = false; }
-							}
-							else if (prevRelationId >= (u64)relation->id) { areNewRelationsSorted = false; }
-							prevRelationId = (u64)relation->id;
-							
-							OsmRelation* newRelation = AddOsmRelation(mapOut, (u64)relation->id, (uxx)relation->n_memids);
-							newRelation->visible = (relation->info->has_visible ? relation->info->visible : true);
-							newRelation->version = (relation->info->has_version ? relation->info->version : -1);
-							//TODO: Str8 timestampStr; newRelation->timestamp = (relation->info->has_timestamp ? (u64)relation->info->timestamp : 0);
-							newRelation->uid = (relation->info->has_uid ? (u64)relation->info->uid : 0);
-							//TODO: Str8 user; newRelation->user = (relation->info->has_user_sid ? LookupString(relation->info->user_sid) : Str8_Empty);
-							newRelation->changeset = (relation->info->has_changeset ? (u64)relation->info->changeset : 0);
-							VarArrayExpand(&newRelation->tags, newRelation->tags.length + (uxx)relation->n_keys);
-							for (size_t tIndex = 0; tIndex < relation->n_keys; tIndex++)
+							for (uxx roleIndex = 1; roleIndex < OsmRelationMemberRole_Count; roleIndex++)
 							{
-								Str8 keyStr = GetPbfString(primitiveBlock->stringtable, relation->keys[tIndex]);
-								if (!IsEmptyStr(keyStr))
+								const char* roleEnumStrNt = GetOsmRelationMemberRoleXmlStr((OsmRelationMemberRole)roleIndex);
+								if (StrAnyCaseEquals(roleStr, MakeStr8Nt(roleEnumStrNt)))
 								{
-									Str8 valueStr = GetPbfString(primitiveBlock->stringtable, relation->vals[tIndex]);
-									OsmTag* newTag = VarArrayAdd(OsmTag, &newRelation->tags);
-									NotNull(newTag);
-									ClearPointer(newTag);
-									newTag->key = AllocStr8(arena, keyStr);
-									newTag->value = AllocStr8(arena, valueStr);
+									role = (OsmRelationMemberRole)roleIndex;
+									break;
 								}
 							}
-							
-							i64 prevMemberId = 0;
-							for (size_t mIndex = 0; mIndex < relation->n_memids; mIndex++)
+							if (role == OsmRelationMemberRole_None) { PbfStagedWarning(block, "Warning: Uknown role type \"%.*s\" on member[%llu] in relation[%zu] in blob[%llu]", StrPrint(roleStr), mIndex, rIndex, blobIndex); }
+						}
+						
+						if (memberId <= 0) { PbfStagedError(block, "Member[%zu] in Relation[%zu] in blob[%llu] has invalid ID %lld", mIndex, rIndex, blobIndex, memberId); result = Result_InvalidID; break; }
+						else
+						{
+							PbfStagedMember* stagedMember = &stagedRelation->members[stagedRelation->numMembers];
+							stagedRelation->numMembers++;
+							stagedMember->id = (u64)memberId;
+							stagedMember->role = role;
+							switch (memberType)
 							{
-								Str8 roleStr = GetPbfString(primitiveBlock->stringtable, relation->roles_sid[mIndex]);
-								i64 memberId = prevMemberId + relation->memids[mIndex];
-								prevMemberId = memberId;
-								OSMPBF__Relation__MemberType memberType = relation->types[mIndex];
-								
-								OsmRelationMemberRole role = OsmRelationMemberRole_None;
-								if (!IsEmptyStr(roleStr))
-								{
-									for (uxx roleIndex = 1; roleIndex < OsmRelationMemberRole_Count; roleIndex++)
-									{
-										const char* roleEnumStrNt = GetOsmRelationMemberRoleXmlStr((OsmRelationMemberRole)roleIndex);
-										if (StrAnyCaseEquals(roleStr, MakeStr8Nt(roleEnumStrNt)))
-										{
-											role = (OsmRelationMemberRole)roleIndex;
-											break;
-										}
-									}
-									if (role == OsmRelationMemberRole_None) { PrintLine_W("Warning: Uknown role type \"%.*s\" on member[%llu] in relation[%zu] in blob[%llu]", StrPrint(roleStr), mIndex, rIndex, blobIndex); }
-								}
-								
-								if (memberId <= 0) { NotifyPrint_E("Member[%zu] in Relation[%zu] in blob[%llu] has invalid ID %lld", mIndex, rIndex, blobIndex, memberId); result = Result_InvalidID; break; }
-								else
-								{
-									OsmRelationMember* newMember = VarArrayAdd(OsmRelationMember, &newRelation->members);
-									NotNull(newMember);
-									ClearPointer(newMember);
-									newMember->id = (u64)memberId;
-									newMember->role = role;
-									newMember->pntr = nullptr; //We'll look it up later
-									switch (memberType)
-									{
-										case OSMPBF__RELATION__MEMBER_TYPE__NODE: newMember->type = OsmRelationMemberType_Node; break;
-										case OSMPBF__RELATION__MEMBER_TYPE__WAY: newMember->type = OsmRelationMemberType_Way; break;
-										case OSMPBF__RELATION__MEMBER_TYPE__RELATION: newMember->type = OsmRelationMemberType_Relation; break;
-										default: NotifyPrint_E("Member[%zu] in Relation[%zu] in blob[%llu] has unhandled type %d", mIndex, rIndex, blobIndex, memberType); result = Result_InvalidType; break;
-									}
-									if (result != Result_None) { break; }
-								}
+								case OSMPBF__RELATION__MEMBER_TYPE__NODE: stagedMember->type = OsmRelationMemberType_Node; break;
+								case OSMPBF__RELATION__MEMBER_TYPE__WAY: stagedMember->type = OsmRelationMemberType_Way; break;
+								case OSMPBF__RELATION__MEMBER_TYPE__RELATION: stagedMember->type = OsmRelationMemberType_Relation; break;
+								default: PbfStagedError(block, "Member[%zu] in Relation[%zu] in blob[%llu] has unhandled type %d", mIndex, rIndex, blobIndex, memberType); result = Result_InvalidType; break;
 							}
 							if (result != Result_None) { break; }
 						}
-						else { PrintLine_W("Relation[%zu] in blob[%llu] had no members!", rIndex, blobIndex); }
-					}
-					TracyCZoneEnd(Zone_OsmRelations);
-					if (result != Result_None) { break; }
-					
-					if (!areNewRelationsSorted || !mapOut->areRelationsSorted)
-					{
-						TracyCZoneN(Zone_SortRelations, "SortRelations", true);
-						QuickSortVarArrayUintMember(OsmRelation, id, &mapOut->relations);
-						mapOut->areRelationsSorted = true;
-						TracyCZoneEnd(Zone_SortRelations);
-					}
-				}
-				
-				// +==============================+
-				// |        PBF Changesets        |
-				// +==============================+
-				if (primitiveGroup->n_changesets > 0)
-				{
-					TracyCZoneN(Zone_OsmChangesets, "OsmChangesets", true);
-					for (size_t cIndex = 0; cIndex < primitiveGroup->n_changesets; cIndex++)
-					{
-						OSMPBF__ChangeSet* changeset = primitiveGroup->changesets[cIndex];
-						UNUSED(changeset); //TODO: Implement me!
 					}
-					TracyCZoneEnd(Zone_OsmChangesets);
 					if (result != Result_None) { break; }
 				}
+				else { PbfStagedWarning(block, "Relation[%zu] in blob[%llu] had no members!", rIndex, blobIndex); }
 			}
+			TracyCZoneEnd(Zone_OsmRelations);
 			if (result != Result_None) { break; }
-			
-			foundOsmData = true;
 		}
-		else { PrintLine_W("Unhandled blob type \"%s\"", blobHeader->type); foundUnkownBlobTypes = true; }
 		
-		ArenaResetToMark(scratch, scratchMark1);
-		blobIndex++;
+		// +==============================+
+		// |        PBF Changesets        |
+		// +==============================+
+		if (primitiveGroup->n_changesets > 0)
+		{
+			TracyCZoneN(Zone_OsmChangesets, "OsmChangesets", true);
+			for (size_t cIndex = 0; cIndex < primitiveGroup->n_changesets; cIndex++)
+			{
+				OSMPBF__ChangeSet* changeset = primitiveGroup->changesets[cIndex];
+				UNUSED(changeset); //TODO: ChangeSet messages only carry an id and we don't store changesets yet
+			}
+			TracyCZoneEnd(Zone_OsmChangesets);
+			if (result != Result_None) { break; }
+		}
 	}
 	
-	if (result != Result_None) { NotifyPrint_E("Got through %llu blobs before encountering: %s", blobIndex, GetResultStr(result)); }
-	if (!foundOsmData) { result = foundOsmHeader ? (foundUnkownBlobTypes ? Result_WrongInternalFormat : Result_MissingData) : Result_MissingHeader; }
-	if (result == Result_None)
+	TracyCZoneEnd(Zone_Func);
+	return result;
+}
+
+// +--------------------------------------------------------------+
+// |                  Direct PrimitiveBlock Decoder               |
+// +--------------------------------------------------------------+
+#define GetPbfTableString(tablePntr, stringId) \
+(                                              \
+	((stringId) > 0 && (uxx)(stringId) < (tablePntr)->numStrings) \
+	? (tablePntr)->strings[(stringId)]         \
+	: Str8_Empty                               \
+)
+
+typedef plex PbfDirectInfo PbfDirectInfo;
+plex PbfDirectInfo
+{
+	bool hasVersion;   i32 version;
+	bool hasTimestamp; i64 timestamp;
+	bool hasChangeset; i64 changeset;
+	bool hasUid;       i32 uid;
+	bool hasUserSid;   u32 userSid;
+	bool hasVisible;   bool visible;
+};
+
+typedef plex PbfDirectDecoder PbfDirectDecoder;
+plex PbfDirectDecoder
+{
+	PbfStagedBlock* block;
+	PbfStringTable stringTable;
+	PbfKernelLevel kernelLevel; //already resolved, never Auto
+	r64 granularityMult;
+	v2d nodeOffset;
+	bool isSupported; //set to false when we find something we should leave to the protobuf-c decoder
+	Result result;
+};
+
+bool TryParsePbfInfoDirect(Slice infoSlice, PbfDirectInfo* infoOut)
+{
+	ClearPointer(infoOut);
+	PbfWireReader reader = MakePbfWireReader(infoSlice);
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	while (PbfWireReadField(&reader, &fieldNumber, &wireType))
 	{
-		result = Result_Success;
-		VarArrayLoop(&mapOut->relations, rIndex)
+		if (fieldNumber >= 1 && fieldNumber <= 6 && wireType != PbfWireType_Varint) { return false; }
+		switch (fieldNumber)
 		{
-			VarArrayLoopGet(OsmRelation, relation, &mapOut->relations, rIndex);
-			UpdateOsmRelationPntrs(mapOut, relation);
+			case 1: infoOut->hasVersion   = true; infoOut->version   = (i32)PbfWireReadVarint(&reader); break;
+			case 2: infoOut->hasTimestamp = true; infoOut->timestamp = (i64)PbfWireReadVarint(&reader); break;
+			case 3: infoOut->hasChangeset = true; infoOut->changeset = (i64)PbfWireReadVarint(&reader); break;
+			case 4: infoOut->hasUid       = true; infoOut->uid       = (i32)PbfWireReadVarint(&reader); break;
+			case 5: infoOut->hasUserSid   = true; infoOut->userSid   = (u32)PbfWireReadVarint(&reader); break;
+			case 6: infoOut->hasVisible   = true; infoOut->visible   = (PbfWireReadVarint(&reader) != 0); break;
+			default: PbfWireSkipField(&reader, wireType); break;
 		}
-		UpdateOsmNodeWayBackPntrs(mapOut);
-		UpdateOsmRelationBackPntrs(mapOut);
 	}
-	else if (foundOsmHeader) { FreeOsmMap(mapOut); }
-	ScratchEnd(scratch);
-	TracyCZoneEnd(Zone_Func);
-	return result;
+	return !reader.isError;
+}
+
+void DecodePbfDenseNodesDirect(PbfDirectDecoder* decoder, PbfStagedGroup* group, uxx gIndex, Slice denseSlice)
+{
+	TracyCZoneN(Zone_Func, "OsmDenseNodes", true);
+	PbfStagedBlock* block = decoder->block;
+	Arena* scratch = block->arena;
+	uxx blobIndex = block->blobIndex;
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	
+	PbfPackedField ids = ZEROED;
+	PbfPackedField lats = ZEROED;
+	PbfPackedField lons = ZEROED;
+	PbfPackedField keysVals = ZEROED;
+	bool foundInfo = false;
+	Slice infoSlice = Slice_Empty;
+	PbfWireReader reader = MakePbfWireReader(denseSlice);
+	while (decoder->isSupported && PbfWireReadField(&reader, &fieldNumber, &wireType))
+	{
+		switch (fieldNumber)
+		{
+			case 1:  decoder->isSupported = TryReadPbfPackedField(&reader, wireType, &ids); break;
+			case 8:  decoder->isSupported = TryReadPbfPackedField(&reader, wireType, &lats); break;
+			case 9:  decoder->isSupported = TryReadPbfPackedField(&reader, wireType, &lons); break;
+			case 10: decoder->isSupported = TryReadPbfPackedField(&reader, wireType, &keysVals); break;
+			case 5:
+			{
+				if (wireType != PbfWireType_LengthDelimited || foundInfo) { decoder->isSupported = false; break; }
+				infoSlice = PbfWireReadSlice(&reader);
+				foundInfo = true;
+			} break;
+			default: PbfWireSkipField(&reader, wireType); break;
+		}
+	}
+	if (reader.isError) { decoder->isSupported = false; }
+	
+	PbfPackedField versions = ZEROED;
+	PbfPackedField timestamps = ZEROED;
+	PbfPackedField changesets = ZEROED;
+	PbfPackedField uids = ZEROED;
+	PbfPackedField userSids = ZEROED;
+	PbfPackedField visibles = ZEROED;
+	if (decoder->isSupported && foundInfo)
+	{
+		PbfWireReader infoReader = MakePbfWireReader(infoSlice);
+		while (decoder->isSupported && PbfWireReadField(&infoReader, &fieldNumber, &wireType))
+		{
+			switch (fieldNumber)
+			{
+				case 1: decoder->isSupported = TryReadPbfPackedField(&infoReader, wireType, &versions); break;
+				case 2: decoder->isSupported = TryReadPbfPackedField(&infoReader, wireType, &timestamps); break;
+				case 3: decoder->isSupported = TryReadPbfPackedField(&infoReader, wireType, &changesets); break;
+				case 4: decoder->isSupported = TryReadPbfPackedField(&infoReader, wireType, &uids); break;
+				case 5: decoder->isSupported = TryReadPbfPackedField(&infoReader, wireType, &userSids); break;
+				case 6: decoder->isSupported = TryReadPbfPackedField(&infoReader, wireType, &visibles); break;
+				default: PbfWireSkipField(&infoReader, wireType); break;
+			}
+		}
+		if (infoReader.isError) { decoder->isSupported = false; }
+	}
+	if (!decoder->isSupported) { TracyCZoneEnd(Zone_Func); return; }
+	
+	if (ids.count != lats.count) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match Lat count %llu", blobIndex, ids.count, lats.count); decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	if (ids.count != lons.count) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match Lon count %llu", blobIndex, ids.count, lons.count); decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	bool haveVersions   = (versions.count   != 0);
+	bool haveTimestamps = (timestamps.count != 0);
+	bool haveChangesets = (changesets.count != 0);
+	bool haveUids       = (uids.count       != 0);
+	bool haveUserSids   = (userSids.count   != 0);
+	bool haveVisibles   = (visibles.count   != 0);
+	if (haveVersions   && ids.count != versions.count)   { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match info->version count %llu",   blobIndex, ids.count, versions.count);   decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	if (haveTimestamps && ids.count != timestamps.count) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match info->timestamp count %llu", blobIndex, ids.count, timestamps.count); decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	if (haveChangesets && ids.count != changesets.count) { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match info->changeset count %llu", blobIndex, ids.count, changesets.count); decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	if (haveUids       && ids.count != uids.count)       { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match info->uid count %llu",       blobIndex, ids.count, uids.count);       decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	if (haveUserSids   && ids.count != userSids.count)   { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match info->user_sid count %llu",  blobIndex, ids.count, userSids.count);   decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	if (haveVisibles   && ids.count != visibles.count)   { PbfStagedError(block, "DenseNode in blob[%llu] ID count %llu doesn't match info->visible count %llu",   blobIndex, ids.count, visibles.count);   decoder->result = Result_Mismatch; TracyCZoneEnd(Zone_Func); return; }
+	
+	group->hasNodes = true;
+	group->areNodesSorted = true;
+	group->numNodes = ids.count;
+	group->nodes = (group->numNodes > 0) ? AllocArray(PbfStagedNode, scratch, group->numNodes) : nullptr;
+	PbfStagedTag* tagsBuffer = (keysVals.count > 0) ? AllocArray(PbfStagedTag, scratch, (keysVals.count/2) + 1) : nullptr;
+	uxx numTagsUsed = 0;
+	if (ids.count == 0)
+	{
+		if (keysVals.count > 0) { PbfStagedNotifyWarning(block, "There were %llu/%llu tags left over after parsing %llu denseNodes in blob[%llu]", keysVals.count, keysVals.count, ids.count, blobIndex); }
+		TracyCZoneEnd(Zone_Func);
+		return;
+	}
+	
+	// +==============================+
+	// |     Decode Delta Columns     |
+	// +==============================+
+	TracyCZoneN(Zone_DeltaColumns, "DenseDeltaColumns", true);
+	PbfKernelLevel kernelLevel = decoder->kernelLevel;
+	i64* nodeIds        = AllocArray(i64, scratch, ids.count);
+	i64* nodeLats       = AllocArray(i64, scratch, ids.count);
+	i64* nodeLons       = AllocArray(i64, scratch, ids.count);
+	i64* nodeVersions   = haveVersions   ? AllocArray(i64, scratch, ids.count) : nullptr;
+	i64* nodeTimestamps = haveTimestamps ? AllocArray(i64, scratch, ids.count) : nullptr;
+	i64* nodeChangesets = haveChangesets ? AllocArray(i64, scratch, ids.count) : nullptr;
+	i64* nodeUids       = haveUids       ? AllocArray(i64, scratch, ids.count) : nullptr;
+	PbfDeltaColumnStats idStats = ZEROED;
+	PbfDeltaColumnStats latStats = ZEROED;
+	PbfDeltaColumnStats lonStats = ZEROED;
+	PbfDeltaColumnStats versionStats = ZEROED;
+	PbfDeltaColumnStats timestampStats = ZEROED;
+	PbfDeltaColumnStats changesetStats = ZEROED;
+	PbfDeltaColumnStats uidStats = ZEROED;
+	//NOTE: user_sid isn't stored or validated yet so we don't bother decoding that column
+	bool decodedColumns = (
+		DecodePbfDeltaColumn(kernelLevel, ids.slice, ids.count, nodeIds, &idStats) &&
+		DecodePbfDeltaColumn(kernelLevel, lats.slice, lats.count, nodeLats, &latStats) &&
+		DecodePbfDeltaColumn(kernelLevel, lons.slice, lons.count, nodeLons, &lonStats) &&
+		//NOTE: version is the only DenseInfo column that isn't delta coded (see osmformat.proto)
+		(!haveVersions   || DecodePbfInt32Column(kernelLevel, versions.slice,   versions.count,   nodeVersions,   &versionStats)) &&
+		(!haveTimestamps || DecodePbfDeltaColumn(kernelLevel, timestamps.slice, timestamps.count, nodeTimestamps, &timestampStats)) &&
+		(!haveChangesets || DecodePbfDeltaColumn(kernelLevel, changesets.slice, changesets.count, nodeChangesets, &changesetStats)) &&
+		(!haveUids       || DecodePbfDeltaColumn(kernelLevel, uids.slice,       uids.count,       nodeUids,       &uidStats))
+	);
+	TracyCZoneEnd(Zone_DeltaColumns);
+	if (!decodedColumns) { decoder->isSupported = false; TracyCZoneEnd(Zone_Func); return; }
+	
+	// +==============================+
+	// |      Validate Whole Batch    |
+	// +==============================+
+	//NOTE: uid is i32 in the .proto so the sums only match the per-node math if they stayed inside the i32 range
+	bool areAllNodesValid = (
+		idStats.minValue > 0 &&
+		(!haveVersions   || versionStats.minValue >= -1) &&
+		(!haveTimestamps || timestampStats.minValue >= 0) &&
+		(!haveChangesets || changesetStats.minValue >= 0) &&
+		(!haveUids       || (uidStats.minValue >= 0 && uidStats.maxValue <= INT32_MAX))
+	);
+	if (!areAllNodesValid)
+	{
+		//Something in this block is invalid, walk the nodes in order to find the first problem so we report exactly what the per-node checks would
+		for (uxx nIndex = 0; nIndex < ids.count; nIndex++)
+		{
+			i64 nodeId = nodeIds[nIndex];
+			i32 nodeVersion   = (haveVersions   ? (i32)nodeVersions[nIndex]   : -1);
+			i64 nodeTimestamp = (haveTimestamps ? nodeTimestamps[nIndex]      : 0);
+			i64 nodeChangeset = (haveChangesets ? nodeChangesets[nIndex]      : 0);
+			i32 nodeUid       = (haveUids       ? (i32)nodeUids[nIndex]       : 0);
+			if (nodeId <= 0) { PbfStagedError(block, "Invalid Node ID %lld in blob[%llu] group[%llu] denseNode[%llu]!", nodeId, blobIndex, gIndex, nIndex); decoder->result = Result_InvalidID; break; }
+			if (nodeVersion < -1) { PbfStagedError(block, "Invalid Node Version %d in blob[%llu] group[%llu] denseNode[%llu]!", nodeVersion, blobIndex, gIndex, nIndex); decoder->result = Result_ValueTooLow; break; }
+			if (nodeTimestamp < 0) { PbfStagedError(block, "Invalid Node Timestamp %d in blob[%llu] group[%llu] denseNode[%llu]!", nodeTimestamp, blobIndex, gIndex, nIndex); decoder->result = Result_ValueTooLow; break; }
+			if (nodeChangeset < 0) { PbfStagedError(block, "Invalid Node Changeset %d in blob[%llu] group[%llu] denseNode[%llu]!", nodeChangeset, blobIndex, gIndex, nIndex); decoder->result = Result_ValueTooLow; break; }
+			if (nodeUid < 0) { PbfStagedError(block, "Invalid Node UID %d in blob[%llu] group[%llu] denseNode[%llu]!", nodeUid, blobIndex, gIndex, nIndex); decoder->result = Result_ValueTooLow; break; }
+		}
+		if (decoder->result != Result_None) { TracyCZoneEnd(Zone_Func); return; }
+	}
+	group->areNodesSorted = (idStats.minDelta > 0);
+	
+	PbfWireReader keysValsReader = MakePbfWireReader(keysVals.slice);
+	PbfWireReader visibleReader = MakePbfWireReader(visibles.slice);
+	uxx currentKeyValIndex = 0;
+	for (uxx nIndex = 0; nIndex < ids.count; nIndex++)
+	{
+		PbfStagedNode* stagedNode = &group->nodes[nIndex];
+		stagedNode->id = (u64)nodeIds[nIndex];
+		stagedNode->location = MakeV2d(
+			decoder->nodeOffset.x + ((r64)nodeLons[nIndex] * decoder->granularityMult),
+			decoder->nodeOffset.y + ((r64)nodeLats[nIndex] * decoder->granularityMult)
+		);
+		stagedNode->visible = (haveVisibles ? (PbfWireReadVarint(&visibleReader) != 0) : true);
+		stagedNode->version = (haveVersions ? (i32)nodeVersions[nIndex] : -1);
+		stagedNode->changeset = (haveChangesets ? (u64)nodeChangesets[nIndex] : 0);
+		stagedNode->uid = (haveUids ? (u64)(i32)nodeUids[nIndex] : 0);
+		stagedNode->tags = (tagsBuffer != nullptr) ? &tagsBuffer[numTagsUsed] : nullptr;
+		stagedNode->numTags = 0;
+		
+		//Find node tags by walking keys_vals list 2 at a time until we find a 0 entry
+		while (currentKeyValIndex <= keysVals.count)
+		{
+			i32 keyStringId = (currentKeyValIndex < keysVals.count) ? (i32)PbfWireReadVarint(&keysValsReader) : 0;
+			if (keyStringId == 0 || currentKeyValIndex+1 >= keysVals.count) { currentKeyValIndex++; break; } // 0 entry denotes following tags are for next node
+			i32 valStringId = (i32)PbfWireReadVarint(&keysValsReader);
+			currentKeyValIndex += 2;
+			Str8 keyStr = GetPbfTableString(&decoder->stringTable, keyStringId);
+			if (!IsEmptyStr(keyStr))
+			{
+				PbfStagedTag* newTag = &tagsBuffer[numTagsUsed];
+				newTag->keyId = (u32)keyStringId;
+				newTag->valueId = GetPbfStagedStringId(&decoder->stringTable, valStringId);
+				numTagsUsed++;
+				stagedNode->numTags++;
+			}
+		}
+	}
+	if (currentKeyValIndex < keysVals.count) { PbfStagedNotifyWarning(block, "There were %llu/%llu tags left over after parsing %llu denseNodes in blob[%llu]", keysVals.count - currentKeyValIndex, keysVals.count, ids.count, blobIndex); }
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Plain Node messages (PrimitiveGroup field 1) are appended after any DenseNodes that were already decoded into this group
+void DecodePbfNodesDirect(PbfDirectDecoder* decoder, PbfStagedGroup* group, Slice groupSlice, uxx numNodes)
+{
+	TracyCZoneN(Zone_Func, "OsmNodes", true);
+	PbfStagedBlock* block = decoder->block;
+	Arena* scratch = block->arena;
+	uxx blobIndex = block->blobIndex;
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	
+	PbfStagedNode* newNodes = AllocArray(PbfStagedNode, scratch, group->numNodes + numNodes);
+	NotNull(newNodes);
+	if (group->numNodes > 0) { MyMemCopy(newNodes, group->nodes, sizeof(PbfStagedNode) * group->numNodes); }
+	if (!group->hasNodes) { group->areNodesSorted = true; }
+	group->hasNodes = true;
+	group->nodes = newNodes;
+	u64 prevNodeId = (group->numNodes > 0) ? group->nodes[group->numNodes-1].id : 0;
+	uxx nIndex = 0;
+	PbfWireReader groupReader = MakePbfWireReader(groupSlice);
+	while (decoder->isSupported && decoder->result == Result_None && PbfWireReadField(&groupReader, &fieldNumber, &wireType))
+	{
+		if (fieldNumber != 1) { PbfWireSkipField(&groupReader, wireType); continue; }
+		Slice nodeSlice = PbfWireReadSlice(&groupReader);
+		
+		bool foundId = false;
+		i64 nodeId = 0;
+		bool foundLat = false;
+		i64 nodeLat = 0;
+		bool foundLon = false;
+		i64 nodeLon = 0;
+		bool foundInfo = false;
+		Slice infoSlice = Slice_Empty;
+		PbfPackedField keys = ZEROED;
+		PbfPackedField vals = ZEROED;
+		PbfWireReader nodeReader = MakePbfWireReader(nodeSlice);
+		while (decoder->isSupported && PbfWireReadField(&nodeReader, &fieldNumber, &wireType))
+		{
+			if ((fieldNumber == 1 || fieldNumber == 8 || fieldNumber == 9) && wireType != PbfWireType_Varint) { decoder->isSupported = false; break; }
+			switch (fieldNumber)
+			{
+				//NOTE: Unlike Way and Relation IDs, the Node id, lat and lon are sint64 (zigzag encoded, see osmformat.proto)
+				case 1: nodeId  = PbfZigZagDecode(PbfWireReadVarint(&nodeReader)); foundId  = true; break;
+				case 8: nodeLat = PbfZigZagDecode(PbfWireReadVarint(&nodeReader)); foundLat = true; break;
+				case 9: nodeLon = PbfZigZagDecode(PbfWireReadVarint(&nodeReader)); foundLon = true; break;
+				case 2: decoder->isSupported = TryReadPbfPackedField(&nodeReader, wireType, &keys); break;
+				case 3: decoder->isSupported = TryReadPbfPackedField(&nodeReader, wireType, &vals); break;
+				case 4:
+				{
+					if (wireType != PbfWireType_LengthDelimited || foundInfo) { decoder->isSupported = false; break; }
+					infoSlice = PbfWireReadSlice(&nodeReader);
+					foundInfo = true;
+				} break;
+				default: PbfWireSkipField(&nodeReader, wireType); break;
+			}
+		}
+		if (nodeReader.isError || !foundId || !foundLat || !foundLon) { decoder->isSupported = false; }
+		PbfDirectInfo info = ZEROED;
+		if (decoder->isSupported && foundInfo && !TryParsePbfInfoDirect(infoSlice, &info)) { decoder->isSupported = false; }
+		if (!decoder->isSupported) { break; }
+		
+		if (nodeId <= 0)                               { PbfStagedError(block, "Node[%llu] in blob[%llu] has invalid ID %lld",        nIndex, blobIndex, nodeId); decoder->result = Result_InvalidID; break; }
+		if (info.hasVersion   && info.version   < -1) { PbfStagedError(block, "Node[%llu] in blob[%llu] has invalid version %d",     nIndex, blobIndex, info.version); decoder->result = Result_ValueTooLow; break; }
+		if (info.hasTimestamp && info.timestamp < 0) { PbfStagedError(block, "Node[%llu] in blob[%llu] has invalid timestamp %lld", nIndex, blobIndex, info.timestamp); decoder->result = Result_ValueTooLow; break; }
+		if (info.hasUid       && info.uid       < 0) { PbfStagedError(block, "Node[%llu] in blob[%llu] has invalid uid %d",         nIndex, blobIndex, info.uid); decoder->result = Result_ValueTooLow; break; }
+		if (info.hasChangeset && info.changeset < 0) { PbfStagedError(block, "Node[%llu] in blob[%llu] has invalid changeset %lld", nIndex, blobIndex, info.changeset); decoder->result = Result_ValueTooLow; break; }
+		if (keys.count != vals.count)                  { PbfStagedError(block, "Node[%llu] in blob[%llu] key count %llu doesn't match value count %llu", nIndex, blobIndex, keys.count, vals.count); decoder->result = Result_Mismatch; break; }
+		
+		if (prevNodeId != 0 && prevNodeId >= (u64)nodeId) { group->areNodesSorted = false; }
+		prevNodeId = (u64)nodeId;
+		
+		PbfStagedNode* stagedNode = &group->nodes[group->numNodes];
+		group->numNodes++;
+		stagedNode->id = (u64)nodeId;
+		stagedNode->location = MakeV2d(
+			decoder->nodeOffset.x + ((r64)nodeLon * decoder->granularityMult),
+			decoder->nodeOffset.y + ((r64)nodeLat * decoder->granularityMult)
+		);
+		stagedNode->visible = (info.hasVisible ? info.visible : true);
+		stagedNode->version = (info.hasVersion ? info.version : -1);
+		stagedNode->changeset = (info.hasChangeset ? (u64)info.changeset : 0);
+		stagedNode->uid = (info.hasUid ? (u64)info.uid : 0);
+		stagedNode->numTags = 0;
+		stagedNode->tags = (keys.count > 0) ? AllocArray(PbfStagedTag, scratch, keys.count) : nullptr;
+		PbfWireReader keysReader = MakePbfWireReader(keys.slice);
+		PbfWireReader valsReader = MakePbfWireReader(vals.slice);
+		for (uxx tIndex = 0; tIndex < keys.count; tIndex++)
+		{
+			u32 keyStringId = (u32)PbfWireReadVarint(&keysReader);
+			u32 valStringId = (u32)PbfWireReadVarint(&valsReader);
+			Str8 keyStr = GetPbfTableString(&decoder->stringTable, keyStringId);
+			if (!IsEmptyStr(keyStr))
+			{
+				PbfStagedTag* newTag = &stagedNode->tags[stagedNode->numTags];
+				newTag->keyId = keyStringId;
+				newTag->valueId = GetPbfStagedStringId(&decoder->stringTable, valStringId);
+				stagedNode->numTags++;
+			}
+		}
+		nIndex++;
+	}
+	if (groupReader.isError) { decoder->isSupported = false; }
+	TracyCZoneEnd(Zone_Func);
+}
+
+void DecodePbfWaysDirect(PbfDirectDecoder* decoder, PbfStagedGroup* group, Slice groupSlice, uxx numWays)
+{
+	TracyCZoneN(Zone_Func, "OsmWays", true);
+	PbfStagedBlock* block = decoder->block;
+	Arena* scratch = block->arena;
+	uxx blobIndex = block->blobIndex;
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	
+	group->hasWays = true;
+	group->areWaysSorted = true;
+	group->ways = AllocArray(PbfStagedWay, scratch, numWays);
+	NotNull(group->ways);
+	u64 prevWayId = 0;
+	uxx wIndex = 0;
+	PbfWireReader groupReader = MakePbfWireReader(groupSlice);
+	while (decoder->isSupported && decoder->result == Result_None && PbfWireReadField(&groupReader, &fieldNumber, &wireType))
+	{
+		if (fieldNumber != 3) { PbfWireSkipField(&groupReader, wireType); continue; }
+		Slice waySlice = PbfWireReadSlice(&groupReader);
+		
+		bool foundId = false;
+		i64 wayId = 0;
+		bool foundInfo = false;
+		Slice infoSlice = Slice_Empty;
+		PbfPackedField keys = ZEROED;
+		PbfPackedField vals = ZEROED;
+		PbfPackedField refs = ZEROED;
+		PbfPackedField lats = ZEROED;
+		PbfPackedField lons = ZEROED;
+		PbfWireReader wayReader = MakePbfWireReader(waySlice);
+		while (decoder->isSupported && PbfWireReadField(&wayReader, &fieldNumber, &wireType))
+		{
+			switch (fieldNumber)
+			{
+				case 1:
+				{
+					if (wireType != PbfWireType_Varint) { decoder->isSupported = false; break; }
+					wayId = (i64)PbfWireReadVarint(&wayReader);
+					foundId = true;
+				} break;
+				case 2: decoder->isSupported = TryReadPbfPackedField(&wayReader, wireType, &keys); break;
+				case 3: decoder->isSupported = TryReadPbfPackedField(&wayReader, wireType, &vals); break;
+				case 8: decoder->isSupported = TryReadPbfPackedField(&wayReader, wireType, &refs); break;
+				case 4:
+				{
+					if (wireType != PbfWireType_LengthDelimited || foundInfo) { decoder->isSupported = false; break; }
+					infoSlice = PbfWireReadSlice(&wayReader);
+					foundInfo = true;
+				} break;
+				case 9: decoder->isSupported = TryReadPbfPackedField(&wayReader, wireType, &lats); break;
+				case 10: decoder->isSupported = TryReadPbfPackedField(&wayReader, wireType, &lons); break;
+				default: PbfWireSkipField(&wayReader, wireType); break;
+			}
+		}
+		if (wayReader.isError || !foundId) { decoder->isSupported = false; }
+		PbfDirectInfo info = ZEROED;
+		if (decoder->isSupported && foundInfo && !TryParsePbfInfoDirect(infoSlice, &info)) { decoder->isSupported = false; }
+		if (!decoder->isSupported) { break; }
+		
+		if (wayId <= 0)                                { PbfStagedError(block, "Way[%llu] in blob[%llu] has invalid ID %lld",        wIndex, blobIndex, wayId); decoder->result = Result_InvalidID; break; }
+		if (info.hasTimestamp && info.timestamp < 0) { PbfStagedError(block, "Way[%llu] in blob[%llu] has invalid timestamp %lld", wIndex, blobIndex, info.timestamp); decoder->result = Result_ValueTooLow; break; }
+		if (info.hasUid       && info.uid       < 0) { PbfStagedError(block, "Way[%llu] in blob[%llu] has invalid uid %d",         wIndex, blobIndex, info.uid); decoder->result = Result_ValueTooLow; break; }
+		if (info.hasChangeset && info.changeset < 0) { PbfStagedError(block, "Way[%llu] in blob[%llu] has invalid changeset %lld", wIndex, blobIndex, info.changeset); decoder->result = Result_ValueTooLow; break; }
+		if (keys.count != vals.count)                  { PbfStagedError(block, "Way[%llu] in blob[%llu] key count %llu doesn't match value count %llu", wIndex, blobIndex, keys.count, vals.count); decoder->result = Result_Mismatch; break; }
+		if (refs.count > 0)
+		{
+			u64* nodeIds = AllocArray(u64, scratch, refs.count);
+			NotNull(nodeIds);
+			u64 prevNodeId = 0;
+			PbfWireReader refsReader = MakePbfWireReader(refs.slice);
+			for (uxx rIndex = 0; rIndex < refs.count; rIndex++)
+			{
+				i64 refDelta = PbfZigZagDecode(PbfWireReadVarint(&refsReader));
+				if (refDelta < -(i64)prevNodeId) { PbfStagedError(block, "Node[%llu] in Way[%llu] in blob[%llu] has negative ID %llu%s%lld", rIndex, wIndex, blobIndex, prevNodeId, (refDelta >= 0) ? "+" : "", refDelta); decoder->result = Result_InvalidID; break; }
+				if (refDelta > 0 && (u64)refDelta > UINT64_MAX - prevNodeId) { PbfStagedError(block, "Node[%llu] in Way[%llu] in blob[%llu] has overflow ID %llu%s%lld", rIndex, wIndex, blobIndex, prevNodeId, (refDelta >= 0) ? "+" : "", refDelta); decoder->result = Result_InvalidID; break; }
+				nodeIds[rIndex] = (u64)(prevNodeId + refDelta);
+				prevNodeId = nodeIds[rIndex];
+			}
+			if (decoder->result != Result_None) { break; }
+			
+			v2d* wayLocations = nullptr;
+			if (lats.count == refs.count && lons.count == refs.count)
+			{
+				wayLocations = AllocArray(v2d, scratch, refs.count);
+				NotNull(wayLocations);
+				i64 wayLat = 0;
+				i64 wayLon = 0;
+				PbfWireReader latsReader = MakePbfWireReader(lats.slice);
+				PbfWireReader lonsReader = MakePbfWireReader(lons.slice);
+				for (uxx rIndex = 0; rIndex < refs.count; rIndex++)
+				{
+					wayLat += PbfZigZagDecode(PbfWireReadVarint(&latsReader));
+					wayLon += PbfZigZagDecode(PbfWireReadVarint(&lonsReader));
+					wayLocations[rIndex] = MakeV2d(
+						decoder->nodeOffset.x + ((r64)wayLon * decoder->granularityMult),
+						decoder->nodeOffset.y + ((r64)wayLat * decoder->granularityMult)
+					);
+				}
+			}
+			else if (lats.count != 0 || lons.count != 0) { PbfStagedWarning(block, "Way[%llu] in blob[%llu] has %llu lat and %llu lon for %llu node refs, ignoring them", wIndex, blobIndex, lats.count, lons.count, refs.count); }
+			
+			if (prevWayId != 0 && prevWayId >= (u64)wayId) { group->areWaysSorted = false; }
+			prevWayId = (u64)wayId;
+			
+			PbfStagedWay* stagedWay = &group->ways[group->numWays];
+			group->numWays++;
+			stagedWay->id = (u64)wayId;
+			stagedWay->visible = (info.hasVisible ? info.visible : true);
+			stagedWay->version = (info.hasVersion ? info.version : -1);
+			stagedWay->uid = (info.hasUid ? (u64)info.uid : 0);
+			stagedWay->changeset = (info.hasChangeset ? (u64)info.changeset : 0);
+			stagedWay->numNodes = refs.count;
+			stagedWay->nodeIds = nodeIds;
+			stagedWay->locations = wayLocations;
+			stagedWay->numTags = 0;
+			stagedWay->tags = (keys.count > 0) ? AllocArray(PbfStagedTag, scratch, keys.count) : nullptr;
+			PbfWireReader keysReader = MakePbfWireReader(keys.slice);
+			PbfWireReader valsReader = MakePbfWireReader(vals.slice);
+			for (uxx tIndex = 0; tIndex < keys.count; tIndex++)
+			{
+				u32 keyStringId = (u32)PbfWireReadVarint(&keysReader);
+				u32 valStringId = (u32)PbfWireReadVarint(&valsReader);
+				Str8 keyStr = GetPbfTableString(&decoder->stringTable, keyStringId);
+				if (!IsEmptyStr(keyStr))
+				{
+					PbfStagedTag* newTag = &stagedWay->tags[stagedWay->numTags];
+					newTag->keyId = keyStringId;
+					newTag->valueId = GetPbfStagedStringId(&decoder->stringTable, valStringId);
+					stagedWay->numTags++;
+				}
+			}
+		}
+		else { PbfStagedWarning(block, "Way[%llu] in blob[%llu] had no node references!", wIndex, blobIndex); }
+		wIndex++;
+	}
+	if (groupReader.isError) { decoder->isSupported = false; }
+	TracyCZoneEnd(Zone_Func);
+}
+
+void DecodePbfRelationsDirect(PbfDirectDecoder* decoder, PbfStagedGroup* group, Slice groupSlice, uxx numRelations)
+{
+	TracyCZoneN(Zone_Func, "OsmRelations", true);
+	PbfStagedBlock* block = decoder->block;
+	Arena* scratch = block->arena;
+	uxx blobIndex = block->blobIndex;
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	
+	group->hasRelations = true;
+	group->areRelationsSorted = true;
+	group->relations = AllocArray(PbfStagedRelation, scratch, numRelations);
+	NotNull(group->relations);
+	u64 prevRelationId = 0;
+	uxx rIndex = 0;
+	PbfWireReader groupReader = MakePbfWireReader(groupSlice);
+	while (decoder->isSupported && decoder->result == Result_None && PbfWireReadField(&groupReader, &fieldNumber, &wireType))
+	{
+		if (fieldNumber != 4) { PbfWireSkipField(&groupReader, wireType); continue; }
+		Slice relationSlice = PbfWireReadSlice(&groupReader);
+		
+		bool foundId = false;
+		i64 relationId = 0;
+		bool foundInfo = false;
+		Slice infoSlice = Slice_Empty;
+		PbfPackedField keys = ZEROED;
+		PbfPackedField vals = ZEROED;
+		PbfPackedField rolesSids = ZEROED;
+		PbfPackedField memberIds = ZEROED;
+		PbfPackedField memberTypes = ZEROED;
+		PbfWireReader relationReader = MakePbfWireReader(relationSlice);
+		while (decoder->isSupported && PbfWireReadField(&relationReader, &fieldNumber, &wireType))
+		{
+			switch (fieldNumber)
+			{
+				case 1:
+				{
+					if (wireType != PbfWireType_Varint) { decoder->isSupported = false; break; }
+					relationId = (i64)PbfWireReadVarint(&relationReader);
+					foundId = true;
+				} break;
+				case 2:  decoder->isSupported = TryReadPbfPackedField(&relationReader, wireType, &keys); break;
+				case 3:  decoder->isSupported = TryReadPbfPackedField(&relationReader, wireType, &vals); break;
+				case 8:  decoder->isSupported = TryReadPbfPackedField(&relationReader, wireType, &rolesSids); break;
+				case 9:  decoder->isSupported = TryReadPbfPackedField(&relationReader, wireType, &memberIds); break;
+				case 10: decoder->isSupported = TryReadPbfPackedField(&relationReader, wireType, &memberTypes); break;
+				case 4:
+				{
+					if (wireType != PbfWireType_LengthDelimited || foundInfo) { decoder->isSupported = false; break; }
+					infoSlice = PbfWireReadSlice(&relationReader);
+					foundInfo = true;
+				} break;
+				default: PbfWireSkipField(&relationReader, wireType); break;
+			}
+		}
+		if (relationReader.isError || !foundId) { decoder->isSupported = false; }
+		PbfDirectInfo info = ZEROED;
+		if (decoder->isSupported && foundInfo && !TryParsePbfInfoDirect(infoSlice, &info)) { decoder->isSupported = false; }
+		if (!decoder->isSupported) { break; }
+		
+		if (relationId <= 0)                           { PbfStagedError(block, "Relation[%llu] in blob[%llu] has invalid ID %lld", rIndex, blobIndex, relationId); decoder->result = Result_InvalidID; break; }
+		if (info.hasTimestamp && info.timestamp < 0) { PbfStagedError(block, "Relation[%llu] in blob[%llu] has invalid timestamp %lld", rIndex, blobIndex, info.timestamp); decoder->result = Result_ValueTooLow; break; }
+		if (info.hasUid       && info.uid       < 0) { PbfStagedError(block, "Relation[%llu] in blob[%llu] has invalid uid %d", rIndex, blobIndex, info.uid); decoder->result = Result_ValueTooLow; break; }
+		if (info.hasChangeset && info.changeset < 0) { PbfStagedError(block, "Relation[%llu] in blob[%llu] has invalid changeset %lld", rIndex, blobIndex, info.changeset); decoder->result = Result_ValueTooLow; break; }
+		if (keys.count != vals.count)                  { PbfStagedError(block, "Relation[%llu] in blob[%llu] key count %llu doesn't match value count %llu", rIndex, blobIndex, keys.count, vals.count); decoder->result = Result_Mismatch; break; }
+		if (memberIds.count != rolesSids.count)        { PbfStagedError(block, "Relation[%llu] in blob[%llu] member ID count %llu doesn't match roles SID count %llu", rIndex, blobIndex, memberIds.count, rolesSids.count); decoder->result = Result_Mismatch; break; }
+		if (memberIds.count != memberTypes.count)      { PbfStagedError(block, "Relation[%llu] in blob[%llu] member ID count %llu doesn't match types count %llu", rIndex, blobIndex, memberIds.count, memberTypes.count); decoder->result = Result_Mismatch; break; }
+		if (memberIds.count > 0)
+		{
+			if (prevRelationId != 0 && prevRelationId >= (u64)relationId) { group->areRelationsSorted = false; }
+			prevRelationId = (u64)relationId;
+			
+			PbfStagedRelation* stagedRelation = &group->relations[group->numRelations];
+			group->numRelations++;
+			stagedRelation->id = (u64)relationId;
+			stagedRelation->visible = (info.hasVisible ? info.visible : true);
+			stagedRelation->version = (info.hasVersion ? info.version : -1);
+			stagedRelation->uid = (info.hasUid ? (u64)info.uid : 0);
+			stagedRelation->changeset = (info.hasChangeset ? (u64)info.changeset : 0);
+			stagedRelation->numTags = 0;
+			stagedRelation->tags = (keys.count > 0) ? AllocArray(PbfStagedTag, scratch, keys.count) : nullptr;
+			PbfWireReader keysReader = MakePbfWireReader(keys.slice);
+			PbfWireReader valsReader = MakePbfWireReader(vals.slice);
+			for (uxx tIndex = 0; tIndex < keys.count; tIndex++)
+			{
+				u32 keyStringId = (u32)PbfWireReadVarint(&keysReader);
+				u32 valStringId = (u32)PbfWireReadVarint(&valsReader);
+				Str8 keyStr = GetPbfTableString(&decoder->stringTable, keyStringId);
+				if (!IsEmptyStr(keyStr))
+				{
+					PbfStagedTag* newTag = &stagedRelation->tags[stagedRelation->numTags];
+					newTag->keyId = keyStringId;
+					newTag->valueId = GetPbfStagedStringId(&decoder->stringTable, valStringId);
+					stagedRelation->numTags++;
+				}
+			}
+			
+			stagedRelation->numMembers = 0;
+			stagedRelation->members = AllocArray(PbfStagedMember, scratch, memberIds.count);
+			NotNull(stagedRelation->members);
+			PbfWireReader rolesSidsReader = MakePbfWireReader(rolesSids.slice);
+			PbfWireReader memberIdsReader = MakePbfWireReader(memberIds.slice);
+			PbfWireReader memberTypesReader = MakePbfWireReader(memberTypes.slice);
+			i64 prevMemberId = 0;
+			for (uxx mIndex = 0; mIndex < memberIds.count; mIndex++)
+			{
+				Str8 roleStr = GetPbfTableString(&decoder->stringTable, (i32)PbfWireReadVarint(&rolesSidsReader));
+				i64 memberId = prevMemberId + PbfZigZagDecode(PbfWireReadVarint(&memberIdsReader));
+				prevMemberId = memberId;
+				i32 memberType = (i32)PbfWireReadVarint(&memberTypesReader);
+				
+				OsmRelationMemberRole role = OsmRelationMemberRole_None;
+				if (!IsEmptyStr(roleStr))
+				{
+					for (uxx roleIndex = 1; roleIndex < OsmRelationMemberRole_Count; roleIndex++)
+					{
+						const char* roleEnumStrNt = GetOsmRelationMemberRoleXmlStr((OsmRelationMemberRole)roleIndex);
+						if (StrAnyCaseEquals(roleStr, MakeStr8Nt(roleEnumStrNt)))
+						{
+							role = (OsmRelationMemberRole)roleIndex;
+							break;
+						}
+					}
+					if (role == OsmRelationMemberRole_None) { PbfStagedWarning(block, "Warning: Uknown role type \"%.*s\" on member[%llu] in relation[%llu] in blob[%llu]", StrPrint(roleStr), mIndex, rIndex, blobIndex); }
+				}
+				
+				if (memberId <= 0) { PbfStagedError(block, "Member[%llu] in Relation[%llu] in blob[%llu] has invalid ID %lld", mIndex, rIndex, blobIndex, memberId); decoder->result = Result_InvalidID; break; }
+				else
+				{
+					PbfStagedMember* stagedMember = &stagedRelation->members[stagedRelation->numMembers];
+					stagedRelation->numMembers++;
+					stagedMember->id = (u64)memberId;
+					stagedMember->role = role;
+					switch (memberType)
+					{
+						case OSMPBF__RELATION__MEMBER_TYPE__NODE: stagedMember->type = OsmRelationMemberType_Node; break;
+						case OSMPBF__RELATION__MEMBER_TYPE__WAY: stagedMember->type = OsmRelationMemberType_Way; break;
+						case OSMPBF__RELATION__MEMBER_TYPE__RELATION: stagedMember->type = OsmRelationMemberType_Relation; break;
+						default: PbfStagedError(block, "Member[%llu] in Relation[%llu] in blob[%llu] has unhandled type %d", mIndex, rIndex, blobIndex, memberType); decoder->result = Result_InvalidType; break;
+					}
+					if (decoder->result != Result_None) { break; }
+				}
+			}
+			if (decoder->result != Result_None) { break; }
+		}
+		else { PbfStagedWarning(block, "Relation[%llu] in blob[%llu] had no members!", rIndex, blobIndex); }
+		rIndex++;
+	}
+	if (groupReader.isError) { decoder->isSupported = false; }
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Decodes the PrimitiveBlock by walking the wire format directly. Packed fields (DenseNodes columns, Way.refs, Relation.memids, etc.)
+// are decoded straight into the staged arrays and all strings point into the decompressed buffer, so nothing is allocated besides
+// the staged block itself. Returns false if the block contains something this decoder doesn't handle (resultOut is not filled in that case)
+bool TryDecodePbfPrimitiveBlockDirect(PbfStagedBlock* block, Slice decompressedBuffer, PbfKernelLevel kernelLevel, Result* resultOut)
+{
+	TracyCZoneN(Zone_Func, "TryDecodePbfPrimitiveBlockDirect", true);
+	Arena* scratch = block->arena;
+	u32 fieldNumber = 0;
+	PbfWireType wireType = PbfWireType_Varint;
+	PbfDirectDecoder decoder = ZEROED;
+	decoder.block = block;
+	decoder.kernelLevel = kernelLevel;
+	decoder.isSupported = true;
+	decoder.result = Result_None;
+	
+	//NOTE: granularity and the offsets usually come after the groups so we need to find them before decoding any groups
+	bool foundStringTable = false;
+	Slice stringTableSlice = Slice_Empty;
+	uxx numGroups = 0;
+	bool hasGranularity = false;
+	i32 granularity = 0;
+	bool hasLatOffset = false;
+	i64 latOffset = 0;
+	bool hasLonOffset = false;
+	i64 lonOffset = 0;
+	PbfWireReader reader = MakePbfWireReader(decompressedBuffer);
+	while (decoder.isSupported && PbfWireReadField(&reader, &fieldNumber, &wireType))
+	{
+		switch (fieldNumber)
+		{
+			case 1:
+			{
+				if (wireType != PbfWireType_LengthDelimited || foundStringTable) { decoder.isSupported = false; break; }
+				stringTableSlice = PbfWireReadSlice(&reader);
+				foundStringTable = true;
+			} break;
+			case 2:
+			{
+				if (wireType != PbfWireType_LengthDelimited) { decoder.isSupported = false; break; }
+				PbfWireSkipField(&reader, wireType);
+				numGroups++;
+			} break;
+			case 17: if (wireType != PbfWireType_Varint) { decoder.isSupported = false; break; } hasGranularity = true; granularity = (i32)PbfWireReadVarint(&reader); break;
+			case 19: if (wireType != PbfWireType_Varint) { decoder.isSupported = false; break; } hasLatOffset = true; latOffset = (i64)PbfWireReadVarint(&reader); break;
+			case 20: if (wireType != PbfWireType_Varint) { decoder.isSupported = false; break; } hasLonOffset = true; lonOffset = (i64)PbfWireReadVarint(&reader); break;
+			default: PbfWireSkipField(&reader, wireType); break;
+		}
+	}
+	if (reader.isError || !foundStringTable) { decoder.isSupported = false; }
+	
+	// +==============================+
+	// |         String Table         |
+	// +==============================+
+	if (decoder.isSupported)
+	{
+		PbfWireReader stringsReader = MakePbfWireReader(stringTableSlice);
+		while (decoder.isSupported && PbfWireReadField(&stringsReader, &fieldNumber, &wireType))
+		{
+			if (fieldNumber == 1 && wireType != PbfWireType_LengthDelimited) { decoder.isSupported = false; break; }
+			if (fieldNumber == 1) { decoder.stringTable.numStrings++; }
+			PbfWireSkipField(&stringsReader, wireType);
+		}
+		if (stringsReader.isError) { decoder.isSupported = false; }
+		
+		if (decoder.isSupported && decoder.stringTable.numStrings > 0)
+		{
+			decoder.stringTable.strings = AllocArray(Str8, scratch, decoder.stringTable.numStrings);
+			NotNull(decoder.stringTable.strings);
+			uxx sIndex = 0;
+			stringsReader = MakePbfWireReader(stringTableSlice);
+			while (PbfWireReadField(&stringsReader, &fieldNumber, &wireType))
+			{
+				if (fieldNumber != 1) { PbfWireSkipField(&stringsReader, wireType); continue; }
+				Slice stringSlice = PbfWireReadSlice(&stringsReader);
+				decoder.stringTable.strings[sIndex] = MakeStr8(stringSlice.length, (char*)stringSlice.bytes);
+				sIndex++;
+			}
+		}
+		block->stringTable = decoder.stringTable;
+	}
+	
+	decoder.granularityMult = (r64)(hasGranularity ? granularity : 1) * (r64)Billionth(100);
+	decoder.nodeOffset = MakeV2d(
+		(r64)(hasLonOffset ? lonOffset * decoder.granularityMult : 0),
+		(r64)(hasLatOffset ? latOffset * decoder.granularityMult : 0)
+	);
+	
+	// +==============================+
+	// |       Primitive Groups       |
+	// +==============================+
+	if (decoder.isSupported)
+	{
+		block->numGroups = numGroups;
+		block->groups = (numGroups > 0) ? AllocArray(PbfStagedGroup, scratch, numGroups) : nullptr;
+		if (numGroups > 0) { NotNull(block->groups); MyMemSet(block->groups, 0x00, sizeof(PbfStagedGroup) * numGroups); }
+		
+		uxx gIndex = 0;
+		reader = MakePbfWireReader(decompressedBuffer);
+		while (decoder.isSupported && decoder.result == Result_None && PbfWireReadField(&reader, &fieldNumber, &wireType))
+		{
+			if (fieldNumber != 2) { PbfWireSkipField(&reader, wireType); continue; }
+			Slice groupSlice = PbfWireReadSlice(&reader);
+			PbfStagedGroup* group = &block->groups[gIndex];
+			
+			bool foundDense = false;
+			Slice denseSlice = Slice_Empty;
+			uxx numNodes = 0;
+			uxx numWays = 0;
+			uxx numRelations = 0;
+			PbfWireReader groupReader = MakePbfWireReader(groupSlice);
+			while (decoder.isSupported && PbfWireReadField(&groupReader, &fieldNumber, &wireType))
+			{
+				if (fieldNumber >= 1 && fieldNumber <= 5 && wireType != PbfWireType_LengthDelimited) { decoder.isSupported = false; break; }
+				if (fieldNumber == 2)
+				{
+					if (foundDense) { decoder.isSupported = false; break; }
+					denseSlice = PbfWireReadSlice(&groupReader);
+					foundDense = true;
+				}
+				else
+				{
+					if (fieldNumber == 1) { numNodes++; }
+					if (fieldNumber == 3) { numWays++; }
+					if (fieldNumber == 4) { numRelations++; }
+					//TODO: ChangeSet messages (field 5) only carry an id, we don't store changesets so they are skipped by both decoders
+					PbfWireSkipField(&groupReader, wireType);
+				}
+			}
+			if (groupReader.isError) { decoder.isSupported = false; }
+			
+			if (decoder.isSupported && foundDense) { DecodePbfDenseNodesDirect(&decoder, group, gIndex, denseSlice); }
+			if (decoder.isSupported && decoder.result == Result_None && numNodes > 0) { DecodePbfNodesDirect(&decoder, group, groupSlice, numNodes); }
+			if (decoder.isSupported && decoder.result == Result_None && numWays > 0) { DecodePbfWaysDirect(&decoder, group, groupSlice, numWays); }
+			if (decoder.isSupported && decoder.result == Result_None && numRelations > 0) { DecodePbfRelationsDirect(&decoder, group, groupSlice, numRelations); }
+			gIndex++;
+		}
+		if (reader.isError) { decoder.isSupported = false; }
+	}
+	
+	if (decoder.isSupported && resultOut != nullptr) { *resultOut = decoder.result; }
+	TracyCZoneEnd(Zone_Func);
+	return decoder.isSupported;
+}
+
+PbfCodec GetPbfCodecForBlobDataCase(OSMPBF__Blob__DataCase dataCase)
+{
+	switch (dataCase)
+	{
+		case OSMPBF__BLOB__DATA_RAW:                 return PbfCodec_Raw;
+		case OSMPBF__BLOB__DATA_ZLIB_DATA:           return PbfCodec_Zlib;
+		case OSMPBF__BLOB__DATA_LZMA_DATA:           return PbfCodec_Lzma;
+		case OSMPBF__BLOB__DATA_OBSOLETE_BZIP2_DATA: return PbfCodec_Bzip2;
+		case OSMPBF__BLOB__DATA_LZ4_DATA:            return PbfCodec_Lz4;
+		case OSMPBF__BLOB__DATA_ZSTD_DATA:           return PbfCodec_Zstd;
+		default: return PbfCodec_None;
+	}
+}
+
+// Parses the Blob message and decompresses the data inside into block->arena using the PbfCodecTable. Raw blobs aren't copied at all,
+// decompressedBufferOut just points at the data inside the blob bytes. The codec, sizes and time spent are recorded in the block for PbfCodecStats
+Result DecompressPbfStagedBlob(PbfStagedBlock* block, Slice* decompressedBufferOut)
+{
+	TracyCZoneN(Zone_Func, "DecompressPbfStagedBlob", true);
+	Arena* scratch = block->arena;
+	uxx blobIndex = block->blobIndex;
+	*decompressedBufferOut = Slice_Empty;
+	
+	TracyCZoneN(Zone_Blob, "Blob", true);
+	PbfBlobInfo blob = ZEROED;
+	bool parsedBlob = TryParsePbfBlobDirect(MakeSlice(block->blobLength, block->blobBytes), &blob);
+	TracyCZoneEnd(Zone_Blob);
+	if (!parsedBlob) { TracyCZoneEnd(Zone_Func); return Result_ParsingFailure; }
+	// PrintLine_I("\tParsed %llu byte Blob!", block->blobLength);
+	// PrintLine_D("\t\traw_size=%d", blob.rawSize);
+	PbfCodec codec = GetPbfCodecForBlobDataCase(blob.dataCase);
+	if (codec == PbfCodec_None) { TracyCZoneEnd(Zone_Func); return Result_None; }
+	const PbfCodecInfo* codecInfo = GetPbfCodecInfo(codec);
+	if (codecInfo->Decompress == nullptr)
+	{
+		PbfStagedError(block, "Unsupported compression %s on blob[%llu]", GetPbfCodecStr(codec), blobIndex);
+		TracyCZoneEnd(Zone_Func);
+		return Result_UnsupportedCompression;
+	}
+	
+	//NOTE: raw_size is optional for RAW blobs, and a compressed blob that claims to be empty has nothing for us to do
+	uxx rawSize = (codec == PbfCodec_Raw) ? blob.data.length : (uxx)blob.rawSize;
+	if (rawSize == 0) { TracyCZoneEnd(Zone_Func); return Result_None; }
+	
+	OsTime startTime = OsGetTime();
+	*decompressedBufferOut = codecInfo->Decompress(scratch, blob.data, rawSize);
+	block->codec = codec;
+	block->compressedSize = blob.data.length;
+	block->rawSize = rawSize;
+	block->decompressMs = (r64)OsTimeDiffMsR32(startTime, OsGetTime());
+	if (decompressedBufferOut->bytes == nullptr)
+	{
+		PbfStagedError(block, "Failed to decompress blob[%llu] %s %llu->%llu", blobIndex, GetPbfCodecStr(codec), blob.data.length, rawSize);
+		TracyCZoneEnd(Zone_Func);
+		return Result_DecompressError;
+	}
+	
+	TracyCZoneEnd(Zone_Func);
+	return Result_None;
+}
+
+// The tag filter works on OsmTags so we resolve the staged tags into a temporary buffer
+bool DoPbfStagedTagsMatchFilter(OsmTagFilter* tagFilter, PbfStagedBlock* block, uxx numTags, const PbfStagedTag* stagedTags)
+{
+	uxx arenaMark = ArenaGetMark(block->arena);
+	OsmTag* tags = (numTags > 0) ? AllocArray(OsmTag, block->arena, numTags) : nullptr;
+	for (uxx tIndex = 0; tIndex < numTags; tIndex++)
+	{
+		tags[tIndex].key = GetPbfTableString(&block->stringTable, stagedTags[tIndex].keyId);
+		tags[tIndex].value = GetPbfTableString(&block->stringTable, stagedTags[tIndex].valueId);
+	}
+	bool result = DoesOsmTagFilterMatch(tagFilter, numTags, tags);
+	ArenaResetToMark(block->arena, arenaMark);
+	return result;
+}
+
+// Hashes every string in the block's string table on this (Decode) thread and sets up the handles array that GetPbfStagedPoolString fills in the Merge stage
+void HashPbfStagedStrings(PbfStagedBlock* block)
+{
+	TracyCZoneN(Zone_Func, "HashPbfStagedStrings", true);
+	uxx numStrings = block->stringTable.numStrings;
+	if (numStrings > 0)
+	{
+		block->stringHashes = AllocArray(u64, block->arena, numStrings);
+		block->stringHandles = AllocArray(u32, block->arena, numStrings);
+		NotNull(block->stringHashes);
+		NotNull(block->stringHandles);
+		for (uxx sIndex = 0; sIndex < numStrings; sIndex++)
+		{
+			block->stringHashes[sIndex] = HashOsmString(block->stringTable.strings[sIndex]);
+			block->stringHandles[sIndex] = OSM_STRING_INVALID;
+		}
+	}
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Drops the staged primitives we don't want (because of the bounds filter or the tag filter) so they never make it to the Merge stage.
+// Everything is compacted in place, which keeps the order (and the areXSorted flags) intact. In the WayNodes pass we keep the nodes
+// that kept ways reference (that weren't kept the first time around) and the Merge stage ignores the ways and relations
+void FilterPbfStagedPrimitives(PbfPipeline* pipeline, PbfStagedBlock* block)
+{
+	TracyCZoneN(Zone_Func, "FilterPbfStagedPrimitives", true);
+	bool useBoundsFilter = pipeline->options.useBoundsFilter;
+	OsmTagFilter* tagFilter = pipeline->options.tagFilter;
+	bool isWayNodesPass = (pipeline->pass == PbfPipelinePass_WayNodes);
+	for (uxx gIndex = 0; gIndex < block->numGroups; gIndex++)
+	{
+		PbfStagedGroup* group = &block->groups[gIndex];
+		if (group->hasNodes)
+		{
+			uxx numKept = 0;
+			for (uxx nIndex = 0; nIndex < group->numNodes; nIndex++)
+			{
+				PbfStagedNode* stagedNode = &group->nodes[nIndex];
+				bool isInside = (!useBoundsFilter || IsPbfLocationInBoundsFilter(pipeline, stagedNode->location));
+				bool keepNode = isInside;
+				if (isWayNodesPass) { keepNode = ((!useBoundsFilter || !isInside) && IsOsmIdInSortedSet(pipeline->numWayNodeIds, pipeline->wayNodeIds, stagedNode->id)); }
+				else if (pipeline->skipNodesInMainPass) { keepNode = false; }
+				else if (keepNode && tagFilter != nullptr && pipeline->options.tagFilterNodes == OsmTagFilterNodes_Matching) { keepNode = DoPbfStagedTagsMatchFilter(tagFilter, block, stagedNode->numTags, stagedNode->tags); }
+				if (keepNode)
+				{
+					if (numKept != nIndex) { MyMemCopy(&group->nodes[numKept], stagedNode, sizeof(PbfStagedNode)); }
+					numKept++;
+				}
+			}
+			group->numNodes = numKept;
+		}
+		if (tagFilter != nullptr && group->hasWays && !isWayNodesPass)
+		{
+			uxx numKept = 0;
+			for (uxx wIndex = 0; wIndex < group->numWays; wIndex++)
+			{
+				PbfStagedWay* stagedWay = &group->ways[wIndex];
+				if (DoPbfStagedTagsMatchFilter(tagFilter, block, stagedWay->numTags, stagedWay->tags))
+				{
+					if (numKept != wIndex) { MyMemCopy(&group->ways[numKept], stagedWay, sizeof(PbfStagedWay)); }
+					numKept++;
+				}
+			}
+			group->numWays = numKept;
+		}
+		if (tagFilter != nullptr && group->hasRelations && !isWayNodesPass)
+		{
+			uxx numKept = 0;
+			for (uxx rIndex = 0; rIndex < group->numRelations; rIndex++)
+			{
+				PbfStagedRelation* stagedRelation = &group->relations[rIndex];
+				if (DoPbfStagedTagsMatchFilter(tagFilter, block, stagedRelation->numTags, stagedRelation->tags))
+				{
+					if (numKept != rIndex) { MyMemCopy(&group->relations[numKept], stagedRelation, sizeof(PbfStagedRelation)); }
+					numKept++;
+				}
+			}
+			group->numRelations = numKept;
+		}
+	}
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Records which kinds of primitives are in the block, their id ranges and the bounds of the nodes. Ways and relations get their bounds in FinishPbfBlobIndexBounds
+void FillPbfBlobIndexEntry(PbfStagedBlock* block)
+{
+	PbfBlobIndexEntry* entry = &block->indexEntry;
+	if (block->type == PbfStagedBlockType_Header) { entry->flags |= PbfBlobIndexFlag_Header; return; }
+	for (uxx gIndex = 0; gIndex < block->numGroups; gIndex++)
+	{
+		PbfStagedGroup* group = &block->groups[gIndex];
+		entry->numNodes += group->numNodes;
+		entry->numWays += group->numWays;
+		entry->numRelations += group->numRelations;
+		for (uxx nIndex = 0; nIndex < group->numNodes; nIndex++)
+		{
+			PbfStagedNode* stagedNode = &group->nodes[nIndex];
+			entry->flags |= PbfBlobIndexFlag_HasNodes;
+			entry->minNodeId = MinU64(entry->minNodeId, stagedNode->id);
+			entry->maxNodeId = MaxU64(entry->maxNodeId, stagedNode->id);
+			ExpandPbfBlobIndexEntryBounds(entry, stagedNode->location.lon, stagedNode->location.lat, stagedNode->location.lon, stagedNode->location.lat);
+		}
+		for (uxx wIndex = 0; wIndex < group->numWays; wIndex++)
+		{
+			entry->flags |= PbfBlobIndexFlag_HasWays;
+			entry->minWayId = MinU64(entry->minWayId, group->ways[wIndex].id);
+			entry->maxWayId = MaxU64(entry->maxWayId, group->ways[wIndex].id);
+		}
+		for (uxx rIndex = 0; rIndex < group->numRelations; rIndex++)
+		{
+			entry->flags |= PbfBlobIndexFlag_HasRelations;
+			entry->minRelationId = MinU64(entry->minRelationId, group->relations[rIndex].id);
+			entry->maxRelationId = MaxU64(entry->maxRelationId, group->relations[rIndex].id);
+		}
+	}
+}
+
+// Decompresses and unpacks the blob and then walks all the primitive groups, delta decoding and validating everything into the staged
+// arrays. Nothing in here touches the OsmMap, so any number of threads can be running this at the same time on different blobs
+void DecodePbfStagedBlock(PbfPipeline* pipeline, PbfStagedBlock* block)
+{
+	TracyCZoneN(Zone_Func, "DecodePbfStagedBlock", true);
+	Arena* scratch = block->arena;
+	ProtobufCAllocator scratchAllocator = ProtobufAllocatorFromArena(scratch);
+	uxx blobIndex = block->blobIndex;
+	Result result = Result_None;
+	
+	do
+	{
+		Slice decompressedBuffer = Slice_Empty;
+		result = DecompressPbfStagedBlob(block, &decompressedBuffer);
+		if (result != Result_None) { break; }
+		
+		// +==============================+
+		// |        OSMHeader Blob        |
+		// +==============================+
+		if (StrExactEquals(block->typeStr, StrLit("OSMHeader")))
+		{
+			block->type = PbfStagedBlockType_Header;
+			TracyCZoneN(Zone_OsmHeaderBlock, "OsmHeaderBlock", true);
+			OSMPBF__HeaderBlock* headerBlock = osmpbf__header_block__unpack(&scratchAllocator, decompressedBuffer.length, decompressedBuffer.bytes);
+			TracyCZoneEnd(Zone_OsmHeaderBlock);
+			if (headerBlock == nullptr) { PbfStagedError(block, "Failed to parse OSMPBF::HeaderBlock in blob[%llu]!", blobIndex); result = Result_ParsingFailure; break; }
+			#if 0
+			PrintLine_D("\tbbox: (%lf, %lf, %lf, %lf)",
+				(r64)headerBlock->bbox->left * (r64)Nano(1),
+				(r64)headerBlock->bbox->top * (r64)Nano(1),
+				(r64)headerBlock->bbox->right * (r64)Nano(1),
+				(r64)headerBlock->bbox->bottom * (r64)Nano(1)
+			);
+			PrintLine_D("\tn_required_features: %zu", headerBlock->n_required_features);
+			for (size_t fIndex = 0; fIndex < headerBlock->n_required_features; fIndex++) { PrintLine_D("\t\trequired_feature[%zu]: \"%s\"", fIndex, headerBlock->required_features[fIndex]); }
+			PrintLine_D("\tn_optional_features: %zu", headerBlock->n_optional_features);
+			for (size_t fIndex = 0; fIndex < headerBlock->n_optional_features; fIndex++) { PrintLine_D("\t\toptional_feature[%zu]: \"%s\"", fIndex, headerBlock->optional_features[fIndex]); }
+			PrintLine_D("\twritingprogram: \"%s\"", headerBlock->writingprogram); //ex. "osmconvert 0.8.10"
+			PrintLine_D("\tsource: \"%s\"", headerBlock->source); //ex. "http://www.openstreetmap.org/api/0.6"
+			#endif
+			
+			block->bounds.x = (r64)headerBlock->bbox->left * (r64)Nano(1);
+			block->bounds.y = (r64)headerBlock->bbox->top * (r64)Nano(1);
+			block->bounds.width = ((r64)headerBlock->bbox->right * (r64)Nano(1)) - block->bounds.x;
+			block->bounds.height = ((r64)headerBlock->bbox->bottom * (r64)Nano(1)) - block->bounds.y;
+			//TODO: Ensure that all the "required_features" are things we expect to handle
+			//      "OsmSchema-V0.6", "DenseNodes", "Sort.Type_then_ID", "LocationsOnWays", "HistoricalInformation", etc.
+			for (size_t fIndex = 0; fIndex < headerBlock->n_optional_features; fIndex++)
+			{
+				if (StrExactEquals(MakeStr8Nt(headerBlock->optional_features[fIndex]), StrLit("LocationsOnWays"))) { block->hasLocationsOnWays = true; }
+			}
+			if (pipeline->buildBlobIndex != nullptr) { FillPbfBlobIndexEntry(block); }
+		}
+		// +==============================+
+		// |         OSMData Blob         |
+		// +==============================+
+		else if (StrExactEquals(block->typeStr, StrLit("OSMData")))
+		{
+			block->type = PbfStagedBlockType_Data;
+			bool decodedDirectly = false;
+			if (!pipeline->options.useProtobufCDecoder)
+			{
+				uxx numMessagesBefore = block->messages.length;
+				decodedDirectly = TryDecodePbfPrimitiveBlockDirect(block, decompressedBuffer, pipeline->options.kernelLevel, &result);
+				if (!decodedDirectly)
+				{
+					//Throw away anything the direct decoder staged before it gave up, the reference decoder will redo all of it
+					block->messages.length = numMessagesBefore;
+					block->numGroups = 0;
+					block->groups = nullptr;
+					result = Result_None;
+				}
+			}
+			if (!decodedDirectly) { result = DecodePbfPrimitiveBlockProtobufC(block, decompressedBuffer); }
+			if (result == Result_None) { HashPbfStagedStrings(block); }
+			if (result == Result_None && pipeline->buildBlobIndex != nullptr) { FillPbfBlobIndexEntry(block); }
+			bool needsFilter = (pipeline->options.useBoundsFilter || pipeline->options.tagFilter != nullptr || pipeline->pass == PbfPipelinePass_WayNodes);
+			if (result == Result_None && needsFilter) { FilterPbfStagedPrimitives(pipeline, block); }
+		}
+		else
+		{
+			block->type = PbfStagedBlockType_Unknown;
+			PbfStagedWarning(block, "Unhandled blob type \"%.*s\"", StrPrint(block->typeStr));
+		}
+	} while(0);
+	
+	block->result = result;
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Interns string table entries into the map's OsmStringPool the first time a tag in this block uses them. Every other tag that uses the same string is just an array lookup
+Str8 GetPbfStagedPoolString(OsmMap* mapOut, PbfStagedBlock* block, u32 stringId)
+{
+	if (stringId == 0 || (uxx)stringId >= block->stringTable.numStrings) { return Str8_Empty; }
+	if (block->stringHandles[stringId] == OSM_STRING_INVALID)
+	{
+		block->stringHandles[stringId] = InternOsmStringHashed(&mapOut->stringPool, block->stringTable.strings[stringId], block->stringHashes[stringId]);
+	}
+	return GetOsmPoolString(&mapOut->stringPool, block->stringHandles[stringId]);
+}
+
+void AddPbfStagedTags(OsmMap* mapOut, PbfStagedBlock* block, uxx numTags, const PbfStagedTag* stagedTags, OsmTagRange* rangeOut)
+{
+	if (numTags == 0) { return; }
+	OsmTag* newTags = AddOsmTags(mapOut, rangeOut, numTags);
+	for (uxx tIndex = 0; tIndex < numTags; tIndex++)
+	{
+		newTags[tIndex].key = GetPbfStagedPoolString(mapOut, block, stagedTags[tIndex].keyId);
+		newTags[tIndex].value = GetPbfStagedPoolString(mapOut, block, stagedTags[tIndex].valueId);
+	}
+}
+
+// Makes room in mapOut->tags for every tag in the group up front, rather than letting it grow a block at a time as the primitives are merged
+void ExpandOsmTagsForPbfStagedGroup(OsmMap* mapOut, const PbfStagedGroup* group)
+{
+	uxx numTags = 0;
+	for (uxx nIndex = 0; nIndex < group->numNodes; nIndex++) { numTags += group->nodes[nIndex].numTags; }
+	for (uxx wIndex = 0; wIndex < group->numWays; wIndex++) { numTags += group->ways[wIndex].numTags; }
+	for (uxx rIndex = 0; rIndex < group->numRelations; rIndex++) { numTags += group->relations[rIndex].numTags; }
+	VarArrayExpand(&mapOut->tags, mapOut->tags.length + numTags);
+}
+
+void MergePbfStagedNode(OsmMap* mapOut, PbfStagedBlock* block, const PbfStagedNode* stagedNode)
+{
+	OsmNode* newNode = AddOsmNode(mapOut, stagedNode->location, stagedNode->id);
+	OsmNodeInfo* newInfo = GetOsmNodeInfo(mapOut, newNode);
+	newInfo->visible = stagedNode->visible;
+	newInfo->version = stagedNode->version;
+	newInfo->changeset = stagedNode->changeset;
+	newInfo->uid = stagedNode->uid;
+	AddPbfStagedTags(mapOut, block, stagedNode->numTags, stagedNode->tags, &newNode->tags);
+}
+
+bool DoesPbfStagedWayReferenceMap(OsmMap* mapOut, const PbfStagedWay* stagedWay)
+{
+	for (uxx nIndex = 0; nIndex < stagedWay->numNodes; nIndex++)
+	{
+		if (FindOsmNode(mapOut, stagedWay->nodeIds[nIndex]) != nullptr) { return true; }
+	}
+	return false;
+}
+
+// With LocationsOnWays the way's nodes (most of which we never add to the map) don't need to be looked up, we have their locations right here
+bool DoesPbfStagedWayLocationsHitBoundsFilter(const PbfPipeline* pipeline, const PbfStagedWay* stagedWay)
+{
+	for (uxx nIndex = 0; nIndex < stagedWay->numNodes; nIndex++)
+	{
+		if (IsPbfLocationInBoundsFilter(pipeline, stagedWay->locations[nIndex])) { return true; }
+	}
+	return false;
+}
+
+bool DoesPbfStagedRelationReferenceMap(OsmMap* mapOut, const PbfStagedRelation* stagedRelation)
+{
+	for (uxx mIndex = 0; mIndex < stagedRelation->numMembers; mIndex++)
+	{
+		const PbfStagedMember* stagedMember = &stagedRelation->members[mIndex];
+		if (stagedMember->type == OsmRelationMemberType_Node && FindOsmNode(mapOut, stagedMember->id) != nullptr) { return true; }
+		if (stagedMember->type == OsmRelationMemberType_Way && FindOsmWay(mapOut, stagedMember->id) != nullptr) { return true; }
+		if (stagedMember->type == OsmRelationMemberType_Relation && FindOsmRelation(mapOut, stagedMember->id) != nullptr) { return true; }
+	}
+	return false;
+}
+
+// Adds the block's sizes and decompression time to the running totals for its codec
+void AddPbfCodecStats(PbfPipeline* pipeline, const PbfStagedBlock* block)
+{
+	PbfCodecStats* stats = &pipeline->codecStats[block->codec];
+	stats->numBlobs++;
+	stats->numCompressedBytes += block->compressedSize;
+	stats->numRawBytes += block->rawSize;
+	stats->decompressMs += block->decompressMs;
+	if (stats->decompressMs > 0)
+	{
+		r64 megabytesPerSec = ((r64)stats->numRawBytes / (1024.0 * 1024.0)) / (stats->decompressMs / 1000.0);
+		UNUSED(megabytesPerSec); //only used when Tracy is enabled
+		TracyCPlot(GetPbfCodecInfo(block->codec)->plotName, megabytesPerSec);
+	}
+}
+
+void PrintPbfCodecStats(const PbfPipeline* pipeline)
+{
+	for (uxx cIndex = 0; cIndex < PbfCodec_Count; cIndex++)
+	{
+		const PbfCodecStats* stats = &pipeline->codecStats[cIndex];
+		if (stats->numBlobs == 0) { continue; }
+		r64 megabytesPerSec = (stats->decompressMs > 0) ? ((r64)stats->numRawBytes / (1024.0 * 1024.0)) / (stats->decompressMs / 1000.0) : 0.0;
+		PrintLine_D("%s: %llu blob%s, %llu->%llu bytes in %.1fms (%.1f MB/s per thread)",
+			GetPbfCodecStr((PbfCodec)cIndex),
+			stats->numBlobs, Plural(stats->numBlobs, "s"),
+			stats->numCompressedBytes, stats->numRawBytes,
+			stats->decompressMs, megabytesPerSec
+		);
+	}
+}
+
+// Copies the contents of a staged block into the OsmMap. This must be called exactly once for every blob, in blob order.
+// Returns false if the block (or this stage) produced an error, in which case pipeline->result has been filled, or when
+// the WayNodes pass has found every node it was looking for and there's no reason to read any further
+bool MergePbfStagedBlock(PbfPipeline* pipeline, PbfStagedBlock* block)
+{
+	TracyCZoneN(Zone_Func, "MergePbfStagedBlock", true);
+	Arena* arena = pipeline->arena;
+	OsmMap* mapOut = pipeline->mapOut;
+	uxx blobIndex = block->blobIndex;
+	Result result = block->result;
+	bool useBoundsFilter = pipeline->options.useBoundsFilter;
+	
+	if (block->codec != PbfCodec_None) { AddPbfCodecStats(pipeline, block); }
+	
+	//NOTE: Everything but the nodes was merged (and all the messages were printed) in the Main pass
+	if (pipeline->pass == PbfPipelinePass_WayNodes)
+	{
+		if (result == Result_None && block->type == PbfStagedBlockType_Data)
+		{
+			for (uxx gIndex = 0; gIndex < block->numGroups; gIndex++)
+			{
+				PbfStagedGroup* group = &block->groups[gIndex];
+				if (!group->hasNodes || group->numNodes == 0) { continue; }
+				mapOut->areNodesSorted = false;
+				ExpandOsmNodes(mapOut, mapOut->nodes.length + group->numNodes);
+				for (uxx nIndex = 0; nIndex < group->numNodes; nIndex++) { MergePbfStagedNode(mapOut, block, &group->nodes[nIndex]); }
+				pipeline->numWayNodesFound += group->numNodes;
+			}
+		}
+		else if (result != Result_None)
+		{
+			pipeline->result = result;
+			pipeline->errorBlobIndex = blobIndex;
+		}
+		TracyCZoneEnd(Zone_Func);
+		return (result == Result_None && pipeline->numWayNodesFound < pipeline->numWayNodeIds);
+	}
+	
+	//NOTE: These two checks happen before we unpack the HeaderBlock/PrimitiveBlock in a serial load, so they take precedence over any messages from the Decode stage
+	if (block->type == PbfStagedBlockType_Header && pipeline->foundOsmHeader) { NotifyPrint_E("Blob[%llu] was a second OSMHeader!", blobIndex); result = Result_Duplicate; }
+	else if (block->type == PbfStagedBlockType_Data && !pipeline->foundOsmHeader) { NotifyPrint_E("Blob[%llu] was OSMData BEFORE we found OSMHeader blob!", blobIndex); result = Result_MissingHeader; }
+	else
+	{
+		VarArrayLoop(&block->messages, mIndex)
+		{
+			VarArrayLoopGet(PbfStagedMessage, message, &block->messages, mIndex);
+			if (message->notify) { NotifyPrintAt(message->level, 0, "%.*s", StrPrint(message->text)); }
+			else { PrintLineAt(message->level, "%.*s", StrPrint(message->text)); }
+		}
+	}
+	
+	if (result == Result_None && block->type == PbfStagedBlockType_Header)
+	{
+		pipeline->foundOsmHeader = true;
+		pipeline->useWayLocations = (pipeline->options.useLocationsOnWays && block->hasLocationsOnWays);
+		if (pipeline->useWayLocations) { PrintLine_D("Using LocationsOnWays, untagged nodes will not be added to the map"); }
+		//NOTE: With LocationsOnWays most nodes are untagged and get dropped, so the node count from the index would be way too high
+		InitOsmMap(arena, mapOut, pipeline->useWayLocations ? 0 : pipeline->numNodesExpected, pipeline->numWaysExpected, pipeline->numRelationsExpected, 0);
+		mapOut->areNodesSorted = true;
+		mapOut->areWaysSorted = true;
+		mapOut->areRelationsSorted = true;
+		mapOut->bounds = block->bounds;
+		if (useBoundsFilter)
+		{
+			//NOTE: Same layout as the header bbox: top-left corner and a negative height
+			mapOut->bounds = MakeRecd(pipeline->boundsFilterMin.lon, pipeline->boundsFilterMax.lat,
+				pipeline->boundsFilterMax.lon - pipeline->boundsFilterMin.lon, pipeline->boundsFilterMin.lat - pipeline->boundsFilterMax.lat);
+		}
+	}
+	else if (result == Result_None && block->type == PbfStagedBlockType_Data)
+	{
+		for (uxx gIndex = 0; result == Result_None && gIndex < block->numGroups; gIndex++)
+		{
+			PbfStagedGroup* group = &block->groups[gIndex];
+			ExpandOsmTagsForPbfStagedGroup(mapOut, group);
+			
+			if (group->hasNodes)
+			{
+				TracyCZoneN(Zone_MergeNodes, "MergeNodes", true);
+				ExpandOsmNodes(mapOut, mapOut->nodes.length + group->numNodes);
+				bool areNewNodesSorted = group->areNodesSorted;
+				if (group->numNodes > 0)
+				{
+					OsmNode* lastNode = VarArrayGetLastSoft(OsmNode, &mapOut->nodes);
+					if (lastNode != nullptr && lastNode->id >= group->nodes[0].id) { areNewNodesSorted = false; }
+				}
+				for (uxx nIndex = 0; nIndex < group->numNodes; nIndex++)
+				{
+					//NOTE: Untagged nodes are (almost always) just way vertices, and the ways carry their own copy of the location
+					if (pipeline->useWayLocations && group->nodes[nIndex].numTags == 0) { continue; }
+					MergePbfStagedNode(mapOut, block, &group->nodes[nIndex]);
+				}
+				TracyCZoneEnd(Zone_MergeNodes);
+				
+				//NOTE: We don't sort here, ResolveOsmNodeRefs sorts the nodes (if needed) once all the blobs have been merged
+				if (!areNewNodesSorted) { mapOut->areNodesSorted = false; }
+			}
+			
+			if (group->hasWays)
+			{
+				TracyCZoneN(Zone_MergeWays, "MergeWays", true);
+				bool areNewWaysSorted = group->areWaysSorted;
+				if (group->numWays > 0)
+				{
+					OsmWay* lastWay = VarArrayGetLastSoft(OsmWay, &mapOut->ways);
+					if (lastWay != nullptr && lastWay->id >= group->ways[0].id) { areNewWaysSorted = false; }
+				}
+				for (uxx wIndex = 0; wIndex < group->numWays; wIndex++)
+				{
+					PbfStagedWay* stagedWay = &group->ways[wIndex];
+					bool useLocations = (pipeline->useWayLocations && stagedWay->locations != nullptr);
+					if (useBoundsFilter && useLocations && !DoesPbfStagedWayLocationsHitBoundsFilter(pipeline, stagedWay)) { continue; }
+					if (useBoundsFilter && !useLocations && !DoesPbfStagedWayReferenceMap(mapOut, stagedWay)) { continue; }
+					OsmWay* newWay = AddOsmWayUnresolved(mapOut, stagedWay->id, stagedWay->numNodes, stagedWay->nodeIds);
+					if (useLocations) { SetOsmWayLocations(mapOut, newWay, stagedWay->numNodes, stagedWay->locations); }
+					newWay->visible = stagedWay->visible;
+					newWay->version = stagedWay->version;
+					newWay->uid = stagedWay->uid;
+					newWay->changeset = stagedWay->changeset;
+					AddPbfStagedTags(mapOut, block, stagedWay->numTags, stagedWay->tags, &newWay->tags);
+				}
+				TracyCZoneEnd(Zone_MergeWays);
+				
+				if (!areNewWaysSorted) { mapOut->areWaysSorted = false; }
+				SortOsmWays(mapOut);
+			}
+			
+			if (group->hasRelations)
+			{
+				TracyCZoneN(Zone_MergeRelations, "MergeRelations", true);
+				bool areNewRelationsSorted = group->areRelationsSorted;
+				if (group->numRelations > 0)
+				{
+					OsmRelation* lastRelation = VarArrayGetLastSoft(OsmRelation, &mapOut->relations);
+					if (lastRelation != nullptr && lastRelation->id >= group->relations[0].id) { areNewRelationsSorted = false; }
+				}
+				for (uxx rIndex = 0; rIndex < group->numRelations; rIndex++)
+				{
+					PbfStagedRelation* stagedRelation = &group->relations[rIndex];
+					if (useBoundsFilter && !DoesPbfStagedRelationReferenceMap(mapOut, stagedRelation)) { continue; }
+					OsmRelation* newRelation = AddOsmRelation(mapOut, stagedRelation->id, stagedRelation->numMembers);
+					newRelation->visible = stagedRelation->visible;
+					newRelation->version = stagedRelation->version;
+					newRelation->uid = stagedRelation->uid;
+					newRelation->changeset = stagedRelation->changeset;
+					AddPbfStagedTags(mapOut, block, stagedRelation->numTags, stagedRelation->tags, &newRelation->tags);
+					for (uxx mIndex = 0; mIndex < stagedRelation->numMembers; mIndex++)
+					{
+						PbfStagedMember* stagedMember = &stagedRelation->members[mIndex];
+						OsmRelationMember* newMember = VarArrayAdd(OsmRelationMember, &newRelation->members);
+						NotNull(newMember);
+						ClearPointer(newMember);
+						newMember->id = stagedMember->id;
+						newMember->type = stagedMember->type;
+						newMember->role = stagedMember->role;
+						newMember->index = OSM_INVALID_INDEX; //We'll look it up later
+					}
+				}
+				TracyCZoneEnd(Zone_MergeRelations);
+				
+				if (!areNewRelationsSorted) { mapOut->areRelationsSorted = false; }
+				SortOsmRelations(mapOut);
+			}
+		}
+		
+		if (result == Result_None) { pipeline->foundOsmData = true; }
+	}
+	else if (result == Result_None && block->type == PbfStagedBlockType_Unknown)
+	{
+		pipeline->foundUnknownBlobTypes = true;
+	}
+	
+	if (result == Result_None && pipeline->options.progress != nullptr)
+	{
+		AddOsmLoadProgress(pipeline->options.progress, sizeof(u32) + block->headerLength + block->blobLength, 1);
+		if (block->type == PbfStagedBlockType_Data) { PublishOsmLoadPreview(pipeline->options.progress, mapOut); }
+	}
+	
+	if (result == Result_None && pipeline->buildBlobIndex != nullptr)
+	{
+		PbfBlobIndexEntry* newEntry = VarArrayAdd(PbfBlobIndexEntry, &pipeline->buildBlobIndex->entries);
+		NotNull(newEntry);
+		MyMemCopy(newEntry, &block->indexEntry, sizeof(PbfBlobIndexEntry));
+	}
+	
+	if (result != Result_None)
+	{
+		pipeline->result = result;
+		pipeline->errorBlobIndex = blobIndex;
+	}
+	TracyCZoneEnd(Zone_Func);
+	return (result == Result_None);
+}
+
+// Each job loops Read -> Decode -> Merge until the stream runs out or some blob fails. We queue one of these per worker thread
+// (or run one on the calling thread) so the number of blobs in flight is bounded by the number of threads
+WORKER_JOB_DEF(PbfPipelineJob)
+{
+	PbfPipeline* pipeline = (PbfPipeline*)contextPntr;
+	ScratchBegin1(scratch, pipeline->arena);
+	while (true)
+	{
+		uxx scratchMark = ArenaGetMark(scratch);
+		PbfStagedBlock block = ZEROED;
+		block.arena = scratch;
+		InitVarArray(PbfStagedMessage, &block.messages, scratch);
+		if (!TryReadPbfBlob(pipeline, &block)) { ArenaResetToMark(scratch, scratchMark); break; }
+		if (block.result == Result_None) { DecodePbfStagedBlock(pipeline, &block); }
+		
+		LockThreadMutex(&pipeline->mergeMutex);
+		while (pipeline->nextMergeBlobIndex != block.blobIndex && pipeline->result == Result_None) { WaitThreadCondVar(&pipeline->mergeTurnChanged, &pipeline->mergeMutex); }
+		bool shouldContinue = false;
+		if (pipeline->result == Result_None)
+		{
+			shouldContinue = MergePbfStagedBlock(pipeline, &block);
+			pipeline->nextMergeBlobIndex++;
+			if (!shouldContinue)
+			{
+				//NOTE: Lock order is always mergeMutex -> readMutex so this can't deadlock with the Read stage
+				LockThreadMutex(&pipeline->readMutex);
+				pipeline->isReadFinished = true;
+				UnlockThreadMutex(&pipeline->readMutex);
+			}
+		}
+		WakeAllThreadCondVar(&pipeline->mergeTurnChanged);
+		UnlockThreadMutex(&pipeline->mergeMutex);
+		
+		ArenaResetToMark(scratch, scratchMark);
+		if (!shouldContinue) { break; }
+	}
+	ScratchEnd(scratch);
+}
+
+// Runs the pipeline over the whole source (from the start) with one job per worker thread, or on the calling thread if there's no pool
+void RunPbfPipelinePass(PbfPipeline* pipeline, PbfPipelinePass pass)
+{
+	pipeline->pass = pass;
+	pipeline->mappedReadOffset = 0;
+	pipeline->isReadFinished = false;
+	pipeline->nextReadBlobIndex = 0;
+	pipeline->nextIndexEntry = 0;
+	pipeline->nextMergeBlobIndex = 0;
+	if (pipeline->mappedFile != nullptr) { MappedFileReadahead(pipeline->mappedFile, 0); }
+	
+	WorkerPool* workerPool = pipeline->options.workerPool;
+	if (workerPool != nullptr && workerPool->numThreads > 0)
+	{
+		WorkerWaitGroup waitGroup = ZEROED;
+		InitWorkerWaitGroup(workerPool, &waitGroup);
+		for (uxx tIndex = 0; tIndex < workerPool->numThreads; tIndex++) { WorkerPoolQueueJob(&waitGroup, PbfPipelineJob, pipeline); }
+		WaitForWorkerWaitGroup(&waitGroup);
+	}
+	else { PbfPipelineJob(pipeline); }
+}
+
+// +--------------------------------------------------------------+
+// |                        TryParsePbfMap                        |
+// +--------------------------------------------------------------+
+// Exactly one of protobufStream or mappedFile should be passed. Use TryParsePbfMap or TryParsePbfMappedFile instead of calling this directly
+Result TryParsePbfMapFromSource(Arena* arena, DataStream* protobufStream, MappedFile* mappedFile, const OsmLoadOptions* options, OsmMap* mapOut)
+{
+	TracyCZoneN(Zone_Func, "TryParsePbfMap", true);
+	NotNull(arena);
+	Assert((protobufStream != nullptr) != (mappedFile != nullptr));
+	NotNull(mapOut);
+	
+	PbfPipeline pipeline = ZEROED;
+	pipeline.arena = arena;
+	pipeline.protobufStream = protobufStream;
+	pipeline.mappedFile = mappedFile;
+	if (options != nullptr) { MyMemCopy(&pipeline.options, options, sizeof(OsmLoadOptions)); }
+	pipeline.options.kernelLevel = ResolvePbfKernelLevel(pipeline.options.kernelLevel);
+	pipeline.mapOut = mapOut;
+	pipeline.result = Result_None;
+	if (pipeline.options.useBoundsFilter)
+	{
+		recd filter = pipeline.options.boundsFilter;
+		pipeline.boundsFilterMin = MakeV2d(MinR64(filter.lon, filter.lon + filter.sizeLon), MinR64(filter.lat, filter.lat + filter.sizeLat));
+		pipeline.boundsFilterMax = MakeV2d(MaxR64(filter.lon, filter.lon + filter.sizeLon), MaxR64(filter.lat, filter.lat + filter.sizeLat));
+	}
+	bool keepOnlyWayNodes = (pipeline.options.tagFilter != nullptr && pipeline.options.tagFilterNodes == OsmTagFilterNodes_WayNodes);
+	//NOTE: The bounds filter needs the nodes in the Main pass to decide which ways to keep, and a DataStream can't go back for a second
+	//      pass, so in those cases we load the nodes as usual and remove the ones no way references at the end
+	pipeline.skipNodesInMainPass = (keepOnlyWayNodes && mappedFile != nullptr && !pipeline.options.useBoundsFilter);
+	bool isFiltered = (pipeline.options.useBoundsFilter || pipeline.options.tagFilter != nullptr);
+	if (mappedFile != nullptr && pipeline.options.blobIndex != nullptr && pipeline.options.blobIndex->entries.length > 0) { pipeline.blobIndex = pipeline.options.blobIndex; }
+	if (pipeline.blobIndex != nullptr && !isFiltered)
+	{
+		u64 numNodes = 0;
+		u64 numWays = 0;
+		u64 numRelations = 0;
+		SumPbfBlobIndexCounts(pipeline.blobIndex, &numNodes, &numWays, &numRelations);
+		pipeline.numNodesExpected = (uxx)numNodes;
+		pipeline.numWaysExpected = (uxx)numWays;
+		pipeline.numRelationsExpected = (uxx)numRelations;
+	}
+	if (mappedFile != nullptr && pipeline.options.buildBlobIndex != nullptr && !isFiltered && pipeline.blobIndex == nullptr)
+	{
+		pipeline.buildBlobIndex = pipeline.options.buildBlobIndex;
+		pipeline.buildBlobIndex->sourceFileSize = (u64)mappedFile->size;
+		pipeline.buildBlobIndex->sourceFileHash = CalcPbfBlobIndexSourceHash(mappedFile);
+	}
+	InitThreadMutex(&pipeline.readMutex);
+	InitThreadMutex(&pipeline.mergeMutex);
+	InitThreadCondVar(&pipeline.mergeTurnChanged);
+	
+	RunPbfPipelinePass(&pipeline, PbfPipelinePass_Main);
+	if (pipeline.skippedDataBlobs) { pipeline.foundOsmData = true; }
+	
+	//NOTE: Ways come after the nodes in the file, so by the time we know which nodes (outside the bounds) we need they've already been
+	//      dropped. We go back over the file for those nodes. A DataStream can't be rewound so this only works for mapped files
+	bool needsWayNodesPass = (pipeline.skipNodesInMainPass || (pipeline.options.useBoundsFilter && pipeline.options.keepWayNodesOutsideBounds));
+	bool areNodeRefsResolved = false;
+	if (pipeline.result == Result_None && pipeline.foundOsmData && needsWayNodesPass)
+	{
+		if (mappedFile != nullptr)
+		{
+			TracyCZoneN(Zone_WayNodesPass, "WayNodesPass", true);
+			ScratchBegin1(scratch, arena);
+			ResolveOsmNodeRefs(mapOut);
+			areNodeRefsResolved = true;
+			pipeline.wayNodeIds = GetMissingOsmNodeRefIds(mapOut, scratch, &pipeline.numWayNodeIds);
+			if (pipeline.numWayNodeIds > 0)
+			{
+				PrintLine_D("Going back over the file for %llu node%s that kept ways reference", (u64)pipeline.numWayNodeIds, Plural(pipeline.numWayNodeIds, "s"));
+				RunPbfPipelinePass(&pipeline, PbfPipelinePass_WayNodes);
+			}
+			pipeline.wayNodeIds = nullptr;
+			pipeline.numWayNodeIds = 0;
+			ScratchEnd(scratch);
+			TracyCZoneEnd(Zone_WayNodesPass);
+		}
+		else { NotifyPrint_W("keepWayNodesOutsideBounds only works on memory mapped files, ways that cross the edge of the bounds will be missing nodes"); }
+	}
+	
+	FreeThreadCondVar(&pipeline.mergeTurnChanged);
+	FreeThreadMutex(&pipeline.mergeMutex);
+	FreeThreadMutex(&pipeline.readMutex);
+	
+	#if DEBUG_PBF_CODEC_STATS
+	PrintPbfCodecStats(&pipeline);
+	#endif
+	
+	Result result = pipeline.result;
+	if (result == Result_Canceled) { PrintLine_I("Load was canceled after %llu blob%s", pipeline.errorBlobIndex, Plural(pipeline.errorBlobIndex, "s")); }
+	else if (result != Result_None) { NotifyPrint_E("Got through %llu blobs before encountering: %s", pipeline.errorBlobIndex, GetResultStr(result)); }
+	if (!pipeline.foundOsmData && result != Result_Canceled) { result = pipeline.foundOsmHeader ? (pipeline.foundUnknownBlobTypes ? Result_WrongInternalFormat : Result_MissingData) : Result_MissingHeader; }
+	if (result == Result_None)
+	{
+		result = Result_Success;
+		//NOTE: The nodes the WayNodes pass added went on the end, the refs that were resolved before it still point at the right nodes
+		if (keepOnlyWayNodes && !pipeline.skipNodesInMainPass) { RemoveUnreferencedOsmNodes(mapOut); }
+		else if (areNodeRefsResolved) { SortOsmNodes(mapOut); ResolveMissingOsmNodeRefs(mapOut); }
+		else { ResolveOsmNodeRefs(mapOut); }
+		if (isFiltered)
+		{
+			PrintLine_I("Filters kept %llu node%s, %llu way%s and %llu relation%s",
+				mapOut->nodes.length, Plural(mapOut->nodes.length, "s"),
+				mapOut->ways.length, Plural(mapOut->ways.length, "s"),
+				mapOut->relations.length, Plural(mapOut->relations.length, "s")
+			);
+		}
+		VarArrayLoop(&mapOut->relations, rIndex)
+		{
+			VarArrayLoopGet(OsmRelation, relation, &mapOut->relations, rIndex);
+			ResolveOsmRelationMembers(mapOut, relation, false);
+		}
+		UpdateOsmNodeWayIndices(mapOut);
+		UpdateOsmRelationBackIndices(mapOut);
+		if (pipeline.buildBlobIndex != nullptr) { FinishPbfBlobIndexBounds(pipeline.buildBlobIndex, mapOut); }
+		PrintLine_D("Interned %llu tag string%s as %llu unique string%s (%llu bytes in the pool, %llu bytes as separate strings)",
+			mapOut->stringPool.numInterned, Plural(mapOut->stringPool.numInterned, "s"),
+			mapOut->stringPool.entries.length, Plural(mapOut->stringPool.entries.length, "s"),
+			GetOsmStringPoolMemoryUsage(&mapOut->stringPool), mapOut->stringPool.numInternedBytes
+		);
+	}
+	else if (pipeline.foundOsmHeader) { FreeOsmMap(mapOut); }
+	if (result != Result_Success && pipeline.buildBlobIndex != nullptr) { VarArrayClear(&pipeline.buildBlobIndex->entries); }
+	TracyCZoneEnd(Zone_Func);
+	return result;
+}
+
+// Pass nullptr for options (or leave options->workerPool nullptr) to do all the work on the calling thread.
+// The resulting map is identical no matter which options are used, only the time it takes changes
+Result TryParsePbfMap(Arena* arena, DataStream* protobufStream, const OsmLoadOptions* options, OsmMap* mapOut)
+{
+	NotNull(protobufStream);
+	return TryParsePbfMapFromSource(arena, protobufStream, nullptr, options, mapOut);
+}
+
+// Same as TryParsePbfMap but the blob bytes are referenced in place in the mapped file rather than being read into scratch arenas.
+// The mappedFile must stay open until this returns, nothing in the resulting map points into it
+Result TryParsePbfMappedFile(Arena* arena, MappedFile* mappedFile, const OsmLoadOptions* options, OsmMap* mapOut)
+{
+	NotNull(mappedFile);
+	NotNull(mappedFile->bytes);
+	return TryParsePbfMapFromSource(arena, nullptr, mappedFile, options, mapOut);
+}
+
+// +--------------------------------------------------------------+
+// |                     Parallel Encode Types                    |
+// +--------------------------------------------------------------+
+#define PBF_WRITE_BLOCK_SIZE      8000 //primitives per PrimitiveBlock, the same as osmium and osmosis use
+#define PBF_WRITE_COORD_MULT      10000000.0 //we always use the default granularity of 100 nanodegrees
+#define PBF_WRITE_CODEC           PbfCodec_Zlib
+
+typedef enum PbfWriteBlockType PbfWriteBlockType;
+enum PbfWriteBlockType
+{
+	PbfWriteBlockType_None = 0,
+	PbfWriteBlockType_Nodes,
+	PbfWriteBlockType_Ways,
+	PbfWriteBlockType_Relations,
+	PbfWriteBlockType_Count,
+};
+
+// Every PrimitiveBlock is encoded and compressed on whichever thread grabs it, the framed blobs are then appended to output in block order
+typedef plex PbfWriter PbfWriter;
+plex PbfWriter
+{
+	Arena* arena;
+	OsmMap* map;
+	PbfCodec codec;
+	bool isHistorical; //some primitive is not visible, so every block needs the visible flags
+	uxx numNodeBlocks;
+	uxx numWayBlocks;
+	uxx numRelationBlocks;
+	uxx numBlocks;
+	
+	ThreadMutex encodeMutex;
+	uxx nextEncodeBlockIndex;
+	
+	ThreadMutex outputMutex;
+	ThreadCondVar outputTurnChanged;
+	uxx nextOutputBlockIndex;
+	PbfWireWriter output;
+	uxx numRawBytes;
+	uxx numCompressedBytes;
+};
+
+// One column per Info field. DenseInfo gets all the values for a block (delta coded), a plain Info only ever holds one primitive's values
+typedef plex PbfInfoColumns PbfInfoColumns;
+plex PbfInfoColumns
+{
+	bool isDense;
+	bool haveVersions;
+	bool haveTimestamps;
+	bool haveChangesets;
+	bool haveUids;
+	bool haveUsers;
+	PbfWireWriter versions;
+	PbfWireWriter timestamps;
+	PbfWireWriter changesets;
+	PbfWireWriter uids;
+	PbfWireWriter userSids;
+	PbfWireWriter visibles;
+	i64 prevTimestamp;
+	i64 prevChangeset;
+	i64 prevUid;
+	i64 prevUserSid;
+};
+
+// Everything in here lives in the scratch arena of the thread encoding the block. The writers are reused for every primitive in the block
+typedef plex PbfBlockEncoder PbfBlockEncoder;
+plex PbfBlockEncoder
+{
+	PbfWriter* writer;
+	Arena* scratch;
+	OsmStringPool strings; //the block's string table, id 0 is always the empty string
+	PbfInfoColumns infoColumns;
+	PbfWireWriter info;
+	PbfWireWriter keys;
+	PbfWireWriter vals;
+	PbfWireWriter primitive; //the Way or Relation currently being written
+	PbfWireWriter group;
+};
+
+// +--------------------------------------------------------------+
+// |                    Parallel Encode Stages                    |
+// +--------------------------------------------------------------+
+// Parses "2017-07-11T21:17:35Z" into seconds since 1970, which is what Info.timestamp holds with the default date_granularity
+bool TryParseOsmTimestamp(Str8 timestampStr, i64* secondsOut)
+{
+	if (timestampStr.length < 19) { return false; }
+	const uxx digitIndices[14] = { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+	i64 digits[14];
+	for (uxx dIndex = 0; dIndex < ArrayCount(digitIndices); dIndex++)
+	{
+		char c = timestampStr.chars[digitIndices[dIndex]];
+		if (c < '0' || c > '9') { return false; }
+		digits[dIndex] = (i64)(c - '0');
+	}
+	i64 year   = digits[0]*1000 + digits[1]*100 + digits[2]*10 + digits[3];
+	i64 month  = digits[4]*10 + digits[5];
+	i64 day    = digits[6]*10 + digits[7];
+	i64 hour   = digits[8]*10 + digits[9];
+	i64 minute = digits[10]*10 + digits[11];
+	i64 second = digits[12]*10 + digits[13];
+	if (month < 1 || month > 12 || day < 1 || day > 31) { return false; }
+	
+	//Days since 1970-01-01 for a proleptic Gregorian date, see http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+	i64 shiftedYear = (month <= 2) ? year - 1 : year;
+	i64 era = (shiftedYear >= 0 ? shiftedYear : shiftedYear - 399) / 400;
+	i64 yearOfEra = shiftedYear - era * 400;
+	i64 dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	i64 dayOfEra = yearOfEra * 365 + yearOfEra/4 - yearOfEra/100 + dayOfYear;
+	i64 numDays = era * 146097 + dayOfEra - 719468;
+	
+	if (secondsOut != nullptr) { *secondsOut = ((numDays * 24 + hour) * 60 + minute) * 60 + second; }
+	return true;
+}
+
+i64 GetPbfWriteCoordinate(r64 degrees)
+{
+	return RoundR64i(degrees * PBF_WRITE_COORD_MULT);
+}
+// Fixed-point locations are already in the units we write (OSM_COORD_FIXED_SCALE matches PBF_WRITE_COORD_MULT) so they don't go through doubles at all
+void GetPbfWriteLocation(OsmLocation location, i64* latOut, i64* lonOut)
+{
+	#if OSM_FIXED_POINT_LOCATIONS
+	*latOut = (i64)location.lat;
+	*lonOut = (i64)location.lon;
+	#else
+	*latOut = GetPbfWriteCoordinate(location.lat);
+	*lonOut = GetPbfWriteCoordinate(location.lon);
+	#endif
+}
+
+void InitPbfInfoColumns(Arena* scratch, bool isDense, uxx numPrimitives, PbfInfoColumns* columnsOut)
+{
+	ClearPointer(columnsOut);
+	columnsOut->isDense = isDense;
+	InitPbfWireWriter(scratch, numPrimitives, &columnsOut->versions);
+	InitPbfWireWriter(scratch, numPrimitives * 2, &columnsOut->timestamps);
+	InitPbfWireWriter(scratch, numPrimitives * 2, &columnsOut->changesets);
+	InitPbfWireWriter(scratch, numPrimitives, &columnsOut->uids);
+	InitPbfWireWriter(scratch, numPrimitives, &columnsOut->userSids);
+	InitPbfWireWriter(scratch, numPrimitives, &columnsOut->visibles);
+}
+
+void ResetPbfInfoColumns(PbfInfoColumns* columns)
+{
+	columns->haveVersions = false;
+	columns->haveTimestamps = false;
+	columns->haveChangesets = false;
+	columns->haveUids = false;
+	columns->haveUsers = false;
+	ResetPbfWireWriter(&columns->versions);
+	ResetPbfWireWriter(&columns->timestamps);
+	ResetPbfWireWriter(&columns->changesets);
+	ResetPbfWireWriter(&columns->uids);
+	ResetPbfWireWriter(&columns->userSids);
+	ResetPbfWireWriter(&columns->visibles);
+}
+
+// NOTE: DenseInfo columns are sint32/sint64 and delta coded (except version), a plain Info message uses regular int32/int64 varints
+void AddPbfInfoColumns(PbfBlockEncoder* encoder, i32 version, Str8 timestampStr, u64 changeset, u64 uid, Str8 user, bool visible)
+{
+	PbfInfoColumns* columns = &encoder->infoColumns;
+	i64 timestamp = 0;
+	if (TryParseOsmTimestamp(timestampStr, &timestamp)) { columns->haveTimestamps = true; }
+	i64 userSid = IsEmptyStr(user) ? 0 : (i64)InternOsmString(&encoder->strings, user);
+	if (version > 0) { columns->haveVersions = true; }
+	if (changeset != 0) { columns->haveChangesets = true; }
+	if (uid != 0) { columns->haveUids = true; }
+	if (userSid != 0) { columns->haveUsers = true; }
+	
+	PbfWireWriteVarint(&columns->versions, (u64)(i64)version);
+	if (columns->isDense)
+	{
+		PbfWireWriteVarint(&columns->timestamps, PbfZigZagEncode(timestamp - columns->prevTimestamp));
+		PbfWireWriteVarint(&columns->changesets, PbfZigZagEncode((i64)changeset - columns->prevChangeset));
+		PbfWireWriteVarint(&columns->uids, PbfZigZagEncode((i64)uid - columns->prevUid));
+		PbfWireWriteVarint(&columns->userSids, PbfZigZagEncode(userSid - columns->prevUserSid));
+		columns->prevTimestamp = timestamp;
+		columns->prevChangeset = (i64)changeset;
+		columns->prevUid = (i64)uid;
+		columns->prevUserSid = userSid;
+	}
+	else
+	{
+		PbfWireWriteVarint(&columns->timestamps, (u64)timestamp);
+		PbfWireWriteVarint(&columns->changesets, changeset);
+		PbfWireWriteVarint(&columns->uids, uid);
+		PbfWireWriteVarint(&columns->userSids, (u64)userSid);
+	}
+	PbfWireWriteVarint(&columns->visibles, visible ? 1 : 0);
+}
+
+// Writes the DenseInfo (packed) or Info message, leaving out any column that didn't have anything worth writing
+void WritePbfInfoColumns(PbfBlockEncoder* encoder, PbfWireWriter* writer, u32 fieldNumber)
+{
+	PbfInfoColumns* columns = &encoder->infoColumns;
+	bool isHistorical = encoder->writer->isHistorical;
+	PbfWireWriter* columnWriters[6] = { &columns->versions, &columns->timestamps, &columns->changesets, &columns->uids, &columns->userSids, &columns->visibles };
+	bool haveColumns[6] = { columns->haveVersions, columns->haveTimestamps, columns->haveChangesets, columns->haveUids, columns->haveUsers, isHistorical };
+	
+	ResetPbfWireWriter(&encoder->info);
+	for (uxx cIndex = 0; cIndex < ArrayCount(columnWriters); cIndex++)
+	{
+		if (!haveColumns[cIndex]) { continue; }
+		u32 columnFieldNumber = (u32)(cIndex + 1);
+		if (columns->isDense) { PbfWireWriteSliceField(&encoder->info, columnFieldNumber, GetPbfWireWriterSlice(columnWriters[cIndex])); }
+		else
+		{
+			PbfWireWriteFieldKey(&encoder->info, columnFieldNumber, PbfWireType_Varint);
+			PbfWireWriteBytes(&encoder->info, GetPbfWireWriterSlice(columnWriters[cIndex]));
+		}
+	}
+	if (encoder->info.length > 0) { PbfWireWriteSliceField(writer, fieldNumber, GetPbfWireWriterSlice(&encoder->info)); }
+}
+
+// Writes keys (field 2) and vals (field 3) the way Way and Relation messages store their tags
+void WritePbfTagFields(PbfBlockEncoder* encoder, PbfWireWriter* writer, OsmTagRange tagRange)
+{
+	if (tagRange.count == 0) { return; }
+	ResetPbfWireWriter(&encoder->keys);
+	ResetPbfWireWriter(&encoder->vals);
+	const OsmTag* tags = GetOsmTags(encoder->writer->map, tagRange);
+	for (u32 tIndex = 0; tIndex < tagRange.count; tIndex++)
+	{
+		PbfWireWriteVarint(&encoder->keys, (u64)InternOsmString(&encoder->strings, tags[tIndex].key));
+		PbfWireWriteVarint(&encoder->vals, (u64)InternOsmString(&encoder->strings, tags[tIndex].value));
+	}
+	PbfWireWriteSliceField(writer, 2, GetPbfWireWriterSlice(&encoder->keys));
+	PbfWireWriteSliceField(writer, 3, GetPbfWireWriterSlice(&encoder->vals));
+}
+
+void EncodePbfDenseNodes(PbfBlockEncoder* encoder, uxx startIndex, uxx endIndex)
+{
+	TracyCZoneN(Zone_Func, "EncodePbfDenseNodes", true);
+	Arena* scratch = encoder->scratch;
+	uxx numNodes = endIndex - startIndex;
+	PbfWireWriter idsWriter;
+	PbfWireWriter latsWriter;
+	PbfWireWriter lonsWriter;
+	PbfWireWriter keysValsWriter;
+	InitPbfWireWriter(scratch, numNodes * 2, &idsWriter);
+	InitPbfWireWriter(scratch, numNodes * 4, &latsWriter);
+	InitPbfWireWriter(scratch, numNodes * 4, &lonsWriter);
+	InitPbfWireWriter(scratch, numNodes, &keysValsWriter);
+	InitPbfInfoColumns(scratch, true, numNodes, &encoder->infoColumns);
+	
+	bool haveTags = false;
+	i64 prevId = 0;
+	i64 prevLat = 0;
+	i64 prevLon = 0;
+	for (uxx nIndex = startIndex; nIndex < endIndex; nIndex++)
+	{
+		OsmNode* node = VarArrayGet(OsmNode, &encoder->writer->map->nodes, nIndex);
+		OsmNodeInfo* info = VarArrayGet(OsmNodeInfo, &encoder->writer->map->nodeInfos, nIndex);
+		i64 nodeLat = 0;
+		i64 nodeLon = 0;
+		GetPbfWriteLocation(*VarArrayGet(OsmLocation, &encoder->writer->map->nodeLocations, nIndex), &nodeLat, &nodeLon);
+		PbfWireWriteVarint(&idsWriter, PbfZigZagEncode((i64)node->id - prevId));
+		PbfWireWriteVarint(&latsWriter, PbfZigZagEncode(nodeLat - prevLat));
+		PbfWireWriteVarint(&lonsWriter, PbfZigZagEncode(nodeLon - prevLon));
+		prevId = (i64)node->id;
+		prevLat = nodeLat;
+		prevLon = nodeLon;
+		AddPbfInfoColumns(encoder, info->version, info->timestampStr, info->changeset, info->uid, info->user, info->visible);
+		
+		const OsmTag* nodeTags = GetOsmTags(encoder->writer->map, node->tags);
+		for (u32 tIndex = 0; tIndex < node->tags.count; tIndex++)
+		{
+			PbfWireWriteVarint(&keysValsWriter, (u64)InternOsmString(&encoder->strings, nodeTags[tIndex].key));
+			PbfWireWriteVarint(&keysValsWriter, (u64)InternOsmString(&encoder->strings, nodeTags[tIndex].value));
+			haveTags = true;
+		}
+		PbfWireWriteVarint(&keysValsWriter, 0);
+	}
+	
+	PbfWireWriter denseWriter;
+	InitPbfWireWriter(scratch, idsWriter.length + latsWriter.length + lonsWriter.length + keysValsWriter.length + Kilobytes(4), &denseWriter);
+	PbfWireWriteSliceField(&denseWriter, 1, GetPbfWireWriterSlice(&idsWriter));
+	WritePbfInfoColumns(encoder, &denseWriter, 5);
+	PbfWireWriteSliceField(&denseWriter, 8, GetPbfWireWriterSlice(&latsWriter));
+	PbfWireWriteSliceField(&denseWriter, 9, GetPbfWireWriterSlice(&lonsWriter));
+	//NOTE: keys_vals can be left out entirely when none of the nodes have tags
+	if (haveTags) { PbfWireWriteSliceField(&denseWriter, 10, GetPbfWireWriterSlice(&keysValsWriter)); }
+	PbfWireWriteSliceField(&encoder->group, 2, GetPbfWireWriterSlice(&denseWriter));
+	TracyCZoneEnd(Zone_Func);
+}
+
+void EncodePbfWays(PbfBlockEncoder* encoder, uxx startIndex, uxx endIndex)
+{
+	TracyCZoneN(Zone_Func, "EncodePbfWays", true);
+	Arena* scratch = encoder->scratch;
+	PbfWireWriter refsWriter;
+	PbfWireWriter latsWriter;
+	PbfWireWriter lonsWriter;
+	InitPbfWireWriter(scratch, 256, &refsWriter);
+	InitPbfWireWriter(scratch, 256, &latsWriter);
+	InitPbfWireWriter(scratch, 256, &lonsWriter);
+	InitPbfInfoColumns(scratch, false, 1, &encoder->infoColumns);
+	
+	for (uxx wIndex = startIndex; wIndex < endIndex; wIndex++)
+	{
+		OsmWay* way = VarArrayGet(OsmWay, &encoder->writer->map->ways, wIndex);
+		ResetPbfWireWriter(&encoder->primitive);
+		ResetPbfWireWriter(&refsWriter);
+		ResetPbfWireWriter(&latsWriter);
+		ResetPbfWireWriter(&lonsWriter);
+		ResetPbfInfoColumns(&encoder->infoColumns);
+		
+		PbfWireWriteVarintField(&encoder->primitive, 1, way->id);
+		WritePbfTagFields(encoder, &encoder->primitive, way->tags);
+		AddPbfInfoColumns(encoder, way->version, way->timestampStr, way->changeset, way->uid, way->user, way->visible);
+		WritePbfInfoColumns(encoder, &encoder->primitive, 4);
+		
+		bool haveLocations = (way->locations.length > 0 && way->locations.length == way->nodes.length);
+		i64 prevRef = 0;
+		i64 prevLat = 0;
+		i64 prevLon = 0;
+		VarArrayLoop(&way->nodes, nIndex)
+		{
+			VarArrayLoopGet(OsmNodeRef, nodeRef, &way->nodes, nIndex);
+			PbfWireWriteVarint(&refsWriter, PbfZigZagEncode((i64)nodeRef->id - prevRef));
+			prevRef = (i64)nodeRef->id;
+			if (haveLocations)
+			{
+				i64 wayLat = 0;
+				i64 wayLon = 0;
+				GetPbfWriteLocation(((OsmLocation*)way->locations.items)[nIndex], &wayLat, &wayLon);
+				PbfWireWriteVarint(&latsWriter, PbfZigZagEncode(wayLat - prevLat));
+				PbfWireWriteVarint(&lonsWriter, PbfZigZagEncode(wayLon - prevLon));
+				prevLat = wayLat;
+				prevLon = wayLon;
+			}
+		}
+		if (way->nodes.length > 0) { PbfWireWriteSliceField(&encoder->primitive, 8, GetPbfWireWriterSlice(&refsWriter)); }
+		if (haveLocations)
+		{
+			PbfWireWriteSliceField(&encoder->primitive, 9, GetPbfWireWriterSlice(&latsWriter));
+			PbfWireWriteSliceField(&encoder->primitive, 10, GetPbfWireWriterSlice(&lonsWriter));
+		}
+		PbfWireWriteSliceField(&encoder->group, 3, GetPbfWireWriterSlice(&encoder->primitive));
+	}
+	TracyCZoneEnd(Zone_Func);
+}
+
+u64 GetPbfRelationMemberTypeValue(OsmRelationMemberType memberType)
+{
+	switch (memberType)
+	{
+		case OsmRelationMemberType_Node:     return OSMPBF__RELATION__MEMBER_TYPE__NODE;
+		case OsmRelationMemberType_Way:      return OSMPBF__RELATION__MEMBER_TYPE__WAY;
+		case OsmRelationMemberType_Relation: return OSMPBF__RELATION__MEMBER_TYPE__RELATION;
+		default: return OSMPBF__RELATION__MEMBER_TYPE__NODE;
+	}
+}
+
+void EncodePbfRelations(PbfBlockEncoder* encoder, uxx startIndex, uxx endIndex)
+{
+	TracyCZoneN(Zone_Func, "EncodePbfRelations", true);
+	Arena* scratch = encoder->scratch;
+	PbfWireWriter rolesWriter;
+	PbfWireWriter memIdsWriter;
+	PbfWireWriter typesWriter;
+	InitPbfWireWriter(scratch, 64, &rolesWriter);
+	InitPbfWireWriter(scratch, 256, &memIdsWriter);
+	InitPbfWireWriter(scratch, 64, &typesWriter);
+	InitPbfInfoColumns(scratch, false, 1, &encoder->infoColumns);
+	
+	for (uxx rIndex = startIndex; rIndex < endIndex; rIndex++)
+	{
+		OsmRelation* relation = VarArrayGet(OsmRelation, &encoder->writer->map->relations, rIndex);
+		ResetPbfWireWriter(&encoder->primitive);
+		ResetPbfWireWriter(&rolesWriter);
+		ResetPbfWireWriter(&memIdsWriter);
+		ResetPbfWireWriter(&typesWriter);
+		ResetPbfInfoColumns(&encoder->infoColumns);
+		
+		PbfWireWriteVarintField(&encoder->primitive, 1, relation->id);
+		WritePbfTagFields(encoder, &encoder->primitive, relation->tags);
+		AddPbfInfoColumns(encoder, relation->version, relation->timestampStr, relation->changeset, relation->uid, relation->user, relation->visible);
+		WritePbfInfoColumns(encoder, &encoder->primitive, 4);
+		
+		i64 prevMemberId = 0;
+		VarArrayLoop(&relation->members, mIndex)
+		{
+			VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
+			Str8 roleStr = MakeStr8Nt(GetOsmRelationMemberRoleXmlStr(member->role));
+			PbfWireWriteVarint(&rolesWriter, (u64)InternOsmString(&encoder->strings, roleStr));
+			PbfWireWriteVarint(&memIdsWriter, PbfZigZagEncode((i64)member->id - prevMemberId));
+			PbfWireWriteVarint(&typesWriter, GetPbfRelationMemberTypeValue(member->type));
+			prevMemberId = (i64)member->id;
+		}
+		if (relation->members.length > 0)
+		{
+			PbfWireWriteSliceField(&encoder->primitive, 8, GetPbfWireWriterSlice(&rolesWriter));
+			PbfWireWriteSliceField(&encoder->primitive, 9, GetPbfWireWriterSlice(&memIdsWriter));
+			PbfWireWriteSliceField(&encoder->primitive, 10, GetPbfWireWriterSlice(&typesWriter));
+		}
+		PbfWireWriteSliceField(&encoder->group, 4, GetPbfWireWriterSlice(&encoder->primitive));
+	}
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Returns the uncompressed PrimitiveBlock: the block's string table and a single PrimitiveGroup that holds only one kind of primitive
+Slice EncodePbfPrimitiveBlock(PbfWriter* writer, Arena* scratch, uxx blockIndex)
+{
+	TracyCZoneN(Zone_Func, "EncodePbfPrimitiveBlock", true);
+	PbfWriteBlockType blockType = PbfWriteBlockType_Nodes;
+	uxx typeBlockIndex = blockIndex;
+	uxx numPrimitives = writer->map->nodes.length;
+	if (typeBlockIndex >= writer->numNodeBlocks)
+	{
+		typeBlockIndex -= writer->numNodeBlocks;
+		blockType = PbfWriteBlockType_Ways;
+		numPrimitives = writer->map->ways.length;
+		if (typeBlockIndex >= writer->numWayBlocks)
+		{
+			typeBlockIndex -= writer->numWayBlocks;
+			blockType = PbfWriteBlockType_Relations;
+			numPrimitives = writer->map->relations.length;
+		}
+	}
+	uxx startIndex = typeBlockIndex * PBF_WRITE_BLOCK_SIZE;
+	uxx endIndex = MinUXX(startIndex + PBF_WRITE_BLOCK_SIZE, numPrimitives);
+	Assert(startIndex < endIndex);
+	
+	PbfBlockEncoder encoder = ZEROED;
+	encoder.writer = writer;
+	encoder.scratch = scratch;
+	InitOsmStringPool(scratch, &encoder.strings);
+	u32 emptyStringId = InternOsmString(&encoder.strings, Str8_Empty);
+	Assert(emptyStringId == 0);
+	UNUSED(emptyStringId);
+	InitPbfWireWriter(scratch, 64, &encoder.info);
+	InitPbfWireWriter(scratch, 64, &encoder.keys);
+	InitPbfWireWriter(scratch, 64, &encoder.vals);
+	InitPbfWireWriter(scratch, 256, &encoder.primitive);
+	InitPbfWireWriter(scratch, Kilobytes(64), &encoder.group);
+	switch (blockType)
+	{
+		case PbfWriteBlockType_Nodes:     EncodePbfDenseNodes(&encoder, startIndex, endIndex); break;
+		case PbfWriteBlockType_Ways:      EncodePbfWays(&encoder, startIndex, endIndex); break;
+		case PbfWriteBlockType_Relations: EncodePbfRelations(&encoder, startIndex, endIndex); break;
+		default: Assert(false); break;
+	}
+	
+	PbfWireWriter tableWriter;
+	InitPbfWireWriter(scratch, encoder.strings.numStoredBytes + (encoder.strings.entries.length * 4), &tableWriter);
+	VarArrayLoop(&encoder.strings.entries, eIndex)
+	{
+		VarArrayLoopGet(OsmStringPoolEntry, entry, &encoder.strings.entries, eIndex);
+		PbfWireWriteStrField(&tableWriter, 1, entry->str);
+	}
+	
+	PbfWireWriter blockWriter;
+	InitPbfWireWriter(scratch, tableWriter.length + encoder.group.length + 16, &blockWriter);
+	PbfWireWriteSliceField(&blockWriter, 1, GetPbfWireWriterSlice(&tableWriter));
+	PbfWireWriteSliceField(&blockWriter, 2, GetPbfWireWriterSlice(&encoder.group));
+	TracyCZoneEnd(Zone_Func);
+	return GetPbfWireWriterSlice(&blockWriter);
+}
+
+u32 GetPbfBlobFieldForCodec(PbfCodec codec)
+{
+	switch (codec)
+	{
+		case PbfCodec_Raw:   return 1;
+		case PbfCodec_Zlib:  return 3;
+		case PbfCodec_Lzma:  return 4;
+		case PbfCodec_Bzip2: return 5;
+		case PbfCodec_Lz4:   return 6;
+		case PbfCodec_Zstd:  return 7;
+		default: return 0;
+	}
+}
+
+// Compresses rawData into a Blob and puts the BlobHeader (and its big-endian length) in front of it, ready to be written to the file
+Slice EncodePbfFramedBlob(Arena* arena, Str8 typeStr, PbfCodec codec, Slice rawData, uxx* compressedSizeOut)
+{
+	const PbfCodecInfo* codecInfo = GetPbfCodecInfo(codec);
+	NotNull(codecInfo->Compress);
+	Slice compressedData = codecInfo->Compress(arena, rawData);
+	if (compressedSizeOut != nullptr) { *compressedSizeOut = compressedData.length; }
+	
+	PbfWireWriter blobWriter;
+	InitPbfWireWriter(arena, compressedData.length + 16, &blobWriter);
+	if (codec != PbfCodec_Raw) { PbfWireWriteVarintField(&blobWriter, 2, (u64)rawData.length); }
+	PbfWireWriteSliceField(&blobWriter, GetPbfBlobFieldForCodec(codec), compressedData);
+	
+	PbfWireWriter headerWriter;
+	InitPbfWireWriter(arena, 32, &headerWriter);
+	PbfWireWriteStrField(&headerWriter, 1, typeStr);
+	PbfWireWriteVarintField(&headerWriter, 3, (u64)blobWriter.length);
+	
+	PbfWireWriter framedWriter;
+	InitPbfWireWriter(arena, 4 + headerWriter.length + blobWriter.length, &framedWriter);
+	u8 headerLengthBytes[4] = { (u8)(headerWriter.length >> 24), (u8)(headerWriter.length >> 16), (u8)(headerWriter.length >> 8), (u8)(headerWriter.length >> 0) };
+	PbfWireWriteBytes(&framedWriter, MakeSlice(ArrayCount(headerLengthBytes), &headerLengthBytes[0]));
+	PbfWireWriteBytes(&framedWriter, GetPbfWireWriterSlice(&headerWriter));
+	PbfWireWriteBytes(&framedWriter, GetPbfWireWriterSlice(&blobWriter));
+	return GetPbfWireWriterSlice(&framedWriter);
+}
+
+Slice EncodePbfHeaderBlock(Arena* arena, OsmMap* map, bool isHistorical)
+{
+	v2d boundsMin = MakeV2d(MinR64(map->bounds.lon, map->bounds.lon + map->bounds.sizeLon), MinR64(map->bounds.lat, map->bounds.lat + map->bounds.sizeLat));
+	v2d boundsMax = MakeV2d(MaxR64(map->bounds.lon, map->bounds.lon + map->bounds.sizeLon), MaxR64(map->bounds.lat, map->bounds.lat + map->bounds.sizeLat));
+	PbfWireWriter bboxWriter;
+	InitPbfWireWriter(arena, 64, &bboxWriter);
+	PbfWireWriteVarintField(&bboxWriter, 1, PbfZigZagEncode(RoundR64i(boundsMin.lon / (r64)Nano(1)))); //left
+	PbfWireWriteVarintField(&bboxWriter, 2, PbfZigZagEncode(RoundR64i(boundsMax.lon / (r64)Nano(1)))); //right
+	PbfWireWriteVarintField(&bboxWriter, 3, PbfZigZagEncode(RoundR64i(boundsMax.lat / (r64)Nano(1)))); //top
+	PbfWireWriteVarintField(&bboxWriter, 4, PbfZigZagEncode(RoundR64i(boundsMin.lat / (r64)Nano(1)))); //bottom
+	
+	bool hasWayLocations = false;
+	VarArrayLoop(&map->ways, wIndex)
+	{
+		VarArrayLoopGet(OsmWay, way, &map->ways, wIndex);
+		if (way->locations.length > 0 && way->locations.length == way->nodes.length) { hasWayLocations = true; break; }
+	}
+	
+	PbfWireWriter headerWriter;
+	InitPbfWireWriter(arena, 256, &headerWriter);
+	PbfWireWriteSliceField(&headerWriter, 1, GetPbfWireWriterSlice(&bboxWriter));
+	PbfWireWriteStrField(&headerWriter, 4, StrLit("OsmSchema-V0.6"));
+	PbfWireWriteStrField(&headerWriter, 4, StrLit("DenseNodes"));
+	if (isHistorical) { PbfWireWriteStrField(&headerWriter, 4, StrLit("HistoricalInformation")); }
+	if (map->areNodesSorted && map->areWaysSorted && map->areRelationsSorted) { PbfWireWriteStrField(&headerWriter, 5, StrLit("Sort.Type_then_ID")); }
+	if (hasWayLocations) { PbfWireWriteStrField(&headerWriter, 5, StrLit("LocationsOnWays")); }
+	PbfWireWriteStrField(&headerWriter, 16, StrLit("COSM 1.0"));
+	return GetPbfWireWriterSlice(&headerWriter);
+}
+
+bool IsOsmMapHistorical(const OsmMap* map)
+{
+	VarArrayLoop(&map->nodeInfos, nIndex) { VarArrayLoopGet(OsmNodeInfo, info, &map->nodeInfos, nIndex); if (!info->visible) { return true; } }
+	VarArrayLoop(&map->ways, wIndex) { VarArrayLoopGet(OsmWay, way, &map->ways, wIndex); if (!way->visible) { return true; } }
+	VarArrayLoop(&map->relations, rIndex) { VarArrayLoopGet(OsmRelation, relation, &map->relations, rIndex); if (!relation->visible) { return true; } }
+	return false;
+}
+
+// Each job grabs the next block, encodes and compresses it in its scratch arena and then waits for its turn to append it to the output.
+// Like PbfPipelineJob we queue one of these per worker thread (or run one on the calling thread)
+WORKER_JOB_DEF(PbfWriterJob)
+{
+	PbfWriter* writer = (PbfWriter*)contextPntr;
+	ScratchBegin1(scratch, writer->arena);
+	while (true)
+	{
+		LockThreadMutex(&writer->encodeMutex);
+		uxx blockIndex = writer->nextEncodeBlockIndex;
+		if (blockIndex < writer->numBlocks) { writer->nextEncodeBlockIndex++; }
+		UnlockThreadMutex(&writer->encodeMutex);
+		if (blockIndex >= writer->numBlocks) { break; }
+		
+		uxx scratchMark = ArenaGetMark(scratch);
+		Slice rawBlock = EncodePbfPrimitiveBlock(writer, scratch, blockIndex);
+		uxx compressedSize = 0;
+		Slice framedBlob = EncodePbfFramedBlob(scratch, StrLit("OSMData"), writer->codec, rawBlock, &compressedSize);
+		
+		LockThreadMutex(&writer->outputMutex);
+		while (writer->nextOutputBlockIndex != blockIndex) { WaitThreadCondVar(&writer->outputTurnChanged, &writer->outputMutex); }
+		PbfWireWriteBytes(&writer->output, framedBlob);
+		writer->numRawBytes += rawBlock.length;
+		writer->numCompressedBytes += compressedSize;
+		writer->nextOutputBlockIndex++;
+		WakeAllThreadCondVar(&writer->outputTurnChanged);
+		UnlockThreadMutex(&writer->outputMutex);
+		
+		ArenaResetToMark(scratch, scratchMark);
+	}
+	ScratchEnd(scratch);
+}
+
+// +--------------------------------------------------------------+
+// |                       SerializePbfMap                        |
+// +--------------------------------------------------------------+
+// Writes the whole map as an OSMHeader blob followed by zlib compressed OSMData blobs of at most PBF_WRITE_BLOCK_SIZE nodes, ways
+// or relations each. Pass nullptr for workerPool to do all the work on the calling thread, the output is identical either way
+Slice SerializePbfMap(Arena* arena, OsmMap* map, WorkerPool* workerPool)
+{
+	TracyCZoneN(Zone_Func, "SerializePbfMap", true);
+	NotNull(arena);
+	NotNull(map);
+	
+	PbfWriter writer = ZEROED;
+	writer.arena = arena;
+	writer.map = map;
+	writer.codec = PBF_WRITE_CODEC;
+	writer.isHistorical = IsOsmMapHistorical(map);
+	writer.numNodeBlocks = (map->nodes.length + PBF_WRITE_BLOCK_SIZE-1) / PBF_WRITE_BLOCK_SIZE;
+	writer.numWayBlocks = (map->ways.length + PBF_WRITE_BLOCK_SIZE-1) / PBF_WRITE_BLOCK_SIZE;
+	writer.numRelationBlocks = (map->relations.length + PBF_WRITE_BLOCK_SIZE-1) / PBF_WRITE_BLOCK_SIZE;
+	writer.numBlocks = writer.numNodeBlocks + writer.numWayBlocks + writer.numRelationBlocks;
+	InitPbfWireWriter(arena, Megabytes(1), &writer.output);
+	
+	{
+		ScratchBegin1(scratch, arena);
+		Slice headerBlock = EncodePbfHeaderBlock(scratch, map, writer.isHistorical);
+		Slice framedHeader = EncodePbfFramedBlob(scratch, StrLit("OSMHeader"), writer.codec, headerBlock, nullptr);
+		PbfWireWriteBytes(&writer.output, framedHeader);
+		ScratchEnd(scratch);
+	}
+	
+	InitThreadMutex(&writer.encodeMutex);
+	InitThreadMutex(&writer.outputMutex);
+	InitThreadCondVar(&writer.outputTurnChanged);
+	if (workerPool != nullptr && workerPool->numThreads > 0)
+	{
+		WorkerWaitGroup waitGroup = ZEROED;
+		InitWorkerWaitGroup(workerPool, &waitGroup);
+		for (uxx tIndex = 0; tIndex < workerPool->numThreads; tIndex++) { WorkerPoolQueueJob(&waitGroup, PbfWriterJob, &writer); }
+		WaitForWorkerWaitGroup(&waitGroup);
+	}
+	else { PbfWriterJob(&writer); }
+	FreeThreadCondVar(&writer.outputTurnChanged);
+	FreeThreadMutex(&writer.outputMutex);
+	FreeThreadMutex(&writer.encodeMutex);
+	
+	#if DEBUG_PBF_CODEC_STATS
+	PrintLine_D("Encoded %llu PrimitiveBlock%s (%llu node, %llu way, %llu relation) with %llu bytes compressed to %llu",
+		writer.numBlocks, Plural(writer.numBlocks, "s"),
+		writer.numNodeBlocks, writer.numWayBlocks, writer.numRelationBlocks,
+		writer.numRawBytes, writer.numCompressedBytes
+	);
+	#endif
+	TracyCZoneEnd(Zone_Func);
+	return GetPbfWireWriterSlice(&writer.output);
 }
@@ -0,0 +1,140 @@
+/*
+File:   osm_string_pool.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the functions that intern strings into an OsmStringPool and look them back up by handle
+*/
+
+void FreeOsmStringPool(OsmStringPool* pool)
+{
+	NotNull(pool);
+	if (pool->arena != nullptr)
+	{
+		VarArrayLoop(&pool->pages, pIndex)
+		{
+			VarArrayLoopGet(Slice, page, &pool->pages, pIndex);
+			FreeArray(u8, pool->arena, page->length, page->bytes);
+		}
+		FreeVarArray(&pool->pages);
+		FreeVarArray(&pool->entries);
+		if (pool->slots != nullptr) { FreeArray(u32, pool->arena, pool->numSlots, pool->slots); }
+	}
+	ClearPointer(pool);
+}
+
+void InitOsmStringPool(Arena* arena, OsmStringPool* poolOut)
+{
+	NotNull(arena);
+	NotNull(poolOut);
+	ClearPointer(poolOut);
+	poolOut->arena = arena;
+	InitVarArray(OsmStringPoolEntry, &poolOut->entries, arena);
+	InitVarArray(Slice, &poolOut->pages, arena);
+	poolOut->numSlots = OSM_STRING_POOL_MIN_SLOTS;
+	poolOut->slots = AllocArray(u32, arena, poolOut->numSlots);
+	NotNull(poolOut->slots);
+	for (uxx sIndex = 0; sIndex < poolOut->numSlots; sIndex++) { poolOut->slots[sIndex] = OSM_STRING_INVALID; }
+}
+
+// FNV-1a. Tag strings are short so this doesn't need to be anything fancy
+u64 HashOsmString(Str8 str)
+{
+	u64 result = 14695981039346656037ULL;
+	for (uxx cIndex = 0; cIndex < str.length; cIndex++) { result = (result ^ (u8)str.chars[cIndex]) * 1099511628211ULL; }
+	return result;
+}
+
+Str8 GetOsmPoolString(const OsmStringPool* pool, u32 handle)
+{
+	NotNull(pool);
+	if (handle == OSM_STRING_INVALID) { return Str8_Empty; }
+	Assert((uxx)handle < pool->entries.length);
+	return VarArrayGet(OsmStringPoolEntry, &pool->entries, (uxx)handle)->str;
+}
+
+void GrowOsmStringPoolSlots(OsmStringPool* pool)
+{
+	TracyCZoneN(Zone_Func, "GrowOsmStringPoolSlots", true);
+	uxx newNumSlots = pool->numSlots * 2;
+	u32* newSlots = AllocArray(u32, pool->arena, newNumSlots);
+	NotNull(newSlots);
+	for (uxx sIndex = 0; sIndex < newNumSlots; sIndex++) { newSlots[sIndex] = OSM_STRING_INVALID; }
+	uxx slotMask = newNumSlots - 1;
+	VarArrayLoop(&pool->entries, eIndex)
+	{
+		VarArrayLoopGet(OsmStringPoolEntry, entry, &pool->entries, eIndex);
+		uxx slotIndex = (uxx)entry->hash & slotMask;
+		while (newSlots[slotIndex] != OSM_STRING_INVALID) { slotIndex = (slotIndex + 1) & slotMask; }
+		newSlots[slotIndex] = (u32)eIndex;
+	}
+	FreeArray(u32, pool->arena, pool->numSlots, pool->slots);
+	pool->slots = newSlots;
+	pool->numSlots = newNumSlots;
+	TracyCZoneEnd(Zone_Func);
+}
+
+// Copies the characters into the current page (or a new one) so that we don't pay for a separate allocation for every string
+Str8 StoreOsmPoolStringChars(OsmStringPool* pool, Str8 str)
+{
+	if (str.length == 0) { return Str8_Empty; }
+	Slice* lastPage = VarArrayGetLastSoft(Slice, &pool->pages);
+	if (lastPage == nullptr || lastPage->length - pool->pageUsed < str.length)
+	{
+		uxx newPageSize = MaxUXX(OSM_STRING_POOL_PAGE_SIZE, str.length);
+		u8* newPageBytes = AllocArray(u8, pool->arena, newPageSize);
+		NotNull(newPageBytes);
+		VarArrayAddValue(Slice, &pool->pages, MakeSlice(newPageSize, newPageBytes));
+		lastPage = VarArrayGetLastSoft(Slice, &pool->pages);
+		pool->pageUsed = 0;
+		pool->numStoredBytes += newPageSize;
+	}
+	char* resultChars = (char*)&lastPage->bytes[pool->pageUsed];
+	MyMemCopy(resultChars, str.chars, str.length);
+	pool->pageUsed += str.length;
+	return MakeStr8(str.length, resultChars);
+}
+
+// Use this when the hash was already calculated (possibly on another thread), otherwise use InternOsmString
+u32 InternOsmStringHashed(OsmStringPool* pool, Str8 str, u64 hash)
+{
+	NotNull(pool);
+	NotNull(pool->slots);
+	pool->numInterned++;
+	pool->numInternedBytes += str.length;
+	uxx slotMask = pool->numSlots - 1;
+	uxx slotIndex = (uxx)hash & slotMask;
+	while (pool->slots[slotIndex] != OSM_STRING_INVALID)
+	{
+		OsmStringPoolEntry* entry = VarArrayGet(OsmStringPoolEntry, &pool->entries, (uxx)pool->slots[slotIndex]);
+		if (entry->hash == hash && StrExactEquals(entry->str, str)) { return pool->slots[slotIndex]; }
+		slotIndex = (slotIndex + 1) & slotMask;
+	}
+	
+	Assert(pool->entries.length < OSM_STRING_INVALID);
+	u32 result = (u32)pool->entries.length;
+	OsmStringPoolEntry* newEntry = VarArrayAdd(OsmStringPoolEntry, &pool->entries);
+	NotNull(newEntry);
+	newEntry->hash = hash;
+	newEntry->str = StoreOsmPoolStringChars(pool, str);
+	pool->slots[slotIndex] = result;
+	if (pool->entries.length * 100 > pool->numSlots * OSM_STRING_POOL_MAX_LOAD) { GrowOsmStringPoolSlots(pool); }
+	return result;
+}
+u32 InternOsmString(OsmStringPool* pool, Str8 str)
+{
+	return InternOsmStringHashed(pool, str, HashOsmString(str));
+}
+
+// Most callers just want the pooled Str8 rather than the handle. The result stays valid until the pool is freed
+Str8 InternOsmStr8(OsmStringPool* pool, Str8 str)
+{
+	return GetOsmPoolString(pool, InternOsmString(pool, str));
+}
+
+// How many bytes the pool is using for the characters, entries and slots (not counting unused VarArray capacity)
+uxx GetOsmStringPoolMemoryUsage(const OsmStringPool* pool)
+{
+	NotNull(pool);
+	return pool->numStoredBytes + (pool->entries.length * sizeof(OsmStringPoolEntry)) + (pool->numSlots * sizeof(u32));
+}
@@ -0,0 +1,41 @@
+/*
+File:   osm_string_pool.h
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** The OsmStringPool holds one copy of every unique tag key and value string in an OsmMap.
+	** Strings are looked up by hash in an open addressed table and are identified by a u32 handle.
+*/
+
+#ifndef _OSM_STRING_POOL_H
+#define _OSM_STRING_POOL_H
+
+#define OSM_STRING_POOL_PAGE_SIZE     Kilobytes(64) //strings are packed into pages of this size, longer strings get their own page
+#define OSM_STRING_POOL_MIN_SLOTS     1024 //must be a power of 2
+#define OSM_STRING_POOL_MAX_LOAD      70 //percent, the slots array doubles when there are more strings than this
+#define OSM_STRING_INVALID            UINT32_MAX
+
+typedef plex OsmStringPoolEntry OsmStringPoolEntry;
+plex OsmStringPoolEntry
+{
+	u64 hash;
+	Str8 str; //points into one of the pages
+};
+
+typedef plex OsmStringPool OsmStringPool;
+plex OsmStringPool
+{
+	Arena* arena;
+	VarArray entries; //OsmStringPoolEntry, indexed by handle
+	uxx numSlots;
+	u32* slots; //numSlots long, OSM_STRING_INVALID for empty slots, otherwise a handle into entries
+	VarArray pages; //Slice
+	uxx pageUsed; //how many bytes of the last page are used
+	
+	//NOTE: Only used to report how much the pool saves. numInternedBytes is how many bytes every interned string would take if they were all allocated separately
+	uxx numInterned;
+	uxx numInternedBytes;
+	uxx numStoredBytes;
+};
+
+#endif //  _OSM_STRING_POOL_H
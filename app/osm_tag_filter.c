@@ -0,0 +1,358 @@
+/*
+File:   osm_tag_filter.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the little expression language that lets us pick which primitives to load from a file based on their tags.
+	** Expressions are compiled once by TryCompileOsmTagFilter and then evaluated against the tags of each primitive.
+	** Syntax:
+	**   highway                  key exists (same as highway=*)
+	**   railway=rail             key has the value
+	**   highway!=footway         key doesn't exist or has a different value
+	**   highway in (primary, secondary, tertiary)
+	**   !expr  or  not expr
+	**   a & b  or  a and b       (binds tighter than or)
+	**   a | b  or  a or b
+	**   (expr)
+	** Keys and values can be put in double quotes when they contain spaces or any of =!()&|,
+*/
+
+typedef enum OsmTagFilterTokenType OsmTagFilterTokenType;
+enum OsmTagFilterTokenType
+{
+	OsmTagFilterTokenType_None = 0,
+	OsmTagFilterTokenType_End,
+	OsmTagFilterTokenType_Word,
+	OsmTagFilterTokenType_QuotedString,
+	OsmTagFilterTokenType_Equals,
+	OsmTagFilterTokenType_NotEquals,
+	OsmTagFilterTokenType_Not,
+	OsmTagFilterTokenType_And,
+	OsmTagFilterTokenType_Or,
+	OsmTagFilterTokenType_OpenParens,
+	OsmTagFilterTokenType_CloseParens,
+	OsmTagFilterTokenType_Comma,
+	OsmTagFilterTokenType_Count,
+};
+
+typedef plex OsmTagFilterToken OsmTagFilterToken;
+plex OsmTagFilterToken
+{
+	OsmTagFilterTokenType type;
+	uxx offset;
+	Str8 str;
+};
+
+typedef plex OsmTagFilterParser OsmTagFilterParser;
+plex OsmTagFilterParser
+{
+	OsmTagFilter* filter;
+	uxx offset;
+	OsmTagFilterToken token;
+	uxx stackDepth;
+	Result error;
+};
+
+void FreeOsmTagFilter(OsmTagFilter* filter)
+{
+	NotNull(filter);
+	if (filter->arena != nullptr)
+	{
+		VarArrayLoop(&filter->instructions, iIndex)
+		{
+			VarArrayLoopGet(OsmTagFilterInstruction, instruction, &filter->instructions, iIndex);
+			FreeStr8(filter->arena, &instruction->key);
+			for (uxx vIndex = 0; vIndex < instruction->numValues; vIndex++) { FreeStr8(filter->arena, &instruction->values[vIndex]); }
+			if (instruction->values != nullptr) { FreeArray(Str8, filter->arena, instruction->numValues, instruction->values); }
+		}
+		FreeVarArray(&filter->instructions);
+		FreeStr8(filter->arena, &filter->expression);
+	}
+	ClearPointer(filter);
+}
+
+bool IsOsmTagFilterWhitespace(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+}
+bool IsOsmTagFilterWordChar(char c)
+{
+	if (IsOsmTagFilterWhitespace(c)) { return false; }
+	if (c == '=' || c == '!' || c == '(' || c == ')' || c == '&' || c == '|' || c == ',' || c == '"') { return false; }
+	return true;
+}
+
+bool IsOsmTagFilterKeyword(const OsmTagFilterToken* token, const char* keywordNt)
+{
+	return (token->type == OsmTagFilterTokenType_Word && StrAnyCaseEquals(token->str, MakeStr8Nt(keywordNt)));
+}
+
+void OsmTagFilterSyntaxError(OsmTagFilterParser* parser, const char* reasonNt)
+{
+	if (parser->error != Result_None) { return; }
+	Str8 expression = parser->filter->expression;
+	PrintLine_E("Tag filter syntax error at character %llu in \"%.*s\": %s", (u64)parser->token.offset, StrPrint(expression), reasonNt);
+	parser->error = Result_InvalidSyntax;
+}
+
+void NextOsmTagFilterToken(OsmTagFilterParser* parser)
+{
+	Str8 expression = parser->filter->expression;
+	while (parser->offset < expression.length && IsOsmTagFilterWhitespace(expression.chars[parser->offset])) { parser->offset++; }
+	
+	OsmTagFilterToken* token = &parser->token;
+	ClearPointer(token);
+	token->offset = parser->offset;
+	if (parser->offset >= expression.length) { token->type = OsmTagFilterTokenType_End; return; }
+	
+	char c = expression.chars[parser->offset];
+	char nextChar = (parser->offset+1 < expression.length) ? expression.chars[parser->offset+1] : '\0';
+	uxx tokenLength = 1;
+	if (c == '=') { token->type = OsmTagFilterTokenType_Equals; }
+	else if (c == '!' && nextChar == '=') { token->type = OsmTagFilterTokenType_NotEquals; tokenLength = 2; }
+	else if (c == '!') { token->type = OsmTagFilterTokenType_Not; }
+	else if (c == '&') { token->type = OsmTagFilterTokenType_And; tokenLength = (nextChar == '&') ? 2 : 1; }
+	else if (c == '|') { token->type = OsmTagFilterTokenType_Or; tokenLength = (nextChar == '|') ? 2 : 1; }
+	else if (c == '(') { token->type = OsmTagFilterTokenType_OpenParens; }
+	else if (c == ')') { token->type = OsmTagFilterTokenType_CloseParens; }
+	else if (c == ',') { token->type = OsmTagFilterTokenType_Comma; }
+	else if (c == '"')
+	{
+		uxx endIndex = parser->offset+1;
+		while (endIndex < expression.length && expression.chars[endIndex] != '"') { endIndex++; }
+		if (endIndex >= expression.length) { OsmTagFilterSyntaxError(parser, "Missing closing quote"); token->type = OsmTagFilterTokenType_End; return; }
+		token->type = OsmTagFilterTokenType_QuotedString;
+		token->str = MakeStr8(endIndex - (parser->offset+1), &expression.chars[parser->offset+1]);
+		tokenLength = (endIndex+1) - parser->offset;
+	}
+	else
+	{
+		tokenLength = 0;
+		while (parser->offset + tokenLength < expression.length && IsOsmTagFilterWordChar(expression.chars[parser->offset + tokenLength])) { tokenLength++; }
+		token->type = OsmTagFilterTokenType_Word;
+		token->str = MakeStr8(tokenLength, &expression.chars[parser->offset]);
+		if (IsOsmTagFilterKeyword(token, "and")) { token->type = OsmTagFilterTokenType_And; }
+		else if (IsOsmTagFilterKeyword(token, "or")) { token->type = OsmTagFilterTokenType_Or; }
+		else if (IsOsmTagFilterKeyword(token, "not")) { token->type = OsmTagFilterTokenType_Not; }
+	}
+	parser->offset += tokenLength;
+}
+
+OsmTagFilterInstruction* AddOsmTagFilterInstruction(OsmTagFilterParser* parser, OsmTagFilterOp op)
+{
+	if (op == OsmTagFilterOp_HasKey || op == OsmTagFilterOp_KeyIn) { parser->stackDepth++; }
+	else if (op == OsmTagFilterOp_And || op == OsmTagFilterOp_Or) { Assert(parser->stackDepth >= 2); parser->stackDepth--; }
+	if (parser->stackDepth > OSM_TAG_FILTER_MAX_STACK_DEPTH)
+	{
+		PrintLine_E("Tag filter \"%.*s\" is too complex, it needs more than %d stack slots", StrPrint(parser->filter->expression), OSM_TAG_FILTER_MAX_STACK_DEPTH);
+		parser->error = Result_StackOverflow;
+	}
+	
+	OsmTagFilterInstruction* result = VarArrayAdd(OsmTagFilterInstruction, &parser->filter->instructions);
+	NotNull(result);
+	ClearPointer(result);
+	result->op = op;
+	return result;
+}
+
+bool IsOsmTagFilterStringToken(const OsmTagFilterToken* token)
+{
+	return (token->type == OsmTagFilterTokenType_Word || token->type == OsmTagFilterTokenType_QuotedString);
+}
+
+void ParseOsmTagFilterOr(OsmTagFilterParser* parser, uxx parensDepth);
+
+// term := key | key=value | key=* | key!=value | key in (value, ...)
+void ParseOsmTagFilterTerm(OsmTagFilterParser* parser)
+{
+	Arena* arena = parser->filter->arena;
+	if (!IsOsmTagFilterStringToken(&parser->token) || IsOsmTagFilterKeyword(&parser->token, "in")) { OsmTagFilterSyntaxError(parser, "Expected a tag key"); return; }
+	Str8 key = parser->token.str;
+	NextOsmTagFilterToken(parser);
+	
+	if (parser->token.type == OsmTagFilterTokenType_Equals || parser->token.type == OsmTagFilterTokenType_NotEquals)
+	{
+		bool isNotEquals = (parser->token.type == OsmTagFilterTokenType_NotEquals);
+		NextOsmTagFilterToken(parser);
+		if (!IsOsmTagFilterStringToken(&parser->token)) { OsmTagFilterSyntaxError(parser, "Expected a tag value"); return; }
+		if (parser->token.type == OsmTagFilterTokenType_Word && StrExactEquals(parser->token.str, StrLit("*")))
+		{
+			OsmTagFilterInstruction* instruction = AddOsmTagFilterInstruction(parser, OsmTagFilterOp_HasKey);
+			instruction->key = AllocStr8(arena, key);
+		}
+		else
+		{
+			OsmTagFilterInstruction* instruction = AddOsmTagFilterInstruction(parser, OsmTagFilterOp_KeyIn);
+			instruction->key = AllocStr8(arena, key);
+			instruction->numValues = 1;
+			instruction->values = AllocArray(Str8, arena, 1);
+			NotNull(instruction->values);
+			instruction->values[0] = AllocStr8(arena, parser->token.str);
+		}
+		if (isNotEquals) { AddOsmTagFilterInstruction(parser, OsmTagFilterOp_Not); }
+		NextOsmTagFilterToken(parser);
+	}
+	else if (IsOsmTagFilterKeyword(&parser->token, "in"))
+	{
+		NextOsmTagFilterToken(parser);
+		if (parser->token.type != OsmTagFilterTokenType_OpenParens) { OsmTagFilterSyntaxError(parser, "Expected ( after in"); return; }
+		
+		//Count the values first so they can go in one allocation
+		OsmTagFilterParser countParser = *parser;
+		uxx numValues = 0;
+		while (true)
+		{
+			NextOsmTagFilterToken(&countParser);
+			if (!IsOsmTagFilterStringToken(&countParser.token)) { break; }
+			numValues++;
+			NextOsmTagFilterToken(&countParser);
+			if (countParser.token.type != OsmTagFilterTokenType_Comma) { break; }
+		}
+		if (countParser.error != Result_None) { parser->error = countParser.error; return; }
+		if (numValues == 0) { NextOsmTagFilterToken(parser); OsmTagFilterSyntaxError(parser, "Expected at least one value inside in (...)"); return; }
+		
+		OsmTagFilterInstruction* instruction = AddOsmTagFilterInstruction(parser, OsmTagFilterOp_KeyIn);
+		instruction->key = AllocStr8(arena, key);
+		instruction->numValues = numValues;
+		instruction->values = AllocArray(Str8, arena, numValues);
+		NotNull(instruction->values);
+		for (uxx vIndex = 0; vIndex < numValues; vIndex++)
+		{
+			NextOsmTagFilterToken(parser);
+			instruction->values[vIndex] = AllocStr8(arena, parser->token.str);
+			NextOsmTagFilterToken(parser);
+		}
+		if (parser->token.type != OsmTagFilterTokenType_CloseParens) { OsmTagFilterSyntaxError(parser, "Expected , or ) in value list"); return; }
+		NextOsmTagFilterToken(parser);
+	}
+	else
+	{
+		OsmTagFilterInstruction* instruction = AddOsmTagFilterInstruction(parser, OsmTagFilterOp_HasKey);
+		instruction->key = AllocStr8(arena, key);
+	}
+}
+
+// unary := !unary | not unary | (or) | term
+void ParseOsmTagFilterUnary(OsmTagFilterParser* parser, uxx parensDepth)
+{
+	if (parser->error != Result_None) { return; }
+	if (parensDepth >= OSM_TAG_FILTER_MAX_STACK_DEPTH) { OsmTagFilterSyntaxError(parser, "Expression is nested too deeply"); return; }
+	if (parser->token.type == OsmTagFilterTokenType_Not)
+	{
+		NextOsmTagFilterToken(parser);
+		ParseOsmTagFilterUnary(parser, parensDepth+1);
+		if (parser->error == Result_None) { AddOsmTagFilterInstruction(parser, OsmTagFilterOp_Not); }
+	}
+	else if (parser->token.type == OsmTagFilterTokenType_OpenParens)
+	{
+		NextOsmTagFilterToken(parser);
+		ParseOsmTagFilterOr(parser, parensDepth+1);
+		if (parser->error != Result_None) { return; }
+		if (parser->token.type != OsmTagFilterTokenType_CloseParens) { OsmTagFilterSyntaxError(parser, "Expected )"); return; }
+		NextOsmTagFilterToken(parser);
+	}
+	else { ParseOsmTagFilterTerm(parser); }
+}
+
+// and := unary (& unary)*
+void ParseOsmTagFilterAnd(OsmTagFilterParser* parser, uxx parensDepth)
+{
+	ParseOsmTagFilterUnary(parser, parensDepth);
+	while (parser->error == Result_None && parser->token.type == OsmTagFilterTokenType_And)
+	{
+		NextOsmTagFilterToken(parser);
+		ParseOsmTagFilterUnary(parser, parensDepth);
+		if (parser->error == Result_None) { AddOsmTagFilterInstruction(parser, OsmTagFilterOp_And); }
+	}
+}
+
+// or := and (| and)*
+void ParseOsmTagFilterOr(OsmTagFilterParser* parser, uxx parensDepth)
+{
+	ParseOsmTagFilterAnd(parser, parensDepth);
+	while (parser->error == Result_None && parser->token.type == OsmTagFilterTokenType_Or)
+	{
+		NextOsmTagFilterToken(parser);
+		ParseOsmTagFilterAnd(parser, parensDepth);
+		if (parser->error == Result_None) { AddOsmTagFilterInstruction(parser, OsmTagFilterOp_Or); }
+	}
+}
+
+// Compiles something like "highway or railway=rail" into filterOut. The filter allocates from arena until FreeOsmTagFilter is called.
+// Returns Result_InvalidSyntax (and prints why) if the expression can't be parsed
+Result TryCompileOsmTagFilter(Arena* arena, Str8 expression, OsmTagFilter* filterOut)
+{
+	TracyCZoneN(funcZone, "TryCompileOsmTagFilter", true);
+	NotNull(arena);
+	NotNull(filterOut);
+	ClearPointer(filterOut);
+	filterOut->arena = arena;
+	filterOut->expression = AllocStr8(arena, expression);
+	InitVarArray(OsmTagFilterInstruction, &filterOut->instructions, arena);
+	
+	OsmTagFilterParser parser = ZEROED;
+	parser.filter = filterOut;
+	parser.error = Result_None;
+	NextOsmTagFilterToken(&parser);
+	if (parser.token.type == OsmTagFilterTokenType_End) { OsmTagFilterSyntaxError(&parser, "Expression is empty"); }
+	else
+	{
+		ParseOsmTagFilterOr(&parser, 0);
+		if (parser.error == Result_None && parser.token.type != OsmTagFilterTokenType_End) { OsmTagFilterSyntaxError(&parser, "Unexpected token after the end of the expression"); }
+	}
+	
+	if (parser.error != Result_None)
+	{
+		FreeOsmTagFilter(filterOut);
+		TracyCZoneEnd(funcZone);
+		return parser.error;
+	}
+	Assert(parser.stackDepth == 1);
+	TracyCZoneEnd(funcZone);
+	return Result_Success;
+}
+
+const Str8* FindOsmTagFilterValue(uxx numTags, const OsmTag* tags, Str8 key)
+{
+	for (uxx tIndex = 0; tIndex < numTags; tIndex++)
+	{
+		if (StrExactEquals(tags[tIndex].key, key)) { return &tags[tIndex].value; }
+	}
+	return nullptr;
+}
+
+bool DoesOsmTagFilterMatch(OsmTagFilter* filter, uxx numTags, const OsmTag* tags)
+{
+	NotNull(filter);
+	bool stack[OSM_TAG_FILTER_MAX_STACK_DEPTH];
+	uxx stackSize = 0;
+	VarArrayLoop(&filter->instructions, iIndex)
+	{
+		VarArrayLoopGet(OsmTagFilterInstruction, instruction, &filter->instructions, iIndex);
+		switch (instruction->op)
+		{
+			case OsmTagFilterOp_HasKey:
+			{
+				stack[stackSize] = (FindOsmTagFilterValue(numTags, tags, instruction->key) != nullptr);
+				stackSize++;
+			} break;
+			case OsmTagFilterOp_KeyIn:
+			{
+				const Str8* value = FindOsmTagFilterValue(numTags, tags, instruction->key);
+				bool isMatch = false;
+				for (uxx vIndex = 0; value != nullptr && vIndex < instruction->numValues; vIndex++)
+				{
+					if (StrExactEquals(*value, instruction->values[vIndex])) { isMatch = true; break; }
+				}
+				stack[stackSize] = isMatch;
+				stackSize++;
+			} break;
+			case OsmTagFilterOp_Not: stack[stackSize-1] = !stack[stackSize-1]; break;
+			case OsmTagFilterOp_And: stackSize--; stack[stackSize-1] = (stack[stackSize-1] && stack[stackSize]); break;
+			case OsmTagFilterOp_Or:  stackSize--; stack[stackSize-1] = (stack[stackSize-1] || stack[stackSize]); break;
+			default: Assert(false); break;
+		}
+	}
+	Assert(stackSize == 1);
+	return stack[0];
+}
@@ -0,0 +1,76 @@
+/*
+File:   osm_tag_filter.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _OSM_TAG_FILTER_H
+#define _OSM_TAG_FILTER_H
+
+#define OSM_TAG_FILTER_MAX_STACK_DEPTH 32 //values, also limits how deeply parenthesis can be nested
+
+typedef enum OsmTagFilterOp OsmTagFilterOp;
+enum OsmTagFilterOp
+{
+	OsmTagFilterOp_None = 0,
+	OsmTagFilterOp_HasKey, //pushes whether the key exists
+	OsmTagFilterOp_KeyIn, //pushes whether the key exists and its value is one of values (key=value is a KeyIn with 1 value)
+	OsmTagFilterOp_Not, //inverts the top of the stack
+	OsmTagFilterOp_And, //pops 2 and pushes 1
+	OsmTagFilterOp_Or, //pops 2 and pushes 1
+	OsmTagFilterOp_Count,
+};
+const char* GetOsmTagFilterOpStr(OsmTagFilterOp enumValue)
+{
+	switch (enumValue)
+	{
+		case OsmTagFilterOp_None:   return "None";
+		case OsmTagFilterOp_HasKey: return "HasKey";
+		case OsmTagFilterOp_KeyIn:  return "KeyIn";
+		case OsmTagFilterOp_Not:    return "Not";
+		case OsmTagFilterOp_And:    return "And";
+		case OsmTagFilterOp_Or:     return "Or";
+		default: return UNKNOWN_STR;
+	}
+}
+
+// Which nodes get kept when OsmLoadOptions.tagFilter is set
+typedef enum OsmTagFilterNodes OsmTagFilterNodes;
+enum OsmTagFilterNodes
+{
+	OsmTagFilterNodes_All = 0, //the filter only applies to ways and relations
+	OsmTagFilterNodes_Matching, //nodes have to match the filter just like ways and relations
+	OsmTagFilterNodes_WayNodes, //exactly the nodes that kept ways reference (this requires looking at the ways before the nodes)
+	OsmTagFilterNodes_Count,
+};
+const char* GetOsmTagFilterNodesStr(OsmTagFilterNodes enumValue)
+{
+	switch (enumValue)
+	{
+		case OsmTagFilterNodes_All:      return "All";
+		case OsmTagFilterNodes_Matching: return "Matching";
+		case OsmTagFilterNodes_WayNodes: return "WayNodes";
+		default: return UNKNOWN_STR;
+	}
+}
+
+typedef plex OsmTagFilterInstruction OsmTagFilterInstruction;
+plex OsmTagFilterInstruction
+{
+	OsmTagFilterOp op;
+	Str8 key;
+	uxx numValues;
+	Str8* values;
+};
+
+// A compiled filter expression, see TryCompileOsmTagFilter for the syntax. The instructions are in postfix order
+// so DoesOsmTagFilterMatch can evaluate them with a small stack of bools rather than walking a tree
+typedef plex OsmTagFilter OsmTagFilter;
+plex OsmTagFilter
+{
+	Arena* arena;
+	Str8 expression;
+	VarArray instructions; //OsmTagFilterInstruction
+};
+
+#endif //  _OSM_TAG_FILTER_H
@@ -0,0 +1,139 @@
+/*
+File:   osm_xml_numbers.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the parsers the .osm loader uses for its numeric attributes. Ids, versions, changesets and uids are plain runs of digits and
+	** coordinates never have more than 7 decimal places, so the Fast functions only handle those forms and convert 8 digits at a time
+	** using SWAR (see "Faster Integer Parsing" by Daniel Lemire). They return false for anything else and the functions at the bottom
+	** fall back to the generic TryParseU64\TryParseI32\TryParseR64 to decide whether the value is really invalid.
+	** The SWAR code assumes a little-endian CPU, which all of our targets are
+*/
+
+// +--------------------------------------------------------------+
+// |                         SWAR Helpers                         |
+// +--------------------------------------------------------------+
+// True if all 8 bytes are '0'-'9'. Adding 0x46 pushes anything above '9' into the high bit and subtracting '0' borrows into it for anything below '0'
+bool AreEightOsmDigits(u64 chunk)
+{
+	return ((((chunk + 0x4646464646464646ULL) | (chunk - 0x3030303030303030ULL)) & 0x8080808080808080ULL) == 0);
+}
+
+// The first character is in the lowest byte. Pairs of digits are combined, then pairs of pairs, with two multiplies doing the last step for both halves at once
+u32 ParseEightOsmDigits(u64 chunk)
+{
+	const u64 byteMask = 0x000000FF000000FFULL;
+	const u64 multiplier1 = 100 + (1000000ULL << 32);
+	const u64 multiplier2 = 1 + (10000ULL << 32);
+	chunk -= 0x3030303030303030ULL;
+	chunk = (chunk * 10) + (chunk >> 8);
+	chunk = (((chunk & byteMask) * multiplier1) + (((chunk >> 16) & byteMask) * multiplier2)) >> 32;
+	return (u32)chunk;
+}
+
+// +--------------------------------------------------------------+
+// |                        Fast Parsers                          |
+// +--------------------------------------------------------------+
+// Only plain digits, no sign or whitespace, and at most OSM_FAST_MAX_INT_DIGITS of them
+bool TryParseOsmDigitsFast(Str8 str, u64* valueOut)
+{
+	if (str.length == 0 || str.length > OSM_FAST_MAX_INT_DIGITS) { return false; }
+	//NOTE: The first chunk is padded at the front with '0's so the rest of the digits come in whole chunks of 8
+	uxx firstChunkLength = ((str.length % 8) != 0) ? (str.length % 8) : 8;
+	u64 chunk = 0x3030303030303030ULL;
+	MyMemCopy(((u8*)&chunk) + (8 - firstChunkLength), str.chars, firstChunkLength);
+	if (!AreEightOsmDigits(chunk)) { return false; }
+	u64 value = ParseEightOsmDigits(chunk);
+	for (uxx cIndex = firstChunkLength; cIndex < str.length; cIndex += 8)
+	{
+		MyMemCopy(&chunk, &str.chars[cIndex], sizeof(u64));
+		if (!AreEightOsmDigits(chunk)) { return false; }
+		value = (value * 100000000ULL) + ParseEightOsmDigits(chunk);
+	}
+	*valueOut = value;
+	return true;
+}
+
+// Splits "-123.4567890" into its sign and its magnitude in units of 1e-8. Accepts an optional '-', 1 to OSM_FAST_MAX_COORD_DIGITS digits
+// and optionally a '.' followed by 1 to OSM_FAST_MAX_FRAC_DIGITS digits
+bool SplitOsmCoordFast(Str8 str, bool* isNegativeOut, u64* unitsOut)
+{
+	uxx cIndex = 0;
+	bool isNegative = (str.length > 0 && str.chars[0] == '-');
+	if (isNegative) { cIndex++; }
+	
+	uxx integerStart = cIndex;
+	u64 integerPart = 0;
+	while (cIndex < str.length && cIndex - integerStart <= OSM_FAST_MAX_COORD_DIGITS)
+	{
+		u8 digit = (u8)(str.chars[cIndex] - '0');
+		if (digit > 9) { break; }
+		integerPart = (integerPart * 10) + digit;
+		cIndex++;
+	}
+	uxx numIntegerDigits = cIndex - integerStart;
+	if (numIntegerDigits == 0 || numIntegerDigits > OSM_FAST_MAX_COORD_DIGITS) { return false; }
+	
+	u64 fractionPart = 0;
+	if (cIndex < str.length)
+	{
+		if (str.chars[cIndex] != '.') { return false; }
+		cIndex++;
+		uxx numFractionDigits = str.length - cIndex;
+		if (numFractionDigits == 0 || numFractionDigits > OSM_FAST_MAX_FRAC_DIGITS) { return false; }
+		//NOTE: Padding the end with '0's scales the fraction to 8 digits for us
+		u64 chunk = 0x3030303030303030ULL;
+		MyMemCopy(&chunk, &str.chars[cIndex], numFractionDigits);
+		if (!AreEightOsmDigits(chunk)) { return false; }
+		fractionPart = ParseEightOsmDigits(chunk);
+	}
+	
+	*isNegativeOut = isNegative;
+	*unitsOut = (integerPart * 100000000ULL) + fractionPart;
+	return true;
+}
+
+// The result is exactly what strtod would give. units and 1e8 are both exact doubles and IEEE division is correctly rounded,
+// so dividing them gives the closest double to the decimal value, as long as units stays below 2^53 (it's at most 12 digits)
+bool TryParseOsmCoordFast(Str8 str, r64* valueOut)
+{
+	bool isNegative = false;
+	u64 units = 0;
+	if (!SplitOsmCoordFast(str, &isNegative, &units)) { return false; }
+	r64 value = (r64)units / 100000000.0;
+	*valueOut = isNegative ? -value : value;
+	return true;
+}
+
+// Gives the coordinate in units of 1/OSM_COORD_FIXED_SCALE degrees. Returns false if it has an 8th decimal place or doesn't fit in an i32
+bool TryParseOsmCoordFixedFast(Str8 str, i32* valueOut)
+{
+	bool isNegative = false;
+	u64 units = 0;
+	if (!SplitOsmCoordFast(str, &isNegative, &units)) { return false; }
+	if ((units % 10) != 0) { return false; }
+	u64 fixedValue = units / 10;
+	if (fixedValue > (u64)INT32_MAX) { return false; }
+	*valueOut = isNegative ? -(i32)fixedValue : (i32)fixedValue;
+	return true;
+}
+
+// +--------------------------------------------------------------+
+// |                     With Generic Fallback                    |
+// +--------------------------------------------------------------+
+bool TryParseOsmU64(Str8 str, u64* valueOut)
+{
+	return (TryParseOsmDigitsFast(str, valueOut) || TryParseU64(str, valueOut, nullptr));
+}
+
+bool TryParseOsmI32(Str8 str, i32* valueOut)
+{
+	u64 valueU64 = 0;
+	if (TryParseOsmDigitsFast(str, &valueU64) && valueU64 <= (u64)INT32_MAX) { *valueOut = (i32)valueU64; return true; }
+	return TryParseI32(str, valueOut, nullptr);
+}
+
+bool TryParseOsmCoord(Str8 str, r64* valueOut)
+{
+	return (TryParseOsmCoordFast(str, valueOut) || TryParseR64(str, valueOut, nullptr));
+}
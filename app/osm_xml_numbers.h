@@ -0,0 +1,15 @@
+/*
+File:   osm_xml_numbers.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _OSM_XML_NUMBERS_H
+#define _OSM_XML_NUMBERS_H
+
+#define OSM_COORD_FIXED_SCALE      10000000 //OSM coordinates are integer multiples of 1e-7 degrees
+#define OSM_FAST_MAX_INT_DIGITS    19 //any 19 digit number fits in a u64, longer ones go through TryParseU64
+#define OSM_FAST_MAX_COORD_DIGITS  3 //before the decimal point
+#define OSM_FAST_MAX_FRAC_DIGITS   8 //after the decimal point, one more than OSM uses so values that were rounded differently still take the fast path
+
+#endif //  _OSM_XML_NUMBERS_H
@@ -29,6 +29,47 @@ const char* GetHoxmlCodeStr(hoxml_code_t code)
 	}
 }
 
+// Result_None for the codes that aren't errors
+Result GetResultForHoxmlCode(hoxml_code_t code)
+{
+	switch (code)
+	{
+		case HOXML_ERROR_INSUFFICIENT_MEMORY:               return Result_Overflow;
+		case HOXML_ERROR_INVALID_INPUT:                     return Result_InvalidInput;
+		case HOXML_ERROR_INTERNAL:                          return Result_Failure;
+		case HOXML_ERROR_UNEXPECTED_EOF:                    return Result_NoMoreBytes;
+		case HOXML_ERROR_SYNTAX:                            return Result_InvalidSyntax;
+		case HOXML_ERROR_ENCODING:                          return Result_InvalidUtf8;
+		case HOXML_ERROR_TAG_MISMATCH:                      return Result_WrongEndElementType;
+		case HOXML_ERROR_INVALID_DOCUMENT_TYPE_DECLARATION: return Result_MissingFileHeader;
+		case HOXML_ERROR_INVALID_DOCUMENT_DECLARATION:      return Result_MissingFileHeader;
+		default: return Result_None;
+	}
+}
+
+// Returns XML_NAME_ID_NONE when nothing in the file uses the name
+u32 XmlFindNameId(XmlFile* file, Str8 name)
+{
+	NotNull(file);
+	VarArrayLoop(&file->names, nIndex)
+	{
+		VarArrayLoopGetValue(Str8, existingName, &file->names, nIndex);
+		if (StrExactEquals(existingName, name)) { return (u32)nIndex; }
+	}
+	return XML_NAME_ID_NONE;
+}
+
+u32 InternXmlName(XmlFile* file, Str8 name)
+{
+	u32 result = XmlFindNameId(file, name);
+	if (result == XML_NAME_ID_NONE)
+	{
+		result = (u32)file->names.length;
+		VarArrayAddValue(Str8, &file->names, AllocStr8(file->arena, name));
+	}
+	return result;
+}
+
 Result TryParseXml(Str8 xmlContents, Arena* arena, XmlFile* fileOut)
 {
 	TracyCZoneN(funcZone, "TryParseXml", true);
@@ -39,6 +80,7 @@ Result TryParseXml(Str8 xmlContents, Arena* arena, XmlFile* fileOut)
 	
 	ClearPointer(fileOut);
 	fileOut->arena = arena;
+	InitVarArray(Str8, &fileOut->names, arena);
 	InitVarArray(XmlElement, &fileOut->roots, arena);
 	
 	u32 stackSize = 0;
@@ -72,7 +114,8 @@ Result TryParseXml(Str8 xmlContents, Arena* arena, XmlFile* fileOut)
 				XmlElement* newElement = VarArrayAdd(XmlElement, elementArray);
 				NotNull(newElement);
 				ClearPointer(newElement);
-				newElement->type = AllocStr8Nt(arena, hoxml.tag);
+				newElement->typeId = InternXmlName(fileOut, MakeStr8Nt(hoxml.tag));
+				newElement->type = *VarArrayGet(Str8, &fileOut->names, newElement->typeId);
 				InitVarArray(XmlAttribute, &newElement->attributes, arena);
 				InitVarArray(XmlElement, &newElement->children, arena);
 				stack[stackSize] = newElement;
@@ -103,7 +146,8 @@ Result TryParseXml(Str8 xmlContents, Arena* arena, XmlFile* fileOut)
 				NotNull(newAttribute);
 				ClearPointer(newAttribute);
 				TracyCZoneN(Zone_AllocStrs, "AllocStrs", true);
-				newAttribute->key = AllocStr8Nt(arena, hoxml.attribute);
+				newAttribute->keyId = InternXmlName(fileOut, MakeStr8Nt(hoxml.attribute));
+				newAttribute->key = *VarArrayGet(Str8, &fileOut->names, newAttribute->keyId);
 				newAttribute->value = AllocStr8Nt(arena, hoxml.value);
 				TracyCZoneEnd(Zone_AllocStrs);
 				TracyCZoneEnd(Zone_ATTRIBUTE);
@@ -144,14 +188,18 @@ XmlElement* XmlGetOneChild(XmlFile* file, XmlElement* parent, Str8 type)
 {
 	NotNull(file);
 	VarArray* childArray = (parent != nullptr) ? &parent->children : &file->roots;
+	u32 typeId = XmlFindNameId(file, type);
 	XmlElement* result = nullptr;
-	VarArrayLoop(childArray, cIndex)
+	if (typeId != XML_NAME_ID_NONE)
 	{
-		VarArrayLoopGet(XmlElement, child, childArray, cIndex);
-		if (StrExactEquals(child->type, type))
+		VarArrayLoop(childArray, cIndex)
 		{
-			if (result != nullptr) { file->error = Result_Duplicate; file->errorElement = parent; file->errorStr = type; return nullptr; }
-			result = child;
+			VarArrayLoopGet(XmlElement, child, childArray, cIndex);
+			if (child->typeId == typeId)
+			{
+				if (result != nullptr) { file->error = Result_Duplicate; file->errorElement = parent; file->errorStr = type; return nullptr; }
+				result = child;
+			}
 		}
 	}
 	if (result == nullptr) { file->error = Result_ElementNotFound; file->errorElement = parent; file->errorStr = type; }
@@ -163,52 +211,98 @@ XmlElement* XmlGetChild(XmlFile* file, XmlElement* parent, Str8 type, u64 index)
 	TracyCZoneN(funcZone, "XmlGetChild", true);
 	NotNull(file);
 	VarArray* childArray = (parent != nullptr) ? &parent->children : &file->roots;
+	u32 typeId = XmlFindNameId(file, type);
 	XmlElement* result = nullptr;
 	u64 findIndex = 0;
-	VarArrayLoop(childArray, cIndex)
+	if (typeId != XML_NAME_ID_NONE)
 	{
-		VarArrayLoopGet(XmlElement, child, childArray, cIndex);
-		if (StrExactEquals(child->type, type))
+		VarArrayLoop(childArray, cIndex)
 		{
-			if (findIndex >= index) { TracyCZoneEnd(funcZone); return child; }
-			findIndex++;
+			VarArrayLoopGet(XmlElement, child, childArray, cIndex);
+			if (child->typeId == typeId)
+			{
+				if (findIndex >= index) { TracyCZoneEnd(funcZone); return child; }
+				findIndex++;
+			}
 		}
 	}
 	TracyCZoneEnd(funcZone);
 	return result;
 }
+// Prefer XmlIterChildren when walking all the children of a type, this has to look up the type's id on every call
 XmlElement* XmlGetNextChild(XmlFile* file, XmlElement* parent, Str8 type, XmlElement* prevChild)
 {
 	TracyCZoneN(funcZone, "XmlGetNextChild", true);
 	
 	VarArray* childArray = (parent != nullptr) ? &parent->children : &file->roots;
-	u64 startIndex = 0;
+	u32 typeId = XmlFindNameId(file, type);
+	if (typeId == XML_NAME_ID_NONE) { TracyCZoneEnd(funcZone); return nullptr; }
+	uxx startIndex = 0;
 	if (prevChild != nullptr)
 	{
-		bool foundChildIndex = VarArrayGetIndexOf(XmlElement, childArray, prevChild, &startIndex);
-		Assert(foundChildIndex); UNUSED(foundChildIndex);
-		startIndex += 1;
+		//NOTE: The children are stored contiguously so prevChild's index is just its offset from the start of the array
+		Assert(prevChild >= (XmlElement*)childArray->items && prevChild < (XmlElement*)childArray->items + childArray->length);
+		startIndex = (uxx)(prevChild - (XmlElement*)childArray->items) + 1;
 	}
 	
 	for (uxx cIndex = startIndex; cIndex < childArray->length; cIndex++)
 	{
 		VarArrayLoopGet(XmlElement, child, childArray, cIndex);
-		if (StrExactEquals(child->type, type)) { TracyCZoneEnd(funcZone); return child; }
+		if (child->typeId == typeId) { TracyCZoneEnd(funcZone); return child; }
 	}
 	
 	TracyCZoneEnd(funcZone);
 	return nullptr;
 }
 
-Str8 XmlGetAttribute(XmlFile* file, XmlElement* element, Str8 attributeName)
+// Pass nullptr for parent to walk the roots. Use it like this:
+//   XmlChildIter iter = XmlIterChildren(file, osmElement, StrLit("node"));
+//   for (XmlElement* node = XmlIterNext(&iter); node != nullptr; node = XmlIterNext(&iter)) { ... }
+XmlChildIter XmlIterChildren(XmlFile* file, XmlElement* parent, Str8 type)
 {
 	NotNull(file);
+	XmlChildIter result = ZEROED;
+	result.children = (parent != nullptr) ? &parent->children : &file->roots;
+	result.typeId = XmlFindNameId(file, type);
+	result.index = 0;
+	return result;
+}
+XmlElement* XmlIterNext(XmlChildIter* iter)
+{
+	NotNull(iter);
+	if (iter->typeId == XML_NAME_ID_NONE) { return nullptr; }
+	while (iter->index < iter->children->length)
+	{
+		XmlElement* child = VarArrayGet(XmlElement, iter->children, iter->index);
+		iter->index++;
+		if (child->typeId == iter->typeId) { return child; }
+	}
+	return nullptr;
+}
+
+// Returns nullptr when the element doesn't have the attribute. Get keyId from XmlFindNameId once when looking up the same attribute on many elements
+XmlAttribute* XmlFindAttributeById(XmlElement* element, u32 keyId)
+{
 	NotNull(element);
+	if (keyId == XML_NAME_ID_NONE) { return nullptr; }
 	VarArrayLoop(&element->attributes, aIndex)
 	{
 		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName)) { return attribute->value; }
+		if (attribute->keyId == keyId) { return attribute; }
 	}
+	return nullptr;
+}
+XmlAttribute* XmlFindAttribute(XmlFile* file, XmlElement* element, Str8 attributeName)
+{
+	return XmlFindAttributeById(element, XmlFindNameId(file, attributeName));
+}
+
+Str8 XmlGetAttribute(XmlFile* file, XmlElement* element, Str8 attributeName)
+{
+	NotNull(file);
+	NotNull(element);
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	if (attribute != nullptr) { return attribute->value; }
 	file->error = Result_AttributeNotFound;
 	file->errorElement = element;
 	file->errorStr = attributeName;
@@ -217,31 +311,23 @@ Str8 XmlGetAttribute(XmlFile* file, XmlElement* element, Str8 attributeName)
 
 Str8 XmlGetAttributeOrDefault(XmlFile* file, XmlElement* element, Str8 attributeName, Str8 defaultValue)
 {
-	UNUSED(file);
 	NotNull(file);
 	NotNull(element);
-	VarArrayLoop(&element->attributes, aIndex)
-	{
-		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName)) { return attribute->value; }
-	}
-	return defaultValue;
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	return (attribute != nullptr) ? attribute->value : defaultValue;
 }
 
 r32 XmlGetAttributeR32(XmlFile* file, XmlElement* element, Str8 attributeName)
 {
 	NotNull(file);
 	NotNull(element);
-	VarArrayLoop(&element->attributes, aIndex)
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	if (attribute != nullptr)
 	{
-		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName))
-		{
-			r32 valueR32 = 0.0f;
-			Result error = Result_None;
-			if (TryParseR32(attribute->value, &valueR32, &error)) { return valueR32; }
-			else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return 0.0f; }
-		}
+		r32 valueR32 = 0.0f;
+		Result error = Result_None;
+		if (TryParseR32(attribute->value, &valueR32, &error)) { return valueR32; }
+		else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return 0.0f; }
 	}
 	file->error = Result_AttributeNotFound;
 	file->errorElement = element;
@@ -252,16 +338,13 @@ r32 XmlGetAttributeR32OrDefault(XmlFile* file, XmlElement* element, Str8 attribu
 {
 	NotNull(file);
 	NotNull(element);
-	VarArrayLoop(&element->attributes, aIndex)
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	if (attribute != nullptr)
 	{
-		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName))
-		{
-			r32 valueR32 = 0.0f;
-			Result error = Result_None;
-			if (TryParseR32(attribute->value, &valueR32, &error)) { return valueR32; }
-			else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return defaultValue; }
-		}
+		r32 valueR32 = 0.0f;
+		Result error = Result_None;
+		if (TryParseR32(attribute->value, &valueR32, &error)) { return valueR32; }
+		else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return defaultValue; }
 	}
 	return defaultValue;
 }
@@ -270,16 +353,13 @@ r64 XmlGetAttributeR64(XmlFile* file, XmlElement* element, Str8 attributeName)
 {
 	NotNull(file);
 	NotNull(element);
-	VarArrayLoop(&element->attributes, aIndex)
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	if (attribute != nullptr)
 	{
-		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName))
-		{
-			r64 valueR64 = 0.0;
-			Result error = Result_None;
-			if (TryParseR64(attribute->value, &valueR64, &error)) { return valueR64; }
-			else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return 0.0; }
-		}
+		r64 valueR64 = 0.0;
+		Result error = Result_None;
+		if (TryParseR64(attribute->value, &valueR64, &error)) { return valueR64; }
+		else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return 0.0; }
 	}
 	file->error = Result_AttributeNotFound;
 	file->errorElement = element;
@@ -290,16 +370,13 @@ r64 XmlGetAttributeR64OrDefault(XmlFile* file, XmlElement* element, Str8 attribu
 {
 	NotNull(file);
 	NotNull(element);
-	VarArrayLoop(&element->attributes, aIndex)
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	if (attribute != nullptr)
 	{
-		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName))
-		{
-			r64 valueR64 = 0.0;
-			Result error = Result_None;
-			if (TryParseR64(attribute->value, &valueR64, &error)) { return valueR64; }
-			else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return defaultValue; }
-		}
+		r64 valueR64 = 0.0;
+		Result error = Result_None;
+		if (TryParseR64(attribute->value, &valueR64, &error)) { return valueR64; }
+		else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return defaultValue; }
 	}
 	return defaultValue;
 }
@@ -308,16 +385,13 @@ u64 XmlGetAttributeU64(XmlFile* file, XmlElement* element, Str8 attributeName)
 {
 	NotNull(file);
 	NotNull(element);
-	VarArrayLoop(&element->attributes, aIndex)
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	if (attribute != nullptr)
 	{
-		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName))
-		{
-			u64 valueU64 = 0;
-			Result error = Result_None;
-			if (TryParseU64(attribute->value, &valueU64, &error)) { return valueU64; }
-			else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return 0; }
-		}
+		u64 valueU64 = 0;
+		Result error = Result_None;
+		if (TryParseU64(attribute->value, &valueU64, &error)) { return valueU64; }
+		else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return 0; }
 	}
 	file->error = Result_AttributeNotFound;
 	file->errorElement = element;
@@ -328,16 +402,13 @@ u64 XmlGetAttributeU64OrDefault(XmlFile* file, XmlElement* element, Str8 attribu
 {
 	NotNull(file);
 	NotNull(element);
-	VarArrayLoop(&element->attributes, aIndex)
+	XmlAttribute* attribute = XmlFindAttribute(file, element, attributeName);
+	if (attribute != nullptr)
 	{
-		VarArrayLoopGet(XmlAttribute, attribute, &element->attributes, aIndex);
-		if (StrExactEquals(attribute->key, attributeName))
-		{
-			u64 valueU64 = 0;
-			Result error = Result_None;
-			if (TryParseU64(attribute->value, &valueU64, &error)) { return valueU64; }
-			else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return defaultValue; }
-		}
+		u64 valueU64 = 0;
+		Result error = Result_None;
+		if (TryParseU64(attribute->value, &valueU64, &error)) { return valueU64; }
+		else { file->error = Result_InvalidAttributeValue; file->errorElement = element; file->errorStr = attributeName; return defaultValue; }
 	}
 	return defaultValue;
 }
@@ -9,17 +9,25 @@ Date:   07\07\2025
 
 #define XML_MAX_DEPTH 16
 
+#define OSM_XML_CHUNK_SIZE        Megabytes(1) //how much of the file TryParseOsmMap hands to hoxml at a time
+#define OSM_XML_HOXML_BUFFER_SIZE Kilobytes(64) //starting size, doubles whenever hoxml runs out of room
+#define OSM_XML_SEGMENT_SIZE      Megabytes(2) //roughly how much of the file each worker parses at a time when TryParseOsmMap is given a workerPool
+
+#define XML_NAME_ID_NONE UINT32_MAX //returned by XmlFindNameId when no element or attribute in the file has the name
+
 typedef plex XmlAttribute XmlAttribute;
 plex XmlAttribute
 {
-	Str8 key;
+	u32 keyId; //index into XmlFile.names
+	Str8 key; //points at the XmlFile.names entry
 	Str8 value;
 };
 
 typedef plex XmlElement XmlElement;
 plex XmlElement
 {
-	Str8 type;
+	u32 typeId; //index into XmlFile.names
+	Str8 type; //points at the XmlFile.names entry
 	VarArray attributes; //XmlAttribute
 	VarArray children; //XmlElement
 };
@@ -29,10 +37,22 @@ plex XmlFile
 {
 	Arena* arena;
 	u64 numElements;
+	//NOTE: Every element type and attribute key is interned here when the file is parsed so lookups can compare ids rather than strings.
+	//      Files only use a handful of distinct names so a linear search of this array is cheap
+	VarArray names; //Str8
 	VarArray roots; //XmlElement
 	Result error;
 	XmlElement* errorElement;
 	Str8 errorStr;
 };
 
+// Walks the children of an element that have a particular type, see XmlIterChildren and XmlIterNext
+typedef plex XmlChildIter XmlChildIter;
+plex XmlChildIter
+{
+	VarArray* children; //XmlElement
+	u32 typeId;
+	uxx index; //of the next child to look at
+};
+
 #endif //  _PARSE_XML_H
@@ -0,0 +1,254 @@
+/*
+File:   pbf_blob_index.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the functions that build, save, load and query a PbfBlobIndex. The index is a
+	** "sidecar" file (see PBF_BLOB_INDEX_FILE_EXT) that lists the offset, contents, id ranges
+	** and bounds of every blob in a .pbf so filtered loads can skip the blobs they don't need
+*/
+
+void FreePbfBlobIndex(PbfBlobIndex* index)
+{
+	NotNull(index);
+	if (index->arena != nullptr) { FreeVarArray(&index->entries); }
+	ClearPointer(index);
+}
+
+void InitPbfBlobIndex(Arena* arena, PbfBlobIndex* indexOut)
+{
+	NotNull(arena);
+	NotNull(indexOut);
+	ClearPointer(indexOut);
+	indexOut->arena = arena;
+	InitVarArray(PbfBlobIndexEntry, &indexOut->entries, arena);
+}
+
+// FNV-1a over the size and the first and last PBF_BLOB_INDEX_HASH_SIZE bytes. This isn't meant to catch every possible change,
+// just the common case of a newer extract being downloaded over the old one (which basically always changes the header blob)
+u64 CalcPbfBlobIndexSourceHash(const MappedFile* sourceFile)
+{
+	NotNull(sourceFile);
+	u64 result = 14695981039346656037ULL;
+	for (uxx bIndex = 0; bIndex < sizeof(u64); bIndex++) { result = (result ^ ((sourceFile->size >> (bIndex*8)) & 0xFF)) * 1099511628211ULL; }
+	uxx headLength = MinUXX(sourceFile->size, PBF_BLOB_INDEX_HASH_SIZE);
+	for (uxx bIndex = 0; bIndex < headLength; bIndex++) { result = (result ^ sourceFile->bytes[bIndex]) * 1099511628211ULL; }
+	uxx tailStart = sourceFile->size - MinUXX(sourceFile->size, PBF_BLOB_INDEX_HASH_SIZE);
+	for (uxx bIndex = tailStart; bIndex < sourceFile->size; bIndex++) { result = (result ^ sourceFile->bytes[bIndex]) * 1099511628211ULL; }
+	return result;
+}
+
+void InitPbfBlobIndexEntry(PbfBlobIndexEntry* entry)
+{
+	NotNull(entry);
+	ClearPointer(entry);
+	entry->minNodeId = UINT64_MAX;
+	entry->minWayId = UINT64_MAX;
+	entry->minRelationId = UINT64_MAX;
+}
+
+void ExpandPbfBlobIndexEntryBounds(PbfBlobIndexEntry* entry, r64 minLon, r64 minLat, r64 maxLon, r64 maxLat)
+{
+	if ((entry->flags & PbfBlobIndexFlag_HasBounds) == 0)
+	{
+		entry->flags |= PbfBlobIndexFlag_HasBounds;
+		entry->minLon = minLon;
+		entry->minLat = minLat;
+		entry->maxLon = maxLon;
+		entry->maxLat = maxLat;
+	}
+	else
+	{
+		entry->minLon = MinR64(entry->minLon, minLon);
+		entry->minLat = MinR64(entry->minLat, minLat);
+		entry->maxLon = MaxR64(entry->maxLon, maxLon);
+		entry->maxLat = MaxR64(entry->maxLat, maxLat);
+	}
+}
+void ExpandPbfBlobIndexEntryBoundsRecd(PbfBlobIndexEntry* entry, recd bounds)
+{
+	ExpandPbfBlobIndexEntryBounds(entry,
+		MinR64(bounds.lon, bounds.lon + bounds.sizeLon), MinR64(bounds.lat, bounds.lat + bounds.sizeLat),
+		MaxR64(bounds.lon, bounds.lon + bounds.sizeLon), MaxR64(bounds.lat, bounds.lat + bounds.sizeLat)
+	);
+}
+
+bool DoesPbfBlobIndexEntryIntersectBounds(const PbfBlobIndexEntry* entry, v2d boundsMin, v2d boundsMax)
+{
+	if ((entry->flags & PbfBlobIndexFlag_HasBounds) == 0) { return false; }
+	return (entry->minLon <= boundsMax.lon && entry->maxLon >= boundsMin.lon && entry->minLat <= boundsMax.lat && entry->maxLat >= boundsMin.lat);
+}
+
+// ids must be sorted
+bool DoesPbfBlobIndexEntryContainAnyNodeId(const PbfBlobIndexEntry* entry, uxx numIds, const u64* ids)
+{
+	if ((entry->flags & PbfBlobIndexFlag_HasNodes) == 0 || numIds == 0) { return false; }
+	uxx lowIndex = 0;
+	uxx highIndex = numIds;
+	while (lowIndex < highIndex)
+	{
+		uxx middleIndex = lowIndex + (highIndex - lowIndex)/2;
+		if (ids[middleIndex] < entry->minNodeId) { lowIndex = middleIndex+1; }
+		else { highIndex = middleIndex; }
+	}
+	return (lowIndex < numIds && ids[lowIndex] <= entry->maxNodeId);
+}
+
+// kindFlag should be one of PbfBlobIndexFlag_HasNodes/HasWays/HasRelations. Returns the index of the first entry whose id range
+// contains the id, or entries.length if there isn't one. Ranges don't overlap in files that are sorted by id (which is most of them)
+uxx FindPbfBlobIndexEntryForId(PbfBlobIndex* index, PbfBlobIndexFlags kindFlag, u64 id)
+{
+	NotNull(index);
+	VarArrayLoop(&index->entries, eIndex)
+	{
+		VarArrayLoopGet(PbfBlobIndexEntry, entry, &index->entries, eIndex);
+		if ((entry->flags & kindFlag) == 0) { continue; }
+		if (kindFlag == PbfBlobIndexFlag_HasNodes && id >= entry->minNodeId && id <= entry->maxNodeId) { return eIndex; }
+		if (kindFlag == PbfBlobIndexFlag_HasWays && id >= entry->minWayId && id <= entry->maxWayId) { return eIndex; }
+		if (kindFlag == PbfBlobIndexFlag_HasRelations && id >= entry->minRelationId && id <= entry->maxRelationId) { return eIndex; }
+	}
+	return index->entries.length;
+}
+
+// Totals for the whole file. These are exact for an unfiltered load, which lets the OsmMap arrays be allocated once instead of growing
+void SumPbfBlobIndexCounts(PbfBlobIndex* index, u64* numNodesOut, u64* numWaysOut, u64* numRelationsOut)
+{
+	NotNull(index);
+	u64 numNodes = 0;
+	u64 numWays = 0;
+	u64 numRelations = 0;
+	VarArrayLoop(&index->entries, eIndex)
+	{
+		VarArrayLoopGet(PbfBlobIndexEntry, entry, &index->entries, eIndex);
+		numNodes += entry->numNodes;
+		numWays += entry->numWays;
+		numRelations += entry->numRelations;
+	}
+	if (numNodesOut != nullptr) { *numNodesOut = numNodes; }
+	if (numWaysOut != nullptr) { *numWaysOut = numWays; }
+	if (numRelationsOut != nullptr) { *numRelationsOut = numRelations; }
+}
+
+// Ways and relations don't have locations of their own, so their blobs get bounds after the whole map is loaded (and all the
+// indices are resolved) from the nodes they reference. The ways and relations arrays must be sorted
+void FinishPbfBlobIndexBounds(PbfBlobIndex* index, OsmMap* map)
+{
+	TracyCZoneN(funcZone, "FinishPbfBlobIndexBounds", true);
+	NotNull(index);
+	NotNull(map);
+	Assert(map->areWaysSorted && map->areRelationsSorted);
+	OsmWay* ways = (OsmWay*)map->ways.items;
+	OsmRelation* relations = (OsmRelation*)map->relations.items;
+	VarArrayLoop(&index->entries, eIndex)
+	{
+		VarArrayLoopGet(PbfBlobIndexEntry, entry, &index->entries, eIndex);
+		if ((entry->flags & PbfBlobIndexFlag_HasWays) != 0)
+		{
+			uxx lowIndex = 0;
+			uxx highIndex = map->ways.length;
+			while (lowIndex < highIndex) { uxx middleIndex = lowIndex + (highIndex - lowIndex)/2; if (ways[middleIndex].id < entry->minWayId) { lowIndex = middleIndex+1; } else { highIndex = middleIndex; } }
+			for (uxx wIndex = lowIndex; wIndex < map->ways.length && ways[wIndex].id <= entry->maxWayId; wIndex++)
+			{
+				OsmWay* way = &ways[wIndex];
+				VarArrayLoop(&way->nodes, nIndex)
+				{
+					v2d location = V2d_Zero;
+					if (TryGetOsmWayNodeLocation(map, way, nIndex, &location)) { ExpandPbfBlobIndexEntryBoundsRecd(entry, way->nodeBounds); break; }
+				}
+			}
+		}
+		if ((entry->flags & PbfBlobIndexFlag_HasRelations) != 0)
+		{
+			uxx lowIndex = 0;
+			uxx highIndex = map->relations.length;
+			while (lowIndex < highIndex) { uxx middleIndex = lowIndex + (highIndex - lowIndex)/2; if (relations[middleIndex].id < entry->minRelationId) { lowIndex = middleIndex+1; } else { highIndex = middleIndex; } }
+			for (uxx rIndex = lowIndex; rIndex < map->relations.length && relations[rIndex].id <= entry->maxRelationId; rIndex++)
+			{
+				OsmRelation* relation = &relations[rIndex];
+				VarArrayLoop(&relation->members, mIndex)
+				{
+					VarArrayLoopGet(OsmRelationMember, member, &relation->members, mIndex);
+					if (member->type == OsmRelationMemberType_Node && member->index != OSM_INVALID_INDEX)
+					{
+						v2d location = GetOsmNodeLocation(map, GetOsmNodeByIndex(map, member->index));
+						ExpandPbfBlobIndexEntryBounds(entry, location.lon, location.lat, location.lon, location.lat);
+					}
+					else if (member->type == OsmRelationMemberType_Way && member->index != OSM_INVALID_INDEX && GetOsmWayByIndex(map, member->index)->nodes.length > 0)
+					{
+						ExpandPbfBlobIndexEntryBoundsRecd(entry, GetOsmWayByIndex(map, member->index)->nodeBounds);
+					}
+				}
+			}
+		}
+	}
+	TracyCZoneEnd(funcZone);
+}
+
+// Returns Result_FileNotFound if there is no index yet and Result_Mismatch if the index was made for a different version of the .pbf
+Result TryLoadPbfBlobIndex(Arena* arena, FilePath indexPath, const MappedFile* sourceFile, PbfBlobIndex* indexOut)
+{
+	TracyCZoneN(funcZone, "TryLoadPbfBlobIndex", true);
+	NotNull(arena);
+	NotNull(sourceFile);
+	NotNull(indexOut);
+	ScratchBegin1(scratch, arena);
+	Slice fileContents = Slice_Empty;
+	if (!OsReadBinFile(indexPath, scratch, &fileContents)) { ScratchEnd(scratch); TracyCZoneEnd(funcZone); return Result_FileNotFound; }
+	
+	Result result = Result_None;
+	PbfBlobIndexFileHeader header = ZEROED;
+	if (fileContents.length < sizeof(PbfBlobIndexFileHeader)) { result = Result_MissingFileHeader; }
+	else
+	{
+		MyMemCopy(&header, fileContents.bytes, sizeof(PbfBlobIndexFileHeader));
+		if (!MyMemEquals(header.magic, PBF_BLOB_INDEX_MAGIC, sizeof(header.magic))) { result = Result_MissingFileHeader; }
+		else if (header.version != PBF_BLOB_INDEX_VERSION || header.entrySize != sizeof(PbfBlobIndexEntry)) { result = Result_WrongInternalFormat; }
+		else if (header.sourceFileSize != sourceFile->size || header.sourceFileHash != CalcPbfBlobIndexSourceHash(sourceFile)) { result = Result_Mismatch; }
+		else if (header.numEntries > (fileContents.length - sizeof(PbfBlobIndexFileHeader)) / sizeof(PbfBlobIndexEntry)) { result = Result_MissingData; }
+	}
+	
+	if (result == Result_None)
+	{
+		InitPbfBlobIndex(arena, indexOut);
+		indexOut->sourceFileSize = header.sourceFileSize;
+		indexOut->sourceFileHash = header.sourceFileHash;
+		VarArrayExpand(&indexOut->entries, (uxx)header.numEntries);
+		const PbfBlobIndexEntry* fileEntries = (const PbfBlobIndexEntry*)(fileContents.bytes + sizeof(PbfBlobIndexFileHeader));
+		for (uxx eIndex = 0; eIndex < (uxx)header.numEntries; eIndex++)
+		{
+			const PbfBlobIndexEntry* fileEntry = &fileEntries[eIndex];
+			if (fileEntry->fileOffset + fileEntry->length > sourceFile->size || (fileEntry->flags & ~(u64)PbfBlobIndexFlag_All) != 0) { result = Result_InvalidInput; break; }
+			PbfBlobIndexEntry* newEntry = VarArrayAdd(PbfBlobIndexEntry, &indexOut->entries);
+			NotNull(newEntry);
+			MyMemCopy(newEntry, fileEntry, sizeof(PbfBlobIndexEntry));
+		}
+		if (result != Result_None) { FreePbfBlobIndex(indexOut); }
+	}
+	
+	ScratchEnd(scratch);
+	TracyCZoneEnd(funcZone);
+	return (result == Result_None) ? Result_Success : result;
+}
+
+bool SavePbfBlobIndex(FilePath indexPath, PbfBlobIndex* index)
+{
+	TracyCZoneN(funcZone, "SavePbfBlobIndex", true);
+	NotNull(index);
+	ScratchBegin(scratch);
+	uxx fileSize = sizeof(PbfBlobIndexFileHeader) + (index->entries.length * sizeof(PbfBlobIndexEntry));
+	u8* fileBytes = AllocArray(u8, scratch, fileSize);
+	NotNull(fileBytes);
+	PbfBlobIndexFileHeader header = ZEROED;
+	MyMemCopy(header.magic, PBF_BLOB_INDEX_MAGIC, sizeof(header.magic));
+	header.version = PBF_BLOB_INDEX_VERSION;
+	header.entrySize = sizeof(PbfBlobIndexEntry);
+	header.sourceFileSize = index->sourceFileSize;
+	header.sourceFileHash = index->sourceFileHash;
+	header.numEntries = index->entries.length;
+	MyMemCopy(fileBytes, &header, sizeof(PbfBlobIndexFileHeader));
+	if (index->entries.length > 0) { MyMemCopy(fileBytes + sizeof(PbfBlobIndexFileHeader), index->entries.items, index->entries.length * sizeof(PbfBlobIndexEntry)); }
+	bool result = OsWriteBinFile(indexPath, MakeSlice(fileSize, fileBytes));
+	ScratchEnd(scratch);
+	TracyCZoneEnd(funcZone);
+	return result;
+}
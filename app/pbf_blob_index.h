@@ -0,0 +1,64 @@
+/*
+File:   pbf_blob_index.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _PBF_BLOB_INDEX_H
+#define _PBF_BLOB_INDEX_H
+
+#define PBF_BLOB_INDEX_FILE_EXT  ".cosmidx" //appended to the full .pbf path, ex. "washington-latest.osm.pbf.cosmidx"
+#define PBF_BLOB_INDEX_MAGIC     "COSMIDX1" //8 bytes, no null-terminator in the file
+#define PBF_BLOB_INDEX_VERSION   2
+#define PBF_BLOB_INDEX_HASH_SIZE Kilobytes(64) //bytes from the start and end of the .pbf that are hashed to notice when the file changes
+
+typedef enum PbfBlobIndexFlags PbfBlobIndexFlags;
+enum PbfBlobIndexFlags
+{
+	PbfBlobIndexFlag_None         = 0x00,
+	PbfBlobIndexFlag_Header       = 0x01,
+	PbfBlobIndexFlag_HasNodes     = 0x02,
+	PbfBlobIndexFlag_HasWays      = 0x04,
+	PbfBlobIndexFlag_HasRelations = 0x08,
+	PbfBlobIndexFlag_HasBounds    = 0x10, //minLon/minLat/maxLon/maxLat are valid. Nodes give their own locations, ways and relations use the nodes they reference
+	PbfBlobIndexFlag_All          = 0x1F,
+};
+
+// One per blob in the file, in file order. This is also exactly how the entries are laid out in the .cosmidx file
+typedef plex PbfBlobIndexEntry PbfBlobIndexEntry;
+plex PbfBlobIndexEntry
+{
+	u64 fileOffset; //of the 4 byte BlobHeader length
+	u64 length; //4 + BlobHeader + Blob bytes
+	u64 flags; //PbfBlobIndexFlags
+	u64 minNodeId, maxNodeId;
+	u64 minWayId, maxWayId;
+	u64 minRelationId, maxRelationId;
+	u64 numNodes, numWays, numRelations; //lets a load size the OsmMap arrays up front (see SumPbfBlobIndexCounts)
+	r64 minLon, minLat;
+	r64 maxLon, maxLat;
+};
+
+typedef plex PbfBlobIndexFileHeader PbfBlobIndexFileHeader;
+plex PbfBlobIndexFileHeader
+{
+	char magic[8];
+	u32 version;
+	u32 entrySize;
+	u64 sourceFileSize;
+	u64 sourceFileHash;
+	u64 numEntries;
+};
+
+// A table of contents for a .pbf file so that a filtered load (see OsmLoadOptions) can seek straight to the blobs it needs
+// rather than inflating and decoding every blob in the file. Built during a normal unfiltered load and saved next to the .pbf
+typedef plex PbfBlobIndex PbfBlobIndex;
+plex PbfBlobIndex
+{
+	Arena* arena;
+	u64 sourceFileSize;
+	u64 sourceFileHash;
+	VarArray entries; //PbfBlobIndexEntry
+};
+
+#endif //  _PBF_BLOB_INDEX_H
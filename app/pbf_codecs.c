@@ -0,0 +1,719 @@
+/*
+File:   pbf_codecs.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the compression and decompression functions for each kind of Blob data in a .pbf and the
+	** table that DecompressPbfStagedBlob and SerializePbfMap dispatch through. Zlib decompression comes
+	** from PigCore, ZSTD is the vendored decoder in third_party/zstd, and LZ4 (block format) and LZMA
+	** ("LZMA alone" streams) are small enough that we decode them ourselves. PigCore has no zlib
+	** compressor so the deflate encoder that SerializePbfMap uses lives here too. app_codec_checks.c holds
+	** known-answer checks for the ones we wrote ourselves
+*/
+
+PBF_DECOMPRESS_DEF(PbfDecompressRaw)
+{
+	UNUSED(arena);
+	if (compressedData.length != rawSize) { return Slice_Empty; }
+	return compressedData;
+}
+
+PBF_DECOMPRESS_DEF(PbfDecompressZlib)
+{
+	TracyCZoneN(Zone_Func, "ZlibDecompress", true);
+	TracyCZoneValue(Zone_Func, rawSize);
+	Slice result = ZlibDecompressIntoArena(arena, compressedData, rawSize);
+	TracyCZoneEnd(Zone_Func);
+	return result;
+}
+
+PBF_DECOMPRESS_DEF(PbfDecompressZstd)
+{
+	TracyCZoneN(Zone_Func, "ZstdDecompress", true);
+	TracyCZoneValue(Zone_Func, rawSize);
+	u8* resultBytes = AllocArray(u8, arena, rawSize);
+	NotNull(resultBytes);
+	//NOTE: ZSTD_decompress allocates (and frees) its own decompression context every call. Keeping one around per worker would
+	//      save a little time but the context is ~100KB of heap memory that we'd have to tie to the worker's lifetime
+	size_t decompressedSize = ZSTD_decompress(resultBytes, rawSize, compressedData.bytes, compressedData.length);
+	TracyCZoneEnd(Zone_Func);
+	if (ZSTD_isError(decompressedSize) || decompressedSize != rawSize) { FreeArray(u8, arena, rawSize, resultBytes); return Slice_Empty; }
+	return MakeSlice(rawSize, resultBytes);
+}
+
+// +--------------------------------------------------------------+
+// |                          LZ4 Block                           |
+// +--------------------------------------------------------------+
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+// Each sequence is a token byte (4 bits literal length, 4 bits match length), the literals, a 2 byte little-endian offset and
+// then the match. Lengths of 15 are continued with extra bytes (until one isn't 255). The last sequence is only literals
+PBF_DECOMPRESS_DEF(PbfDecompressLz4)
+{
+	TracyCZoneN(Zone_Func, "Lz4Decompress", true);
+	TracyCZoneValue(Zone_Func, rawSize);
+	u8* resultBytes = AllocArray(u8, arena, rawSize);
+	NotNull(resultBytes);
+	const u8* inBytes = compressedData.bytes;
+	uxx inLength = compressedData.length;
+	uxx inIndex = 0;
+	uxx outIndex = 0;
+	bool isValid = (inLength > 0);
+	while (isValid && inIndex < inLength)
+	{
+		u8 token = inBytes[inIndex++];
+		uxx literalLength = (uxx)(token >> 4);
+		if (literalLength == 15)
+		{
+			u8 extraByte = 255;
+			while (extraByte == 255 && inIndex < inLength) { extraByte = inBytes[inIndex++]; literalLength += extraByte; }
+			if (extraByte == 255) { isValid = false; break; }
+		}
+		if (literalLength > inLength - inIndex || literalLength > rawSize - outIndex) { isValid = false; break; }
+		MyMemCopy(&resultBytes[outIndex], &inBytes[inIndex], literalLength);
+		inIndex += literalLength;
+		outIndex += literalLength;
+		if (inIndex == inLength) { break; } //the last sequence has no match
+		
+		if (inLength - inIndex < 2) { isValid = false; break; }
+		uxx matchOffset = (uxx)inBytes[inIndex] | ((uxx)inBytes[inIndex+1] << 8);
+		inIndex += 2;
+		if (matchOffset == 0 || matchOffset > outIndex) { isValid = false; break; }
+		uxx matchLength = (uxx)(token & 0x0F);
+		if (matchLength == 15)
+		{
+			u8 extraByte = 255;
+			while (extraByte == 255 && inIndex < inLength) { extraByte = inBytes[inIndex++]; matchLength += extraByte; }
+			if (extraByte == 255) { isValid = false; break; }
+		}
+		matchLength += 4; //minimum match length
+		if (matchLength > rawSize - outIndex) { isValid = false; break; }
+		//NOTE: The match is allowed to overlap the bytes it's producing (ex. offset 1 repeats the last byte) so it can only be
+		//      copied all at once when the offset is at least as long as the match
+		if (matchOffset >= matchLength) { MyMemCopy(&resultBytes[outIndex], &resultBytes[outIndex - matchOffset], matchLength); }
+		else { for (uxx bIndex = 0; bIndex < matchLength; bIndex++) { resultBytes[outIndex + bIndex] = resultBytes[outIndex - matchOffset + bIndex]; } }
+		outIndex += matchLength;
+	}
+	TracyCZoneEnd(Zone_Func);
+	if (!isValid || outIndex != rawSize) { FreeArray(u8, arena, rawSize, resultBytes); return Slice_Empty; }
+	return MakeSlice(rawSize, resultBytes);
+}
+
+// +--------------------------------------------------------------+
+// |                             LZMA                             |
+// +--------------------------------------------------------------+
+// This follows the structure of the reference decoder in the LZMA SDK (DOC/lzma-specification.txt) rather than the optimized
+// LzmaDec.c. Since we always decode a whole blob into one buffer the output buffer doubles as the dictionary
+void InitLzmaProbs(uxx numProbs, u16* probs)
+{
+	for (uxx pIndex = 0; pIndex < numProbs; pIndex++) { probs[pIndex] = LZMA_PROB_INIT; }
+}
+
+u8 LzmaReadByte(LzmaRangeDecoder* rangeDecoder)
+{
+	if (rangeDecoder->offset >= rangeDecoder->length) { rangeDecoder->isError = true; return 0; }
+	return rangeDecoder->bytes[rangeDecoder->offset++];
+}
+
+bool InitLzmaRangeDecoder(LzmaRangeDecoder* rangeDecoder, Slice bytes)
+{
+	ClearPointer(rangeDecoder);
+	rangeDecoder->bytes = bytes.bytes;
+	rangeDecoder->length = bytes.length;
+	rangeDecoder->range = 0xFFFFFFFF;
+	u8 firstByte = LzmaReadByte(rangeDecoder);
+	for (uxx bIndex = 0; bIndex < 4; bIndex++) { rangeDecoder->code = (rangeDecoder->code << 8) | LzmaReadByte(rangeDecoder); }
+	return (firstByte == 0 && rangeDecoder->code != rangeDecoder->range && !rangeDecoder->isError);
+}
+
+void NormalizeLzmaRange(LzmaRangeDecoder* rangeDecoder)
+{
+	if (rangeDecoder->range < LZMA_RANGE_TOP)
+	{
+		rangeDecoder->range <<= 8;
+		rangeDecoder->code = (rangeDecoder->code << 8) | LzmaReadByte(rangeDecoder);
+	}
+}
+
+u32 DecodeLzmaBit(LzmaRangeDecoder* rangeDecoder, u16* prob)
+{
+	u32 bound = (rangeDecoder->range >> 11) * (u32)(*prob);
+	u32 result = 0;
+	if (rangeDecoder->code < bound)
+	{
+		*prob = (u16)(*prob + ((LZMA_BIT_MODEL_TOTAL - *prob) >> LZMA_NUM_MOVE_BITS));
+		rangeDecoder->range = bound;
+	}
+	else
+	{
+		*prob = (u16)(*prob - (*prob >> LZMA_NUM_MOVE_BITS));
+		rangeDecoder->code -= bound;
+		rangeDecoder->range -= bound;
+		result = 1;
+	}
+	NormalizeLzmaRange(rangeDecoder);
+	return result;
+}
+
+u32 DecodeLzmaDirectBits(LzmaRangeDecoder* rangeDecoder, uxx numBits)
+{
+	u32 result = 0;
+	for (uxx bIndex = 0; bIndex < numBits; bIndex++)
+	{
+		rangeDecoder->range >>= 1;
+		rangeDecoder->code -= rangeDecoder->range;
+		u32 mask = 0 - (rangeDecoder->code >> 31); //all 1s if code went "negative"
+		rangeDecoder->code += (rangeDecoder->range & mask);
+		if (rangeDecoder->code == rangeDecoder->range) { rangeDecoder->isError = true; }
+		NormalizeLzmaRange(rangeDecoder);
+		result = (result << 1) + (mask + 1);
+	}
+	return result;
+}
+
+u32 DecodeLzmaBitTree(LzmaRangeDecoder* rangeDecoder, u16* probs, uxx numBits)
+{
+	u32 index = 1;
+	for (uxx bIndex = 0; bIndex < numBits; bIndex++) { index = (index << 1) + DecodeLzmaBit(rangeDecoder, &probs[index]); }
+	return index - ((u32)1 << numBits);
+}
+
+u32 DecodeLzmaBitTreeReverse(LzmaRangeDecoder* rangeDecoder, u16* probs, uxx numBits)
+{
+	u32 index = 1;
+	u32 result = 0;
+	for (uxx bIndex = 0; bIndex < numBits; bIndex++)
+	{
+		u32 bit = DecodeLzmaBit(rangeDecoder, &probs[index]);
+		index = (index << 1) + bit;
+		result |= (bit << bIndex);
+	}
+	return result;
+}
+
+u32 DecodeLzmaLength(LzmaRangeDecoder* rangeDecoder, LzmaLenDecoder* lenDecoder, uxx posState)
+{
+	if (DecodeLzmaBit(rangeDecoder, &lenDecoder->choice) == 0) { return DecodeLzmaBitTree(rangeDecoder, lenDecoder->low[posState], 3); }
+	if (DecodeLzmaBit(rangeDecoder, &lenDecoder->choice2) == 0) { return 8 + DecodeLzmaBitTree(rangeDecoder, lenDecoder->mid[posState], 3); }
+	return 16 + DecodeLzmaBitTree(rangeDecoder, lenDecoder->high, 8);
+}
+
+u32 DecodeLzmaDistance(LzmaDecoder* decoder, u32 length)
+{
+	uxx lenState = (length < LZMA_NUM_LEN_TO_POS-1) ? (uxx)length : LZMA_NUM_LEN_TO_POS-1;
+	u32 posSlot = DecodeLzmaBitTree(&decoder->rangeDecoder, decoder->probs.posSlot[lenState], 6);
+	if (posSlot < LZMA_START_POS_MODEL) { return posSlot; }
+	uxx numDirectBits = (uxx)((posSlot >> 1) - 1);
+	u32 result = ((2 | (posSlot & 1)) << numDirectBits);
+	if (posSlot < LZMA_END_POS_MODEL)
+	{
+		result += DecodeLzmaBitTreeReverse(&decoder->rangeDecoder, &decoder->probs.posDecoders[result - posSlot], numDirectBits);
+	}
+	else
+	{
+		result += (DecodeLzmaDirectBits(&decoder->rangeDecoder, numDirectBits - LZMA_NUM_ALIGN_BITS) << LZMA_NUM_ALIGN_BITS);
+		result += DecodeLzmaBitTreeReverse(&decoder->rangeDecoder, decoder->probs.align, LZMA_NUM_ALIGN_BITS);
+	}
+	return result;
+}
+
+// Decodes a whole "LZMA alone" stream (what xz --format=lzma and Python's lzma.FORMAT_ALONE write) into rawSize bytes
+PBF_DECOMPRESS_DEF(PbfDecompressLzma)
+{
+	TracyCZoneN(Zone_Func, "LzmaDecompress", true);
+	TracyCZoneValue(Zone_Func, rawSize);
+	if (compressedData.length < LZMA_ALONE_HEADER_SIZE) { TracyCZoneEnd(Zone_Func); return Slice_Empty; }
+	const u8* header = compressedData.bytes;
+	u32 properties = (u32)header[0];
+	if (properties >= 9*5*5) { TracyCZoneEnd(Zone_Func); return Slice_Empty; }
+	uxx numLiteralContextBits = (uxx)(properties % 9); properties /= 9;
+	uxx numLiteralPosBits = (uxx)(properties % 5);
+	uxx numPosBits = (uxx)(properties / 5);
+	u64 headerRawSize = 0;
+	for (uxx bIndex = 0; bIndex < 8; bIndex++) { headerRawSize |= ((u64)header[5 + bIndex] << (bIndex*8)); }
+	if (headerRawSize != UINT64_MAX && headerRawSize != (u64)rawSize) { TracyCZoneEnd(Zone_Func); return Slice_Empty; }
+	if (numLiteralContextBits + numLiteralPosBits > LZMA_MAX_LITERAL_BITS) { TracyCZoneEnd(Zone_Func); return Slice_Empty; }
+	//NOTE: The dictionary size (header[1..4]) doesn't matter to us since the whole output is our dictionary
+	
+	uxx arenaMark = ArenaGetMark(arena);
+	u8* resultBytes = AllocArray(u8, arena, rawSize);
+	NotNull(resultBytes);
+	LzmaDecoder decoder = ZEROED;
+	uxx numLiteralProbs = ((uxx)0x300 << (numLiteralContextBits + numLiteralPosBits));
+	u16* literalProbs = AllocArray(u16, arena, numLiteralProbs);
+	NotNull(literalProbs);
+	InitLzmaProbs(numLiteralProbs, literalProbs);
+	InitLzmaProbs(sizeof(LzmaProbs)/sizeof(u16), (u16*)&decoder.probs);
+	bool isValid = InitLzmaRangeDecoder(&decoder.rangeDecoder, MakeSlice(compressedData.length - LZMA_ALONE_HEADER_SIZE, compressedData.bytes + LZMA_ALONE_HEADER_SIZE));
+	LzmaRangeDecoder* rangeDecoder = &decoder.rangeDecoder;
+	
+	uxx posMask = ((uxx)1 << numPosBits) - 1;
+	uxx literalPosMask = ((uxx)1 << numLiteralPosBits) - 1;
+	uxx state = 0;
+	u32 rep0 = 0, rep1 = 0, rep2 = 0, rep3 = 0;
+	uxx outIndex = 0;
+	while (isValid && outIndex < rawSize)
+	{
+		uxx posState = (outIndex & posMask);
+		if (DecodeLzmaBit(rangeDecoder, &decoder.probs.isMatch[(state << LZMA_NUM_POS_BITS_MAX) + posState]) == 0)
+		{
+			u8 prevByte = (outIndex > 0) ? resultBytes[outIndex-1] : 0;
+			uxx literalState = ((outIndex & literalPosMask) << numLiteralContextBits) + (prevByte >> (8 - numLiteralContextBits));
+			u16* probs = &literalProbs[0x300 * literalState];
+			u32 symbol = 1;
+			if (state >= 7)
+			{
+				u32 matchByte = resultBytes[outIndex - rep0 - 1];
+				while (symbol < 0x100)
+				{
+					u32 matchBit = ((matchByte >> 7) & 1);
+					matchByte <<= 1;
+					u32 bit = DecodeLzmaBit(rangeDecoder, &probs[((1 + matchBit) << 8) + symbol]);
+					symbol = (symbol << 1) | bit;
+					if (matchBit != bit) { break; }
+				}
+			}
+			while (symbol < 0x100) { symbol = (symbol << 1) | DecodeLzmaBit(rangeDecoder, &probs[symbol]); }
+			resultBytes[outIndex++] = (u8)(symbol - 0x100);
+			state = (state < 4) ? 0 : ((state < 10) ? state-3 : state-6);
+			continue;
+		}
+		
+		u32 length = 0;
+		if (DecodeLzmaBit(rangeDecoder, &decoder.probs.isRep[state]) != 0)
+		{
+			if (outIndex == 0) { isValid = false; break; }
+			if (DecodeLzmaBit(rangeDecoder, &decoder.probs.isRepG0[state]) == 0)
+			{
+				if (DecodeLzmaBit(rangeDecoder, &decoder.probs.isRep0Long[(state << LZMA_NUM_POS_BITS_MAX) + posState]) == 0)
+				{
+					//"Short rep", a single byte from rep0
+					state = (state < 7) ? 9 : 11;
+					resultBytes[outIndex] = resultBytes[outIndex - rep0 - 1];
+					outIndex++;
+					continue;
+				}
+			}
+			else
+			{
+				u32 distance = 0;
+				if (DecodeLzmaBit(rangeDecoder, &decoder.probs.isRepG1[state]) == 0) { distance = rep1; }
+				else
+				{
+					if (DecodeLzmaBit(rangeDecoder, &decoder.probs.isRepG2[state]) == 0) { distance = rep2; }
+					else { distance = rep3; rep3 = rep2; }
+					rep2 = rep1;
+				}
+				rep1 = rep0;
+				rep0 = distance;
+			}
+			length = DecodeLzmaLength(rangeDecoder, &decoder.probs.repLenDecoder, posState);
+			state = (state < 7) ? 8 : 11;
+		}
+		else
+		{
+			rep3 = rep2;
+			rep2 = rep1;
+			rep1 = rep0;
+			length = DecodeLzmaLength(rangeDecoder, &decoder.probs.lenDecoder, posState);
+			state = (state < 7) ? 7 : 10;
+			rep0 = DecodeLzmaDistance(&decoder, length);
+			if (rep0 == 0xFFFFFFFF) { break; } //end marker, only valid if we have all the bytes (checked below)
+			if ((uxx)rep0 >= outIndex) { isValid = false; break; }
+		}
+		
+		length += LZMA_MATCH_MIN_LENGTH;
+		if ((uxx)length > rawSize - outIndex) { isValid = false; break; }
+		for (uxx bIndex = 0; bIndex < (uxx)length; bIndex++) { resultBytes[outIndex + bIndex] = resultBytes[outIndex - rep0 - 1 + bIndex]; }
+		outIndex += (uxx)length;
+		if (rangeDecoder->isError) { isValid = false; }
+	}
+	TracyCZoneEnd(Zone_Func);
+	if (!isValid || rangeDecoder->isError || outIndex != rawSize) { ArenaResetToMark(arena, arenaMark); return Slice_Empty; }
+	//NOTE: The literal probabilities were allocated after the result so we can give them back
+	FreeArray(u16, arena, numLiteralProbs, literalProbs);
+	return MakeSlice(rawSize, resultBytes);
+}
+
+// +--------------------------------------------------------------+
+// |                       Zlib Compression                       |
+// +--------------------------------------------------------------+
+// https://www.rfc-editor.org/rfc/rfc1951 (deflate) and https://www.rfc-editor.org/rfc/rfc1950 (the zlib wrapper)
+// Greedy LZ77 matching over 3 byte hash chains followed by one dynamic Huffman block per DEFLATE_BLOCK_TOKENS tokens.
+// This doesn't compress quite as well as zlib's default level but it's plenty for PrimitiveBlocks, which are mostly varints
+const u16 DeflateLengthBases[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const u8 DeflateLengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const u16 DeflateDistBases[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const u8 DeflateDistExtraBits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+const u8 DeflateClOrder[DEFLATE_NUM_CL_CODES] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+void DeflateWriteBits(DeflateBitWriter* writer, u32 value, u8 numBits)
+{
+	writer->bitBuffer |= ((u64)value << writer->numBits);
+	writer->numBits += numBits;
+	while (writer->numBits >= 8)
+	{
+		if (writer->offset >= writer->length) { writer->isOverflow = true; writer->numBits = 0; writer->bitBuffer = 0; return; }
+		writer->bytes[writer->offset++] = (u8)(writer->bitBuffer & 0xFF);
+		writer->bitBuffer >>= 8;
+		writer->numBits -= 8;
+	}
+}
+void DeflateFlushBits(DeflateBitWriter* writer)
+{
+	if (writer->numBits > 0) { DeflateWriteBits(writer, 0, 8 - writer->numBits); }
+}
+
+uxx GetDeflateLengthCode(uxx matchLength)
+{
+	uxx result = 28;
+	while (DeflateLengthBases[result] > matchLength) { result--; }
+	return result;
+}
+uxx GetDeflateDistCode(uxx distance)
+{
+	uxx result = 29;
+	while (DeflateDistBases[result] > distance) { result--; }
+	return result;
+}
+
+// Builds Huffman code lengths for the given frequencies that are no longer than maxLength. When the tree is too deep the
+// frequencies are halved (keeping every used symbol at least 1) and we try again, which flattens the tree a little each time
+void BuildDeflateCodeLengths(const u32* frequencies, uxx numSymbols, u8 maxLength, u8* lengthsOut)
+{
+	u32 nodeFreqs[2 * DEFLATE_NUM_LITLEN_CODES];
+	u16 nodeParents[2 * DEFLATE_NUM_LITLEN_CODES];
+	u16 leafSymbols[DEFLATE_NUM_LITLEN_CODES];
+	u32 scaledFreqs[DEFLATE_NUM_LITLEN_CODES];
+	Assert(numSymbols <= DEFLATE_NUM_LITLEN_CODES);
+	for (uxx sIndex = 0; sIndex < numSymbols; sIndex++) { scaledFreqs[sIndex] = frequencies[sIndex]; lengthsOut[sIndex] = 0; }
+	
+	while (true)
+	{
+		//Leaves sorted by frequency (insertion sort is fine for at most 286 symbols)
+		uxx numLeaves = 0;
+		for (uxx sIndex = 0; sIndex < numSymbols; sIndex++)
+		{
+			if (scaledFreqs[sIndex] == 0) { continue; }
+			uxx insertIndex = numLeaves;
+			while (insertIndex > 0 && scaledFreqs[leafSymbols[insertIndex-1]] > scaledFreqs[sIndex]) { leafSymbols[insertIndex] = leafSymbols[insertIndex-1]; insertIndex--; }
+			leafSymbols[insertIndex] = (u16)sIndex;
+			numLeaves++;
+		}
+		if (numLeaves == 0) { return; }
+		if (numLeaves == 1) { lengthsOut[leafSymbols[0]] = 1; return; }
+		
+		//Two queue Huffman construction: leaves are nodes [0, numLeaves), internal nodes are appended after them in increasing frequency order
+		for (uxx lIndex = 0; lIndex < numLeaves; lIndex++) { nodeFreqs[lIndex] = scaledFreqs[leafSymbols[lIndex]]; }
+		uxx nextLeaf = 0;
+		uxx nextInternal = numLeaves;
+		uxx numNodes = numLeaves;
+		while (numNodes < 2*numLeaves - 1)
+		{
+			uxx children[2];
+			for (uxx cIndex = 0; cIndex < 2; cIndex++)
+			{
+				bool takeLeaf = (nextLeaf < numLeaves && (nextInternal >= numNodes || nodeFreqs[nextLeaf] <= nodeFreqs[nextInternal]));
+				children[cIndex] = takeLeaf ? nextLeaf++ : nextInternal++;
+			}
+			nodeFreqs[numNodes] = nodeFreqs[children[0]] + nodeFreqs[children[1]];
+			nodeParents[children[0]] = (u16)numNodes;
+			nodeParents[children[1]] = (u16)numNodes;
+			numNodes++;
+		}
+		
+		//Parents always come after their children so depths can be filled in from the root down
+		u8 nodeDepths[2 * DEFLATE_NUM_LITLEN_CODES];
+		nodeDepths[numNodes-1] = 0;
+		u8 maxDepth = 0;
+		for (uxx nIndex = numNodes-1; nIndex > 0; nIndex--)
+		{
+			nodeDepths[nIndex-1] = nodeDepths[nodeParents[nIndex-1]] + 1;
+			if (nodeDepths[nIndex-1] > maxDepth) { maxDepth = nodeDepths[nIndex-1]; }
+		}
+		if (maxDepth <= maxLength)
+		{
+			for (uxx lIndex = 0; lIndex < numLeaves; lIndex++) { lengthsOut[leafSymbols[lIndex]] = nodeDepths[lIndex]; }
+			return;
+		}
+		for (uxx sIndex = 0; sIndex < numSymbols; sIndex++) { if (scaledFreqs[sIndex] > 0) { scaledFreqs[sIndex] = (scaledFreqs[sIndex] + 1) / 2; } }
+	}
+}
+
+// Canonical codes (RFC 1951 section 3.2.2), bit-reversed since the code bits are written most significant bit first
+void BuildDeflateCodes(const u8* lengths, uxx numSymbols, DeflateHuffmanCode* codesOut)
+{
+	u16 lengthCounts[DEFLATE_MAX_CODE_LENGTH+1] = ZEROED;
+	for (uxx sIndex = 0; sIndex < numSymbols; sIndex++) { lengthCounts[lengths[sIndex]]++; }
+	lengthCounts[0] = 0;
+	u16 nextCodes[DEFLATE_MAX_CODE_LENGTH+1] = ZEROED;
+	u16 code = 0;
+	for (uxx bIndex = 1; bIndex <= DEFLATE_MAX_CODE_LENGTH; bIndex++)
+	{
+		code = (u16)((code + lengthCounts[bIndex-1]) << 1);
+		nextCodes[bIndex] = code;
+	}
+	for (uxx sIndex = 0; sIndex < numSymbols; sIndex++)
+	{
+		u8 length = lengths[sIndex];
+		codesOut[sIndex].length = length;
+		codesOut[sIndex].code = 0;
+		if (length == 0) { continue; }
+		u16 symbolCode = nextCodes[length]++;
+		u16 reversedCode = 0;
+		for (u8 bIndex = 0; bIndex < length; bIndex++) { reversedCode = (u16)((reversedCode << 1) | ((symbolCode >> bIndex) & 1)); }
+		codesOut[sIndex].code = reversedCode;
+	}
+}
+
+void WriteDeflateDynamicBlock(DeflateBitWriter* writer, const u32* tokens, uxx numTokens, bool isFinal)
+{
+	u32 litLenFreqs[DEFLATE_NUM_LITLEN_CODES] = ZEROED;
+	u32 distFreqs[DEFLATE_NUM_DIST_CODES] = ZEROED;
+	for (uxx tIndex = 0; tIndex < numTokens; tIndex++)
+	{
+		u32 token = tokens[tIndex];
+		if ((token & DEFLATE_MATCH_FLAG) == 0) { litLenFreqs[token]++; continue; }
+		litLenFreqs[257 + GetDeflateLengthCode(((token >> 16) & 0xFF) + DEFLATE_MIN_MATCH)]++;
+		distFreqs[GetDeflateDistCode((token & 0xFFFF) + 1)]++;
+	}
+	litLenFreqs[256]++; //end of block
+	
+	u8 litLenLengths[DEFLATE_NUM_LITLEN_CODES];
+	u8 distLengths[DEFLATE_NUM_DIST_CODES];
+	BuildDeflateCodeLengths(litLenFreqs, DEFLATE_NUM_LITLEN_CODES, DEFLATE_MAX_CODE_LENGTH, litLenLengths);
+	BuildDeflateCodeLengths(distFreqs, DEFLATE_NUM_DIST_CODES, DEFLATE_MAX_CODE_LENGTH, distLengths);
+	uxx numLitLenCodes = DEFLATE_NUM_LITLEN_CODES;
+	while (numLitLenCodes > 257 && litLenLengths[numLitLenCodes-1] == 0) { numLitLenCodes--; }
+	uxx numDistCodes = DEFLATE_NUM_DIST_CODES;
+	while (numDistCodes > 1 && distLengths[numDistCodes-1] == 0) { numDistCodes--; }
+	if (distLengths[0] == 0 && numDistCodes == 1) { distLengths[0] = 1; } //at least one distance code has to be described, even if it's never used
+	u8 lengths[DEFLATE_NUM_LITLEN_CODES + DEFLATE_NUM_DIST_CODES];
+	MyMemCopy(&lengths[0], litLenLengths, numLitLenCodes);
+	MyMemCopy(&lengths[numLitLenCodes], distLengths, numDistCodes);
+	uxx numLengths = numLitLenCodes + numDistCodes;
+	
+	//Run length encode the code lengths with 16 (repeat previous 3-6), 17 (3-10 zeros) and 18 (11-138 zeros)
+	u8 clSymbols[DEFLATE_NUM_LITLEN_CODES + DEFLATE_NUM_DIST_CODES];
+	u8 clExtras[DEFLATE_NUM_LITLEN_CODES + DEFLATE_NUM_DIST_CODES];
+	uxx numClSymbols = 0;
+	u32 clFreqs[DEFLATE_NUM_CL_CODES] = ZEROED;
+	for (uxx lIndex = 0; lIndex < numLengths; )
+	{
+		u8 length = lengths[lIndex];
+		uxx runLength = 1;
+		while (lIndex + runLength < numLengths && lengths[lIndex + runLength] == length) { runLength++; }
+		if (length == 0 && runLength >= 3)
+		{
+			uxx repeatCount = MinUXX(runLength, 138);
+			clSymbols[numClSymbols] = (repeatCount >= 11) ? 18 : 17;
+			clExtras[numClSymbols] = (u8)(repeatCount - ((repeatCount >= 11) ? 11 : 3));
+			clFreqs[clSymbols[numClSymbols]]++;
+			numClSymbols++;
+			lIndex += repeatCount;
+		}
+		else if (length != 0 && runLength >= 4)
+		{
+			clSymbols[numClSymbols] = length; clExtras[numClSymbols] = 0; clFreqs[length]++; numClSymbols++;
+			uxx repeatCount = MinUXX(runLength - 1, 6);
+			clSymbols[numClSymbols] = 16; clExtras[numClSymbols] = (u8)(repeatCount - 3); clFreqs[16]++; numClSymbols++;
+			lIndex += 1 + repeatCount;
+		}
+		else
+		{
+			clSymbols[numClSymbols] = length; clExtras[numClSymbols] = 0; clFreqs[length]++; numClSymbols++;
+			lIndex++;
+		}
+	}
+	u8 clLengths[DEFLATE_NUM_CL_CODES];
+	BuildDeflateCodeLengths(clFreqs, DEFLATE_NUM_CL_CODES, DEFLATE_MAX_CL_LENGTH, clLengths);
+	uxx numClCodes = DEFLATE_NUM_CL_CODES;
+	while (numClCodes > 4 && clLengths[DeflateClOrder[numClCodes-1]] == 0) { numClCodes--; }
+	
+	DeflateHuffmanCode litLenCodes[DEFLATE_NUM_LITLEN_CODES];
+	DeflateHuffmanCode distCodes[DEFLATE_NUM_DIST_CODES];
+	DeflateHuffmanCode clCodes[DEFLATE_NUM_CL_CODES];
+	BuildDeflateCodes(litLenLengths, DEFLATE_NUM_LITLEN_CODES, litLenCodes);
+	BuildDeflateCodes(distLengths, DEFLATE_NUM_DIST_CODES, distCodes);
+	BuildDeflateCodes(clLengths, DEFLATE_NUM_CL_CODES, clCodes);
+	
+	DeflateWriteBits(writer, isFinal ? 1 : 0, 1);
+	DeflateWriteBits(writer, 2, 2); //BTYPE=10 dynamic Huffman
+	DeflateWriteBits(writer, (u32)(numLitLenCodes - 257), 5);
+	DeflateWriteBits(writer, (u32)(numDistCodes - 1), 5);
+	DeflateWriteBits(writer, (u32)(numClCodes - 4), 4);
+	for (uxx cIndex = 0; cIndex < numClCodes; cIndex++) { DeflateWriteBits(writer, clLengths[DeflateClOrder[cIndex]], 3); }
+	for (uxx sIndex = 0; sIndex < numClSymbols; sIndex++)
+	{
+		u8 symbol = clSymbols[sIndex];
+		DeflateWriteBits(writer, clCodes[symbol].code, clCodes[symbol].length);
+		if (symbol == 16) { DeflateWriteBits(writer, clExtras[sIndex], 2); }
+		else if (symbol == 17) { DeflateWriteBits(writer, clExtras[sIndex], 3); }
+		else if (symbol == 18) { DeflateWriteBits(writer, clExtras[sIndex], 7); }
+	}
+	
+	for (uxx tIndex = 0; tIndex < numTokens && !writer->isOverflow; tIndex++)
+	{
+		u32 token = tokens[tIndex];
+		if ((token & DEFLATE_MATCH_FLAG) == 0) { DeflateWriteBits(writer, litLenCodes[token].code, litLenCodes[token].length); continue; }
+		uxx matchLength = ((token >> 16) & 0xFF) + DEFLATE_MIN_MATCH;
+		uxx distance = (token & 0xFFFF) + 1;
+		uxx lengthCode = GetDeflateLengthCode(matchLength);
+		DeflateWriteBits(writer, litLenCodes[257 + lengthCode].code, litLenCodes[257 + lengthCode].length);
+		if (DeflateLengthExtraBits[lengthCode] > 0) { DeflateWriteBits(writer, (u32)(matchLength - DeflateLengthBases[lengthCode]), DeflateLengthExtraBits[lengthCode]); }
+		uxx distCode = GetDeflateDistCode(distance);
+		DeflateWriteBits(writer, distCodes[distCode].code, distCodes[distCode].length);
+		if (DeflateDistExtraBits[distCode] > 0) { DeflateWriteBits(writer, (u32)(distance - DeflateDistBases[distCode]), DeflateDistExtraBits[distCode]); }
+	}
+	DeflateWriteBits(writer, litLenCodes[256].code, litLenCodes[256].length);
+}
+
+u32 CalcAdler32(Slice data)
+{
+	u32 sumA = 1;
+	u32 sumB = 0;
+	uxx bIndex = 0;
+	while (bIndex < data.length)
+	{
+		//NOTE: 5552 is the most bytes we can add up before sumB could overflow a u32
+		uxx runEnd = MinUXX(data.length, bIndex + 5552);
+		for (; bIndex < runEnd; bIndex++) { sumA += data.bytes[bIndex]; sumB += sumA; }
+		sumA %= 65521;
+		sumB %= 65521;
+	}
+	return (sumB << 16) | sumA;
+}
+
+PBF_COMPRESS_DEF(PbfCompressRaw)
+{
+	UNUSED(arena);
+	return rawData;
+}
+
+PBF_COMPRESS_DEF(PbfCompressZlib)
+{
+	TracyCZoneN(Zone_Func, "ZlibCompress", true);
+	TracyCZoneValue(Zone_Func, rawData.length);
+	//NOTE: Stored blocks are the worst case, if the Huffman coded stream doesn't fit in that much space we write stored blocks instead
+	uxx numStoredBlocks = (rawData.length + DEFLATE_MAX_STORED_SIZE - 1) / DEFLATE_MAX_STORED_SIZE;
+	uxx maxLength = 2 + (MaxUXX(numStoredBlocks, 1) * 5) + rawData.length + 4;
+	u8* resultBytes = AllocArray(u8, arena, maxLength);
+	NotNull(resultBytes);
+	uxx scratchMark = ArenaGetMark(arena);
+	
+	DeflateBitWriter writer = ZEROED;
+	writer.bytes = resultBytes;
+	writer.length = maxLength - 4; //room for the adler32
+	DeflateWriteBits(&writer, 0x78, 8); //CM=8 (deflate), CINFO=7 (32K window)
+	DeflateWriteBits(&writer, 0x01, 8); //FLEVEL=0, FCHECK makes 0x7801 a multiple of 31
+	
+	u32* hashHeads = AllocArray(u32, arena, DEFLATE_HASH_SIZE);
+	u32* hashPrevs = AllocArray(u32, arena, DEFLATE_WINDOW_SIZE);
+	u32* tokens = AllocArray(u32, arena, DEFLATE_BLOCK_TOKENS);
+	NotNull(hashHeads);
+	NotNull(hashPrevs);
+	NotNull(tokens);
+	MyMemSet(hashHeads, 0x00, sizeof(u32) * DEFLATE_HASH_SIZE); //0 means empty, positions are stored +1
+	
+	const u8* bytes = rawData.bytes;
+	uxx numTokens = 0;
+	uxx pos = 0;
+	while (pos < rawData.length && !writer.isOverflow)
+	{
+		uxx bestLength = 0;
+		uxx bestDistance = 0;
+		if (pos + DEFLATE_MIN_MATCH <= rawData.length)
+		{
+			u32 hash = (((u32)bytes[pos] << 16) ^ ((u32)bytes[pos+1] << 8) ^ (u32)bytes[pos+2]) * 2654435761U;
+			hash >>= (32 - 15); //DEFLATE_HASH_SIZE is 1 << 15
+			uxx maxMatch = MinUXX(DEFLATE_MAX_MATCH, rawData.length - pos);
+			u32 candidate = hashHeads[hash];
+			for (uxx chainIndex = 0; candidate != 0 && chainIndex < DEFLATE_MAX_CHAIN; chainIndex++)
+			{
+				uxx candidatePos = (uxx)candidate - 1;
+				if (pos - candidatePos > DEFLATE_WINDOW_SIZE) { break; }
+				uxx matchLength = 0;
+				while (matchLength < maxMatch && bytes[candidatePos + matchLength] == bytes[pos + matchLength]) { matchLength++; }
+				if (matchLength > bestLength) { bestLength = matchLength; bestDistance = pos - candidatePos; }
+				if (bestLength >= DEFLATE_NICE_LENGTH) { break; }
+				u32 prevCandidate = hashPrevs[candidatePos % DEFLATE_WINDOW_SIZE];
+				if (prevCandidate >= candidate) { break; } //that slot was reused by a newer position
+				candidate = prevCandidate;
+			}
+			hashPrevs[pos % DEFLATE_WINDOW_SIZE] = hashHeads[hash];
+			hashHeads[hash] = (u32)(pos + 1);
+		}
+		
+		if (bestLength >= DEFLATE_MIN_MATCH)
+		{
+			tokens[numTokens++] = DEFLATE_MATCH_FLAG | ((u32)(bestLength - DEFLATE_MIN_MATCH) << 16) | (u32)(bestDistance - 1);
+			//Insert the rest of the matched positions into the hash chains so later matches can find them
+			for (uxx mIndex = 1; mIndex < bestLength && pos + mIndex + DEFLATE_MIN_MATCH <= rawData.length; mIndex++)
+			{
+				uxx insertPos = pos + mIndex;
+				u32 insertHash = ((((u32)bytes[insertPos] << 16) ^ ((u32)bytes[insertPos+1] << 8) ^ (u32)bytes[insertPos+2]) * 2654435761U) >> (32 - 15);
+				hashPrevs[insertPos % DEFLATE_WINDOW_SIZE] = hashHeads[insertHash];
+				hashHeads[insertHash] = (u32)(insertPos + 1);
+			}
+			pos += bestLength;
+		}
+		else { tokens[numTokens++] = bytes[pos]; pos++; }
+		
+		if (numTokens == DEFLATE_BLOCK_TOKENS || pos == rawData.length)
+		{
+			WriteDeflateDynamicBlock(&writer, tokens, numTokens, (pos == rawData.length));
+			numTokens = 0;
+		}
+	}
+	if (rawData.length == 0) { WriteDeflateDynamicBlock(&writer, tokens, 0, true); }
+	DeflateFlushBits(&writer);
+	ArenaResetToMark(arena, scratchMark);
+	
+	if (writer.isOverflow)
+	{
+		//The data didn't compress, store it as is
+		writer.offset = 2;
+		writer.isOverflow = false;
+		for (uxx bIndex = 0; bIndex < MaxUXX(numStoredBlocks, 1); bIndex++)
+		{
+			uxx blockStart = bIndex * DEFLATE_MAX_STORED_SIZE;
+			uxx blockLength = MinUXX(DEFLATE_MAX_STORED_SIZE, rawData.length - blockStart);
+			resultBytes[writer.offset++] = (bIndex+1 >= numStoredBlocks) ? 1 : 0; //BFINAL and BTYPE=00 (stored)
+			resultBytes[writer.offset++] = (u8)(blockLength & 0xFF);
+			resultBytes[writer.offset++] = (u8)(blockLength >> 8);
+			resultBytes[writer.offset++] = (u8)(~blockLength & 0xFF);
+			resultBytes[writer.offset++] = (u8)((~blockLength >> 8) & 0xFF);
+			if (blockLength > 0) { MyMemCopy(&resultBytes[writer.offset], &bytes[blockStart], blockLength); }
+			writer.offset += blockLength;
+		}
+	}
+	
+	u32 adler = CalcAdler32(rawData);
+	resultBytes[writer.offset++] = (u8)(adler >> 24);
+	resultBytes[writer.offset++] = (u8)(adler >> 16);
+	resultBytes[writer.offset++] = (u8)(adler >> 8);
+	resultBytes[writer.offset++] = (u8)(adler >> 0);
+	TracyCZoneEnd(Zone_Func);
+	return MakeSlice(writer.offset, resultBytes);
+}
+
+// +--------------------------------------------------------------+
+// |                         Codec Table                          |
+// +--------------------------------------------------------------+
+// Indexed by PbfCodec
+const PbfCodecInfo PbfCodecTable[PbfCodec_Count] = {
+	{ PbfCodec_None,  nullptr,           nullptr,         "None MB/s"  },
+	{ PbfCodec_Raw,   PbfDecompressRaw,  PbfCompressRaw,  "RAW MB/s"   },
+	{ PbfCodec_Zlib,  PbfDecompressZlib, PbfCompressZlib, "ZLIB MB/s"  },
+	{ PbfCodec_Lzma,  PbfDecompressLzma, nullptr,         "LZMA MB/s"  },
+	{ PbfCodec_Bzip2, nullptr,           nullptr,         "BZIP2 MB/s" },
+	{ PbfCodec_Lz4,   PbfDecompressLz4,  nullptr,         "LZ4 MB/s"   },
+	{ PbfCodec_Zstd,  PbfDecompressZstd, nullptr,         "ZSTD MB/s"  },
+};
+
+const PbfCodecInfo* GetPbfCodecInfo(PbfCodec codec)
+{
+	Assert(codec < PbfCodec_Count);
+	const PbfCodecInfo* result = &PbfCodecTable[codec];
+	Assert(result->codec == codec);
+	return result;
+}
@@ -0,0 +1,160 @@
+/*
+File:   pbf_codecs.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _PBF_CODECS_H
+#define _PBF_CODECS_H
+
+#define LZMA_ALONE_HEADER_SIZE   13 //1 byte properties, 4 byte dictionary size, 8 byte uncompressed size
+#define LZMA_MAX_LITERAL_BITS    12 //lc+lp, the literal probabilities take 0x300 << (lc+lp) u16s
+#define LZMA_NUM_STATES          12
+#define LZMA_NUM_POS_BITS_MAX    4
+#define LZMA_NUM_LEN_TO_POS      4
+#define LZMA_NUM_ALIGN_BITS      4
+#define LZMA_START_POS_MODEL     4
+#define LZMA_END_POS_MODEL       14
+#define LZMA_NUM_FULL_DISTANCES  (1 << (LZMA_END_POS_MODEL >> 1))
+#define LZMA_MATCH_MIN_LENGTH    2
+#define LZMA_PROB_INIT           (LZMA_BIT_MODEL_TOTAL / 2)
+#define LZMA_BIT_MODEL_TOTAL     (1 << 11)
+#define LZMA_NUM_MOVE_BITS       5
+#define LZMA_RANGE_TOP           (1 << 24)
+
+#define DEFLATE_WINDOW_SIZE      32768 //bytes, the furthest back a match can reach
+#define DEFLATE_HASH_SIZE        32768 //entries in the head table of the 3 byte hash chains
+#define DEFLATE_MAX_CHAIN        32 //how many earlier positions we check for each match, higher is smaller output but slower
+#define DEFLATE_NICE_LENGTH      128 //stop searching once we find a match this long
+#define DEFLATE_MIN_MATCH        3
+#define DEFLATE_MAX_MATCH        258
+#define DEFLATE_BLOCK_TOKENS     65536 //tokens per dynamic Huffman block
+#define DEFLATE_NUM_LITLEN_CODES 286
+#define DEFLATE_NUM_DIST_CODES   30
+#define DEFLATE_NUM_CL_CODES     19
+#define DEFLATE_MAX_CODE_LENGTH  15
+#define DEFLATE_MAX_CL_LENGTH    7
+#define DEFLATE_MAX_STORED_SIZE  65535 //bytes per stored (uncompressed) block
+#define DEFLATE_MATCH_FLAG       0x80000000 //tokens are either a literal byte or DEFLATE_MATCH_FLAG | (length-3) << 16 | (distance-1)
+
+// One for each of the "oneof data" variants in Blob (see osm_pbf.proto)
+typedef enum PbfCodec PbfCodec;
+enum PbfCodec
+{
+	PbfCodec_None = 0, //the Blob had no data
+	PbfCodec_Raw,
+	PbfCodec_Zlib,
+	PbfCodec_Lzma,
+	PbfCodec_Bzip2, //"OBSOLETE_bzip2_data", nothing has written this in a long time
+	PbfCodec_Lz4,
+	PbfCodec_Zstd,
+	PbfCodec_Count,
+};
+const char* GetPbfCodecStr(PbfCodec enumValue)
+{
+	switch (enumValue)
+	{
+		case PbfCodec_None:  return "None";
+		case PbfCodec_Raw:   return "RAW";
+		case PbfCodec_Zlib:  return "ZLIB";
+		case PbfCodec_Lzma:  return "LZMA";
+		case PbfCodec_Bzip2: return "OBSOLETE_BZIP2";
+		case PbfCodec_Lz4:   return "LZ4";
+		case PbfCodec_Zstd:  return "ZSTD";
+		default: return UNKNOWN_STR;
+	}
+}
+
+// Returns a Slice of exactly rawSize bytes, or a Slice with nullptr bytes if the data is corrupt (or doesn't decompress to rawSize bytes).
+// The result may point at compressedData (Raw) so it's only valid as long as compressedData is
+#define PBF_DECOMPRESS_DEF(functionName) Slice functionName(Arena* arena, Slice compressedData, uxx rawSize)
+typedef PBF_DECOMPRESS_DEF(PbfDecompress_f);
+
+// Used by SerializePbfMap. The result may point at rawData (Raw)
+#define PBF_COMPRESS_DEF(functionName) Slice functionName(Arena* arena, Slice rawData)
+typedef PBF_COMPRESS_DEF(PbfCompress_f);
+
+typedef plex PbfCodecInfo PbfCodecInfo;
+plex PbfCodecInfo
+{
+	PbfCodec codec;
+	PbfDecompress_f* Decompress; //nullptr means we don't support this codec
+	PbfCompress_f* Compress; //nullptr means we can't write this codec
+	const char* plotName; //Tracy plot that shows the decompression throughput (MB/s of output) for this codec
+};
+
+// Accumulated by the Merge stage so there's no need for any synchronization
+typedef plex PbfCodecStats PbfCodecStats;
+plex PbfCodecStats
+{
+	uxx numBlobs;
+	uxx numCompressedBytes;
+	uxx numRawBytes;
+	r64 decompressMs; //summed over all threads, so this can be more than the wall clock time of the load
+};
+
+// Writes the deflate bit stream, least significant bit first. When the output doesn't fit isOverflow is set and nothing else is written
+typedef plex DeflateBitWriter DeflateBitWriter;
+plex DeflateBitWriter
+{
+	u8* bytes;
+	uxx length;
+	uxx offset;
+	u64 bitBuffer;
+	u8 numBits;
+	bool isOverflow;
+};
+
+typedef plex DeflateHuffmanCode DeflateHuffmanCode;
+plex DeflateHuffmanCode
+{
+	u16 code; //already bit-reversed so it can be written least significant bit first
+	u8 length;
+};
+
+typedef plex LzmaRangeDecoder LzmaRangeDecoder;
+plex LzmaRangeDecoder
+{
+	const u8* bytes;
+	uxx length;
+	uxx offset;
+	u32 range;
+	u32 code;
+	bool isError; //ran out of bytes or the data is corrupt
+};
+
+typedef plex LzmaLenDecoder LzmaLenDecoder;
+plex LzmaLenDecoder
+{
+	u16 choice;
+	u16 choice2;
+	u16 low[1 << LZMA_NUM_POS_BITS_MAX][1 << 3];
+	u16 mid[1 << LZMA_NUM_POS_BITS_MAX][1 << 3];
+	u16 high[1 << 8];
+};
+
+// Every adaptive probability except the literal ones (which depend on lc and lp). Nothing but u16s so it can be initialized as one array
+typedef plex LzmaProbs LzmaProbs;
+plex LzmaProbs
+{
+	u16 isMatch[LZMA_NUM_STATES << LZMA_NUM_POS_BITS_MAX];
+	u16 isRep[LZMA_NUM_STATES];
+	u16 isRepG0[LZMA_NUM_STATES];
+	u16 isRepG1[LZMA_NUM_STATES];
+	u16 isRepG2[LZMA_NUM_STATES];
+	u16 isRep0Long[LZMA_NUM_STATES << LZMA_NUM_POS_BITS_MAX];
+	u16 posSlot[LZMA_NUM_LEN_TO_POS][1 << 6];
+	u16 posDecoders[1 + LZMA_NUM_FULL_DISTANCES - LZMA_END_POS_MODEL];
+	u16 align[1 << LZMA_NUM_ALIGN_BITS];
+	LzmaLenDecoder lenDecoder;
+	LzmaLenDecoder repLenDecoder;
+};
+
+typedef plex LzmaDecoder LzmaDecoder;
+plex LzmaDecoder
+{
+	LzmaRangeDecoder rangeDecoder;
+	LzmaProbs probs;
+};
+
+#endif //  _PBF_CODECS_H
@@ -0,0 +1,311 @@
+/*
+File:   pbf_delta_kernels.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the kernels that turn the packed columns of a DenseNodes message (id, lat, lon, and the DenseInfo columns)
+	** into absolute values. Each column is decoded in two passes: first all the varints are decoded into the output
+	** array, then the zigzag encoding is undone and the deltas are prefix summed in place. The second pass
+	** also finds the min\max value and the smallest delta so the caller can validate the whole column with a couple of
+	** comparisons instead of branching on every node. There is a scalar version of every kernel plus SSE4.2 and AVX2
+	** versions on x64 which are picked at runtime based on what the CPU supports.
+*/
+
+// +--------------------------------------------------------------+
+// |                      Feature Detection                       |
+// +--------------------------------------------------------------+
+PbfKernelLevel GetPbfKernelLevelSupported()
+{
+	#if !PBF_KERNELS_HAVE_X64
+	return PbfKernelLevel_Scalar;
+	#else
+	
+	#if COMPILER_IS_MSVC
+	int cpuInfo[4] = ZEROED;
+	__cpuid(cpuInfo, 0);
+	int maxLeaf = cpuInfo[0];
+	__cpuid(cpuInfo, 1);
+	bool hasSse42 = ((cpuInfo[2] & (1 << 20)) != 0);
+	bool hasOsXsave = ((cpuInfo[2] & (1 << 27)) != 0);
+	bool hasAvx = ((cpuInfo[2] & (1 << 28)) != 0);
+	bool hasAvx2 = false;
+	//NOTE: The OS has to be saving the upper halves of the ymm registers on context switches, which is what the xgetbv check is for
+	if (maxLeaf >= 7 && hasOsXsave && hasAvx && (_xgetbv(0) & 0x06) == 0x06)
+	{
+		__cpuidex(cpuInfo, 7, 0);
+		hasAvx2 = ((cpuInfo[1] & (1 << 5)) != 0);
+	}
+	#else
+	__builtin_cpu_init();
+	bool hasSse42 = (__builtin_cpu_supports("sse4.2") != 0);
+	bool hasAvx2 = (__builtin_cpu_supports("avx2") != 0);
+	#endif
+	
+	if (hasAvx2 && hasSse42) { return PbfKernelLevel_Avx2; }
+	if (hasSse42) { return PbfKernelLevel_Sse42; }
+	return PbfKernelLevel_Scalar;
+	#endif
+}
+
+// Turns Auto into the best supported level and clamps anything higher than what the CPU supports
+PbfKernelLevel ResolvePbfKernelLevel(PbfKernelLevel requestedLevel)
+{
+	PbfKernelLevel supportedLevel = GetPbfKernelLevelSupported();
+	if (requestedLevel == PbfKernelLevel_Auto || requestedLevel > supportedLevel) { return supportedLevel; }
+	return requestedLevel;
+}
+
+// +--------------------------------------------------------------+
+// |                        Scalar Kernels                        |
+// +--------------------------------------------------------------+
+// Decodes count varints starting at *offsetPntr. Returns false if the bytes run out or a varint is longer than 10 bytes
+bool DecodePbfVarintsScalar(const u8* bytes, uxx length, uxx* offsetPntr, uxx count, u64* valuesOut)
+{
+	uxx offset = *offsetPntr;
+	for (uxx vIndex = 0; vIndex < count; vIndex++)
+	{
+		u64 value = 0;
+		u8 shift = 0;
+		while (true)
+		{
+			if (offset >= length || shift >= 64) { return false; }
+			u8 nextByte = bytes[offset];
+			offset++;
+			value |= ((u64)(nextByte & 0x7F) << shift);
+			if ((nextByte & 0x80) == 0) { break; }
+			shift += 7;
+		}
+		valuesOut[vIndex] = value;
+	}
+	*offsetPntr = offset;
+	return true;
+}
+
+// Undoes the encoding on values[startIndex, endIndex) and prefix sums them in place. The running sum and statsPntr carry
+// over between calls so the SIMD kernels can use this for the values before and after the part they handle
+void DecodePbfDeltasScalarRange(u64* values, uxx startIndex, uxx endIndex, u64* sumPntr, PbfDeltaColumnStats* statsPntr)
+{
+	u64 sum = *sumPntr;
+	for (uxx vIndex = startIndex; vIndex < endIndex; vIndex++)
+	{
+		i64 delta = PbfZigZagDecode(values[vIndex]);
+		if (vIndex > 0 && delta < statsPntr->minDelta) { statsPntr->minDelta = delta; }
+		//NOTE: We sum as unsigned so overflow wraps around instead of being undefined behavior, the validation catches it after the fact
+		sum += (u64)delta;
+		i64 value = (i64)sum;
+		values[vIndex] = (u64)value;
+		if (value < statsPntr->minValue) { statsPntr->minValue = value; }
+		if (value > statsPntr->maxValue) { statsPntr->maxValue = value; }
+	}
+	*sumPntr = sum;
+}
+
+// +--------------------------------------------------------------+
+// |                         SIMD Kernels                         |
+// +--------------------------------------------------------------+
+#if PBF_KERNELS_HAVE_X64
+
+u32 PbfCountTrailingZerosU32(u32 value)
+{
+	#if COMPILER_IS_MSVC
+	unsigned long result = 0;
+	_BitScanForward(&result, value);
+	return (u32)result;
+	#else
+	return (u32)__builtin_ctz(value);
+	#endif
+}
+
+// Looks at 16 bytes at a time. If none of them have the continuation bit set we widen all 16 straight into the output,
+// otherwise the movemask tells us where every varint that ends in those 16 bytes is so we don't have to check each byte
+PBF_TARGET_SSE42 bool DecodePbfVarintsSse42(const u8* bytes, uxx length, uxx count, u64* valuesOut)
+{
+	uxx offset = 0;
+	uxx vIndex = 0;
+	while (count - vIndex >= 16 && length - offset >= 16)
+	{
+		__m128i chunk = _mm_loadu_si128((const __m128i*)&bytes[offset]);
+		u32 continueMask = (u32)_mm_movemask_epi8(chunk);
+		if (continueMask == 0)
+		{
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex +  0], _mm_cvtepu8_epi64(chunk));
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex +  2], _mm_cvtepu8_epi64(_mm_srli_si128(chunk, 2)));
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex +  4], _mm_cvtepu8_epi64(_mm_srli_si128(chunk, 4)));
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex +  6], _mm_cvtepu8_epi64(_mm_srli_si128(chunk, 6)));
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex +  8], _mm_cvtepu8_epi64(_mm_srli_si128(chunk, 8)));
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex + 10], _mm_cvtepu8_epi64(_mm_srli_si128(chunk, 10)));
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex + 12], _mm_cvtepu8_epi64(_mm_srli_si128(chunk, 12)));
+			_mm_storeu_si128((__m128i*)&valuesOut[vIndex + 14], _mm_cvtepu8_epi64(_mm_srli_si128(chunk, 14)));
+			vIndex += 16;
+			offset += 16;
+		}
+		else
+		{
+			u32 endMask = (~continueMask & 0xFFFF);
+			if (endMask == 0) { return false; } //a varint can't be longer than 10 bytes
+			uxx chunkOffset = offset;
+			while (endMask != 0)
+			{
+				uxx endIndex = (uxx)PbfCountTrailingZerosU32(endMask);
+				uxx varintLength = (chunkOffset + endIndex + 1) - offset;
+				if (varintLength > PBF_MAX_VARINT_LENGTH) { return false; }
+				u64 value = 0;
+				for (uxx bIndex = 0; bIndex < varintLength; bIndex++) { value |= ((u64)(bytes[offset + bIndex] & 0x7F) << (7 * bIndex)); }
+				valuesOut[vIndex] = value;
+				vIndex++;
+				offset += varintLength;
+				endMask &= (endMask - 1);
+			}
+			//NOTE: Any bytes after the last end are the start of a varint that crosses into the next chunk, so they are decoded next loop
+		}
+	}
+	return DecodePbfVarintsScalar(bytes, length, &offset, count - vIndex, &valuesOut[vIndex]);
+}
+
+PBF_TARGET_SSE42 void DecodePbfDeltasSse42(u64* values, uxx count, PbfDeltaColumnStats* statsPntr)
+{
+	u64 sum = 0;
+	DecodePbfDeltasScalarRange(values, 0, MinUXX(count, 1), &sum, statsPntr);
+	
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi64x(1);
+	__m128i carry = _mm_set1_epi64x((i64)sum);
+	__m128i minValues = _mm_set1_epi64x(statsPntr->minValue);
+	__m128i maxValues = _mm_set1_epi64x(statsPntr->maxValue);
+	__m128i minDeltas = _mm_set1_epi64x(statsPntr->minDelta);
+	uxx vIndex = 1;
+	for (; vIndex + 2 <= count; vIndex += 2)
+	{
+		__m128i rawValues = _mm_loadu_si128((const __m128i*)&values[vIndex]);
+		__m128i deltas = _mm_xor_si128(_mm_srli_epi64(rawValues, 1), _mm_sub_epi64(zero, _mm_and_si128(rawValues, one)));
+		minDeltas = _mm_blendv_epi8(minDeltas, deltas, _mm_cmpgt_epi64(minDeltas, deltas));
+		
+		__m128i sums = _mm_add_epi64(deltas, _mm_slli_si128(deltas, 8));
+		sums = _mm_add_epi64(sums, carry);
+		_mm_storeu_si128((__m128i*)&values[vIndex], sums);
+		carry = _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 2, 3, 2));
+		minValues = _mm_blendv_epi8(minValues, sums, _mm_cmpgt_epi64(minValues, sums));
+		maxValues = _mm_blendv_epi8(maxValues, sums, _mm_cmpgt_epi64(sums, maxValues));
+	}
+	
+	i64 laneValues[2];
+	_mm_storeu_si128((__m128i*)&laneValues[0], minValues);
+	statsPntr->minValue = MinI64(laneValues[0], laneValues[1]);
+	_mm_storeu_si128((__m128i*)&laneValues[0], maxValues);
+	statsPntr->maxValue = MaxI64(laneValues[0], laneValues[1]);
+	_mm_storeu_si128((__m128i*)&laneValues[0], minDeltas);
+	statsPntr->minDelta = MinI64(laneValues[0], laneValues[1]);
+	sum = (u64)_mm_cvtsi128_si64(carry);
+	
+	DecodePbfDeltasScalarRange(values, vIndex, count, &sum, statsPntr);
+}
+
+PBF_TARGET_AVX2 void DecodePbfDeltasAvx2(u64* values, uxx count, PbfDeltaColumnStats* statsPntr)
+{
+	u64 sum = 0;
+	DecodePbfDeltasScalarRange(values, 0, MinUXX(count, 1), &sum, statsPntr);
+	
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi64x(1);
+	__m256i carry = _mm256_set1_epi64x((i64)sum);
+	__m256i minValues = _mm256_set1_epi64x(statsPntr->minValue);
+	__m256i maxValues = _mm256_set1_epi64x(statsPntr->maxValue);
+	__m256i minDeltas = _mm256_set1_epi64x(statsPntr->minDelta);
+	uxx vIndex = 1;
+	for (; vIndex + 4 <= count; vIndex += 4)
+	{
+		__m256i rawValues = _mm256_loadu_si256((const __m256i*)&values[vIndex]);
+		__m256i deltas = _mm256_xor_si256(_mm256_srli_epi64(rawValues, 1), _mm256_sub_epi64(zero, _mm256_and_si256(rawValues, one)));
+		minDeltas = _mm256_blendv_epi8(minDeltas, deltas, _mm256_cmpgt_epi64(minDeltas, deltas));
+		
+		// [d0, d1, d2, d3] -> [d0, d0+d1, d1+d2, d2+d3] -> [d0, d0+d1, d0+d1+d2, d0+d1+d2+d3]
+		__m256i sums = _mm256_add_epi64(deltas, _mm256_blend_epi32(_mm256_permute4x64_epi64(deltas, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+		sums = _mm256_add_epi64(sums, _mm256_blend_epi32(_mm256_permute4x64_epi64(sums, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+		sums = _mm256_add_epi64(sums, carry);
+		_mm256_storeu_si256((__m256i*)&values[vIndex], sums);
+		carry = _mm256_permute4x64_epi64(sums, _MM_SHUFFLE(3, 3, 3, 3));
+		minValues = _mm256_blendv_epi8(minValues, sums, _mm256_cmpgt_epi64(minValues, sums));
+		maxValues = _mm256_blendv_epi8(maxValues, sums, _mm256_cmpgt_epi64(sums, maxValues));
+	}
+	
+	i64 laneValues[4];
+	_mm256_storeu_si256((__m256i*)&laneValues[0], minValues);
+	statsPntr->minValue = MinI64(MinI64(laneValues[0], laneValues[1]), MinI64(laneValues[2], laneValues[3]));
+	_mm256_storeu_si256((__m256i*)&laneValues[0], maxValues);
+	statsPntr->maxValue = MaxI64(MaxI64(laneValues[0], laneValues[1]), MaxI64(laneValues[2], laneValues[3]));
+	_mm256_storeu_si256((__m256i*)&laneValues[0], minDeltas);
+	statsPntr->minDelta = MinI64(MinI64(laneValues[0], laneValues[1]), MinI64(laneValues[2], laneValues[3]));
+	sum = (u64)_mm256_extract_epi64(carry, 0);
+	
+	DecodePbfDeltasScalarRange(values, vIndex, count, &sum, statsPntr);
+}
+
+#endif //PBF_KERNELS_HAVE_X64
+
+// +--------------------------------------------------------------+
+// |                         Entry Point                          |
+// +--------------------------------------------------------------+
+// Decodes a packed column of count delta encoded values into valuesOut (which must have room for count values).
+// level must already be resolved (see ResolvePbfKernelLevel). Returns false if the varints are malformed.
+// When count is 0 statsOut->minValue is INT64_MAX and statsOut->maxValue is INT64_MIN
+bool DecodePbfDeltaColumn(PbfKernelLevel level, Slice packedSlice, uxx count, i64* valuesOut, PbfDeltaColumnStats* statsOut)
+{
+	Assert(level != PbfKernelLevel_Auto);
+	NotNull(statsOut);
+	statsOut->minValue = INT64_MAX;
+	statsOut->maxValue = INT64_MIN;
+	statsOut->minDelta = INT64_MAX;
+	if (count == 0) { return true; }
+	NotNull(valuesOut);
+	u64* rawValues = (u64*)valuesOut;
+	
+	#if PBF_KERNELS_HAVE_X64
+	if (level == PbfKernelLevel_Sse42 || level == PbfKernelLevel_Avx2)
+	{
+		if (!DecodePbfVarintsSse42(packedSlice.bytes, packedSlice.length, count, rawValues)) { return false; }
+		if (level == PbfKernelLevel_Avx2) { DecodePbfDeltasAvx2(rawValues, count, statsOut); }
+		else { DecodePbfDeltasSse42(rawValues, count, statsOut); }
+		return true;
+	}
+	#endif
+	
+	uxx offset = 0;
+	if (!DecodePbfVarintsScalar(packedSlice.bytes, packedSlice.length, &offset, count, rawValues)) { return false; }
+	u64 sum = 0;
+	DecodePbfDeltasScalarRange(rawValues, 0, count, &sum, statsOut);
+	return true;
+}
+
+// For the packed int32 columns that aren't delta encoded (DenseInfo version). The varints go through the same kernels as
+// DecodePbfDeltaColumn but the values are only sign extended from 32 bits. statsOut->minDelta is always INT64_MAX
+bool DecodePbfInt32Column(PbfKernelLevel level, Slice packedSlice, uxx count, i64* valuesOut, PbfDeltaColumnStats* statsOut)
+{
+	Assert(level != PbfKernelLevel_Auto);
+	NotNull(statsOut);
+	statsOut->minValue = INT64_MAX;
+	statsOut->maxValue = INT64_MIN;
+	statsOut->minDelta = INT64_MAX;
+	if (count == 0) { return true; }
+	NotNull(valuesOut);
+	u64* rawValues = (u64*)valuesOut;
+	
+	bool decodedVarints = false;
+	#if PBF_KERNELS_HAVE_X64
+	if (level == PbfKernelLevel_Sse42 || level == PbfKernelLevel_Avx2) { decodedVarints = DecodePbfVarintsSse42(packedSlice.bytes, packedSlice.length, count, rawValues); }
+	else
+	#endif
+	{
+		uxx offset = 0;
+		decodedVarints = DecodePbfVarintsScalar(packedSlice.bytes, packedSlice.length, &offset, count, rawValues);
+	}
+	if (!decodedVarints) { return false; }
+	
+	for (uxx vIndex = 0; vIndex < count; vIndex++)
+	{
+		i64 value = (i64)(i32)(u32)rawValues[vIndex];
+		valuesOut[vIndex] = value;
+		if (value < statsOut->minValue) { statsOut->minValue = value; }
+		if (value > statsOut->maxValue) { statsOut->maxValue = value; }
+	}
+	return true;
+}
@@ -0,0 +1,63 @@
+/*
+File:   pbf_delta_kernels.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _PBF_DELTA_KERNELS_H
+#define _PBF_DELTA_KERNELS_H
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PBF_KERNELS_HAVE_X64 1
+#else
+#define PBF_KERNELS_HAVE_X64 0
+#endif
+
+#if PBF_KERNELS_HAVE_X64
+#include <immintrin.h>
+#if COMPILER_IS_MSVC
+#include <intrin.h>
+#endif
+#endif
+
+//NOTE: We don't pass -mavx2 (or /arch:AVX2) to the compiler so the SIMD kernels are marked individually and only get called
+//      when GetPbfKernelLevelSupported says the CPU (and OS) can run them. MSVC lets you use any intrinsic without a flag
+#if PBF_KERNELS_HAVE_X64 && !COMPILER_IS_MSVC
+#define PBF_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define PBF_TARGET_AVX2  __attribute__((target("avx2")))
+#else
+#define PBF_TARGET_SSE42 //nothing
+#define PBF_TARGET_AVX2  //nothing
+#endif
+
+typedef enum PbfKernelLevel PbfKernelLevel;
+enum PbfKernelLevel
+{
+	PbfKernelLevel_Auto = 0, //picks the best level that GetPbfKernelLevelSupported returns
+	PbfKernelLevel_Scalar,
+	PbfKernelLevel_Sse42,
+	PbfKernelLevel_Avx2,
+	PbfKernelLevel_Count,
+};
+const char* GetPbfKernelLevelStr(PbfKernelLevel enumValue)
+{
+	switch (enumValue)
+	{
+		case PbfKernelLevel_Auto:   return "Auto";
+		case PbfKernelLevel_Scalar: return "Scalar";
+		case PbfKernelLevel_Sse42:  return "SSE4.2";
+		case PbfKernelLevel_Avx2:   return "AVX2";
+		default: return UNKNOWN_STR;
+	}
+}
+
+// Filled by DecodePbfDeltaColumn (and DecodePbfInt32Column) so the caller can validate a whole column at once and only look at individual values when something is wrong
+typedef plex PbfDeltaColumnStats PbfDeltaColumnStats;
+plex PbfDeltaColumnStats
+{
+	i64 minValue;
+	i64 maxValue;
+	i64 minDelta; //ignores the first value (which is relative to 0), INT64_MAX if the column has less than 2 values
+};
+
+#endif //  _PBF_DELTA_KERNELS_H
@@ -0,0 +1,216 @@
+/*
+File:   pbf_wire_format.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds a handful of functions that read the protobuf wire format directly out of a buffer.
+	** These are used by the direct PrimitiveBlock decoder in osm_map_serialization_pbf.c which
+	** skips all the intermediate structures that the generated osm_pbf.pb-c.c code allocates.
+	** The PbfWireWriter functions at the bottom go the other way for SerializePbfMap
+*/
+
+PbfWireReader MakePbfWireReader(Slice slice)
+{
+	PbfWireReader result = ZEROED;
+	result.bytes = slice.bytes;
+	result.length = slice.length;
+	result.offset = 0;
+	result.isError = false;
+	return result;
+}
+
+bool IsPbfWireReaderFinished(const PbfWireReader* reader)
+{
+	return (reader->isError || reader->offset >= reader->length);
+}
+
+u64 PbfWireReadVarint(PbfWireReader* reader)
+{
+	u64 result = 0;
+	u8 shift = 0;
+	while (reader->offset < reader->length && shift < 64)
+	{
+		u8 nextByte = reader->bytes[reader->offset];
+		reader->offset++;
+		result |= ((u64)(nextByte & 0x7F) << shift);
+		if ((nextByte & 0x80) == 0) { return result; }
+		shift += 7;
+	}
+	reader->isError = true;
+	return 0;
+}
+
+// sint32 and sint64 fields are "zigzag" encoded so that small negative numbers stay small: 0->0, -1->1, 1->2, -2->3, etc.
+i64 PbfZigZagDecode(u64 value)
+{
+	return (i64)((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// Returns false when there are no more fields (or the data was malformed)
+bool PbfWireReadField(PbfWireReader* reader, u32* fieldNumberOut, PbfWireType* wireTypeOut)
+{
+	if (IsPbfWireReaderFinished(reader)) { return false; }
+	u64 fieldKey = PbfWireReadVarint(reader);
+	if (reader->isError) { return false; }
+	if ((fieldKey >> 3) == 0 || (fieldKey >> 3) > UINT32_MAX) { reader->isError = true; return false; }
+	if (fieldNumberOut != nullptr) { *fieldNumberOut = (u32)(fieldKey >> 3); }
+	if (wireTypeOut != nullptr) { *wireTypeOut = (PbfWireType)(fieldKey & 0x07); }
+	return true;
+}
+
+// Returns a slice that points into the reader's buffer, nothing is copied
+Slice PbfWireReadSlice(PbfWireReader* reader)
+{
+	u64 length = PbfWireReadVarint(reader);
+	if (reader->isError) { return Slice_Empty; }
+	if (length > (u64)(reader->length - reader->offset)) { reader->isError = true; return Slice_Empty; }
+	Slice result = MakeSlice((uxx)length, &reader->bytes[reader->offset]);
+	reader->offset += (uxx)length;
+	return result;
+}
+
+void PbfWireSkipField(PbfWireReader* reader, PbfWireType wireType)
+{
+	switch (wireType)
+	{
+		case PbfWireType_Varint: PbfWireReadVarint(reader); break;
+		case PbfWireType_LengthDelimited: PbfWireReadSlice(reader); break;
+		case PbfWireType_Fixed64:
+		{
+			if (reader->length - reader->offset < sizeof(u64)) { reader->isError = true; break; }
+			reader->offset += sizeof(u64);
+		} break;
+		case PbfWireType_Fixed32:
+		{
+			if (reader->length - reader->offset < sizeof(u32)) { reader->isError = true; break; }
+			reader->offset += sizeof(u32);
+		} break;
+		//NOTE: Groups have been deprecated for a long time and the OSM .proto doesn't use them
+		default: reader->isError = true; break;
+	}
+}
+
+// Counts the number of values in a packed repeated varint field by counting the bytes that don't have the continuation bit set.
+// Returns false if the data ends in the middle of a varint or contains a varint that is too long
+bool TryCountPbfPackedVarints(Slice packedSlice, uxx* countOut)
+{
+	uxx count = 0;
+	uxx varintLength = 0;
+	for (uxx bIndex = 0; bIndex < packedSlice.length; bIndex++)
+	{
+		varintLength++;
+		if ((packedSlice.bytes[bIndex] & 0x80) == 0) { count++; varintLength = 0; }
+		else if (varintLength >= PBF_MAX_VARINT_LENGTH) { return false; }
+	}
+	if (varintLength != 0) { return false; }
+	if (countOut != nullptr) { *countOut = count; }
+	return true;
+}
+
+// Grabs the slice for a packed repeated varint field and counts the values in it. Returns false for anything we don't handle,
+// like repeated fields that weren't packed, a second occurrence of the same field, or malformed varints
+bool TryReadPbfPackedField(PbfWireReader* reader, PbfWireType wireType, PbfPackedField* fieldOut)
+{
+	if (wireType != PbfWireType_LengthDelimited || fieldOut->isPresent) { return false; }
+	fieldOut->slice = PbfWireReadSlice(reader);
+	if (reader->isError) { return false; }
+	fieldOut->isPresent = true;
+	return TryCountPbfPackedVarints(fieldOut->slice, &fieldOut->count);
+}
+
+// +--------------------------------------------------------------+
+// |                            Writer                            |
+// +--------------------------------------------------------------+
+void InitPbfWireWriter(Arena* arena, uxx initialSize, PbfWireWriter* writerOut)
+{
+	NotNull(arena);
+	NotNull(writerOut);
+	ClearPointer(writerOut);
+	writerOut->arena = arena;
+	if (initialSize > 0)
+	{
+		writerOut->bytes = AllocArray(u8, arena, initialSize);
+		NotNull(writerOut->bytes);
+		writerOut->allocLength = initialSize;
+	}
+}
+
+// Keeps the allocation so the writer can be reused for the next message
+void ResetPbfWireWriter(PbfWireWriter* writer)
+{
+	writer->length = 0;
+}
+
+Slice GetPbfWireWriterSlice(const PbfWireWriter* writer)
+{
+	return MakeSlice(writer->length, writer->bytes);
+}
+
+u8* PbfWireWriterAlloc(PbfWireWriter* writer, uxx numBytes)
+{
+	if (writer->length + numBytes > writer->allocLength)
+	{
+		uxx newAllocLength = MaxUXX(writer->allocLength * 2, 64);
+		while (newAllocLength < writer->length + numBytes) { newAllocLength *= 2; }
+		u8* newBytes = AllocArray(u8, writer->arena, newAllocLength);
+		NotNull(newBytes);
+		if (writer->length > 0) { MyMemCopy(newBytes, writer->bytes, writer->length); }
+		if (writer->bytes != nullptr) { FreeArray(u8, writer->arena, writer->allocLength, writer->bytes); }
+		writer->bytes = newBytes;
+		writer->allocLength = newAllocLength;
+	}
+	u8* result = &writer->bytes[writer->length];
+	writer->length += numBytes;
+	return result;
+}
+
+void PbfWireWriteBytes(PbfWireWriter* writer, Slice bytes)
+{
+	if (bytes.length == 0) { return; }
+	u8* destination = PbfWireWriterAlloc(writer, bytes.length);
+	MyMemCopy(destination, bytes.bytes, bytes.length);
+}
+
+void PbfWireWriteVarint(PbfWireWriter* writer, u64 value)
+{
+	u8 varintBytes[PBF_MAX_VARINT_LENGTH];
+	uxx numBytes = 0;
+	do
+	{
+		varintBytes[numBytes] = (u8)(value & 0x7F);
+		value >>= 7;
+		if (value != 0) { varintBytes[numBytes] |= 0x80; }
+		numBytes++;
+	} while (value != 0);
+	u8* destination = PbfWireWriterAlloc(writer, numBytes);
+	MyMemCopy(destination, &varintBytes[0], numBytes);
+}
+
+u64 PbfZigZagEncode(i64 value)
+{
+	return ((u64)value << 1) ^ (u64)(value >> 63);
+}
+
+void PbfWireWriteFieldKey(PbfWireWriter* writer, u32 fieldNumber, PbfWireType wireType)
+{
+	PbfWireWriteVarint(writer, ((u64)fieldNumber << 3) | (u64)wireType);
+}
+
+// NOTE: Negative int32/int64 values have to be cast to u64 first (sign extended) which always takes 10 bytes
+void PbfWireWriteVarintField(PbfWireWriter* writer, u32 fieldNumber, u64 value)
+{
+	PbfWireWriteFieldKey(writer, fieldNumber, PbfWireType_Varint);
+	PbfWireWriteVarint(writer, value);
+}
+
+// Used for strings, bytes, nested messages and packed repeated fields
+void PbfWireWriteSliceField(PbfWireWriter* writer, u32 fieldNumber, Slice slice)
+{
+	PbfWireWriteFieldKey(writer, fieldNumber, PbfWireType_LengthDelimited);
+	PbfWireWriteVarint(writer, (u64)slice.length);
+	PbfWireWriteBytes(writer, slice);
+}
+void PbfWireWriteStrField(PbfWireWriter* writer, u32 fieldNumber, Str8 str)
+{
+	PbfWireWriteSliceField(writer, fieldNumber, MakeSlice(str.length, str.chars));
+}
@@ -0,0 +1,54 @@
+/*
+File:   pbf_wire_format.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _PBF_WIRE_FORMAT_H
+#define _PBF_WIRE_FORMAT_H
+
+#define PBF_MAX_VARINT_LENGTH 10 //bytes
+
+typedef enum PbfWireType PbfWireType;
+enum PbfWireType
+{
+	PbfWireType_Varint = 0,
+	PbfWireType_Fixed64 = 1,
+	PbfWireType_LengthDelimited = 2,
+	PbfWireType_StartGroup = 3,
+	PbfWireType_EndGroup = 4,
+	PbfWireType_Fixed32 = 5,
+};
+
+// Walks the raw bytes of a protobuf message (or a packed repeated field) without copying anything.
+// Any malformed or truncated data sets isError and all subsequent reads return 0/empty
+typedef plex PbfWireReader PbfWireReader;
+plex PbfWireReader
+{
+	u8* bytes;
+	uxx length;
+	uxx offset;
+	bool isError;
+};
+
+// A packed repeated varint field, the values are decoded on demand by walking slice with a PbfWireReader
+typedef plex PbfPackedField PbfPackedField;
+plex PbfPackedField
+{
+	bool isPresent;
+	Slice slice;
+	uxx count;
+};
+
+// Appends protobuf wire format bytes to a buffer that grows in arena. Nested messages and packed fields have to
+// be written to their own writer first since their length is written before them
+typedef plex PbfWireWriter PbfWireWriter;
+plex PbfWireWriter
+{
+	Arena* arena;
+	u8* bytes;
+	uxx length;
+	uxx allocLength;
+};
+
+#endif //  _PBF_WIRE_FORMAT_H
@@ -0,0 +1,981 @@
+/*
+File:   stream_codecs.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds the StreamDecoder that lets TryParseMapFile load .osm.gz and .osm.bz2 (and .osc) files a chunk at a time
+	** without inflating the whole file first. PigCore's zlib decompression wants to know the output size up front and
+	** produces it all at once, so gzip gets its own inflate here (sharing the deflate tables in pbf_codecs.c). Bzip2 has
+	** no decoder anywhere else so it lives here too. app_codec_checks.c decodes fixtures made by the reference gzip and
+	** bzip2 tools through the StreamDecoder
+*/
+
+// +--------------------------------------------------------------+
+// |                            CRC32                             |
+// +--------------------------------------------------------------+
+// gzip's CRC32 is the reflected one (polynomial 0xEDB88320), bzip2's is the same polynomial the other way around (0x04C11DB7)
+void InitGzipCrcTable(InflateStream* stream)
+{
+	for (u32 bIndex = 0; bIndex < 256; bIndex++)
+	{
+		u32 crc = bIndex;
+		for (uxx kIndex = 0; kIndex < 8; kIndex++) { crc = ((crc & 1) != 0) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1); }
+		stream->crcTable[0][bIndex] = crc;
+	}
+	for (u32 bIndex = 0; bIndex < 256; bIndex++)
+	{
+		for (uxx sIndex = 1; sIndex < 8; sIndex++)
+		{
+			u32 prevCrc = stream->crcTable[sIndex-1][bIndex];
+			stream->crcTable[sIndex][bIndex] = (prevCrc >> 8) ^ stream->crcTable[0][prevCrc & 0xFF];
+		}
+	}
+}
+
+// Slicing-by-8, see "A Systematic Approach to Building High Performance, Software-based, CRC Generators" (Kounavis and Berry)
+u32 UpdateGzipCrc(InflateStream* stream, u32 crc, const u8* bytes, uxx numBytes)
+{
+	crc = ~crc;
+	uxx bIndex = 0;
+	for (; bIndex + 8 <= numBytes; bIndex += 8)
+	{
+		u32 low = 0;
+		u32 high = 0;
+		MyMemCopy(&low, &bytes[bIndex], sizeof(u32));
+		MyMemCopy(&high, &bytes[bIndex + 4], sizeof(u32));
+		low ^= crc;
+		crc = stream->crcTable[7][low & 0xFF] ^ stream->crcTable[6][(low >> 8) & 0xFF] ^ stream->crcTable[5][(low >> 16) & 0xFF] ^ stream->crcTable[4][low >> 24] ^
+			stream->crcTable[3][high & 0xFF] ^ stream->crcTable[2][(high >> 8) & 0xFF] ^ stream->crcTable[1][(high >> 16) & 0xFF] ^ stream->crcTable[0][high >> 24];
+	}
+	for (; bIndex < numBytes; bIndex++) { crc = (crc >> 8) ^ stream->crcTable[0][(crc ^ bytes[bIndex]) & 0xFF]; }
+	return ~crc;
+}
+
+void InitBzip2CrcTable(Bzip2Stream* stream)
+{
+	for (u32 bIndex = 0; bIndex < 256; bIndex++)
+	{
+		u32 crc = (bIndex << 24);
+		for (uxx kIndex = 0; kIndex < 8; kIndex++) { crc = ((crc & 0x80000000) != 0) ? ((crc << 1) ^ 0x04C11DB7) : (crc << 1); }
+		stream->crcTable[bIndex] = crc;
+	}
+}
+
+// +--------------------------------------------------------------+
+// |                        Gzip (Inflate)                        |
+// +--------------------------------------------------------------+
+// https://www.rfc-editor.org/rfc/rfc1951 (deflate) and https://www.rfc-editor.org/rfc/rfc1952 (the gzip wrapper).
+// The whole compressed file is in memory so we never have to stop for more input, only when the output buffer is full
+void SetInflateError(InflateStream* stream, Result error)
+{
+	if (stream->error == Result_None) { stream->error = error; }
+}
+
+// Tops the bit buffer up to at least 56 bits (unless we're at the end of the input). The fast path loads 8 bytes at once and only counts the whole
+// bytes that fit, the extra bits above numBits are part of the next byte and get OR'd in again, unchanged, by the next refill
+void RefillInflateBits(InflateStream* stream)
+{
+	if (stream->numBits > 56) { return; }
+	if (stream->length - stream->offset >= sizeof(u64))
+	{
+		u64 word = 0;
+		MyMemCopy(&word, &stream->bytes[stream->offset], sizeof(u64));
+		stream->bitBuffer |= (word << stream->numBits);
+		stream->offset += (uxx)((63 - stream->numBits) >> 3);
+		stream->numBits |= 56;
+	}
+	else
+	{
+		while (stream->numBits <= 56 && stream->offset < stream->length)
+		{
+			stream->bitBuffer |= ((u64)stream->bytes[stream->offset] << stream->numBits);
+			stream->offset++;
+			stream->numBits += 8;
+		}
+	}
+}
+
+u32 ReadInflateBits(InflateStream* stream, u8 numBits)
+{
+	if (stream->numBits < numBits) { RefillInflateBits(stream); }
+	if (stream->numBits < numBits) { SetInflateError(stream, Result_NoMoreBytes); return 0; }
+	u32 result = (u32)(stream->bitBuffer & (((u64)1 << numBits) - 1));
+	stream->bitBuffer >>= numBits;
+	stream->numBits -= numBits;
+	return result;
+}
+
+// Throws away the bits up to the next byte boundary and gives the whole bytes that are still in the bit buffer back to the input,
+// so stored blocks and the gzip trailer can be read straight from stream->bytes
+void AlignInflateToByte(InflateStream* stream)
+{
+	stream->numBits -= (stream->numBits & 7);
+	stream->offset -= (uxx)(stream->numBits >> 3);
+	stream->bitBuffer = 0;
+	stream->numBits = 0;
+}
+
+bool BuildInflateHuffman(InflateHuffman* huffman, const u8* lengths, uxx numSymbols)
+{
+	Assert(numSymbols <= INFLATE_MAX_LITLEN_CODES);
+	MyMemSet(huffman->fast, 0x00, sizeof(huffman->fast));
+	MyMemSet(huffman->lengthCounts, 0x00, sizeof(huffman->lengthCounts));
+	for (uxx sIndex = 0; sIndex < numSymbols; sIndex++) { huffman->lengthCounts[lengths[sIndex]]++; }
+	huffman->lengthCounts[0] = 0;
+	
+	u32 code = 0;
+	u16 sortedIndex = 0;
+	u16 nextIndices[DEFLATE_MAX_CODE_LENGTH+1];
+	for (uxx lIndex = 1; lIndex <= DEFLATE_MAX_CODE_LENGTH; lIndex++)
+	{
+		huffman->firstCodes[lIndex] = (u16)code;
+		huffman->firstIndices[lIndex] = sortedIndex;
+		nextIndices[lIndex] = sortedIndex;
+		code += huffman->lengthCounts[lIndex];
+		sortedIndex += huffman->lengthCounts[lIndex];
+		if (code > ((u32)1 << lIndex)) { return false; } //more codes of this length than there is room for
+		code <<= 1;
+	}
+	
+	for (uxx sIndex = 0; sIndex < numSymbols; sIndex++)
+	{
+		u8 length = lengths[sIndex];
+		if (length == 0) { continue; }
+		u16 symbolIndex = nextIndices[length]++;
+		huffman->sortedSymbols[symbolIndex] = (u16)sIndex;
+		if (length <= INFLATE_FAST_BITS)
+		{
+			//NOTE: The stream holds the codes most significant bit first so the table is indexed by the reversed code, with every combination of the bits after it
+			u32 symbolCode = (u32)huffman->firstCodes[length] + (u32)(symbolIndex - huffman->firstIndices[length]);
+			u32 reversedCode = 0;
+			for (u8 bIndex = 0; bIndex < length; bIndex++) { reversedCode = (reversedCode << 1) | ((symbolCode >> bIndex) & 1); }
+			for (u32 fIndex = reversedCode; fIndex < (1 << INFLATE_FAST_BITS); fIndex += ((u32)1 << length)) { huffman->fast[fIndex] = (u16)((length << 9) | sIndex); }
+		}
+	}
+	return true;
+}
+
+u16 DecodeInflateSymbol(InflateStream* stream, const InflateHuffman* huffman)
+{
+	if (stream->numBits < DEFLATE_MAX_CODE_LENGTH) { RefillInflateBits(stream); }
+	u16 entry = huffman->fast[stream->bitBuffer & ((1 << INFLATE_FAST_BITS) - 1)];
+	if (entry != 0)
+	{
+		u8 length = (u8)(entry >> 9);
+		if (length > stream->numBits) { SetInflateError(stream, Result_NoMoreBytes); return 0; }
+		stream->bitBuffer >>= length;
+		stream->numBits -= length;
+		return (u16)(entry & 0x1FF);
+	}
+	
+	u32 code = 0;
+	for (u8 length = 1; length <= DEFLATE_MAX_CODE_LENGTH; length++)
+	{
+		if (length > stream->numBits) { SetInflateError(stream, Result_NoMoreBytes); return 0; }
+		code = (code << 1) | (u32)((stream->bitBuffer >> (length-1)) & 1);
+		u32 codeIndex = code - (u32)huffman->firstCodes[length]; //wraps around when code is below the first code
+		if (codeIndex < huffman->lengthCounts[length])
+		{
+			stream->bitBuffer >>= length;
+			stream->numBits -= length;
+			return huffman->sortedSymbols[huffman->firstIndices[length] + codeIndex];
+		}
+	}
+	SetInflateError(stream, Result_DecompressError);
+	return 0;
+}
+
+void ResetInflateStream(InflateStream* stream, Slice input)
+{
+	stream->bytes = input.bytes;
+	stream->length = input.length;
+	stream->offset = 0;
+	stream->bitBuffer = 0;
+	stream->numBits = 0;
+	stream->stage = InflateStage_MemberHeader;
+	stream->isFinalBlock = false;
+	stream->storedRemaining = 0;
+	stream->matchRemaining = 0;
+	stream->matchDistance = 0;
+	stream->memberCrc = 0;
+	stream->memberSize = 0;
+	stream->numMembers = 0;
+	stream->error = Result_None;
+}
+
+void InitInflateStream(InflateStream* stream, Slice input)
+{
+	ClearPointer(stream);
+	ResetInflateStream(stream, input);
+	InitGzipCrcTable(stream);
+	
+	u8 fixedLengths[INFLATE_MAX_LITLEN_CODES];
+	for (uxx sIndex = 0; sIndex < INFLATE_MAX_LITLEN_CODES; sIndex++) { fixedLengths[sIndex] = (sIndex < 144) ? 8 : ((sIndex < 256) ? 9 : ((sIndex < 280) ? 7 : 8)); }
+	bool builtFixedCodes = BuildInflateHuffman(&stream->fixedLitLenCodes, fixedLengths, INFLATE_MAX_LITLEN_CODES);
+	for (uxx sIndex = 0; sIndex < INFLATE_MAX_DIST_CODES; sIndex++) { fixedLengths[sIndex] = 5; }
+	builtFixedCodes = (BuildInflateHuffman(&stream->fixedDistCodes, fixedLengths, INFLATE_MAX_DIST_CODES) && builtFixedCodes);
+	Assert(builtFixedCodes);
+	UNUSED(builtFixedCodes);
+}
+
+// The bit buffer is always empty here, the trailer of the last member (or ResetInflateStream) left it that way
+void ReadGzipMemberHeader(InflateStream* stream)
+{
+	const u8* bytes = stream->bytes;
+	uxx offset = stream->offset;
+	if (stream->length - offset < 10) { SetInflateError(stream, (stream->numMembers == 0) ? Result_MissingFileHeader : Result_NoMoreBytes); return; }
+	if (bytes[offset+0] != 0x1F || bytes[offset+1] != 0x8B) { SetInflateError(stream, Result_MissingFileHeader); return; }
+	if (bytes[offset+2] != 8) { SetInflateError(stream, Result_UnsupportedCompression); return; } //CM=8 (deflate) is the only one there is
+	u8 flags = bytes[offset+3];
+	if ((flags & GZIP_FLAG_RESERVED) != 0) { SetInflateError(stream, Result_DecompressError); return; }
+	offset += 10; //ID1, ID2, CM, FLG, MTIME (4), XFL, OS
+	if ((flags & GZIP_FLAG_EXTRA) != 0)
+	{
+		if (stream->length - offset < 2) { SetInflateError(stream, Result_NoMoreBytes); return; }
+		uxx extraLength = (uxx)bytes[offset] | ((uxx)bytes[offset+1] << 8);
+		offset += 2;
+		if (stream->length - offset < extraLength) { SetInflateError(stream, Result_NoMoreBytes); return; }
+		offset += extraLength;
+	}
+	//NOTE: The original file name and the comment are both zero terminated
+	for (uxx fIndex = 0; fIndex < 2; fIndex++)
+	{
+		if ((flags & ((fIndex == 0) ? GZIP_FLAG_NAME : GZIP_FLAG_COMMENT)) == 0) { continue; }
+		while (offset < stream->length && bytes[offset] != '\0') { offset++; }
+		if (offset >= stream->length) { SetInflateError(stream, Result_NoMoreBytes); return; }
+		offset++;
+	}
+	if ((flags & GZIP_FLAG_HCRC) != 0) { offset += 2; }
+	if (offset > stream->length) { SetInflateError(stream, Result_NoMoreBytes); return; }
+	
+	stream->offset = offset;
+	stream->memberCrc = 0;
+	stream->memberSize = 0;
+	stream->numMembers++;
+	stream->stage = InflateStage_BlockHeader;
+}
+
+// Reads the dynamic Huffman code lengths (RFC 1951 section 3.2.7) and builds litLenCodes and distCodes from them
+void ReadInflateDynamicCodes(InflateStream* stream)
+{
+	uxx numLitLenCodes = 257 + (uxx)ReadInflateBits(stream, 5);
+	uxx numDistCodes = 1 + (uxx)ReadInflateBits(stream, 5);
+	uxx numClCodes = 4 + (uxx)ReadInflateBits(stream, 4);
+	if (numLitLenCodes > DEFLATE_NUM_LITLEN_CODES || numDistCodes > DEFLATE_NUM_DIST_CODES) { SetInflateError(stream, Result_DecompressError); return; }
+	u8 clLengths[DEFLATE_NUM_CL_CODES] = ZEROED;
+	for (uxx cIndex = 0; cIndex < numClCodes; cIndex++) { clLengths[DeflateClOrder[cIndex]] = (u8)ReadInflateBits(stream, 3); }
+	if (stream->error != Result_None) { return; }
+	//NOTE: litLenCodes isn't needed until the lengths are all read, so it holds the code length code in the meantime
+	if (!BuildInflateHuffman(&stream->litLenCodes, clLengths, DEFLATE_NUM_CL_CODES)) { SetInflateError(stream, Result_DecompressError); return; }
+	
+	u8 lengths[DEFLATE_NUM_LITLEN_CODES + DEFLATE_NUM_DIST_CODES];
+	uxx numLengths = numLitLenCodes + numDistCodes;
+	uxx lIndex = 0;
+	while (lIndex < numLengths && stream->error == Result_None)
+	{
+		u16 symbol = DecodeInflateSymbol(stream, &stream->litLenCodes);
+		if (symbol < 16) { lengths[lIndex++] = (u8)symbol; continue; }
+		u8 repeatValue = 0;
+		uxx repeatCount = 0;
+		if (symbol == 16)
+		{
+			if (lIndex == 0) { SetInflateError(stream, Result_DecompressError); break; }
+			repeatValue = lengths[lIndex-1];
+			repeatCount = 3 + (uxx)ReadInflateBits(stream, 2);
+		}
+		else if (symbol == 17) { repeatCount = 3 + (uxx)ReadInflateBits(stream, 3); }
+		else { repeatCount = 11 + (uxx)ReadInflateBits(stream, 7); }
+		if (repeatCount > numLengths - lIndex) { SetInflateError(stream, Result_DecompressError); break; }
+		MyMemSet(&lengths[lIndex], repeatValue, repeatCount);
+		lIndex += repeatCount;
+	}
+	if (stream->error != Result_None) { return; }
+	if (lengths[256] == 0) { SetInflateError(stream, Result_DecompressError); return; } //no way to end the block
+	if (!BuildInflateHuffman(&stream->litLenCodes, &lengths[0], numLitLenCodes) ||
+		!BuildInflateHuffman(&stream->distCodes, &lengths[numLitLenCodes], numDistCodes))
+	{
+		SetInflateError(stream, Result_DecompressError);
+	}
+}
+
+void ReadInflateBlockHeader(InflateStream* stream)
+{
+	stream->isFinalBlock = (ReadInflateBits(stream, 1) != 0);
+	u32 blockType = ReadInflateBits(stream, 2);
+	if (stream->error != Result_None) { return; }
+	if (blockType == 0)
+	{
+		AlignInflateToByte(stream);
+		if (stream->length - stream->offset < 4) { SetInflateError(stream, Result_NoMoreBytes); return; }
+		const u8* bytes = &stream->bytes[stream->offset];
+		uxx blockLength = (uxx)bytes[0] | ((uxx)bytes[1] << 8);
+		uxx blockLengthComplement = (uxx)bytes[2] | ((uxx)bytes[3] << 8);
+		if (blockLength != (~blockLengthComplement & 0xFFFF)) { SetInflateError(stream, Result_DecompressError); return; }
+		stream->offset += 4;
+		stream->storedRemaining = blockLength;
+		stream->stage = InflateStage_Stored;
+	}
+	else if (blockType == 1)
+	{
+		MyMemCopy(&stream->litLenCodes, &stream->fixedLitLenCodes, sizeof(InflateHuffman));
+		MyMemCopy(&stream->distCodes, &stream->fixedDistCodes, sizeof(InflateHuffman));
+		stream->stage = InflateStage_Huffman;
+	}
+	else if (blockType == 2)
+	{
+		ReadInflateDynamicCodes(stream);
+		stream->stage = InflateStage_Huffman;
+	}
+	else { SetInflateError(stream, Result_DecompressError); }
+}
+
+void ReadGzipMemberTrailer(InflateStream* stream)
+{
+	AlignInflateToByte(stream);
+	if (stream->length - stream->offset < 8) { SetInflateError(stream, Result_NoMoreBytes); return; }
+	const u8* bytes = &stream->bytes[stream->offset];
+	u32 expectedCrc = (u32)bytes[0] | ((u32)bytes[1] << 8) | ((u32)bytes[2] << 16) | ((u32)bytes[3] << 24);
+	u32 expectedSize = (u32)bytes[4] | ((u32)bytes[5] << 8) | ((u32)bytes[6] << 16) | ((u32)bytes[7] << 24);
+	if (expectedCrc != stream->memberCrc || expectedSize != stream->memberSize) { SetInflateError(stream, Result_Mismatch); return; }
+	stream->offset += 8;
+	//NOTE: A gzip file can be several members one after another (ex. cat a.gz b.gz), anything after the last member that isn't another one is ignored like gzip does
+	bool hasAnotherMember = (stream->length - stream->offset >= 2 && stream->bytes[stream->offset] == 0x1F && stream->bytes[stream->offset+1] == 0x8B);
+	stream->stage = hasAnotherMember ? InflateStage_MemberHeader : InflateStage_Done;
+}
+
+uxx DecodeInflateHuffmanBlock(InflateStream* stream, u8* buffer, uxx outIndex, uxx bufferSize)
+{
+	while (outIndex < bufferSize)
+	{
+		if (stream->matchRemaining > 0)
+		{
+			uxx copyLength = MinUXX(stream->matchRemaining, bufferSize - outIndex);
+			u8* copyDest = &buffer[outIndex];
+			const u8* copySource = copyDest - stream->matchDistance;
+			//NOTE: Same as LZ4, the match can overlap the bytes it's producing
+			if (stream->matchDistance >= copyLength) { MyMemCopy(copyDest, copySource, copyLength); }
+			else { for (uxx bIndex = 0; bIndex < copyLength; bIndex++) { copyDest[bIndex] = copySource[bIndex]; } }
+			outIndex += copyLength;
+			stream->matchRemaining -= copyLength;
+			continue;
+		}
+		
+		u16 symbol = DecodeInflateSymbol(stream, &stream->litLenCodes);
+		if (stream->error != Result_None) { break; }
+		if (symbol < 256) { buffer[outIndex++] = (u8)symbol; continue; }
+		if (symbol == 256) { stream->stage = stream->isFinalBlock ? InflateStage_MemberTrailer : InflateStage_BlockHeader; break; }
+		
+		uxx lengthCode = (uxx)symbol - 257;
+		if (lengthCode >= 29) { SetInflateError(stream, Result_DecompressError); break; }
+		uxx matchLength = DeflateLengthBases[lengthCode] + (uxx)ReadInflateBits(stream, DeflateLengthExtraBits[lengthCode]);
+		u16 distCode = DecodeInflateSymbol(stream, &stream->distCodes);
+		if (stream->error != Result_None) { break; }
+		if (distCode >= DEFLATE_NUM_DIST_CODES) { SetInflateError(stream, Result_DecompressError); break; }
+		uxx distance = DeflateDistBases[distCode] + (uxx)ReadInflateBits(stream, DeflateDistExtraBits[distCode]);
+		if (stream->error != Result_None) { break; }
+		if (distance > outIndex) { SetInflateError(stream, Result_DecompressError); break; } //reaches back before the start of the file
+		stream->matchRemaining = matchLength;
+		stream->matchDistance = distance;
+	}
+	return outIndex;
+}
+
+// Decodes into buffer[outIndex..bufferSize). The bytes before outIndex have to be the output that came right before, at least DEFLATE_WINDOW_SIZE
+// of it (or all of it near the start). Returns the new outIndex, which is bufferSize unless the file ended or the data is corrupt (see stream->error)
+uxx DecodeInflateStream(InflateStream* stream, u8* buffer, uxx outIndex, uxx bufferSize)
+{
+	TracyCZoneN(funcZone, "DecodeInflateStream", true);
+	uxx crcStartIndex = outIndex;
+	while (outIndex < bufferSize && stream->error == Result_None && stream->stage != InflateStage_Done)
+	{
+		switch (stream->stage)
+		{
+			case InflateStage_MemberHeader: ReadGzipMemberHeader(stream); break;
+			case InflateStage_BlockHeader: ReadInflateBlockHeader(stream); break;
+			case InflateStage_Stored:
+			{
+				uxx copyLength = MinUXX(stream->storedRemaining, bufferSize - outIndex);
+				if (copyLength > stream->length - stream->offset) { SetInflateError(stream, Result_NoMoreBytes); break; }
+				MyMemCopy(&buffer[outIndex], &stream->bytes[stream->offset], copyLength);
+				stream->offset += copyLength;
+				outIndex += copyLength;
+				stream->storedRemaining -= copyLength;
+				if (stream->storedRemaining == 0) { stream->stage = stream->isFinalBlock ? InflateStage_MemberTrailer : InflateStage_BlockHeader; }
+			} break;
+			case InflateStage_Huffman: outIndex = DecodeInflateHuffmanBlock(stream, buffer, outIndex, bufferSize); break;
+			case InflateStage_MemberTrailer:
+			{
+				stream->memberCrc = UpdateGzipCrc(stream, stream->memberCrc, &buffer[crcStartIndex], outIndex - crcStartIndex);
+				stream->memberSize += (u32)(outIndex - crcStartIndex);
+				crcStartIndex = outIndex;
+				ReadGzipMemberTrailer(stream);
+			} break;
+			default: break;
+		}
+	}
+	stream->memberCrc = UpdateGzipCrc(stream, stream->memberCrc, &buffer[crcStartIndex], outIndex - crcStartIndex);
+	stream->memberSize += (u32)(outIndex - crcStartIndex);
+	TracyCZoneEnd(funcZone);
+	return outIndex;
+}
+
+// +--------------------------------------------------------------+
+// |                            Bzip2                             |
+// +--------------------------------------------------------------+
+// There's no spec besides the reference implementation (bzip2 1.0.8's decompress.c), https://github.com/dsnet/compress/blob/master/doc/bzip2-format.pdf
+// describes it well. Each block is: Huffman coded symbols -> move-to-front and RUNA/RUNB zero runs -> the Burrows-Wheeler transform -> runs of 4-255 bytes.
+// Blocks are at most 900k so we decode a whole block into tt at once and only hand out the run length decoded bytes a buffer at a time
+void SetBzip2Error(Bzip2Stream* stream, Result error)
+{
+	if (stream->error == Result_None) { stream->error = error; }
+}
+
+void RefillBzip2Bits(Bzip2Stream* stream)
+{
+	while (stream->numBits <= 56 && stream->offset < stream->length)
+	{
+		stream->bitBuffer = (stream->bitBuffer << 8) | (u64)stream->bytes[stream->offset];
+		stream->offset++;
+		stream->numBits += 8;
+	}
+}
+
+u32 ReadBzip2Bits(Bzip2Stream* stream, u8 numBits)
+{
+	if (stream->numBits < numBits) { RefillBzip2Bits(stream); }
+	if (stream->numBits < numBits) { SetBzip2Error(stream, Result_NoMoreBytes); return 0; }
+	stream->numBits -= numBits;
+	return (u32)((stream->bitBuffer >> stream->numBits) & (((u64)1 << numBits) - 1));
+}
+
+// perms holds the symbols sorted by code length, the codes of each length are consecutive so a code of length L is perms[code - bases[L]] if it's <= limits[L]
+void BuildBzip2Group(Bzip2Group* group, const u8* lengths, uxx alphaSize)
+{
+	group->minLength = BZIP2_MAX_CODE_LENGTH;
+	group->maxLength = 0;
+	for (uxx sIndex = 0; sIndex < alphaSize; sIndex++)
+	{
+		if (lengths[sIndex] < group->minLength) { group->minLength = lengths[sIndex]; }
+		if (lengths[sIndex] > group->maxLength) { group->maxLength = lengths[sIndex]; }
+	}
+	uxx permIndex = 0;
+	i32 code = 0;
+	for (u8 length = 0; length <= BZIP2_MAX_CODE_LENGTH+1; length++) { group->limits[length] = -1; group->bases[length] = 0; }
+	for (u8 length = group->minLength; length <= group->maxLength; length++)
+	{
+		i32 firstPermIndex = (i32)permIndex;
+		for (uxx sIndex = 0; sIndex < alphaSize; sIndex++)
+		{
+			if (lengths[sIndex] == length) { group->perms[permIndex++] = (u16)sIndex; }
+		}
+		i32 numCodes = (i32)permIndex - firstPermIndex;
+		group->bases[length] = code - firstPermIndex;
+		group->limits[length] = code + numCodes - 1;
+		code = (code + numCodes) << 1;
+	}
+}
+
+u16 DecodeBzip2Symbol(Bzip2Stream* stream, const Bzip2Group* group, uxx alphaSize)
+{
+	if (stream->numBits < BZIP2_MAX_CODE_LENGTH) { RefillBzip2Bits(stream); }
+	u8 length = group->minLength;
+	if (length > stream->numBits) { SetBzip2Error(stream, Result_NoMoreBytes); return 0; }
+	i32 code = (i32)((stream->bitBuffer >> (stream->numBits - length)) & (((u64)1 << length) - 1));
+	while (code > group->limits[length])
+	{
+		length++;
+		if (length > group->maxLength) { SetBzip2Error(stream, Result_DecompressError); return 0; }
+		if (length > stream->numBits) { SetBzip2Error(stream, Result_NoMoreBytes); return 0; }
+		code = (i32)((stream->bitBuffer >> (stream->numBits - length)) & (((u64)1 << length) - 1));
+	}
+	i32 permIndex = code - group->bases[length];
+	if (permIndex < 0 || permIndex >= (i32)alphaSize) { SetBzip2Error(stream, Result_DecompressError); return 0; }
+	stream->numBits -= length;
+	return group->perms[permIndex];
+}
+
+void ResetBzip2Stream(Bzip2Stream* stream, Slice input)
+{
+	stream->bytes = input.bytes;
+	stream->length = input.length;
+	stream->offset = 0;
+	stream->bitBuffer = 0;
+	stream->numBits = 0;
+	stream->stage = Bzip2Stage_StreamHeader;
+	stream->maxBlockSize = 0;
+	stream->numStreams = 0;
+	stream->error = Result_None;
+	stream->blockRemaining = 0;
+	stream->repeatRemaining = 0;
+}
+
+void InitBzip2Stream(Bzip2Stream* stream, u32* tt, Slice input)
+{
+	ClearPointer(stream);
+	stream->tt = tt;
+	ResetBzip2Stream(stream, input);
+	InitBzip2CrcTable(stream);
+}
+
+// The bit buffer is always byte aligned here, the end of the last stream (or ResetBzip2Stream) left it that way
+void ReadBzip2StreamHeader(Bzip2Stream* stream)
+{
+	u32 magic = ReadBzip2Bits(stream, 24);
+	u32 levelChar = ReadBzip2Bits(stream, 8);
+	if (stream->error != Result_None || magic != 0x425A68 || levelChar < '1' || levelChar > '9') //"BZh" then '1'-'9'
+	{
+		if (stream->error == Result_None || stream->numStreams == 0) { stream->error = Result_MissingFileHeader; }
+		return;
+	}
+	stream->maxBlockSize = (uxx)(levelChar - '0') * 100000;
+	stream->combinedCrc = 0;
+	stream->numStreams++;
+	stream->stage = Bzip2Stage_BlockHeader;
+}
+
+// Huffman decodes the block, undoes the move-to-front and zero runs into tt and then links tt up for the inverse BWT
+void DecodeBzip2Block(Bzip2Stream* stream, u32 origPtr)
+{
+	TracyCZoneN(funcZone, "DecodeBzip2Block", true);
+	u8 seqToUnseq[256];
+	uxx numInUse = 0;
+	u32 usedRanges = ReadBzip2Bits(stream, 16);
+	for (uxx rIndex = 0; rIndex < 16; rIndex++)
+	{
+		if ((usedRanges & (0x8000 >> rIndex)) == 0) { continue; }
+		u32 usedBytes = ReadBzip2Bits(stream, 16);
+		for (uxx bIndex = 0; bIndex < 16; bIndex++)
+		{
+			if ((usedBytes & (0x8000 >> bIndex)) != 0) { seqToUnseq[numInUse++] = (u8)(rIndex*16 + bIndex); }
+		}
+	}
+	uxx alphaSize = numInUse + 2; //RUNA and RUNB replace the 0th MTF index, plus the end of block symbol
+	uxx numGroups = (uxx)ReadBzip2Bits(stream, 3);
+	uxx numSelectors = (uxx)ReadBzip2Bits(stream, 15);
+	if (stream->error == Result_None && (numInUse == 0 || numGroups < 2 || numGroups > BZIP2_MAX_GROUPS || numSelectors == 0)) { SetBzip2Error(stream, Result_DecompressError); }
+	if (stream->error != Result_None) { TracyCZoneEnd(funcZone); return; }
+	
+	u8 groupMtf[BZIP2_MAX_GROUPS];
+	for (uxx gIndex = 0; gIndex < BZIP2_MAX_GROUPS; gIndex++) { groupMtf[gIndex] = (u8)gIndex; }
+	for (uxx sIndex = 0; sIndex < numSelectors && stream->error == Result_None; sIndex++)
+	{
+		uxx mtfIndex = 0;
+		while (ReadBzip2Bits(stream, 1) != 0)
+		{
+			mtfIndex++;
+			if (mtfIndex >= numGroups) { SetBzip2Error(stream, Result_DecompressError); break; }
+		}
+		if (stream->error != Result_None) { break; }
+		u8 group = groupMtf[mtfIndex];
+		for (uxx gIndex = mtfIndex; gIndex > 0; gIndex--) { groupMtf[gIndex] = groupMtf[gIndex-1]; }
+		groupMtf[0] = group;
+		if (sIndex < BZIP2_MAX_SELECTORS) { stream->selectors[sIndex] = group; }
+	}
+	numSelectors = MinUXX(numSelectors, BZIP2_MAX_SELECTORS);
+	
+	//NOTE: Each length is a delta from the last one, 0 ends the symbol, 10 adds one and 11 subtracts one
+	for (uxx gIndex = 0; gIndex < numGroups && stream->error == Result_None; gIndex++)
+	{
+		i32 length = (i32)ReadBzip2Bits(stream, 5);
+		for (uxx sIndex = 0; sIndex < alphaSize && stream->error == Result_None; sIndex++)
+		{
+			while (true)
+			{
+				if (length < 1 || length > BZIP2_MAX_CODE_LENGTH) { SetBzip2Error(stream, Result_DecompressError); break; }
+				if (ReadBzip2Bits(stream, 1) == 0) { break; }
+				length += (ReadBzip2Bits(stream, 1) == 0) ? 1 : -1;
+				if (stream->error != Result_None) { break; }
+			}
+			stream->codeLengths[gIndex][sIndex] = (u8)length;
+		}
+		BuildBzip2Group(&stream->groups[gIndex], stream->codeLengths[gIndex], alphaSize);
+	}
+	if (stream->error != Result_None) { TracyCZoneEnd(funcZone); return; }
+	
+	u8 mtf[256];
+	for (uxx mIndex = 0; mIndex < 256; mIndex++) { mtf[mIndex] = (u8)mIndex; }
+	u32 byteCounts[256] = ZEROED;
+	u32* tt = stream->tt;
+	uxx numDecoded = 0;
+	uxx selectorIndex = 0;
+	uxx groupRemaining = 0;
+	const Bzip2Group* group = nullptr;
+	uxx runLength = 0;
+	uxx runBit = 0;
+	u16 endOfBlock = (u16)(alphaSize - 1);
+	while (true)
+	{
+		if (groupRemaining == 0)
+		{
+			if (selectorIndex >= numSelectors) { SetBzip2Error(stream, Result_DecompressError); break; }
+			group = &stream->groups[stream->selectors[selectorIndex++]];
+			groupRemaining = BZIP2_GROUP_SIZE;
+		}
+		groupRemaining--;
+		u16 symbol = DecodeBzip2Symbol(stream, group, alphaSize);
+		if (stream->error != Result_None) { break; }
+		
+		//NOTE: Runs of the byte at the front of the MTF list are written in bijective base 2, RUNA is a 1 and RUNB is a 2 in each place, least significant first
+		if (symbol == BZIP2_RUNA || symbol == BZIP2_RUNB)
+		{
+			runLength += ((uxx)symbol + 1) << runBit;
+			runBit++;
+			if (runLength > stream->maxBlockSize) { SetBzip2Error(stream, Result_DecompressError); break; }
+			continue;
+		}
+		if (runLength > 0)
+		{
+			if (runLength > stream->maxBlockSize - numDecoded) { SetBzip2Error(stream, Result_DecompressError); break; }
+			u8 runByte = seqToUnseq[mtf[0]];
+			byteCounts[runByte] += (u32)runLength;
+			for (uxx rIndex = 0; rIndex < runLength; rIndex++) { tt[numDecoded++] = runByte; }
+			runLength = 0;
+			runBit = 0;
+		}
+		if (symbol == endOfBlock) { break; }
+		
+		uxx mtfIndex = (uxx)symbol - 1;
+		if (mtfIndex >= numInUse || numDecoded >= stream->maxBlockSize) { SetBzip2Error(stream, Result_DecompressError); break; }
+		u8 value = mtf[mtfIndex];
+		MyMemMove(&mtf[1], &mtf[0], mtfIndex);
+		mtf[0] = value;
+		u8 outByte = seqToUnseq[value];
+		byteCounts[outByte]++;
+		tt[numDecoded++] = outByte;
+	}
+	if (stream->error == Result_None && (uxx)origPtr >= numDecoded) { SetBzip2Error(stream, Result_DecompressError); }
+	if (stream->error != Result_None) { TracyCZoneEnd(funcZone); return; }
+	
+	//NOTE: The inverse BWT, each entry gets the index of the entry that follows it in the original data in its upper 24 bits
+	u32 nextIndices[256];
+	u32 countSum = 0;
+	for (uxx bIndex = 0; bIndex < 256; bIndex++) { nextIndices[bIndex] = countSum; countSum += byteCounts[bIndex]; }
+	for (uxx tIndex = 0; tIndex < numDecoded; tIndex++)
+	{
+		u8 byteValue = (u8)(tt[tIndex] & 0xFF);
+		tt[nextIndices[byteValue]++] |= ((u32)tIndex << 8);
+	}
+	stream->tPos = (tt[origPtr] >> 8);
+	stream->blockRemaining = numDecoded;
+	stream->runByte = -1;
+	stream->runLength = 0;
+	stream->repeatRemaining = 0;
+	stream->blockCrc = 0xFFFFFFFF;
+	stream->stage = Bzip2Stage_BlockOutput;
+	TracyCZoneValue(funcZone, numDecoded);
+	TracyCZoneEnd(funcZone);
+}
+
+void ReadBzip2BlockHeader(Bzip2Stream* stream)
+{
+	u64 magic = ((u64)ReadBzip2Bits(stream, 24) << 24);
+	magic |= (u64)ReadBzip2Bits(stream, 24);
+	if (stream->error != Result_None) { return; }
+	if (magic == BZIP2_END_MAGIC)
+	{
+		u32 expectedCombinedCrc = ReadBzip2Bits(stream, 32);
+		if (stream->error != Result_None) { return; }
+		if (expectedCombinedCrc != stream->combinedCrc) { SetBzip2Error(stream, Result_Mismatch); return; }
+		//NOTE: Streams are padded to a whole byte. Like gzip members, several streams can be concatenated (ex. pbzip2 writes one per thread)
+		stream->numBits -= (stream->numBits & 7);
+		stream->offset -= (uxx)(stream->numBits >> 3);
+		stream->bitBuffer = 0;
+		stream->numBits = 0;
+		const u8* bytes = &stream->bytes[stream->offset];
+		bool hasAnotherStream = (stream->length - stream->offset >= 4 && bytes[0] == 'B' && bytes[1] == 'Z' && bytes[2] == 'h');
+		stream->stage = hasAnotherStream ? Bzip2Stage_StreamHeader : Bzip2Stage_Done;
+		return;
+	}
+	if (magic != BZIP2_BLOCK_MAGIC) { SetBzip2Error(stream, Result_DecompressError); return; }
+	stream->expectedBlockCrc = ReadBzip2Bits(stream, 32);
+	//NOTE: Randomized blocks were dropped in bzip2 0.9.5 (1999) and nothing has written them since, so we don't carry the table of random numbers to undo them
+	if (ReadBzip2Bits(stream, 1) != 0) { SetBzip2Error(stream, Result_UnsupportedCompression); return; }
+	u32 origPtr = ReadBzip2Bits(stream, 24);
+	if (stream->error != Result_None) { return; }
+	DecodeBzip2Block(stream, origPtr);
+}
+
+// Follows the tt links and undoes the runs of 4 (a run of 4 identical bytes is followed by a count of 0-255 more)
+uxx OutputBzip2Block(Bzip2Stream* stream, u8* buffer, uxx outIndex, uxx bufferSize)
+{
+	const u32* tt = stream->tt;
+	u32 tPos = stream->tPos;
+	u32 crc = stream->blockCrc;
+	while (outIndex < bufferSize)
+	{
+		if (stream->repeatRemaining > 0)
+		{
+			u8 repeatByte = (u8)stream->runByte;
+			uxx numRepeats = MinUXX(stream->repeatRemaining, bufferSize - outIndex);
+			MyMemSet(&buffer[outIndex], repeatByte, numRepeats);
+			for (uxx rIndex = 0; rIndex < numRepeats; rIndex++) { crc = (crc << 8) ^ stream->crcTable[(crc >> 24) ^ repeatByte]; }
+			outIndex += numRepeats;
+			stream->repeatRemaining -= numRepeats;
+			continue;
+		}
+		if (stream->blockRemaining == 0)
+		{
+			crc = ~crc;
+			if (crc != stream->expectedBlockCrc) { SetBzip2Error(stream, Result_Mismatch); break; }
+			stream->combinedCrc = ((stream->combinedCrc << 1) | (stream->combinedCrc >> 31)) ^ crc;
+			stream->stage = Bzip2Stage_BlockHeader;
+			break;
+		}
+		
+		u32 entry = tt[tPos];
+		u8 outByte = (u8)(entry & 0xFF);
+		tPos = (entry >> 8);
+		stream->blockRemaining--;
+		if (stream->runLength == 4)
+		{
+			stream->repeatRemaining = outByte;
+			stream->runLength = 0;
+			continue;
+		}
+		if ((i32)outByte == stream->runByte) { stream->runLength++; }
+		else { stream->runByte = (i32)outByte; stream->runLength = 1; }
+		buffer[outIndex++] = outByte;
+		crc = (crc << 8) ^ stream->crcTable[(crc >> 24) ^ outByte];
+	}
+	stream->tPos = tPos;
+	stream->blockCrc = crc;
+	return outIndex;
+}
+
+// Decodes into buffer[outIndex..bufferSize), returns the new outIndex. That's bufferSize unless the file ended or the data is corrupt (see stream->error)
+uxx DecodeBzip2Stream(Bzip2Stream* stream, u8* buffer, uxx outIndex, uxx bufferSize)
+{
+	TracyCZoneN(funcZone, "DecodeBzip2Stream", true);
+	while (outIndex < bufferSize && stream->error == Result_None && stream->stage != Bzip2Stage_Done)
+	{
+		switch (stream->stage)
+		{
+			case Bzip2Stage_StreamHeader: ReadBzip2StreamHeader(stream); break;
+			case Bzip2Stage_BlockHeader: ReadBzip2BlockHeader(stream); break;
+			case Bzip2Stage_BlockOutput: outIndex = OutputBzip2Block(stream, buffer, outIndex, bufferSize); break;
+			default: break;
+		}
+	}
+	TracyCZoneEnd(funcZone);
+	return outIndex;
+}
+
+// +--------------------------------------------------------------+
+// |                        Stream Decoder                        |
+// +--------------------------------------------------------------+
+// Decodes the next chunk into buffers[fillIndex % numBuffers]. Only one thread fills buffers at a time, it's the only one that touches the codec.
+// The end of the last buffer (the history that matches can reach back into and the bytes that were held back) is copied to the front first
+void FillStreamDecoderBuffer(StreamDecoder* decoder, uxx fillIndex)
+{
+	TracyCZoneN(funcZone, "FillStreamDecoderBuffer", true);
+	StreamDecoderBuffer* buffer = &decoder->buffers[fillIndex % decoder->numBuffers];
+	uxx copyLength = 0;
+	uxx carryLength = 0;
+	if (fillIndex > 0)
+	{
+		StreamDecoderBuffer* prevBuffer = &decoder->buffers[(fillIndex-1) % decoder->numBuffers];
+		carryLength = prevBuffer->decodedEnd - prevBuffer->chunkEnd;
+		copyLength = MinUXX(prevBuffer->decodedEnd, decoder->historySize + carryLength);
+		MyMemCopy(buffer->bytes, &prevBuffer->bytes[prevBuffer->decodedEnd - copyLength], copyLength);
+	}
+	
+	uxx decodedEnd = copyLength;
+	bool isDone = false;
+	if (decoder->codec == StreamCodec_Gzip)
+	{
+		if (decoder->mappedFile != nullptr) { MappedFileReadahead(decoder->mappedFile, decoder->inflate->offset); }
+		decodedEnd = DecodeInflateStream(decoder->inflate, buffer->bytes, copyLength, decoder->bufferSize);
+		if (decoder->inflate->error != Result_None) { decoder->error = decoder->inflate->error; }
+		isDone = (decoder->inflate->stage == InflateStage_Done);
+		buffer->inputOffset = decoder->inflate->offset;
+	}
+	else if (decoder->codec == StreamCodec_Bzip2)
+	{
+		if (decoder->mappedFile != nullptr) { MappedFileReadahead(decoder->mappedFile, decoder->bzip2->offset); }
+		decodedEnd = DecodeBzip2Stream(decoder->bzip2, buffer->bytes, copyLength, decoder->bufferSize);
+		if (decoder->bzip2->error != Result_None) { decoder->error = decoder->bzip2->error; }
+		isDone = (decoder->bzip2->stage == Bzip2Stage_Done);
+		buffer->inputOffset = decoder->bzip2->offset;
+	}
+	
+	buffer->chunkStart = copyLength - carryLength;
+	buffer->decodedEnd = decodedEnd;
+	buffer->isLast = isDone;
+	buffer->chunkEnd = (isDone || decodedEnd < STREAM_DECODER_CARRY_SIZE) ? decodedEnd : decodedEnd - STREAM_DECODER_CARRY_SIZE;
+	TracyCZoneValue(funcZone, decodedEnd - copyLength);
+	TracyCZoneEnd(funcZone);
+}
+
+// Keeps filling buffers until they're all waiting to be parsed (or being parsed), the codec reaches the end or StopStreamDecoderJob is called
+WORKER_JOB_DEF(StreamDecoderJob)
+{
+	StreamDecoder* decoder = (StreamDecoder*)contextPntr;
+	TracyCZoneN(funcZone, "StreamDecoderJob", true);
+	LockThreadMutex(&decoder->mutex);
+	while (!decoder->isStopRequested && !decoder->isDecodeFinished)
+	{
+		//NOTE: The chunk that was taken last is still being parsed, so it's busy too
+		uxx numBusy = (decoder->numFilled - decoder->numTaken) + ((decoder->numTaken > 0) ? 1 : 0);
+		if (numBusy >= decoder->numBuffers) { WaitThreadCondVar(&decoder->bufferTaken, &decoder->mutex); continue; }
+		uxx fillIndex = decoder->numFilled;
+		UnlockThreadMutex(&decoder->mutex);
+		
+		FillStreamDecoderBuffer(decoder, fillIndex);
+		
+		LockThreadMutex(&decoder->mutex);
+		if (decoder->error == Result_None) { decoder->numFilled++; }
+		if (decoder->error != Result_None || decoder->buffers[fillIndex % decoder->numBuffers].isLast) { decoder->isDecodeFinished = true; }
+		WakeAllThreadCondVar(&decoder->bufferFilled);
+	}
+	decoder->isJobRunning = false;
+	WakeAllThreadCondVar(&decoder->bufferFilled);
+	UnlockThreadMutex(&decoder->mutex);
+	TracyCZoneEnd(funcZone);
+}
+
+void StartStreamDecoderJob(StreamDecoder* decoder)
+{
+	if (decoder->workerPool == nullptr) { return; }
+	LockThreadMutex(&decoder->mutex);
+	decoder->isJobRunning = true;
+	decoder->isStopRequested = false;
+	UnlockThreadMutex(&decoder->mutex);
+	WorkerPoolQueueJob(&decoder->waitGroup, StreamDecoderJob, decoder);
+}
+
+// Blocks until the job has finished the buffer it's working on (if any) and returned
+void StopStreamDecoderJob(StreamDecoder* decoder)
+{
+	if (decoder->workerPool == nullptr) { return; }
+	LockThreadMutex(&decoder->mutex);
+	decoder->isStopRequested = true;
+	WakeAllThreadCondVar(&decoder->bufferTaken);
+	while (decoder->isJobRunning) { WaitThreadCondVar(&decoder->bufferFilled, &decoder->mutex); }
+	UnlockThreadMutex(&decoder->mutex);
+}
+
+void FreeStreamDecoder(StreamDecoder* decoder)
+{
+	NotNull(decoder);
+	if (decoder->arena != nullptr)
+	{
+		StopStreamDecoderJob(decoder);
+		if (decoder->workerPool != nullptr)
+		{
+			FreeThreadCondVar(&decoder->bufferTaken);
+			FreeThreadCondVar(&decoder->bufferFilled);
+			FreeThreadMutex(&decoder->mutex);
+		}
+		for (uxx bIndex = 0; bIndex < decoder->numBuffers; bIndex++) { FreeArray(u8, decoder->arena, decoder->bufferSize, decoder->buffers[bIndex].bytes); }
+		if (decoder->bzip2 != nullptr)
+		{
+			FreeArray(u32, decoder->arena, BZIP2_MAX_BLOCK_SIZE, decoder->bzip2->tt);
+			FreeType(Bzip2Stream, decoder->arena, decoder->bzip2);
+		}
+		if (decoder->inflate != nullptr) { FreeType(InflateStream, decoder->arena, decoder->inflate); }
+	}
+	ClearPointer(decoder);
+}
+
+// input has to stay valid (and mappedFile open) until the decoder is freed. When workerPool has threads one of them decodes ahead of NextStreamDecoderChunk
+void InitStreamDecoder(Arena* arena, StreamCodec codec, Slice input, MappedFile* mappedFile, WorkerPool* workerPool, StreamDecoder* decoderOut)
+{
+	NotNull(arena);
+	NotNull(decoderOut);
+	Assert(codec == StreamCodec_Gzip || codec == StreamCodec_Bzip2);
+	ClearPointer(decoderOut);
+	decoderOut->arena = arena;
+	decoderOut->codec = codec;
+	decoderOut->input = input;
+	decoderOut->mappedFile = mappedFile;
+	//NOTE: A pool without threads runs jobs right away on the calling thread, which would never come back from the decode job
+	decoderOut->workerPool = (workerPool != nullptr && workerPool->numThreads > 0) ? workerPool : nullptr;
+	decoderOut->numBuffers = (decoderOut->workerPool != nullptr) ? STREAM_DECODER_NUM_BUFFERS : 2;
+	
+	if (codec == StreamCodec_Gzip)
+	{
+		decoderOut->inflate = AllocType(InflateStream, arena);
+		NotNull(decoderOut->inflate);
+		InitInflateStream(decoderOut->inflate, input);
+		decoderOut->historySize = DEFLATE_WINDOW_SIZE;
+	}
+	else
+	{
+		decoderOut->bzip2 = AllocType(Bzip2Stream, arena);
+		NotNull(decoderOut->bzip2);
+		u32* tt = AllocArray(u32, arena, BZIP2_MAX_BLOCK_SIZE);
+		NotNull(tt);
+		InitBzip2Stream(decoderOut->bzip2, tt, input);
+		decoderOut->historySize = 0;
+	}
+	decoderOut->bufferSize = decoderOut->historySize + STREAM_DECODER_CARRY_SIZE + STREAM_DECODER_CHUNK_SIZE;
+	for (uxx bIndex = 0; bIndex < decoderOut->numBuffers; bIndex++)
+	{
+		decoderOut->buffers[bIndex].bytes = AllocArray(u8, arena, decoderOut->bufferSize);
+		NotNull(decoderOut->buffers[bIndex].bytes);
+	}
+	
+	if (decoderOut->workerPool != nullptr)
+	{
+		InitThreadMutex(&decoderOut->mutex);
+		InitThreadCondVar(&decoderOut->bufferFilled);
+		InitThreadCondVar(&decoderOut->bufferTaken);
+		InitWorkerWaitGroup(decoderOut->workerPool, &decoderOut->waitGroup);
+		StartStreamDecoderJob(decoderOut);
+	}
+}
+
+// Goes back to the start of the input, for loaders that need to go through the file more than once
+void ResetStreamDecoder(StreamDecoder* decoder)
+{
+	NotNull(decoder);
+	NotNull(decoder->arena);
+	StopStreamDecoderJob(decoder);
+	if (decoder->inflate != nullptr) { ResetInflateStream(decoder->inflate, decoder->input); }
+	if (decoder->bzip2 != nullptr) { ResetBzip2Stream(decoder->bzip2, decoder->input); }
+	decoder->error = Result_None;
+	decoder->chunkInputOffset = 0;
+	decoder->numFilled = 0;
+	decoder->numTaken = 0;
+	decoder->isDecodeFinished = false;
+	StartStreamDecoderJob(decoder);
+}
+
+// Returns false once everything has been handed out, or when the data turns out to be corrupt (decoder->error is set).
+// The chunk is only valid until the next call, consecutive chunks never start at the same address
+bool NextStreamDecoderChunk(StreamDecoder* decoder, Slice* chunkOut)
+{
+	NotNull(decoder);
+	NotNull(chunkOut);
+	StreamDecoderBuffer* buffer = nullptr;
+	if (decoder->workerPool != nullptr)
+	{
+		TracyCZoneN(Zone_Wait, "WaitForStreamDecoder", true);
+		LockThreadMutex(&decoder->mutex);
+		while (decoder->numFilled == decoder->numTaken && !decoder->isDecodeFinished) { WaitThreadCondVar(&decoder->bufferFilled, &decoder->mutex); }
+		if (decoder->numFilled > decoder->numTaken)
+		{
+			buffer = &decoder->buffers[decoder->numTaken % decoder->numBuffers];
+			decoder->numTaken++;
+			WakeAllThreadCondVar(&decoder->bufferTaken);
+		}
+		UnlockThreadMutex(&decoder->mutex);
+		TracyCZoneEnd(Zone_Wait);
+	}
+	else if (!decoder->isDecodeFinished)
+	{
+		FillStreamDecoderBuffer(decoder, decoder->numFilled);
+		if (decoder->error == Result_None)
+		{
+			buffer = &decoder->buffers[decoder->numFilled % decoder->numBuffers];
+			decoder->numFilled++;
+			decoder->numTaken++;
+		}
+		decoder->isDecodeFinished = (buffer == nullptr || buffer->isLast);
+	}
+	
+	if (buffer == nullptr || buffer->chunkEnd == buffer->chunkStart) { return false; }
+	decoder->chunkInputOffset = buffer->inputOffset;
+	*chunkOut = MakeSlice(buffer->chunkEnd - buffer->chunkStart, &buffer->bytes[buffer->chunkStart]);
+	return true;
+}
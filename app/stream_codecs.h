@@ -0,0 +1,194 @@
+/*
+File:   stream_codecs.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _STREAM_CODECS_H
+#define _STREAM_CODECS_H
+
+#define STREAM_DECODER_CHUNK_SIZE   Megabytes(1) //decompressed bytes per chunk handed to the parser
+#define STREAM_DECODER_NUM_BUFFERS  4 //when decoding on a worker thread, how many chunks it can get ahead of the parser by (minus the one being parsed)
+#define STREAM_DECODER_CARRY_SIZE   sizeof(u32) //bytes held back from the end of every chunk but the last so the last chunk is never shorter than a character
+
+#define INFLATE_FAST_BITS           10 //codes up to this long are decoded with one table lookup, longer ones fall back to walking the canonical code
+#define INFLATE_MAX_LITLEN_CODES    288 //including the 2 that never show up in valid data, the fixed Huffman code describes them
+#define INFLATE_MAX_DIST_CODES      32
+#define GZIP_FLAG_TEXT              0x01
+#define GZIP_FLAG_HCRC              0x02
+#define GZIP_FLAG_EXTRA             0x04
+#define GZIP_FLAG_NAME              0x08
+#define GZIP_FLAG_COMMENT           0x10
+#define GZIP_FLAG_RESERVED          0xE0
+
+#define BZIP2_MAX_BLOCK_SIZE        900000 //bytes, what the level 9 ("BZh9") header allows
+#define BZIP2_MAX_GROUPS            6
+#define BZIP2_MAX_ALPHA_SIZE        258
+#define BZIP2_MAX_CODE_LENGTH       20
+#define BZIP2_GROUP_SIZE            50 //symbols per selector
+#define BZIP2_MAX_SELECTORS         18002 //files can say they have more, the rest are read and ignored (like bzip2 1.0.8 does)
+#define BZIP2_BLOCK_MAGIC           0x314159265359ULL //48 bits, the digits of pi
+#define BZIP2_END_MAGIC             0x177245385090ULL //48 bits, the digits of sqrt(pi)
+#define BZIP2_RUNA                  0
+#define BZIP2_RUNB                  1
+
+typedef enum StreamCodec StreamCodec;
+enum StreamCodec
+{
+	StreamCodec_None = 0,
+	StreamCodec_Gzip,
+	StreamCodec_Bzip2,
+	StreamCodec_Count,
+};
+const char* GetStreamCodecStr(StreamCodec enumValue)
+{
+	switch (enumValue)
+	{
+		case StreamCodec_None:  return "None";
+		case StreamCodec_Gzip:  return "GZIP";
+		case StreamCodec_Bzip2: return "BZIP2";
+		default: return UNKNOWN_STR;
+	}
+}
+
+typedef enum InflateStage InflateStage;
+enum InflateStage
+{
+	InflateStage_MemberHeader = 0, //the gzip header in front of each member
+	InflateStage_BlockHeader,
+	InflateStage_Stored,
+	InflateStage_Huffman,
+	InflateStage_MemberTrailer, //CRC32 and ISIZE
+	InflateStage_Done,
+};
+
+typedef plex InflateHuffman InflateHuffman;
+plex InflateHuffman
+{
+	u16 fast[1 << INFLATE_FAST_BITS]; //(length << 9) | symbol, indexed by the next INFLATE_FAST_BITS bits of the stream. 0 when the code is longer than that
+	u16 lengthCounts[DEFLATE_MAX_CODE_LENGTH+1];
+	u16 firstCodes[DEFLATE_MAX_CODE_LENGTH+1]; //the canonical code of the first symbol of each length
+	u16 firstIndices[DEFLATE_MAX_CODE_LENGTH+1]; //where the symbols of each length start in sortedSymbols
+	u16 sortedSymbols[INFLATE_MAX_LITLEN_CODES];
+};
+
+// Decodes a gzip file (RFC 1952, any number of members) that is entirely in memory. Only the output is streamed, DecodeInflateStream
+// stops whenever the buffer it's given is full and picks up where it left off (in the middle of a match or stored block) the next time
+typedef plex InflateStream InflateStream;
+plex InflateStream
+{
+	const u8* bytes;
+	uxx length;
+	uxx offset;
+	u64 bitBuffer; //least significant bit first
+	u8 numBits;
+	InflateStage stage;
+	bool isFinalBlock;
+	uxx storedRemaining; //bytes left in the current stored block
+	uxx matchRemaining; //bytes left to copy from a match that didn't fit in the last buffer
+	uxx matchDistance;
+	u32 memberCrc; //CRC32 of the member's output so far
+	u32 memberSize; //ISIZE, the member's output size mod 2^32
+	uxx numMembers;
+	Result error;
+	InflateHuffman litLenCodes;
+	InflateHuffman distCodes;
+	InflateHuffman fixedLitLenCodes;
+	InflateHuffman fixedDistCodes;
+	u32 crcTable[8][256]; //slicing-by-8, for the reflected CRC32 that gzip uses
+};
+
+typedef enum Bzip2Stage Bzip2Stage;
+enum Bzip2Stage
+{
+	Bzip2Stage_StreamHeader = 0,
+	Bzip2Stage_BlockHeader,
+	Bzip2Stage_BlockOutput,
+	Bzip2Stage_Done,
+};
+
+typedef plex Bzip2Group Bzip2Group;
+plex Bzip2Group
+{
+	u8 minLength;
+	u8 maxLength;
+	i32 limits[BZIP2_MAX_CODE_LENGTH+2]; //the largest code of each length, -1 when there are none
+	i32 bases[BZIP2_MAX_CODE_LENGTH+2];
+	u16 perms[BZIP2_MAX_ALPHA_SIZE]; //symbols sorted by code length
+};
+
+// Decodes a bzip2 file (any number of concatenated streams) that is entirely in memory. Each block is Huffman/MTF decoded and
+// inverse BWT'd into tt all at once, then its bytes are run-length decoded into the output buffers as they're asked for
+typedef plex Bzip2Stream Bzip2Stream;
+plex Bzip2Stream
+{
+	const u8* bytes;
+	uxx length;
+	uxx offset;
+	u64 bitBuffer; //most significant bit first, the low numBits bits are the ones we haven't read yet
+	u8 numBits;
+	Bzip2Stage stage;
+	uxx maxBlockSize; //from the "BZh1".."BZh9" header
+	uxx numStreams;
+	Result error;
+	
+	u32* tt; //BZIP2_MAX_BLOCK_SIZE, the low 8 bits are the byte and the high 24 bits link to the next position
+	u32 tPos;
+	uxx blockRemaining; //bytes of tt we haven't output yet
+	i32 runByte; //the byte that the run length decoding is counting, -1 at the start of each block
+	uxx runLength;
+	uxx repeatRemaining; //copies of runByte left to output from the last run length byte
+	u32 blockCrc;
+	u32 expectedBlockCrc;
+	u32 combinedCrc;
+	u32 crcTable[256]; //for the non-reflected CRC32 that bzip2 uses
+	
+	u8 selectors[BZIP2_MAX_SELECTORS];
+	u8 codeLengths[BZIP2_MAX_GROUPS][BZIP2_MAX_ALPHA_SIZE];
+	Bzip2Group groups[BZIP2_MAX_GROUPS];
+};
+
+typedef plex StreamDecoderBuffer StreamDecoderBuffer;
+plex StreamDecoderBuffer
+{
+	u8* bytes; //historySize + STREAM_DECODER_CARRY_SIZE + STREAM_DECODER_CHUNK_SIZE
+	uxx chunkStart; //the bytes before this are copied from the end of the last buffer so matches can reach back into them
+	uxx chunkEnd;
+	uxx decodedEnd; //chunkEnd + STREAM_DECODER_CARRY_SIZE unless this is the last chunk
+	u64 inputOffset; //how far through the compressed data the codec was when it finished this buffer
+	bool isLast;
+};
+
+// Decompresses a file one chunk at a time so the whole thing never needs to be in memory. The chunks come out of a ring of buffers, either
+// filled on demand by NextStreamDecoderChunk or ahead of time by a job on workerPool, in which case decompression and parsing run side by side
+typedef plex StreamDecoder StreamDecoder;
+plex StreamDecoder
+{
+	Arena* arena;
+	StreamCodec codec;
+	Slice input;
+	MappedFile* mappedFile; //nullptr when input isn't mapped
+	uxx historySize; //DEFLATE_WINDOW_SIZE for gzip, bzip2 blocks don't refer back to earlier output
+	uxx bufferSize;
+	InflateStream* inflate;
+	Bzip2Stream* bzip2;
+	Result error;
+	u64 chunkInputOffset; //the inputOffset of the chunk NextStreamDecoderChunk handed out last, for progress
+	
+	uxx numBuffers; //2 when decoding on the calling thread, consecutive chunks must never start at the same address (hoxml only resets when the pointer changes)
+	StreamDecoderBuffer buffers[STREAM_DECODER_NUM_BUFFERS];
+	uxx numFilled;
+	uxx numTaken;
+	bool isDecodeFinished; //the codec reached the end (or an error), no more buffers will be filled
+	
+	//NOTE: When workerPool is nullptr everything happens on the calling thread and none of this is used
+	WorkerPool* workerPool;
+	WorkerWaitGroup waitGroup;
+	ThreadMutex mutex; //protects numFilled, numTaken, isDecodeFinished and the flags below, the job fills buffers[numFilled % numBuffers] without holding it
+	ThreadCondVar bufferFilled;
+	ThreadCondVar bufferTaken;
+	bool isJobRunning;
+	bool isStopRequested;
+};
+
+#endif //  _STREAM_CODECS_H
@@ -0,0 +1,301 @@
+/*
+File:   worker_pool.c
+Author: Taylor Robbins
+Date:   10\17\2026
+Description:
+	** Holds a small fixed-size pool of worker threads that pull jobs off of a shared queue.
+	** Also holds the ThreadMutex and ThreadCondVar wrappers that jobs can use to coordinate
+	** with each other. Jobs are queued through a WorkerWaitGroup so the code that queued them
+	** can wait on just those jobs while other code shares the pool. When TARGET_HAS_THREADING is false
+	** the pool has no threads and all jobs are run immediately on the thread that queues them.
+*/
+
+// +--------------------------------------------------------------+
+// |                      Thread Primitives                       |
+// +--------------------------------------------------------------+
+void InitThreadMutex(ThreadMutex* mutex)
+{
+	NotNull(mutex);
+	ClearPointer(mutex);
+	#if !TARGET_HAS_THREADING
+	//Nothing to do
+	#elif TARGET_IS_WINDOWS
+	InitializeSRWLock(&mutex->handle);
+	#else
+	int initResult = pthread_mutex_init(&mutex->handle, nullptr);
+	Assert(initResult == 0); UNUSED(initResult);
+	#endif
+}
+void FreeThreadMutex(ThreadMutex* mutex)
+{
+	NotNull(mutex);
+	#if TARGET_HAS_THREADING && !TARGET_IS_WINDOWS
+	pthread_mutex_destroy(&mutex->handle);
+	#endif
+	ClearPointer(mutex);
+}
+void LockThreadMutex(ThreadMutex* mutex)
+{
+	#if !TARGET_HAS_THREADING
+	Assert(!mutex->isLocked);
+	mutex->isLocked = true;
+	#elif TARGET_IS_WINDOWS
+	AcquireSRWLockExclusive(&mutex->handle);
+	#else
+	pthread_mutex_lock(&mutex->handle);
+	#endif
+}
+void UnlockThreadMutex(ThreadMutex* mutex)
+{
+	#if !TARGET_HAS_THREADING
+	Assert(mutex->isLocked);
+	mutex->isLocked = false;
+	#elif TARGET_IS_WINDOWS
+	ReleaseSRWLockExclusive(&mutex->handle);
+	#else
+	pthread_mutex_unlock(&mutex->handle);
+	#endif
+}
+
+void InitThreadCondVar(ThreadCondVar* condVar)
+{
+	NotNull(condVar);
+	ClearPointer(condVar);
+	#if !TARGET_HAS_THREADING
+	//Nothing to do
+	#elif TARGET_IS_WINDOWS
+	InitializeConditionVariable(&condVar->handle);
+	#else
+	int initResult = pthread_cond_init(&condVar->handle, nullptr);
+	Assert(initResult == 0); UNUSED(initResult);
+	#endif
+}
+void FreeThreadCondVar(ThreadCondVar* condVar)
+{
+	NotNull(condVar);
+	#if TARGET_HAS_THREADING && !TARGET_IS_WINDOWS
+	pthread_cond_destroy(&condVar->handle);
+	#endif
+	ClearPointer(condVar);
+}
+// The mutex must be locked when calling this. It is unlocked while waiting and re-locked before returning.
+// Like all condition variables this can wake up spuriously so always call it in a loop that checks your condition
+void WaitThreadCondVar(ThreadCondVar* condVar, ThreadMutex* mutex)
+{
+	#if !TARGET_HAS_THREADING
+	UNUSED(condVar);
+	UNUSED(mutex);
+	AssertMsg(false, "WaitThreadCondVar would wait forever when there is no threading!");
+	#elif TARGET_IS_WINDOWS
+	SleepConditionVariableSRW(&condVar->handle, &mutex->handle, INFINITE, 0);
+	#else
+	pthread_cond_wait(&condVar->handle, &mutex->handle);
+	#endif
+}
+void WakeAllThreadCondVar(ThreadCondVar* condVar)
+{
+	#if !TARGET_HAS_THREADING
+	UNUSED(condVar);
+	#elif TARGET_IS_WINDOWS
+	WakeAllConditionVariable(&condVar->handle);
+	#else
+	pthread_cond_broadcast(&condVar->handle);
+	#endif
+}
+
+uxx GetNumProcessorCores()
+{
+	#if !TARGET_HAS_THREADING
+	return 1;
+	#elif TARGET_IS_WINDOWS
+	SYSTEM_INFO systemInfo = ZEROED;
+	GetSystemInfo(&systemInfo);
+	return (systemInfo.dwNumberOfProcessors > 0) ? (uxx)systemInfo.dwNumberOfProcessors : 1;
+	#else
+	long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+	return (numCores > 0) ? (uxx)numCores : 1;
+	#endif
+}
+
+// +--------------------------------------------------------------+
+// |                         Worker Pool                          |
+// +--------------------------------------------------------------+
+void RunWorkerThreadLoop(WorkerThread* thread)
+{
+	WorkerPool* pool = thread->pool;
+	LockThreadMutex(&pool->mutex);
+	while (true)
+	{
+		while (pool->queueLength == 0 && !pool->isStopping) { WaitThreadCondVar(&pool->jobQueued, &pool->mutex); }
+		if (pool->queueLength == 0 && pool->isStopping) { break; }
+		
+		WorkerJob job = pool->queue[pool->queueHead];
+		pool->queueHead = (pool->queueHead + 1) % WORKER_POOL_QUEUE_SIZE;
+		pool->queueLength--;
+		WakeAllThreadCondVar(&pool->jobFinished); //a slot in the queue opened up
+		UnlockThreadMutex(&pool->mutex);
+		
+		job.function(job.contextPntr);
+		
+		LockThreadMutex(&pool->mutex);
+		Assert(job.waitGroup->numPendingJobs > 0);
+		job.waitGroup->numPendingJobs--;
+		WakeAllThreadCondVar(&pool->jobFinished);
+	}
+	UnlockThreadMutex(&pool->mutex);
+}
+
+#if TARGET_HAS_THREADING
+//NOTE: PigCore has no counterpart to InitScratchArenasVirtual since the main thread's scratch arenas live as long as the process.
+//      Worker pools are recreated on every DLL reload though, so each thread has to give its reservations back before it exits
+void FreeWorkerThreadScratchArenas()
+{
+	for (uxx aIndex = 0; aIndex < NUM_SCRATCH_ARENAS_PER_THREAD; aIndex++)
+	{
+		Arena* scratchArena = &scratchArenasArray[aIndex];
+		if (scratchArena->mainPntr != nullptr) { OsFreeReservedMemory(scratchArena->mainPntr, scratchArena->size); }
+		ClearPointer(scratchArena);
+	}
+}
+
+#if TARGET_IS_WINDOWS
+DWORD WINAPI WorkerThreadMain(LPVOID lpParameter)
+#else
+void* WorkerThreadMain(void* lpParameter)
+#endif
+{
+	WorkerThread* thread = (WorkerThread*)lpParameter;
+	NotNull(thread);
+	#if PROFILING_ENABLED
+	TracyCSetThreadName("worker");
+	#endif
+	//NOTE: Scratch arenas are per-thread so every worker needs its own set before it runs any jobs
+	InitScratchArenasVirtual(thread->pool->scratchSize);
+	RunWorkerThreadLoop(thread);
+	FreeWorkerThreadScratchArenas();
+	#if TARGET_IS_WINDOWS
+	return 0;
+	#else
+	return nullptr;
+	#endif
+}
+#endif //TARGET_HAS_THREADING
+
+void FreeWorkerPool(WorkerPool* pool)
+{
+	NotNull(pool);
+	if (pool->arena != nullptr)
+	{
+		LockThreadMutex(&pool->mutex);
+		pool->isStopping = true;
+		WakeAllThreadCondVar(&pool->jobQueued);
+		UnlockThreadMutex(&pool->mutex);
+		
+		#if TARGET_HAS_THREADING
+		for (uxx tIndex = 0; tIndex < pool->numThreads; tIndex++)
+		{
+			WorkerThread* thread = &pool->threads[tIndex];
+			#if TARGET_IS_WINDOWS
+			WaitForSingleObject(thread->handle, INFINITE);
+			CloseHandle(thread->handle);
+			#else
+			pthread_join(thread->handle, nullptr);
+			#endif
+		}
+		#endif
+		
+		if (pool->threads != nullptr) { FreeArray(WorkerThread, pool->arena, pool->numThreads, pool->threads); }
+		FreeThreadCondVar(&pool->jobFinished);
+		FreeThreadCondVar(&pool->jobQueued);
+		FreeThreadMutex(&pool->mutex);
+	}
+	ClearPointer(pool);
+}
+
+// Pass 0 for numThreads to get one thread per processor core. scratchSize is the virtual size of each
+// of the thread's scratch arenas, only pools with jobs that need more than WORKER_THREAD_SCRATCH_SIZE should use this
+void InitWorkerPoolEx(Arena* arena, uxx numThreads, uxx scratchSize, WorkerPool* poolOut)
+{
+	NotNull(arena);
+	NotNull(poolOut);
+	Assert(scratchSize > 0);
+	ClearPointer(poolOut);
+	poolOut->arena = arena;
+	poolOut->scratchSize = scratchSize;
+	InitThreadMutex(&poolOut->mutex);
+	InitThreadCondVar(&poolOut->jobQueued);
+	InitThreadCondVar(&poolOut->jobFinished);
+	
+	#if TARGET_HAS_THREADING
+	if (numThreads == 0) { numThreads = GetNumProcessorCores(); }
+	numThreads = MinUXX(numThreads, WORKER_POOL_MAX_THREADS);
+	poolOut->threads = AllocArray(WorkerThread, arena, numThreads);
+	NotNull(poolOut->threads);
+	MyMemSet(poolOut->threads, 0x00, sizeof(WorkerThread) * numThreads);
+	for (uxx tIndex = 0; tIndex < numThreads; tIndex++)
+	{
+		WorkerThread* thread = &poolOut->threads[tIndex];
+		thread->pool = poolOut;
+		thread->index = tIndex;
+		#if TARGET_IS_WINDOWS
+		thread->handle = CreateThread(nullptr, 0, WorkerThreadMain, (LPVOID)thread, 0, nullptr);
+		bool createdThread = (thread->handle != NULL);
+		#else
+		bool createdThread = (pthread_create(&thread->handle, nullptr, WorkerThreadMain, (void*)thread) == 0);
+		#endif
+		if (!createdThread) { PrintLine_E("Failed to create worker thread %llu/%llu", tIndex+1, numThreads); break; }
+		poolOut->numThreads++;
+	}
+	#else
+	UNUSED(numThreads);
+	#endif
+}
+void InitWorkerPool(Arena* arena, uxx numThreads, WorkerPool* poolOut)
+{
+	InitWorkerPoolEx(arena, numThreads, WORKER_THREAD_SCRATCH_SIZE, poolOut);
+}
+
+void InitWorkerWaitGroup(WorkerPool* pool, WorkerWaitGroup* groupOut)
+{
+	NotNull(pool);
+	NotNull(groupOut);
+	ClearPointer(groupOut);
+	groupOut->pool = pool;
+}
+
+// Blocks if the queue is full. When the pool has no threads the job is run immediately on the calling thread
+void WorkerPoolQueueJob(WorkerWaitGroup* waitGroup, WorkerJob_f* function, void* contextPntr)
+{
+	NotNull(waitGroup);
+	WorkerPool* pool = waitGroup->pool;
+	NotNull(pool);
+	NotNull(pool->arena);
+	NotNull(function);
+	if (pool->numThreads == 0) { function(contextPntr); return; }
+	
+	LockThreadMutex(&pool->mutex);
+	while (pool->queueLength >= WORKER_POOL_QUEUE_SIZE) { WaitThreadCondVar(&pool->jobFinished, &pool->mutex); }
+	WorkerJob* newJob = &pool->queue[(pool->queueHead + pool->queueLength) % WORKER_POOL_QUEUE_SIZE];
+	newJob->function = function;
+	newJob->contextPntr = contextPntr;
+	newJob->waitGroup = waitGroup;
+	pool->queueLength++;
+	waitGroup->numPendingJobs++;
+	WakeAllThreadCondVar(&pool->jobQueued);
+	UnlockThreadMutex(&pool->mutex);
+}
+
+// Blocks until every job queued through waitGroup has been picked up and finished. Jobs from other wait groups
+// don't hold this up. This must not be called from a job running on the same pool, it could be waiting on a job that has no thread left to run it
+void WaitForWorkerWaitGroup(WorkerWaitGroup* waitGroup)
+{
+	NotNull(waitGroup);
+	WorkerPool* pool = waitGroup->pool;
+	NotNull(pool);
+	if (pool->numThreads == 0) { return; }
+	TracyCZoneN(funcZone, "WaitForWorkerWaitGroup", true);
+	LockThreadMutex(&pool->mutex);
+	while (waitGroup->numPendingJobs > 0) { WaitThreadCondVar(&pool->jobFinished, &pool->mutex); }
+	UnlockThreadMutex(&pool->mutex);
+	TracyCZoneEnd(funcZone);
+}
@@ -0,0 +1,100 @@
+/*
+File:   worker_pool.h
+Author: Taylor Robbins
+Date:   10\17\2026
+*/
+
+#ifndef _WORKER_POOL_H
+#define _WORKER_POOL_H
+
+#if TARGET_HAS_THREADING && !TARGET_IS_WINDOWS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define WORKER_POOL_MAX_THREADS       64 //threads
+#define WORKER_POOL_QUEUE_SIZE        256 //jobs
+#define WORKER_THREAD_SCRATCH_SIZE    Megabytes(256) //virtual (per scratch arena), only committed as it gets used. A .pbf blob is at most 32MB compressed plus 32MB raw
+
+// +--------------------------------------------------------------+
+// |                      Thread Primitives                       |
+// +--------------------------------------------------------------+
+typedef plex ThreadMutex ThreadMutex;
+plex ThreadMutex
+{
+	#if !TARGET_HAS_THREADING
+	bool isLocked;
+	#elif TARGET_IS_WINDOWS
+	SRWLOCK handle;
+	#else
+	pthread_mutex_t handle;
+	#endif
+};
+
+typedef plex ThreadCondVar ThreadCondVar;
+plex ThreadCondVar
+{
+	#if !TARGET_HAS_THREADING
+	u8 unused;
+	#elif TARGET_IS_WINDOWS
+	CONDITION_VARIABLE handle;
+	#else
+	pthread_cond_t handle;
+	#endif
+};
+
+// +--------------------------------------------------------------+
+// |                         Worker Pool                          |
+// +--------------------------------------------------------------+
+#define WORKER_JOB_DEF(functionName) void functionName(void* contextPntr)
+typedef WORKER_JOB_DEF(WorkerJob_f);
+
+// Counts the jobs that were queued through it and haven't finished yet. Each batch of jobs gets its own
+// so the caller only waits on the work it queued, even when other code is using the same pool at the same time
+typedef plex WorkerWaitGroup WorkerWaitGroup;
+plex WorkerWaitGroup
+{
+	plex WorkerPool* pool;
+	uxx numPendingJobs; //protected by pool->mutex
+};
+
+typedef plex WorkerJob WorkerJob;
+plex WorkerJob
+{
+	WorkerJob_f* function;
+	void* contextPntr;
+	WorkerWaitGroup* waitGroup;
+};
+
+typedef plex WorkerThread WorkerThread;
+plex WorkerThread
+{
+	plex WorkerPool* pool;
+	uxx index;
+	#if !TARGET_HAS_THREADING
+	u8 unused;
+	#elif TARGET_IS_WINDOWS
+	HANDLE handle;
+	#else
+	pthread_t handle;
+	#endif
+};
+
+typedef plex WorkerPool WorkerPool;
+plex WorkerPool
+{
+	Arena* arena;
+	uxx numThreads;
+	uxx scratchSize; //virtual size of each of the scratch arenas a thread reserves when it starts
+	WorkerThread* threads;
+	
+	ThreadMutex mutex;
+	ThreadCondVar jobQueued; //signalled when a job is added or the pool is stopping
+	ThreadCondVar jobFinished; //signalled when a job finishes or leaves the queue
+	bool isStopping;
+	uxx queueHead;
+	uxx queueLength;
+	WorkerJob queue[WORKER_POOL_QUEUE_SIZE];
+};
+
+#endif //  _WORKER_POOL_H